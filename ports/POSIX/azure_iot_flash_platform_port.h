@@ -0,0 +1,82 @@
+/* Copyright (c) Microsoft Corporation.
+ * Licensed under the MIT License. */
+
+/**
+ * @file azure_iot_flash_platform_port.h
+ * @brief Flash platform port for POSIX hosts, with two boot banks in memory mapped files.
+ *
+ * The port behaves like a NOR flash: bits are only cleared by a program, a sector is erased
+ * the first time a write starts it while it is not blank, and a write that would have to set
+ * bits back to 1 anywhere else fails. Erase and program times are simulated, and
+ * AzureIoTPlatform_ResetDevice() boots the enabled bank without exiting the process.
+ *
+ * The banks, the checkpoint and the boot state are files in #AzureADUImage_t.pcDirectory, so
+ * they survive the process, like flash survives a reset of the device.
+ */
+
+#ifndef AZURE_IOT_FLASH_PLATFORM_PORT_H
+#define AZURE_IOT_FLASH_PLATFORM_PORT_H
+
+#include <stdint.h>
+
+/**
+ * @brief Size of each boot bank.
+ */
+#ifndef azureiotflashposixBANK_SIZE
+    #define azureiotflashposixBANK_SIZE       ( 4U * 1024U * 1024U )
+#endif
+
+/**
+ * @brief Program page size of the simulated flash.
+ */
+#ifndef azureiotflashposixPAGE_SIZE
+    #define azureiotflashposixPAGE_SIZE       ( 256U )
+#endif
+
+/**
+ * @brief Erase sector size of the simulated flash, a multiple of #azureiotflashposixPAGE_SIZE.
+ */
+#ifndef azureiotflashposixSECTOR_SIZE
+    #define azureiotflashposixSECTOR_SIZE     ( 4096U )
+#endif
+
+/**
+ * @brief Largest checkpoint AzureIoTPlatform_SaveCheckpoint() accepts.
+ */
+#ifndef azureiotflashposixCHECKPOINT_SIZE
+    #define azureiotflashposixCHECKPOINT_SIZE    ( 1024U )
+#endif
+
+struct AzureADUImage;
+
+/**
+ * @brief Called by AzureIoTPlatform_ResetDevice() once the device is reset.
+ *
+ * @param[in] pxImage The image passed to AzureIoTPlatform_ResetDevice().
+ */
+typedef void ( * AzureADUImageResetCallback_t )( struct AzureADUImage * pxImage );
+
+/**
+ * @brief Image written to the update bank of a POSIX host.
+ *
+ * Set the fields up to xResetCallback, zero the others, then call AzureIoTPlatform_Init().
+ */
+typedef struct AzureADUImage
+{
+    const char * pcDirectory;                   /**< Directory of the bank files, created if needed. */
+    uint32_t ulEraseMicroseconds;               /**< Simulated time to erase a sector. */
+    uint32_t ulProgramMicroseconds;             /**< Simulated time to program a page. */
+    AzureADUImageResetCallback_t xResetCallback; /**< Called on reset, for example to restart the application, or NULL. */
+
+    uint8_t * pucBanks[ 2 ];                    /**< The mapped banks. */
+    uint32_t ulActiveBank;                      /**< The bank booted from, the other is the update bank. */
+    uint32_t ulImageSize;                       /**< End of the last byte written to the update bank. */
+    uint8_t ucErased[ azureiotflashposixBANK_SIZE / azureiotflashposixSECTOR_SIZE / 8U ]; /**< Sectors erased since AzureIoTPlatform_Init(). */
+
+    uint32_t ulEraseCount;                      /**< Sectors erased. */
+    uint32_t ulProgramCount;                    /**< Pages programmed. */
+    uint64_t ullBusyMicroseconds;               /**< Simulated time spent erasing and programming. */
+    uint32_t ulResetCount;                      /**< Calls to AzureIoTPlatform_ResetDevice(). */
+} AzureADUImage_t;
+
+#endif /* AZURE_IOT_FLASH_PLATFORM_PORT_H */
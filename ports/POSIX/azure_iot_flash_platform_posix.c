@@ -0,0 +1,507 @@
+/* Copyright (c) Microsoft Corporation.
+ * Licensed under the MIT License. */
+
+/**
+ * @file azure_iot_flash_platform_posix.c
+ * @brief Flash platform port for POSIX hosts, with two boot banks in memory mapped files.
+ *
+ */
+
+#include "azure_iot_flash_platform.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "azure_iot.h"
+#include "azure_iot_crypto.h"
+
+#include "azure/core/az_base64.h"
+#include "azure/core/az_span.h"
+
+#define azureiotflashposixNO_BANK    ( 0xFFFFFFFFU )
+
+/* Boot state, saved in boot.bin */
+typedef struct AzureIoTFlashPOSIXBootState
+{
+    uint32_t ulActiveBank;
+    uint32_t ulPendingBank;
+} AzureIoTFlashPOSIXBootState_t;
+/*-----------------------------------------------------------*/
+
+static void prvGetPath( AzureADUImage_t * const pxAduImage,
+                        const char * pcName,
+                        char * pcPath )
+{
+    ( void ) snprintf( pcPath, PATH_MAX, "%s/%s", pxAduImage->pcDirectory, pcName );
+}
+/*-----------------------------------------------------------*/
+
+/* Replace a file in one step, so a simulated power loss never leaves half of it. */
+static AzureIoTResult_t prvSaveFile( AzureADUImage_t * const pxAduImage,
+                                     const char * pcName,
+                                     const void * pvData,
+                                     uint32_t ulLength )
+{
+    char cPath[ PATH_MAX ];
+    char cTempPath[ PATH_MAX + sizeof( ".tmp" ) ];
+    FILE * pxFile;
+    AzureIoTResult_t xResult = eAzureIoTSuccess;
+
+    prvGetPath( pxAduImage, pcName, cPath );
+    ( void ) snprintf( cTempPath, sizeof( cTempPath ), "%s.tmp", cPath );
+
+    if( ( pxFile = fopen( cTempPath, "wb" ) ) == NULL )
+    {
+        AZLogError( ( "AzureIoTPlatform failed to open %s: errno=%d", cTempPath, errno ) );
+        return eAzureIoTErrorFailed;
+    }
+
+    if( ( fwrite( pvData, 1, ulLength, pxFile ) != ulLength ) || ( fflush( pxFile ) != 0 ) ||
+        ( fsync( fileno( pxFile ) ) != 0 ) )
+    {
+        AZLogError( ( "AzureIoTPlatform failed to write %s: errno=%d", cTempPath, errno ) );
+        xResult = eAzureIoTErrorFailed;
+    }
+
+    ( void ) fclose( pxFile );
+
+    if( ( xResult == eAzureIoTSuccess ) && ( rename( cTempPath, cPath ) != 0 ) )
+    {
+        AZLogError( ( "AzureIoTPlatform failed to rename %s: errno=%d", cTempPath, errno ) );
+        xResult = eAzureIoTErrorFailed;
+    }
+
+    return xResult;
+}
+/*-----------------------------------------------------------*/
+
+static AzureIoTResult_t prvLoadFile( AzureADUImage_t * const pxAduImage,
+                                     const char * pcName,
+                                     void * pvData,
+                                     uint32_t ulLength )
+{
+    char cPath[ PATH_MAX ];
+    FILE * pxFile;
+    AzureIoTResult_t xResult = eAzureIoTSuccess;
+
+    prvGetPath( pxAduImage, pcName, cPath );
+
+    if( ( pxFile = fopen( cPath, "rb" ) ) == NULL )
+    {
+        return eAzureIoTErrorItemNotFound;
+    }
+
+    /* A file of another length is not the one expected. */
+    if( ( fread( pvData, 1, ulLength, pxFile ) != ulLength ) || ( fgetc( pxFile ) != EOF ) )
+    {
+        xResult = eAzureIoTErrorItemNotFound;
+    }
+
+    ( void ) fclose( pxFile );
+
+    return xResult;
+}
+/*-----------------------------------------------------------*/
+
+static AzureIoTResult_t prvMapBank( AzureADUImage_t * const pxAduImage,
+                                    uint32_t ulBank )
+{
+    char cName[ 16 ];
+    char cPath[ PATH_MAX ];
+    struct stat xStat;
+    void * pvBank;
+    int lFile;
+
+    ( void ) snprintf( cName, sizeof( cName ), "bank%u.bin", ulBank );
+    prvGetPath( pxAduImage, cName, cPath );
+
+    if( ( lFile = open( cPath, O_RDWR | O_CREAT, 0644 ) ) < 0 )
+    {
+        AZLogError( ( "AzureIoTPlatform failed to open %s: errno=%d", cPath, errno ) );
+        return eAzureIoTErrorFailed;
+    }
+
+    if( ( fstat( lFile, &xStat ) != 0 ) ||
+        ( ( xStat.st_size < ( off_t ) azureiotflashposixBANK_SIZE ) &&
+          ( ftruncate( lFile, azureiotflashposixBANK_SIZE ) != 0 ) ) )
+    {
+        AZLogError( ( "AzureIoTPlatform failed to size %s: errno=%d", cPath, errno ) );
+        ( void ) close( lFile );
+        return eAzureIoTErrorFailed;
+    }
+
+    pvBank = mmap( NULL, azureiotflashposixBANK_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED, lFile, 0 );
+    ( void ) close( lFile );
+
+    if( pvBank == MAP_FAILED )
+    {
+        AZLogError( ( "AzureIoTPlatform failed to map %s: errno=%d", cPath, errno ) );
+        return eAzureIoTErrorFailed;
+    }
+
+    /* New flash comes erased. */
+    if( xStat.st_size < ( off_t ) azureiotflashposixBANK_SIZE )
+    {
+        memset( ( uint8_t * ) pvBank + xStat.st_size, 0xFF, azureiotflashposixBANK_SIZE - ( size_t ) xStat.st_size );
+    }
+
+    pxAduImage->pucBanks[ ulBank ] = ( uint8_t * ) pvBank;
+
+    return eAzureIoTSuccess;
+}
+/*-----------------------------------------------------------*/
+
+static void prvUnmapBanks( AzureADUImage_t * const pxAduImage )
+{
+    uint32_t ulBank;
+
+    for( ulBank = 0; ulBank < 2; ulBank++ )
+    {
+        if( pxAduImage->pucBanks[ ulBank ] != NULL )
+        {
+            ( void ) msync( pxAduImage->pucBanks[ ulBank ], azureiotflashposixBANK_SIZE, MS_SYNC );
+            ( void ) munmap( pxAduImage->pucBanks[ ulBank ], azureiotflashposixBANK_SIZE );
+            pxAduImage->pucBanks[ ulBank ] = NULL;
+        }
+    }
+}
+/*-----------------------------------------------------------*/
+
+static uint8_t * prvGetUpdateBank( AzureADUImage_t * const pxAduImage )
+{
+    return pxAduImage->pucBanks[ 1U - pxAduImage->ulActiveBank ];
+}
+/*-----------------------------------------------------------*/
+
+static void prvAddBusyTime( AzureADUImage_t * const pxAduImage,
+                            uint64_t ullMicroseconds,
+                            uint64_t * pullDelay )
+{
+    pxAduImage->ullBusyMicroseconds += ullMicroseconds;
+    *pullDelay += ullMicroseconds;
+}
+/*-----------------------------------------------------------*/
+
+static bool prvIsBlank( const uint8_t * pucData,
+                        uint32_t ulLength )
+{
+    while( ulLength-- > 0 )
+    {
+        if( *pucData++ != 0xFF )
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+/*-----------------------------------------------------------*/
+
+AzureIoTResult_t AzureIoTPlatform_Init( AzureADUImage_t * const pxAduImage )
+{
+    AzureIoTFlashPOSIXBootState_t xBootState;
+    AzureIoTResult_t xResult;
+
+    if( ( pxAduImage == NULL ) || ( pxAduImage->pcDirectory == NULL ) )
+    {
+        AZLogError( ( "AzureIoTPlatform_Init failed: invalid argument" ) );
+        return eAzureIoTErrorInvalidArgument;
+    }
+
+    prvUnmapBanks( pxAduImage );
+
+    if( ( mkdir( pxAduImage->pcDirectory, 0755 ) != 0 ) && ( errno != EEXIST ) )
+    {
+        AZLogError( ( "AzureIoTPlatform_Init failed to create %s: errno=%d", pxAduImage->pcDirectory, errno ) );
+        return eAzureIoTErrorFailed;
+    }
+
+    if( ( ( xResult = prvMapBank( pxAduImage, 0 ) ) != eAzureIoTSuccess ) ||
+        ( ( xResult = prvMapBank( pxAduImage, 1 ) ) != eAzureIoTSuccess ) )
+    {
+        prvUnmapBanks( pxAduImage );
+        return xResult;
+    }
+
+    if( ( prvLoadFile( pxAduImage, "boot.bin", &xBootState, sizeof( xBootState ) ) != eAzureIoTSuccess ) ||
+        ( xBootState.ulActiveBank > 1 ) )
+    {
+        xBootState.ulActiveBank = 0;
+    }
+
+    pxAduImage->ulActiveBank = xBootState.ulActiveBank;
+    pxAduImage->ulImageSize = 0;
+    memset( pxAduImage->ucErased, 0, sizeof( pxAduImage->ucErased ) );
+
+    AZLogInfo( ( "AzureIoTPlatform_Init: running from bank %u, updating bank %u",
+                 pxAduImage->ulActiveBank, 1U - pxAduImage->ulActiveBank ) );
+
+    return eAzureIoTSuccess;
+}
+/*-----------------------------------------------------------*/
+
+int64_t AzureIoTPlatform_GetSingleFlashBootBankSize()
+{
+    return azureiotflashposixBANK_SIZE;
+}
+/*-----------------------------------------------------------*/
+
+uint32_t AzureIoTPlatform_GetProgramPageSize( AzureADUImage_t * const pxAduImage )
+{
+    ( void ) pxAduImage;
+
+    return azureiotflashposixPAGE_SIZE;
+}
+/*-----------------------------------------------------------*/
+
+uint32_t AzureIoTPlatform_GetEraseSectorSize( AzureADUImage_t * const pxAduImage )
+{
+    ( void ) pxAduImage;
+
+    return azureiotflashposixSECTOR_SIZE;
+}
+/*-----------------------------------------------------------*/
+
+AzureIoTResult_t AzureIoTPlatform_WriteBlock( AzureADUImage_t * const pxAduImage,
+                                              uint32_t ulOffset,
+                                              uint8_t * const pData,
+                                              uint32_t ulBlockSize )
+{
+    uint8_t * pucBank;
+    uint64_t ullDelay = 0;
+    uint32_t ulEnd = ulOffset + ulBlockSize;
+    uint32_t ulSector;
+    uint32_t ulIndex;
+
+    if( ( pxAduImage == NULL ) || ( pData == NULL ) || ( pxAduImage->pucBanks[ 0 ] == NULL ) )
+    {
+        AZLogError( ( "AzureIoTPlatform_WriteBlock failed: invalid argument" ) );
+        return eAzureIoTErrorInvalidArgument;
+    }
+
+    if( ( ulBlockSize > azureiotflashposixBANK_SIZE ) || ( ulOffset > ( azureiotflashposixBANK_SIZE - ulBlockSize ) ) )
+    {
+        AZLogError( ( "AzureIoTPlatform_WriteBlock failed: %u bytes at offset %u past the end of the bank",
+                      ulBlockSize, ulOffset ) );
+        return eAzureIoTErrorOutOfMemory;
+    }
+
+    pucBank = prvGetUpdateBank( pxAduImage );
+
+    /* Erase the sectors the write starts, unless they are blank already. */
+    for( ulSector = ( ulOffset + azureiotflashposixSECTOR_SIZE - 1U ) / azureiotflashposixSECTOR_SIZE;
+         ( ulSector * azureiotflashposixSECTOR_SIZE ) < ulEnd; ulSector++ )
+    {
+        if( ( pxAduImage->ucErased[ ulSector / 8U ] & ( 1U << ( ulSector % 8U ) ) ) == 0 )
+        {
+            if( !prvIsBlank( pucBank + ulSector * azureiotflashposixSECTOR_SIZE, azureiotflashposixSECTOR_SIZE ) )
+            {
+                memset( pucBank + ulSector * azureiotflashposixSECTOR_SIZE, 0xFF, azureiotflashposixSECTOR_SIZE );
+                pxAduImage->ulEraseCount++;
+                prvAddBusyTime( pxAduImage, pxAduImage->ulEraseMicroseconds, &ullDelay );
+            }
+
+            pxAduImage->ucErased[ ulSector / 8U ] |= ( uint8_t ) ( 1U << ( ulSector % 8U ) );
+        }
+    }
+
+    /* Programming only clears bits, setting one needs an erase of the whole sector. */
+    for( ulIndex = 0; ulIndex < ulBlockSize; ulIndex++ )
+    {
+        if( ( pucBank[ ulOffset + ulIndex ] & pData[ ulIndex ] ) != pData[ ulIndex ] )
+        {
+            AZLogError( ( "AzureIoTPlatform_WriteBlock failed: offset %u is programmed and its sector is not erased",
+                          ulOffset + ulIndex ) );
+            return eAzureIoTErrorFailed;
+        }
+    }
+
+    for( ulIndex = 0; ulIndex < ulBlockSize; ulIndex++ )
+    {
+        pucBank[ ulOffset + ulIndex ] &= pData[ ulIndex ];
+    }
+
+    if( ulBlockSize > 0 )
+    {
+        ulIndex = ( ( ulEnd - 1U ) / azureiotflashposixPAGE_SIZE ) - ( ulOffset / azureiotflashposixPAGE_SIZE ) + 1U;
+        pxAduImage->ulProgramCount += ulIndex;
+        prvAddBusyTime( pxAduImage, ( uint64_t ) ulIndex * pxAduImage->ulProgramMicroseconds, &ullDelay );
+    }
+
+    if( pxAduImage->ulImageSize < ulEnd )
+    {
+        pxAduImage->ulImageSize = ulEnd;
+    }
+
+    if( ullDelay > 0 )
+    {
+        ( void ) usleep( ( useconds_t ) ullDelay );
+    }
+
+    return eAzureIoTSuccess;
+}
+/*-----------------------------------------------------------*/
+
+AzureIoTResult_t AzureIoTPlatform_ReadActiveBlock( AzureADUImage_t * const pxAduImage,
+                                                   uint32_t ulOffset,
+                                                   uint8_t * const pData,
+                                                   uint32_t ulBlockSize )
+{
+    if( ( pxAduImage == NULL ) || ( pData == NULL ) || ( pxAduImage->pucBanks[ 0 ] == NULL ) ||
+        ( ulBlockSize > azureiotflashposixBANK_SIZE ) || ( ulOffset > ( azureiotflashposixBANK_SIZE - ulBlockSize ) ) )
+    {
+        AZLogError( ( "AzureIoTPlatform_ReadActiveBlock failed: invalid argument" ) );
+        return eAzureIoTErrorInvalidArgument;
+    }
+
+    memcpy( pData, pxAduImage->pucBanks[ pxAduImage->ulActiveBank ] + ulOffset, ulBlockSize );
+
+    return eAzureIoTSuccess;
+}
+/*-----------------------------------------------------------*/
+
+AzureIoTResult_t AzureIoTPlatform_VerifyImage( AzureADUImage_t * const pxAduImage,
+                                               uint8_t * pucSHA256Hash,
+                                               uint32_t ulSHA256HashLength )
+{
+    AzureIoTCryptoSHA256Context_t xContext;
+    AzureIoTResult_t xResult;
+    az_result xCoreResult;
+    uint8_t ucExpected[ azureiotcryptoSHA256_SIZE ];
+    uint8_t ucActual[ azureiotcryptoSHA256_SIZE ];
+    int32_t lExpectedLength;
+
+    if( ( pxAduImage == NULL ) || ( pucSHA256Hash == NULL ) || ( pxAduImage->pucBanks[ 0 ] == NULL ) )
+    {
+        AZLogError( ( "AzureIoTPlatform_VerifyImage failed: invalid argument" ) );
+        return eAzureIoTErrorInvalidArgument;
+    }
+
+    /* The hash is base64 encoded, as in the update manifest. */
+    if( az_result_failed( xCoreResult = az_base64_decode( az_span_create( ucExpected, sizeof( ucExpected ) ),
+                                                          az_span_create( pucSHA256Hash, ( int32_t ) ulSHA256HashLength ),
+                                                          &lExpectedLength ) ) ||
+        ( lExpectedLength != ( int32_t ) sizeof( ucExpected ) ) )
+    {
+        AZLogError( ( "AzureIoTPlatform_VerifyImage failed: invalid hash" ) );
+        return eAzureIoTErrorInvalidArgument;
+    }
+
+    if( ( ( xResult = AzureIoTCrypto_SHA256Init( &xContext ) ) != eAzureIoTSuccess ) ||
+        ( ( xResult = AzureIoTCrypto_SHA256Update( &xContext, prvGetUpdateBank( pxAduImage ),
+                                                   pxAduImage->ulImageSize ) ) != eAzureIoTSuccess ) ||
+        ( ( xResult = AzureIoTCrypto_SHA256Final( &xContext, ucActual, sizeof( ucActual ) ) ) != eAzureIoTSuccess ) )
+    {
+        AZLogError( ( "AzureIoTPlatform_VerifyImage failed to hash image: error=0x%08x", ( uint16_t ) xResult ) );
+        return xResult;
+    }
+
+    if( memcmp( ucExpected, ucActual, sizeof( ucExpected ) ) != 0 )
+    {
+        AZLogError( ( "AzureIoTPlatform_VerifyImage failed: image of %u bytes does not match the hash", pxAduImage->ulImageSize ) );
+        return eAzureIoTErrorFailed;
+    }
+
+    return eAzureIoTSuccess;
+}
+/*-----------------------------------------------------------*/
+
+AzureIoTResult_t AzureIoTPlatform_SaveCheckpoint( AzureADUImage_t * const pxAduImage,
+                                                  const uint8_t * pucCheckpoint,
+                                                  uint32_t ulCheckpointLength )
+{
+    if( ( pxAduImage == NULL ) || ( pucCheckpoint == NULL ) || ( ulCheckpointLength > azureiotflashposixCHECKPOINT_SIZE ) )
+    {
+        AZLogError( ( "AzureIoTPlatform_SaveCheckpoint failed: invalid argument" ) );
+        return eAzureIoTErrorInvalidArgument;
+    }
+
+    /* The checkpoint may cover bytes only in the page cache of the bank so far. */
+    if( ( pxAduImage->pucBanks[ 0 ] != NULL ) &&
+        ( msync( prvGetUpdateBank( pxAduImage ), azureiotflashposixBANK_SIZE, MS_SYNC ) != 0 ) )
+    {
+        AZLogError( ( "AzureIoTPlatform_SaveCheckpoint failed to sync bank: errno=%d", errno ) );
+        return eAzureIoTErrorFailed;
+    }
+
+    return prvSaveFile( pxAduImage, "checkpoint.bin", pucCheckpoint, ulCheckpointLength );
+}
+/*-----------------------------------------------------------*/
+
+AzureIoTResult_t AzureIoTPlatform_LoadCheckpoint( AzureADUImage_t * const pxAduImage,
+                                                  uint8_t * pucCheckpoint,
+                                                  uint32_t ulCheckpointLength )
+{
+    if( ( pxAduImage == NULL ) || ( pucCheckpoint == NULL ) )
+    {
+        AZLogError( ( "AzureIoTPlatform_LoadCheckpoint failed: invalid argument" ) );
+        return eAzureIoTErrorInvalidArgument;
+    }
+
+    return prvLoadFile( pxAduImage, "checkpoint.bin", pucCheckpoint, ulCheckpointLength );
+}
+/*-----------------------------------------------------------*/
+
+AzureIoTResult_t AzureIoTPlatform_EnableImage( AzureADUImage_t * const pxAduImage )
+{
+    AzureIoTFlashPOSIXBootState_t xBootState;
+
+    if( ( pxAduImage == NULL ) || ( pxAduImage->pucBanks[ 0 ] == NULL ) )
+    {
+        AZLogError( ( "AzureIoTPlatform_EnableImage failed: invalid argument" ) );
+        return eAzureIoTErrorInvalidArgument;
+    }
+
+    xBootState.ulActiveBank = pxAduImage->ulActiveBank;
+    xBootState.ulPendingBank = 1U - pxAduImage->ulActiveBank;
+
+    return prvSaveFile( pxAduImage, "boot.bin", &xBootState, sizeof( xBootState ) );
+}
+/*-----------------------------------------------------------*/
+
+AzureIoTResult_t AzureIoTPlatform_ResetDevice( AzureADUImage_t * const pxAduImage )
+{
+    AzureIoTFlashPOSIXBootState_t xBootState;
+    AzureIoTResult_t xResult;
+
+    if( ( pxAduImage == NULL ) || ( pxAduImage->pcDirectory == NULL ) )
+    {
+        AZLogError( ( "AzureIoTPlatform_ResetDevice failed: invalid argument" ) );
+        return eAzureIoTErrorInvalidArgument;
+    }
+
+    prvUnmapBanks( pxAduImage );
+
+    /* The boot loader switches to the enabled bank. */
+    if( ( prvLoadFile( pxAduImage, "boot.bin", &xBootState, sizeof( xBootState ) ) == eAzureIoTSuccess ) &&
+        ( xBootState.ulPendingBank <= 1 ) )
+    {
+        xBootState.ulActiveBank = xBootState.ulPendingBank;
+        xBootState.ulPendingBank = azureiotflashposixNO_BANK;
+
+        if( ( xResult = prvSaveFile( pxAduImage, "boot.bin", &xBootState, sizeof( xBootState ) ) ) != eAzureIoTSuccess )
+        {
+            return xResult;
+        }
+
+        AZLogInfo( ( "AzureIoTPlatform_ResetDevice: booting bank %u", xBootState.ulActiveBank ) );
+    }
+
+    pxAduImage->ulResetCount++;
+
+    /* The banks are mapped again by AzureIoTPlatform_Init(), as after a real reset. */
+    if( pxAduImage->xResetCallback != NULL )
+    {
+        pxAduImage->xResetCallback( pxAduImage );
+    }
+
+    return eAzureIoTSuccess;
+}
+/*-----------------------------------------------------------*/
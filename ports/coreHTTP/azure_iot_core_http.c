@@ -10,6 +10,7 @@
 #include "core_http_client.h"
 /* Kernel includes. */
 #include "FreeRTOS.h"
+#include "task.h"
 
 static AzureIoTHTTPResult_t prvTranslateToAzureIoTHTTPResult( HTTPStatus_t xResult )
 {
@@ -70,23 +71,316 @@ static AzureIoTHTTPResult_t prvTranslateToAzureIoTHTTPResult( HTTPStatus_t xResu
     return eAzureIoTHTTPError;
 }
 
+/* Length of the headers up to and including the blank line, 0 if not received yet. */
+static uint32_t prvFindHeadersEnd( const char * pucBuffer,
+                                   uint32_t ulLength )
+{
+    uint32_t ulIndex;
 
-AzureIoTHTTPResult_t AzureIoTHTTP_Init( AzureIoTHTTPHandle_t xHTTPHandle,
-                                        AzureIoTTransportInterface_t * pxHTTPTransport,
-                                        const char * pucURL,
-                                        uint32_t ulURLLength,
-                                        const char * pucPath,
-                                        uint32_t ulPathLength,
-                                        char * pucHeaderBuffer,
-                                        uint32_t ulHeaderBufferLength )
+    for( ulIndex = 3; ulIndex < ulLength; ulIndex++ )
+    {
+        if( ( pucBuffer[ ulIndex - 3 ] == '\r' ) && ( pucBuffer[ ulIndex - 2 ] == '\n' ) &&
+            ( pucBuffer[ ulIndex - 1 ] == '\r' ) && ( pucBuffer[ ulIndex ] == '\n' ) )
+        {
+            return ulIndex + 1;
+        }
+    }
+
+    return 0;
+}
+
+/* Status code of "HTTP/1.x SSS ...", 0 if malformed. */
+static uint32_t prvParseStatusCode( const char * pucHeaders,
+                                    uint32_t ulHeadersLength )
 {
-    HTTPStatus_t xHttpLibraryStatus = HTTPSuccess;
+    uint32_t ulStatusCode = 0;
+    uint32_t ulIndex;
 
-    if( xHTTPHandle == NULL )
+    if( ( ulHeadersLength < 12 ) || ( strncmp( pucHeaders, "HTTP/1.", 7 ) != 0 ) || ( pucHeaders[ 8 ] != ' ' ) )
     {
-        return 1;
+        return 0;
+    }
+
+    for( ulIndex = 9; ulIndex < 12; ulIndex++ )
+    {
+        if( ( pucHeaders[ ulIndex ] < '0' ) || ( pucHeaders[ ulIndex ] > '9' ) )
+        {
+            return 0;
+        }
+
+        ulStatusCode = ulStatusCode * 10 + ( uint32_t ) ( pucHeaders[ ulIndex ] - '0' );
+    }
+
+    return ulStatusCode;
+}
+
+static bool prvEqualsIgnoreCase( const char * pucText,
+                                 const char * pucLowerCase,
+                                 uint32_t ulLength )
+{
+    uint32_t ulIndex;
+    char ucChar;
+
+    for( ulIndex = 0; ulIndex < ulLength; ulIndex++ )
+    {
+        ucChar = pucText[ ulIndex ];
+
+        if( ( ucChar >= 'A' ) && ( ucChar <= 'Z' ) )
+        {
+            ucChar = ( char ) ( ucChar - 'A' + 'a' );
+        }
+
+        if( ucChar != pucLowerCase[ ulIndex ] )
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/* Value of the header \p pucName, given in lower case with its colon, without the leading spaces. */
+static bool prvFindHeader( const char * pucHeaders,
+                           uint32_t ulHeadersLength,
+                           const char * pucName,
+                           const char ** ppucValue,
+                           uint32_t * pulValueLength )
+{
+    uint32_t ulNameLength = ( uint32_t ) strlen( pucName );
+    uint32_t ulLine = 0;
+    uint32_t ulIndex;
+
+    while( ulLine < ulHeadersLength )
+    {
+        if( ( ( ulHeadersLength - ulLine ) > ulNameLength ) &&
+            prvEqualsIgnoreCase( pucHeaders + ulLine, pucName, ulNameLength ) )
+        {
+            for( ulIndex = ulLine + ulNameLength; ( ulIndex < ulHeadersLength ) && ( pucHeaders[ ulIndex ] == ' ' ); ulIndex++ )
+            {
+            }
+
+            *ppucValue = pucHeaders + ulIndex;
+
+            for( *pulValueLength = 0; ( ulIndex < ulHeadersLength ) && ( pucHeaders[ ulIndex ] != '\r' ); ulIndex++ )
+            {
+                ( *pulValueLength )++;
+            }
+
+            return true;
+        }
+
+        /* Next line. */
+        while( ( ulLine < ulHeadersLength ) && ( pucHeaders[ ulLine ] != '\n' ) )
+        {
+            ulLine++;
+        }
+
+        ulLine++;
     }
 
+    return false;
+}
+
+/* Decimal number starting at *pulIndex, moving *pulIndex past it. False if there is none, or it does not fit. */
+static bool prvParseNumber( const char * pucText,
+                            uint32_t ulLength,
+                            uint32_t * pulIndex,
+                            int32_t * plValue )
+{
+    uint32_t ulStart = *pulIndex;
+
+    *plValue = 0;
+
+    while( ( *pulIndex < ulLength ) && ( pucText[ *pulIndex ] >= '0' ) && ( pucText[ *pulIndex ] <= '9' ) )
+    {
+        if( *plValue > ( ( INT32_MAX - 9 ) / 10 ) )
+        {
+            return false;
+        }
+
+        *plValue = *plValue * 10 + ( int32_t ) ( pucText[ *pulIndex ] - '0' );
+        ( *pulIndex )++;
+    }
+
+    return *pulIndex > ulStart;
+}
+
+/* Value of the Content-Length header, -1 if missing or malformed. */
+static int32_t prvParseContentLength( const char * pucHeaders,
+                                      uint32_t ulHeadersLength )
+{
+    const char * pucValue;
+    uint32_t ulValueLength;
+    uint32_t ulIndex = 0;
+    int32_t lValue;
+
+    if( !prvFindHeader( pucHeaders, ulHeadersLength, "content-length:", &pucValue, &ulValueLength ) ||
+        !prvParseNumber( pucValue, ulValueLength, &ulIndex, &lValue ) || ( ulIndex != ulValueLength ) )
+    {
+        return -1;
+    }
+
+    return lValue;
+}
+
+/* First and last byte of "Content-Range: bytes F-L/T", false if missing or malformed. */
+static bool prvParseContentRange( const char * pucHeaders,
+                                  uint32_t ulHeadersLength,
+                                  int32_t * plFirst,
+                                  int32_t * plLast )
+{
+    const char * pucValue;
+    uint32_t ulValueLength;
+    uint32_t ulIndex = 6;
+
+    return prvFindHeader( pucHeaders, ulHeadersLength, "content-range:", &pucValue, &ulValueLength ) &&
+           ( ulValueLength > ulIndex ) && prvEqualsIgnoreCase( pucValue, "bytes ", ulIndex ) &&
+           prvParseNumber( pucValue, ulValueLength, &ulIndex, plFirst ) &&
+           ( ulIndex < ulValueLength ) && ( pucValue[ ulIndex++ ] == '-' ) &&
+           prvParseNumber( pucValue, ulValueLength, &ulIndex, plLast ) &&
+           ( ulIndex < ulValueLength ) && ( pucValue[ ulIndex ] == '/' ) &&
+           ( *plFirst <= *plLast );
+}
+
+/* Whether the server closes the connection after this response. */
+static bool prvIsConnectionClose( const char * pucHeaders,
+                                  uint32_t ulHeadersLength )
+{
+    const char * pucValue;
+    uint32_t ulValueLength;
+
+    return prvFindHeader( pucHeaders, ulHeadersLength, "connection:", &pucValue, &ulValueLength ) &&
+           ( ulValueLength == 5 ) && prvEqualsIgnoreCase( pucValue, "close", 5 );
+}
+
+static uint32_t prvGetTimeMs( void )
+{
+    return ( uint32_t ) xTaskGetTickCount() * azureiotMILLISECONDS_PER_TICK;
+}
+
+/* Wait before trying a send or receive which moved no data again, at least one tick so lower priority tasks run. */
+static void prvRetryDelay( void )
+{
+    TickType_t xTicks = pdMS_TO_TICKS( azureiothttpSTREAM_RETRY_DELAY_MS );
+
+    vTaskDelay( ( xTicks > 0 ) ? xTicks : 1 );
+}
+
+/* Receive at least one byte, retrying reads that return nothing for up to azureiothttpSTREAM_RETRY_TIMEOUT_MS. */
+static int32_t prvReceive( AzureIoTHTTPHandle_t xHTTPHandle,
+                           char * pucBuffer,
+                           uint32_t ulLength )
+{
+    uint32_t ulStartMs = prvGetTimeMs();
+    int32_t lReceived;
+
+    while( ( lReceived = xHTTPHandle->pxHTTPTransport->xRecv( xHTTPHandle->pxHTTPTransport->pxNetworkContext,
+                                                              pucBuffer, ulLength ) ) == 0 )
+    {
+        if( ( prvGetTimeMs() - ulStartMs ) >= azureiothttpSTREAM_RETRY_TIMEOUT_MS )
+        {
+            break;
+        }
+
+        prvRetryDelay();
+    }
+
+    return lReceived;
+}
+
+/* Send the request headers, which end with the blank line as there is no request body. */
+static AzureIoTHTTPResult_t prvSendHeaders( AzureIoTHTTPHandle_t xHTTPHandle )
+{
+    uint32_t ulSent = 0;
+    uint32_t ulLastProgressMs = prvGetTimeMs();
+    int32_t lBytes;
+
+    while( ulSent < xHTTPHandle->xRequestHeaders.headersLen )
+    {
+        lBytes = xHTTPHandle->pxHTTPTransport->xSend( xHTTPHandle->pxHTTPTransport->pxNetworkContext,
+                                                      xHTTPHandle->xRequestHeaders.pBuffer + ulSent,
+                                                      xHTTPHandle->xRequestHeaders.headersLen - ulSent );
+
+        if( ( lBytes < 0 ) ||
+            ( ( lBytes == 0 ) && ( ( prvGetTimeMs() - ulLastProgressMs ) >= azureiothttpSTREAM_RETRY_TIMEOUT_MS ) ) )
+        {
+            SdkLog( ( "[HTTP] Send failed %d\r\n", ( int ) lBytes ) );
+            return eAzureIoTHTTPNetworkError;
+        }
+
+        if( lBytes > 0 )
+        {
+            ulSent += ( uint32_t ) lBytes;
+            ulLastProgressMs = prvGetTimeMs();
+        }
+        else
+        {
+            prvRetryDelay();
+        }
+    }
+
+    return eAzureIoTHTTPSuccess;
+}
+
+static AzureIoTHTTPResult_t prvReconnect( AzureIoTHTTPHandle_t xHTTPHandle )
+{
+    int32_t lResult;
+
+    /* Responses still expected on the old connection are lost with it. */
+    xHTTPHandle->xPipelined = false;
+
+    if( ( lResult = xHTTPHandle->xConnect( xHTTPHandle->pvConnectContext, xHTTPHandle->pxHTTPTransport ) ) != 0 )
+    {
+        SdkLog( ( "[HTTP] Reconnect failed %d\r\n", ( int ) lResult ) );
+        xHTTPHandle->xConnectionClosed = true;
+        return eAzureIoTHTTPNetworkError;
+    }
+
+    SdkLog( ( "[HTTP] Reconnected\r\n" ) );
+    xHTTPHandle->xConnectionClosed = false;
+    xHTTPHandle->ulReconnectCount++;
+
+    return eAzureIoTHTTPSuccess;
+}
+
+/* Reconnect first if the connection is closed, or busy with a response nobody will read. */
+static AzureIoTHTTPResult_t prvPrepareConnection( AzureIoTHTTPHandle_t xHTTPHandle )
+{
+    if( xHTTPHandle->xPipelined )
+    {
+        xHTTPHandle->xPipelined = false;
+        xHTTPHandle->xConnectionClosed = true;
+    }
+
+    if( xHTTPHandle->xConnectionClosed && ( xHTTPHandle->xConnect != NULL ) )
+    {
+        return prvReconnect( xHTTPHandle );
+    }
+
+    return eAzureIoTHTTPSuccess;
+}
+
+/* A request that failed before any response may have been sent on a connection the server closed. */
+static bool prvShouldRetry( AzureIoTHTTPHandle_t xHTTPHandle,
+                            HTTPStatus_t xHttpLibraryStatus,
+                            uint32_t ulAttempt )
+{
+    return ( ulAttempt == 0 ) && ( xHTTPHandle->xConnect != NULL ) &&
+           ( ( xHttpLibraryStatus == HTTPNetworkError ) || ( xHttpLibraryStatus == HTTPNoResponse ) );
+}
+
+/* Build the headers of a request, without touching the connection. */
+static AzureIoTHTTPResult_t prvInitRequest( AzureIoTHTTPHandle_t xHTTPHandle,
+                                            const char * pucURL,
+                                            uint32_t ulURLLength,
+                                            const char * pucPath,
+                                            uint32_t ulPathLength,
+                                            const char * pucMethod,
+                                            char * pucHeaderBuffer,
+                                            uint32_t ulHeaderBufferLength )
+{
+    HTTPStatus_t xHttpLibraryStatus = HTTPSuccess;
+
     ( void ) memset( &xHTTPHandle->xRequestInfo, 0, sizeof( xHTTPHandle->xRequestInfo ) );
     ( void ) memset( &xHTTPHandle->xRequestHeaders, 0, sizeof( xHTTPHandle->xRequestHeaders ) );
     ( void ) memset( &xHTTPHandle->xResponse, 0, sizeof( xHTTPHandle->xResponse ) );
@@ -98,17 +392,95 @@ AzureIoTHTTPResult_t AzureIoTHTTP_Init( AzureIoTHTTPHandle_t xHTTPHandle,
     xHTTPHandle->xRequestInfo.hostLen = ulURLLength;
     xHTTPHandle->xRequestInfo.pPath = pucPath;
     xHTTPHandle->xRequestInfo.pathLen = ulPathLength;
-    xHTTPHandle->xRequestInfo.pMethod = "GET";
-    xHTTPHandle->xRequestInfo.methodLen = strlen( "GET" );
+    xHTTPHandle->xRequestInfo.pMethod = pucMethod;
+    xHTTPHandle->xRequestInfo.methodLen = strlen( pucMethod );
     xHTTPHandle->xRequestInfo.reqFlags |= HTTP_REQUEST_KEEP_ALIVE_FLAG;
 
-    xHTTPHandle->pxHTTPTransport = pxHTTPTransport;
-
     HTTPClient_InitializeRequestHeaders( &xHTTPHandle->xRequestHeaders, &xHTTPHandle->xRequestInfo );
 
     return prvTranslateToAzureIoTHTTPResult( xHttpLibraryStatus );
 }
 
+/* A new connection, which is not reopened when the server closes it. */
+static void prvInitConnectionState( AzureIoTHTTPHandle_t xHTTPHandle,
+                                    AzureIoTTransportInterface_t * pxHTTPTransport )
+{
+    xHTTPHandle->pxHTTPTransport = pxHTTPTransport;
+    xHTTPHandle->xConnect = NULL;
+    xHTTPHandle->pvConnectContext = NULL;
+    xHTTPHandle->xConnectionClosed = false;
+    xHTTPHandle->ulReconnectCount = 0;
+    xHTTPHandle->xNextRange = false;
+    xHTTPHandle->xPipelined = false;
+}
+
+AzureIoTHTTPResult_t AzureIoTHTTP_InitConnection( AzureIoTHTTPHandle_t xHTTPHandle,
+                                                  AzureIoTTransportInterface_t * pxHTTPTransport,
+                                                  AzureIoTTransportConnect_t xConnect,
+                                                  void * pvConnectContext )
+{
+    if( ( xHTTPHandle == NULL ) || ( pxHTTPTransport == NULL ) )
+    {
+        return eAzureIoTHTTPInvalidParameter;
+    }
+
+    xHTTPHandle->pxHTTPTransport = pxHTTPTransport;
+    xHTTPHandle->xConnect = xConnect;
+    xHTTPHandle->pvConnectContext = pvConnectContext;
+
+    return eAzureIoTHTTPSuccess;
+}
+
+AzureIoTHTTPResult_t AzureIoTHTTP_Init( AzureIoTHTTPHandle_t xHTTPHandle,
+                                        AzureIoTTransportInterface_t * pxHTTPTransport,
+                                        const char * pucURL,
+                                        uint32_t ulURLLength,
+                                        const char * pucPath,
+                                        uint32_t ulPathLength,
+                                        char * pucHeaderBuffer,
+                                        uint32_t ulHeaderBufferLength )
+{
+    if( xHTTPHandle == NULL )
+    {
+        return 1;
+    }
+
+    prvInitConnectionState( xHTTPHandle, pxHTTPTransport );
+
+    return prvInitRequest( xHTTPHandle, pucURL, ulURLLength, pucPath, ulPathLength,
+                           "GET", pucHeaderBuffer, ulHeaderBufferLength );
+}
+
+AzureIoTHTTPResult_t AzureIoTHTTP_InitNextRequest( AzureIoTHTTPHandle_t xHTTPHandle )
+{
+    if( xHTTPHandle == NULL )
+    {
+        return eAzureIoTHTTPInvalidParameter;
+    }
+
+    return prvInitRequest( xHTTPHandle,
+                           xHTTPHandle->xRequestInfo.pHost, ( uint32_t ) xHTTPHandle->xRequestInfo.hostLen,
+                           xHTTPHandle->xRequestInfo.pPath, ( uint32_t ) xHTTPHandle->xRequestInfo.pathLen,
+                           "GET", ( char * ) xHTTPHandle->xRequestHeaders.pBuffer,
+                           ( uint32_t ) xHTTPHandle->xRequestHeaders.bufferLen );
+}
+
+AzureIoTHTTPResult_t AzureIoTHTTP_SetNextRange( AzureIoTHTTPHandle_t xHTTPHandle,
+                                                int32_t lRangeStart,
+                                                int32_t lRangeEnd )
+{
+    if( xHTTPHandle == NULL )
+    {
+        return eAzureIoTHTTPInvalidParameter;
+    }
+
+    xHTTPHandle->xNextRange = true;
+    xHTTPHandle->lNextRangeStart = lRangeStart;
+    xHTTPHandle->lNextRangeEnd = lRangeEnd;
+
+    return eAzureIoTHTTPSuccess;
+}
+
 AzureIoTHTTPResult_t AzureIoTHTTP_Request( AzureIoTHTTPHandle_t xHTTPHandle,
                                            int32_t lRangeStart,
                                            int32_t lRangeEnd,
@@ -118,10 +490,17 @@ AzureIoTHTTPResult_t AzureIoTHTTP_Request( AzureIoTHTTPHandle_t xHTTPHandle,
                                            uint32_t * pulOutDataLength )
 {
     HTTPStatus_t xHttpLibraryStatus = HTTPSuccess;
+    AzureIoTHTTPResult_t xResult;
+    uint32_t ulAttempt;
 
     xHTTPHandle->xResponse.pBuffer = ( uint8_t * ) pucDataBuffer;
     xHTTPHandle->xResponse.bufferLen = ulDataBufferLength;
 
+    if( ( xResult = prvPrepareConnection( xHTTPHandle ) ) != eAzureIoTHTTPSuccess )
+    {
+        return xResult;
+    }
+
     if( !( ( lRangeStart == 0 ) && ( lRangeEnd == azureiothttpHttpRangeRequestEndOfFile ) ) )
     {
         /* Add range headers if not the whole image. */
@@ -134,14 +513,31 @@ AzureIoTHTTPResult_t AzureIoTHTTP_Request( AzureIoTHTTPHandle_t xHTTPHandle,
         }
     }
 
-    xHttpLibraryStatus = HTTPClient_Send( ( TransportInterface_t * ) xHTTPHandle->pxHTTPTransport, &xHTTPHandle->xRequestHeaders, NULL, 0, &xHTTPHandle->xResponse, 0 );
+    for( ulAttempt = 0; ; ulAttempt++ )
+    {
+        xHttpLibraryStatus = HTTPClient_Send( ( TransportInterface_t * ) xHTTPHandle->pxHTTPTransport, &xHTTPHandle->xRequestHeaders, NULL, 0, &xHTTPHandle->xResponse, 0 );
+
+        if( !prvShouldRetry( xHTTPHandle, xHttpLibraryStatus, ulAttempt ) ||
+            ( prvReconnect( xHTTPHandle ) != eAzureIoTHTTPSuccess ) )
+        {
+            break;
+        }
+    }
 
     if( xHttpLibraryStatus != HTTPSuccess )
     {
         SdkLog( ( "[HTTP] ERROR: %d\r\n", xHttpLibraryStatus ) );
+
+        /* Part of the response may still be on its way. */
+        xHTTPHandle->xConnectionClosed = true;
         return prvTranslateToAzureIoTHTTPResult( xHttpLibraryStatus );
     }
 
+    if( ( xHTTPHandle->xResponse.respFlags & HTTP_RESPONSE_CONNECTION_CLOSE_FLAG ) != 0 )
+    {
+        xHTTPHandle->xConnectionClosed = true;
+    }
+
     if( xHttpLibraryStatus == HTTPSuccess )
     {
         if( xHTTPHandle->xResponse.statusCode == 200 )
@@ -168,6 +564,211 @@ AzureIoTHTTPResult_t AzureIoTHTTP_Request( AzureIoTHTTPHandle_t xHTTPHandle,
     return prvTranslateToAzureIoTHTTPResult( xHttpLibraryStatus );
 }
 
+/* Send the pipelined request for the next range, while the current body is still to be received. */
+static void prvSendNextRange( AzureIoTHTTPHandle_t xHTTPHandle )
+{
+    xHTTPHandle->xNextRange = false;
+
+    /* The current request was sent, its headers can be rebuilt for the next one. */
+    HTTPClient_InitializeRequestHeaders( &xHTTPHandle->xRequestHeaders, &xHTTPHandle->xRequestInfo );
+
+    if( ( !( ( xHTTPHandle->lNextRangeStart == 0 ) && ( xHTTPHandle->lNextRangeEnd == azureiothttpHttpRangeRequestEndOfFile ) ) &&
+          ( HTTPClient_AddRangeHeader( &xHTTPHandle->xRequestHeaders, xHTTPHandle->lNextRangeStart,
+                                       xHTTPHandle->lNextRangeEnd ) != HTTPSuccess ) ) ||
+        ( prvSendHeaders( xHTTPHandle ) != eAzureIoTHTTPSuccess ) )
+    {
+        /* Not pipelined, the next request is sent as usual. */
+        return;
+    }
+
+    xHTTPHandle->xPipelined = true;
+    xHTTPHandle->lPipelinedRangeStart = xHTTPHandle->lNextRangeStart;
+    xHTTPHandle->lPipelinedRangeEnd = xHTTPHandle->lNextRangeEnd;
+}
+
+AzureIoTHTTPResult_t AzureIoTHTTP_RequestStream( AzureIoTHTTPHandle_t xHTTPHandle,
+                                                 int32_t lRangeStart,
+                                                 int32_t lRangeEnd,
+                                                 char * pucDataBuffer,
+                                                 uint32_t ulDataBufferLength,
+                                                 AzureIoTHTTPBodyCallback_t xBodyCallback,
+                                                 void * pvCallbackContext,
+                                                 uint32_t * pulOutDataLength )
+{
+    HTTPStatus_t xHttpLibraryStatus = HTTPSuccess;
+    AzureIoTHTTPResult_t xResult = eAzureIoTHTTPSuccess;
+    uint32_t ulAttempt;
+    uint32_t ulReceived = 0;
+    uint32_t ulHeadersLength = 0;
+    uint32_t ulStatusCode;
+    uint32_t ulLength;
+    uint32_t ulRemaining;
+    int32_t lContentLength;
+    int32_t lFirst;
+    int32_t lLast;
+    int32_t lBytes = 0;
+    bool xWholeFile = ( lRangeStart == 0 ) && ( lRangeEnd == azureiothttpHttpRangeRequestEndOfFile );
+    bool xSent = false;
+    bool xConnectionClose;
+
+    if( ( xHTTPHandle == NULL ) || ( pucDataBuffer == NULL ) || ( ulDataBufferLength == 0 ) ||
+        ( xBodyCallback == NULL ) || ( pulOutDataLength == NULL ) )
+    {
+        return eAzureIoTHTTPInvalidParameter;
+    }
+
+    *pulOutDataLength = 0;
+
+    /* The response to a pipelined request for this range is already on its way. */
+    if( xHTTPHandle->xPipelined &&
+        ( xHTTPHandle->lPipelinedRangeStart == lRangeStart ) && ( xHTTPHandle->lPipelinedRangeEnd == lRangeEnd ) )
+    {
+        xHTTPHandle->xPipelined = false;
+        xSent = true;
+    }
+    else if( ( xResult = prvPrepareConnection( xHTTPHandle ) ) != eAzureIoTHTTPSuccess )
+    {
+        return xResult;
+    }
+
+    if( !xWholeFile )
+    {
+        /* Add range headers if not the whole image. */
+        xHttpLibraryStatus = HTTPClient_AddRangeHeader( &xHTTPHandle->xRequestHeaders, lRangeStart, lRangeEnd );
+
+        if( xHttpLibraryStatus != HTTPSuccess )
+        {
+            return prvTranslateToAzureIoTHTTPResult( xHttpLibraryStatus );
+        }
+    }
+
+    for( ulAttempt = 0; ; ulAttempt++ )
+    {
+        xResult = xSent ? eAzureIoTHTTPSuccess : prvSendHeaders( xHTTPHandle );
+        xSent = false;
+
+        /* Receive the headers, and possibly the start of the body with them. */
+        while( ( xResult == eAzureIoTHTTPSuccess ) &&
+               ( ( ulHeadersLength = prvFindHeadersEnd( pucDataBuffer, ulReceived ) ) == 0 ) )
+        {
+            if( ulReceived == ulDataBufferLength )
+            {
+                SdkLog( ( "[HTTP] Stream response headers larger than %u\r\n", ( unsigned int ) ulDataBufferLength ) );
+                xResult = eAzureIoTHTTPSecurityAlertResponseHeadersSizeLimitExceeded;
+            }
+            else if( ( lBytes = prvReceive( xHTTPHandle, pucDataBuffer + ulReceived, ulDataBufferLength - ulReceived ) ) <= 0 )
+            {
+                xResult = ( lBytes < 0 ) ? eAzureIoTHTTPNetworkError :
+                          ( ulReceived == 0 ) ? eAzureIoTHTTPNoResponse : eAzureIoTHTTPPartialResponse;
+            }
+            else
+            {
+                ulReceived += ( uint32_t ) lBytes;
+            }
+        }
+
+        if( ( ulReceived > 0 ) || ( ulAttempt > 0 ) || ( xHTTPHandle->xConnect == NULL ) ||
+            ( ( xResult != eAzureIoTHTTPNetworkError ) && ( xResult != eAzureIoTHTTPNoResponse ) ) ||
+            ( prvReconnect( xHTTPHandle ) != eAzureIoTHTTPSuccess ) )
+        {
+            break;
+        }
+    }
+
+    if( xResult != eAzureIoTHTTPSuccess )
+    {
+        xHTTPHandle->xConnectionClosed = true;
+        return xResult;
+    }
+
+    ulStatusCode = prvParseStatusCode( pucDataBuffer, ulHeadersLength );
+    xConnectionClose = prvIsConnectionClose( pucDataBuffer, ulHeadersLength );
+    lContentLength = prvParseContentLength( pucDataBuffer, ulHeadersLength );
+
+    /* A 200 to a range request is the whole file, which the caller did not ask for. */
+    if( ( ulStatusCode != 206 ) && !( ( ulStatusCode == 200 ) && xWholeFile ) )
+    {
+        SdkLog( ( "[HTTP] Stream failed %u\r\n", ( unsigned int ) ulStatusCode ) );
+        xResult = ( ulStatusCode == 0 ) ? eAzureIoTHTTPSecurityAlertInvalidStatusCode : eAzureIoTHTTPError;
+    }
+    else if( lContentLength < 0 )
+    {
+        xResult = eAzureIoTHTTPSecurityAlertInvalidContentLength;
+    }
+    else if( ( ulReceived - ulHeadersLength ) > ( uint32_t ) lContentLength )
+    {
+        xResult = eAzureIoTHTTPSecurityAlertExtraneousResponseData;
+    }
+    else if( ( ulStatusCode == 206 ) &&
+             ( !prvParseContentRange( pucDataBuffer, ulHeadersLength, &lFirst, &lLast ) ||
+               ( lFirst != lRangeStart ) || ( ( lLast - lFirst ) != ( lContentLength - 1 ) ) ||
+               ( ( lRangeEnd != azureiothttpHttpRangeRequestEndOfFile ) && ( lLast > lRangeEnd ) ) ) )
+    {
+        /* A range the caller did not ask for would be written at the wrong offset. */
+        SdkLog( ( "[HTTP] Stream range does not match %i to %i\r\n", ( int ) lRangeStart, ( int ) lRangeEnd ) );
+        xResult = eAzureIoTHTTPInvalidResponse;
+    }
+
+    if( xResult != eAzureIoTHTTPSuccess )
+    {
+        /* The rest of the response is not read, the connection cannot be used anymore. */
+        xHTTPHandle->xConnectionClosed = true;
+        return xResult;
+    }
+
+    if( xHTTPHandle->xNextRange && !xConnectionClose )
+    {
+        prvSendNextRange( xHTTPHandle );
+    }
+
+    ulRemaining = ( uint32_t ) lContentLength;
+    ulLength = ulReceived - ulHeadersLength;
+
+    /* The body is handed over straight from the receive buffer, the headers are not needed anymore. */
+    if( ulLength > 0 )
+    {
+        xResult = xBodyCallback( pvCallbackContext, ( const uint8_t * ) pucDataBuffer + ulHeadersLength, ulLength );
+
+        if( xResult == eAzureIoTHTTPSuccess )
+        {
+            *pulOutDataLength += ulLength;
+            ulRemaining -= ulLength;
+        }
+    }
+
+    /* Only this body is read, the response to a pipelined request stays on the connection. */
+    while( ( xResult == eAzureIoTHTTPSuccess ) && ( ulRemaining > 0 ) )
+    {
+        ulLength = ( ulRemaining < ulDataBufferLength ) ? ulRemaining : ulDataBufferLength;
+
+        if( ( lBytes = prvReceive( xHTTPHandle, pucDataBuffer, ulLength ) ) <= 0 )
+        {
+            SdkLog( ( "[HTTP] Stream ended %u bytes early\r\n", ( unsigned int ) ulRemaining ) );
+            xResult = ( lBytes < 0 ) ? eAzureIoTHTTPNetworkError : eAzureIoTHTTPPartialResponse;
+        }
+        else if( ( xResult = xBodyCallback( pvCallbackContext, ( const uint8_t * ) pucDataBuffer,
+                                            ( uint32_t ) lBytes ) ) == eAzureIoTHTTPSuccess )
+        {
+            *pulOutDataLength += ( uint32_t ) lBytes;
+            ulRemaining -= ( uint32_t ) lBytes;
+        }
+    }
+
+    if( ( xResult != eAzureIoTHTTPSuccess ) || xConnectionClose )
+    {
+        xHTTPHandle->xPipelined = false;
+        xHTTPHandle->xConnectionClosed = true;
+    }
+
+    if( xResult == eAzureIoTHTTPSuccess )
+    {
+        SdkLog( ( "[HTTP] [Status %u] Streamed range %i to %i\r\n", ( unsigned int ) ulStatusCode,
+                  ( int ) lRangeStart, ( int ) ( lRangeStart + lContentLength ) ) );
+    }
+
+    return xResult;
+}
+
 AzureIoTHTTPResult_t AzureIoTHTTP_RequestSizeInit( AzureIoTHTTPHandle_t xHTTPHandle,
                                                    AzureIoTTransportInterface_t * pxHTTPTransport,
                                                    const char * pucURL,
@@ -177,33 +778,15 @@ AzureIoTHTTPResult_t AzureIoTHTTP_RequestSizeInit( AzureIoTHTTPHandle_t xHTTPHan
                                                    char * pucHeaderBuffer,
                                                    uint32_t ulHeaderBufferLength )
 {
-    HTTPStatus_t xHttpLibraryStatus = HTTPSuccess;
-
     if( xHTTPHandle == NULL )
     {
         return 1;
     }
 
-    ( void ) memset( &xHTTPHandle->xRequestInfo, 0, sizeof( xHTTPHandle->xRequestInfo ) );
-    ( void ) memset( &xHTTPHandle->xRequestHeaders, 0, sizeof( xHTTPHandle->xRequestHeaders ) );
-    ( void ) memset( &xHTTPHandle->xResponse, 0, sizeof( xHTTPHandle->xResponse ) );
-
-    xHTTPHandle->xRequestHeaders.pBuffer = ( uint8_t * ) pucHeaderBuffer;
-    xHTTPHandle->xRequestHeaders.bufferLen = ulHeaderBufferLength;
-
-    xHTTPHandle->xRequestInfo.pHost = pucURL;
-    xHTTPHandle->xRequestInfo.hostLen = ulURLLength;
-    xHTTPHandle->xRequestInfo.pPath = pucPath;
-    xHTTPHandle->xRequestInfo.pathLen = ulPathLength;
-    xHTTPHandle->xRequestInfo.pMethod = "HEAD";
-    xHTTPHandle->xRequestInfo.methodLen = strlen( "HEAD" );
-    xHTTPHandle->xRequestInfo.reqFlags |= HTTP_REQUEST_KEEP_ALIVE_FLAG;
-
-    xHTTPHandle->pxHTTPTransport = pxHTTPTransport;
-
-    HTTPClient_InitializeRequestHeaders( &xHTTPHandle->xRequestHeaders, &xHTTPHandle->xRequestInfo );
+    prvInitConnectionState( xHTTPHandle, pxHTTPTransport );
 
-    return prvTranslateToAzureIoTHTTPResult( xHttpLibraryStatus );
+    return prvInitRequest( xHTTPHandle, pucURL, ulURLLength, pucPath, ulPathLength,
+                           "HEAD", pucHeaderBuffer, ulHeaderBufferLength );
 }
 
 int32_t AzureIoTHTTP_RequestSize( AzureIoTHTTPHandle_t xHTTPHandle,
@@ -211,17 +794,38 @@ int32_t AzureIoTHTTP_RequestSize( AzureIoTHTTPHandle_t xHTTPHandle,
                                   uint32_t ulDataBufferLength )
 {
     HTTPStatus_t xHttpLibraryStatus = HTTPSuccess;
+    uint32_t ulAttempt;
 
     xHTTPHandle->xResponse.pBuffer = ( uint8_t * ) pucDataBuffer;
     xHTTPHandle->xResponse.bufferLen = ulDataBufferLength;
 
-    xHttpLibraryStatus = HTTPClient_Send( ( TransportInterface_t * ) xHTTPHandle->pxHTTPTransport, &xHTTPHandle->xRequestHeaders, NULL, 0, &xHTTPHandle->xResponse, 0 );
+    if( prvPrepareConnection( xHTTPHandle ) != eAzureIoTHTTPSuccess )
+    {
+        return -1;
+    }
+
+    for( ulAttempt = 0; ; ulAttempt++ )
+    {
+        xHttpLibraryStatus = HTTPClient_Send( ( TransportInterface_t * ) xHTTPHandle->pxHTTPTransport, &xHTTPHandle->xRequestHeaders, NULL, 0, &xHTTPHandle->xResponse, 0 );
+
+        if( !prvShouldRetry( xHTTPHandle, xHttpLibraryStatus, ulAttempt ) ||
+            ( prvReconnect( xHTTPHandle ) != eAzureIoTHTTPSuccess ) )
+        {
+            break;
+        }
+    }
 
     if( xHttpLibraryStatus != HTTPSuccess )
     {
+        xHTTPHandle->xConnectionClosed = true;
         return -1;
     }
 
+    if( ( xHTTPHandle->xResponse.respFlags & HTTP_RESPONSE_CONNECTION_CLOSE_FLAG ) != 0 )
+    {
+        xHTTPHandle->xConnectionClosed = true;
+    }
+
     if( xHttpLibraryStatus == HTTPSuccess )
     {
         if( xHTTPHandle->xResponse.statusCode == 200 )
@@ -10,18 +10,49 @@
 #ifndef AZURE_IOT_HTTP_PORT_H
 #define AZURE_IOT_HTTP_PORT_H
 
+#include <stdbool.h>
 #include <stdio.h>
 
 #include "azure_iot_transport_interface.h"
 
 #include "core_http_client.h"
 
+/**
+ * @brief Time in milliseconds without any data sent or received before a streamed request is abandoned.
+ */
+#ifndef azureiothttpSTREAM_RETRY_TIMEOUT_MS
+    #define azureiothttpSTREAM_RETRY_TIMEOUT_MS    ( 5000U )
+#endif
+
+/**
+ * @brief Time in milliseconds to wait after a send or receive which moved no data, before trying again.
+ *
+ * The wait lets lower priority tasks run, such as the IP task which has to drain the socket.
+ */
+#ifndef azureiothttpSTREAM_RETRY_DELAY_MS
+    #define azureiothttpSTREAM_RETRY_DELAY_MS    ( 10U )
+#endif
+
 typedef struct AzureIoTCoreHTTPContext
 {
     HTTPRequestInfo_t xRequestInfo;
     HTTPRequestHeaders_t xRequestHeaders;
     HTTPResponse_t xResponse;
     AzureIoTTransportInterface_t * pxHTTPTransport;
+
+    /* Connection lifecycle, reset by AzureIoTHTTP_Init(), reconnects set by AzureIoTHTTP_InitConnection(). */
+    AzureIoTTransportConnect_t xConnect;
+    void * pvConnectContext;
+    bool xConnectionClosed;
+    uint32_t ulReconnectCount;
+
+    /* Range to pipeline with the next streamed request, and the one already sent ahead. */
+    bool xNextRange;
+    int32_t lNextRangeStart;
+    int32_t lNextRangeEnd;
+    bool xPipelined;
+    int32_t lPipelinedRangeStart;
+    int32_t lPipelinedRangeEnd;
 } AzureIoTCoreHTTPContext_t;
 
 /* Maps HTTPContext directly to AzureIoTHTTP */
@@ -14,6 +14,15 @@
 
 #include "azure_iot_mqtt.h"
 
+#include "FreeRTOS.h"
+#include "task.h"
+
+/* How long to retry a send which makes no progress, in a streamed publish */
+#define azureiotmqttSEND_RETRY_TIMEOUT_MS    ( 10000U )
+
+/* How long to wait before retrying a send which made no progress, so lower priority tasks can drain the socket */
+#define azureiotmqttSEND_RETRY_DELAY_MS      ( 10U )
+
 /**
  * Maps CoreMQTT errors to AzureIoTMQTT errors.
  **/
@@ -75,6 +84,48 @@ static AzureIoTMQTTResult_t prvTranslateToAzureIoTMQTTResult( MQTTStatus_t xResu
     return xReturn;
 }
 
+/**
+ * Sends all the bytes through the transport of the coreMQTT context.
+ **/
+static MQTTStatus_t prvSendAll( MQTTContext_t * pxContext,
+                                const uint8_t * pucData,
+                                size_t xDataLength )
+{
+    uint32_t ulLastProgressTime = pxContext->getTime();
+    int32_t lBytesSent;
+
+    while( xDataLength > 0 )
+    {
+        lBytesSent = pxContext->transportInterface.send( pxContext->transportInterface.pNetworkContext,
+                                                         pucData, xDataLength );
+
+        if( ( lBytesSent < 0 ) || ( ( size_t ) lBytesSent > xDataLength ) )
+        {
+            return MQTTSendFailed;
+        }
+        else if( lBytesSent > 0 )
+        {
+            pucData += lBytesSent;
+            xDataLength -= ( size_t ) lBytesSent;
+            ulLastProgressTime = pxContext->getTime();
+
+            /* Sent past coreMQTT, which would otherwise ping or time out the keep-alive in a long publish */
+            pxContext->lastPacketTxTime = ulLastProgressTime;
+        }
+        else if( ( pxContext->getTime() - ulLastProgressTime ) > azureiotmqttSEND_RETRY_TIMEOUT_MS )
+        {
+            return MQTTSendFailed;
+        }
+        else
+        {
+            vTaskDelay( ( pdMS_TO_TICKS( azureiotmqttSEND_RETRY_DELAY_MS ) > 0 ) ?
+                        pdMS_TO_TICKS( azureiotmqttSEND_RETRY_DELAY_MS ) : 1 );
+        }
+    }
+
+    return MQTTSuccess;
+}
+
 AzureIoTMQTTResult_t AzureIoTMQTT_Init( AzureIoTMQTTHandle_t xContext,
                                         const AzureIoTTransportInterface_t * pxTransportInterface,
                                         AzureIoTMQTTGetCurrentTimeFunc_t xGetTimeFunction,
@@ -143,6 +194,53 @@ AzureIoTMQTTResult_t AzureIoTMQTT_Publish( AzureIoTMQTTHandle_t xContext,
     return prvTranslateToAzureIoTMQTTResult( xResult );
 }
 
+AzureIoTMQTTResult_t AzureIoTMQTT_PublishHeader( AzureIoTMQTTHandle_t xContext,
+                                                 const AzureIoTMQTTPublishInfo_t * pxPublishInfo )
+{
+    MQTTStatus_t xResult;
+    size_t xRemainingLength;
+    size_t xPacketSize;
+    size_t xHeaderSize;
+
+    /* QoS 1 would need the packet tracked by coreMQTT, which only MQTT_Publish() does */
+    if( ( pxPublishInfo == NULL ) || ( pxPublishInfo->xQOS != eAzureIoTMQTTQoS0 ) )
+    {
+        xResult = MQTTBadParameter;
+    }
+    else if( xContext->connectStatus != MQTTConnected )
+    {
+        xResult = MQTTIllegalState;
+    }
+    else if( ( ( xResult = MQTT_GetPublishPacketSize( ( const MQTTPublishInfo_t * ) pxPublishInfo,
+                                                      &xRemainingLength, &xPacketSize ) ) == MQTTSuccess ) &&
+             ( ( xResult = MQTT_SerializePublishHeader( ( const MQTTPublishInfo_t * ) pxPublishInfo, 0,
+                                                        xRemainingLength, &xContext->networkBuffer,
+                                                        &xHeaderSize ) ) == MQTTSuccess ) )
+    {
+        xResult = prvSendAll( xContext, xContext->networkBuffer.pBuffer, xHeaderSize );
+    }
+
+    return prvTranslateToAzureIoTMQTTResult( xResult );
+}
+
+AzureIoTMQTTResult_t AzureIoTMQTT_PublishPayload( AzureIoTMQTTHandle_t xContext,
+                                                  const uint8_t * pucPayload,
+                                                  size_t xPayloadLength )
+{
+    MQTTStatus_t xResult;
+
+    if( ( pucPayload == NULL ) && ( xPayloadLength > 0 ) )
+    {
+        xResult = MQTTBadParameter;
+    }
+    else
+    {
+        xResult = prvSendAll( xContext, pucPayload, xPayloadLength );
+    }
+
+    return prvTranslateToAzureIoTMQTTResult( xResult );
+}
+
 AzureIoTMQTTResult_t AzureIoTMQTT_Ping( AzureIoTMQTTHandle_t xContext )
 {
     MQTTStatus_t xResult;
@@ -0,0 +1,109 @@
+/* Copyright (c) Microsoft Corporation.
+ * Licensed under the MIT License. */
+
+/**
+ * @file azure_iot_crypto_mbedtls.c
+ * @brief Implements the incremental SHA256 functions of the crypto interface with mbedTLS.
+ *
+ * AzureIoTCrypto_SHA256Calculate() and AzureIoTCrypto_RS256Verify() stay with the application.
+ *
+ */
+
+#include "azure_iot_crypto.h"
+
+#include <stddef.h>
+
+#include "azure_iot_config.h"
+
+#include "mbedtls/version.h"
+#include "mbedtls/sha256.h"
+
+#if !azureiotconfigCRYPTO_PORT_HEADER
+    #error "The mbedTLS crypto port needs azureiotconfigCRYPTO_PORT_HEADER set to 1 in azure_iot_config.h"
+#endif
+
+/* mbedTLS 2.x returns the result of the SHA256 functions with the _ret variants. */
+#if MBEDTLS_VERSION_NUMBER >= 0x03000000
+    #define azureiotcryptoSHA256_STARTS    mbedtls_sha256_starts
+    #define azureiotcryptoSHA256_UPDATE    mbedtls_sha256_update
+    #define azureiotcryptoSHA256_FINISH    mbedtls_sha256_finish
+#else
+    #define azureiotcryptoSHA256_STARTS    mbedtls_sha256_starts_ret
+    #define azureiotcryptoSHA256_UPDATE    mbedtls_sha256_update_ret
+    #define azureiotcryptoSHA256_FINISH    mbedtls_sha256_finish_ret
+#endif
+/*-----------------------------------------------------------*/
+
+AzureIoTResult_t AzureIoTCrypto_SHA256Init( AzureIoTCryptoSHA256Context_t * pxContext )
+{
+    int lMbedTLSResult;
+
+    if( pxContext == NULL )
+    {
+        AZLogError( ( "AzureIoTCrypto_SHA256Init failed: invalid argument" ) );
+        return eAzureIoTErrorInvalidArgument;
+    }
+
+    mbedtls_sha256_init( pxContext );
+
+    if( ( lMbedTLSResult = azureiotcryptoSHA256_STARTS( pxContext, 0 ) ) != 0 )
+    {
+        AZLogError( ( "AzureIoTCrypto_SHA256Init failed: mbedTLS error=0x%08x", ( uint16_t ) lMbedTLSResult ) );
+        mbedtls_sha256_free( pxContext );
+        return eAzureIoTErrorFailed;
+    }
+
+    return eAzureIoTSuccess;
+}
+/*-----------------------------------------------------------*/
+
+AzureIoTResult_t AzureIoTCrypto_SHA256Update( AzureIoTCryptoSHA256Context_t * pxContext,
+                                              const uint8_t * pucInput,
+                                              uint32_t ulInputSize )
+{
+    int lMbedTLSResult;
+
+    if( ( pxContext == NULL ) || ( ( pucInput == NULL ) && ( ulInputSize > 0 ) ) )
+    {
+        AZLogError( ( "AzureIoTCrypto_SHA256Update failed: invalid argument" ) );
+        return eAzureIoTErrorInvalidArgument;
+    }
+
+    if( ( lMbedTLSResult = azureiotcryptoSHA256_UPDATE( pxContext, pucInput, ulInputSize ) ) != 0 )
+    {
+        AZLogError( ( "AzureIoTCrypto_SHA256Update failed: mbedTLS error=0x%08x", ( uint16_t ) lMbedTLSResult ) );
+        return eAzureIoTErrorFailed;
+    }
+
+    return eAzureIoTSuccess;
+}
+/*-----------------------------------------------------------*/
+
+AzureIoTResult_t AzureIoTCrypto_SHA256Final( AzureIoTCryptoSHA256Context_t * pxContext,
+                                             uint8_t * pucOutput,
+                                             uint32_t ulOutputSize )
+{
+    AzureIoTResult_t xResult;
+    int lMbedTLSResult;
+
+    if( ( pxContext == NULL ) || ( pucOutput == NULL ) || ( ulOutputSize < azureiotcryptoSHA256_SIZE ) )
+    {
+        AZLogError( ( "AzureIoTCrypto_SHA256Final failed: invalid argument" ) );
+        return eAzureIoTErrorInvalidArgument;
+    }
+
+    if( ( lMbedTLSResult = azureiotcryptoSHA256_FINISH( pxContext, pucOutput ) ) != 0 )
+    {
+        AZLogError( ( "AzureIoTCrypto_SHA256Final failed: mbedTLS error=0x%08x", ( uint16_t ) lMbedTLSResult ) );
+        xResult = eAzureIoTErrorFailed;
+    }
+    else
+    {
+        xResult = eAzureIoTSuccess;
+    }
+
+    mbedtls_sha256_free( pxContext );
+
+    return xResult;
+}
+/*-----------------------------------------------------------*/
@@ -0,0 +1,27 @@
+/* Copyright (c) Microsoft Corporation.
+ * Licensed under the MIT License. */
+
+/**
+ * @file azure_iot_crypto_port.h
+ * @brief Defines Azure IoT crypto port based on mbedTLS
+ *
+ */
+
+#ifndef AZURE_IOT_CRYPTO_PORT_H
+#define AZURE_IOT_CRYPTO_PORT_H
+
+#include "mbedtls/version.h"
+#include "mbedtls/sha256.h"
+
+/* Maps the mbedTLS SHA256 context directly to the incremental SHA256 context */
+typedef mbedtls_sha256_context AzureIoTCryptoSHA256Context_t;
+
+/* The context changes with the mbedTLS version, and an alternative implementation may hold
+ * hardware state that does not survive a reset. */
+#if defined( MBEDTLS_SHA256_ALT )
+    #define azureiotcryptoSHA256_CONTEXT_LAYOUT    ( 0U )
+#else
+    #define azureiotcryptoSHA256_CONTEXT_LAYOUT    ( ( uint32_t ) MBEDTLS_VERSION_NUMBER )
+#endif
+
+#endif /* AZURE_IOT_CRYPTO_PORT_H */
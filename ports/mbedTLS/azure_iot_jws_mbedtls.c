@@ -3,6 +3,9 @@
 
 #include "azure_iot_jws.h"
 
+#include <stdbool.h>
+#include <string.h>
+
 #include "azure/az_core.h"
 #include "azure/az_iot.h"
 
@@ -11,7 +14,6 @@
 #include "azure_iot_json_reader.h"
 #include "azure_iot_adu_client.h"
 
-#include "mbedtls/base64.h"
 #include "mbedtls/rsa.h"
 #include "mbedtls/pk.h"
 #include "mbedtls/ctr_drbg.h"
@@ -41,20 +43,39 @@ static const uint8_t jws_e_json_value[] = "e";
 static const uint8_t jws_alg_json_value[] = "alg";
 static const uint8_t jws_alg_rs256[] = "RS256";
 
+#if azureiotconfigJWS_SIGNING_KEY_CACHE_SIZE > 0
+
+/* A signing key verified against a root key */
+typedef struct prvJWSSigningKeyCacheEntry
+{
+    uint8_t ucKid[ azureiotconfigJWS_SIGNING_KEY_CACHE_KID_MAX ];
+    uint32_t ulKidLength; /* 0 for an unused entry */
+    uint8_t ucSJWKSHA256[ azureiotjwsSHA256_SIZE ];
+    uint8_t ucRootKeySHA256[ azureiotjwsSHA256_SIZE ];
+} prvJWSSigningKeyCacheEntry_t;
+
+static prvJWSSigningKeyCacheEntry_t xJWSSigningKeyCache[ azureiotconfigJWS_SIGNING_KEY_CACHE_SIZE ];
+static uint32_t ulJWSSigningKeyCacheNext = 0;
+#endif /* azureiotconfigJWS_SIGNING_KEY_CACHE_SIZE > 0 */
+
+/*
+ * The decoded JWS header holds the signed JWK, whose header, payload and signature are decoded in
+ * place, and so are the signing key modulus and exponent inside the JWK payload. The JWS payload and
+ * signature are decoded to their own buffers, leaving the caller's JWS intact.
+ */
 typedef struct prvJWSValidationContext
 {
-    int32_t outParsedManifestShaSize;
     uint8_t * ucJWSHeader;
+    uint8_t * ucJWSPayload;
+    uint8_t * ucJWSSignature;
+    uint8_t * ucSigningInputSHA;
+    uint8_t * ucManifestSHACalculation;
+    uint8_t * ucParsedManifestSha;
     uint8_t * ucJWKHeader;
     uint8_t * ucJWKPayload;
     uint8_t * ucJWKSignature;
-    uint8_t * ucScratchCalculationBuffer;
-    uint8_t * ucJWSPayload;
-    uint8_t * ucJWSSignature;
     uint8_t * ucSigningKeyN;
     uint8_t * ucSigningKeyE;
-    uint8_t * ucManifestSHACalculation;
-    uint8_t * ucParsedManifestSha;
     uint8_t * pucBase64EncodedHeader;
     uint8_t * pucBase64EncodedPayload;
     uint8_t * pucBase64EncodedSignature;
@@ -67,6 +88,7 @@ typedef struct prvJWSValidationContext
     uint32_t ulJWKBase64EncodedHeaderLength;
     uint32_t ulJWKBase64EncodedPayloadLength;
     uint32_t ulJWKBase64EncodedSignatureLength;
+    int32_t outParsedManifestShaSize;
     int32_t outSigningKeyELength;
     int32_t outSigningKeyNLength;
     int32_t outJWSHeaderLength;
@@ -155,56 +177,163 @@ static AzureIoTResult_t prvJWS_SHA256Calculate( const uint8_t * pucInput,
 {
     mbedtls_md_context_t ctx;
     mbedtls_md_type_t md_type = MBEDTLS_MD_SHA256;
+    int32_t lMbedTLSResult;
 
     mbedtls_md_init( &ctx );
-    mbedtls_md_setup( &ctx, mbedtls_md_info_from_type( md_type ), 0 );
-    mbedtls_md_starts( &ctx );
-    mbedtls_md_update( &ctx, pucInput, ulInputLength );
-    mbedtls_md_finish( &ctx, pucOutput );
+    lMbedTLSResult = mbedtls_md_setup( &ctx, mbedtls_md_info_from_type( md_type ), 0 );
+
+    if( lMbedTLSResult == 0 )
+    {
+        lMbedTLSResult = mbedtls_md_starts( &ctx );
+    }
+
+    if( lMbedTLSResult == 0 )
+    {
+        lMbedTLSResult = mbedtls_md_update( &ctx, pucInput, ulInputLength );
+    }
+
+    if( lMbedTLSResult == 0 )
+    {
+        lMbedTLSResult = mbedtls_md_finish( &ctx, pucOutput );
+    }
+
     mbedtls_md_free( &ctx );
 
+    if( lMbedTLSResult != 0 )
+    {
+        AZLogError( ( "[JWS] SHA256 res: %08x", ( uint16_t ) lMbedTLSResult ) );
+        return eAzureIoTErrorFailed;
+    }
+
     return eAzureIoTSuccess;
 }
 
+static int32_t prvJWSBase64Value( uint8_t ucCharacter )
+{
+    if( ( ucCharacter >= 'A' ) && ( ucCharacter <= 'Z' ) )
+    {
+        return ucCharacter - 'A';
+    }
+    else if( ( ucCharacter >= 'a' ) && ( ucCharacter <= 'z' ) )
+    {
+        return ucCharacter - 'a' + 26;
+    }
+    else if( ( ucCharacter >= '0' ) && ( ucCharacter <= '9' ) )
+    {
+        return ucCharacter - '0' + 52;
+    }
+    else if( ( ucCharacter == '+' ) || ( ucCharacter == '-' ) )
+    {
+        return 62;
+    }
+    else if( ( ucCharacter == '/' ) || ( ucCharacter == '_' ) )
+    {
+        return 63;
+    }
+
+    return -1;
+}
+
 /**
- * @brief Verify the manifest via RS256 for the JWS.
+ * @brief Decode base64 or base64url, with or without padding.
  *
- * @param pucInput The input over which the RS256 will be verified.
+ * @param pucInput The encoded input.
  * @param ulInputLength The length of \p pucInput.
+ * @param pucOutput The output buffer. It may be \p pucInput to decode in place: each byte is
+ * written at or before the position of the last character read.
+ * @param ulOutputSize The size of \p pucOutput.
+ * @param plOutputLength The decoded length.
+ * @return AzureIoTResult_t The result of the operation.
+ */
+static AzureIoTResult_t prvJWSBase64Decode( const uint8_t * pucInput,
+                                            uint32_t ulInputLength,
+                                            uint8_t * pucOutput,
+                                            uint32_t ulOutputSize,
+                                            int32_t * plOutputLength )
+{
+    uint32_t ulBits = 0;
+    uint32_t ulBitCount = 0;
+    uint32_t ulIndex;
+    uint32_t ulOutputLength = 0;
+    int32_t lValue;
+
+    while( ( ulInputLength > 0 ) && ( pucInput[ ulInputLength - 1 ] == '=' ) )
+    {
+        ulInputLength--;
+    }
+
+    if( ( ulInputLength % 4 ) == 1 )
+    {
+        AZLogError( ( "[JWS] Base64 input of invalid length: %u", ulInputLength ) );
+        return eAzureIoTErrorFailed;
+    }
+
+    if( ( ( ulInputLength / 4 ) * 3 + ( ( ulInputLength % 4 ) * 3 ) / 4 ) > ulOutputSize )
+    {
+        AZLogError( ( "[JWS] Decode buffer was too small: %u bytes", ulOutputSize ) );
+        return eAzureIoTErrorOutOfMemory;
+    }
+
+    for( ulIndex = 0; ulIndex < ulInputLength; ulIndex++ )
+    {
+        if( ( lValue = prvJWSBase64Value( pucInput[ ulIndex ] ) ) < 0 )
+        {
+            AZLogError( ( "[JWS] Invalid base64 character at %u", ulIndex ) );
+            return eAzureIoTErrorFailed;
+        }
+
+        ulBits = ( ( ulBits << 6 ) | ( uint32_t ) lValue ) & 0xFFFFU;
+        ulBitCount += 6;
+
+        if( ulBitCount >= 8 )
+        {
+            ulBitCount -= 8;
+            pucOutput[ ulOutputLength++ ] = ( uint8_t ) ( ulBits >> ulBitCount );
+        }
+    }
+
+    *plOutputLength = ( int32_t ) ulOutputLength;
+
+    return eAzureIoTSuccess;
+}
+
+/* Decode a base64 or base64url value where it is, replacing the span with the decoded bytes */
+static AzureIoTResult_t prvJWSBase64DecodeInPlace( uint8_t * pucData,
+                                                   uint32_t ulLength,
+                                                   uint32_t ulMaxDecodedLength,
+                                                   int32_t * plOutputLength )
+{
+    return prvJWSBase64Decode( pucData, ulLength, pucData,
+                               ulLength < ulMaxDecodedLength ? ulLength : ulMaxDecodedLength,
+                               plOutputLength );
+}
+
+/**
+ * @brief Verify an RS256 signature.
+ *
+ * @param pucSHA256 The SHA256 of the signed input.
  * @param pucSignature The encrypted signature which will be decrypted by \p pucN and \p pucE.
  * @param ulSignatureLength The length of \p pucSignature.
  * @param pucN The key's modulus which is used to decrypt \p signature.
  * @param ulNLength The length of \p pucN.
  * @param pucE The exponent used for the key.
  * @param ulELength The length of \p pucE.
- * @param pucBuffer The buffer used as scratch space to make the calculations. It should be at least
- * `azureiotjwsSHA256_SIZE` in size.
- * @param ulBufferLength The length of \p pucBuffer.
  * @return uint32_t The result of the operation.
  * @retval 0 if successful.
  * @retval Non-0 if not successful.
  */
-static AzureIoTResult_t prvJWS_RS256Verify( uint8_t * pucInput,
-                                            uint32_t ulInputLength,
+static AzureIoTResult_t prvJWS_RS256Verify( const uint8_t * pucSHA256,
                                             uint8_t * pucSignature,
                                             uint32_t ulSignatureLength,
                                             uint8_t * pucN,
                                             uint32_t ulNLength,
                                             uint8_t * pucE,
-                                            uint32_t ulELength,
-                                            uint8_t * pucBuffer,
-                                            uint32_t ulBufferLength )
+                                            uint32_t ulELength )
 {
     AzureIoTResult_t xResult;
     int32_t lMbedTLSResult;
     mbedtls_rsa_context ctx;
 
-    if( ulBufferLength < azureiotjwsSHA_CALCULATION_SCRATCH_SIZE )
-    {
-        AZLogError( ( "[JWS] Buffer Not Large Enough" ) );
-        return eAzureIoTErrorOutOfMemory;
-    }
-
     /* The signature is encrypted using the input key. We need to decrypt the */
     /* signature which gives us the SHA256 inside a PKCS7 structure. We then compare */
     /* that to the SHA256 of the input. */
@@ -246,20 +375,17 @@ static AzureIoTResult_t prvJWS_RS256Verify( uint8_t * pucInput,
         return eAzureIoTErrorFailed;
     }
 
-    /* RSA */
-    xResult = prvJWS_SHA256Calculate( pucInput, ulInputLength,
-                                      pucBuffer );
-
-    if( xResult != eAzureIoTSuccess )
+    if( ulSignatureLength != mbedtls_rsa_get_len( &ctx ) )
     {
-        AZLogError( ( "[JWS] prvJWS_SHA256Calculate failed" ) );
-        return xResult;
+        AZLogError( ( "[JWS] Signature length %u does not match the key length", ulSignatureLength ) );
+        mbedtls_rsa_free( &ctx );
+        return eAzureIoTErrorFailed;
     }
 
     #if MBEDTLS_VERSION_NUMBER >= 0x03000000
-        lMbedTLSResult = mbedtls_rsa_pkcs1_verify( &ctx, MBEDTLS_MD_SHA256, azureiotjwsSHA256_SIZE, pucBuffer, pucSignature );
+        lMbedTLSResult = mbedtls_rsa_pkcs1_verify( &ctx, MBEDTLS_MD_SHA256, azureiotjwsSHA256_SIZE, pucSHA256, pucSignature );
     #else
-        lMbedTLSResult = mbedtls_rsa_pkcs1_verify( &ctx, NULL, NULL, MBEDTLS_RSA_PUBLIC, MBEDTLS_MD_SHA256, azureiotjwsSHA256_SIZE, pucBuffer, pucSignature );
+        lMbedTLSResult = mbedtls_rsa_pkcs1_verify( &ctx, NULL, NULL, MBEDTLS_RSA_PUBLIC, MBEDTLS_MD_SHA256, azureiotjwsSHA256_SIZE, pucSHA256, pucSignature );
     #endif
 
     if( lMbedTLSResult != 0 )
@@ -469,139 +595,6 @@ static AzureIoTResult_t prvFindManifestSHA( AzureIoTJSONReader_t * pxPayload,
     return eAzureIoTSuccess;
 }
 
-static AzureIoTResult_t prvBase64DecodeJWK( prvJWSValidationContext_t * pxManifestContext )
-{
-    az_result xCoreResult;
-
-    xCoreResult = az_base64_url_decode( az_span_create( pxManifestContext->ucJWKHeader, azureiotjwsJWK_HEADER_SIZE ),
-                                        az_span_create( pxManifestContext->pucJWKBase64EncodedHeader, pxManifestContext->ulJWKBase64EncodedHeaderLength ),
-                                        &pxManifestContext->outJWKHeaderLength );
-
-    if( az_result_failed( xCoreResult ) )
-    {
-        AZLogError( ( "[JWS] az_base64_url_decode failed: result 0x%08x", ( uint16_t ) xCoreResult ) );
-
-        if( xCoreResult == AZ_ERROR_NOT_ENOUGH_SPACE )
-        {
-            AZLogError( ( "[JWS] Decode buffer was too small: %i bytes", azureiotjwsJWK_HEADER_SIZE ) );
-        }
-
-        return eAzureIoTErrorFailed;
-    }
-
-    xCoreResult = az_base64_url_decode( az_span_create( pxManifestContext->ucJWKPayload, azureiotjwsJWK_PAYLOAD_SIZE ),
-                                        az_span_create( pxManifestContext->pucJWKBase64EncodedPayload, pxManifestContext->ulJWKBase64EncodedPayloadLength ),
-                                        &pxManifestContext->outJWKPayloadLength );
-
-    if( az_result_failed( xCoreResult ) )
-    {
-        AZLogError( ( "[JWS] az_base64_url_decode failed: result 0x%08x", ( uint16_t ) xCoreResult ) );
-
-        if( xCoreResult == AZ_ERROR_NOT_ENOUGH_SPACE )
-        {
-            AZLogError( ( "[JWS] Decode buffer was too small: %i bytes", azureiotjwsJWK_PAYLOAD_SIZE ) );
-        }
-
-        return eAzureIoTErrorFailed;
-    }
-
-    xCoreResult = az_base64_url_decode( az_span_create( pxManifestContext->ucJWKSignature, azureiotjwsSIGNATURE_SIZE ),
-                                        az_span_create( pxManifestContext->pucJWKBase64EncodedSignature, pxManifestContext->ulJWKBase64EncodedSignatureLength ),
-                                        &pxManifestContext->outJWKSignatureLength );
-
-    if( az_result_failed( xCoreResult ) )
-    {
-        AZLogError( ( "[JWS] az_base64_url_decode failed: result 0x%08x", ( uint16_t ) xCoreResult ) );
-
-        if( xCoreResult == AZ_ERROR_NOT_ENOUGH_SPACE )
-        {
-            AZLogError( ( "[JWS] Decode buffer was too small: %i bytes", azureiotjwsSIGNATURE_SIZE ) );
-        }
-
-        return eAzureIoTErrorFailed;
-    }
-
-    return eAzureIoTSuccess;
-}
-
-static AzureIoTResult_t prvBase64DecodeSigningKey( prvJWSValidationContext_t * pxManifestContext )
-{
-    az_result xCoreResult;
-
-    xCoreResult = az_base64_decode( az_span_create( pxManifestContext->ucSigningKeyN, azureiotjwsRSA3072_SIZE ),
-                                    pxManifestContext->xBase64EncodedNSpan,
-                                    &pxManifestContext->outSigningKeyNLength );
-
-    if( az_result_failed( xCoreResult ) )
-    {
-        AZLogError( ( "[JWS] az_base64_decode failed: result 0x%08x", ( uint16_t ) xCoreResult ) );
-
-        if( xCoreResult == AZ_ERROR_NOT_ENOUGH_SPACE )
-        {
-            AZLogError( ( "[JWS] Decode buffer was too small: %i bytes", azureiotjwsRSA3072_SIZE ) );
-        }
-
-        return eAzureIoTErrorFailed;
-    }
-
-    xCoreResult = az_base64_decode( az_span_create( pxManifestContext->ucSigningKeyE, azureiotjwsSIGNING_KEY_E_SIZE ),
-                                    pxManifestContext->xBase64EncodedESpan,
-                                    &pxManifestContext->outSigningKeyELength );
-
-    if( az_result_failed( xCoreResult ) )
-    {
-        AZLogError( ( "[JWS] az_base64_decode failed: result 0x%08x", ( uint16_t ) xCoreResult ) );
-
-        if( xCoreResult == AZ_ERROR_NOT_ENOUGH_SPACE )
-        {
-            AZLogError( ( "[JWS] Decode buffer was too small: %i bytes", azureiotjwsSIGNING_KEY_E_SIZE ) );
-        }
-
-        return eAzureIoTErrorFailed;
-    }
-
-    return eAzureIoTSuccess;
-}
-
-static AzureIoTResult_t prvBase64DecodeJWSHeaderAndPayload( prvJWSValidationContext_t * pxManifestContext )
-{
-    az_result xCoreResult;
-
-    xCoreResult = az_base64_url_decode( az_span_create( pxManifestContext->ucJWSPayload, azureiotjwsJWS_PAYLOAD_SIZE ),
-                                        az_span_create( pxManifestContext->pucBase64EncodedPayload, pxManifestContext->ulBase64EncodedPayloadLength ),
-                                        &pxManifestContext->outJWSPayloadLength );
-
-    if( az_result_failed( xCoreResult ) )
-    {
-        AZLogError( ( "[JWS] az_base64_url_decode failed: result 0x%08x", ( uint16_t ) xCoreResult ) );
-
-        if( xCoreResult == AZ_ERROR_NOT_ENOUGH_SPACE )
-        {
-            AZLogError( ( "[JWS] Decode buffer was too small: %i bytes", azureiotjwsJWS_PAYLOAD_SIZE ) );
-        }
-
-        return eAzureIoTErrorFailed;
-    }
-
-    xCoreResult = az_base64_url_decode( az_span_create( pxManifestContext->ucJWSSignature, azureiotjwsSIGNATURE_SIZE ),
-                                        az_span_create( pxManifestContext->pucBase64EncodedSignature, pxManifestContext->ulBase64SignatureLength ),
-                                        &pxManifestContext->outJWSSignatureLength );
-
-    if( az_result_failed( xCoreResult ) )
-    {
-        AZLogError( ( "[JWS] az_base64_url_decode failed: result 0x%08x", ( uint16_t ) xCoreResult ) );
-
-        if( xCoreResult == AZ_ERROR_NOT_ENOUGH_SPACE )
-        {
-            AZLogError( ( "[JWS] Decode buffer was too small: %i bytes", azureiotjwsSIGNATURE_SIZE ) );
-        }
-
-        return eAzureIoTErrorFailed;
-    }
-
-    return eAzureIoTSuccess;
-}
-
 static AzureIoTResult_t prvValidateRootKey( prvJWSValidationContext_t * pxManifestContext,
                                             AzureIoTJWS_RootKey_t const* xADURootKeys,
                                             uint32_t ulADURootKeysLength,
@@ -640,7 +633,6 @@ static AzureIoTResult_t prvVerifySHAMatch( prvJWSValidationContext_t * pxManifes
 {
     AzureIoTJSONReader_t xJSONReader;
     AzureIoTResult_t ulVerificationResult;
-    az_result xCoreResult;
 
     ulVerificationResult = prvJWS_SHA256Calculate( pucManifest,
                                                    ulManifestLength,
@@ -660,19 +652,11 @@ static AzureIoTResult_t prvVerifySHAMatch( prvJWSValidationContext_t * pxManifes
         return eAzureIoTErrorFailed;
     }
 
-    xCoreResult = az_base64_decode( az_span_create( pxManifestContext->ucParsedManifestSha, azureiotjwsSHA256_SIZE ),
-                                    pxManifestContext->sha256Span,
-                                    &pxManifestContext->outParsedManifestShaSize );
-
-    if( az_result_failed( xCoreResult ) )
+    if( prvJWSBase64Decode( az_span_ptr( pxManifestContext->sha256Span ), ( uint32_t ) az_span_size( pxManifestContext->sha256Span ),
+                            pxManifestContext->ucParsedManifestSha, azureiotjwsSHA256_SIZE,
+                            &pxManifestContext->outParsedManifestShaSize ) != eAzureIoTSuccess )
     {
-        AZLogError( ( "[JWS] az_base64_decode failed: result 0x%08x", ( uint16_t ) xCoreResult ) );
-
-        if( xCoreResult == AZ_ERROR_NOT_ENOUGH_SPACE )
-        {
-            AZLogError( ( "[JWS] Decode buffer was too small: %i bytes", azureiotjwsSHA256_SIZE ) );
-        }
-
+        AZLogError( ( "[JWS] Base64 decoding of manifest SHA failed" ) );
         return eAzureIoTErrorFailed;
     }
 
@@ -697,6 +681,87 @@ static AzureIoTResult_t prvVerifySHAMatch( prvJWSValidationContext_t * pxManifes
     return eAzureIoTSuccess;
 }
 
+#if azureiotconfigJWS_SIGNING_KEY_CACHE_SIZE > 0
+
+/**
+ * @brief Fill the cache entry for the signing key of a JWS.
+ *
+ * The entry holds the hash of the signed JWK as found in the JWS header, which covers its kid,
+ * key and signature, and the hash of the root key it is verified against. The hash of the signed
+ * JWK is calculated before the JWK is decoded in place.
+ *
+ * @return false if the signing key cannot be cached.
+ */
+static bool prvJWSSigningKeyCacheEntryInit( prvJWSValidationContext_t * pxManifestContext,
+                                            AzureIoTJWS_RootKey_t const * pxRootKey,
+                                            prvJWSSigningKeyCacheEntry_t * pxEntry )
+{
+    mbedtls_md_context_t ctx;
+    int32_t lMbedTLSResult;
+
+    if( ( az_span_size( pxManifestContext->kidSpan ) <= 0 ) ||
+        ( az_span_size( pxManifestContext->kidSpan ) > ( int32_t ) sizeof( pxEntry->ucKid ) ) )
+    {
+        return false;
+    }
+
+    memcpy( pxEntry->ucKid, az_span_ptr( pxManifestContext->kidSpan ), ( size_t ) az_span_size( pxManifestContext->kidSpan ) );
+    pxEntry->ulKidLength = ( uint32_t ) az_span_size( pxManifestContext->kidSpan );
+
+    mbedtls_md_init( &ctx );
+    lMbedTLSResult = mbedtls_md_setup( &ctx, mbedtls_md_info_from_type( MBEDTLS_MD_SHA256 ), 0 );
+
+    if( lMbedTLSResult == 0 )
+    {
+        lMbedTLSResult = mbedtls_md_starts( &ctx );
+    }
+
+    if( lMbedTLSResult == 0 )
+    {
+        lMbedTLSResult = mbedtls_md_update( &ctx, pxRootKey->pucRootKeyN, pxRootKey->ulRootKeyNLength );
+    }
+
+    if( lMbedTLSResult == 0 )
+    {
+        lMbedTLSResult = mbedtls_md_update( &ctx, pxRootKey->pucRootKeyExponent, pxRootKey->ulRootKeyExponentLength );
+    }
+
+    if( lMbedTLSResult == 0 )
+    {
+        lMbedTLSResult = mbedtls_md_finish( &ctx, pxEntry->ucRootKeySHA256 );
+    }
+
+    mbedtls_md_free( &ctx );
+
+    return( lMbedTLSResult == 0 );
+}
+
+static bool prvJWSSigningKeyCacheFind( const prvJWSSigningKeyCacheEntry_t * pxEntry )
+{
+    uint32_t ulIndex;
+
+    for( ulIndex = 0; ulIndex < azureiotconfigJWS_SIGNING_KEY_CACHE_SIZE; ulIndex++ )
+    {
+        if( ( xJWSSigningKeyCache[ ulIndex ].ulKidLength == pxEntry->ulKidLength ) &&
+            ( memcmp( xJWSSigningKeyCache[ ulIndex ].ucKid, pxEntry->ucKid, pxEntry->ulKidLength ) == 0 ) &&
+            ( memcmp( xJWSSigningKeyCache[ ulIndex ].ucSJWKSHA256, pxEntry->ucSJWKSHA256, azureiotjwsSHA256_SIZE ) == 0 ) &&
+            ( memcmp( xJWSSigningKeyCache[ ulIndex ].ucRootKeySHA256, pxEntry->ucRootKeySHA256, azureiotjwsSHA256_SIZE ) == 0 ) )
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/* Replace the oldest entry */
+static void prvJWSSigningKeyCacheAdd( const prvJWSSigningKeyCacheEntry_t * pxEntry )
+{
+    xJWSSigningKeyCache[ ulJWSSigningKeyCacheNext ] = *pxEntry;
+    ulJWSSigningKeyCacheNext = ( ulJWSSigningKeyCacheNext + 1 ) % azureiotconfigJWS_SIGNING_KEY_CACHE_SIZE;
+}
+#endif /* azureiotconfigJWS_SIGNING_KEY_CACHE_SIZE > 0 */
+
 AzureIoTResult_t AzureIoTJWS_ManifestAuthenticate(
       const uint8_t*               pucManifest,
       uint32_t                     ulManifestLength,
@@ -707,16 +772,37 @@ AzureIoTResult_t AzureIoTJWS_ManifestAuthenticate(
       uint8_t*                     pucScratchBuffer,
       uint32_t                     ulScratchBufferLength)
 {
-    az_result xCoreResult;
     AzureIoTResult_t xResult;
     AzureIoTJSONReader_t xJSONReader;
     prvJWSValidationContext_t xManifestContext = { 0 };
     int32_t lRootKeyIndex;
+    bool xSigningKeyVerified = false;
+
+    #if azureiotconfigJWS_SIGNING_KEY_CACHE_SIZE > 0
+        prvJWSSigningKeyCacheEntry_t xSigningKeyCacheEntry;
+        bool xSigningKeyCacheable = false;
+    #endif
+
+    if( ( pucManifest == NULL ) || ( pucJWS == NULL ) || ( xADURootKeys == NULL ) || ( pucScratchBuffer == NULL ) )
+    {
+        AZLogError( ( "[JWS] AzureIoTJWS_ManifestAuthenticate failed: invalid argument" ) );
+        return eAzureIoTErrorInvalidArgument;
+    }
 
-    /* Break up scratch buffer for reusable and persistant sections */
-    uint8_t * ucPersistentScratchSpaceHead = pucScratchBuffer;
-    uint8_t * ucReusableScratchSpaceRoot = ucPersistentScratchSpaceHead + azureiotjwsJWS_HEADER_SIZE + azureiotjwsJWK_PAYLOAD_SIZE;
-    uint8_t * ucReusableScratchSpaceHead = ucReusableScratchSpaceRoot;
+    if( ulScratchBufferLength < azureiotjwsSCRATCH_BUFFER_SIZE )
+    {
+        AZLogError( ( "[JWS] Scratch buffer of %u bytes is smaller than %u bytes", ulScratchBufferLength, azureiotjwsSCRATCH_BUFFER_SIZE ) );
+        return eAzureIoTErrorOutOfMemory;
+    }
+
+    /* Break up scratch buffer. The signing input SHA is reused for the JWK and the JWS, and the JWS
+     * signature buffer for the manifest SHAs once the signature is verified. */
+    xManifestContext.ucJWSHeader = pucScratchBuffer;
+    xManifestContext.ucSigningInputSHA = xManifestContext.ucJWSHeader + azureiotjwsJWS_HEADER_SIZE;
+    xManifestContext.ucJWSPayload = xManifestContext.ucSigningInputSHA + azureiotjwsSHA256_SIZE;
+    xManifestContext.ucJWSSignature = xManifestContext.ucJWSPayload + azureiotjwsJWS_PAYLOAD_SIZE;
+    xManifestContext.ucManifestSHACalculation = xManifestContext.ucJWSSignature;
+    xManifestContext.ucParsedManifestSha = xManifestContext.ucManifestSHACalculation + azureiotjwsSHA256_SIZE;
 
     /*------------------- Parse and Decode the JWS Header ------------------------*/
 
@@ -731,21 +817,13 @@ AzureIoTResult_t AzureIoTJWS_ManifestAuthenticate(
         return xResult;
     }
 
-    xManifestContext.ucJWSHeader = ucPersistentScratchSpaceHead;
-    ucPersistentScratchSpaceHead += azureiotjwsJWS_HEADER_SIZE;
-    xCoreResult = az_base64_url_decode( az_span_create( xManifestContext.ucJWSHeader, azureiotjwsJWS_HEADER_SIZE ),
-                                        az_span_create( xManifestContext.pucBase64EncodedHeader, xManifestContext.ulBase64EncodedHeaderLength ),
-                                        &xManifestContext.outJWSHeaderLength );
+    xResult = prvJWSBase64Decode( xManifestContext.pucBase64EncodedHeader, xManifestContext.ulBase64EncodedHeaderLength,
+                                  xManifestContext.ucJWSHeader, azureiotjwsJWS_HEADER_SIZE,
+                                  &xManifestContext.outJWSHeaderLength );
 
-    if( az_result_failed( xCoreResult ) )
+    if( xResult != eAzureIoTSuccess )
     {
-        AZLogError( ( "[JWS] az_base64_url_decode failed: result 0x%08x", ( uint16_t ) xCoreResult ) );
-
-        if( xCoreResult == AZ_ERROR_NOT_ENOUGH_SPACE )
-        {
-            AZLogError( ( "[JWS] Decode buffer was too small: %i bytes", azureiotjwsJWS_HEADER_SIZE ) );
-        }
-
+        AZLogError( ( "[JWS] Base64 decoding of JWS header failed" ) );
         return eAzureIoTErrorFailed;
     }
 
@@ -773,15 +851,38 @@ AzureIoTResult_t AzureIoTJWS_ManifestAuthenticate(
         return xResult;
     }
 
-    xManifestContext.ucJWKHeader = ucReusableScratchSpaceHead;
-    ucReusableScratchSpaceHead += azureiotjwsJWK_HEADER_SIZE;
-    /* Needs to be persisted so we can parse the signing key N and E later */
-    xManifestContext.ucJWKPayload = ucPersistentScratchSpaceHead;
-    ucPersistentScratchSpaceHead += azureiotjwsJWK_PAYLOAD_SIZE;
-    xManifestContext.ucJWKSignature = ucReusableScratchSpaceHead;
-    ucReusableScratchSpaceHead += azureiotjwsSIGNATURE_SIZE;
+    /* Hash what the JWK decoding in place overwrites */
+    xResult = prvJWS_SHA256Calculate( xManifestContext.pucJWKBase64EncodedHeader,
+                                      xManifestContext.ulJWKBase64EncodedHeaderLength + xManifestContext.ulJWKBase64EncodedPayloadLength + 1,
+                                      xManifestContext.ucSigningInputSHA );
 
-    prvBase64DecodeJWK( &xManifestContext );
+    if( xResult != eAzureIoTSuccess )
+    {
+        AZLogError( ( "[JWS] SHA256 of JWK signing input failed" ) );
+        return xResult;
+    }
+
+    #if azureiotconfigJWS_SIGNING_KEY_CACHE_SIZE > 0
+        /* Without the hash of the signed JWK the signing key is verified in full and not cached. */
+        xSigningKeyCacheable = ( prvJWS_SHA256Calculate( az_span_ptr( xManifestContext.xJWKManifestSpan ),
+                                                         ( uint32_t ) az_span_size( xManifestContext.xJWKManifestSpan ),
+                                                         xSigningKeyCacheEntry.ucSJWKSHA256 ) == eAzureIoTSuccess );
+    #endif
+
+    xManifestContext.ucJWKHeader = xManifestContext.pucJWKBase64EncodedHeader;
+    xManifestContext.ucJWKPayload = xManifestContext.pucJWKBase64EncodedPayload;
+    xManifestContext.ucJWKSignature = xManifestContext.pucJWKBase64EncodedSignature;
+
+    if( ( prvJWSBase64DecodeInPlace( xManifestContext.ucJWKHeader, xManifestContext.ulJWKBase64EncodedHeaderLength,
+                                     azureiotjwsJWK_HEADER_SIZE, &xManifestContext.outJWKHeaderLength ) != eAzureIoTSuccess ) ||
+        ( prvJWSBase64DecodeInPlace( xManifestContext.ucJWKPayload, xManifestContext.ulJWKBase64EncodedPayloadLength,
+                                     azureiotjwsJWK_PAYLOAD_SIZE, &xManifestContext.outJWKPayloadLength ) != eAzureIoTSuccess ) ||
+        ( prvJWSBase64DecodeInPlace( xManifestContext.ucJWKSignature, xManifestContext.ulJWKBase64EncodedSignatureLength,
+                                     azureiotjwsSIGNATURE_SIZE, &xManifestContext.outJWKSignatureLength ) != eAzureIoTSuccess ) )
+    {
+        AZLogError( ( "[JWS] Base64 decoding of JWK failed" ) );
+        return eAzureIoTErrorFailed;
+    }
 
     /*------------------- Parse root key id ------------------------*/
 
@@ -805,53 +906,63 @@ AzureIoTResult_t AzureIoTJWS_ManifestAuthenticate(
 
     /*------------------- Verify the signature ------------------------*/
 
-    xManifestContext.ucScratchCalculationBuffer = ucReusableScratchSpaceHead;
-    ucReusableScratchSpaceHead += azureiotjwsSHA_CALCULATION_SCRATCH_SIZE;
-    xResult = prvJWS_RS256Verify( xManifestContext.pucJWKBase64EncodedHeader, xManifestContext.ulJWKBase64EncodedHeaderLength + xManifestContext.ulJWKBase64EncodedPayloadLength + 1,
-                                  xManifestContext.ucJWKSignature, xManifestContext.outJWKSignatureLength,
-                                  ( uint8_t * ) xADURootKeys[ lRootKeyIndex ].pucRootKeyN, xADURootKeys[ lRootKeyIndex ].ulRootKeyNLength,
-                                  ( uint8_t * ) xADURootKeys[ lRootKeyIndex ].pucRootKeyExponent, xADURootKeys[ lRootKeyIndex ].ulRootKeyExponentLength,
-                                  xManifestContext.ucScratchCalculationBuffer, azureiotjwsSHA_CALCULATION_SCRATCH_SIZE );
+    #if azureiotconfigJWS_SIGNING_KEY_CACHE_SIZE > 0
+        /* A signing key verified against the same root key before needs no RSA verification. */
+        xSigningKeyCacheable = xSigningKeyCacheable &&
+                               prvJWSSigningKeyCacheEntryInit( &xManifestContext, &xADURootKeys[ lRootKeyIndex ], &xSigningKeyCacheEntry );
+        xSigningKeyVerified = xSigningKeyCacheable && prvJWSSigningKeyCacheFind( &xSigningKeyCacheEntry );
+    #endif
 
-    if( xResult != eAzureIoTSuccess )
+    if( xSigningKeyVerified )
     {
-        AZLogError( ( "[JWS] prvJWS_RS256Verify failed" ) );
-        return xResult;
+        AZLogInfo( ( "[JWS] Signing key verified before" ) );
     }
+    else
+    {
+        xResult = prvJWS_RS256Verify( xManifestContext.ucSigningInputSHA,
+                                      xManifestContext.ucJWKSignature, xManifestContext.outJWKSignatureLength,
+                                      ( uint8_t * ) xADURootKeys[ lRootKeyIndex ].pucRootKeyN, xADURootKeys[ lRootKeyIndex ].ulRootKeyNLength,
+                                      ( uint8_t * ) xADURootKeys[ lRootKeyIndex ].pucRootKeyExponent, xADURootKeys[ lRootKeyIndex ].ulRootKeyExponentLength );
 
-    /*------------------- Reuse Buffer Space ------------------------*/
+        if( xResult != eAzureIoTSuccess )
+        {
+            AZLogError( ( "[JWS] prvJWS_RS256Verify failed" ) );
+            return xResult;
+        }
 
-    /* The JWK verification is now done, so we can reuse the buffers which it used. */
-    ucReusableScratchSpaceHead = ucReusableScratchSpaceRoot;
+        #if azureiotconfigJWS_SIGNING_KEY_CACHE_SIZE > 0
+            if( xSigningKeyCacheable )
+            {
+                prvJWSSigningKeyCacheAdd( &xSigningKeyCacheEntry );
+            }
+        #endif
+    }
 
     /*------------------- Decode remaining values from JWS ------------------------*/
 
-    xManifestContext.ucJWSPayload = ucReusableScratchSpaceHead;
-    ucReusableScratchSpaceHead += azureiotjwsJWS_PAYLOAD_SIZE;
-    xManifestContext.ucJWSSignature = ucReusableScratchSpaceHead;
-    ucReusableScratchSpaceHead += azureiotjwsSIGNATURE_SIZE;
-
-    xResult = prvBase64DecodeJWSHeaderAndPayload( &xManifestContext );
-
-    if( xResult != eAzureIoTSuccess )
+    if( ( prvJWSBase64Decode( xManifestContext.pucBase64EncodedPayload, xManifestContext.ulBase64EncodedPayloadLength,
+                              xManifestContext.ucJWSPayload, azureiotjwsJWS_PAYLOAD_SIZE,
+                              &xManifestContext.outJWSPayloadLength ) != eAzureIoTSuccess ) ||
+        ( prvJWSBase64Decode( xManifestContext.pucBase64EncodedSignature, xManifestContext.ulBase64SignatureLength,
+                              xManifestContext.ucJWSSignature, azureiotjwsSIGNATURE_SIZE,
+                              &xManifestContext.outJWSSignatureLength ) != eAzureIoTSuccess ) )
     {
-        AZLogError( ( "[JWS] prvBase64DecodeJWSHeaderAndPayload failed" ) );
-        return xResult;
+        AZLogError( ( "[JWS] Base64 decoding of JWS payload and signature failed" ) );
+        return eAzureIoTErrorFailed;
     }
 
     /*------------------- Base64 decode the signing key ------------------------*/
 
-    xManifestContext.ucSigningKeyN = ucReusableScratchSpaceHead;
-    ucReusableScratchSpaceHead += azureiotjwsRSA3072_SIZE;
-    xManifestContext.ucSigningKeyE = ucReusableScratchSpaceHead;
-    ucReusableScratchSpaceHead += azureiotjwsSIGNING_KEY_E_SIZE;
-
-    xResult = prvBase64DecodeSigningKey( &xManifestContext );
+    xManifestContext.ucSigningKeyN = az_span_ptr( xManifestContext.xBase64EncodedNSpan );
+    xManifestContext.ucSigningKeyE = az_span_ptr( xManifestContext.xBase64EncodedESpan );
 
-    if( xResult != eAzureIoTSuccess )
+    if( ( prvJWSBase64DecodeInPlace( xManifestContext.ucSigningKeyN, ( uint32_t ) az_span_size( xManifestContext.xBase64EncodedNSpan ),
+                                     azureiotjwsSIGNING_KEY_N_SIZE, &xManifestContext.outSigningKeyNLength ) != eAzureIoTSuccess ) ||
+        ( prvJWSBase64DecodeInPlace( xManifestContext.ucSigningKeyE, ( uint32_t ) az_span_size( xManifestContext.xBase64EncodedESpan ),
+                                     azureiotjwsSIGNING_KEY_E_SIZE, &xManifestContext.outSigningKeyELength ) != eAzureIoTSuccess ) )
     {
-        AZLogError( ( "[JWS] prvBase64DecodeSigningKey failed" ) );
-        return xResult;
+        AZLogError( ( "[JWS] Base64 decoding of signing key failed" ) );
+        return eAzureIoTErrorFailed;
     }
 
     /*------------------- Verify that the signature was signed by signing key ------------------------*/
@@ -864,11 +975,20 @@ AzureIoTResult_t AzureIoTJWS_ManifestAuthenticate(
         return eAzureIoTErrorFailed;
     }
 
-    xResult = prvJWS_RS256Verify( xManifestContext.pucBase64EncodedHeader, xManifestContext.ulBase64EncodedHeaderLength + xManifestContext.ulBase64EncodedPayloadLength + 1,
+    xResult = prvJWS_SHA256Calculate( xManifestContext.pucBase64EncodedHeader,
+                                      xManifestContext.ulBase64EncodedHeaderLength + xManifestContext.ulBase64EncodedPayloadLength + 1,
+                                      xManifestContext.ucSigningInputSHA );
+
+    if( xResult != eAzureIoTSuccess )
+    {
+        AZLogError( ( "[JWS] SHA256 of JWS signing input failed" ) );
+        return xResult;
+    }
+
+    xResult = prvJWS_RS256Verify( xManifestContext.ucSigningInputSHA,
                                   xManifestContext.ucJWSSignature, xManifestContext.outJWSSignatureLength,
                                   xManifestContext.ucSigningKeyN, xManifestContext.outSigningKeyNLength,
-                                  xManifestContext.ucSigningKeyE, xManifestContext.outSigningKeyELength,
-                                  xManifestContext.ucScratchCalculationBuffer, azureiotjwsSHA_CALCULATION_SCRATCH_SIZE );
+                                  xManifestContext.ucSigningKeyE, xManifestContext.outSigningKeyELength );
 
     if( xResult != eAzureIoTSuccess )
     {
@@ -878,10 +998,13 @@ AzureIoTResult_t AzureIoTJWS_ManifestAuthenticate(
 
     /*------------------- Verify that the SHAs match ------------------------*/
 
-    xManifestContext.ucManifestSHACalculation = ucReusableScratchSpaceHead;
-    ucReusableScratchSpaceHead += azureiotjwsSHA256_SIZE;
-    xManifestContext.ucParsedManifestSha = ucReusableScratchSpaceHead;
-    ucReusableScratchSpaceHead += azureiotjwsSHA256_SIZE;
-
     return prvVerifySHAMatch( &xManifestContext, pucManifest, ulManifestLength );
 }
+
+void AzureIoTJWS_ClearSigningKeyCache( void )
+{
+    #if azureiotconfigJWS_SIGNING_KEY_CACHE_SIZE > 0
+        memset( xJWSSigningKeyCache, 0, sizeof( xJWSSigningKeyCache ) );
+        ulJWSSigningKeyCacheNext = 0;
+    #endif
+}
@@ -264,6 +264,700 @@ AzureIoTResult_t AzureIoTADUClient_ParseRequest( AzureIoTADUClient_t * pxAzureIo
     return eAzureIoTSuccess;
 }
 
+static void prvGetTokenSpan( AzureIoTJSONReader_t * pxReader,
+                             uint8_t ** ppucValue,
+                             uint32_t * pulValueLength )
+{
+    az_span xSlice = pxReader->_internal.xCoreReader.token.slice;
+
+    *ppucValue = az_span_ptr( xSlice );
+    *pulValueLength = ( uint32_t ) az_span_size( xSlice );
+}
+
+/* Moves to the next value, which must be a string or null, and returns it as a span into the payload. */
+static AzureIoTResult_t prvGetStringValue( AzureIoTJSONReader_t * pxReader,
+                                           uint8_t ** ppucValue,
+                                           uint32_t * pulValueLength )
+{
+    AzureIoTResult_t xResult;
+    AzureIoTJSONTokenType_t xTokenType;
+
+    if( ( ( xResult = AzureIoTJSONReader_NextToken( pxReader ) ) != eAzureIoTSuccess ) ||
+        ( ( xResult = AzureIoTJSONReader_TokenType( pxReader, &xTokenType ) ) != eAzureIoTSuccess ) )
+    {
+        return xResult;
+    }
+
+    if( xTokenType == eAzureIoTJSONTokenSTRING )
+    {
+        prvGetTokenSpan( pxReader, ppucValue, pulValueLength );
+    }
+    else if( xTokenType == eAzureIoTJSONTokenNULL )
+    {
+        *ppucValue = NULL;
+        *pulValueLength = 0;
+    }
+    else
+    {
+        AZLogError( ( "[ADU] Unexpected JSON token type for string: %d", xTokenType ) );
+        return eAzureIoTErrorJSONInvalidState;
+    }
+
+    return eAzureIoTSuccess;
+}
+
+/* Moves to the next value, which must be an object, an array or null, and skips it, returning where it is in the
+ * payload and how many properties or elements it has. */
+static AzureIoTResult_t prvGetContainerValue( AzureIoTJSONReader_t * pxReader,
+                                              uint8_t ** ppucContainer,
+                                              uint32_t * pulContainerLength,
+                                              uint32_t * pulItemCount )
+{
+    AzureIoTResult_t xResult;
+    AzureIoTJSONTokenType_t xTokenType;
+    uint8_t * pucContainerStart;
+    uint32_t ulLength;
+    uint32_t ulItemCount = 0;
+
+    if( ( ( xResult = AzureIoTJSONReader_NextToken( pxReader ) ) != eAzureIoTSuccess ) ||
+        ( ( xResult = AzureIoTJSONReader_TokenType( pxReader, &xTokenType ) ) != eAzureIoTSuccess ) )
+    {
+        return xResult;
+    }
+
+    if( xTokenType == eAzureIoTJSONTokenNULL )
+    {
+        *ppucContainer = NULL;
+        *pulContainerLength = 0;
+        *pulItemCount = 0;
+        return eAzureIoTSuccess;
+    }
+    else if( ( xTokenType != eAzureIoTJSONTokenBEGIN_OBJECT ) && ( xTokenType != eAzureIoTJSONTokenBEGIN_ARRAY ) )
+    {
+        AZLogError( ( "[ADU] Unexpected JSON token type for object or array: %d", xTokenType ) );
+        return eAzureIoTErrorJSONInvalidState;
+    }
+
+    prvGetTokenSpan( pxReader, &pucContainerStart, &ulLength );
+
+    while( ( ( xResult = AzureIoTJSONReader_NextToken( pxReader ) ) == eAzureIoTSuccess ) &&
+           ( ( xResult = AzureIoTJSONReader_TokenType( pxReader, &xTokenType ) ) == eAzureIoTSuccess ) &&
+           ( xTokenType != eAzureIoTJSONTokenEND_OBJECT ) && ( xTokenType != eAzureIoTJSONTokenEND_ARRAY ) )
+    {
+        /* Skips a property with its value, or an array element */
+        if( ( xResult = AzureIoTJSONReader_SkipChildren( pxReader ) ) != eAzureIoTSuccess )
+        {
+            return xResult;
+        }
+
+        ulItemCount++;
+    }
+
+    if( xResult != eAzureIoTSuccess )
+    {
+        return xResult;
+    }
+
+    prvGetTokenSpan( pxReader, ppucContainer, &ulLength );
+    *pulContainerLength = ( uint32_t ) ( *ppucContainer - pucContainerStart ) + ulLength;
+    *ppucContainer = pucContainerStart;
+    *pulItemCount = ulItemCount;
+
+    return eAzureIoTSuccess;
+}
+
+/* Reads an object or array stored by prvGetContainerValue() from the start, up to item ulItemIndex or, if pucName is
+ * not NULL, up to the property named pucName. The reader is left on the property name or the array element. */
+static AzureIoTResult_t prvMoveToContainerItem( AzureIoTJSONReader_t * pxReader,
+                                                const uint8_t * pucContainer,
+                                                uint32_t ulContainerLength,
+                                                uint32_t ulItemIndex,
+                                                const uint8_t * pucName,
+                                                uint32_t ulNameLength )
+{
+    AzureIoTResult_t xResult;
+    AzureIoTJSONTokenType_t xTokenType;
+    uint32_t ulIndex = 0;
+
+    if( pucContainer == NULL )
+    {
+        return eAzureIoTErrorItemNotFound;
+    }
+
+    if( ( ( xResult = AzureIoTJSONReader_Init( pxReader, pucContainer, ulContainerLength ) ) != eAzureIoTSuccess ) ||
+        ( ( xResult = AzureIoTJSONReader_NextToken( pxReader ) ) != eAzureIoTSuccess ) )
+    {
+        return xResult;
+    }
+
+    while( ( ( xResult = AzureIoTJSONReader_NextToken( pxReader ) ) == eAzureIoTSuccess ) &&
+           ( ( xResult = AzureIoTJSONReader_TokenType( pxReader, &xTokenType ) ) == eAzureIoTSuccess ) &&
+           ( xTokenType != eAzureIoTJSONTokenEND_OBJECT ) && ( xTokenType != eAzureIoTJSONTokenEND_ARRAY ) )
+    {
+        if( ( pucName != NULL ) ?
+            AzureIoTJSONReader_TokenIsTextEqual( pxReader, pucName, ulNameLength ) :
+            ( ulIndex == ulItemIndex ) )
+        {
+            return eAzureIoTSuccess;
+        }
+
+        if( ( xResult = AzureIoTJSONReader_SkipChildren( pxReader ) ) != eAzureIoTSuccess )
+        {
+            return xResult;
+        }
+
+        ulIndex++;
+    }
+
+    return ( xResult == eAzureIoTSuccess ) ? eAzureIoTErrorItemNotFound : xResult;
+}
+
+/* Moves into the object value of the current property. */
+static AzureIoTResult_t prvBeginObjectValue( AzureIoTJSONReader_t * pxReader )
+{
+    AzureIoTResult_t xResult;
+    AzureIoTJSONTokenType_t xTokenType;
+
+    if( ( ( xResult = AzureIoTJSONReader_NextToken( pxReader ) ) != eAzureIoTSuccess ) ||
+        ( ( xResult = AzureIoTJSONReader_TokenType( pxReader, &xTokenType ) ) != eAzureIoTSuccess ) )
+    {
+        return xResult;
+    }
+
+    if( xTokenType != eAzureIoTJSONTokenBEGIN_OBJECT )
+    {
+        AZLogError( ( "[ADU] Unexpected JSON token type for object: %d", xTokenType ) );
+        return eAzureIoTErrorJSONInvalidState;
+    }
+
+    return eAzureIoTSuccess;
+}
+
+/* Moves to the next property name of the current object, returning eAzureIoTErrorEndOfProperties at its end. */
+static AzureIoTResult_t prvNextProperty( AzureIoTJSONReader_t * pxReader )
+{
+    AzureIoTResult_t xResult;
+    AzureIoTJSONTokenType_t xTokenType;
+
+    if( ( ( xResult = AzureIoTJSONReader_NextToken( pxReader ) ) != eAzureIoTSuccess ) ||
+        ( ( xResult = AzureIoTJSONReader_TokenType( pxReader, &xTokenType ) ) != eAzureIoTSuccess ) )
+    {
+        return xResult;
+    }
+
+    return ( xTokenType == eAzureIoTJSONTokenEND_OBJECT ) ? eAzureIoTErrorEndOfProperties : eAzureIoTSuccess;
+}
+
+static bool prvIsProperty( AzureIoTJSONReader_t * pxReader,
+                           const char * pcName )
+{
+    return AzureIoTJSONReader_TokenIsTextEqual( pxReader, ( const uint8_t * ) pcName, ( uint32_t ) strlen( pcName ) );
+}
+
+static AzureIoTResult_t prvParseWorkflowCompact( AzureIoTJSONReader_t * pxReader,
+                                                 AzureIoTADUClientWorkflow_t * pxWorkflow )
+{
+    AzureIoTResult_t xResult;
+    int32_t lAction;
+
+    if( ( xResult = prvBeginObjectValue( pxReader ) ) != eAzureIoTSuccess )
+    {
+        return xResult;
+    }
+
+    while( ( xResult = prvNextProperty( pxReader ) ) == eAzureIoTSuccess )
+    {
+        if( prvIsProperty( pxReader, "action" ) )
+        {
+            if( ( ( xResult = AzureIoTJSONReader_NextToken( pxReader ) ) == eAzureIoTSuccess ) &&
+                ( ( xResult = AzureIoTJSONReader_GetTokenInt32( pxReader, &lAction ) ) == eAzureIoTSuccess ) )
+            {
+                pxWorkflow->xAction = ( AzureIoTADUAction_t ) lAction;
+            }
+        }
+        else if( prvIsProperty( pxReader, "id" ) )
+        {
+            xResult = prvGetStringValue( pxReader, ( uint8_t ** ) &pxWorkflow->pucID, &pxWorkflow->ulIDLength );
+        }
+        else if( prvIsProperty( pxReader, "retryTimestamp" ) )
+        {
+            xResult = prvGetStringValue( pxReader, ( uint8_t ** ) &pxWorkflow->pucRetryTimestamp, &pxWorkflow->ulRetryTimestampLength );
+        }
+        else
+        {
+            xResult = AzureIoTJSONReader_SkipChildren( pxReader );
+        }
+
+        if( xResult != eAzureIoTSuccess )
+        {
+            return xResult;
+        }
+    }
+
+    return ( xResult == eAzureIoTErrorEndOfProperties ) ? eAzureIoTSuccess : xResult;
+}
+
+static AzureIoTResult_t prvParseUpdateIdCompact( AzureIoTJSONReader_t * pxReader,
+                                                 AzureIoTADUUpdateId_t * pxUpdateId )
+{
+    AzureIoTResult_t xResult;
+
+    if( ( xResult = prvBeginObjectValue( pxReader ) ) != eAzureIoTSuccess )
+    {
+        return xResult;
+    }
+
+    while( ( xResult = prvNextProperty( pxReader ) ) == eAzureIoTSuccess )
+    {
+        if( prvIsProperty( pxReader, "provider" ) )
+        {
+            xResult = prvGetStringValue( pxReader, &pxUpdateId->pucProvider, &pxUpdateId->ulProviderLength );
+        }
+        else if( prvIsProperty( pxReader, "name" ) )
+        {
+            xResult = prvGetStringValue( pxReader, &pxUpdateId->pucName, &pxUpdateId->ulNameLength );
+        }
+        else if( prvIsProperty( pxReader, "version" ) )
+        {
+            xResult = prvGetStringValue( pxReader, &pxUpdateId->pucVersion, &pxUpdateId->ulVersionLength );
+        }
+        else
+        {
+            xResult = AzureIoTJSONReader_SkipChildren( pxReader );
+        }
+
+        if( xResult != eAzureIoTSuccess )
+        {
+            return xResult;
+        }
+    }
+
+    return ( xResult == eAzureIoTErrorEndOfProperties ) ? eAzureIoTSuccess : xResult;
+}
+
+static AzureIoTResult_t prvParseInstructionsCompact( AzureIoTJSONReader_t * pxReader,
+                                                     AzureIoTADUUpdateRequestCompact_t * pxAduUpdateRequest )
+{
+    AzureIoTResult_t xResult;
+
+    if( ( xResult = prvBeginObjectValue( pxReader ) ) != eAzureIoTSuccess )
+    {
+        return xResult;
+    }
+
+    while( ( xResult = prvNextProperty( pxReader ) ) == eAzureIoTSuccess )
+    {
+        if( prvIsProperty( pxReader, "steps" ) )
+        {
+            xResult = prvGetContainerValue( pxReader,
+                                            &pxAduUpdateRequest->_internal.pucSteps,
+                                            &pxAduUpdateRequest->_internal.ulStepsLength,
+                                            &pxAduUpdateRequest->ulStepsCount );
+        }
+        else
+        {
+            xResult = AzureIoTJSONReader_SkipChildren( pxReader );
+        }
+
+        if( xResult != eAzureIoTSuccess )
+        {
+            return xResult;
+        }
+    }
+
+    return ( xResult == eAzureIoTErrorEndOfProperties ) ? eAzureIoTSuccess : xResult;
+}
+
+static AzureIoTResult_t prvParseManifestCompact( AzureIoTADUUpdateRequestCompact_t * pxAduUpdateRequest )
+{
+    AzureIoTResult_t xResult;
+    AzureIoTJSONReader_t xReader;
+    AzureIoTJSONTokenType_t xTokenType;
+
+    if( ( ( xResult = AzureIoTJSONReader_Init( &xReader, pxAduUpdateRequest->pucUpdateManifest,
+                                               pxAduUpdateRequest->ulUpdateManifestLength ) ) != eAzureIoTSuccess ) ||
+        ( ( xResult = AzureIoTJSONReader_NextToken( &xReader ) ) != eAzureIoTSuccess ) ||
+        ( ( xResult = AzureIoTJSONReader_TokenType( &xReader, &xTokenType ) ) != eAzureIoTSuccess ) )
+    {
+        return xResult;
+    }
+
+    if( xTokenType != eAzureIoTJSONTokenBEGIN_OBJECT )
+    {
+        return eAzureIoTErrorJSONInvalidState;
+    }
+
+    while( ( xResult = prvNextProperty( &xReader ) ) == eAzureIoTSuccess )
+    {
+        if( prvIsProperty( &xReader, "manifestVersion" ) )
+        {
+            xResult = prvGetStringValue( &xReader, &pxAduUpdateRequest->pucManifestVersion,
+                                         &pxAduUpdateRequest->ulManifestVersionLength );
+        }
+        else if( prvIsProperty( &xReader, "updateId" ) )
+        {
+            xResult = prvParseUpdateIdCompact( &xReader, &pxAduUpdateRequest->xUpdateId );
+        }
+        else if( prvIsProperty( &xReader, "instructions" ) )
+        {
+            xResult = prvParseInstructionsCompact( &xReader, pxAduUpdateRequest );
+        }
+        else if( prvIsProperty( &xReader, "files" ) )
+        {
+            xResult = prvGetContainerValue( &xReader,
+                                            &pxAduUpdateRequest->_internal.pucFiles,
+                                            &pxAduUpdateRequest->_internal.ulFilesLength,
+                                            &pxAduUpdateRequest->ulFilesCount );
+        }
+        else if( prvIsProperty( &xReader, "createdDateTime" ) )
+        {
+            xResult = prvGetStringValue( &xReader, &pxAduUpdateRequest->pucCreateDateTime,
+                                         &pxAduUpdateRequest->ulCreateDateTimeLength );
+        }
+        else
+        {
+            xResult = AzureIoTJSONReader_SkipChildren( &xReader );
+        }
+
+        if( xResult != eAzureIoTSuccess )
+        {
+            return xResult;
+        }
+    }
+
+    return ( xResult == eAzureIoTErrorEndOfProperties ) ? eAzureIoTSuccess : xResult;
+}
+
+AzureIoTResult_t AzureIoTADUClient_ParseRequestCompact( AzureIoTADUClient_t * pxAzureIoTADUClient,
+                                                        AzureIoTJSONReader_t * pxReader,
+                                                        AzureIoTADUUpdateRequestCompact_t * pxAduUpdateRequest )
+{
+    AzureIoTResult_t xResult;
+
+    if( ( pxAzureIoTADUClient == NULL ) || ( pxReader == NULL ) ||
+        ( pxAduUpdateRequest == NULL ) )
+    {
+        AZLogError( ( "AzureIoTADUClient_ParseRequestCompact failed: invalid argument" ) );
+        return eAzureIoTErrorInvalidArgument;
+    }
+
+    memset( pxAduUpdateRequest, 0, sizeof( AzureIoTADUUpdateRequestCompact_t ) );
+
+    if( !prvIsProperty( pxReader, "service" ) )
+    {
+        AZLogError( ( "AzureIoTADUClient_ParseRequestCompact failed: reader not on the service property" ) );
+        return eAzureIoTErrorJSONInvalidState;
+    }
+
+    if( ( xResult = prvBeginObjectValue( pxReader ) ) != eAzureIoTSuccess )
+    {
+        return xResult;
+    }
+
+    while( ( xResult = prvNextProperty( pxReader ) ) == eAzureIoTSuccess )
+    {
+        if( prvIsProperty( pxReader, "workflow" ) )
+        {
+            xResult = prvParseWorkflowCompact( pxReader, &pxAduUpdateRequest->xWorkflow );
+        }
+        else if( prvIsProperty( pxReader, "updateManifest" ) )
+        {
+            /* Unescaped in place to save a copy of the manifest. It modifies the original payload buffer. */
+            xResult = prvGetStringValue( pxReader, &pxAduUpdateRequest->pucUpdateManifest,
+                                         &pxAduUpdateRequest->ulUpdateManifestLength );
+
+            if( ( xResult == eAzureIoTSuccess ) && ( pxAduUpdateRequest->pucUpdateManifest != NULL ) )
+            {
+                xResult = AzureIoTJSONReader_GetTokenStringInPlace( pxReader, &pxAduUpdateRequest->pucUpdateManifest,
+                                                                    &pxAduUpdateRequest->ulUpdateManifestLength );
+            }
+        }
+        else if( prvIsProperty( pxReader, "updateManifestSignature" ) )
+        {
+            xResult = prvGetStringValue( pxReader, &pxAduUpdateRequest->pucUpdateManifestSignature,
+                                         &pxAduUpdateRequest->ulUpdateManifestSignatureLength );
+        }
+        else if( prvIsProperty( pxReader, "fileUrls" ) )
+        {
+            xResult = prvGetContainerValue( pxReader,
+                                            &pxAduUpdateRequest->_internal.pucFileUrls,
+                                            &pxAduUpdateRequest->_internal.ulFileUrlsLength,
+                                            &pxAduUpdateRequest->ulFileUrlCount );
+        }
+        else
+        {
+            xResult = AzureIoTJSONReader_SkipChildren( pxReader );
+        }
+
+        if( xResult != eAzureIoTSuccess )
+        {
+            AZLogError( ( "AzureIoTADUClient_ParseRequestCompact failed: error=0x%08x", ( uint16_t ) xResult ) );
+            return xResult;
+        }
+    }
+
+    if( xResult != eAzureIoTErrorEndOfProperties )
+    {
+        return xResult;
+    }
+
+    if( pxAduUpdateRequest->ulUpdateManifestLength > 0 )
+    {
+        if( ( xResult = prvParseManifestCompact( pxAduUpdateRequest ) ) != eAzureIoTSuccess )
+        {
+            AZLogError( ( "AzureIoTADUClient_ParseRequestCompact failed to parse manifest: error=0x%08x", ( uint16_t ) xResult ) );
+            return xResult;
+        }
+    }
+
+    return eAzureIoTSuccess;
+}
+
+AzureIoTResult_t AzureIoTADUUpdateRequestCompact_GetStep( AzureIoTADUUpdateRequestCompact_t const* pxAduUpdateRequest,
+                                                          uint32_t ulStepIndex,
+                                                          AzureIoTADUInstructionStepCompact_t * pxStep )
+{
+    AzureIoTResult_t xResult;
+    AzureIoTJSONReader_t xReader;
+
+    if( ( pxAduUpdateRequest == NULL ) || ( pxStep == NULL ) )
+    {
+        AZLogError( ( "AzureIoTADUUpdateRequestCompact_GetStep failed: invalid argument" ) );
+        return eAzureIoTErrorInvalidArgument;
+    }
+
+    memset( pxStep, 0, sizeof( AzureIoTADUInstructionStepCompact_t ) );
+
+    /* The reader is left on the beginning of the step object */
+    if( ( xResult = prvMoveToContainerItem( &xReader, pxAduUpdateRequest->_internal.pucSteps,
+                                            pxAduUpdateRequest->_internal.ulStepsLength,
+                                            ulStepIndex, NULL, 0 ) ) != eAzureIoTSuccess )
+    {
+        return xResult;
+    }
+
+    while( ( xResult = prvNextProperty( &xReader ) ) == eAzureIoTSuccess )
+    {
+        if( prvIsProperty( &xReader, "handler" ) )
+        {
+            xResult = prvGetStringValue( &xReader, &pxStep->pucHandler, &pxStep->ulHandlerLength );
+        }
+        else if( prvIsProperty( &xReader, "files" ) )
+        {
+            xResult = prvGetContainerValue( &xReader, &pxStep->_internal.pucFiles,
+                                            &pxStep->_internal.ulFilesLength, &pxStep->ulFilesCount );
+        }
+        else if( prvIsProperty( &xReader, "handlerProperties" ) )
+        {
+            if( ( xResult = prvBeginObjectValue( &xReader ) ) == eAzureIoTSuccess )
+            {
+                while( ( xResult = prvNextProperty( &xReader ) ) == eAzureIoTSuccess )
+                {
+                    if( prvIsProperty( &xReader, "installedCriteria" ) )
+                    {
+                        xResult = prvGetStringValue( &xReader, &pxStep->pucInstalledCriteria,
+                                                     &pxStep->ulInstalledCriteriaLength );
+                    }
+                    else
+                    {
+                        xResult = AzureIoTJSONReader_SkipChildren( &xReader );
+                    }
+
+                    if( xResult != eAzureIoTSuccess )
+                    {
+                        return xResult;
+                    }
+                }
+
+                xResult = ( xResult == eAzureIoTErrorEndOfProperties ) ? eAzureIoTSuccess : xResult;
+            }
+        }
+        else
+        {
+            xResult = AzureIoTJSONReader_SkipChildren( &xReader );
+        }
+
+        if( xResult != eAzureIoTSuccess )
+        {
+            return xResult;
+        }
+    }
+
+    return ( xResult == eAzureIoTErrorEndOfProperties ) ? eAzureIoTSuccess : xResult;
+}
+
+AzureIoTResult_t AzureIoTADUUpdateRequestCompact_GetStepFile( AzureIoTADUInstructionStepCompact_t const* pxStep,
+                                                              uint32_t ulFileIndex,
+                                                              AzureIoTADUUpdateManifestInstructionStepFile_t * pxFile )
+{
+    AzureIoTResult_t xResult;
+    AzureIoTJSONReader_t xReader;
+
+    if( ( pxStep == NULL ) || ( pxFile == NULL ) )
+    {
+        AZLogError( ( "AzureIoTADUUpdateRequestCompact_GetStepFile failed: invalid argument" ) );
+        return eAzureIoTErrorInvalidArgument;
+    }
+
+    if( ( xResult = prvMoveToContainerItem( &xReader, pxStep->_internal.pucFiles, pxStep->_internal.ulFilesLength,
+                                            ulFileIndex, NULL, 0 ) ) != eAzureIoTSuccess )
+    {
+        return xResult;
+    }
+
+    prvGetTokenSpan( &xReader, &pxFile->pucFileName, &pxFile->ulFileNameLength );
+
+    return eAzureIoTSuccess;
+}
+
+/* Reads the file whose id is the current property name. */
+static AzureIoTResult_t prvParseFileCompact( AzureIoTJSONReader_t * pxReader,
+                                             AzureIoTADUUpdateManifestFileCompact_t * pxFile )
+{
+    AzureIoTResult_t xResult;
+    az_result xCoreResult;
+
+    memset( pxFile, 0, sizeof( AzureIoTADUUpdateManifestFileCompact_t ) );
+    prvGetTokenSpan( pxReader, &pxFile->pucId, &pxFile->ulIdLength );
+
+    if( ( xResult = prvBeginObjectValue( pxReader ) ) != eAzureIoTSuccess )
+    {
+        return xResult;
+    }
+
+    while( ( xResult = prvNextProperty( pxReader ) ) == eAzureIoTSuccess )
+    {
+        if( prvIsProperty( pxReader, "fileName" ) )
+        {
+            xResult = prvGetStringValue( pxReader, &pxFile->pucFileName, &pxFile->ulFileNameLength );
+        }
+        else if( prvIsProperty( pxReader, "sizeInBytes" ) )
+        {
+            if( ( xResult = AzureIoTJSONReader_NextToken( pxReader ) ) == eAzureIoTSuccess )
+            {
+                if( az_result_failed( xCoreResult = az_json_token_get_int64( &pxReader->_internal.xCoreReader.token,
+                                                                             &pxFile->llSizeInBytes ) ) )
+                {
+                    xResult = AzureIoT_TranslateCoreError( xCoreResult );
+                }
+            }
+        }
+        else if( prvIsProperty( pxReader, "hashes" ) )
+        {
+            xResult = prvGetContainerValue( pxReader, &pxFile->_internal.pucHashes,
+                                            &pxFile->_internal.ulHashesLength, &pxFile->ulHashesCount );
+        }
+        else
+        {
+            xResult = AzureIoTJSONReader_SkipChildren( pxReader );
+        }
+
+        if( xResult != eAzureIoTSuccess )
+        {
+            return xResult;
+        }
+    }
+
+    return ( xResult == eAzureIoTErrorEndOfProperties ) ? eAzureIoTSuccess : xResult;
+}
+
+AzureIoTResult_t AzureIoTADUUpdateRequestCompact_GetFile( AzureIoTADUUpdateRequestCompact_t const* pxAduUpdateRequest,
+                                                          uint32_t ulFileIndex,
+                                                          AzureIoTADUUpdateManifestFileCompact_t * pxFile )
+{
+    AzureIoTResult_t xResult;
+    AzureIoTJSONReader_t xReader;
+
+    if( ( pxAduUpdateRequest == NULL ) || ( pxFile == NULL ) )
+    {
+        AZLogError( ( "AzureIoTADUUpdateRequestCompact_GetFile failed: invalid argument" ) );
+        return eAzureIoTErrorInvalidArgument;
+    }
+
+    if( ( xResult = prvMoveToContainerItem( &xReader, pxAduUpdateRequest->_internal.pucFiles,
+                                            pxAduUpdateRequest->_internal.ulFilesLength,
+                                            ulFileIndex, NULL, 0 ) ) != eAzureIoTSuccess )
+    {
+        return xResult;
+    }
+
+    return prvParseFileCompact( &xReader, pxFile );
+}
+
+AzureIoTResult_t AzureIoTADUUpdateRequestCompact_FindFile( AzureIoTADUUpdateRequestCompact_t const* pxAduUpdateRequest,
+                                                           const uint8_t * pucFileId,
+                                                           uint32_t ulFileIdLength,
+                                                           AzureIoTADUUpdateManifestFileCompact_t * pxFile )
+{
+    AzureIoTResult_t xResult;
+    AzureIoTJSONReader_t xReader;
+
+    if( ( pxAduUpdateRequest == NULL ) || ( pucFileId == NULL ) || ( pxFile == NULL ) )
+    {
+        AZLogError( ( "AzureIoTADUUpdateRequestCompact_FindFile failed: invalid argument" ) );
+        return eAzureIoTErrorInvalidArgument;
+    }
+
+    if( ( xResult = prvMoveToContainerItem( &xReader, pxAduUpdateRequest->_internal.pucFiles,
+                                            pxAduUpdateRequest->_internal.ulFilesLength,
+                                            0, pucFileId, ulFileIdLength ) ) != eAzureIoTSuccess )
+    {
+        return xResult;
+    }
+
+    return prvParseFileCompact( &xReader, pxFile );
+}
+
+AzureIoTResult_t AzureIoTADUUpdateRequestCompact_GetFileHash( AzureIoTADUUpdateManifestFileCompact_t const* pxFile,
+                                                              uint32_t ulHashIndex,
+                                                              AzureIoTADUUpdateManifestFileHash_t * pxHash )
+{
+    AzureIoTResult_t xResult;
+    AzureIoTJSONReader_t xReader;
+
+    if( ( pxFile == NULL ) || ( pxHash == NULL ) )
+    {
+        AZLogError( ( "AzureIoTADUUpdateRequestCompact_GetFileHash failed: invalid argument" ) );
+        return eAzureIoTErrorInvalidArgument;
+    }
+
+    if( ( xResult = prvMoveToContainerItem( &xReader, pxFile->_internal.pucHashes, pxFile->_internal.ulHashesLength,
+                                            ulHashIndex, NULL, 0 ) ) != eAzureIoTSuccess )
+    {
+        return xResult;
+    }
+
+    prvGetTokenSpan( &xReader, &pxHash->pucId, &pxHash->ulIdLength );
+
+    return prvGetStringValue( &xReader, &pxHash->pucHash, &pxHash->ulHashLength );
+}
+
+AzureIoTResult_t AzureIoTADUUpdateRequestCompact_FindFileUrl( AzureIoTADUUpdateRequestCompact_t const* pxAduUpdateRequest,
+                                                              const uint8_t * pucFileId,
+                                                              uint32_t ulFileIdLength,
+                                                              AzureIoTADUUpdateManifestFileUrl_t * pxFileUrl )
+{
+    AzureIoTResult_t xResult;
+    AzureIoTJSONReader_t xReader;
+
+    if( ( pxAduUpdateRequest == NULL ) || ( pucFileId == NULL ) || ( pxFileUrl == NULL ) )
+    {
+        AZLogError( ( "AzureIoTADUUpdateRequestCompact_FindFileUrl failed: invalid argument" ) );
+        return eAzureIoTErrorInvalidArgument;
+    }
+
+    if( ( xResult = prvMoveToContainerItem( &xReader, pxAduUpdateRequest->_internal.pucFileUrls,
+                                            pxAduUpdateRequest->_internal.ulFileUrlsLength,
+                                            0, pucFileId, ulFileIdLength ) ) != eAzureIoTSuccess )
+    {
+        return xResult;
+    }
+
+    prvGetTokenSpan( &xReader, &pxFileUrl->pucId, &pxFileUrl->ulIdLength );
+
+    return prvGetStringValue( &xReader, &pxFileUrl->pucUrl, &pxFileUrl->ulUrlLength );
+}
+
 AzureIoTResult_t AzureIoTADUClient_SendResponse( AzureIoTADUClient_t const* pxAzureIoTADUClient,
                                                  AzureIoTHubClient_t * pxAzureIoTHubClient,
                                                  AzureIoTADURequestDecision_t xRequestDecision,
@@ -369,18 +1063,18 @@ static void prvFillBaseAduDeviceProperties( AzureIoTADUClientDeviceProperties_t
         ( int32_t ) pxDeviceProperties->ulDeliveryOptimizationAgentVersionLength );
 }
 
-static void prvFillBaseAduWorkflow( AzureIoTADUUpdateRequest_t const* pxAduUpdateRequest,
+static void prvFillBaseAduWorkflow( AzureIoTADUClientWorkflow_t const* pxWorkflow,
                                     az_iot_adu_client_workflow * pxBaseWorkflow )
 {
-    if( pxAduUpdateRequest != NULL )
+    if( pxWorkflow != NULL )
     {
-        pxBaseWorkflow->action = ( az_iot_adu_client_service_action ) pxAduUpdateRequest->xWorkflow.xAction;
+        pxBaseWorkflow->action = ( az_iot_adu_client_service_action ) pxWorkflow->xAction;
         pxBaseWorkflow->id = az_span_create(
-            ( uint8_t * ) pxAduUpdateRequest->xWorkflow.pucID,
-            ( int32_t ) pxAduUpdateRequest->xWorkflow.ulIDLength );
+            ( uint8_t * ) pxWorkflow->pucID,
+            ( int32_t ) pxWorkflow->ulIDLength );
         pxBaseWorkflow->retry_timestamp = az_span_create(
-            ( uint8_t * ) pxAduUpdateRequest->xWorkflow.pucRetryTimestamp,
-            ( int32_t ) pxAduUpdateRequest->xWorkflow.ulRetryTimestampLength );
+            ( uint8_t * ) pxWorkflow->pucRetryTimestamp,
+            ( int32_t ) pxWorkflow->ulRetryTimestampLength );
     }
 }
 
@@ -431,15 +1125,15 @@ static void prvFillBaseAduInstallResults( AzureIoTADUClientInstallResult_t const
     }
 }
 
-AzureIoTResult_t AzureIoTADUClient_SendAgentState( AzureIoTADUClient_t const* pxAzureIoTADUClient,
-                                                   AzureIoTHubClient_t * pxAzureIoTHubClient,
-                                                   AzureIoTADUClientDeviceProperties_t const* pxDeviceProperties,
-                                                   AzureIoTADUUpdateRequest_t const* pxAduUpdateRequest,
-                                                   AzureIoTADUAgentState_t xAgentState,
-                                                   AzureIoTADUClientInstallResult_t const* pxUpdateResults,
-                                                   uint8_t * pucBuffer,
-                                                   uint32_t ulBufferSize,
-                                                   uint32_t * pulRequestId )
+static AzureIoTResult_t prvSendAgentState( AzureIoTADUClient_t const* pxAzureIoTADUClient,
+                                           AzureIoTHubClient_t * pxAzureIoTHubClient,
+                                           AzureIoTADUClientDeviceProperties_t const* pxDeviceProperties,
+                                           AzureIoTADUClientWorkflow_t const* pxWorkflow,
+                                           AzureIoTADUAgentState_t xAgentState,
+                                           AzureIoTADUClientInstallResult_t const* pxUpdateResults,
+                                           uint8_t * pucBuffer,
+                                           uint32_t ulBufferSize,
+                                           uint32_t * pulRequestId )
 {
     az_result xAzResult;
     az_iot_adu_client_device_properties xBaseADUDeviceProperties;
@@ -448,15 +1142,8 @@ AzureIoTResult_t AzureIoTADUClient_SendAgentState( AzureIoTADUClient_t const* px
     az_json_writer jw;
     az_span xPropertiesPayload;
 
-    if( ( pxAzureIoTADUClient == NULL ) || ( pxAzureIoTHubClient == NULL ) ||
-        ( pxDeviceProperties == NULL ) || ( pucBuffer == NULL ) || ( ulBufferSize == 0 ) )
-    {
-        AZLogError( ( "AzureIoTADUClient_SendAgentState failed: invalid argument" ) );
-        return eAzureIoTErrorInvalidArgument;
-    }
-
     prvFillBaseAduDeviceProperties( pxDeviceProperties, &xBaseADUDeviceProperties );
-    prvFillBaseAduWorkflow( pxAduUpdateRequest, &xBaseWorkflow );
+    prvFillBaseAduWorkflow( pxWorkflow, &xBaseWorkflow );
     prvFillBaseAduInstallResults( pxUpdateResults, &xInstallResult );
 
     xAzResult = az_json_writer_init( &jw, az_span_create( pucBuffer, ( int32_t ) ulBufferSize ), NULL );
@@ -471,7 +1158,7 @@ AzureIoTResult_t AzureIoTADUClient_SendAgentState( AzureIoTADUClient_t const* px
         &pxAzureIoTADUClient->_internal.xADUClient,
         &xBaseADUDeviceProperties,
         ( az_iot_adu_client_agent_state ) xAgentState,
-        pxAduUpdateRequest != NULL ? &xBaseWorkflow : NULL,
+        pxWorkflow != NULL ? &xBaseWorkflow : NULL,
         pxUpdateResults != NULL ? &xInstallResult : NULL,
         &jw );
 
@@ -495,3 +1182,47 @@ AzureIoTResult_t AzureIoTADUClient_SendAgentState( AzureIoTADUClient_t const* px
 
     return eAzureIoTSuccess;
 }
+
+AzureIoTResult_t AzureIoTADUClient_SendAgentState( AzureIoTADUClient_t const* pxAzureIoTADUClient,
+                                                   AzureIoTHubClient_t * pxAzureIoTHubClient,
+                                                   AzureIoTADUClientDeviceProperties_t const* pxDeviceProperties,
+                                                   AzureIoTADUUpdateRequest_t const* pxAduUpdateRequest,
+                                                   AzureIoTADUAgentState_t xAgentState,
+                                                   AzureIoTADUClientInstallResult_t const* pxUpdateResults,
+                                                   uint8_t * pucBuffer,
+                                                   uint32_t ulBufferSize,
+                                                   uint32_t * pulRequestId )
+{
+    if( ( pxAzureIoTADUClient == NULL ) || ( pxAzureIoTHubClient == NULL ) ||
+        ( pxDeviceProperties == NULL ) || ( pucBuffer == NULL ) || ( ulBufferSize == 0 ) )
+    {
+        AZLogError( ( "AzureIoTADUClient_SendAgentState failed: invalid argument" ) );
+        return eAzureIoTErrorInvalidArgument;
+    }
+
+    return prvSendAgentState( pxAzureIoTADUClient, pxAzureIoTHubClient, pxDeviceProperties,
+                              pxAduUpdateRequest != NULL ? &pxAduUpdateRequest->xWorkflow : NULL,
+                              xAgentState, pxUpdateResults, pucBuffer, ulBufferSize, pulRequestId );
+}
+
+AzureIoTResult_t AzureIoTADUClient_SendAgentStateCompact( AzureIoTADUClient_t const* pxAzureIoTADUClient,
+                                                          AzureIoTHubClient_t * pxAzureIoTHubClient,
+                                                          AzureIoTADUClientDeviceProperties_t const* pxDeviceProperties,
+                                                          AzureIoTADUUpdateRequestCompact_t const* pxAduUpdateRequest,
+                                                          AzureIoTADUAgentState_t xAgentState,
+                                                          AzureIoTADUClientInstallResult_t const* pxUpdateResults,
+                                                          uint8_t * pucBuffer,
+                                                          uint32_t ulBufferSize,
+                                                          uint32_t * pulRequestId )
+{
+    if( ( pxAzureIoTADUClient == NULL ) || ( pxAzureIoTHubClient == NULL ) ||
+        ( pxDeviceProperties == NULL ) || ( pucBuffer == NULL ) || ( ulBufferSize == 0 ) )
+    {
+        AZLogError( ( "AzureIoTADUClient_SendAgentStateCompact failed: invalid argument" ) );
+        return eAzureIoTErrorInvalidArgument;
+    }
+
+    return prvSendAgentState( pxAzureIoTADUClient, pxAzureIoTHubClient, pxDeviceProperties,
+                              pxAduUpdateRequest != NULL ? &pxAduUpdateRequest->xWorkflow : NULL,
+                              xAgentState, pxUpdateResults, pucBuffer, ulBufferSize, pulRequestId );
+}
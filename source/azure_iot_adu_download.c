@@ -0,0 +1,1345 @@
+/* Copyright (c) Microsoft Corporation.
+ * Licensed under the MIT License. */
+
+/**
+ * @file azure_iot_adu_download.c
+ * @brief Implementation of the ADU download engine.
+ *
+ */
+
+#include "azure_iot_adu_download.h"
+
+#include <string.h>
+
+/* Kernel includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+/*-----------------------------------------------------------*/
+
+#define azureiotaduDOWNLOAD_CHECKPOINT_VERSION    ( 4U )
+/*-----------------------------------------------------------*/
+
+/**
+ * Get number of millseconds since the scheduler started.
+ *
+ */
+static uint32_t prvADUDownloadGetTimeMilliseconds( void )
+{
+    TickType_t xTickCount = 0;
+    uint32_t ulTimeMs = 0UL;
+
+    /* Get the current tick count. */
+    xTickCount = xTaskGetTickCount();
+
+    /* Convert the ticks to milliseconds. */
+    ulTimeMs = ( uint32_t ) xTickCount * azureiotMILLISECONDS_PER_TICK;
+
+    return ulTimeMs;
+}
+/*-----------------------------------------------------------*/
+
+static void prvADUDownloadUpdateThroughput( AzureIoTADUDownload_t * pxDownload,
+                                            uint32_t ulNowMs )
+{
+    AzureIoTADUDownloadStats_t * pxStats = &pxDownload->_internal.xStats;
+
+    pxStats->ulElapsedMilliseconds = ulNowMs - pxDownload->_internal.ulStartTimeMs;
+
+    if( pxStats->ulElapsedMilliseconds > 0 )
+    {
+        pxStats->ulBytesPerSecond = ( uint32_t ) ( ( ( uint64_t ) pxStats->ulBytesWritten * 1000U ) /
+                                                   pxStats->ulElapsedMilliseconds );
+    }
+}
+/*-----------------------------------------------------------*/
+
+/**
+ * Length of the next range request, bounded by the chunk size and the time slice.
+ *
+ */
+static uint32_t prvADUDownloadMaxRangeLength( AzureIoTADUDownload_t * pxDownload )
+{
+    uint32_t ulLength = pxDownload->_internal.ulChunkSize;
+    uint64_t ullSliceLength;
+
+    if( pxDownload->_internal.ulSliceMilliseconds > 0 )
+    {
+        /* The first request only measures the link. */
+        ullSliceLength = ( ( uint64_t ) pxDownload->_internal.ulSliceBytesPerSecond *
+                           pxDownload->_internal.ulSliceMilliseconds ) / 1000U;
+
+        if( ullSliceLength < azureiotconfigADU_DOWNLOAD_TIME_SLICE_MIN_CHUNK )
+        {
+            ullSliceLength = azureiotconfigADU_DOWNLOAD_TIME_SLICE_MIN_CHUNK;
+        }
+
+        if( ullSliceLength < ulLength )
+        {
+            ulLength = ( uint32_t ) ullSliceLength;
+        }
+    }
+
+    return ulLength;
+}
+/*-----------------------------------------------------------*/
+
+static void prvADUDownloadMeasureSlice( AzureIoTADUDownload_t * pxDownload,
+                                        uint32_t ulLength,
+                                        uint32_t ulElapsedMs )
+{
+    /* Round trip included, so that requests shrink until they fit in the slice. */
+    pxDownload->_internal.ulSliceBytesPerSecond = ( uint32_t ) ( ( ( uint64_t ) ulLength * 1000U ) /
+                                                                 ( ( ulElapsedMs > 0 ) ? ulElapsedMs : 1U ) );
+}
+/*-----------------------------------------------------------*/
+
+/**
+ * Measure the goodput of the current chunk size and move to the neighbouring size
+ * with the best known goodput.
+ *
+ */
+static void prvADUDownloadAdaptChunkSize( AzureIoTADUDownload_t * pxDownload,
+                                          uint32_t ulBytes,
+                                          uint32_t ulMilliseconds,
+                                          bool xFailed )
+{
+    uint32_t * pulEstimates = pxDownload->_internal.ulLevelBytesPerSecond;
+    uint32_t ulLevel = pxDownload->_internal.ulChunkLevel;
+    uint32_t ulBytesPerSecond;
+
+    if( pxDownload->_internal.ulMinChunkSize == 0 )
+    {
+        return;
+    }
+
+    pxDownload->_internal.ulWindowBytes += ulBytes;
+    pxDownload->_internal.ulWindowMilliseconds += ulMilliseconds;
+    pxDownload->_internal.ulWindowRequests++;
+
+    /* A failure closes the window right away, so a lossy size is left quickly. */
+    if( !xFailed && ( pxDownload->_internal.ulWindowRequests < azureiotconfigADU_DOWNLOAD_ADAPTIVE_WINDOW ) )
+    {
+        return;
+    }
+
+    if( pxDownload->_internal.ulWindowMilliseconds == 0 )
+    {
+        pxDownload->_internal.ulWindowMilliseconds = 1;
+    }
+
+    ulBytesPerSecond = ( uint32_t ) ( ( ( uint64_t ) pxDownload->_internal.ulWindowBytes * 1000U ) /
+                                      pxDownload->_internal.ulWindowMilliseconds );
+
+    /* 0 means not measured yet. */
+    if( ulBytesPerSecond == 0 )
+    {
+        ulBytesPerSecond = 1;
+    }
+
+    pulEstimates[ ulLevel ] = ( pulEstimates[ ulLevel ] == 0 ) ?
+                              ulBytesPerSecond : ( pulEstimates[ ulLevel ] + ulBytesPerSecond ) / 2;
+
+    if( ( ( ulLevel + 1 ) < pxDownload->_internal.ulChunkLevelCount ) &&
+        ( ( pulEstimates[ ulLevel + 1 ] == 0 ) || ( pulEstimates[ ulLevel + 1 ] > pulEstimates[ ulLevel ] ) ) )
+    {
+        ulLevel++;
+        pxDownload->_internal.ulStableWindows = 0;
+    }
+    else if( ( ulLevel > 0 ) && ( pulEstimates[ ulLevel - 1 ] > pulEstimates[ ulLevel ] ) )
+    {
+        ulLevel--;
+        pxDownload->_internal.ulStableWindows = 0;
+    }
+    else if( ++pxDownload->_internal.ulStableWindows >= azureiotconfigADU_DOWNLOAD_ADAPTIVE_PROBE_WINDOWS )
+    {
+        /* The link may have changed, measure the larger size again after the next window. */
+        if( ( ulLevel + 1 ) < pxDownload->_internal.ulChunkLevelCount )
+        {
+            pulEstimates[ ulLevel + 1 ] = 0;
+        }
+
+        pxDownload->_internal.ulStableWindows = 0;
+    }
+
+    if( ulLevel != pxDownload->_internal.ulChunkLevel )
+    {
+        AZLogDebug( ( "AzureIoTADUDownload chunk size %u -> %u bytes, goodput %u B/s",
+                      pxDownload->_internal.ulChunkSize,
+                      pxDownload->_internal.ulMinChunkSize << ulLevel,
+                      ulBytesPerSecond ) );
+    }
+
+    pxDownload->_internal.ulChunkLevel = ulLevel;
+    pxDownload->_internal.ulChunkSize = pxDownload->_internal.ulMinChunkSize << ulLevel;
+    pxDownload->_internal.xStats.ulChunkSize = pxDownload->_internal.ulChunkSize;
+    pxDownload->_internal.ulWindowBytes = 0;
+    pxDownload->_internal.ulWindowMilliseconds = 0;
+    pxDownload->_internal.ulWindowRequests = 0;
+}
+/*-----------------------------------------------------------*/
+
+static AzureIoTResult_t prvADUDownloadFinishSHA256( AzureIoTADUDownload_t * pxDownload )
+{
+    AzureIoTResult_t xResult;
+
+    if( ( xResult = AzureIoTCrypto_SHA256Final( &pxDownload->_internal.xCheckpoint.xSHA256Context,
+                                                pxDownload->_internal.ucSHA256,
+                                                sizeof( pxDownload->_internal.ucSHA256 ) ) ) != eAzureIoTSuccess )
+    {
+        AZLogError( ( "AzureIoTADUDownload failed to finish SHA256: error=0x%08x", ( uint16_t ) xResult ) );
+    }
+    else
+    {
+        pxDownload->_internal.xSHA256Ready = true;
+    }
+
+    return xResult;
+}
+/*-----------------------------------------------------------*/
+
+static AzureIoTResult_t prvADUDownloadSaveCheckpoint( AzureIoTADUDownload_t * pxDownload )
+{
+    AzureIoTResult_t xResult;
+    uint32_t ulSavedOffset = pxDownload->_internal.xCheckpoint.ulOffset;
+
+    /* The checkpoint must never cover bytes still in the writer. */
+    if( ( pxDownload->_internal.pxWriter != NULL ) &&
+        ( ( xResult = AzureIoTADUFlashWriter_Flush( pxDownload->_internal.pxWriter ) ) != eAzureIoTSuccess ) )
+    {
+        AZLogWarn( ( "AzureIoTADUDownload failed to flush before checkpoint: error=0x%08x", ( uint16_t ) xResult ) );
+        return xResult;
+    }
+
+    pxDownload->_internal.xCheckpoint.ulOffset = pxDownload->_internal.ulWriteOffset;
+
+    if( pxDownload->_internal.pxPatch != NULL )
+    {
+        ( void ) AzureIoTADUPatch_GetState( pxDownload->_internal.pxPatch, &pxDownload->_internal.xCheckpoint.xPatchState );
+    }
+
+    if( ( xResult = AzureIoTPlatform_SaveCheckpoint( pxDownload->_internal.pxImage,
+                                                     ( const uint8_t * ) &pxDownload->_internal.xCheckpoint,
+                                                     sizeof( pxDownload->_internal.xCheckpoint ) ) ) != eAzureIoTSuccess )
+    {
+        /* The download goes on, the save is retried after the next write. */
+        pxDownload->_internal.xCheckpoint.ulOffset = ulSavedOffset;
+        AZLogWarn( ( "AzureIoTADUDownload failed to save checkpoint at offset %u: error=0x%08x",
+                     pxDownload->_internal.ulWriteOffset, ( uint16_t ) xResult ) );
+    }
+
+    return xResult;
+}
+/*-----------------------------------------------------------*/
+
+static void prvADUDownloadResume( AzureIoTADUDownload_t * pxDownload )
+{
+    AzureIoTResult_t xResult;
+    AzureIoTADUDownloadCheckpoint_t xSaved;
+    AzureIoTADUDownloadCheckpoint_t * pxCheckpoint = &pxDownload->_internal.xCheckpoint;
+
+    pxCheckpoint->ulFileSize = pxDownload->_internal.ulFileSize;
+
+    if( ( xResult = AzureIoTPlatform_LoadCheckpoint( pxDownload->_internal.pxImage,
+                                                     ( uint8_t * ) &xSaved,
+                                                     sizeof( xSaved ) ) ) != eAzureIoTSuccess )
+    {
+        if( xResult != eAzureIoTErrorItemNotFound )
+        {
+            AZLogWarn( ( "AzureIoTADUDownload failed to load checkpoint: error=0x%08x", ( uint16_t ) xResult ) );
+        }
+    }
+    else if( ( xSaved.ulVersion != azureiotaduDOWNLOAD_CHECKPOINT_VERSION ) ||
+             ( xSaved.ulFileSize != pxCheckpoint->ulFileSize ) ||
+             ( xSaved.ulOffset > xSaved.ulFileSize ) ||
+             ( xSaved.ulFileIdLength != pxCheckpoint->ulFileIdLength ) ||
+             ( xSaved.ulFileHashLength != pxCheckpoint->ulFileHashLength ) ||
+             ( memcmp( xSaved.ucFileId, pxCheckpoint->ucFileId, pxCheckpoint->ulFileIdLength ) != 0 ) ||
+             ( memcmp( xSaved.ucFileHash, pxCheckpoint->ucFileHash, pxCheckpoint->ulFileHashLength ) != 0 ) )
+    {
+        AZLogInfo( ( "AzureIoTADUDownload checkpoint is for another file, starting over" ) );
+    }
+    else if( ( xSaved.ulSHA256Layout != azureiotcryptoSHA256_CONTEXT_LAYOUT ) ||
+             ( xSaved.ulSHA256Layout == 0 ) )
+    {
+        /* The saved hash state would give a wrong hash without any error. */
+        AZLogInfo( ( "AzureIoTADUDownload checkpoint hash state cannot be restored, starting over" ) );
+    }
+    else
+    {
+        pxDownload->_internal.ulRequestOffset = xSaved.ulOffset;
+        pxDownload->_internal.ulWriteOffset = xSaved.ulOffset;
+        pxDownload->_internal.xStats.ulResumeOffset = xSaved.ulOffset;
+        pxCheckpoint->xSHA256Context = xSaved.xSHA256Context;
+
+        if( pxDownload->_internal.pxPatch != NULL )
+        {
+            ( void ) AzureIoTADUPatch_Resume( pxDownload->_internal.pxPatch, &xSaved.xPatchState );
+        }
+
+        if( xSaved.ulOffset == xSaved.ulFileSize )
+        {
+            ( void ) prvADUDownloadFinishSHA256( pxDownload );
+        }
+    }
+
+    /* Replace a checkpoint of another file right away, so it is never applied to this one. */
+    if( pxDownload->_internal.ulWriteOffset == 0 )
+    {
+        ( void ) prvADUDownloadSaveCheckpoint( pxDownload );
+    }
+    else
+    {
+        pxCheckpoint->ulOffset = pxDownload->_internal.ulWriteOffset;
+    }
+}
+/*-----------------------------------------------------------*/
+
+static bool prvADUDownloadCheckpointEnabled( AzureIoTADUDownload_t * pxDownload )
+{
+    /* The decoder state cannot be saved, a decoded download always starts over. */
+    return ( pxDownload->_internal.ulCheckpointInterval > 0 ) && ( pxDownload->_internal.pxDecoder == NULL );
+}
+/*-----------------------------------------------------------*/
+
+/**
+ * Pass decoded bytes to the patch, or write them to flash.
+ *
+ */
+static AzureIoTResult_t prvADUDownloadStore( AzureIoTADUDownload_t * pxDownload,
+                                             const uint8_t * pucData,
+                                             uint32_t ulLength )
+{
+    AzureIoTResult_t xResult;
+
+    if( pxDownload->_internal.pxPatch != NULL )
+    {
+        /* Whether the patch ends with the file is checked once the file is complete. */
+        if( ( xResult = AzureIoTADUPatch_Write( pxDownload->_internal.pxPatch, pucData, ulLength ) ) == eAzureIoTErrorPending )
+        {
+            xResult = eAzureIoTSuccess;
+        }
+    }
+    else if( pxDownload->_internal.pxWriter != NULL )
+    {
+        xResult = AzureIoTADUFlashWriter_Write( pxDownload->_internal.pxWriter,
+                                                pxDownload->_internal.ulOutputOffset,
+                                                pucData, ulLength );
+    }
+    else
+    {
+        xResult = AzureIoTPlatform_WriteBlock( pxDownload->_internal.pxImage,
+                                               pxDownload->_internal.ulOutputOffset,
+                                               ( uint8_t * ) pucData, ulLength );
+    }
+
+    if( ( xResult == eAzureIoTSuccess ) && ( pxDownload->_internal.pxDecoder != NULL ) &&
+        ( pxDownload->_internal.xHash == eAzureIoTADUDownloadHashDecoded ) )
+    {
+        xResult = AzureIoTCrypto_SHA256Update( &pxDownload->_internal.xCheckpoint.xSHA256Context, pucData, ulLength );
+    }
+
+    if( xResult != eAzureIoTSuccess )
+    {
+        AZLogError( ( "AzureIoTADUDownload failed to write block at offset %u: error=0x%08x",
+                      pxDownload->_internal.ulOutputOffset, ( uint16_t ) xResult ) );
+    }
+    else
+    {
+        pxDownload->_internal.ulOutputOffset += ulLength;
+    }
+
+    return xResult;
+}
+/*-----------------------------------------------------------*/
+
+static AzureIoTResult_t prvADUDownloadDecode( AzureIoTADUDownload_t * pxDownload,
+                                              const uint8_t * pucData,
+                                              uint32_t ulLength )
+{
+    const AzureIoTADUDecoderInterface_t * pxDecoder = pxDownload->_internal.pxDecoder;
+    AzureIoTResult_t xResult;
+    uint32_t ulConsumed;
+    uint32_t ulProduced;
+
+    do
+    {
+        if( ( xResult = pxDecoder->xDecode( pxDecoder->pvDecoderContext, pucData, ulLength, &ulConsumed,
+                                            pxDownload->_internal.pucDecodeBuffer,
+                                            pxDownload->_internal.ulDecodeBufferLength,
+                                            &ulProduced ) ) != eAzureIoTSuccess )
+        {
+            AZLogError( ( "AzureIoTADUDownload failed to decode: error=0x%08x", ( uint16_t ) xResult ) );
+            break;
+        }
+
+        if( ( ulProduced > 0 ) &&
+            ( ( xResult = prvADUDownloadStore( pxDownload, pxDownload->_internal.pucDecodeBuffer, ulProduced ) ) != eAzureIoTSuccess ) )
+        {
+            break;
+        }
+
+        pxDownload->_internal.xStats.ulBytesDecoded += ulProduced;
+        pucData += ulConsumed;
+        ulLength -= ulConsumed;
+
+        /* A full buffer may leave output pending in the decoder, even with all input consumed. */
+    } while( ( ulLength > 0 ) || ( ulProduced == pxDownload->_internal.ulDecodeBufferLength ) );
+
+    return xResult;
+}
+/*-----------------------------------------------------------*/
+
+/**
+ * Write received bytes of the file, in file order, and add them to the hash.
+ *
+ */
+static AzureIoTResult_t prvADUDownloadWrite( AzureIoTADUDownload_t * pxDownload,
+                                             const uint8_t * pucData,
+                                             uint32_t ulLength )
+{
+    AzureIoTResult_t xResult;
+
+    if( pxDownload->_internal.pxDecoder != NULL )
+    {
+        xResult = prvADUDownloadDecode( pxDownload, pucData, ulLength );
+    }
+    else
+    {
+        xResult = prvADUDownloadStore( pxDownload, pucData, ulLength );
+    }
+
+    /* The hash covers the file as written. */
+    if( ( xResult == eAzureIoTSuccess ) &&
+        ( ( pxDownload->_internal.pxDecoder == NULL ) ||
+          ( pxDownload->_internal.xHash == eAzureIoTADUDownloadHashDownloaded ) ) &&
+        ( ( xResult = AzureIoTCrypto_SHA256Update( &pxDownload->_internal.xCheckpoint.xSHA256Context,
+                                                   pucData, ulLength ) ) != eAzureIoTSuccess ) )
+    {
+        AZLogError( ( "AzureIoTADUDownload failed to hash: error=0x%08x", ( uint16_t ) xResult ) );
+    }
+
+    return xResult;
+}
+/*-----------------------------------------------------------*/
+
+/**
+ * AzureIoTHTTPBodyCallback_t of streamed requests, writes each fragment as it is received.
+ *
+ */
+static AzureIoTHTTPResult_t prvADUDownloadStreamBody( void * pvCallbackContext,
+                                                      const uint8_t * pucData,
+                                                      uint32_t ulDataLength )
+{
+    AzureIoTADUDownload_t * pxDownload = ( AzureIoTADUDownload_t * ) pvCallbackContext;
+
+    if( ( pxDownload->_internal.ulStreamRangeLength - pxDownload->_internal.ulStreamLength ) < ulDataLength )
+    {
+        AZLogError( ( "AzureIoTADUDownload_Fetch invalid range response: longer than %u",
+                      pxDownload->_internal.ulStreamRangeLength ) );
+        pxDownload->_internal.xStreamResult = eAzureIoTErrorInvalidResponse;
+        return eAzureIoTHTTPInvalidResponse;
+    }
+
+    if( ( pxDownload->_internal.xStreamResult = prvADUDownloadWrite( pxDownload, pucData, ulDataLength ) ) != eAzureIoTSuccess )
+    {
+        return eAzureIoTHTTPError;
+    }
+
+    pxDownload->_internal.ulStreamLength += ulDataLength;
+
+    return eAzureIoTHTTPSuccess;
+}
+/*-----------------------------------------------------------*/
+
+AzureIoTResult_t AzureIoTADUDownload_Init( AzureIoTADUDownload_t * pxDownload,
+                                           AzureIoTHTTPHandle_t xHTTPHandle,
+                                           AzureADUImage_t * pxImage,
+                                           uint8_t * pucBuffer,
+                                           uint32_t ulBufferLength,
+                                           uint32_t ulChunkSize )
+{
+    AzureIoTResult_t xResult;
+    uint32_t ulIndex;
+
+    if( ( pxDownload == NULL ) || ( xHTTPHandle == NULL ) ||
+        ( pxImage == NULL ) || ( pucBuffer == NULL ) || ( ulChunkSize == 0 ) )
+    {
+        AZLogError( ( "AzureIoTADUDownload_Init failed: invalid argument" ) );
+        xResult = eAzureIoTErrorInvalidArgument;
+    }
+    else if( ulBufferLength < azureiotaduDOWNLOAD_BUFFER_SIZE( ulChunkSize ) )
+    {
+        AZLogError( ( "AzureIoTADUDownload_Init failed: buffer too small for chunk size %u", ulChunkSize ) );
+        xResult = eAzureIoTErrorOutOfMemory;
+    }
+    else
+    {
+        memset( pxDownload, 0, sizeof( AzureIoTADUDownload_t ) );
+
+        pxDownload->_internal.xHTTPHandle = xHTTPHandle;
+        pxDownload->_internal.pxImage = pxImage;
+        pxDownload->_internal.ulChunkSize = ulChunkSize;
+        pxDownload->_internal.ulMaxChunkSize = ulChunkSize;
+        pxDownload->_internal.ulStepsPerHubProcess = 1;
+
+        pxDownload->_internal.pucHeaderBuffer = ( char * ) pucBuffer;
+        pxDownload->_internal.ulHeaderBufferLength = azureiotconfigADU_DOWNLOAD_REQUEST_HEADER_MAX;
+        pxDownload->_internal.ulBufferLength = ( ulBufferLength - azureiotconfigADU_DOWNLOAD_REQUEST_HEADER_MAX ) /
+                                               azureiotaduDOWNLOAD_BUFFER_COUNT;
+
+        for( ulIndex = 0; ulIndex < azureiotaduDOWNLOAD_BUFFER_COUNT; ulIndex++ )
+        {
+            pxDownload->_internal.pucBuffers[ ulIndex ] = ( char * ) pucBuffer +
+                                                          azureiotconfigADU_DOWNLOAD_REQUEST_HEADER_MAX +
+                                                          ulIndex * pxDownload->_internal.ulBufferLength;
+        }
+
+        xResult = eAzureIoTSuccess;
+    }
+
+    return xResult;
+}
+/*-----------------------------------------------------------*/
+
+AzureIoTResult_t AzureIoTADUDownload_SetCheckpoint( AzureIoTADUDownload_t * pxDownload,
+                                                    const uint8_t * pucFileId,
+                                                    uint32_t ulFileIdLength,
+                                                    const uint8_t * pucFileHash,
+                                                    uint32_t ulFileHashLength,
+                                                    uint32_t ulInterval )
+{
+    AzureIoTResult_t xResult;
+    AzureIoTADUDownloadCheckpoint_t * pxCheckpoint;
+
+    if( ( pxDownload == NULL ) ||
+        ( pucFileId == NULL ) || ( ulFileIdLength == 0 ) ||
+        ( pucFileHash == NULL ) || ( ulFileHashLength == 0 ) )
+    {
+        AZLogError( ( "AzureIoTADUDownload_SetCheckpoint failed: invalid argument" ) );
+        xResult = eAzureIoTErrorInvalidArgument;
+    }
+    else if( ( ulFileIdLength > azureiotconfigADU_DOWNLOAD_CHECKPOINT_FILE_ID_MAX ) ||
+             ( ulFileHashLength > azureiotconfigADU_DOWNLOAD_CHECKPOINT_HASH_MAX ) )
+    {
+        AZLogError( ( "AzureIoTADUDownload_SetCheckpoint failed: file ID or hash too long" ) );
+        xResult = eAzureIoTErrorOutOfMemory;
+    }
+    else
+    {
+        pxCheckpoint = &pxDownload->_internal.xCheckpoint;
+        memset( pxCheckpoint, 0, sizeof( AzureIoTADUDownloadCheckpoint_t ) );
+        pxCheckpoint->ulVersion = azureiotaduDOWNLOAD_CHECKPOINT_VERSION;
+        pxCheckpoint->ulSHA256Layout = azureiotcryptoSHA256_CONTEXT_LAYOUT;
+        pxCheckpoint->ulFileIdLength = ulFileIdLength;
+        pxCheckpoint->ulFileHashLength = ulFileHashLength;
+        memcpy( pxCheckpoint->ucFileId, pucFileId, ulFileIdLength );
+        memcpy( pxCheckpoint->ucFileHash, pucFileHash, ulFileHashLength );
+
+        pxDownload->_internal.ulCheckpointInterval = ( ulInterval == 0 ) ?
+                                                     azureiotconfigADU_DOWNLOAD_CHECKPOINT_INTERVAL : ulInterval;
+        xResult = eAzureIoTSuccess;
+    }
+
+    return xResult;
+}
+/*-----------------------------------------------------------*/
+
+AzureIoTResult_t AzureIoTADUDownload_SetAdaptiveChunkSize( AzureIoTADUDownload_t * pxDownload,
+                                                           uint32_t ulMinChunkSize )
+{
+    AzureIoTResult_t xResult;
+    uint32_t ulLevelCount = 1;
+
+    if( ( pxDownload == NULL ) || ( ulMinChunkSize == 0 ) ||
+        ( ulMinChunkSize > pxDownload->_internal.ulMaxChunkSize ) )
+    {
+        AZLogError( ( "AzureIoTADUDownload_SetAdaptiveChunkSize failed: invalid argument" ) );
+        xResult = eAzureIoTErrorInvalidArgument;
+    }
+    else
+    {
+        while( ( ulLevelCount < azureiotaduDOWNLOAD_ADAPTIVE_LEVEL_COUNT ) &&
+               ( ( ulMinChunkSize << ulLevelCount ) <= pxDownload->_internal.ulMaxChunkSize ) )
+        {
+            ulLevelCount++;
+        }
+
+        pxDownload->_internal.ulMinChunkSize = ulMinChunkSize;
+        pxDownload->_internal.ulChunkLevelCount = ulLevelCount;
+        xResult = eAzureIoTSuccess;
+    }
+
+    return xResult;
+}
+/*-----------------------------------------------------------*/
+
+AzureIoTResult_t AzureIoTADUDownload_SetPatch( AzureIoTADUDownload_t * pxDownload,
+                                               AzureIoTADUPatch_t * pxPatch )
+{
+    if( pxDownload == NULL )
+    {
+        AZLogError( ( "AzureIoTADUDownload_SetPatch failed: invalid argument" ) );
+        return eAzureIoTErrorInvalidArgument;
+    }
+
+    pxDownload->_internal.pxPatch = pxPatch;
+
+    return eAzureIoTSuccess;
+}
+/*-----------------------------------------------------------*/
+
+AzureIoTResult_t AzureIoTADUDownload_SetDecoder( AzureIoTADUDownload_t * pxDownload,
+                                                 const AzureIoTADUDecoderInterface_t * pxDecoder,
+                                                 uint8_t * pucBuffer,
+                                                 uint32_t ulBufferLength,
+                                                 AzureIoTADUDownloadHash_t xHash )
+{
+    if( ( pxDownload == NULL ) ||
+        ( ( pxDecoder != NULL ) &&
+          ( ( pxDecoder->xReset == NULL ) || ( pxDecoder->xDecode == NULL ) ||
+            ( pucBuffer == NULL ) || ( ulBufferLength == 0 ) ) ) )
+    {
+        AZLogError( ( "AzureIoTADUDownload_SetDecoder failed: invalid argument" ) );
+        return eAzureIoTErrorInvalidArgument;
+    }
+
+    pxDownload->_internal.pxDecoder = pxDecoder;
+    pxDownload->_internal.pucDecodeBuffer = pucBuffer;
+    pxDownload->_internal.ulDecodeBufferLength = ulBufferLength;
+    pxDownload->_internal.xHash = xHash;
+
+    return eAzureIoTSuccess;
+}
+/*-----------------------------------------------------------*/
+
+AzureIoTResult_t AzureIoTADUDownload_SetStreaming( AzureIoTADUDownload_t * pxDownload,
+                                                   uint32_t ulChunkSize )
+{
+    if( pxDownload == NULL )
+    {
+        AZLogError( ( "AzureIoTADUDownload_SetStreaming failed: invalid argument" ) );
+        return eAzureIoTErrorInvalidArgument;
+    }
+
+    pxDownload->_internal.xStreaming = ( ulChunkSize > 0 );
+    pxDownload->_internal.ulMaxChunkSize = ( ulChunkSize > 0 ) ? ulChunkSize :
+                                           pxDownload->_internal.ulBufferLength - azureiotconfigADU_DOWNLOAD_RESPONSE_HEADER_MAX;
+    pxDownload->_internal.ulChunkSize = pxDownload->_internal.ulMaxChunkSize;
+    pxDownload->_internal.ulMinChunkSize = 0;
+    pxDownload->_internal.ulChunkLevelCount = 0;
+
+    return eAzureIoTSuccess;
+}
+/*-----------------------------------------------------------*/
+
+AzureIoTResult_t AzureIoTADUDownload_SetPipelining( AzureIoTADUDownload_t * pxDownload,
+                                                    bool xEnable )
+{
+    if( pxDownload == NULL )
+    {
+        AZLogError( ( "AzureIoTADUDownload_SetPipelining failed: invalid argument" ) );
+        return eAzureIoTErrorInvalidArgument;
+    }
+
+    pxDownload->_internal.xPipelining = xEnable;
+    pxDownload->_internal.ulPipelinedLength = 0;
+
+    return eAzureIoTSuccess;
+}
+/*-----------------------------------------------------------*/
+
+AzureIoTResult_t AzureIoTADUDownload_SetConnect( AzureIoTADUDownload_t * pxDownload,
+                                                 AzureIoTTransportConnect_t xConnect,
+                                                 void * pvConnectContext )
+{
+    if( pxDownload == NULL )
+    {
+        AZLogError( ( "AzureIoTADUDownload_SetConnect failed: invalid argument" ) );
+        return eAzureIoTErrorInvalidArgument;
+    }
+
+    pxDownload->_internal.xConnect = xConnect;
+    pxDownload->_internal.pvConnectContext = pvConnectContext;
+
+    return eAzureIoTSuccess;
+}
+/*-----------------------------------------------------------*/
+
+AzureIoTResult_t AzureIoTADUDownload_SetFlashWriter( AzureIoTADUDownload_t * pxDownload,
+                                                     AzureIoTADUFlashWriter_t * pxWriter )
+{
+    if( pxDownload == NULL )
+    {
+        AZLogError( ( "AzureIoTADUDownload_SetFlashWriter failed: invalid argument" ) );
+        return eAzureIoTErrorInvalidArgument;
+    }
+
+    pxDownload->_internal.pxWriter = pxWriter;
+
+    return eAzureIoTSuccess;
+}
+/*-----------------------------------------------------------*/
+
+AzureIoTResult_t AzureIoTADUDownload_SetTimeSlice( AzureIoTADUDownload_t * pxDownload,
+                                                   uint32_t ulSliceMilliseconds )
+{
+    if( pxDownload == NULL )
+    {
+        AZLogError( ( "AzureIoTADUDownload_SetTimeSlice failed: invalid argument" ) );
+        return eAzureIoTErrorInvalidArgument;
+    }
+
+    pxDownload->_internal.ulSliceMilliseconds = ulSliceMilliseconds;
+
+    return eAzureIoTSuccess;
+}
+/*-----------------------------------------------------------*/
+
+AzureIoTResult_t AzureIoTADUDownload_SetPriority( AzureIoTADUDownload_t * pxDownload,
+                                                  uint32_t ulStepsPerHubProcess,
+                                                  uint32_t ulHubProcessMilliseconds )
+{
+    if( ( pxDownload == NULL ) || ( ulStepsPerHubProcess == 0 ) )
+    {
+        AZLogError( ( "AzureIoTADUDownload_SetPriority failed: invalid argument" ) );
+        return eAzureIoTErrorInvalidArgument;
+    }
+
+    pxDownload->_internal.ulStepsPerHubProcess = ulStepsPerHubProcess;
+    pxDownload->_internal.ulHubProcessMilliseconds = ulHubProcessMilliseconds;
+
+    return eAzureIoTSuccess;
+}
+/*-----------------------------------------------------------*/
+
+AzureIoTResult_t AzureIoTADUDownload_Start( AzureIoTADUDownload_t * pxDownload,
+                                            AzureIoTTransportInterface_t * pxHTTPTransport,
+                                            const char * pucURL,
+                                            uint32_t ulURLLength,
+                                            const char * pucPath,
+                                            uint32_t ulPathLength,
+                                            uint32_t ulFileSize )
+{
+    AzureIoTResult_t xResult;
+    AzureIoTHTTPResult_t xHTTPResult;
+    int32_t lFileSize;
+
+    if( ( pxDownload == NULL ) || ( pxHTTPTransport == NULL ) ||
+        ( pucURL == NULL ) || ( ulURLLength == 0 ) ||
+        ( pucPath == NULL ) || ( ulPathLength == 0 ) )
+    {
+        AZLogError( ( "AzureIoTADUDownload_Start failed: invalid argument" ) );
+        return eAzureIoTErrorInvalidArgument;
+    }
+
+    pxDownload->_internal.pxHTTPTransport = pxHTTPTransport;
+    pxDownload->_internal.pucURL = pucURL;
+    pxDownload->_internal.ulURLLength = ulURLLength;
+    pxDownload->_internal.pucPath = pucPath;
+    pxDownload->_internal.ulPathLength = ulPathLength;
+    pxDownload->_internal.ulRequestOffset = 0;
+    pxDownload->_internal.ulWriteOffset = 0;
+    pxDownload->_internal.ulFetchCount = 0;
+    pxDownload->_internal.ulCommitCount = 0;
+    pxDownload->_internal.ulEndTimeMs = 0;
+    pxDownload->_internal.ulSliceBytesPerSecond = 0;
+    pxDownload->_internal.ulRetryCount = 0;
+    memset( &pxDownload->_internal.xStats, 0, sizeof( pxDownload->_internal.xStats ) );
+    pxDownload->_internal.ulStartTimeMs = prvADUDownloadGetTimeMilliseconds();
+
+    if( pxDownload->_internal.ulMinChunkSize > 0 )
+    {
+        /* Each download starts small and grows, the link may not be the one of the last download. */
+        pxDownload->_internal.ulChunkSize = pxDownload->_internal.ulMinChunkSize;
+        pxDownload->_internal.ulChunkLevel = 0;
+        pxDownload->_internal.ulWindowRequests = 0;
+        pxDownload->_internal.ulWindowBytes = 0;
+        pxDownload->_internal.ulWindowMilliseconds = 0;
+        pxDownload->_internal.ulStableWindows = 0;
+        memset( pxDownload->_internal.ulLevelBytesPerSecond, 0, sizeof( pxDownload->_internal.ulLevelBytesPerSecond ) );
+    }
+
+    pxDownload->_internal.xStats.ulChunkSize = pxDownload->_internal.ulChunkSize;
+
+    /* Both reset the connection of the handle, the size request first when the size is not known. */
+    if( ulFileSize == 0 )
+    {
+        xHTTPResult = AzureIoTHTTP_RequestSizeInit( pxDownload->_internal.xHTTPHandle,
+                                                    pxHTTPTransport,
+                                                    pucURL, ulURLLength,
+                                                    pucPath, ulPathLength,
+                                                    pxDownload->_internal.pucHeaderBuffer,
+                                                    pxDownload->_internal.ulHeaderBufferLength );
+    }
+    else
+    {
+        xHTTPResult = AzureIoTHTTP_Init( pxDownload->_internal.xHTTPHandle,
+                                         pxHTTPTransport,
+                                         pucURL, ulURLLength,
+                                         pucPath, ulPathLength,
+                                         pxDownload->_internal.pucHeaderBuffer,
+                                         pxDownload->_internal.ulHeaderBufferLength );
+    }
+
+    if( xHTTPResult != eAzureIoTHTTPSuccess )
+    {
+        AZLogError( ( "AzureIoTADUDownload_Start failed to init request: error=0x%08x", ( uint16_t ) xHTTPResult ) );
+        xResult = eAzureIoTErrorFailed;
+    }
+    else if( ( xHTTPResult = AzureIoTHTTP_InitConnection( pxDownload->_internal.xHTTPHandle, pxHTTPTransport,
+                                                          pxDownload->_internal.xConnect,
+                                                          pxDownload->_internal.pvConnectContext ) ) != eAzureIoTHTTPSuccess )
+    {
+        AZLogError( ( "AzureIoTADUDownload_Start failed to init connection: error=0x%08x", ( uint16_t ) xHTTPResult ) );
+        xResult = eAzureIoTErrorFailed;
+    }
+    else if( ulFileSize == 0 )
+    {
+        if( ( lFileSize = AzureIoTHTTP_RequestSize( pxDownload->_internal.xHTTPHandle,
+                                                    pxDownload->_internal.pucBuffers[ 0 ],
+                                                    pxDownload->_internal.ulBufferLength ) ) <= 0 )
+        {
+            AZLogError( ( "AzureIoTADUDownload_Start failed to get file size" ) );
+            xResult = eAzureIoTErrorFailed;
+        }
+        else
+        {
+            pxDownload->_internal.ulFileSize = ( uint32_t ) lFileSize;
+            xResult = eAzureIoTSuccess;
+        }
+    }
+    else
+    {
+        pxDownload->_internal.ulFileSize = ulFileSize;
+        xResult = eAzureIoTSuccess;
+    }
+
+    if( xResult == eAzureIoTSuccess )
+    {
+        pxDownload->_internal.xSHA256Ready = false;
+
+        if( ( xResult = AzureIoTCrypto_SHA256Init( &pxDownload->_internal.xCheckpoint.xSHA256Context ) ) != eAzureIoTSuccess )
+        {
+            AZLogError( ( "AzureIoTADUDownload_Start failed to init SHA256: error=0x%08x", ( uint16_t ) xResult ) );
+            return xResult;
+        }
+
+        if( ( pxDownload->_internal.pxPatch != NULL ) &&
+            ( ( xResult = AzureIoTADUPatch_Start( pxDownload->_internal.pxPatch ) ) != eAzureIoTSuccess ) )
+        {
+            AZLogError( ( "AzureIoTADUDownload_Start failed to start patch: error=0x%08x", ( uint16_t ) xResult ) );
+            return xResult;
+        }
+
+        if( pxDownload->_internal.pxPatch != NULL )
+        {
+            ( void ) AzureIoTADUPatch_SetFlashWriter( pxDownload->_internal.pxPatch, pxDownload->_internal.pxWriter );
+        }
+
+        if( pxDownload->_internal.pxWriter != NULL )
+        {
+            /* Drop bytes left over from a download that did not complete. */
+            ( void ) AzureIoTADUFlashWriter_Reset( pxDownload->_internal.pxWriter );
+        }
+
+        if( ( pxDownload->_internal.pxDecoder != NULL ) &&
+            ( ( xResult = pxDownload->_internal.pxDecoder->xReset( pxDownload->_internal.pxDecoder->pvDecoderContext ) ) != eAzureIoTSuccess ) )
+        {
+            AZLogError( ( "AzureIoTADUDownload_Start failed to reset decoder: error=0x%08x", ( uint16_t ) xResult ) );
+            return xResult;
+        }
+
+        if( prvADUDownloadCheckpointEnabled( pxDownload ) )
+        {
+            prvADUDownloadResume( pxDownload );
+        }
+        else if( ( pxDownload->_internal.ulCheckpointInterval > 0 ) && ( pxDownload->_internal.pxDecoder != NULL ) )
+        {
+            AZLogWarn( ( "AzureIoTADUDownload checkpoints are not supported with a decoder, the download is not resumable" ) );
+        }
+
+        pxDownload->_internal.ulOutputOffset = pxDownload->_internal.ulWriteOffset;
+
+        AZLogInfo( ( "AzureIoTADUDownload starting download of %u bytes at offset %u in chunks of %u bytes",
+                     pxDownload->_internal.ulFileSize, pxDownload->_internal.ulWriteOffset,
+                     pxDownload->_internal.ulChunkSize ) );
+    }
+
+    return xResult;
+}
+/*-----------------------------------------------------------*/
+
+/**
+ * Streamed range request. The chunk is published with no data, as it is already written.
+ *
+ */
+static AzureIoTResult_t prvADUDownloadFetchStream( AzureIoTADUDownload_t * pxDownload,
+                                                   uint32_t ulIndex,
+                                                   uint32_t ulRangeStart,
+                                                   uint32_t ulRangeLength,
+                                                   uint32_t ulStartMs )
+{
+    AzureIoTHTTPResult_t xHTTPResult;
+    AzureIoTResult_t xResult = eAzureIoTSuccess;
+    uint32_t ulElapsedMs;
+    uint32_t ulDataLength = 0;
+
+    pxDownload->_internal.ulStreamRangeLength = ulRangeLength;
+    pxDownload->_internal.ulStreamLength = 0;
+    pxDownload->_internal.xStreamResult = eAzureIoTSuccess;
+    pxDownload->_internal.ulPipelinedLength = 0;
+
+    if( pxDownload->_internal.xPipelining && ( ( ulRangeStart + ulRangeLength ) < pxDownload->_internal.ulFileSize ) )
+    {
+        /* The next range is fixed now, the adapted chunk size applies to the one after. */
+        pxDownload->_internal.ulPipelinedOffset = ulRangeStart + ulRangeLength;
+        pxDownload->_internal.ulPipelinedLength = pxDownload->_internal.ulFileSize - pxDownload->_internal.ulPipelinedOffset;
+
+        if( pxDownload->_internal.ulPipelinedLength > prvADUDownloadMaxRangeLength( pxDownload ) )
+        {
+            pxDownload->_internal.ulPipelinedLength = prvADUDownloadMaxRangeLength( pxDownload );
+        }
+
+        ( void ) AzureIoTHTTP_SetNextRange( pxDownload->_internal.xHTTPHandle,
+                                            ( int32_t ) pxDownload->_internal.ulPipelinedOffset,
+                                            ( int32_t ) ( pxDownload->_internal.ulPipelinedOffset +
+                                                          pxDownload->_internal.ulPipelinedLength - 1 ) );
+    }
+
+    /* The chunk buffers are contiguous, all of them receive the fragments. */
+    xHTTPResult = AzureIoTHTTP_RequestStream( pxDownload->_internal.xHTTPHandle,
+                                              ( int32_t ) ulRangeStart,
+                                              ( int32_t ) ( ulRangeStart + ulRangeLength - 1 ),
+                                              pxDownload->_internal.pucBuffers[ 0 ],
+                                              pxDownload->_internal.ulBufferLength * azureiotaduDOWNLOAD_BUFFER_COUNT,
+                                              prvADUDownloadStreamBody,
+                                              pxDownload,
+                                              &ulDataLength );
+    ulElapsedMs = prvADUDownloadGetTimeMilliseconds() - ulStartMs;
+
+    if( pxDownload->_internal.xStreamResult != eAzureIoTSuccess )
+    {
+        /* What was written before cannot be taken back, the download can not continue. */
+        AZLogError( ( "AzureIoTADUDownload_Fetch failed to write range %u-%u: error=0x%08x",
+                      ulRangeStart, ulRangeStart + ulRangeLength - 1, ( uint16_t ) pxDownload->_internal.xStreamResult ) );
+        return pxDownload->_internal.xStreamResult;
+    }
+
+    if( xHTTPResult != eAzureIoTHTTPSuccess )
+    {
+        AZLogError( ( "AzureIoTADUDownload_Fetch failed range %u-%u after %u bytes: error=0x%08x",
+                      ulRangeStart, ulRangeStart + ulRangeLength - 1,
+                      pxDownload->_internal.ulStreamLength, ( uint16_t ) xHTTPResult ) );
+        pxDownload->_internal.xStats.ulRequestErrorCount++;
+        prvADUDownloadAdaptChunkSize( pxDownload, 0, ulElapsedMs, true );
+        xResult = eAzureIoTErrorFailed;
+    }
+    else if( pxDownload->_internal.ulStreamLength == 0 )
+    {
+        AZLogError( ( "AzureIoTADUDownload_Fetch invalid range response: length=0" ) );
+        return eAzureIoTErrorInvalidResponse;
+    }
+    else
+    {
+        prvADUDownloadAdaptChunkSize( pxDownload, pxDownload->_internal.ulStreamLength, ulElapsedMs, false );
+        prvADUDownloadMeasureSlice( pxDownload, pxDownload->_internal.ulStreamLength, ulElapsedMs );
+    }
+
+    pxDownload->_internal.xStats.ulFetchMilliseconds += ulElapsedMs;
+    pxDownload->_internal.xStats.ulBytesDownloaded += pxDownload->_internal.ulStreamLength;
+
+    /* Bytes received before a failure are written, keep them. */
+    if( pxDownload->_internal.ulStreamLength > 0 )
+    {
+        pxDownload->_internal.pucChunkData[ ulIndex ] = NULL;
+        pxDownload->_internal.ulChunkLength[ ulIndex ] = pxDownload->_internal.ulStreamLength;
+        pxDownload->_internal.ulChunkOffset[ ulIndex ] = ulRangeStart;
+        pxDownload->_internal.ulRequestOffset = ulRangeStart + pxDownload->_internal.ulStreamLength;
+        pxDownload->_internal.ulFetchCount++;
+    }
+
+    return xResult;
+}
+/*-----------------------------------------------------------*/
+
+AzureIoTResult_t AzureIoTADUDownload_Fetch( AzureIoTADUDownload_t * pxDownload )
+{
+    AzureIoTHTTPResult_t xHTTPResult;
+    uint32_t ulIndex;
+    uint32_t ulRangeStart;
+    uint32_t ulRangeLength;
+    uint32_t ulStartMs;
+    uint32_t ulElapsedMs;
+    char * pucData = NULL;
+    uint32_t ulDataLength = 0;
+
+    if( pxDownload == NULL )
+    {
+        AZLogError( ( "AzureIoTADUDownload_Fetch failed: invalid argument" ) );
+        return eAzureIoTErrorInvalidArgument;
+    }
+
+    if( pxDownload->_internal.ulRequestOffset >= pxDownload->_internal.ulFileSize )
+    {
+        /* Whole file already requested. */
+        return eAzureIoTSuccess;
+    }
+
+    if( ( pxDownload->_internal.ulFetchCount - pxDownload->_internal.ulCommitCount ) >=
+        ( pxDownload->_internal.xStreaming ? 1U : azureiotaduDOWNLOAD_BUFFER_COUNT ) )
+    {
+        /* A streamed chunk is written as it is received, so it waits for the previous one to be committed. */
+        return eAzureIoTErrorOutOfMemory;
+    }
+
+    ulIndex = pxDownload->_internal.ulFetchCount % azureiotaduDOWNLOAD_BUFFER_COUNT;
+    ulRangeStart = pxDownload->_internal.ulRequestOffset;
+    ulRangeLength = pxDownload->_internal.ulFileSize - ulRangeStart;
+
+    if( ulRangeLength > prvADUDownloadMaxRangeLength( pxDownload ) )
+    {
+        ulRangeLength = prvADUDownloadMaxRangeLength( pxDownload );
+    }
+
+    if( pxDownload->_internal.xStreaming && ( pxDownload->_internal.ulPipelinedLength > 0 ) &&
+        ( pxDownload->_internal.ulPipelinedOffset == ulRangeStart ) )
+    {
+        /* Already requested, ask for the same range to read its response. */
+        ulRangeLength = pxDownload->_internal.ulPipelinedLength;
+    }
+
+    ulStartMs = prvADUDownloadGetTimeMilliseconds();
+
+    /* Headers are rebuilt for each request, so only a single range header is sent. */
+    if( ( xHTTPResult = AzureIoTHTTP_InitNextRequest( pxDownload->_internal.xHTTPHandle ) ) != eAzureIoTHTTPSuccess )
+    {
+        AZLogError( ( "AzureIoTADUDownload_Fetch failed to init request: error=0x%08x", ( uint16_t ) xHTTPResult ) );
+        return eAzureIoTErrorInitFailed;
+    }
+
+    pxDownload->_internal.xStats.ulRequestCount++;
+
+    if( pxDownload->_internal.xStreaming )
+    {
+        return prvADUDownloadFetchStream( pxDownload, ulIndex, ulRangeStart, ulRangeLength, ulStartMs );
+    }
+
+    if( ( xHTTPResult = AzureIoTHTTP_Request( pxDownload->_internal.xHTTPHandle,
+                                              ( int32_t ) ulRangeStart,
+                                              ( int32_t ) ( ulRangeStart + ulRangeLength - 1 ),
+                                              pxDownload->_internal.pucBuffers[ ulIndex ],
+                                              pxDownload->_internal.ulBufferLength,
+                                              &pucData,
+                                              &ulDataLength ) ) != eAzureIoTHTTPSuccess )
+    {
+        AZLogError( ( "AzureIoTADUDownload_Fetch failed range %u-%u: error=0x%08x",
+                      ulRangeStart, ulRangeStart + ulRangeLength - 1, ( uint16_t ) xHTTPResult ) );
+        pxDownload->_internal.xStats.ulRequestErrorCount++;
+        prvADUDownloadAdaptChunkSize( pxDownload, 0, prvADUDownloadGetTimeMilliseconds() - ulStartMs, true );
+        return eAzureIoTErrorFailed;
+    }
+
+    if( ( pucData == NULL ) || ( ulDataLength == 0 ) || ( ulDataLength > ulRangeLength ) )
+    {
+        AZLogError( ( "AzureIoTADUDownload_Fetch invalid range response: length=%u", ulDataLength ) );
+        return eAzureIoTErrorInvalidResponse;
+    }
+
+    ulElapsedMs = prvADUDownloadGetTimeMilliseconds() - ulStartMs;
+    pxDownload->_internal.xStats.ulFetchMilliseconds += ulElapsedMs;
+    pxDownload->_internal.xStats.ulBytesDownloaded += ulDataLength;
+
+    pxDownload->_internal.pucChunkData[ ulIndex ] = pucData;
+    pxDownload->_internal.ulChunkLength[ ulIndex ] = ulDataLength;
+    pxDownload->_internal.ulChunkOffset[ ulIndex ] = ulRangeStart;
+
+    /* A short read is not an error, the next request continues from where this one ended. */
+    pxDownload->_internal.ulRequestOffset = ulRangeStart + ulDataLength;
+
+    prvADUDownloadAdaptChunkSize( pxDownload, ulDataLength, ulElapsedMs, false );
+    prvADUDownloadMeasureSlice( pxDownload, ulDataLength, ulElapsedMs );
+
+    /* Publish the chunk last, this is what hands the buffer over to Commit. */
+    pxDownload->_internal.ulFetchCount++;
+
+    return eAzureIoTSuccess;
+}
+/*-----------------------------------------------------------*/
+
+AzureIoTResult_t AzureIoTADUDownload_Commit( AzureIoTADUDownload_t * pxDownload )
+{
+    AzureIoTResult_t xResult;
+    uint32_t ulIndex;
+    uint32_t ulStartMs;
+    uint32_t ulNowMs;
+
+    if( pxDownload == NULL )
+    {
+        AZLogError( ( "AzureIoTADUDownload_Commit failed: invalid argument" ) );
+        return eAzureIoTErrorInvalidArgument;
+    }
+
+    if( pxDownload->_internal.ulWriteOffset >= pxDownload->_internal.ulFileSize )
+    {
+        return eAzureIoTSuccess;
+    }
+
+    if( pxDownload->_internal.ulFetchCount == pxDownload->_internal.ulCommitCount )
+    {
+        /* Nothing received yet. */
+        return eAzureIoTErrorPending;
+    }
+
+    ulIndex = pxDownload->_internal.ulCommitCount % azureiotaduDOWNLOAD_BUFFER_COUNT;
+    ulStartMs = prvADUDownloadGetTimeMilliseconds();
+
+    /* A streamed chunk was already written by Fetch. */
+    if( ( pxDownload->_internal.pucChunkData[ ulIndex ] != NULL ) &&
+        ( ( xResult = prvADUDownloadWrite( pxDownload,
+                                           ( const uint8_t * ) pxDownload->_internal.pucChunkData[ ulIndex ],
+                                           pxDownload->_internal.ulChunkLength[ ulIndex ] ) ) != eAzureIoTSuccess ) )
+    {
+        AZLogError( ( "AzureIoTADUDownload_Commit failed to write chunk at offset %u: error=0x%08x",
+                      pxDownload->_internal.ulChunkOffset[ ulIndex ], ( uint16_t ) xResult ) );
+        return xResult;
+    }
+
+    ulNowMs = prvADUDownloadGetTimeMilliseconds();
+    pxDownload->_internal.xStats.ulWriteMilliseconds += ulNowMs - ulStartMs;
+    pxDownload->_internal.xStats.ulBytesWritten += pxDownload->_internal.ulChunkLength[ ulIndex ];
+    pxDownload->_internal.ulWriteOffset = pxDownload->_internal.ulChunkOffset[ ulIndex ] +
+                                          pxDownload->_internal.ulChunkLength[ ulIndex ];
+
+    /* Release the buffer back to Fetch. */
+    pxDownload->_internal.ulCommitCount++;
+
+    prvADUDownloadUpdateThroughput( pxDownload, ulNowMs );
+
+    if( prvADUDownloadCheckpointEnabled( pxDownload ) &&
+        ( ( ( pxDownload->_internal.ulWriteOffset - pxDownload->_internal.xCheckpoint.ulOffset ) >=
+            pxDownload->_internal.ulCheckpointInterval ) ||
+          ( pxDownload->_internal.ulWriteOffset >= pxDownload->_internal.ulFileSize ) ) )
+    {
+        /* Saved after the write, so the checkpoint never covers bytes missing from flash. */
+        ( void ) prvADUDownloadSaveCheckpoint( pxDownload );
+    }
+
+    if( pxDownload->_internal.ulWriteOffset >= pxDownload->_internal.ulFileSize )
+    {
+        pxDownload->_internal.ulEndTimeMs = ulNowMs;
+
+        /* The patch must end with the file. */
+        if( ( pxDownload->_internal.pxPatch != NULL ) &&
+            ( AzureIoTADUPatch_Write( pxDownload->_internal.pxPatch, NULL, 0 ) != eAzureIoTSuccess ) )
+        {
+            AZLogError( ( "AzureIoTADUDownload_Commit failed: patch truncated" ) );
+            return eAzureIoTErrorInvalidResponse;
+        }
+
+        if( ( pxDownload->_internal.pxWriter != NULL ) &&
+            ( ( xResult = AzureIoTADUFlashWriter_Flush( pxDownload->_internal.pxWriter ) ) != eAzureIoTSuccess ) )
+        {
+            AZLogError( ( "AzureIoTADUDownload_Commit failed to flush: error=0x%08x", ( uint16_t ) xResult ) );
+            return xResult;
+        }
+
+        if( ( xResult = prvADUDownloadFinishSHA256( pxDownload ) ) != eAzureIoTSuccess )
+        {
+            return xResult;
+        }
+
+        AZLogInfo( ( "AzureIoTADUDownload complete: %u bytes, %u requests, %u ms, %u B/s",
+                     pxDownload->_internal.xStats.ulBytesWritten,
+                     pxDownload->_internal.xStats.ulRequestCount,
+                     pxDownload->_internal.xStats.ulElapsedMilliseconds,
+                     pxDownload->_internal.xStats.ulBytesPerSecond ) );
+        xResult = eAzureIoTSuccess;
+    }
+    else
+    {
+        xResult = eAzureIoTErrorPending;
+    }
+
+    return xResult;
+}
+/*-----------------------------------------------------------*/
+
+AzureIoTResult_t AzureIoTADUDownload_Process( AzureIoTADUDownload_t * pxDownload )
+{
+    AzureIoTResult_t xResult;
+
+    if( pxDownload == NULL )
+    {
+        AZLogError( ( "AzureIoTADUDownload_Process failed: invalid argument" ) );
+        xResult = eAzureIoTErrorInvalidArgument;
+    }
+    else if( ( ( xResult = AzureIoTADUDownload_Fetch( pxDownload ) ) != eAzureIoTSuccess ) &&
+             ( xResult != eAzureIoTErrorOutOfMemory ) )
+    {
+        AZLogError( ( "AzureIoTADUDownload_Process failed to fetch: error=0x%08x", ( uint16_t ) xResult ) );
+    }
+    else
+    {
+        xResult = AzureIoTADUDownload_Commit( pxDownload );
+    }
+
+    return xResult;
+}
+/*-----------------------------------------------------------*/
+
+/* The wait before the next request, after ulRetryCount failures in a row: doubled each time, and capped. */
+static uint32_t prvADUDownloadRetryDelay( uint32_t ulRetryCount )
+{
+    uint32_t ulDelayMs = azureiotconfigADU_DOWNLOAD_RETRY_DELAY_MS;
+    uint32_t ulIndex;
+
+    for( ulIndex = 1; ( ulIndex < ulRetryCount ) && ( ulDelayMs < azureiotconfigADU_DOWNLOAD_RETRY_DELAY_MAX_MS ); ulIndex++ )
+    {
+        ulDelayMs = ( ulDelayMs > ( UINT32_MAX / 2 ) ) ? UINT32_MAX : ( ulDelayMs * 2 );
+    }
+
+    return ( ulDelayMs < azureiotconfigADU_DOWNLOAD_RETRY_DELAY_MAX_MS ) ? ulDelayMs : azureiotconfigADU_DOWNLOAD_RETRY_DELAY_MAX_MS;
+}
+/*-----------------------------------------------------------*/
+
+AzureIoTResult_t AzureIoTADUDownload_ProcessLoop( AzureIoTADUDownload_t * pxDownload,
+                                                  AzureIoTHubClient_t * pxHubClient,
+                                                  uint32_t ulTimeoutMilliseconds )
+{
+    AzureIoTResult_t xResult;
+    uint32_t ulStartMs;
+    uint32_t ulNowMs;
+    uint32_t ulWaitMs;
+    uint32_t ulSteps = 0;
+    uint32_t ulRequestCount;
+    uint32_t ulRequestErrorCount;
+
+    if( ( pxDownload == NULL ) || ( pxHubClient == NULL ) )
+    {
+        AZLogError( ( "AzureIoTADUDownload_ProcessLoop failed: invalid argument" ) );
+        return eAzureIoTErrorInvalidArgument;
+    }
+
+    ulStartMs = prvADUDownloadGetTimeMilliseconds();
+
+    do
+    {
+        ulNowMs = prvADUDownloadGetTimeMilliseconds();
+
+        if( ( pxDownload->_internal.ulRetryCount > 0 ) &&
+            ( ( int32_t ) ( pxDownload->_internal.ulRetryTimeMs - ulNowMs ) > 0 ) )
+        {
+            /* Wait for the retry in the hub client, so commands are still handled. */
+            ulWaitMs = pxDownload->_internal.ulRetryTimeMs - ulNowMs;
+
+            if( ( ulNowMs - ulStartMs ) >= ulTimeoutMilliseconds )
+            {
+                ulWaitMs = 0;
+            }
+            else if( ulWaitMs > ( ulTimeoutMilliseconds - ( ulNowMs - ulStartMs ) ) )
+            {
+                ulWaitMs = ulTimeoutMilliseconds - ( ulNowMs - ulStartMs );
+            }
+
+            if( ( xResult = AzureIoTHubClient_ProcessLoop( pxHubClient, ulWaitMs ) ) != eAzureIoTSuccess )
+            {
+                AZLogError( ( "AzureIoTADUDownload_ProcessLoop failed to process hub client: error=0x%08x", ( uint16_t ) xResult ) );
+                return eAzureIoTErrorHubClientFailed;
+            }
+
+            xResult = eAzureIoTErrorPending;
+            continue;
+        }
+
+        if( ( ulSteps % pxDownload->_internal.ulStepsPerHubProcess ) == 0 )
+        {
+            if( ( xResult = AzureIoTHubClient_ProcessLoop( pxHubClient,
+                                                           pxDownload->_internal.ulHubProcessMilliseconds ) ) != eAzureIoTSuccess )
+            {
+                AZLogError( ( "AzureIoTADUDownload_ProcessLoop failed to process hub client: error=0x%08x", ( uint16_t ) xResult ) );
+                return eAzureIoTErrorHubClientFailed;
+            }
+        }
+
+        ulRequestCount = pxDownload->_internal.xStats.ulRequestCount;
+        ulRequestErrorCount = pxDownload->_internal.xStats.ulRequestErrorCount;
+        xResult = AzureIoTADUDownload_Process( pxDownload );
+        ulSteps++;
+
+        if( ( xResult == eAzureIoTErrorFailed ) &&
+            ( pxDownload->_internal.xStats.ulRequestErrorCount != ulRequestErrorCount ) )
+        {
+            if( ++pxDownload->_internal.ulRetryCount >= azureiotconfigADU_DOWNLOAD_RETRY_MAX )
+            {
+                AZLogError( ( "AzureIoTADUDownload_ProcessLoop failed: %u range requests failed in a row",
+                              pxDownload->_internal.ulRetryCount ) );
+                pxDownload->_internal.ulRetryCount = 0;
+                return xResult;
+            }
+
+            /* The range request failed, request it again later. */
+            pxDownload->_internal.ulRetryTimeMs = prvADUDownloadGetTimeMilliseconds() +
+                                                  prvADUDownloadRetryDelay( pxDownload->_internal.ulRetryCount );
+            xResult = eAzureIoTErrorPending;
+        }
+        else if( pxDownload->_internal.xStats.ulRequestCount != ulRequestCount )
+        {
+            pxDownload->_internal.ulRetryCount = 0;
+        }
+    } while( ( xResult == eAzureIoTErrorPending ) &&
+             ( ( prvADUDownloadGetTimeMilliseconds() - ulStartMs ) < ulTimeoutMilliseconds ) );
+
+    return xResult;
+}
+/*-----------------------------------------------------------*/
+
+AzureIoTResult_t AzureIoTADUDownload_GetSHA256( AzureIoTADUDownload_t * pxDownload,
+                                                uint8_t * pucSHA256,
+                                                uint32_t ulSHA256Length )
+{
+    AzureIoTResult_t xResult;
+
+    if( ( pxDownload == NULL ) || ( pucSHA256 == NULL ) || ( ulSHA256Length < azureiotcryptoSHA256_SIZE ) )
+    {
+        AZLogError( ( "AzureIoTADUDownload_GetSHA256 failed: invalid argument" ) );
+        xResult = eAzureIoTErrorInvalidArgument;
+    }
+    else if( !pxDownload->_internal.xSHA256Ready )
+    {
+        xResult = eAzureIoTErrorPending;
+    }
+    else
+    {
+        memcpy( pucSHA256, pxDownload->_internal.ucSHA256, azureiotcryptoSHA256_SIZE );
+        xResult = eAzureIoTSuccess;
+    }
+
+    return xResult;
+}
+/*-----------------------------------------------------------*/
+
+AzureIoTResult_t AzureIoTADUDownload_GetStats( AzureIoTADUDownload_t * pxDownload,
+                                               AzureIoTADUDownloadStats_t * pxStats )
+{
+    AzureIoTResult_t xResult;
+
+    if( ( pxDownload == NULL ) || ( pxStats == NULL ) )
+    {
+        AZLogError( ( "AzureIoTADUDownload_GetStats failed: invalid argument" ) );
+        xResult = eAzureIoTErrorInvalidArgument;
+    }
+    else
+    {
+        if( pxDownload->_internal.ulEndTimeMs == 0 )
+        {
+            pxDownload->_internal.xStats.ulElapsedMilliseconds = prvADUDownloadGetTimeMilliseconds() -
+                                                                 pxDownload->_internal.ulStartTimeMs;
+        }
+
+        *pxStats = pxDownload->_internal.xStats;
+        xResult = eAzureIoTSuccess;
+    }
+
+    return xResult;
+}
+/*-----------------------------------------------------------*/
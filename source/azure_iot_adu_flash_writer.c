@@ -0,0 +1,224 @@
+/* Copyright (c) Microsoft Corporation.
+ * Licensed under the MIT License. */
+
+/**
+ * @file azure_iot_adu_flash_writer.c
+ * @brief Implementation of the page aligned ADU flash writer.
+ *
+ */
+
+#include "azure_iot_adu_flash_writer.h"
+
+#include <string.h>
+/*-----------------------------------------------------------*/
+
+static AzureIoTResult_t prvADUFlashWriterWriteBlock( AzureIoTADUFlashWriter_t * pxWriter,
+                                                     uint32_t ulOffset,
+                                                     const uint8_t * pucData,
+                                                     uint32_t ulLength )
+{
+    AzureIoTResult_t xResult;
+
+    /* The platform takes a non-const pointer but only reads from it. */
+    if( ( xResult = AzureIoTPlatform_WriteBlock( pxWriter->_internal.pxImage, ulOffset,
+                                                 ( uint8_t * ) pucData, ulLength ) ) != eAzureIoTSuccess )
+    {
+        AZLogError( ( "AzureIoTADUFlashWriter failed to write block at offset %u: error=0x%08x",
+                      ulOffset, ( uint16_t ) xResult ) );
+    }
+    else
+    {
+        pxWriter->_internal.ulWriteCount++;
+    }
+
+    return xResult;
+}
+/*-----------------------------------------------------------*/
+
+/**
+ * End of the write for a buffer starting at ulOffset: the last page boundary the buffer reaches,
+ * or the end of the sector if it comes first.
+ *
+ */
+static uint32_t prvADUFlashWriterGetLimit( AzureIoTADUFlashWriter_t * pxWriter,
+                                           uint32_t ulOffset )
+{
+    uint32_t ulLimit = ulOffset + pxWriter->_internal.ulBufferLength;
+    uint32_t ulSectorEnd;
+
+    ulLimit -= ulLimit % pxWriter->_internal.ulPageSize;
+
+    if( pxWriter->_internal.ulSectorSize > 1 )
+    {
+        ulSectorEnd = ulOffset - ( ulOffset % pxWriter->_internal.ulSectorSize ) + pxWriter->_internal.ulSectorSize;
+
+        if( ulSectorEnd < ulLimit )
+        {
+            ulLimit = ulSectorEnd;
+        }
+    }
+
+    return ulLimit;
+}
+/*-----------------------------------------------------------*/
+
+AzureIoTResult_t AzureIoTADUFlashWriter_Init( AzureIoTADUFlashWriter_t * pxWriter,
+                                              AzureADUImage_t * pxImage,
+                                              uint8_t * pucBuffer,
+                                              uint32_t ulBufferLength )
+{
+    uint32_t ulPageSize;
+
+    if( ( pxWriter == NULL ) || ( pxImage == NULL ) || ( pucBuffer == NULL ) )
+    {
+        AZLogError( ( "AzureIoTADUFlashWriter_Init failed: invalid argument" ) );
+        return eAzureIoTErrorInvalidArgument;
+    }
+
+    ulPageSize = AzureIoTPlatform_GetProgramPageSize( pxImage );
+
+    if( ulPageSize == 0 )
+    {
+        ulPageSize = 1;
+    }
+
+    if( ulBufferLength < ulPageSize )
+    {
+        AZLogError( ( "AzureIoTADUFlashWriter_Init failed: buffer of %u bytes smaller than a page of %u bytes",
+                      ulBufferLength, ulPageSize ) );
+        return eAzureIoTErrorInvalidArgument;
+    }
+
+    memset( pxWriter, 0, sizeof( *pxWriter ) );
+    pxWriter->_internal.pxImage = pxImage;
+    pxWriter->_internal.pucBuffer = pucBuffer;
+    pxWriter->_internal.ulBufferLength = ulBufferLength - ( ulBufferLength % ulPageSize );
+    pxWriter->_internal.ulPageSize = ulPageSize;
+    pxWriter->_internal.ulSectorSize = AzureIoTPlatform_GetEraseSectorSize( pxImage );
+
+    return eAzureIoTSuccess;
+}
+/*-----------------------------------------------------------*/
+
+AzureIoTResult_t AzureIoTADUFlashWriter_Write( AzureIoTADUFlashWriter_t * pxWriter,
+                                               uint32_t ulOffset,
+                                               const uint8_t * pucData,
+                                               uint32_t ulLength )
+{
+    AzureIoTResult_t xResult = eAzureIoTSuccess;
+    uint32_t ulPageSize;
+    uint32_t ulLimit;
+    uint32_t ulCopy;
+
+    if( ( pxWriter == NULL ) || ( ( pucData == NULL ) && ( ulLength > 0 ) ) )
+    {
+        AZLogError( ( "AzureIoTADUFlashWriter_Write failed: invalid argument" ) );
+        return eAzureIoTErrorInvalidArgument;
+    }
+
+    ulPageSize = pxWriter->_internal.ulPageSize;
+
+    if( ( pxWriter->_internal.ulBufferFill > 0 ) &&
+        ( ulOffset != ( pxWriter->_internal.ulBufferOffset + pxWriter->_internal.ulBufferFill ) ) &&
+        ( ( xResult = AzureIoTADUFlashWriter_Flush( pxWriter ) ) != eAzureIoTSuccess ) )
+    {
+        return xResult;
+    }
+
+    while( ( ulLength > 0 ) && ( xResult == eAzureIoTSuccess ) )
+    {
+        if( pxWriter->_internal.ulBufferFill == 0 )
+        {
+            pxWriter->_internal.ulBufferOffset = ulOffset;
+
+            if( ( ( ulOffset % ulPageSize ) == 0 ) && ( ulLength >= pxWriter->_internal.ulBufferLength ) )
+            {
+                /* A block filling the buffer needs no gathering, write its whole pages from the caller's buffer. */
+                ulCopy = ulLength - ( ulLength % ulPageSize );
+
+                if( ( pxWriter->_internal.ulSectorSize > 1 ) &&
+                    ( ulCopy > ( pxWriter->_internal.ulSectorSize - ( ulOffset % pxWriter->_internal.ulSectorSize ) ) ) )
+                {
+                    ulCopy = pxWriter->_internal.ulSectorSize - ( ulOffset % pxWriter->_internal.ulSectorSize );
+                }
+
+                xResult = prvADUFlashWriterWriteBlock( pxWriter, ulOffset, pucData, ulCopy );
+                ulOffset += ulCopy;
+                pucData += ulCopy;
+                ulLength -= ulCopy;
+                continue;
+            }
+        }
+
+        ulLimit = prvADUFlashWriterGetLimit( pxWriter, pxWriter->_internal.ulBufferOffset );
+        ulCopy = ulLimit - ( pxWriter->_internal.ulBufferOffset + pxWriter->_internal.ulBufferFill );
+
+        if( ulCopy > ulLength )
+        {
+            ulCopy = ulLength;
+        }
+
+        memcpy( pxWriter->_internal.pucBuffer + pxWriter->_internal.ulBufferFill, pucData, ulCopy );
+        pxWriter->_internal.ulBufferFill += ulCopy;
+        ulOffset += ulCopy;
+        pucData += ulCopy;
+        ulLength -= ulCopy;
+
+        if( ( pxWriter->_internal.ulBufferOffset + pxWriter->_internal.ulBufferFill ) == ulLimit )
+        {
+            xResult = AzureIoTADUFlashWriter_Flush( pxWriter );
+        }
+    }
+
+    return xResult;
+}
+/*-----------------------------------------------------------*/
+
+AzureIoTResult_t AzureIoTADUFlashWriter_Flush( AzureIoTADUFlashWriter_t * pxWriter )
+{
+    AzureIoTResult_t xResult = eAzureIoTSuccess;
+
+    if( pxWriter == NULL )
+    {
+        AZLogError( ( "AzureIoTADUFlashWriter_Flush failed: invalid argument" ) );
+        return eAzureIoTErrorInvalidArgument;
+    }
+
+    if( ( pxWriter->_internal.ulBufferFill > 0 ) &&
+        ( ( xResult = prvADUFlashWriterWriteBlock( pxWriter, pxWriter->_internal.ulBufferOffset,
+                                                   pxWriter->_internal.pucBuffer,
+                                                   pxWriter->_internal.ulBufferFill ) ) == eAzureIoTSuccess ) )
+    {
+        pxWriter->_internal.ulBufferOffset += pxWriter->_internal.ulBufferFill;
+        pxWriter->_internal.ulBufferFill = 0;
+    }
+
+    return xResult;
+}
+/*-----------------------------------------------------------*/
+
+AzureIoTResult_t AzureIoTADUFlashWriter_Reset( AzureIoTADUFlashWriter_t * pxWriter )
+{
+    if( pxWriter == NULL )
+    {
+        AZLogError( ( "AzureIoTADUFlashWriter_Reset failed: invalid argument" ) );
+        return eAzureIoTErrorInvalidArgument;
+    }
+
+    pxWriter->_internal.ulBufferFill = 0;
+
+    return eAzureIoTSuccess;
+}
+/*-----------------------------------------------------------*/
+
+uint32_t AzureIoTADUFlashWriter_GetWriteCount( AzureIoTADUFlashWriter_t * pxWriter )
+{
+    if( pxWriter == NULL )
+    {
+        AZLogError( ( "AzureIoTADUFlashWriter_GetWriteCount failed: invalid argument" ) );
+        return 0;
+    }
+
+    return pxWriter->_internal.ulWriteCount;
+}
+/*-----------------------------------------------------------*/
@@ -0,0 +1,202 @@
+/* Copyright (c) Microsoft Corporation.
+ * Licensed under the MIT License. */
+
+/**
+ * @file azure_iot_adu_heatshrink.c
+ * @brief Implementation of the streaming heatshrink decoder.
+ *
+ */
+
+#include "azure_iot_adu_heatshrink.h"
+
+#include <string.h>
+/*-----------------------------------------------------------*/
+
+#define azureiotaduHEATSHRINK_STATE_TAG              ( 0U )
+#define azureiotaduHEATSHRINK_STATE_LITERAL          ( 1U )
+#define azureiotaduHEATSHRINK_STATE_BACKREF_INDEX    ( 2U )
+#define azureiotaduHEATSHRINK_STATE_BACKREF_COUNT    ( 3U )
+#define azureiotaduHEATSHRINK_STATE_YIELD_BACKREF    ( 4U )
+/*-----------------------------------------------------------*/
+
+/**
+ * Bits read in each state. The stream is read most significant bit first.
+ *
+ */
+static uint8_t prvADUHeatshrinkGetBitCount( AzureIoTADUHeatshrink_t * pxHeatshrink )
+{
+    switch( pxHeatshrink->_internal.ucState )
+    {
+        case azureiotaduHEATSHRINK_STATE_TAG:
+            return 1;
+
+        case azureiotaduHEATSHRINK_STATE_LITERAL:
+            return 8;
+
+        case azureiotaduHEATSHRINK_STATE_BACKREF_INDEX:
+            return pxHeatshrink->_internal.ucWindowBits;
+
+        default:
+            return pxHeatshrink->_internal.ucLookaheadBits;
+    }
+}
+/*-----------------------------------------------------------*/
+
+static void prvADUHeatshrinkPushByte( AzureIoTADUHeatshrink_t * pxHeatshrink,
+                                      uint8_t ucByte )
+{
+    uint16_t usMask = ( uint16_t ) ( azureiotaduHEATSHRINK_WINDOW_SIZE( pxHeatshrink->_internal.ucWindowBits ) - 1U );
+
+    pxHeatshrink->_internal.pucWindow[ pxHeatshrink->_internal.usHeadIndex & usMask ] = ucByte;
+    pxHeatshrink->_internal.usHeadIndex++;
+}
+/*-----------------------------------------------------------*/
+
+AzureIoTResult_t AzureIoTADUHeatshrink_Init( AzureIoTADUHeatshrink_t * pxHeatshrink,
+                                             uint8_t ucWindowBits,
+                                             uint8_t ucLookaheadBits,
+                                             uint8_t * pucWindow,
+                                             uint32_t ulWindowLength )
+{
+    if( ( pxHeatshrink == NULL ) || ( pucWindow == NULL ) ||
+        ( ucWindowBits < azureiotaduHEATSHRINK_MIN_WINDOW_BITS ) ||
+        ( ucWindowBits > azureiotaduHEATSHRINK_MAX_WINDOW_BITS ) ||
+        ( ucLookaheadBits < 3 ) || ( ucLookaheadBits >= ucWindowBits ) ||
+        ( ulWindowLength < azureiotaduHEATSHRINK_WINDOW_SIZE( ucWindowBits ) ) )
+    {
+        AZLogError( ( "AzureIoTADUHeatshrink_Init failed: invalid argument" ) );
+        return eAzureIoTErrorInvalidArgument;
+    }
+
+    memset( pxHeatshrink, 0, sizeof( *pxHeatshrink ) );
+    pxHeatshrink->_internal.pucWindow = pucWindow;
+    pxHeatshrink->_internal.ucWindowBits = ucWindowBits;
+    pxHeatshrink->_internal.ucLookaheadBits = ucLookaheadBits;
+
+    return AzureIoTADUHeatshrink_Reset( pxHeatshrink );
+}
+/*-----------------------------------------------------------*/
+
+AzureIoTResult_t AzureIoTADUHeatshrink_Reset( void * pvHeatshrink )
+{
+    AzureIoTADUHeatshrink_t * pxHeatshrink = ( AzureIoTADUHeatshrink_t * ) pvHeatshrink;
+
+    if( pxHeatshrink == NULL )
+    {
+        AZLogError( ( "AzureIoTADUHeatshrink_Reset failed: invalid argument" ) );
+        return eAzureIoTErrorInvalidArgument;
+    }
+
+    /* Back-references before the start of the stream read zeros, as with the heatshrink encoder. */
+    memset( pxHeatshrink->_internal.pucWindow, 0,
+            azureiotaduHEATSHRINK_WINDOW_SIZE( pxHeatshrink->_internal.ucWindowBits ) );
+    pxHeatshrink->_internal.ucState = azureiotaduHEATSHRINK_STATE_TAG;
+    pxHeatshrink->_internal.ucBitCount = 0;
+    pxHeatshrink->_internal.ulBits = 0;
+    pxHeatshrink->_internal.usHeadIndex = 0;
+    pxHeatshrink->_internal.usBackrefIndex = 0;
+    pxHeatshrink->_internal.usBackrefCount = 0;
+
+    return eAzureIoTSuccess;
+}
+/*-----------------------------------------------------------*/
+
+AzureIoTResult_t AzureIoTADUHeatshrink_Decode( void * pvHeatshrink,
+                                               const uint8_t * pucInput,
+                                               uint32_t ulInputLength,
+                                               uint32_t * pulInputConsumed,
+                                               uint8_t * pucOutput,
+                                               uint32_t ulOutputLength,
+                                               uint32_t * pulOutputProduced )
+{
+    AzureIoTADUHeatshrink_t * pxHeatshrink = ( AzureIoTADUHeatshrink_t * ) pvHeatshrink;
+    uint32_t ulConsumed = 0;
+    uint32_t ulProduced = 0;
+    uint16_t usMask;
+    uint16_t usValue;
+    uint8_t ucNeeded;
+    uint8_t ucByte;
+
+    if( ( pxHeatshrink == NULL ) || ( ( pucInput == NULL ) && ( ulInputLength > 0 ) ) ||
+        ( pulInputConsumed == NULL ) || ( pucOutput == NULL ) || ( ulOutputLength == 0 ) ||
+        ( pulOutputProduced == NULL ) )
+    {
+        AZLogError( ( "AzureIoTADUHeatshrink_Decode failed: invalid argument" ) );
+        return eAzureIoTErrorInvalidArgument;
+    }
+
+    usMask = ( uint16_t ) ( azureiotaduHEATSHRINK_WINDOW_SIZE( pxHeatshrink->_internal.ucWindowBits ) - 1U );
+
+    while( ulProduced < ulOutputLength )
+    {
+        if( pxHeatshrink->_internal.ucState == azureiotaduHEATSHRINK_STATE_YIELD_BACKREF )
+        {
+            while( ( pxHeatshrink->_internal.usBackrefCount > 0 ) && ( ulProduced < ulOutputLength ) )
+            {
+                ucByte = pxHeatshrink->_internal.pucWindow[ ( uint16_t ) ( pxHeatshrink->_internal.usHeadIndex -
+                                                                           pxHeatshrink->_internal.usBackrefIndex ) & usMask ];
+                pucOutput[ ulProduced++ ] = ucByte;
+                prvADUHeatshrinkPushByte( pxHeatshrink, ucByte );
+                pxHeatshrink->_internal.usBackrefCount--;
+            }
+
+            if( pxHeatshrink->_internal.usBackrefCount == 0 )
+            {
+                pxHeatshrink->_internal.ucState = azureiotaduHEATSHRINK_STATE_TAG;
+            }
+
+            continue;
+        }
+
+        ucNeeded = prvADUHeatshrinkGetBitCount( pxHeatshrink );
+
+        /* At most 15 bits are needed, so the bits buffered never exceed 22. */
+        while( ( pxHeatshrink->_internal.ucBitCount < ucNeeded ) && ( ulConsumed < ulInputLength ) )
+        {
+            pxHeatshrink->_internal.ulBits = ( pxHeatshrink->_internal.ulBits << 8 ) | pucInput[ ulConsumed++ ];
+            pxHeatshrink->_internal.ucBitCount += 8;
+        }
+
+        if( pxHeatshrink->_internal.ucBitCount < ucNeeded )
+        {
+            /* Wait for more input. */
+            break;
+        }
+
+        pxHeatshrink->_internal.ucBitCount -= ucNeeded;
+        usValue = ( uint16_t ) ( ( pxHeatshrink->_internal.ulBits >> pxHeatshrink->_internal.ucBitCount ) &
+                                 ( ( 1U << ucNeeded ) - 1U ) );
+        pxHeatshrink->_internal.ulBits &= ( 1U << pxHeatshrink->_internal.ucBitCount ) - 1U;
+
+        switch( pxHeatshrink->_internal.ucState )
+        {
+            case azureiotaduHEATSHRINK_STATE_TAG:
+                pxHeatshrink->_internal.ucState = ( usValue != 0 ) ?
+                                                  azureiotaduHEATSHRINK_STATE_LITERAL :
+                                                  azureiotaduHEATSHRINK_STATE_BACKREF_INDEX;
+                break;
+
+            case azureiotaduHEATSHRINK_STATE_LITERAL:
+                pucOutput[ ulProduced++ ] = ( uint8_t ) usValue;
+                prvADUHeatshrinkPushByte( pxHeatshrink, ( uint8_t ) usValue );
+                pxHeatshrink->_internal.ucState = azureiotaduHEATSHRINK_STATE_TAG;
+                break;
+
+            case azureiotaduHEATSHRINK_STATE_BACKREF_INDEX:
+                pxHeatshrink->_internal.usBackrefIndex = ( uint16_t ) ( usValue + 1U );
+                pxHeatshrink->_internal.ucState = azureiotaduHEATSHRINK_STATE_BACKREF_COUNT;
+                break;
+
+            default:
+                pxHeatshrink->_internal.usBackrefCount = ( uint16_t ) ( usValue + 1U );
+                pxHeatshrink->_internal.ucState = azureiotaduHEATSHRINK_STATE_YIELD_BACKREF;
+                break;
+        }
+    }
+
+    *pulInputConsumed = ulConsumed;
+    *pulOutputProduced = ulProduced;
+
+    return eAzureIoTSuccess;
+}
+/*-----------------------------------------------------------*/
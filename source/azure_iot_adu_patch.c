@@ -0,0 +1,442 @@
+/* Copyright (c) Microsoft Corporation.
+ * Licensed under the MIT License. */
+
+/**
+ * @file azure_iot_adu_patch.c
+ * @brief Implementation of the ADU streaming patch applier.
+ *
+ */
+
+#include "azure_iot_adu_patch.h"
+
+#include <string.h>
+
+#include "azure/core/az_base64.h"
+#include "azure/core/az_span.h"
+/*-----------------------------------------------------------*/
+
+#define azureiotaduPATCH_PHASE_HEADER     ( 0U )
+#define azureiotaduPATCH_PHASE_CONTROL    ( 1U )
+#define azureiotaduPATCH_PHASE_DIFF       ( 2U )
+#define azureiotaduPATCH_PHASE_EXTRA      ( 3U )
+#define azureiotaduPATCH_PHASE_DONE       ( 4U )
+
+static const uint8_t ucADUPatchMagic[] = { 'A', 'Z', 'D', 'P' };
+/*-----------------------------------------------------------*/
+
+static uint32_t prvADUPatchGetUint32( const uint8_t * pucData )
+{
+    return ( uint32_t ) pucData[ 0 ] |
+           ( ( uint32_t ) pucData[ 1 ] << 8 ) |
+           ( ( uint32_t ) pucData[ 2 ] << 16 ) |
+           ( ( uint32_t ) pucData[ 3 ] << 24 );
+}
+/*-----------------------------------------------------------*/
+
+/**
+ * Move to the next part of the patch that has bytes left, skipping empty diff and extra parts.
+ *
+ */
+static void prvADUPatchNextPhase( AzureIoTADUPatch_t * pxPatch )
+{
+    AzureIoTADUPatchState_t * pxState = &pxPatch->_internal.xState;
+
+    if( ( pxState->ulPhase == azureiotaduPATCH_PHASE_DIFF ) && ( pxState->ulDiffLength == 0 ) )
+    {
+        pxState->ulPhase = azureiotaduPATCH_PHASE_EXTRA;
+    }
+
+    if( ( pxState->ulPhase == azureiotaduPATCH_PHASE_EXTRA ) && ( pxState->ulExtraLength == 0 ) )
+    {
+        pxState->lOldOffset += pxState->lOldAdjust;
+        pxState->ulPhase = azureiotaduPATCH_PHASE_CONTROL;
+    }
+
+    if( ( pxState->ulPhase == azureiotaduPATCH_PHASE_CONTROL ) && ( pxState->ulNewOffset == pxState->ulNewSize ) )
+    {
+        pxState->ulPhase = azureiotaduPATCH_PHASE_DONE;
+        AZLogInfo( ( "AzureIoTADUPatch complete: %u bytes", pxState->ulNewSize ) );
+    }
+}
+/*-----------------------------------------------------------*/
+
+/**
+ * Parse the header or control block in ucPending.
+ *
+ */
+static AzureIoTResult_t prvADUPatchParsePending( AzureIoTADUPatch_t * pxPatch )
+{
+    AzureIoTADUPatchState_t * pxState = &pxPatch->_internal.xState;
+    const uint8_t * pucPending = pxState->ucPending;
+    int64_t llOldEnd;
+    int64_t llOldNext;
+
+    pxState->ulPendingLength = 0;
+
+    if( pxState->ulPhase == azureiotaduPATCH_PHASE_HEADER )
+    {
+        if( memcmp( pucPending, ucADUPatchMagic, sizeof( ucADUPatchMagic ) ) != 0 )
+        {
+            AZLogError( ( "AzureIoTADUPatch failed: not a patch" ) );
+            return eAzureIoTErrorInvalidResponse;
+        }
+
+        pxState->ulOldSize = prvADUPatchGetUint32( pucPending + 4 );
+        pxState->ulNewSize = prvADUPatchGetUint32( pucPending + 8 );
+
+        if( ( pxState->ulOldSize > INT32_MAX ) || ( pxState->ulNewSize > INT32_MAX ) )
+        {
+            AZLogError( ( "AzureIoTADUPatch failed: image size too large" ) );
+            return eAzureIoTErrorInvalidResponse;
+        }
+
+        AZLogInfo( ( "AzureIoTADUPatch rebuilding %u bytes from %u bytes", pxState->ulNewSize, pxState->ulOldSize ) );
+    }
+    else
+    {
+        pxState->ulDiffLength = prvADUPatchGetUint32( pucPending );
+        pxState->ulExtraLength = prvADUPatchGetUint32( pucPending + 4 );
+        pxState->lOldAdjust = ( int32_t ) prvADUPatchGetUint32( pucPending + 8 );
+
+        /* Checked one at a time, the sum could wrap around. */
+        if( ( pxState->ulDiffLength > ( pxState->ulNewSize - pxState->ulNewOffset ) ) ||
+            ( pxState->ulExtraLength > ( pxState->ulNewSize - pxState->ulNewOffset - pxState->ulDiffLength ) ) )
+        {
+            AZLogError( ( "AzureIoTADUPatch failed: segment at offset %u past the end of the image", pxState->ulNewOffset ) );
+            return eAzureIoTErrorInvalidResponse;
+        }
+
+        /* Both the diff and the next position stay in the old image, so lOldOffset never overflows. */
+        llOldEnd = ( int64_t ) pxState->lOldOffset + ( int64_t ) pxState->ulDiffLength;
+        llOldNext = llOldEnd + ( int64_t ) pxState->lOldAdjust;
+
+        if( ( llOldEnd > ( int64_t ) pxState->ulOldSize ) ||
+            ( llOldNext < 0 ) || ( llOldNext > ( int64_t ) pxState->ulOldSize ) )
+        {
+            AZLogError( ( "AzureIoTADUPatch failed: segment at offset %u outside of the old image", pxState->ulNewOffset ) );
+            return eAzureIoTErrorInvalidResponse;
+        }
+    }
+
+    pxState->ulPhase = azureiotaduPATCH_PHASE_DIFF;
+    prvADUPatchNextPhase( pxPatch );
+
+    return eAzureIoTSuccess;
+}
+/*-----------------------------------------------------------*/
+
+/**
+ * Read the old image into the work buffer. The control block was checked to keep the diff in the old image.
+ *
+ */
+static AzureIoTResult_t prvADUPatchReadOld( AzureIoTADUPatch_t * pxPatch,
+                                            uint32_t ulLength )
+{
+    AzureIoTADUPatchState_t * pxState = &pxPatch->_internal.xState;
+    AzureIoTResult_t xResult;
+
+    if( ( xResult = AzureIoTPlatform_ReadActiveBlock( pxPatch->_internal.pxImage,
+                                                      ( uint32_t ) pxState->lOldOffset,
+                                                      pxPatch->_internal.pucBuffer,
+                                                      ulLength ) ) != eAzureIoTSuccess )
+    {
+        AZLogError( ( "AzureIoTADUPatch failed to read active image at offset %u: error=0x%08x",
+                      ( uint32_t ) pxState->lOldOffset, ( uint16_t ) xResult ) );
+    }
+
+    return xResult;
+}
+/*-----------------------------------------------------------*/
+
+/**
+ * Write the first ulLength bytes of the work buffer to the new image.
+ *
+ */
+static AzureIoTResult_t prvADUPatchWriteNew( AzureIoTADUPatch_t * pxPatch,
+                                             uint32_t ulLength )
+{
+    AzureIoTADUPatchState_t * pxState = &pxPatch->_internal.xState;
+    AzureIoTResult_t xResult;
+
+    if( pxPatch->_internal.pxWriter != NULL )
+    {
+        xResult = AzureIoTADUFlashWriter_Write( pxPatch->_internal.pxWriter, pxState->ulNewOffset,
+                                                pxPatch->_internal.pucBuffer, ulLength );
+    }
+    else
+    {
+        xResult = AzureIoTPlatform_WriteBlock( pxPatch->_internal.pxImage, pxState->ulNewOffset,
+                                               pxPatch->_internal.pucBuffer, ulLength );
+    }
+
+    if( xResult != eAzureIoTSuccess )
+    {
+        AZLogError( ( "AzureIoTADUPatch failed to write block at offset %u: error=0x%08x",
+                      pxState->ulNewOffset, ( uint16_t ) xResult ) );
+    }
+    else if( ( xResult = AzureIoTCrypto_SHA256Update( &pxState->xSHA256Context,
+                                                      pxPatch->_internal.pucBuffer,
+                                                      ulLength ) ) != eAzureIoTSuccess )
+    {
+        AZLogError( ( "AzureIoTADUPatch failed to hash block at offset %u: error=0x%08x",
+                      pxState->ulNewOffset, ( uint16_t ) xResult ) );
+    }
+    else
+    {
+        pxState->ulNewOffset += ulLength;
+    }
+
+    return xResult;
+}
+/*-----------------------------------------------------------*/
+
+AzureIoTResult_t AzureIoTADUPatch_Init( AzureIoTADUPatch_t * pxPatch,
+                                        AzureADUImage_t * pxImage,
+                                        uint8_t * pucBuffer,
+                                        uint32_t ulBufferLength )
+{
+    if( ( pxPatch == NULL ) || ( pxImage == NULL ) ||
+        ( pucBuffer == NULL ) || ( ulBufferLength == 0 ) )
+    {
+        AZLogError( ( "AzureIoTADUPatch_Init failed: invalid argument" ) );
+        return eAzureIoTErrorInvalidArgument;
+    }
+
+    memset( pxPatch, 0, sizeof( *pxPatch ) );
+    pxPatch->_internal.pxImage = pxImage;
+    pxPatch->_internal.pucBuffer = pucBuffer;
+    pxPatch->_internal.ulBufferLength = ulBufferLength;
+
+    return AzureIoTADUPatch_Start( pxPatch );
+}
+/*-----------------------------------------------------------*/
+
+AzureIoTResult_t AzureIoTADUPatch_SetFlashWriter( AzureIoTADUPatch_t * pxPatch,
+                                                  AzureIoTADUFlashWriter_t * pxWriter )
+{
+    if( pxPatch == NULL )
+    {
+        AZLogError( ( "AzureIoTADUPatch_SetFlashWriter failed: invalid argument" ) );
+        return eAzureIoTErrorInvalidArgument;
+    }
+
+    pxPatch->_internal.pxWriter = pxWriter;
+
+    return eAzureIoTSuccess;
+}
+/*-----------------------------------------------------------*/
+
+AzureIoTResult_t AzureIoTADUPatch_Start( AzureIoTADUPatch_t * pxPatch )
+{
+    AzureIoTResult_t xResult;
+
+    if( pxPatch == NULL )
+    {
+        AZLogError( ( "AzureIoTADUPatch_Start failed: invalid argument" ) );
+        return eAzureIoTErrorInvalidArgument;
+    }
+
+    memset( &pxPatch->_internal.xState, 0, sizeof( pxPatch->_internal.xState ) );
+    pxPatch->_internal.xState.ulPhase = azureiotaduPATCH_PHASE_HEADER;
+
+    if( ( xResult = AzureIoTCrypto_SHA256Init( &pxPatch->_internal.xState.xSHA256Context ) ) != eAzureIoTSuccess )
+    {
+        AZLogError( ( "AzureIoTADUPatch_Start failed to init SHA256: error=0x%08x", ( uint16_t ) xResult ) );
+    }
+
+    return xResult;
+}
+/*-----------------------------------------------------------*/
+
+AzureIoTResult_t AzureIoTADUPatch_GetState( AzureIoTADUPatch_t * pxPatch,
+                                            AzureIoTADUPatchState_t * pxState )
+{
+    if( ( pxPatch == NULL ) || ( pxState == NULL ) )
+    {
+        AZLogError( ( "AzureIoTADUPatch_GetState failed: invalid argument" ) );
+        return eAzureIoTErrorInvalidArgument;
+    }
+
+    *pxState = pxPatch->_internal.xState;
+
+    return eAzureIoTSuccess;
+}
+/*-----------------------------------------------------------*/
+
+AzureIoTResult_t AzureIoTADUPatch_Resume( AzureIoTADUPatch_t * pxPatch,
+                                          const AzureIoTADUPatchState_t * pxState )
+{
+    if( ( pxPatch == NULL ) || ( pxState == NULL ) )
+    {
+        AZLogError( ( "AzureIoTADUPatch_Resume failed: invalid argument" ) );
+        return eAzureIoTErrorInvalidArgument;
+    }
+
+    pxPatch->_internal.xState = *pxState;
+
+    return eAzureIoTSuccess;
+}
+/*-----------------------------------------------------------*/
+
+AzureIoTResult_t AzureIoTADUPatch_Write( AzureIoTADUPatch_t * pxPatch,
+                                         const uint8_t * pucData,
+                                         uint32_t ulLength )
+{
+    AzureIoTADUPatchState_t * pxState;
+    AzureIoTResult_t xResult = eAzureIoTSuccess;
+    uint32_t ulCopyLength;
+    uint32_t ulIndex;
+
+    if( ( pxPatch == NULL ) || ( ( pucData == NULL ) && ( ulLength > 0 ) ) )
+    {
+        AZLogError( ( "AzureIoTADUPatch_Write failed: invalid argument" ) );
+        return eAzureIoTErrorInvalidArgument;
+    }
+
+    pxState = &pxPatch->_internal.xState;
+
+    while( ( ulLength > 0 ) && ( xResult == eAzureIoTSuccess ) )
+    {
+        switch( pxState->ulPhase )
+        {
+            case azureiotaduPATCH_PHASE_HEADER:
+            case azureiotaduPATCH_PHASE_CONTROL:
+                /* The header and the control blocks have the same size. */
+                ulCopyLength = azureiotaduPATCH_CONTROL_SIZE - pxState->ulPendingLength;
+                ulCopyLength = ( ulLength < ulCopyLength ) ? ulLength : ulCopyLength;
+                memcpy( pxState->ucPending + pxState->ulPendingLength, pucData, ulCopyLength );
+                pxState->ulPendingLength += ulCopyLength;
+
+                if( pxState->ulPendingLength == azureiotaduPATCH_CONTROL_SIZE )
+                {
+                    xResult = prvADUPatchParsePending( pxPatch );
+                }
+
+                break;
+
+            case azureiotaduPATCH_PHASE_DIFF:
+                ulCopyLength = ( ulLength < pxState->ulDiffLength ) ? ulLength : pxState->ulDiffLength;
+                ulCopyLength = ( ulCopyLength < pxPatch->_internal.ulBufferLength ) ?
+                               ulCopyLength : pxPatch->_internal.ulBufferLength;
+
+                if( ( xResult = prvADUPatchReadOld( pxPatch, ulCopyLength ) ) == eAzureIoTSuccess )
+                {
+                    for( ulIndex = 0; ulIndex < ulCopyLength; ulIndex++ )
+                    {
+                        pxPatch->_internal.pucBuffer[ ulIndex ] += pucData[ ulIndex ];
+                    }
+
+                    if( ( xResult = prvADUPatchWriteNew( pxPatch, ulCopyLength ) ) == eAzureIoTSuccess )
+                    {
+                        pxState->lOldOffset += ( int32_t ) ulCopyLength;
+                        pxState->ulDiffLength -= ulCopyLength;
+                        prvADUPatchNextPhase( pxPatch );
+                    }
+                }
+
+                break;
+
+            case azureiotaduPATCH_PHASE_EXTRA:
+                ulCopyLength = ( ulLength < pxState->ulExtraLength ) ? ulLength : pxState->ulExtraLength;
+                ulCopyLength = ( ulCopyLength < pxPatch->_internal.ulBufferLength ) ?
+                               ulCopyLength : pxPatch->_internal.ulBufferLength;
+                memcpy( pxPatch->_internal.pucBuffer, pucData, ulCopyLength );
+
+                if( ( xResult = prvADUPatchWriteNew( pxPatch, ulCopyLength ) ) == eAzureIoTSuccess )
+                {
+                    pxState->ulExtraLength -= ulCopyLength;
+                    prvADUPatchNextPhase( pxPatch );
+                }
+
+                break;
+
+            default:
+                ulCopyLength = ulLength;
+                AZLogError( ( "AzureIoTADUPatch_Write failed: %u bytes past the end of the patch", ulLength ) );
+                xResult = eAzureIoTErrorInvalidResponse;
+                break;
+        }
+
+        pucData += ulCopyLength;
+        ulLength -= ulCopyLength;
+    }
+
+    if( xResult != eAzureIoTSuccess )
+    {
+        return xResult;
+    }
+
+    return ( pxState->ulPhase == azureiotaduPATCH_PHASE_DONE ) ? eAzureIoTSuccess : eAzureIoTErrorPending;
+}
+/*-----------------------------------------------------------*/
+
+AzureIoTResult_t AzureIoTADUPatch_GetSHA256( AzureIoTADUPatch_t * pxPatch,
+                                             uint8_t * pucSHA256,
+                                             uint32_t ulSHA256Length )
+{
+    AzureIoTResult_t xResult;
+    AzureIoTCryptoSHA256Context_t xSHA256Context;
+
+    if( ( pxPatch == NULL ) || ( pucSHA256 == NULL ) || ( ulSHA256Length < azureiotcryptoSHA256_SIZE ) )
+    {
+        AZLogError( ( "AzureIoTADUPatch_GetSHA256 failed: invalid argument" ) );
+        xResult = eAzureIoTErrorInvalidArgument;
+    }
+    else if( pxPatch->_internal.xState.ulPhase != azureiotaduPATCH_PHASE_DONE )
+    {
+        xResult = eAzureIoTErrorPending;
+    }
+    else
+    {
+        /* Finished on a copy, the state stays valid for a checkpoint restored at the end of the patch. */
+        xSHA256Context = pxPatch->_internal.xState.xSHA256Context;
+
+        if( ( xResult = AzureIoTCrypto_SHA256Final( &xSHA256Context, pucSHA256, ulSHA256Length ) ) != eAzureIoTSuccess )
+        {
+            AZLogError( ( "AzureIoTADUPatch_GetSHA256 failed to finish SHA256: error=0x%08x", ( uint16_t ) xResult ) );
+        }
+    }
+
+    return xResult;
+}
+/*-----------------------------------------------------------*/
+
+AzureIoTResult_t AzureIoTADUPatch_VerifySHA256( AzureIoTADUPatch_t * pxPatch,
+                                                const uint8_t * pucHash,
+                                                uint32_t ulHashLength )
+{
+    AzureIoTResult_t xResult;
+    az_result xCoreResult;
+    uint8_t ucExpected[ azureiotcryptoSHA256_SIZE ];
+    uint8_t ucSHA256[ azureiotcryptoSHA256_SIZE ];
+    int32_t lExpectedLength;
+
+    if( ( pxPatch == NULL ) || ( pucHash == NULL ) || ( ulHashLength == 0 ) )
+    {
+        AZLogError( ( "AzureIoTADUPatch_VerifySHA256 failed: invalid argument" ) );
+        return eAzureIoTErrorInvalidArgument;
+    }
+
+    if( ( xResult = AzureIoTADUPatch_GetSHA256( pxPatch, ucSHA256, sizeof( ucSHA256 ) ) ) != eAzureIoTSuccess )
+    {
+        return xResult;
+    }
+
+    if( az_result_failed( xCoreResult = az_base64_decode( az_span_create( ucExpected, sizeof( ucExpected ) ),
+                                                          az_span_create( ( uint8_t * ) pucHash, ( int32_t ) ulHashLength ),
+                                                          &lExpectedLength ) ) )
+    {
+        AZLogError( ( "AzureIoTADUPatch_VerifySHA256 az_base64_decode failed: core error=0x%08x", ( uint16_t ) xCoreResult ) );
+        return eAzureIoTErrorFailed;
+    }
+
+    if( ( lExpectedLength != ( int32_t ) sizeof( ucExpected ) ) ||
+        ( memcmp( ucExpected, ucSHA256, sizeof( ucExpected ) ) != 0 ) )
+    {
+        AZLogError( ( "AzureIoTADUPatch_VerifySHA256 failed: new image does not match the hash" ) );
+        return eAzureIoTErrorFailed;
+    }
+
+    return eAzureIoTSuccess;
+}
+/*-----------------------------------------------------------*/
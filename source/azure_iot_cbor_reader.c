@@ -0,0 +1,605 @@
+/* Copyright (c) Microsoft Corporation.
+ * Licensed under the MIT License. */
+
+/**
+ * @file azure_iot_cbor_reader.c
+ * @brief Implementation of the CBOR reader.
+ */
+
+#include "azure_iot_cbor_reader.h"
+
+#include <string.h>
+
+#include "azure_iot.h"
+/*-----------------------------------------------------------*/
+
+#define azureiotcborMAJOR_UNSIGNED      ( 0U )
+#define azureiotcborMAJOR_NEGATIVE      ( 1U )
+#define azureiotcborMAJOR_BYTES         ( 2U )
+#define azureiotcborMAJOR_TEXT          ( 3U )
+#define azureiotcborMAJOR_ARRAY         ( 4U )
+#define azureiotcborMAJOR_MAP           ( 5U )
+#define azureiotcborMAJOR_TAG           ( 6U )
+#define azureiotcborMAJOR_SIMPLE        ( 7U )
+
+#define azureiotcborINFO_ONE_BYTE       ( 24U )
+#define azureiotcborINFO_INDEFINITE     ( 31U )
+
+#define azureiotcborSIMPLE_FALSE        ( 20U )
+#define azureiotcborSIMPLE_TRUE         ( 21U )
+#define azureiotcborSIMPLE_NULL         ( 22U )
+#define azureiotcborSIMPLE_UNDEFINED    ( 23U )
+#define azureiotcborSIMPLE_HALF         ( 25U )
+#define azureiotcborSIMPLE_SINGLE       ( 26U )
+#define azureiotcborSIMPLE_DOUBLE       ( 27U )
+
+#define azureiotcborBREAK               ( 0xFFU )
+
+#if azureiotconfigCBOR_READER_MAX_DEPTH > 32
+    #error "azureiotconfigCBOR_READER_MAX_DEPTH must be 32 or less, there is one bit per level in the stacks"
+#endif
+/*-----------------------------------------------------------*/
+
+static bool prvTopIs( const AzureIoTCBORReader_t * pxReader,
+                      uint32_t ulStack )
+{
+    return ( ( ulStack >> ( pxReader->_internal.ucDepth - 1U ) ) & 1U ) != 0U;
+}
+/*-----------------------------------------------------------*/
+
+/* The argument of the head after the initial byte, in 1, 2, 4 or 8 bytes big endian for the
+ * additional information 24 to 27 */
+static bool prvReadArgument( AzureIoTCBORReader_t * pxReader,
+                             uint8_t ucInfo,
+                             uint64_t * pullArgument )
+{
+    uint32_t ulLength;
+    uint32_t ulIndex;
+
+    if( ucInfo < azureiotcborINFO_ONE_BYTE )
+    {
+        *pullArgument = ucInfo;
+        return true;
+    }
+
+    if( ucInfo > azureiotcborSIMPLE_DOUBLE )
+    {
+        return false;
+    }
+
+    ulLength = 1U << ( ucInfo - azureiotcborINFO_ONE_BYTE );
+
+    if( ulLength > pxReader->_internal.ulBufferSize - pxReader->_internal.ulOffset )
+    {
+        return false;
+    }
+
+    *pullArgument = 0;
+
+    for( ulIndex = 0; ulIndex < ulLength; ulIndex++ )
+    {
+        *pullArgument = ( *pullArgument << 8 ) | pxReader->_internal.pucBuffer[ pxReader->_internal.ulOffset++ ];
+    }
+
+    return true;
+}
+/*-----------------------------------------------------------*/
+
+/* Half precision floats (RFC 8949 appendix D) are all single precision floats */
+static double prvHalfToDouble( uint32_t ulHalf )
+{
+    uint32_t ulSign = ( ulHalf & 0x8000U ) << 16;
+    uint32_t ulExponent = ( ulHalf >> 10 ) & 0x1FU;
+    uint32_t ulMantissa = ulHalf & 0x3FFU;
+    uint32_t ulBits;
+    float xSingle;
+
+    if( ulExponent == 0U )
+    {
+        /* Zero or subnormal, a multiple of 2^-24 */
+        xSingle = ( float ) ulMantissa / 16777216.0f;
+
+        return ulSign ? -( double ) xSingle : ( double ) xSingle;
+    }
+
+    if( ulExponent == 0x1FU )
+    {
+        ulBits = ulSign | 0x7F800000U | ( ulMantissa << 13 );
+    }
+    else
+    {
+        ulBits = ulSign | ( ( ulExponent + 127U - 15U ) << 23 ) | ( ulMantissa << 13 );
+    }
+
+    memcpy( &xSingle, &ulBits, sizeof( xSingle ) );
+
+    return ( double ) xSingle;
+}
+/*-----------------------------------------------------------*/
+
+static void prvEndContainer( AzureIoTCBORReader_t * pxReader )
+{
+    pxReader->_internal.xTokenType = prvTopIs( pxReader, pxReader->_internal.ulMapStack ) ?
+                                     eAzureIoTCBORTokenEND_OBJECT : eAzureIoTCBORTokenEND_ARRAY;
+    pxReader->_internal.ucDepth--;
+}
+/*-----------------------------------------------------------*/
+
+static AzureIoTResult_t prvReadToken( AzureIoTCBORReader_t * pxReader )
+{
+    uint32_t ulDepth = pxReader->_internal.ucDepth;
+    uint32_t ulBit = ( ulDepth > 0 ) ? ( 1U << ( ulDepth - 1U ) ) : 0U;
+    bool xIsName = ( pxReader->_internal.ulNameStack & ulBit ) != 0U;
+    bool xIsIndefinite = false;
+    uint32_t ulLeft;
+    uint8_t ucInitial;
+    uint8_t ucMajor;
+    uint8_t ucInfo;
+    uint64_t ullArgument = 0;
+    float xSingle;
+    uint32_t ulSingle;
+
+    if( ulDepth == 0 )
+    {
+        if( pxReader->_internal.xTokenType != eAzureIoTCBORTokenNONE )
+        {
+            return eAzureIoTErrorJSONReaderDone;
+        }
+    }
+    else if( ( ( pxReader->_internal.ulIndefiniteStack & ulBit ) == 0U ) &&
+             ( pxReader->_internal.ulItemsLeft[ ulDepth - 1U ] == 0U ) )
+    {
+        prvEndContainer( pxReader );
+        return eAzureIoTSuccess;
+    }
+
+    /* The head, after any tags */
+    do
+    {
+        if( pxReader->_internal.ulOffset >= pxReader->_internal.ulBufferSize )
+        {
+            AZLogError( ( "AzureIoTCBORReader: truncated" ) );
+            return eAzureIoTErrorUnexpectedChar;
+        }
+
+        ucInitial = pxReader->_internal.pucBuffer[ pxReader->_internal.ulOffset++ ];
+        ucMajor = ( uint8_t ) ( ucInitial >> 5 );
+        ucInfo = ( uint8_t ) ( ucInitial & 0x1FU );
+
+        if( ucInitial == azureiotcborBREAK )
+        {
+            /* The end of an indefinite length container, but not between a name and its value */
+            if( ( ulDepth == 0 ) || ( ( pxReader->_internal.ulIndefiniteStack & ulBit ) == 0U ) ||
+                ( prvTopIs( pxReader, pxReader->_internal.ulMapStack ) && !xIsName ) )
+            {
+                AZLogError( ( "AzureIoTCBORReader: unexpected break" ) );
+                return eAzureIoTErrorUnexpectedChar;
+            }
+
+            prvEndContainer( pxReader );
+            return eAzureIoTSuccess;
+        }
+
+        if( ucInfo == azureiotcborINFO_INDEFINITE )
+        {
+            xIsIndefinite = true;
+
+            if( ( ucMajor != azureiotcborMAJOR_ARRAY ) && ( ucMajor != azureiotcborMAJOR_MAP ) )
+            {
+                AZLogError( ( "AzureIoTCBORReader: chunked strings are not supported" ) );
+                return eAzureIoTErrorUnexpectedChar;
+            }
+        }
+        else if( !prvReadArgument( pxReader, ucInfo, &ullArgument ) )
+        {
+            AZLogError( ( "AzureIoTCBORReader: invalid head 0x%02x", ucInitial ) );
+            return eAzureIoTErrorUnexpectedChar;
+        }
+    } while( ucMajor == azureiotcborMAJOR_TAG );
+
+    if( xIsName && ( ucMajor != azureiotcborMAJOR_TEXT ) )
+    {
+        AZLogError( ( "AzureIoTCBORReader: map keys must be text strings" ) );
+        return eAzureIoTErrorUnexpectedChar;
+    }
+
+    pxReader->_internal.xTokenIsNegative = false;
+    pxReader->_internal.xTokenIsFloat = false;
+    ulLeft = pxReader->_internal.ulBufferSize - pxReader->_internal.ulOffset;
+
+    switch( ucMajor )
+    {
+        case azureiotcborMAJOR_UNSIGNED:
+        case azureiotcborMAJOR_NEGATIVE:
+            pxReader->_internal.xTokenType = eAzureIoTCBORTokenNUMBER;
+            pxReader->_internal.ullTokenInteger = ullArgument;
+            pxReader->_internal.xTokenIsNegative = ( ucMajor == azureiotcborMAJOR_NEGATIVE );
+            break;
+
+        case azureiotcborMAJOR_BYTES:
+        case azureiotcborMAJOR_TEXT:
+
+            if( ullArgument > ulLeft )
+            {
+                AZLogError( ( "AzureIoTCBORReader: truncated" ) );
+                return eAzureIoTErrorUnexpectedChar;
+            }
+
+            pxReader->_internal.xTokenType = ( ucMajor == azureiotcborMAJOR_BYTES ) ? eAzureIoTCBORTokenBYTES :
+                                             xIsName ? eAzureIoTCBORTokenPROPERTY_NAME : eAzureIoTCBORTokenSTRING;
+            pxReader->_internal.pucTokenString = pxReader->_internal.pucBuffer + pxReader->_internal.ulOffset;
+            pxReader->_internal.ulTokenStringLength = ( uint32_t ) ullArgument;
+            pxReader->_internal.ulOffset += ( uint32_t ) ullArgument;
+            break;
+
+        case azureiotcborMAJOR_ARRAY:
+        case azureiotcborMAJOR_MAP:
+
+            if( ulDepth == azureiotconfigCBOR_READER_MAX_DEPTH )
+            {
+                AZLogError( ( "AzureIoTCBORReader: nesting too deep" ) );
+                return eAzureIoTErrorJSONNestingOverflow;
+            }
+
+            /* Every item takes at least a byte */
+            if( !xIsIndefinite &&
+                ( ullArgument > ( ( ucMajor == azureiotcborMAJOR_MAP ) ? ( ulLeft / 2U ) : ulLeft ) ) )
+            {
+                AZLogError( ( "AzureIoTCBORReader: truncated" ) );
+                return eAzureIoTErrorUnexpectedChar;
+            }
+
+            pxReader->_internal.xTokenType = ( ucMajor == azureiotcborMAJOR_MAP ) ?
+                                             eAzureIoTCBORTokenBEGIN_OBJECT : eAzureIoTCBORTokenBEGIN_ARRAY;
+            break;
+
+        case azureiotcborMAJOR_SIMPLE:
+
+            switch( ucInfo )
+            {
+                case azureiotcborSIMPLE_FALSE:
+                    pxReader->_internal.xTokenType = eAzureIoTCBORTokenFALSE;
+                    break;
+
+                case azureiotcborSIMPLE_TRUE:
+                    pxReader->_internal.xTokenType = eAzureIoTCBORTokenTRUE;
+                    break;
+
+                case azureiotcborSIMPLE_NULL:
+                case azureiotcborSIMPLE_UNDEFINED:
+                    pxReader->_internal.xTokenType = eAzureIoTCBORTokenNULL;
+                    break;
+
+                case azureiotcborSIMPLE_HALF:
+                    pxReader->_internal.xTokenFloat = prvHalfToDouble( ( uint32_t ) ullArgument );
+                    break;
+
+                case azureiotcborSIMPLE_SINGLE:
+                    ulSingle = ( uint32_t ) ullArgument;
+                    memcpy( &xSingle, &ulSingle, sizeof( xSingle ) );
+                    pxReader->_internal.xTokenFloat = ( double ) xSingle;
+                    break;
+
+                case azureiotcborSIMPLE_DOUBLE:
+                    memcpy( &pxReader->_internal.xTokenFloat, &ullArgument, sizeof( ullArgument ) );
+                    break;
+
+                default:
+                    AZLogError( ( "AzureIoTCBORReader: simple value %u is not supported", ( uint16_t ) ucInfo ) );
+                    return eAzureIoTErrorUnexpectedChar;
+            }
+
+            if( ucInfo >= azureiotcborSIMPLE_HALF )
+            {
+                pxReader->_internal.xTokenType = eAzureIoTCBORTokenNUMBER;
+                pxReader->_internal.xTokenIsFloat = true;
+            }
+
+            break;
+
+        default:
+            /* Tags were skipped */
+            return eAzureIoTErrorUnexpectedChar;
+    }
+
+    /* The token is an item of its container, and the value of a name in a map */
+    if( ulDepth > 0 )
+    {
+        if( ( pxReader->_internal.ulIndefiniteStack & ulBit ) == 0U )
+        {
+            pxReader->_internal.ulItemsLeft[ ulDepth - 1U ]--;
+        }
+
+        if( pxReader->_internal.ulMapStack & ulBit )
+        {
+            pxReader->_internal.ulNameStack ^= ulBit;
+        }
+    }
+
+    if( ( ucMajor == azureiotcborMAJOR_ARRAY ) || ( ucMajor == azureiotcborMAJOR_MAP ) )
+    {
+        ulBit = 1U << ulDepth;
+        pxReader->_internal.ulMapStack &= ~ulBit;
+        pxReader->_internal.ulNameStack &= ~ulBit;
+        pxReader->_internal.ulIndefiniteStack &= ~ulBit;
+
+        if( ucMajor == azureiotcborMAJOR_MAP )
+        {
+            pxReader->_internal.ulMapStack |= ulBit;
+            pxReader->_internal.ulNameStack |= ulBit;
+        }
+
+        if( xIsIndefinite )
+        {
+            pxReader->_internal.ulIndefiniteStack |= ulBit;
+            pxReader->_internal.ulItemsLeft[ ulDepth ] = 0;
+        }
+        else
+        {
+            pxReader->_internal.ulItemsLeft[ ulDepth ] = ( uint32_t ) ullArgument *
+                                                         ( ( ucMajor == azureiotcborMAJOR_MAP ) ? 2U : 1U );
+        }
+
+        pxReader->_internal.ucDepth++;
+    }
+
+    return eAzureIoTSuccess;
+}
+/*-----------------------------------------------------------*/
+
+static bool prvIsText( const AzureIoTCBORReader_t * pxReader )
+{
+    return ( pxReader->_internal.xTokenType == eAzureIoTCBORTokenSTRING ) ||
+           ( pxReader->_internal.xTokenType == eAzureIoTCBORTokenPROPERTY_NAME );
+}
+/*-----------------------------------------------------------*/
+
+AzureIoTResult_t AzureIoTCBORReader_Init( AzureIoTCBORReader_t * pxReader,
+                                          const uint8_t * pucBuffer,
+                                          uint32_t ulBufferSize )
+{
+    if( ( pxReader == NULL ) || ( pucBuffer == NULL ) || ( ulBufferSize == 0 ) )
+    {
+        AZLogError( ( "AzureIoTCBORReader_Init failed: invalid argument" ) );
+        return eAzureIoTErrorInvalidArgument;
+    }
+
+    memset( pxReader, 0, sizeof( *pxReader ) );
+    pxReader->_internal.pucBuffer = pucBuffer;
+    pxReader->_internal.ulBufferSize = ulBufferSize;
+
+    return eAzureIoTSuccess;
+}
+/*-----------------------------------------------------------*/
+
+AzureIoTResult_t AzureIoTCBORReader_NextToken( AzureIoTCBORReader_t * pxReader )
+{
+    if( pxReader == NULL )
+    {
+        AZLogError( ( "AzureIoTCBORReader_NextToken failed: invalid argument" ) );
+        return eAzureIoTErrorInvalidArgument;
+    }
+
+    return prvReadToken( pxReader );
+}
+/*-----------------------------------------------------------*/
+
+AzureIoTResult_t AzureIoTCBORReader_SkipChildren( AzureIoTCBORReader_t * pxReader )
+{
+    AzureIoTResult_t xResult;
+    uint8_t ucDepth;
+
+    if( pxReader == NULL )
+    {
+        AZLogError( ( "AzureIoTCBORReader_SkipChildren failed: invalid argument" ) );
+        return eAzureIoTErrorInvalidArgument;
+    }
+
+    if( ( pxReader->_internal.xTokenType == eAzureIoTCBORTokenPROPERTY_NAME ) &&
+        ( ( xResult = prvReadToken( pxReader ) ) != eAzureIoTSuccess ) )
+    {
+        return xResult;
+    }
+
+    if( ( pxReader->_internal.xTokenType == eAzureIoTCBORTokenBEGIN_OBJECT ) ||
+        ( pxReader->_internal.xTokenType == eAzureIoTCBORTokenBEGIN_ARRAY ) )
+    {
+        ucDepth = ( uint8_t ) ( pxReader->_internal.ucDepth - 1U );
+
+        while( pxReader->_internal.ucDepth > ucDepth )
+        {
+            if( ( xResult = prvReadToken( pxReader ) ) != eAzureIoTSuccess )
+            {
+                return xResult;
+            }
+        }
+    }
+
+    return eAzureIoTSuccess;
+}
+/*-----------------------------------------------------------*/
+
+AzureIoTResult_t AzureIoTCBORReader_GetTokenBool( AzureIoTCBORReader_t * pxReader,
+                                                  bool * pxValue )
+{
+    if( ( pxReader == NULL ) || ( pxValue == NULL ) )
+    {
+        AZLogError( ( "AzureIoTCBORReader_GetTokenBool failed: invalid argument" ) );
+        return eAzureIoTErrorInvalidArgument;
+    }
+
+    if( ( pxReader->_internal.xTokenType != eAzureIoTCBORTokenTRUE ) &&
+        ( pxReader->_internal.xTokenType != eAzureIoTCBORTokenFALSE ) )
+    {
+        return eAzureIoTErrorJSONInvalidState;
+    }
+
+    *pxValue = ( pxReader->_internal.xTokenType == eAzureIoTCBORTokenTRUE );
+
+    return eAzureIoTSuccess;
+}
+/*-----------------------------------------------------------*/
+
+AzureIoTResult_t AzureIoTCBORReader_GetTokenInt32( AzureIoTCBORReader_t * pxReader,
+                                                   int32_t * plValue )
+{
+    if( ( pxReader == NULL ) || ( plValue == NULL ) )
+    {
+        AZLogError( ( "AzureIoTCBORReader_GetTokenInt32 failed: invalid argument" ) );
+        return eAzureIoTErrorInvalidArgument;
+    }
+
+    if( pxReader->_internal.xTokenType != eAzureIoTCBORTokenNUMBER )
+    {
+        return eAzureIoTErrorJSONInvalidState;
+    }
+
+    /* -1 - n for negative integers, INT32_MIN included */
+    if( pxReader->_internal.xTokenIsFloat || ( pxReader->_internal.ullTokenInteger > 0x7FFFFFFFULL ) )
+    {
+        return eAzureIoTErrorUnexpectedChar;
+    }
+
+    *plValue = pxReader->_internal.xTokenIsNegative ?
+               ( int32_t ) ( -1 - ( int64_t ) pxReader->_internal.ullTokenInteger ) :
+               ( int32_t ) pxReader->_internal.ullTokenInteger;
+
+    return eAzureIoTSuccess;
+}
+/*-----------------------------------------------------------*/
+
+AzureIoTResult_t AzureIoTCBORReader_GetTokenDouble( AzureIoTCBORReader_t * pxReader,
+                                                    double * pxValue )
+{
+    if( ( pxReader == NULL ) || ( pxValue == NULL ) )
+    {
+        AZLogError( ( "AzureIoTCBORReader_GetTokenDouble failed: invalid argument" ) );
+        return eAzureIoTErrorInvalidArgument;
+    }
+
+    if( pxReader->_internal.xTokenType != eAzureIoTCBORTokenNUMBER )
+    {
+        return eAzureIoTErrorJSONInvalidState;
+    }
+
+    if( pxReader->_internal.xTokenIsFloat )
+    {
+        *pxValue = pxReader->_internal.xTokenFloat;
+    }
+    else if( pxReader->_internal.xTokenIsNegative )
+    {
+        *pxValue = -1.0 - ( double ) pxReader->_internal.ullTokenInteger;
+    }
+    else
+    {
+        *pxValue = ( double ) pxReader->_internal.ullTokenInteger;
+    }
+
+    return eAzureIoTSuccess;
+}
+/*-----------------------------------------------------------*/
+
+AzureIoTResult_t AzureIoTCBORReader_GetTokenString( AzureIoTCBORReader_t * pxReader,
+                                                    uint8_t * pucBuffer,
+                                                    uint32_t ulBufferSize,
+                                                    uint32_t * pulBytesCopied )
+{
+    if( ( pxReader == NULL ) || ( pucBuffer == NULL ) || ( ulBufferSize == 0 ) || ( pulBytesCopied == NULL ) )
+    {
+        AZLogError( ( "AzureIoTCBORReader_GetTokenString failed: invalid argument" ) );
+        return eAzureIoTErrorInvalidArgument;
+    }
+
+    if( !prvIsText( pxReader ) )
+    {
+        return eAzureIoTErrorJSONInvalidState;
+    }
+
+    if( pxReader->_internal.ulTokenStringLength >= ulBufferSize )
+    {
+        return eAzureIoTErrorOutOfMemory;
+    }
+
+    memcpy( pucBuffer, pxReader->_internal.pucTokenString, pxReader->_internal.ulTokenStringLength );
+    pucBuffer[ pxReader->_internal.ulTokenStringLength ] = '\0';
+    *pulBytesCopied = pxReader->_internal.ulTokenStringLength;
+
+    return eAzureIoTSuccess;
+}
+/*-----------------------------------------------------------*/
+
+AzureIoTResult_t AzureIoTCBORReader_GetTokenStringView( AzureIoTCBORReader_t * pxReader,
+                                                        const uint8_t ** ppucString,
+                                                        uint32_t * pulStringLength )
+{
+    if( ( pxReader == NULL ) || ( ppucString == NULL ) || ( pulStringLength == NULL ) )
+    {
+        AZLogError( ( "AzureIoTCBORReader_GetTokenStringView failed: invalid argument" ) );
+        return eAzureIoTErrorInvalidArgument;
+    }
+
+    if( !prvIsText( pxReader ) )
+    {
+        return eAzureIoTErrorJSONInvalidState;
+    }
+
+    *ppucString = pxReader->_internal.pucTokenString;
+    *pulStringLength = pxReader->_internal.ulTokenStringLength;
+
+    return eAzureIoTSuccess;
+}
+/*-----------------------------------------------------------*/
+
+AzureIoTResult_t AzureIoTCBORReader_GetTokenBytes( AzureIoTCBORReader_t * pxReader,
+                                                   const uint8_t ** ppucBytes,
+                                                   uint32_t * pulBytesLength )
+{
+    if( ( pxReader == NULL ) || ( ppucBytes == NULL ) || ( pulBytesLength == NULL ) )
+    {
+        AZLogError( ( "AzureIoTCBORReader_GetTokenBytes failed: invalid argument" ) );
+        return eAzureIoTErrorInvalidArgument;
+    }
+
+    if( pxReader->_internal.xTokenType != eAzureIoTCBORTokenBYTES )
+    {
+        return eAzureIoTErrorJSONInvalidState;
+    }
+
+    *ppucBytes = pxReader->_internal.pucTokenString;
+    *pulBytesLength = pxReader->_internal.ulTokenStringLength;
+
+    return eAzureIoTSuccess;
+}
+/*-----------------------------------------------------------*/
+
+bool AzureIoTCBORReader_TokenIsTextEqual( AzureIoTCBORReader_t * pxReader,
+                                          const uint8_t * pucExpectedText,
+                                          uint32_t ulExpectedTextLength )
+{
+    if( ( pxReader == NULL ) || ( ( pucExpectedText == NULL ) && ( ulExpectedTextLength > 0 ) ) )
+    {
+        AZLogError( ( "AzureIoTCBORReader_TokenIsTextEqual failed: invalid argument" ) );
+        return false;
+    }
+
+    return prvIsText( pxReader ) &&
+           ( pxReader->_internal.ulTokenStringLength == ulExpectedTextLength ) &&
+           ( ( ulExpectedTextLength == 0 ) ||
+             ( memcmp( pxReader->_internal.pucTokenString, pucExpectedText, ulExpectedTextLength ) == 0 ) );
+}
+/*-----------------------------------------------------------*/
+
+AzureIoTResult_t AzureIoTCBORReader_TokenType( AzureIoTCBORReader_t * pxReader,
+                                               AzureIoTCBORTokenType_t * pxTokenType )
+{
+    if( ( pxReader == NULL ) || ( pxTokenType == NULL ) )
+    {
+        AZLogError( ( "AzureIoTCBORReader_TokenType failed: invalid argument" ) );
+        return eAzureIoTErrorInvalidArgument;
+    }
+
+    *pxTokenType = pxReader->_internal.xTokenType;
+
+    return eAzureIoTSuccess;
+}
+/*-----------------------------------------------------------*/
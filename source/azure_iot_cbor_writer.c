@@ -0,0 +1,646 @@
+/* Copyright (c) Microsoft Corporation.
+ * Licensed under the MIT License. */
+
+/**
+ * @file azure_iot_cbor_writer.c
+ * @brief Implementation of the CBOR writer.
+ */
+
+#include "azure_iot_cbor_writer.h"
+
+#include <string.h>
+
+#include "azure_iot.h"
+/*-----------------------------------------------------------*/
+
+#define azureiotcborMAJOR_UNSIGNED       ( 0U )
+#define azureiotcborMAJOR_NEGATIVE       ( 1U )
+#define azureiotcborMAJOR_BYTES          ( 2U )
+#define azureiotcborMAJOR_TEXT           ( 3U )
+
+#define azureiotcborFALSE                ( 0xF4U )
+#define azureiotcborTRUE                 ( 0xF5U )
+#define azureiotcborNULL                 ( 0xF6U )
+#define azureiotcborHALF                 ( 0xF9U )
+#define azureiotcborSINGLE               ( 0xFAU )
+#define azureiotcborDOUBLE               ( 0xFBU )
+#define azureiotcborBEGIN_ARRAY          ( 0x9FU )
+#define azureiotcborBEGIN_MAP            ( 0xBFU )
+#define azureiotcborBREAK                ( 0xFFU )
+
+/* One bit per level in ulMapStack */
+#define azureiotcborWRITER_MAX_DEPTH     ( 32U )
+
+/* Longest head: the initial byte and a 4 byte argument */
+#define azureiotcborHEAD_MAX             ( 5U )
+
+/* Longest float: the initial byte and a double */
+#define azureiotcborFLOAT_MAX            ( 9U )
+/*-----------------------------------------------------------*/
+
+static bool prvInMap( const AzureIoTCBORWriter_t * pxWriter )
+{
+    return ( pxWriter->_internal.ucDepth > 0 ) &&
+           ( ( pxWriter->_internal.ulMapStack >> ( pxWriter->_internal.ucDepth - 1U ) ) & 1U );
+}
+/*-----------------------------------------------------------*/
+
+/* The head of a data item: the major type and its argument in the fewest bytes, big endian */
+static uint32_t prvEncodeHead( uint8_t * pucHead,
+                               uint8_t ucMajorType,
+                               uint32_t ulArgument )
+{
+    uint8_t ucMajor = ( uint8_t ) ( ucMajorType << 5 );
+
+    if( ulArgument < 24U )
+    {
+        pucHead[ 0 ] = ( uint8_t ) ( ucMajor | ulArgument );
+        return 1;
+    }
+    else if( ulArgument <= 0xFFU )
+    {
+        pucHead[ 0 ] = ( uint8_t ) ( ucMajor | 24U );
+        pucHead[ 1 ] = ( uint8_t ) ulArgument;
+        return 2;
+    }
+    else if( ulArgument <= 0xFFFFU )
+    {
+        pucHead[ 0 ] = ( uint8_t ) ( ucMajor | 25U );
+        pucHead[ 1 ] = ( uint8_t ) ( ulArgument >> 8 );
+        pucHead[ 2 ] = ( uint8_t ) ulArgument;
+        return 3;
+    }
+
+    pucHead[ 0 ] = ( uint8_t ) ( ucMajor | 26U );
+    pucHead[ 1 ] = ( uint8_t ) ( ulArgument >> 24 );
+    pucHead[ 2 ] = ( uint8_t ) ( ulArgument >> 16 );
+    pucHead[ 3 ] = ( uint8_t ) ( ulArgument >> 8 );
+    pucHead[ 4 ] = ( uint8_t ) ulArgument;
+
+    return 5;
+}
+/*-----------------------------------------------------------*/
+
+/* The smallest float holding xValue exactly, as half (RFC 8949 appendix D), single or double precision */
+static uint32_t prvEncodeFloat( uint8_t * pucFloat,
+                                double xValue )
+{
+    float xSingle = ( float ) xValue;
+    uint64_t ullBits;
+    uint32_t ulBits;
+    uint32_t ulSign;
+    uint32_t ulMantissa;
+    int32_t lExponent;
+    uint32_t ulShift;
+    int32_t lHalf = -1;
+    uint32_t ulIndex;
+
+    if( xValue != xValue )
+    {
+        /* The canonical quiet NaN */
+        lHalf = 0x7E00;
+    }
+    else if( ( double ) xSingle == xValue )
+    {
+        memcpy( &ulBits, &xSingle, sizeof( ulBits ) );
+        ulSign = ( ulBits >> 16 ) & 0x8000U;
+        lExponent = ( int32_t ) ( ( ulBits >> 23 ) & 0xFFU ) - 127;
+        ulMantissa = ulBits & 0x7FFFFFU;
+
+        if( ( ulBits & 0x7FFFFFFFU ) == 0U )
+        {
+            lHalf = ( int32_t ) ulSign;
+        }
+        else if( lExponent == 128 )
+        {
+            lHalf = ( int32_t ) ( ulSign | 0x7C00U );
+        }
+        else if( ( lExponent >= -14 ) && ( lExponent <= 15 ) && ( ( ulMantissa & 0x1FFFU ) == 0U ) )
+        {
+            lHalf = ( int32_t ) ( ulSign | ( ( uint32_t ) ( lExponent + 15 ) << 10 ) | ( ulMantissa >> 13 ) );
+        }
+        else if( ( lExponent >= -24 ) && ( lExponent < -14 ) )
+        {
+            /* A half precision subnormal, a multiple of 2^-24 */
+            ulMantissa |= 0x800000U;
+            ulShift = ( uint32_t ) ( -1 - lExponent );
+
+            if( ( ulMantissa & ( ( 1U << ulShift ) - 1U ) ) == 0U )
+            {
+                lHalf = ( int32_t ) ( ulSign | ( ulMantissa >> ulShift ) );
+            }
+        }
+
+        if( lHalf < 0 )
+        {
+            pucFloat[ 0 ] = azureiotcborSINGLE;
+
+            for( ulIndex = 0; ulIndex < 4U; ulIndex++ )
+            {
+                pucFloat[ 1U + ulIndex ] = ( uint8_t ) ( ulBits >> ( 24U - 8U * ulIndex ) );
+            }
+
+            return 5;
+        }
+    }
+    else
+    {
+        memcpy( &ullBits, &xValue, sizeof( ullBits ) );
+        pucFloat[ 0 ] = azureiotcborDOUBLE;
+
+        for( ulIndex = 0; ulIndex < 8U; ulIndex++ )
+        {
+            pucFloat[ 1U + ulIndex ] = ( uint8_t ) ( ullBits >> ( 56U - 8U * ulIndex ) );
+        }
+
+        return 9;
+    }
+
+    pucFloat[ 0 ] = azureiotcborHALF;
+    pucFloat[ 1 ] = ( uint8_t ) ( ( uint32_t ) lHalf >> 8 );
+    pucFloat[ 2 ] = ( uint8_t ) lHalf;
+
+    return 3;
+}
+/*-----------------------------------------------------------*/
+
+/* Append a data item: its head, then ulDataLength bytes of pucData. Nothing is written when the
+ * item is not allowed here or does not fit. */
+static AzureIoTResult_t prvAppendItem( AzureIoTCBORWriter_t * pxWriter,
+                                       const uint8_t * pucHead,
+                                       uint32_t ulHeadLength,
+                                       const uint8_t * pucData,
+                                       uint32_t ulDataLength,
+                                       bool xIsPropertyName )
+{
+    uint32_t ulBytesUsed = pxWriter->_internal.ulBytesUsed;
+
+    if( xIsPropertyName != pxWriter->_internal.xNeedsPropertyName )
+    {
+        AZLogError( ( "AzureIoTCBORWriter: %s", xIsPropertyName ? "unexpected property name" :
+                      "property name expected" ) );
+        return eAzureIoTErrorJSONInvalidState;
+    }
+
+    if( ( ulHeadLength > pxWriter->_internal.ulBufferSize - ulBytesUsed ) ||
+        ( ulDataLength > pxWriter->_internal.ulBufferSize - ulBytesUsed - ulHeadLength ) )
+    {
+        return eAzureIoTErrorOutOfMemory;
+    }
+
+    memcpy( pxWriter->_internal.pucBuffer + ulBytesUsed, pucHead, ulHeadLength );
+
+    if( ulDataLength > 0 )
+    {
+        memcpy( pxWriter->_internal.pucBuffer + ulBytesUsed + ulHeadLength, pucData, ulDataLength );
+    }
+
+    pxWriter->_internal.ulBytesUsed = ulBytesUsed + ulHeadLength + ulDataLength;
+
+    /* A name is followed by its value, a value in a map by the next name */
+    pxWriter->_internal.xNeedsPropertyName = !xIsPropertyName && prvInMap( pxWriter );
+
+    return eAzureIoTSuccess;
+}
+/*-----------------------------------------------------------*/
+
+static AzureIoTResult_t prvAppendString( AzureIoTCBORWriter_t * pxWriter,
+                                         uint8_t ucMajorType,
+                                         const uint8_t * pucValue,
+                                         uint32_t ulValueLen,
+                                         bool xIsPropertyName )
+{
+    uint8_t ucHead[ azureiotcborHEAD_MAX ];
+
+    return prvAppendItem( pxWriter, ucHead, prvEncodeHead( ucHead, ucMajorType, ulValueLen ),
+                          pucValue, ulValueLen, xIsPropertyName );
+}
+/*-----------------------------------------------------------*/
+
+static AzureIoTResult_t prvAppendInt32( AzureIoTCBORWriter_t * pxWriter,
+                                        int32_t lValue )
+{
+    uint8_t ucHead[ azureiotcborHEAD_MAX ];
+    uint32_t ulHeadLength;
+
+    if( lValue >= 0 )
+    {
+        ulHeadLength = prvEncodeHead( ucHead, azureiotcborMAJOR_UNSIGNED, ( uint32_t ) lValue );
+    }
+    else
+    {
+        /* -1 - n, computed without overflow for INT32_MIN */
+        ulHeadLength = prvEncodeHead( ucHead, azureiotcborMAJOR_NEGATIVE, ( uint32_t ) ( -( lValue + 1 ) ) );
+    }
+
+    return prvAppendItem( pxWriter, ucHead, ulHeadLength, NULL, 0, false );
+}
+/*-----------------------------------------------------------*/
+
+static AzureIoTResult_t prvAppendSimple( AzureIoTCBORWriter_t * pxWriter,
+                                         uint8_t ucValue )
+{
+    return prvAppendItem( pxWriter, &ucValue, 1, NULL, 0, false );
+}
+/*-----------------------------------------------------------*/
+
+static AzureIoTResult_t prvAppendBegin( AzureIoTCBORWriter_t * pxWriter,
+                                        bool xIsMap )
+{
+    AzureIoTResult_t xResult;
+
+    if( pxWriter->_internal.ucDepth == azureiotcborWRITER_MAX_DEPTH )
+    {
+        AZLogError( ( "AzureIoTCBORWriter: nesting too deep" ) );
+        return eAzureIoTErrorJSONNestingOverflow;
+    }
+
+    if( ( xResult = prvAppendSimple( pxWriter, xIsMap ? azureiotcborBEGIN_MAP : azureiotcborBEGIN_ARRAY ) ) == eAzureIoTSuccess )
+    {
+        if( xIsMap )
+        {
+            pxWriter->_internal.ulMapStack |= 1U << pxWriter->_internal.ucDepth;
+        }
+        else
+        {
+            pxWriter->_internal.ulMapStack &= ~( 1U << pxWriter->_internal.ucDepth );
+        }
+
+        pxWriter->_internal.ucDepth++;
+        pxWriter->_internal.xNeedsPropertyName = xIsMap;
+    }
+
+    return xResult;
+}
+/*-----------------------------------------------------------*/
+
+static AzureIoTResult_t prvAppendEnd( AzureIoTCBORWriter_t * pxWriter,
+                                      bool xIsMap )
+{
+    /* In a map, the value of the last property name must have been written */
+    if( ( pxWriter->_internal.ucDepth == 0 ) || ( prvInMap( pxWriter ) != xIsMap ) ||
+        ( xIsMap && !pxWriter->_internal.xNeedsPropertyName ) )
+    {
+        AZLogError( ( "AzureIoTCBORWriter: no %s to end", xIsMap ? "map" : "array" ) );
+        return eAzureIoTErrorJSONInvalidState;
+    }
+
+    if( pxWriter->_internal.ulBytesUsed == pxWriter->_internal.ulBufferSize )
+    {
+        return eAzureIoTErrorOutOfMemory;
+    }
+
+    pxWriter->_internal.pucBuffer[ pxWriter->_internal.ulBytesUsed++ ] = azureiotcborBREAK;
+    pxWriter->_internal.ucDepth--;
+    pxWriter->_internal.xNeedsPropertyName = prvInMap( pxWriter );
+
+    return eAzureIoTSuccess;
+}
+/*-----------------------------------------------------------*/
+
+AzureIoTResult_t AzureIoTCBORWriter_Init( AzureIoTCBORWriter_t * pxWriter,
+                                          uint8_t * pucBuffer,
+                                          uint32_t ulBufferSize )
+{
+    if( ( pxWriter == NULL ) || ( pucBuffer == NULL ) )
+    {
+        AZLogError( ( "AzureIoTCBORWriter_Init failed: invalid argument" ) );
+        return eAzureIoTErrorInvalidArgument;
+    }
+
+    memset( pxWriter, 0, sizeof( *pxWriter ) );
+    pxWriter->_internal.pucBuffer = pucBuffer;
+    pxWriter->_internal.ulBufferSize = ulBufferSize;
+
+    return eAzureIoTSuccess;
+}
+/*-----------------------------------------------------------*/
+
+AzureIoTResult_t AzureIoTCBORWriter_AppendPropertyWithInt32Value( AzureIoTCBORWriter_t * pxWriter,
+                                                                  const uint8_t * pucPropertyName,
+                                                                  uint32_t ulPropertyNameLength,
+                                                                  int32_t lValue )
+{
+    AzureIoTResult_t xResult;
+    uint32_t ulBytesUsed;
+
+    if( ( pxWriter == NULL ) || ( pucPropertyName == NULL ) || ( ulPropertyNameLength == 0 ) )
+    {
+        AZLogError( ( "AzureIoTCBORWriter_AppendPropertyWithInt32Value failed: invalid argument" ) );
+        return eAzureIoTErrorInvalidArgument;
+    }
+
+    ulBytesUsed = pxWriter->_internal.ulBytesUsed;
+
+    if( ( ( xResult = prvAppendString( pxWriter, azureiotcborMAJOR_TEXT, pucPropertyName,
+                                       ulPropertyNameLength, true ) ) == eAzureIoTSuccess ) &&
+        ( ( xResult = prvAppendInt32( pxWriter, lValue ) ) != eAzureIoTSuccess ) )
+    {
+        /* Take the name back, the writer is left as it was */
+        pxWriter->_internal.ulBytesUsed = ulBytesUsed;
+        pxWriter->_internal.xNeedsPropertyName = true;
+    }
+
+    if( xResult != eAzureIoTSuccess )
+    {
+        AZLogError( ( "Could not append property and int32: error=0x%08x", ( uint16_t ) xResult ) );
+    }
+
+    return xResult;
+}
+/*-----------------------------------------------------------*/
+
+AzureIoTResult_t AzureIoTCBORWriter_AppendPropertyWithDoubleValue( AzureIoTCBORWriter_t * pxWriter,
+                                                                   const uint8_t * pucPropertyName,
+                                                                   uint32_t ulPropertyNameLength,
+                                                                   double xValue )
+{
+    AzureIoTResult_t xResult;
+    uint32_t ulBytesUsed;
+
+    if( ( pxWriter == NULL ) || ( pucPropertyName == NULL ) || ( ulPropertyNameLength == 0 ) )
+    {
+        AZLogError( ( "AzureIoTCBORWriter_AppendPropertyWithDoubleValue failed: invalid argument" ) );
+        return eAzureIoTErrorInvalidArgument;
+    }
+
+    ulBytesUsed = pxWriter->_internal.ulBytesUsed;
+
+    if( ( ( xResult = prvAppendString( pxWriter, azureiotcborMAJOR_TEXT, pucPropertyName,
+                                       ulPropertyNameLength, true ) ) == eAzureIoTSuccess ) &&
+        ( ( xResult = AzureIoTCBORWriter_AppendDouble( pxWriter, xValue ) ) != eAzureIoTSuccess ) )
+    {
+        /* Take the name back, the writer is left as it was */
+        pxWriter->_internal.ulBytesUsed = ulBytesUsed;
+        pxWriter->_internal.xNeedsPropertyName = true;
+    }
+
+    if( xResult != eAzureIoTSuccess )
+    {
+        AZLogError( ( "Could not append property and double: error=0x%08x", ( uint16_t ) xResult ) );
+    }
+
+    return xResult;
+}
+/*-----------------------------------------------------------*/
+
+AzureIoTResult_t AzureIoTCBORWriter_AppendPropertyWithBoolValue( AzureIoTCBORWriter_t * pxWriter,
+                                                                 const uint8_t * pucPropertyName,
+                                                                 uint32_t ulPropertyNameLength,
+                                                                 bool xValue )
+{
+    AzureIoTResult_t xResult;
+    uint32_t ulBytesUsed;
+
+    if( ( pxWriter == NULL ) || ( pucPropertyName == NULL ) || ( ulPropertyNameLength == 0 ) )
+    {
+        AZLogError( ( "AzureIoTCBORWriter_AppendPropertyWithBoolValue failed: invalid argument" ) );
+        return eAzureIoTErrorInvalidArgument;
+    }
+
+    ulBytesUsed = pxWriter->_internal.ulBytesUsed;
+
+    if( ( ( xResult = prvAppendString( pxWriter, azureiotcborMAJOR_TEXT, pucPropertyName,
+                                       ulPropertyNameLength, true ) ) == eAzureIoTSuccess ) &&
+        ( ( xResult = prvAppendSimple( pxWriter, xValue ? azureiotcborTRUE : azureiotcborFALSE ) ) != eAzureIoTSuccess ) )
+    {
+        /* Take the name back, the writer is left as it was */
+        pxWriter->_internal.ulBytesUsed = ulBytesUsed;
+        pxWriter->_internal.xNeedsPropertyName = true;
+    }
+
+    if( xResult != eAzureIoTSuccess )
+    {
+        AZLogError( ( "Could not append property and bool: error=0x%08x", ( uint16_t ) xResult ) );
+    }
+
+    return xResult;
+}
+/*-----------------------------------------------------------*/
+
+AzureIoTResult_t AzureIoTCBORWriter_AppendPropertyWithStringValue( AzureIoTCBORWriter_t * pxWriter,
+                                                                   const uint8_t * pucPropertyName,
+                                                                   uint32_t ulPropertyNameLength,
+                                                                   const uint8_t * pucValue,
+                                                                   uint32_t ulValueLen )
+{
+    AzureIoTResult_t xResult;
+    uint32_t ulBytesUsed;
+
+    if( ( pxWriter == NULL ) || ( pucPropertyName == NULL ) || ( ulPropertyNameLength == 0 ) ||
+        ( ( pucValue == NULL ) && ( ulValueLen > 0 ) ) )
+    {
+        AZLogError( ( "AzureIoTCBORWriter_AppendPropertyWithStringValue failed: invalid argument" ) );
+        return eAzureIoTErrorInvalidArgument;
+    }
+
+    ulBytesUsed = pxWriter->_internal.ulBytesUsed;
+
+    if( ( ( xResult = prvAppendString( pxWriter, azureiotcborMAJOR_TEXT, pucPropertyName,
+                                       ulPropertyNameLength, true ) ) == eAzureIoTSuccess ) &&
+        ( ( xResult = prvAppendString( pxWriter, azureiotcborMAJOR_TEXT, pucValue, ulValueLen, false ) ) != eAzureIoTSuccess ) )
+    {
+        /* Take the name back, the writer is left as it was */
+        pxWriter->_internal.ulBytesUsed = ulBytesUsed;
+        pxWriter->_internal.xNeedsPropertyName = true;
+    }
+
+    if( xResult != eAzureIoTSuccess )
+    {
+        AZLogError( ( "Could not append property and string: error=0x%08x", ( uint16_t ) xResult ) );
+    }
+
+    return xResult;
+}
+/*-----------------------------------------------------------*/
+
+AzureIoTResult_t AzureIoTCBORWriter_AppendPropertyWithBytesValue( AzureIoTCBORWriter_t * pxWriter,
+                                                                  const uint8_t * pucPropertyName,
+                                                                  uint32_t ulPropertyNameLength,
+                                                                  const uint8_t * pucValue,
+                                                                  uint32_t ulValueLen )
+{
+    AzureIoTResult_t xResult;
+    uint32_t ulBytesUsed;
+
+    if( ( pxWriter == NULL ) || ( pucPropertyName == NULL ) || ( ulPropertyNameLength == 0 ) ||
+        ( ( pucValue == NULL ) && ( ulValueLen > 0 ) ) )
+    {
+        AZLogError( ( "AzureIoTCBORWriter_AppendPropertyWithBytesValue failed: invalid argument" ) );
+        return eAzureIoTErrorInvalidArgument;
+    }
+
+    ulBytesUsed = pxWriter->_internal.ulBytesUsed;
+
+    if( ( ( xResult = prvAppendString( pxWriter, azureiotcborMAJOR_TEXT, pucPropertyName,
+                                       ulPropertyNameLength, true ) ) == eAzureIoTSuccess ) &&
+        ( ( xResult = prvAppendString( pxWriter, azureiotcborMAJOR_BYTES, pucValue, ulValueLen, false ) ) != eAzureIoTSuccess ) )
+    {
+        /* Take the name back, the writer is left as it was */
+        pxWriter->_internal.ulBytesUsed = ulBytesUsed;
+        pxWriter->_internal.xNeedsPropertyName = true;
+    }
+
+    if( xResult != eAzureIoTSuccess )
+    {
+        AZLogError( ( "Could not append property and bytes: error=0x%08x", ( uint16_t ) xResult ) );
+    }
+
+    return xResult;
+}
+/*-----------------------------------------------------------*/
+
+int32_t AzureIoTCBORWriter_GetBytesUsed( AzureIoTCBORWriter_t * pxWriter )
+{
+    if( pxWriter == NULL )
+    {
+        AZLogError( ( "AzureIoTCBORWriter_GetBytesUsed failed: invalid argument" ) );
+        return -1;
+    }
+
+    return ( int32_t ) pxWriter->_internal.ulBytesUsed;
+}
+/*-----------------------------------------------------------*/
+
+AzureIoTResult_t AzureIoTCBORWriter_AppendString( AzureIoTCBORWriter_t * pxWriter,
+                                                  const uint8_t * pucValue,
+                                                  uint32_t ulValueLen )
+{
+    if( ( pxWriter == NULL ) || ( ( pucValue == NULL ) && ( ulValueLen > 0 ) ) )
+    {
+        AZLogError( ( "AzureIoTCBORWriter_AppendString failed: invalid argument" ) );
+        return eAzureIoTErrorInvalidArgument;
+    }
+
+    return prvAppendString( pxWriter, azureiotcborMAJOR_TEXT, pucValue, ulValueLen, false );
+}
+/*-----------------------------------------------------------*/
+
+AzureIoTResult_t AzureIoTCBORWriter_AppendBytes( AzureIoTCBORWriter_t * pxWriter,
+                                                 const uint8_t * pucValue,
+                                                 uint32_t ulValueLen )
+{
+    if( ( pxWriter == NULL ) || ( ( pucValue == NULL ) && ( ulValueLen > 0 ) ) )
+    {
+        AZLogError( ( "AzureIoTCBORWriter_AppendBytes failed: invalid argument" ) );
+        return eAzureIoTErrorInvalidArgument;
+    }
+
+    return prvAppendString( pxWriter, azureiotcborMAJOR_BYTES, pucValue, ulValueLen, false );
+}
+/*-----------------------------------------------------------*/
+
+AzureIoTResult_t AzureIoTCBORWriter_AppendPropertyName( AzureIoTCBORWriter_t * pxWriter,
+                                                        const uint8_t * pusValue,
+                                                        uint32_t ulValueLen )
+{
+    if( ( pxWriter == NULL ) || ( pusValue == NULL ) || ( ulValueLen == 0 ) )
+    {
+        AZLogError( ( "AzureIoTCBORWriter_AppendPropertyName failed: invalid argument" ) );
+        return eAzureIoTErrorInvalidArgument;
+    }
+
+    return prvAppendString( pxWriter, azureiotcborMAJOR_TEXT, pusValue, ulValueLen, true );
+}
+/*-----------------------------------------------------------*/
+
+AzureIoTResult_t AzureIoTCBORWriter_AppendBool( AzureIoTCBORWriter_t * pxWriter,
+                                                bool xValue )
+{
+    if( pxWriter == NULL )
+    {
+        AZLogError( ( "AzureIoTCBORWriter_AppendBool failed: invalid argument" ) );
+        return eAzureIoTErrorInvalidArgument;
+    }
+
+    return prvAppendSimple( pxWriter, xValue ? azureiotcborTRUE : azureiotcborFALSE );
+}
+/*-----------------------------------------------------------*/
+
+AzureIoTResult_t AzureIoTCBORWriter_AppendInt32( AzureIoTCBORWriter_t * pxWriter,
+                                                 int32_t lValue )
+{
+    if( pxWriter == NULL )
+    {
+        AZLogError( ( "AzureIoTCBORWriter_AppendInt32 failed: invalid argument" ) );
+        return eAzureIoTErrorInvalidArgument;
+    }
+
+    return prvAppendInt32( pxWriter, lValue );
+}
+/*-----------------------------------------------------------*/
+
+AzureIoTResult_t AzureIoTCBORWriter_AppendDouble( AzureIoTCBORWriter_t * pxWriter,
+                                                  double xValue )
+{
+    uint8_t ucFloat[ azureiotcborFLOAT_MAX ];
+
+    if( pxWriter == NULL )
+    {
+        AZLogError( ( "AzureIoTCBORWriter_AppendDouble failed: invalid argument" ) );
+        return eAzureIoTErrorInvalidArgument;
+    }
+
+    return prvAppendItem( pxWriter, ucFloat, prvEncodeFloat( ucFloat, xValue ), NULL, 0, false );
+}
+/*-----------------------------------------------------------*/
+
+AzureIoTResult_t AzureIoTCBORWriter_AppendNull( AzureIoTCBORWriter_t * pxWriter )
+{
+    if( pxWriter == NULL )
+    {
+        AZLogError( ( "AzureIoTCBORWriter_AppendNull failed: invalid argument" ) );
+        return eAzureIoTErrorInvalidArgument;
+    }
+
+    return prvAppendSimple( pxWriter, azureiotcborNULL );
+}
+/*-----------------------------------------------------------*/
+
+AzureIoTResult_t AzureIoTCBORWriter_AppendBeginObject( AzureIoTCBORWriter_t * pxWriter )
+{
+    if( pxWriter == NULL )
+    {
+        AZLogError( ( "AzureIoTCBORWriter_AppendBeginObject failed: invalid argument" ) );
+        return eAzureIoTErrorInvalidArgument;
+    }
+
+    return prvAppendBegin( pxWriter, true );
+}
+/*-----------------------------------------------------------*/
+
+AzureIoTResult_t AzureIoTCBORWriter_AppendBeginArray( AzureIoTCBORWriter_t * pxWriter )
+{
+    if( pxWriter == NULL )
+    {
+        AZLogError( ( "AzureIoTCBORWriter_AppendBeginArray failed: invalid argument" ) );
+        return eAzureIoTErrorInvalidArgument;
+    }
+
+    return prvAppendBegin( pxWriter, false );
+}
+/*-----------------------------------------------------------*/
+
+AzureIoTResult_t AzureIoTCBORWriter_AppendEndObject( AzureIoTCBORWriter_t * pxWriter )
+{
+    if( pxWriter == NULL )
+    {
+        AZLogError( ( "AzureIoTCBORWriter_AppendEndObject failed: invalid argument" ) );
+        return eAzureIoTErrorInvalidArgument;
+    }
+
+    return prvAppendEnd( pxWriter, true );
+}
+/*-----------------------------------------------------------*/
+
+AzureIoTResult_t AzureIoTCBORWriter_AppendEndArray( AzureIoTCBORWriter_t * pxWriter )
+{
+    if( pxWriter == NULL )
+    {
+        AZLogError( ( "AzureIoTCBORWriter_AppendEndArray failed: invalid argument" ) );
+        return eAzureIoTErrorInvalidArgument;
+    }
+
+    return prvAppendEnd( pxWriter, false );
+}
+/*-----------------------------------------------------------*/
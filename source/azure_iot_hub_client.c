@@ -453,6 +453,49 @@ static AzureIoTResult_t prvGetPropertiesRequestId( AzureIoTHubClient_t * pxAzure
 }
 /*-----------------------------------------------------------*/
 
+/**
+ * The payload of a publish sent while it is written, see AzureIoTHubClient_SendPropertiesReportedStreaming().
+ *
+ * */
+typedef struct AzureIoTHubClientPublishStream
+{
+    AzureIoTHubClient_t * pxAzureIoTHubClient;
+    uint32_t ulBytesLeft;
+} AzureIoTHubClientPublishStream_t;
+
+/**
+ * Flush callback of the second pass: sends the chunk, never more than the length announced.
+ *
+ * */
+static AzureIoTResult_t prvPublishChunk( const uint8_t * pucData,
+                                         uint32_t ulDataLength,
+                                         void * pvContext )
+{
+    AzureIoTHubClientPublishStream_t * pxStream = ( AzureIoTHubClientPublishStream_t * ) pvContext;
+    AzureIoTMQTTResult_t xMQTTResult;
+    AzureIoTResult_t xResult;
+
+    if( ulDataLength > pxStream->ulBytesLeft )
+    {
+        AZLogError( ( "Reported properties are longer than when counted" ) );
+        xResult = eAzureIoTErrorPublishFailed;
+    }
+    else if( ( xMQTTResult = AzureIoTMQTT_PublishPayload( &( pxStream->pxAzureIoTHubClient->_internal.xMQTTContext ),
+                                                          pucData, ulDataLength ) ) != eAzureIoTMQTTSuccess )
+    {
+        AZLogError( ( "Failed to send reported properties: MQTT error=0x%08x", xMQTTResult ) );
+        xResult = eAzureIoTErrorPublishFailed;
+    }
+    else
+    {
+        pxStream->ulBytesLeft -= ulDataLength;
+        xResult = eAzureIoTSuccess;
+    }
+
+    return xResult;
+}
+/*-----------------------------------------------------------*/
+
 /**
  * Do blocking wait for sub-ack of particular receive context.
  *
@@ -1366,6 +1409,94 @@ AzureIoTResult_t AzureIoTHubClient_SendPropertiesReported( AzureIoTHubClient_t *
 }
 /*-----------------------------------------------------------*/
 
+AzureIoTResult_t AzureIoTHubClient_SendPropertiesReportedStreaming( AzureIoTHubClient_t * pxAzureIoTHubClient,
+                                                                    AzureIoTHubClientPropertiesWriteCallback_t xWriteCallback,
+                                                                    void * pvContext,
+                                                                    uint8_t * pucBuffer,
+                                                                    uint32_t ulBufferSize,
+                                                                    uint32_t * pulRequestId )
+{
+    AzureIoTMQTTResult_t xMQTTResult;
+    AzureIoTResult_t xResult;
+    AzureIoTMQTTPublishInfo_t xMQTTPublishInfo = { 0 };
+    AzureIoTHubClientPublishStream_t xStream;
+    AzureIoTJSONWriter_t xWriter;
+    uint8_t ucRequestID[ azureiothubMAX_SIZE_FOR_UINT32 ];
+    size_t xTopicLength;
+    int32_t lPayloadLength;
+    az_result xCoreResult;
+    az_span xRequestID = az_span_create( ucRequestID, sizeof( ucRequestID ) );
+
+    if( ( pxAzureIoTHubClient == NULL ) || ( xWriteCallback == NULL ) ||
+        ( pucBuffer == NULL ) || ( ulBufferSize < azureiotjsonwriterSTREAMING_BUFFER_MIN_SIZE ) )
+    {
+        AZLogError( ( "AzureIoTHubClient_SendPropertiesReportedStreaming failed: invalid argument" ) );
+        xResult = eAzureIoTErrorInvalidArgument;
+    }
+    else if( pxAzureIoTHubClient->_internal.xReceiveContext[ azureiothubRECEIVE_CONTEXT_INDEX_PROPERTIES ]._internal.usState !=
+             azureiothubTOPIC_SUBSCRIBE_STATE_SUBACK )
+    {
+        AZLogError( ( "AzureIoTHubClient_SendPropertiesReportedStreaming failed: property topic not subscribed" ) );
+        xResult = eAzureIoTErrorTopicNotSubscribed;
+    }
+    else if( ( ( xResult = AzureIoTJSONWriter_InitCounting( &xWriter, pucBuffer, ulBufferSize ) ) != eAzureIoTSuccess ) ||
+             ( ( xResult = xWriteCallback( &xWriter, pvContext ) ) != eAzureIoTSuccess ) )
+    {
+        AZLogError( ( "Failed to count reported properties: error=0x%08x", ( uint16_t ) xResult ) );
+    }
+    else if( ( lPayloadLength = AzureIoTJSONWriter_GetBytesUsed( &xWriter ) ) <= 0 )
+    {
+        AZLogError( ( "AzureIoTHubClient_SendPropertiesReportedStreaming failed: no reported properties written" ) );
+        xResult = eAzureIoTErrorInvalidArgument;
+    }
+    else if( ( xResult = prvGetPropertiesRequestId( pxAzureIoTHubClient, xRequestID,
+                                                    true, pulRequestId, &xRequestID ) ) != eAzureIoTSuccess )
+    {
+        AZLogError( ( "Failed to get request id: error=0x%08x", xResult ) );
+    }
+    else if( az_result_failed(
+                 xCoreResult =
+                     az_iot_hub_client_properties_get_reported_publish_topic( &pxAzureIoTHubClient->_internal.xAzureIoTHubClientCore,
+                                                                              xRequestID,
+                                                                              ( char * ) pxAzureIoTHubClient->_internal.pucWorkingBuffer,
+                                                                              pxAzureIoTHubClient->_internal.ulWorkingBufferLength,
+                                                                              &xTopicLength ) ) )
+    {
+        AZLogError( ( "Failed to get property patch topic: core error=0x%08x", ( uint16_t ) xCoreResult ) );
+        xResult = AzureIoT_TranslateCoreError( xCoreResult );
+    }
+    else
+    {
+        xMQTTPublishInfo.xQOS = eAzureIoTMQTTQoS0;
+        xMQTTPublishInfo.pcTopicName = pxAzureIoTHubClient->_internal.pucWorkingBuffer;
+        xMQTTPublishInfo.usTopicNameLength = ( uint16_t ) xTopicLength;
+        xMQTTPublishInfo.xPayloadLength = ( size_t ) lPayloadLength;
+        xStream.pxAzureIoTHubClient = pxAzureIoTHubClient;
+        xStream.ulBytesLeft = ( uint32_t ) lPayloadLength;
+
+        if( ( xMQTTResult = AzureIoTMQTT_PublishHeader( &( pxAzureIoTHubClient->_internal.xMQTTContext ),
+                                                        &xMQTTPublishInfo ) ) != eAzureIoTMQTTSuccess )
+        {
+            AZLogError( ( "Failed to Publish properties reported message: MQTT error=0x%08x", xMQTTResult ) );
+            xResult = eAzureIoTErrorPublishFailed;
+        }
+        else if( ( ( xResult = AzureIoTJSONWriter_InitStreaming( &xWriter, pucBuffer, ulBufferSize,
+                                                                 prvPublishChunk, &xStream ) ) != eAzureIoTSuccess ) ||
+                 ( ( xResult = xWriteCallback( &xWriter, pvContext ) ) != eAzureIoTSuccess ) ||
+                 ( ( xResult = AzureIoTJSONWriter_Flush( &xWriter ) ) != eAzureIoTSuccess ) ||
+                 ( xStream.ulBytesLeft != 0 ) )
+        {
+            /* The broker takes whatever comes next on the connection as the rest of the payload. */
+            AZLogError( ( "Failed to stream properties reported message, %u bytes missing: error=0x%08x",
+                          ( unsigned int ) xStream.ulBytesLeft, ( uint16_t ) xResult ) );
+            xResult = eAzureIoTErrorHubClientFailed;
+        }
+    }
+
+    return xResult;
+}
+/*-----------------------------------------------------------*/
+
 AzureIoTResult_t AzureIoTHubClient_RequestPropertiesAsync( AzureIoTHubClient_t * pxAzureIoTHubClient )
 {
     AzureIoTMQTTResult_t xMQTTResult;
@@ -7,8 +7,18 @@
  */
 
 #include "azure_iot_hub_client_properties.h"
+
+#include <string.h>
+
 #include "azure_iot_private.h"
 
+/* The component of the properties outside of components, in an index */
+#define azureiothubclientpropertiesINDEX_ROOT    ( 0xFFU )
+
+#if azureiotconfigPROPERTIES_INDEX_MAX_ENTRIES > 255
+    #error "azureiotconfigPROPERTIES_INDEX_MAX_ENTRIES must be 255 or less, entries refer to their component by a uint8_t index"
+#endif
+
 AzureIoTResult_t AzureIoTHubClientProperties_BuilderBeginComponent( AzureIoTHubClient_t * pxAzureIoTHubClient,
                                                                     AzureIoTJSONWriter_t * pxJSONWriter,
                                                                     const uint8_t * pucComponentName,
@@ -243,3 +253,316 @@ AzureIoTResult_t AzureIoTHubClientProperties_GetNextComponentProperty( AzureIoTH
 
     return xResult;
 }
+
+/* The first character of a value, and the character after it, quotes included */
+static uint32_t prvValueStart( const az_json_token * pxToken,
+                               const uint8_t * pucJSON )
+{
+    uint32_t ulOffset = ( uint32_t ) ( az_span_ptr( pxToken->slice ) - pucJSON );
+
+    return ( pxToken->kind == AZ_JSON_TOKEN_STRING ) ? ( ulOffset - 1U ) : ulOffset;
+}
+
+static uint32_t prvValueEnd( const az_json_token * pxToken,
+                             const uint8_t * pucJSON )
+{
+    uint32_t ulOffset = ( uint32_t ) ( az_span_ptr( pxToken->slice ) - pucJSON ) + ( uint32_t ) az_span_size( pxToken->slice );
+
+    return ( pxToken->kind == AZ_JSON_TOKEN_STRING ) ? ( ulOffset + 1U ) : ulOffset;
+}
+
+static bool prvIsComponent( AzureIoTHubClient_t * pxAzureIoTHubClient,
+                            const az_json_token * pxName )
+{
+    az_iot_hub_client_options * pxOptions = &pxAzureIoTHubClient->_internal.xAzureIoTHubClientCore._internal.options;
+    int32_t lIndex;
+
+    for( lIndex = 0; lIndex < pxOptions->component_names_length; lIndex++ )
+    {
+        if( az_json_token_is_text_equal( pxName, pxOptions->component_names[ lIndex ] ) )
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+static AzureIoTHubClientPropertiesIndexEntry_t * prvAddEntry( AzureIoTHubClientPropertiesIndex_t * pxIndex,
+                                                              const az_json_token * pxName,
+                                                              uint32_t ulValueStart,
+                                                              uint8_t ucComponent,
+                                                              bool xIsComponent )
+{
+    AzureIoTHubClientPropertiesIndexEntry_t * pxEntry;
+
+    if( pxIndex->_internal.ulEntryCount == azureiotconfigPROPERTIES_INDEX_MAX_ENTRIES )
+    {
+        return NULL;
+    }
+
+    pxEntry = &pxIndex->_internal.xEntries[ pxIndex->_internal.ulEntryCount++ ];
+    pxEntry->ulNameOffset = ( uint32_t ) ( az_span_ptr( pxName->slice ) - pxIndex->_internal.pucJSON );
+    pxEntry->usNameLength = ( uint16_t ) az_span_size( pxName->slice );
+    pxEntry->ulValueOffset = ulValueStart;
+    pxEntry->ulValueLength = 0;
+    pxEntry->ucComponent = ucComponent;
+    pxEntry->xIsComponent = xIsComponent;
+
+    return pxEntry;
+}
+
+/* Records the properties, from the begin of their object to its end, with the properties of the
+ * components among them */
+static az_result prvIndexProperties( AzureIoTHubClient_t * pxAzureIoTHubClient,
+                                     AzureIoTHubClientPropertiesIndex_t * pxIndex,
+                                     az_json_reader * pxCoreReader )
+{
+    az_result xCoreResult;
+    az_json_token xName;
+    AzureIoTHubClientPropertiesIndexEntry_t * pxEntry;
+    AzureIoTHubClientPropertiesIndexEntry_t * pxComponent = NULL;
+    uint8_t ucComponent = azureiothubclientpropertiesINDEX_ROOT;
+    uint32_t ulValueStart;
+
+    while( az_result_succeeded( xCoreResult = az_json_reader_next_token( pxCoreReader ) ) )
+    {
+        if( pxCoreReader->token.kind == AZ_JSON_TOKEN_END_OBJECT )
+        {
+            if( pxComponent == NULL )
+            {
+                break;
+            }
+
+            /* End of a component, back to the properties outside of components */
+            pxComponent->ulValueLength = prvValueEnd( &pxCoreReader->token, pxIndex->_internal.pucJSON ) - pxComponent->ulValueOffset;
+            pxComponent = NULL;
+            ucComponent = azureiothubclientpropertiesINDEX_ROOT;
+        }
+        else
+        {
+            xName = pxCoreReader->token;
+
+            if( az_result_failed( xCoreResult = az_json_reader_next_token( pxCoreReader ) ) )
+            {
+                break;
+            }
+
+            ulValueStart = prvValueStart( &pxCoreReader->token, pxIndex->_internal.pucJSON );
+
+            if( ( pxComponent == NULL ) && ( pxCoreReader->token.kind == AZ_JSON_TOKEN_BEGIN_OBJECT ) &&
+                prvIsComponent( pxAzureIoTHubClient, &xName ) )
+            {
+                ucComponent = ( uint8_t ) pxIndex->_internal.ulEntryCount;
+
+                if( ( pxComponent = prvAddEntry( pxIndex, &xName, ulValueStart, azureiothubclientpropertiesINDEX_ROOT, true ) ) == NULL )
+                {
+                    return AZ_ERROR_NOT_ENOUGH_SPACE;
+                }
+            }
+            else if( az_result_failed( xCoreResult = az_json_reader_skip_children( pxCoreReader ) ) )
+            {
+                break;
+            }
+            else if( !az_json_token_is_text_equal( &xName, ( pxComponent == NULL ) ?
+                                                   AZ_SPAN_FROM_STR( "$version" ) : AZ_SPAN_FROM_STR( "__t" ) ) )
+            {
+                if( ( pxEntry = prvAddEntry( pxIndex, &xName, ulValueStart, ucComponent, false ) ) == NULL )
+                {
+                    return AZ_ERROR_NOT_ENOUGH_SPACE;
+                }
+
+                pxEntry->ulValueLength = prvValueEnd( &pxCoreReader->token, pxIndex->_internal.pucJSON ) - ulValueStart;
+            }
+        }
+    }
+
+    return xCoreResult;
+}
+
+/* The entry of a component, or the index count when the document has no such component */
+static uint32_t prvFindComponent( AzureIoTHubClientPropertiesIndex_t * pxIndex,
+                                  const uint8_t * pucComponentName,
+                                  uint32_t ulComponentNameLength )
+{
+    AzureIoTHubClientPropertiesIndexEntry_t * pxEntry;
+    uint32_t ulIndex;
+
+    for( ulIndex = 0; ulIndex < pxIndex->_internal.ulEntryCount; ulIndex++ )
+    {
+        pxEntry = &pxIndex->_internal.xEntries[ ulIndex ];
+
+        if( pxEntry->xIsComponent && ( pxEntry->usNameLength == ulComponentNameLength ) &&
+            ( memcmp( pxIndex->_internal.pucJSON + pxEntry->ulNameOffset, pucComponentName, ulComponentNameLength ) == 0 ) )
+        {
+            break;
+        }
+    }
+
+    return ulIndex;
+}
+
+AzureIoTResult_t AzureIoTHubClientProperties_BuildIndex( AzureIoTHubClient_t * pxAzureIoTHubClient,
+                                                         AzureIoTHubClientPropertiesIndex_t * pxIndex,
+                                                         const uint8_t * pucJSON,
+                                                         uint32_t ulJSONLength,
+                                                         AzureIoTHubMessageType_t xResponseType,
+                                                         AzureIoTHubClientPropertyType_t xPropertyType )
+{
+    AzureIoTResult_t xResult;
+    az_result xCoreResult;
+    az_json_reader xCoreReader;
+    az_span xSection;
+
+    if( ( pxAzureIoTHubClient == NULL ) || ( pxIndex == NULL ) ||
+        ( pucJSON == NULL ) || ( ulJSONLength == 0 ) ||
+        ( ( xResponseType != eAzureIoTHubPropertiesRequestedMessage ) &&
+          ( xResponseType != eAzureIoTHubPropertiesWritablePropertyMessage ) ) ||
+        ( ( xPropertyType == eAzureIoTHubClientReportedFromDevice ) &&
+          ( xResponseType != eAzureIoTHubPropertiesRequestedMessage ) ) )
+    {
+        AZLogError( ( "AzureIoTHubClientProperties_BuildIndex failed: invalid argument" ) );
+        xResult = eAzureIoTErrorInvalidArgument;
+    }
+    else
+    {
+        pxIndex->_internal.pucJSON = pucJSON;
+        pxIndex->_internal.ulEntryCount = 0;
+        xSection = ( xPropertyType == eAzureIoTHubClientPropertyWritable ) ?
+                   AZ_SPAN_FROM_STR( "desired" ) : AZ_SPAN_FROM_STR( "reported" );
+
+        if( az_result_succeeded( xCoreResult = az_json_reader_init( &xCoreReader, az_span_create( ( uint8_t * ) pucJSON, ( int32_t ) ulJSONLength ), NULL ) ) &&
+            az_result_succeeded( xCoreResult = az_json_reader_next_token( &xCoreReader ) ) &&
+            ( xResponseType == eAzureIoTHubPropertiesRequestedMessage ) )
+        {
+            /* A get response holds the desired and the reported properties */
+            while( az_result_succeeded( xCoreResult = az_json_reader_next_token( &xCoreReader ) ) &&
+                   ( xCoreReader.token.kind == AZ_JSON_TOKEN_PROPERTY_NAME ) &&
+                   !az_json_token_is_text_equal( &xCoreReader.token, xSection ) )
+            {
+                if( az_result_failed( xCoreResult = az_json_reader_next_token( &xCoreReader ) ) ||
+                    az_result_failed( xCoreResult = az_json_reader_skip_children( &xCoreReader ) ) )
+                {
+                    break;
+                }
+            }
+
+            if( az_result_succeeded( xCoreResult ) && ( xCoreReader.token.kind == AZ_JSON_TOKEN_PROPERTY_NAME ) )
+            {
+                xCoreResult = az_json_reader_next_token( &xCoreReader );
+            }
+        }
+
+        if( az_result_succeeded( xCoreResult ) && ( xCoreReader.token.kind == AZ_JSON_TOKEN_BEGIN_OBJECT ) )
+        {
+            xCoreResult = prvIndexProperties( pxAzureIoTHubClient, pxIndex, &xCoreReader );
+        }
+        else if( az_result_succeeded( xCoreResult ) && ( xCoreReader.token.kind != AZ_JSON_TOKEN_END_OBJECT ) )
+        {
+            /* The properties are not an object */
+            xCoreResult = AZ_ERROR_UNEXPECTED_CHAR;
+        }
+
+        if( az_result_failed( xCoreResult ) )
+        {
+            AZLogError( ( "Could not index properties: core error=0x%08x", ( uint16_t ) xCoreResult ) );
+            xResult = AzureIoT_TranslateCoreError( xCoreResult );
+        }
+        else
+        {
+            xResult = eAzureIoTSuccess;
+        }
+    }
+
+    return xResult;
+}
+
+AzureIoTResult_t AzureIoTHubClientProperties_IndexGetComponent( AzureIoTHubClientPropertiesIndex_t * pxIndex,
+                                                                const uint8_t * pucComponentName,
+                                                                uint32_t ulComponentNameLength,
+                                                                AzureIoTJSONReader_t * pxJSONReader )
+{
+    AzureIoTResult_t xResult;
+    AzureIoTHubClientPropertiesIndexEntry_t * pxEntry;
+    uint32_t ulIndex;
+
+    if( ( pxIndex == NULL ) || ( pucComponentName == NULL ) ||
+        ( ulComponentNameLength == 0 ) || ( pxJSONReader == NULL ) )
+    {
+        AZLogError( ( "AzureIoTHubClientProperties_IndexGetComponent failed: invalid argument" ) );
+        xResult = eAzureIoTErrorInvalidArgument;
+    }
+    else if( ( ulIndex = prvFindComponent( pxIndex, pucComponentName, ulComponentNameLength ) ) == pxIndex->_internal.ulEntryCount )
+    {
+        xResult = eAzureIoTErrorItemNotFound;
+    }
+    else
+    {
+        pxEntry = &pxIndex->_internal.xEntries[ ulIndex ];
+        xResult = AzureIoTJSONReader_Init( pxJSONReader, pxIndex->_internal.pucJSON + pxEntry->ulValueOffset, pxEntry->ulValueLength );
+    }
+
+    return xResult;
+}
+
+AzureIoTResult_t AzureIoTHubClientProperties_IndexGetNextProperty( AzureIoTHubClientPropertiesIndex_t * pxIndex,
+                                                                   const uint8_t * pucComponentName,
+                                                                   uint32_t ulComponentNameLength,
+                                                                   uint32_t * pulPosition,
+                                                                   const uint8_t ** ppucPropertyName,
+                                                                   uint32_t * pulPropertyNameLength,
+                                                                   AzureIoTJSONReader_t * pxJSONReader )
+{
+    AzureIoTResult_t xResult;
+    AzureIoTHubClientPropertiesIndexEntry_t * pxEntry;
+    uint32_t ulComponent = azureiothubclientpropertiesINDEX_ROOT;
+    uint32_t ulIndex;
+
+    if( ( pxIndex == NULL ) || ( ( pucComponentName == NULL ) && ( ulComponentNameLength > 0 ) ) ||
+        ( pulPosition == NULL ) || ( ppucPropertyName == NULL ) ||
+        ( pulPropertyNameLength == NULL ) || ( pxJSONReader == NULL ) )
+    {
+        AZLogError( ( "AzureIoTHubClientProperties_IndexGetNextProperty failed: invalid argument" ) );
+        xResult = eAzureIoTErrorInvalidArgument;
+    }
+    else
+    {
+        ulIndex = *pulPosition;
+
+        if( pucComponentName != NULL )
+        {
+            ulComponent = prvFindComponent( pxIndex, pucComponentName, ulComponentNameLength );
+
+            /* The properties of a component are after its entry */
+            if( ulIndex <= ulComponent )
+            {
+                ulIndex = ulComponent + 1U;
+            }
+        }
+
+        for( ; ulIndex < pxIndex->_internal.ulEntryCount; ulIndex++ )
+        {
+            pxEntry = &pxIndex->_internal.xEntries[ ulIndex ];
+
+            if( !pxEntry->xIsComponent && ( pxEntry->ucComponent == ulComponent ) )
+            {
+                break;
+            }
+        }
+
+        if( ulIndex >= pxIndex->_internal.ulEntryCount )
+        {
+            *pulPosition = pxIndex->_internal.ulEntryCount;
+            xResult = eAzureIoTErrorEndOfProperties;
+        }
+        else
+        {
+            *ppucPropertyName = pxIndex->_internal.pucJSON + pxEntry->ulNameOffset;
+            *pulPropertyNameLength = pxEntry->usNameLength;
+            *pulPosition = ulIndex + 1U;
+            xResult = AzureIoTJSONReader_Init( pxJSONReader, pxIndex->_internal.pucJSON + pxEntry->ulValueOffset, pxEntry->ulValueLength );
+        }
+    }
+
+    return xResult;
+}
@@ -0,0 +1,282 @@
+/* Copyright (c) Microsoft Corporation.
+ * Licensed under the MIT License. */
+
+/**
+ * @file azure_iot_json_binding.c
+ * @brief Implementation of the JSON to struct binding.
+ */
+
+#include "azure_iot_json_binding.h"
+
+#include <string.h>
+
+#include "azure_iot.h"
+#include "azure_iot_private.h"
+
+#include "azure/az_core.h"
+/*-----------------------------------------------------------*/
+
+static bool prvBindingsValid( const AzureIoTJSONBinding_t * pxBindings,
+                              uint32_t ulBindingCount )
+{
+    uint32_t ulIndex;
+    uint32_t ulSize;
+
+    if( ( pxBindings == NULL ) || ( ulBindingCount == 0 ) || ( ulBindingCount > azureiotjsonBINDING_MAX ) )
+    {
+        return false;
+    }
+
+    for( ulIndex = 0; ulIndex < ulBindingCount; ulIndex++ )
+    {
+        switch( pxBindings[ ulIndex ].xType )
+        {
+            case eAzureIoTJSONBindingBool:
+                ulSize = sizeof( bool );
+                break;
+
+            case eAzureIoTJSONBindingInt32:
+                ulSize = sizeof( int32_t );
+                break;
+
+            case eAzureIoTJSONBindingDouble:
+                ulSize = sizeof( double );
+                break;
+
+            case eAzureIoTJSONBindingString:
+                /* Any size with room for the NULL terminator */
+                ulSize = ( pxBindings[ ulIndex ].ulSize > 0 ) ? pxBindings[ ulIndex ].ulSize : 1;
+                break;
+
+            default:
+                return false;
+        }
+
+        if( ( pxBindings[ ulIndex ].pucName == NULL ) || ( pxBindings[ ulIndex ].ulNameLength == 0 ) ||
+            ( pxBindings[ ulIndex ].ulSize != ulSize ) )
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+/*-----------------------------------------------------------*/
+
+/* Convert the value the reader is on into pxBinding's field, if it has the type of the field and passes
+ * the validation. */
+static bool prvStoreValue( const az_json_token * pxToken,
+                           const AzureIoTJSONBinding_t * pxBinding,
+                           void * pvStruct )
+{
+    uint8_t * pucField = ( uint8_t * ) pvStruct + pxBinding->ulOffset;
+    union
+    {
+        bool xBool;
+        int32_t lInt32;
+        double xDouble;
+    } xValue;
+    int32_t lLength;
+
+    switch( pxBinding->xType )
+    {
+        case eAzureIoTJSONBindingBool:
+
+            if( ( pxToken->kind != AZ_JSON_TOKEN_TRUE ) && ( pxToken->kind != AZ_JSON_TOKEN_FALSE ) )
+            {
+                return false;
+            }
+
+            xValue.xBool = ( pxToken->kind == AZ_JSON_TOKEN_TRUE );
+            break;
+
+        case eAzureIoTJSONBindingInt32:
+
+            if( ( pxToken->kind != AZ_JSON_TOKEN_NUMBER ) ||
+                az_result_failed( az_json_token_get_int32( pxToken, &xValue.lInt32 ) ) )
+            {
+                return false;
+            }
+
+            break;
+
+        case eAzureIoTJSONBindingDouble:
+
+            if( ( pxToken->kind != AZ_JSON_TOKEN_NUMBER ) ||
+                az_result_failed( az_json_token_get_double( pxToken, &xValue.xDouble ) ) )
+            {
+                return false;
+            }
+
+            break;
+
+        default:
+
+            /* Unescaped in the field, which is left empty when the value does not fit or fails the validation */
+            if( pxToken->kind != AZ_JSON_TOKEN_STRING )
+            {
+                return false;
+            }
+
+            if( az_result_failed( az_json_token_get_string( pxToken, ( char * ) pucField,
+                                                            ( int32_t ) pxBinding->ulSize, &lLength ) ) ||
+                ( ( pxBinding->xValidate != NULL ) && !pxBinding->xValidate( pucField ) ) )
+            {
+                pucField[ 0 ] = '\0';
+                return false;
+            }
+
+            return true;
+    }
+
+    if( ( pxBinding->xValidate != NULL ) && !pxBinding->xValidate( &xValue ) )
+    {
+        return false;
+    }
+
+    memcpy( pucField, &xValue, pxBinding->ulSize );
+
+    return true;
+}
+/*-----------------------------------------------------------*/
+
+static AzureIoTResult_t prvReadProperty( az_json_reader * pxCoreReader,
+                                         const AzureIoTJSONBinding_t * pxBindings,
+                                         uint32_t ulBindingCount,
+                                         void * pvStruct,
+                                         uint32_t * pulPresent,
+                                         uint32_t * pulInvalid )
+{
+    az_result xCoreResult;
+    uint32_t ulIndex;
+    uint32_t ulBit;
+
+    if( pxCoreReader->token.kind != AZ_JSON_TOKEN_PROPERTY_NAME )
+    {
+        AZLogError( ( "AzureIoTJSONBinding_ReadProperty failed: reader not on a property name" ) );
+        return eAzureIoTErrorJSONInvalidState;
+    }
+
+    for( ulIndex = 0; ulIndex < ulBindingCount; ulIndex++ )
+    {
+        if( az_json_token_is_text_equal( &pxCoreReader->token,
+                                         az_span_create( ( uint8_t * ) pxBindings[ ulIndex ].pucName,
+                                                         ( int32_t ) pxBindings[ ulIndex ].ulNameLength ) ) )
+        {
+            break;
+        }
+    }
+
+    if( az_result_failed( xCoreResult = az_json_reader_next_token( pxCoreReader ) ) )
+    {
+        AZLogError( ( "AzureIoTJSONBinding_ReadProperty failed: error=0x%08x", ( uint16_t ) xCoreResult ) );
+        return AzureIoT_TranslateCoreError( xCoreResult );
+    }
+
+    if( ulIndex < ulBindingCount )
+    {
+        ulBit = 1U << ulIndex;
+
+        if( prvStoreValue( &pxCoreReader->token, &pxBindings[ ulIndex ], pvStruct ) )
+        {
+            *pulPresent |= ulBit;
+            *pulInvalid &= ~ulBit;
+        }
+        else
+        {
+            AZLogWarn( ( "AzureIoTJSONBinding: invalid value for %.*s",
+                         ( int16_t ) pxBindings[ ulIndex ].ulNameLength, pxBindings[ ulIndex ].pucName ) );
+            *pulPresent &= ~ulBit;
+            *pulInvalid |= ulBit;
+        }
+    }
+
+    /* Move after the value, an object or an array of the wrong type included */
+    if( az_result_failed( xCoreResult = az_json_reader_skip_children( pxCoreReader ) ) ||
+        az_result_failed( xCoreResult = az_json_reader_next_token( pxCoreReader ) ) )
+    {
+        AZLogError( ( "AzureIoTJSONBinding_ReadProperty failed: error=0x%08x", ( uint16_t ) xCoreResult ) );
+        return AzureIoT_TranslateCoreError( xCoreResult );
+    }
+
+    return ( ulIndex < ulBindingCount ) ? eAzureIoTSuccess : eAzureIoTErrorItemNotFound;
+}
+/*-----------------------------------------------------------*/
+
+AzureIoTResult_t AzureIoTJSONBinding_ReadProperty( AzureIoTJSONReader_t * pxReader,
+                                                   const AzureIoTJSONBinding_t * pxBindings,
+                                                   uint32_t ulBindingCount,
+                                                   void * pvStruct,
+                                                   uint32_t * pulPresent,
+                                                   uint32_t * pulInvalid )
+{
+    uint32_t ulInvalid = 0;
+
+    /* The bindings step the core reader, which a resumable reader does not hold the JSON text of */
+    if( ( pxReader == NULL ) || ( pxReader->_internal.pucTokenBuffer != NULL ) ||
+        !prvBindingsValid( pxBindings, ulBindingCount ) || ( pvStruct == NULL ) || ( pulPresent == NULL ) )
+    {
+        AZLogError( ( "AzureIoTJSONBinding_ReadProperty failed: invalid argument" ) );
+        return eAzureIoTErrorInvalidArgument;
+    }
+
+    return prvReadProperty( &pxReader->_internal.xCoreReader, pxBindings, ulBindingCount, pvStruct,
+                            pulPresent, ( pulInvalid != NULL ) ? pulInvalid : &ulInvalid );
+}
+/*-----------------------------------------------------------*/
+
+AzureIoTResult_t AzureIoTJSONBinding_ReadObject( AzureIoTJSONReader_t * pxReader,
+                                                 const AzureIoTJSONBinding_t * pxBindings,
+                                                 uint32_t ulBindingCount,
+                                                 void * pvStruct,
+                                                 uint32_t * pulPresent,
+                                                 uint32_t * pulInvalid )
+{
+    az_json_reader * pxCoreReader;
+    AzureIoTResult_t xResult;
+    az_result xCoreResult;
+    uint32_t ulInvalid = 0;
+
+    /* The bindings step the core reader, which a resumable reader does not hold the JSON text of */
+    if( ( pxReader == NULL ) || ( pxReader->_internal.pucTokenBuffer != NULL ) ||
+        !prvBindingsValid( pxBindings, ulBindingCount ) || ( pvStruct == NULL ) || ( pulPresent == NULL ) )
+    {
+        AZLogError( ( "AzureIoTJSONBinding_ReadObject failed: invalid argument" ) );
+        return eAzureIoTErrorInvalidArgument;
+    }
+
+    pxCoreReader = &pxReader->_internal.xCoreReader;
+
+    if( pulInvalid == NULL )
+    {
+        pulInvalid = &ulInvalid;
+    }
+
+    *pulPresent = 0;
+    *pulInvalid = 0;
+
+    if( pxCoreReader->token.kind != AZ_JSON_TOKEN_BEGIN_OBJECT )
+    {
+        AZLogError( ( "AzureIoTJSONBinding_ReadObject failed: reader not on an object" ) );
+        return eAzureIoTErrorJSONInvalidState;
+    }
+
+    if( az_result_failed( xCoreResult = az_json_reader_next_token( pxCoreReader ) ) )
+    {
+        AZLogError( ( "AzureIoTJSONBinding_ReadObject failed: error=0x%08x", ( uint16_t ) xCoreResult ) );
+        return AzureIoT_TranslateCoreError( xCoreResult );
+    }
+
+    while( pxCoreReader->token.kind == AZ_JSON_TOKEN_PROPERTY_NAME )
+    {
+        xResult = prvReadProperty( pxCoreReader, pxBindings, ulBindingCount, pvStruct, pulPresent, pulInvalid );
+
+        if( ( xResult != eAzureIoTSuccess ) && ( xResult != eAzureIoTErrorItemNotFound ) )
+        {
+            return xResult;
+        }
+    }
+
+    return eAzureIoTSuccess;
+}
+/*-----------------------------------------------------------*/
@@ -10,10 +10,511 @@
 
 #include <stdbool.h>
 #include <stdint.h>
+#include <string.h>
 
 #include "azure_iot.h"
 #include "azure_iot_private.h"
 
+#define azureiotjsonreaderRESUMABLE_MAX_DEPTH    ( 64U )
+
+/* What a resumable reader accepts next */
+#define azureiotjsonreaderEXPECT_VALUE           ( 0U )
+#define azureiotjsonreaderEXPECT_VALUE_OR_END    ( 1U )
+#define azureiotjsonreaderEXPECT_NAME            ( 2U )
+#define azureiotjsonreaderEXPECT_NAME_OR_END     ( 3U )
+#define azureiotjsonreaderEXPECT_COLON           ( 4U )
+#define azureiotjsonreaderEXPECT_COMMA_OR_END    ( 5U )
+#define azureiotjsonreaderEXPECT_DONE            ( 6U )
+
+/* Where a resumable reader is in a string, number, true, false or null token */
+#define azureiotjsonreaderSCAN_NONE              ( 0U )
+#define azureiotjsonreaderSCAN_STRING            ( 1U )
+#define azureiotjsonreaderSCAN_STRING_ESCAPE     ( 2U )
+#define azureiotjsonreaderSCAN_LITERAL           ( 3U )
+
+/* After \u, one state per hex digit read, so the 4 digits can be split across fragments */
+#define azureiotjsonreaderSCAN_STRING_UNICODE    ( 4U )
+#define azureiotjsonreaderUNICODE_DIGITS         ( 4U )
+
+static bool prvIsWhitespace( uint8_t ucChar )
+{
+    return ( ucChar == ' ' ) || ( ucChar == '\t' ) || ( ucChar == '\n' ) || ( ucChar == '\r' );
+}
+
+static bool prvIsDigit( uint8_t ucChar )
+{
+    return ( ucChar >= '0' ) && ( ucChar <= '9' );
+}
+
+/* Numbers, true, false and null are made of these, any other character ends them */
+static bool prvIsLiteralChar( uint8_t ucChar )
+{
+    return prvIsDigit( ucChar ) || ( ( ucChar >= 'a' ) && ( ucChar <= 'z' ) ) ||
+           ( ( ucChar >= 'A' ) && ( ucChar <= 'Z' ) ) ||
+           ( ucChar == '+' ) || ( ucChar == '-' ) || ( ucChar == '.' );
+}
+
+static bool prvIsHexDigit( uint8_t ucChar )
+{
+    return prvIsDigit( ucChar ) || ( ( ucChar >= 'a' ) && ( ucChar <= 'f' ) ) ||
+           ( ( ucChar >= 'A' ) && ( ucChar <= 'F' ) );
+}
+
+static bool prvIsEscapeChar( uint8_t ucChar )
+{
+    return ( ucChar == '"' ) || ( ucChar == '\\' ) || ( ucChar == '/' ) || ( ucChar == 'b' ) ||
+           ( ucChar == 'f' ) || ( ucChar == 'n' ) || ( ucChar == 'r' ) || ( ucChar == 't' ) || ( ucChar == 'u' );
+}
+
+/* -?(0|[1-9][0-9]*)(.[0-9]+)?([eE][+-]?[0-9]+)? */
+static bool prvIsNumber( const uint8_t * pucText,
+                         uint32_t ulLength )
+{
+    uint32_t ulIndex = 0;
+    uint32_t ulDigitsStart;
+
+    if( ( ulIndex < ulLength ) && ( pucText[ ulIndex ] == '-' ) )
+    {
+        ulIndex++;
+    }
+
+    if( ( ulIndex < ulLength ) && ( pucText[ ulIndex ] == '0' ) )
+    {
+        ulIndex++;
+    }
+    else
+    {
+        ulDigitsStart = ulIndex;
+
+        while( ( ulIndex < ulLength ) && prvIsDigit( pucText[ ulIndex ] ) )
+        {
+            ulIndex++;
+        }
+
+        if( ulIndex == ulDigitsStart )
+        {
+            return false;
+        }
+    }
+
+    if( ( ulIndex < ulLength ) && ( pucText[ ulIndex ] == '.' ) )
+    {
+        ulDigitsStart = ++ulIndex;
+
+        while( ( ulIndex < ulLength ) && prvIsDigit( pucText[ ulIndex ] ) )
+        {
+            ulIndex++;
+        }
+
+        if( ulIndex == ulDigitsStart )
+        {
+            return false;
+        }
+    }
+
+    if( ( ulIndex < ulLength ) && ( ( pucText[ ulIndex ] == 'e' ) || ( pucText[ ulIndex ] == 'E' ) ) )
+    {
+        ulIndex++;
+
+        if( ( ulIndex < ulLength ) && ( ( pucText[ ulIndex ] == '+' ) || ( pucText[ ulIndex ] == '-' ) ) )
+        {
+            ulIndex++;
+        }
+
+        ulDigitsStart = ulIndex;
+
+        while( ( ulIndex < ulLength ) && prvIsDigit( pucText[ ulIndex ] ) )
+        {
+            ulIndex++;
+        }
+
+        if( ulIndex == ulDigitsStart )
+        {
+            return false;
+        }
+    }
+
+    return ulIndex == ulLength;
+}
+
+static bool prvInObject( AzureIoTJSONReader_t * pxReader )
+{
+    return ( ( pxReader->_internal.ullNesting >> ( pxReader->_internal.ucDepth - 1U ) ) & 1U ) != 0U;
+}
+
+static void prvEndValue( AzureIoTJSONReader_t * pxReader )
+{
+    pxReader->_internal.ucExpect = ( pxReader->_internal.ucDepth == 0U ) ?
+                                   azureiotjsonreaderEXPECT_DONE : azureiotjsonreaderEXPECT_COMMA_OR_END;
+}
+
+/* Sets the token the way the SDK sets a token read from a single buffer, for the token functions */
+static void prvSetToken( AzureIoTJSONReader_t * pxReader,
+                         az_json_token_kind xKind,
+                         const uint8_t * pucText,
+                         uint32_t ulLength )
+{
+    az_json_token * pxToken = &pxReader->_internal.xCoreReader.token;
+
+    memset( pxToken, 0, sizeof( *pxToken ) );
+    pxToken->kind = xKind;
+    pxToken->slice = az_span_create( ( uint8_t * ) pucText, ( int32_t ) ulLength );
+    pxToken->size = ( int32_t ) ulLength;
+    pxToken->_internal.string_has_escaped_chars = pxReader->_internal.xTokenHasEscapes;
+    pxReader->_internal.xCoreReader.current_depth = ( int32_t ) pxReader->_internal.ucDepth;
+}
+
+/* Moves past whitespace, colons and commas to the first character of the next token */
+static AzureIoTResult_t prvSkipSeparators( AzureIoTJSONReader_t * pxReader )
+{
+    uint8_t ucChar;
+
+    while( pxReader->_internal.ulFragmentOffset < pxReader->_internal.ulFragmentSize )
+    {
+        ucChar = pxReader->_internal.pucFragment[ pxReader->_internal.ulFragmentOffset ];
+
+        if( prvIsWhitespace( ucChar ) )
+        {
+            /* Skipped */
+        }
+        else if( pxReader->_internal.ucExpect == azureiotjsonreaderEXPECT_COLON )
+        {
+            if( ucChar != ':' )
+            {
+                return eAzureIoTErrorUnexpectedChar;
+            }
+
+            pxReader->_internal.ucExpect = azureiotjsonreaderEXPECT_VALUE;
+        }
+        else if( ( pxReader->_internal.ucExpect == azureiotjsonreaderEXPECT_COMMA_OR_END ) && ( ucChar == ',' ) )
+        {
+            pxReader->_internal.ucExpect = prvInObject( pxReader ) ?
+                                           azureiotjsonreaderEXPECT_NAME : azureiotjsonreaderEXPECT_VALUE;
+        }
+        else if( pxReader->_internal.ucExpect == azureiotjsonreaderEXPECT_DONE )
+        {
+            return eAzureIoTErrorUnexpectedChar;
+        }
+        else
+        {
+            return eAzureIoTSuccess;
+        }
+
+        pxReader->_internal.ulFragmentOffset++;
+    }
+
+    if( pxReader->_internal.ucExpect == azureiotjsonreaderEXPECT_DONE )
+    {
+        return eAzureIoTErrorJSONReaderDone;
+    }
+    else if( pxReader->_internal.xIsLastFragment )
+    {
+        /* The JSON text ends before its root value does */
+        return eAzureIoTErrorUnexpectedChar;
+    }
+
+    return eAzureIoTErrorJSONReaderNeedMoreData;
+}
+
+/* Reads a string, number, true, false or null token to its end, copying it to the token buffer
+ * when it is split across fragments */
+static AzureIoTResult_t prvScanToken( AzureIoTJSONReader_t * pxReader )
+{
+    const uint8_t * pucFragment = pxReader->_internal.pucFragment;
+    const uint8_t * pucText;
+    uint32_t ulIndex = pxReader->_internal.ulFragmentOffset;
+    uint32_t ulLength;
+    az_json_token_kind xKind;
+    bool xComplete = false;
+    uint8_t ucChar;
+
+    while( !xComplete && ( ulIndex < pxReader->_internal.ulFragmentSize ) )
+    {
+        ucChar = pucFragment[ ulIndex ];
+
+        if( pxReader->_internal.ucScan == azureiotjsonreaderSCAN_STRING_ESCAPE )
+        {
+            if( !prvIsEscapeChar( ucChar ) )
+            {
+                return eAzureIoTErrorUnexpectedChar;
+            }
+
+            pxReader->_internal.ucScan = ( ucChar == 'u' ) ? azureiotjsonreaderSCAN_STRING_UNICODE :
+                                         azureiotjsonreaderSCAN_STRING;
+            ulIndex++;
+        }
+        else if( pxReader->_internal.ucScan >= azureiotjsonreaderSCAN_STRING_UNICODE )
+        {
+            if( !prvIsHexDigit( ucChar ) )
+            {
+                return eAzureIoTErrorUnexpectedChar;
+            }
+
+            pxReader->_internal.ucScan++;
+
+            if( pxReader->_internal.ucScan == ( azureiotjsonreaderSCAN_STRING_UNICODE + azureiotjsonreaderUNICODE_DIGITS ) )
+            {
+                pxReader->_internal.ucScan = azureiotjsonreaderSCAN_STRING;
+            }
+
+            ulIndex++;
+        }
+        else if( pxReader->_internal.ucScan == azureiotjsonreaderSCAN_STRING )
+        {
+            if( ucChar == '"' )
+            {
+                xComplete = true;
+            }
+            else if( ucChar < 0x20U )
+            {
+                return eAzureIoTErrorUnexpectedChar;
+            }
+            else
+            {
+                if( ucChar == '\\' )
+                {
+                    pxReader->_internal.ucScan = azureiotjsonreaderSCAN_STRING_ESCAPE;
+                    pxReader->_internal.xTokenHasEscapes = true;
+                }
+
+                ulIndex++;
+            }
+        }
+        else if( prvIsLiteralChar( ucChar ) )
+        {
+            ulIndex++;
+        }
+        else
+        {
+            xComplete = true;
+        }
+    }
+
+    if( !xComplete && pxReader->_internal.xIsLastFragment &&
+        ( pxReader->_internal.ucScan == azureiotjsonreaderSCAN_LITERAL ) )
+    {
+        /* The JSON text ends with this literal */
+        xComplete = true;
+    }
+
+    if( pxReader->_internal.xTokenCarried || !xComplete )
+    {
+        ulLength = ulIndex - pxReader->_internal.ulTokenStart;
+
+        if( ulLength > ( pxReader->_internal.ulTokenBufferSize - pxReader->_internal.ulTokenLength ) )
+        {
+            AZLogError( ( "JSON token split across fragments is larger than the token buffer" ) );
+            return eAzureIoTErrorOutOfMemory;
+        }
+
+        memcpy( pxReader->_internal.pucTokenBuffer + pxReader->_internal.ulTokenLength,
+                pucFragment + pxReader->_internal.ulTokenStart, ulLength );
+        pxReader->_internal.ulTokenLength += ulLength;
+        pxReader->_internal.ulTokenStart = ulIndex;
+        pxReader->_internal.xTokenCarried = true;
+    }
+
+    if( !xComplete )
+    {
+        pxReader->_internal.ulFragmentOffset = ulIndex;
+
+        return pxReader->_internal.xIsLastFragment ? eAzureIoTErrorUnexpectedChar : eAzureIoTErrorJSONReaderNeedMoreData;
+    }
+
+    if( pxReader->_internal.xTokenCarried )
+    {
+        pucText = pxReader->_internal.pucTokenBuffer;
+        ulLength = pxReader->_internal.ulTokenLength;
+    }
+    else
+    {
+        pucText = pucFragment + pxReader->_internal.ulTokenStart;
+        ulLength = ulIndex - pxReader->_internal.ulTokenStart;
+    }
+
+    if( pxReader->_internal.ucScan == azureiotjsonreaderSCAN_STRING )
+    {
+        /* Past the closing quote */
+        ulIndex++;
+
+        if( ( pxReader->_internal.ucExpect == azureiotjsonreaderEXPECT_NAME ) ||
+            ( pxReader->_internal.ucExpect == azureiotjsonreaderEXPECT_NAME_OR_END ) )
+        {
+            xKind = AZ_JSON_TOKEN_PROPERTY_NAME;
+            pxReader->_internal.ucExpect = azureiotjsonreaderEXPECT_COLON;
+        }
+        else
+        {
+            xKind = AZ_JSON_TOKEN_STRING;
+            prvEndValue( pxReader );
+        }
+    }
+    else
+    {
+        if( ( ulLength == 4U ) && ( memcmp( pucText, "true", 4U ) == 0 ) )
+        {
+            xKind = AZ_JSON_TOKEN_TRUE;
+        }
+        else if( ( ulLength == 5U ) && ( memcmp( pucText, "false", 5U ) == 0 ) )
+        {
+            xKind = AZ_JSON_TOKEN_FALSE;
+        }
+        else if( ( ulLength == 4U ) && ( memcmp( pucText, "null", 4U ) == 0 ) )
+        {
+            xKind = AZ_JSON_TOKEN_NULL;
+        }
+        else if( prvIsNumber( pucText, ulLength ) )
+        {
+            xKind = AZ_JSON_TOKEN_NUMBER;
+        }
+        else
+        {
+            return eAzureIoTErrorUnexpectedChar;
+        }
+
+        prvEndValue( pxReader );
+    }
+
+    pxReader->_internal.ulFragmentOffset = ulIndex;
+    pxReader->_internal.ucScan = azureiotjsonreaderSCAN_NONE;
+    prvSetToken( pxReader, xKind, pucText, ulLength );
+
+    return eAzureIoTSuccess;
+}
+
+static AzureIoTResult_t prvResumableNextToken( AzureIoTJSONReader_t * pxReader )
+{
+    AzureIoTResult_t xResult;
+    const uint8_t * pucChar;
+    uint8_t ucExpect;
+    bool xValueExpected;
+    bool xNameExpected;
+    bool xIsObject;
+
+    if( pxReader->_internal.ucScan == azureiotjsonreaderSCAN_NONE )
+    {
+        if( ( xResult = prvSkipSeparators( pxReader ) ) != eAzureIoTSuccess )
+        {
+            return xResult;
+        }
+
+        pucChar = &pxReader->_internal.pucFragment[ pxReader->_internal.ulFragmentOffset ];
+        ucExpect = pxReader->_internal.ucExpect;
+        xValueExpected = ( ucExpect == azureiotjsonreaderEXPECT_VALUE ) || ( ucExpect == azureiotjsonreaderEXPECT_VALUE_OR_END );
+        xNameExpected = ( ucExpect == azureiotjsonreaderEXPECT_NAME ) || ( ucExpect == azureiotjsonreaderEXPECT_NAME_OR_END );
+        pxReader->_internal.xTokenHasEscapes = false;
+
+        if( ( *pucChar == '{' ) || ( *pucChar == '[' ) )
+        {
+            xIsObject = ( *pucChar == '{' );
+
+            if( !xValueExpected )
+            {
+                return eAzureIoTErrorUnexpectedChar;
+            }
+            else if( pxReader->_internal.ucDepth == azureiotjsonreaderRESUMABLE_MAX_DEPTH )
+            {
+                return eAzureIoTErrorJSONNestingOverflow;
+            }
+
+            if( xIsObject )
+            {
+                pxReader->_internal.ullNesting |= ( 1ULL << pxReader->_internal.ucDepth );
+            }
+            else
+            {
+                pxReader->_internal.ullNesting &= ~( 1ULL << pxReader->_internal.ucDepth );
+            }
+
+            pxReader->_internal.ucDepth++;
+            pxReader->_internal.ucExpect = xIsObject ? azureiotjsonreaderEXPECT_NAME_OR_END : azureiotjsonreaderEXPECT_VALUE_OR_END;
+            pxReader->_internal.ulFragmentOffset++;
+            prvSetToken( pxReader, xIsObject ? AZ_JSON_TOKEN_BEGIN_OBJECT : AZ_JSON_TOKEN_BEGIN_ARRAY, pucChar, 1U );
+
+            return eAzureIoTSuccess;
+        }
+        else if( ( *pucChar == '}' ) || ( *pucChar == ']' ) )
+        {
+            xIsObject = ( *pucChar == '}' );
+
+            /* No trailing comma, and the end matches the begin */
+            if( ( pxReader->_internal.ucDepth == 0U ) || ( prvInObject( pxReader ) != xIsObject ) ||
+                ( ( ucExpect != azureiotjsonreaderEXPECT_COMMA_OR_END ) &&
+                  ( ucExpect != ( xIsObject ? azureiotjsonreaderEXPECT_NAME_OR_END : azureiotjsonreaderEXPECT_VALUE_OR_END ) ) ) )
+            {
+                return eAzureIoTErrorUnexpectedChar;
+            }
+
+            pxReader->_internal.ucDepth--;
+            prvEndValue( pxReader );
+            pxReader->_internal.ulFragmentOffset++;
+            prvSetToken( pxReader, xIsObject ? AZ_JSON_TOKEN_END_OBJECT : AZ_JSON_TOKEN_END_ARRAY, pucChar, 1U );
+
+            return eAzureIoTSuccess;
+        }
+        else if( *pucChar == '"' )
+        {
+            if( !xValueExpected && !xNameExpected )
+            {
+                return eAzureIoTErrorUnexpectedChar;
+            }
+
+            pxReader->_internal.ucScan = azureiotjsonreaderSCAN_STRING;
+            pxReader->_internal.ulFragmentOffset++;
+        }
+        else if( xValueExpected && prvIsLiteralChar( *pucChar ) )
+        {
+            pxReader->_internal.ucScan = azureiotjsonreaderSCAN_LITERAL;
+        }
+        else
+        {
+            return eAzureIoTErrorUnexpectedChar;
+        }
+
+        pxReader->_internal.ulTokenStart = pxReader->_internal.ulFragmentOffset;
+        pxReader->_internal.ulTokenLength = 0;
+        pxReader->_internal.xTokenCarried = false;
+    }
+
+    return prvScanToken( pxReader );
+}
+
+/* Same as the SDK skip, but it can stop at the end of a fragment and go on from there when called again */
+static AzureIoTResult_t prvResumableSkipChildren( AzureIoTJSONReader_t * pxReader )
+{
+    AzureIoTResult_t xResult = eAzureIoTSuccess;
+    az_json_token_kind xKind = pxReader->_internal.xCoreReader.token.kind;
+
+    if( !pxReader->_internal.xSkipping )
+    {
+        if( xKind == AZ_JSON_TOKEN_PROPERTY_NAME )
+        {
+            pxReader->_internal.ucSkipDepth = pxReader->_internal.ucDepth;
+            pxReader->_internal.xSkipping = true;
+        }
+        else if( ( xKind == AZ_JSON_TOKEN_BEGIN_OBJECT ) || ( xKind == AZ_JSON_TOKEN_BEGIN_ARRAY ) )
+        {
+            pxReader->_internal.ucSkipDepth = ( uint8_t ) ( pxReader->_internal.ucDepth - 1U );
+            pxReader->_internal.xSkipping = true;
+        }
+    }
+
+    while( pxReader->_internal.xSkipping && ( xResult == eAzureIoTSuccess ) )
+    {
+        if( ( pxReader->_internal.xCoreReader.token.kind != AZ_JSON_TOKEN_PROPERTY_NAME ) &&
+            ( pxReader->_internal.ucDepth <= pxReader->_internal.ucSkipDepth ) )
+        {
+            pxReader->_internal.xSkipping = false;
+        }
+        else
+        {
+            xResult = prvResumableNextToken( pxReader );
+        }
+    }
+
+    return xResult;
+}
+
 AzureIoTResult_t AzureIoTJSONReader_Init( AzureIoTJSONReader_t * pxReader,
                                           const uint8_t * pucBuffer,
                                           uint32_t ulBufferSize )
@@ -30,6 +531,7 @@ AzureIoTResult_t AzureIoTJSONReader_Init( AzureIoTJSONReader_t * pxReader,
     else
     {
         xJSONSpan = az_span_create( ( uint8_t * ) pucBuffer, ( int32_t ) ulBufferSize );
+        pxReader->_internal.pucTokenBuffer = NULL;
 
         if( az_result_failed( xCoreResult = az_json_reader_init( &pxReader->_internal.xCoreReader, xJSONSpan, NULL ) ) )
         {
@@ -46,6 +548,63 @@ AzureIoTResult_t AzureIoTJSONReader_Init( AzureIoTJSONReader_t * pxReader,
 }
 
 
+AzureIoTResult_t AzureIoTJSONReader_InitResumable( AzureIoTJSONReader_t * pxReader,
+                                                   uint8_t * pucTokenBuffer,
+                                                   uint32_t ulTokenBufferSize )
+{
+    AzureIoTResult_t xResult;
+
+    if( ( pxReader == NULL ) || ( pucTokenBuffer == NULL ) || ( ulTokenBufferSize == 0 ) )
+    {
+        AZLogError( ( "AzureIoTJSONReader_InitResumable failed: invalid argument" ) );
+        xResult = eAzureIoTErrorInvalidArgument;
+    }
+    else
+    {
+        memset( pxReader, 0, sizeof( *pxReader ) );
+        pxReader->_internal.pucTokenBuffer = pucTokenBuffer;
+        pxReader->_internal.ulTokenBufferSize = ulTokenBufferSize;
+        pxReader->_internal.ucExpect = azureiotjsonreaderEXPECT_VALUE;
+        pxReader->_internal.ucScan = azureiotjsonreaderSCAN_NONE;
+        xResult = eAzureIoTSuccess;
+    }
+
+    return xResult;
+}
+
+AzureIoTResult_t AzureIoTJSONReader_AppendFragment( AzureIoTJSONReader_t * pxReader,
+                                                    const uint8_t * pucFragment,
+                                                    uint32_t ulFragmentSize,
+                                                    bool xIsLastFragment )
+{
+    AzureIoTResult_t xResult;
+
+    if( ( pxReader == NULL ) || ( pxReader->_internal.pucTokenBuffer == NULL ) ||
+        ( ( pucFragment == NULL ) && ( ulFragmentSize > 0 ) ) )
+    {
+        AZLogError( ( "AzureIoTJSONReader_AppendFragment failed: invalid argument" ) );
+        xResult = eAzureIoTErrorInvalidArgument;
+    }
+    else if( pxReader->_internal.xIsLastFragment ||
+             ( ( pxReader->_internal.ulFragmentOffset < pxReader->_internal.ulFragmentSize ) &&
+               ( pxReader->_internal.ucExpect != azureiotjsonreaderEXPECT_DONE ) ) )
+    {
+        AZLogError( ( "AzureIoTJSONReader_AppendFragment failed: previous fragment not read" ) );
+        xResult = eAzureIoTErrorJSONInvalidState;
+    }
+    else
+    {
+        pxReader->_internal.pucFragment = pucFragment;
+        pxReader->_internal.ulFragmentSize = ulFragmentSize;
+        pxReader->_internal.ulFragmentOffset = 0;
+        pxReader->_internal.ulTokenStart = 0;
+        pxReader->_internal.xIsLastFragment = xIsLastFragment;
+        xResult = eAzureIoTSuccess;
+    }
+
+    return xResult;
+}
+
 AzureIoTResult_t AzureIoTJSONReader_NextToken( AzureIoTJSONReader_t * pxReader )
 {
     AzureIoTResult_t xResult;
@@ -56,6 +615,17 @@ AzureIoTResult_t AzureIoTJSONReader_NextToken( AzureIoTJSONReader_t * pxReader )
         AZLogError( ( "AzureIoTJSONReader_NextToken failed: invalid argument" ) );
         xResult = eAzureIoTErrorInvalidArgument;
     }
+    else if( pxReader->_internal.pucTokenBuffer != NULL )
+    {
+        /* Reading on abandons a skip stopped at the end of a fragment */
+        pxReader->_internal.xSkipping = false;
+        xResult = prvResumableNextToken( pxReader );
+
+        if( ( xResult != eAzureIoTSuccess ) && ( xResult != eAzureIoTErrorJSONReaderNeedMoreData ) )
+        {
+            AZLogError( ( "Could not get next JSON token: error=0x%08x", ( uint16_t ) xResult ) );
+        }
+    }
     else
     {
         if( az_result_failed( xCoreResult = az_json_reader_next_token( &pxReader->_internal.xCoreReader ) ) )
@@ -82,6 +652,15 @@ AzureIoTResult_t AzureIoTJSONReader_SkipChildren( AzureIoTJSONReader_t * pxReade
         AZLogError( ( "AzureIoTJSONReader_SkipChildren failed: invalid argument" ) );
         xResult = eAzureIoTErrorInvalidArgument;
     }
+    else if( pxReader->_internal.pucTokenBuffer != NULL )
+    {
+        xResult = prvResumableSkipChildren( pxReader );
+
+        if( ( xResult != eAzureIoTSuccess ) && ( xResult != eAzureIoTErrorJSONReaderNeedMoreData ) )
+        {
+            AZLogError( ( "Could not skip children in JSON: error=0x%08x", ( uint16_t ) xResult ) );
+        }
+    }
     else
     {
         if( az_result_failed( xCoreResult = az_json_reader_skip_children( &pxReader->_internal.xCoreReader ) ) )
@@ -214,6 +793,91 @@ AzureIoTResult_t AzureIoTJSONReader_GetTokenString( AzureIoTJSONReader_t * pxRea
 }
 
 
+AzureIoTResult_t AzureIoTJSONReader_GetTokenStringView( AzureIoTJSONReader_t * pxReader,
+                                                        const uint8_t ** ppucString,
+                                                        uint32_t * pulStringLength )
+{
+    AzureIoTResult_t xResult;
+    az_json_token * pxToken;
+
+    if( ( pxReader == NULL ) || ( ppucString == NULL ) || ( pulStringLength == NULL ) )
+    {
+        AZLogError( ( "AzureIoTJSONReader_GetTokenStringView failed: invalid argument" ) );
+        xResult = eAzureIoTErrorInvalidArgument;
+    }
+    else
+    {
+        pxToken = &pxReader->_internal.xCoreReader.token;
+
+        if( ( pxToken->kind != AZ_JSON_TOKEN_STRING ) && ( pxToken->kind != AZ_JSON_TOKEN_PROPERTY_NAME ) )
+        {
+            AZLogError( ( "AzureIoTJSONReader_GetTokenStringView failed: token is not a string" ) );
+            xResult = eAzureIoTErrorJSONInvalidState;
+        }
+        else if( pxToken->_internal.string_has_escaped_chars )
+        {
+            /* Not an error, the caller falls back on a copy or on unescaping in place */
+            xResult = eAzureIoTErrorFailed;
+        }
+        else
+        {
+            *ppucString = az_span_ptr( pxToken->slice );
+            *pulStringLength = ( uint32_t ) az_span_size( pxToken->slice );
+            xResult = eAzureIoTSuccess;
+        }
+    }
+
+    return xResult;
+}
+
+
+AzureIoTResult_t AzureIoTJSONReader_GetTokenStringInPlace( AzureIoTJSONReader_t * pxReader,
+                                                           uint8_t ** ppucString,
+                                                           uint32_t * pulStringLength )
+{
+    AzureIoTResult_t xResult;
+    az_json_token * pxToken;
+
+    if( ( pxReader == NULL ) || ( ppucString == NULL ) || ( pulStringLength == NULL ) )
+    {
+        AZLogError( ( "AzureIoTJSONReader_GetTokenStringInPlace failed: invalid argument" ) );
+        xResult = eAzureIoTErrorInvalidArgument;
+    }
+    else
+    {
+        pxToken = &pxReader->_internal.xCoreReader.token;
+
+        if( ( pxToken->kind != AZ_JSON_TOKEN_STRING ) && ( pxToken->kind != AZ_JSON_TOKEN_PROPERTY_NAME ) )
+        {
+            AZLogError( ( "AzureIoTJSONReader_GetTokenStringInPlace failed: token is not a string" ) );
+            xResult = eAzureIoTErrorJSONInvalidState;
+        }
+        else if( ( pxReader->_internal.pucTokenBuffer != NULL ) && !pxReader->_internal.xTokenCarried )
+        {
+            /* The token is read in place in a fragment, which the reader must not write */
+            AZLogError( ( "AzureIoTJSONReader_GetTokenStringInPlace failed: token in a read-only fragment" ) );
+            xResult = eAzureIoTErrorJSONInvalidState;
+        }
+        else
+        {
+            /* The unescaped string is never longer, it is written over the escaped one. The token is
+             * updated so the other functions read it unescaped. */
+            if( pxToken->_internal.string_has_escaped_chars )
+            {
+                pxToken->slice = az_json_string_unescape( pxToken->slice, pxToken->slice );
+                pxToken->size = az_span_size( pxToken->slice );
+                pxToken->_internal.string_has_escaped_chars = false;
+            }
+
+            *ppucString = az_span_ptr( pxToken->slice );
+            *pulStringLength = ( uint32_t ) az_span_size( pxToken->slice );
+            xResult = eAzureIoTSuccess;
+        }
+    }
+
+    return xResult;
+}
+
 bool AzureIoTJSONReader_TokenIsTextEqual( AzureIoTJSONReader_t * pxReader,
                                           const uint8_t * pucExpectedText,
                                           uint32_t ulExpectedTextLength )
@@ -0,0 +1,420 @@
+/* Copyright (c) Microsoft Corporation.
+ * Licensed under the MIT License. */
+
+/**
+ * @file azure_iot_json_template.c
+ * @brief Implementation of the pre-rendered JSON object.
+ */
+
+#include "azure_iot_json_template.h"
+
+#include <string.h>
+
+#include "azure_iot.h"
+#include "azure_iot_json_writer.h"
+
+#include "azure/az_core.h"
+/*-----------------------------------------------------------*/
+
+#define azureiotjsontemplateTYPE_INT32     ( 1U )
+#define azureiotjsontemplateTYPE_DOUBLE    ( 2U )
+#define azureiotjsontemplateTYPE_BOOL      ( 3U )
+#define azureiotjsontemplateTYPE_STRING    ( 4U )
+
+/* Longest number formatted in place, longer ones are left to the JSON writer. */
+#define azureiotjsontemplateNUMBER_MAX     ( 32U )
+/*-----------------------------------------------------------*/
+
+static AzureIoTResult_t prvAddProperty( AzureIoTJSONTemplate_t * pxTemplate,
+                                        const uint8_t * pucPropertyName,
+                                        uint32_t ulPropertyNameLength,
+                                        uint8_t ucType,
+                                        uint16_t usFractionalDigits,
+                                        uint32_t * pulSlot )
+{
+    AzureIoTJSONTemplateSlot_t * pxSlot;
+
+    if( ( pxTemplate == NULL ) || ( pucPropertyName == NULL ) ||
+        ( ulPropertyNameLength == 0 ) || ( pulSlot == NULL ) )
+    {
+        AZLogError( ( "AzureIoTJSONTemplate_Add*Property failed: invalid argument" ) );
+        return eAzureIoTErrorInvalidArgument;
+    }
+
+    if( pxTemplate->_internal.ulSlotCount == pxTemplate->_internal.ulSlotMax )
+    {
+        AZLogError( ( "AzureIoTJSONTemplate_Add*Property failed: no slot left" ) );
+        return eAzureIoTErrorOutOfMemory;
+    }
+
+    pxSlot = &pxTemplate->_internal.pxSlots[ pxTemplate->_internal.ulSlotCount ];
+    memset( pxSlot, 0, sizeof( *pxSlot ) );
+    pxSlot->_internal.pucName = pucPropertyName;
+    pxSlot->_internal.ulNameLength = ulPropertyNameLength;
+    pxSlot->_internal.ucType = ucType;
+    pxSlot->_internal.usFractionalDigits = usFractionalDigits;
+
+    *pulSlot = pxTemplate->_internal.ulSlotCount++;
+
+    /* The rendered text has no room for the new property */
+    pxTemplate->_internal.ulLength = 0;
+
+    return eAzureIoTSuccess;
+}
+/*-----------------------------------------------------------*/
+
+static AzureIoTResult_t prvAppendValue( AzureIoTJSONWriter_t * pxWriter,
+                                        const AzureIoTJSONTemplateSlot_t * pxSlot )
+{
+    switch( pxSlot->_internal.ucType )
+    {
+        case azureiotjsontemplateTYPE_INT32:
+            return AzureIoTJSONWriter_AppendInt32( pxWriter, pxSlot->_internal.xValue.lValue );
+
+        case azureiotjsontemplateTYPE_DOUBLE:
+            return AzureIoTJSONWriter_AppendDouble( pxWriter, pxSlot->_internal.xValue.xValue,
+                                                    pxSlot->_internal.usFractionalDigits );
+
+        case azureiotjsontemplateTYPE_BOOL:
+            return AzureIoTJSONWriter_AppendBool( pxWriter, pxSlot->_internal.xValue.xBool );
+
+        default:
+
+            /* The writer only appends strings that are not empty */
+            if( pxSlot->_internal.xValue.xString.ulValueLength == 0 )
+            {
+                return AzureIoTJSONWriter_AppendJSONText( pxWriter, ( const uint8_t * ) "\"\"", 2 );
+            }
+
+            return AzureIoTJSONWriter_AppendString( pxWriter, pxSlot->_internal.xValue.xString.pucValue,
+                                                    pxSlot->_internal.xValue.xString.ulValueLength );
+    }
+}
+/*-----------------------------------------------------------*/
+
+/* Write the whole object with the JSON writer, recording where each value lands. */
+static AzureIoTResult_t prvRender( AzureIoTJSONTemplate_t * pxTemplate )
+{
+    AzureIoTJSONWriter_t xWriter;
+    AzureIoTJSONTemplateSlot_t * pxSlot;
+    AzureIoTResult_t xResult;
+    uint32_t ulIndex;
+
+    pxTemplate->_internal.ulLength = 0;
+
+    if( ( ( xResult = AzureIoTJSONWriter_Init( &xWriter, pxTemplate->_internal.pucBuffer,
+                                               pxTemplate->_internal.ulBufferSize ) ) != eAzureIoTSuccess ) ||
+        ( ( xResult = AzureIoTJSONWriter_AppendBeginObject( &xWriter ) ) != eAzureIoTSuccess ) )
+    {
+        return xResult;
+    }
+
+    for( ulIndex = 0; ulIndex < pxTemplate->_internal.ulSlotCount; ulIndex++ )
+    {
+        pxSlot = &pxTemplate->_internal.pxSlots[ ulIndex ];
+
+        if( ( xResult = AzureIoTJSONWriter_AppendPropertyName( &xWriter, pxSlot->_internal.pucName,
+                                                               pxSlot->_internal.ulNameLength ) ) != eAzureIoTSuccess )
+        {
+            return xResult;
+        }
+
+        pxSlot->_internal.ulOffset = ( uint32_t ) AzureIoTJSONWriter_GetBytesUsed( &xWriter );
+
+        if( ( xResult = prvAppendValue( &xWriter, pxSlot ) ) != eAzureIoTSuccess )
+        {
+            return xResult;
+        }
+
+        pxSlot->_internal.ulLength = ( uint32_t ) AzureIoTJSONWriter_GetBytesUsed( &xWriter ) - pxSlot->_internal.ulOffset;
+    }
+
+    if( ( xResult = AzureIoTJSONWriter_AppendEndObject( &xWriter ) ) != eAzureIoTSuccess )
+    {
+        return xResult;
+    }
+
+    pxTemplate->_internal.ulLength = ( uint32_t ) AzureIoTJSONWriter_GetBytesUsed( &xWriter );
+
+    return eAzureIoTSuccess;
+}
+/*-----------------------------------------------------------*/
+
+static AzureIoTJSONTemplateSlot_t * prvGetSlot( AzureIoTJSONTemplate_t * pxTemplate,
+                                                uint32_t ulSlot,
+                                                uint8_t ucType )
+{
+    if( ( pxTemplate == NULL ) ||
+        ( ulSlot >= pxTemplate->_internal.ulSlotCount ) ||
+        ( pxTemplate->_internal.pxSlots[ ulSlot ]._internal.ucType != ucType ) )
+    {
+        return NULL;
+    }
+
+    return &pxTemplate->_internal.pxSlots[ ulSlot ];
+}
+/*-----------------------------------------------------------*/
+
+/* Put the new value of pxSlot, formatted in pucText, over the old one when they have the same length.
+ * Otherwise, or when the text is not known, leave the object to be rendered again by GetPayload. */
+static void prvUpdate( AzureIoTJSONTemplate_t * pxTemplate,
+                       const AzureIoTJSONTemplateSlot_t * pxSlot,
+                       const uint8_t * pucText,
+                       uint32_t ulTextLength )
+{
+    if( ( pucText != NULL ) && ( ulTextLength == pxSlot->_internal.ulLength ) )
+    {
+        memcpy( pxTemplate->_internal.pucBuffer + pxSlot->_internal.ulOffset, pucText, ulTextLength );
+    }
+    else
+    {
+        pxTemplate->_internal.ulLength = 0;
+    }
+}
+/*-----------------------------------------------------------*/
+
+AzureIoTResult_t AzureIoTJSONTemplate_Init( AzureIoTJSONTemplate_t * pxTemplate,
+                                            AzureIoTJSONTemplateSlot_t * pxSlots,
+                                            uint32_t ulSlotMax,
+                                            uint8_t * pucBuffer,
+                                            uint32_t ulBufferSize )
+{
+    if( ( pxTemplate == NULL ) || ( ( pxSlots == NULL ) && ( ulSlotMax > 0 ) ) ||
+        ( pucBuffer == NULL ) || ( ulBufferSize == 0 ) )
+    {
+        AZLogError( ( "AzureIoTJSONTemplate_Init failed: invalid argument" ) );
+        return eAzureIoTErrorInvalidArgument;
+    }
+
+    memset( pxTemplate, 0, sizeof( *pxTemplate ) );
+    pxTemplate->_internal.pxSlots = pxSlots;
+    pxTemplate->_internal.ulSlotMax = ulSlotMax;
+    pxTemplate->_internal.pucBuffer = pucBuffer;
+    pxTemplate->_internal.ulBufferSize = ulBufferSize;
+
+    return eAzureIoTSuccess;
+}
+/*-----------------------------------------------------------*/
+
+AzureIoTResult_t AzureIoTJSONTemplate_AddInt32Property( AzureIoTJSONTemplate_t * pxTemplate,
+                                                        const uint8_t * pucPropertyName,
+                                                        uint32_t ulPropertyNameLength,
+                                                        uint32_t * pulSlot )
+{
+    return prvAddProperty( pxTemplate, pucPropertyName, ulPropertyNameLength,
+                           azureiotjsontemplateTYPE_INT32, 0, pulSlot );
+}
+/*-----------------------------------------------------------*/
+
+AzureIoTResult_t AzureIoTJSONTemplate_AddDoubleProperty( AzureIoTJSONTemplate_t * pxTemplate,
+                                                         const uint8_t * pucPropertyName,
+                                                         uint32_t ulPropertyNameLength,
+                                                         uint16_t usFractionalDigits,
+                                                         uint32_t * pulSlot )
+{
+    return prvAddProperty( pxTemplate, pucPropertyName, ulPropertyNameLength,
+                           azureiotjsontemplateTYPE_DOUBLE, usFractionalDigits, pulSlot );
+}
+/*-----------------------------------------------------------*/
+
+AzureIoTResult_t AzureIoTJSONTemplate_AddBoolProperty( AzureIoTJSONTemplate_t * pxTemplate,
+                                                       const uint8_t * pucPropertyName,
+                                                       uint32_t ulPropertyNameLength,
+                                                       uint32_t * pulSlot )
+{
+    return prvAddProperty( pxTemplate, pucPropertyName, ulPropertyNameLength,
+                           azureiotjsontemplateTYPE_BOOL, 0, pulSlot );
+}
+/*-----------------------------------------------------------*/
+
+AzureIoTResult_t AzureIoTJSONTemplate_AddStringProperty( AzureIoTJSONTemplate_t * pxTemplate,
+                                                         const uint8_t * pucPropertyName,
+                                                         uint32_t ulPropertyNameLength,
+                                                         uint32_t * pulSlot )
+{
+    return prvAddProperty( pxTemplate, pucPropertyName, ulPropertyNameLength,
+                           azureiotjsontemplateTYPE_STRING, 0, pulSlot );
+}
+/*-----------------------------------------------------------*/
+
+AzureIoTResult_t AzureIoTJSONTemplate_Render( AzureIoTJSONTemplate_t * pxTemplate )
+{
+    AzureIoTResult_t xResult;
+
+    if( pxTemplate == NULL )
+    {
+        AZLogError( ( "AzureIoTJSONTemplate_Render failed: invalid argument" ) );
+        return eAzureIoTErrorInvalidArgument;
+    }
+
+    if( ( xResult = prvRender( pxTemplate ) ) != eAzureIoTSuccess )
+    {
+        AZLogError( ( "AzureIoTJSONTemplate_Render failed: error=0x%08x", ( uint16_t ) xResult ) );
+    }
+
+    return xResult;
+}
+/*-----------------------------------------------------------*/
+
+AzureIoTResult_t AzureIoTJSONTemplate_SetInt32( AzureIoTJSONTemplate_t * pxTemplate,
+                                                uint32_t ulSlot,
+                                                int32_t lValue )
+{
+    AzureIoTJSONTemplateSlot_t * pxSlot = prvGetSlot( pxTemplate, ulSlot, azureiotjsontemplateTYPE_INT32 );
+    uint8_t ucText[ azureiotjsontemplateNUMBER_MAX ];
+    az_span xRemainder;
+
+    if( pxSlot == NULL )
+    {
+        AZLogError( ( "AzureIoTJSONTemplate_SetInt32 failed: invalid argument" ) );
+        return eAzureIoTErrorInvalidArgument;
+    }
+
+    pxSlot->_internal.xValue.lValue = lValue;
+
+    /* Nothing to format when the object is rendered again anyway */
+    if( pxTemplate->_internal.ulLength != 0 )
+    {
+        if( az_result_failed( az_span_i32toa( AZ_SPAN_FROM_BUFFER( ucText ), lValue, &xRemainder ) ) )
+        {
+            prvUpdate( pxTemplate, pxSlot, NULL, 0 );
+        }
+        else
+        {
+            prvUpdate( pxTemplate, pxSlot, ucText, sizeof( ucText ) - ( uint32_t ) az_span_size( xRemainder ) );
+        }
+    }
+
+    return eAzureIoTSuccess;
+}
+/*-----------------------------------------------------------*/
+
+AzureIoTResult_t AzureIoTJSONTemplate_SetDouble( AzureIoTJSONTemplate_t * pxTemplate,
+                                                 uint32_t ulSlot,
+                                                 double xValue )
+{
+    AzureIoTJSONTemplateSlot_t * pxSlot = prvGetSlot( pxTemplate, ulSlot, azureiotjsontemplateTYPE_DOUBLE );
+    uint8_t ucText[ azureiotjsontemplateNUMBER_MAX ];
+    az_span xRemainder;
+
+    if( pxSlot == NULL )
+    {
+        AZLogError( ( "AzureIoTJSONTemplate_SetDouble failed: invalid argument" ) );
+        return eAzureIoTErrorInvalidArgument;
+    }
+
+    pxSlot->_internal.xValue.xValue = xValue;
+
+    if( pxTemplate->_internal.ulLength != 0 )
+    {
+        /* The same formatting as the JSON writer, a value too long for ucText is left to it */
+        if( az_result_failed( az_span_dtoa( AZ_SPAN_FROM_BUFFER( ucText ), xValue,
+                                            ( int32_t ) pxSlot->_internal.usFractionalDigits, &xRemainder ) ) )
+        {
+            prvUpdate( pxTemplate, pxSlot, NULL, 0 );
+        }
+        else
+        {
+            prvUpdate( pxTemplate, pxSlot, ucText, sizeof( ucText ) - ( uint32_t ) az_span_size( xRemainder ) );
+        }
+    }
+
+    return eAzureIoTSuccess;
+}
+/*-----------------------------------------------------------*/
+
+AzureIoTResult_t AzureIoTJSONTemplate_SetBool( AzureIoTJSONTemplate_t * pxTemplate,
+                                               uint32_t ulSlot,
+                                               bool xValue )
+{
+    AzureIoTJSONTemplateSlot_t * pxSlot = prvGetSlot( pxTemplate, ulSlot, azureiotjsontemplateTYPE_BOOL );
+
+    if( pxSlot == NULL )
+    {
+        AZLogError( ( "AzureIoTJSONTemplate_SetBool failed: invalid argument" ) );
+        return eAzureIoTErrorInvalidArgument;
+    }
+
+    pxSlot->_internal.xValue.xBool = xValue;
+
+    if( pxTemplate->_internal.ulLength != 0 )
+    {
+        if( xValue )
+        {
+            prvUpdate( pxTemplate, pxSlot, ( const uint8_t * ) "true", sizeof( "true" ) - 1 );
+        }
+        else
+        {
+            prvUpdate( pxTemplate, pxSlot, ( const uint8_t * ) "false", sizeof( "false" ) - 1 );
+        }
+    }
+
+    return eAzureIoTSuccess;
+}
+/*-----------------------------------------------------------*/
+
+AzureIoTResult_t AzureIoTJSONTemplate_SetString( AzureIoTJSONTemplate_t * pxTemplate,
+                                                 uint32_t ulSlot,
+                                                 const uint8_t * pucValue,
+                                                 uint32_t ulValueLength )
+{
+    AzureIoTJSONTemplateSlot_t * pxSlot = prvGetSlot( pxTemplate, ulSlot, azureiotjsontemplateTYPE_STRING );
+    uint32_t ulIndex;
+
+    if( ( pxSlot == NULL ) || ( ( pucValue == NULL ) && ( ulValueLength > 0 ) ) )
+    {
+        AZLogError( ( "AzureIoTJSONTemplate_SetString failed: invalid argument" ) );
+        return eAzureIoTErrorInvalidArgument;
+    }
+
+    pxSlot->_internal.xValue.xString.pucValue = pucValue;
+    pxSlot->_internal.xValue.xString.ulValueLength = ulValueLength;
+
+    /* The slot includes the quotes, only values without characters to escape are copied in place */
+    if( ( pxTemplate->_internal.ulLength == 0 ) || ( ( ulValueLength + 2 ) != pxSlot->_internal.ulLength ) )
+    {
+        pxTemplate->_internal.ulLength = 0;
+        return eAzureIoTSuccess;
+    }
+
+    for( ulIndex = 0; ulIndex < ulValueLength; ulIndex++ )
+    {
+        if( ( pucValue[ ulIndex ] < 0x20U ) || ( pucValue[ ulIndex ] == '"' ) || ( pucValue[ ulIndex ] == '\\' ) )
+        {
+            pxTemplate->_internal.ulLength = 0;
+            return eAzureIoTSuccess;
+        }
+    }
+
+    memcpy( pxTemplate->_internal.pucBuffer + pxSlot->_internal.ulOffset + 1, pucValue, ulValueLength );
+
+    return eAzureIoTSuccess;
+}
+/*-----------------------------------------------------------*/
+
+AzureIoTResult_t AzureIoTJSONTemplate_GetPayload( AzureIoTJSONTemplate_t * pxTemplate,
+                                                  const uint8_t ** ppucPayload,
+                                                  uint32_t * pulPayloadLength )
+{
+    AzureIoTResult_t xResult;
+
+    if( ( pxTemplate == NULL ) || ( ppucPayload == NULL ) || ( pulPayloadLength == NULL ) )
+    {
+        AZLogError( ( "AzureIoTJSONTemplate_GetPayload failed: invalid argument" ) );
+        return eAzureIoTErrorInvalidArgument;
+    }
+
+    /* A value changed length since the last rendering */
+    if( ( pxTemplate->_internal.ulLength == 0 ) &&
+        ( ( xResult = prvRender( pxTemplate ) ) != eAzureIoTSuccess ) )
+    {
+        AZLogError( ( "AzureIoTJSONTemplate_GetPayload failed: error=0x%08x", ( uint16_t ) xResult ) );
+        return xResult;
+    }
+
+    *ppucPayload = pxTemplate->_internal.pucBuffer;
+    *pulPayloadLength = pxTemplate->_internal.ulLength;
+
+    return eAzureIoTSuccess;
+}
+/*-----------------------------------------------------------*/
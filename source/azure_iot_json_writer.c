@@ -10,10 +10,541 @@
 
 #include <stdbool.h>
 #include <stdint.h>
+#include <string.h>
 
 #include "azure_iot.h"
 #include "azure_iot_private.h"
 
+#define azureiotjsonwriterNUMBER_MAX                ( 32 )
+#define azureiotjsonwriterFIXED_POINT_SCALE_MAX     ( 15U )
+
+/* Shortest double formatting, after Grisu2 from F. Loitsch, "Printing Floating-Point Numbers
+ * Quickly and Accurately with Integers": only 64-bit integer operations, and the digits written
+ * always read back to the same double. */
+#define azureiotjsonwriterGRISU_ALPHA               ( -60 )
+#define azureiotjsonwriterGRISU_CACHED_POWER_MIN    ( -300 )
+#define azureiotjsonwriterGRISU_CACHED_POWER_STEP   ( 8 )
+
+/* Positions of the decimal point from the first digit written without an exponent, from 1e-4 up to 1e15 */
+#define azureiotjsonwriterDECIMAL_POINT_MIN         ( -4 )
+#define azureiotjsonwriterDECIMAL_POINT_MAX         ( 15 )
+
+/* ullF * 2^lE */
+typedef struct AzureIoTJSONWriterDiyFp
+{
+    uint64_t ullF;
+    int32_t lE;
+} AzureIoTJSONWriterDiyFp_t;
+
+/* 10^lK rounded to 64 bits, as ullF * 2^lE */
+typedef struct AzureIoTJSONWriterCachedPower
+{
+    uint64_t ullF;
+    int32_t lE;
+    int32_t lK;
+} AzureIoTJSONWriterCachedPower_t;
+
+static const AzureIoTJSONWriterCachedPower_t xCachedPowers[] =
+{
+    { 0xAB70FE17C79AC6CAULL, -1060, -300 },
+    { 0xFF77B1FCBEBCDC4FULL, -1034, -292 },
+    { 0xBE5691EF416BD60CULL, -1007, -284 },
+    { 0x8DD01FAD907FFC3CULL, -980, -276 },
+    { 0xD3515C2831559A83ULL, -954, -268 },
+    { 0x9D71AC8FADA6C9B5ULL, -927, -260 },
+    { 0xEA9C227723EE8BCBULL, -901, -252 },
+    { 0xAECC49914078536DULL, -874, -244 },
+    { 0x823C12795DB6CE57ULL, -847, -236 },
+    { 0xC21094364DFB5637ULL, -821, -228 },
+    { 0x9096EA6F3848984FULL, -794, -220 },
+    { 0xD77485CB25823AC7ULL, -768, -212 },
+    { 0xA086CFCD97BF97F4ULL, -741, -204 },
+    { 0xEF340A98172AACE5ULL, -715, -196 },
+    { 0xB23867FB2A35B28EULL, -688, -188 },
+    { 0x84C8D4DFD2C63F3BULL, -661, -180 },
+    { 0xC5DD44271AD3CDBAULL, -635, -172 },
+    { 0x936B9FCEBB25C996ULL, -608, -164 },
+    { 0xDBAC6C247D62A584ULL, -582, -156 },
+    { 0xA3AB66580D5FDAF6ULL, -555, -148 },
+    { 0xF3E2F893DEC3F126ULL, -529, -140 },
+    { 0xB5B5ADA8AAFF80B8ULL, -502, -132 },
+    { 0x87625F056C7C4A8BULL, -475, -124 },
+    { 0xC9BCFF6034C13053ULL, -449, -116 },
+    { 0x964E858C91BA2655ULL, -422, -108 },
+    { 0xDFF9772470297EBDULL, -396, -100 },
+    { 0xA6DFBD9FB8E5B88FULL, -369, -92 },
+    { 0xF8A95FCF88747D94ULL, -343, -84 },
+    { 0xB94470938FA89BCFULL, -316, -76 },
+    { 0x8A08F0F8BF0F156BULL, -289, -68 },
+    { 0xCDB02555653131B6ULL, -263, -60 },
+    { 0x993FE2C6D07B7FACULL, -236, -52 },
+    { 0xE45C10C42A2B3B06ULL, -210, -44 },
+    { 0xAA242499697392D3ULL, -183, -36 },
+    { 0xFD87B5F28300CA0EULL, -157, -28 },
+    { 0xBCE5086492111AEBULL, -130, -20 },
+    { 0x8CBCCC096F5088CCULL, -103, -12 },
+    { 0xD1B71758E219652CULL, -77, -4 },
+    { 0x9C40000000000000ULL, -50, 4 },
+    { 0xE8D4A51000000000ULL, -24, 12 },
+    { 0xAD78EBC5AC620000ULL, 3, 20 },
+    { 0x813F3978F8940984ULL, 30, 28 },
+    { 0xC097CE7BC90715B3ULL, 56, 36 },
+    { 0x8F7E32CE7BEA5C70ULL, 83, 44 },
+    { 0xD5D238A4ABE98068ULL, 109, 52 },
+    { 0x9F4F2726179A2245ULL, 136, 60 },
+    { 0xED63A231D4C4FB27ULL, 162, 68 },
+    { 0xB0DE65388CC8ADA8ULL, 189, 76 },
+    { 0x83C7088E1AAB65DBULL, 216, 84 },
+    { 0xC45D1DF942711D9AULL, 242, 92 },
+    { 0x924D692CA61BE758ULL, 269, 100 },
+    { 0xDA01EE641A708DEAULL, 295, 108 },
+    { 0xA26DA3999AEF774AULL, 322, 116 },
+    { 0xF209787BB47D6B85ULL, 348, 124 },
+    { 0xB454E4A179DD1877ULL, 375, 132 },
+    { 0x865B86925B9BC5C2ULL, 402, 140 },
+    { 0xC83553C5C8965D3DULL, 428, 148 },
+    { 0x952AB45CFA97A0B3ULL, 455, 156 },
+    { 0xDE469FBD99A05FE3ULL, 481, 164 },
+    { 0xA59BC234DB398C25ULL, 508, 172 },
+    { 0xF6C69A72A3989F5CULL, 534, 180 },
+    { 0xB7DCBF5354E9BECEULL, 561, 188 },
+    { 0x88FCF317F22241E2ULL, 588, 196 },
+    { 0xCC20CE9BD35C78A5ULL, 614, 204 },
+    { 0x98165AF37B2153DFULL, 641, 212 },
+    { 0xE2A0B5DC971F303AULL, 667, 220 },
+    { 0xA8D9D1535CE3B396ULL, 694, 228 },
+    { 0xFB9B7CD9A4A7443CULL, 720, 236 },
+    { 0xBB764C4CA7A44410ULL, 747, 244 },
+    { 0x8BAB8EEFB6409C1AULL, 774, 252 },
+    { 0xD01FEF10A657842CULL, 800, 260 },
+    { 0x9B10A4E5E9913129ULL, 827, 268 },
+    { 0xE7109BFBA19C0C9DULL, 853, 276 },
+    { 0xAC2820D9623BF429ULL, 880, 284 },
+    { 0x80444B5E7AA7CF85ULL, 907, 292 },
+    { 0xBF21E44003ACDD2DULL, 933, 300 },
+    { 0x8E679C2F5E44FF8FULL, 960, 308 },
+    { 0xD433179D9C8CB841ULL, 986, 316 },
+    { 0x9E19DB92B4E31BA9ULL, 1013, 324 }
+};
+
+static AzureIoTJSONWriterDiyFp_t prvDiyFpSub( AzureIoTJSONWriterDiyFp_t xX,
+                                              AzureIoTJSONWriterDiyFp_t xY )
+{
+    AzureIoTJSONWriterDiyFp_t xResult = { xX.ullF - xY.ullF, xX.lE };
+
+    return xResult;
+}
+
+/* The upper 64 bits of the 128-bit product, rounded */
+static AzureIoTJSONWriterDiyFp_t prvDiyFpMul( AzureIoTJSONWriterDiyFp_t xX,
+                                              AzureIoTJSONWriterDiyFp_t xY )
+{
+    AzureIoTJSONWriterDiyFp_t xResult;
+    uint64_t ullXLow = xX.ullF & 0xFFFFFFFFULL;
+    uint64_t ullXHigh = xX.ullF >> 32;
+    uint64_t ullYLow = xY.ullF & 0xFFFFFFFFULL;
+    uint64_t ullYHigh = xY.ullF >> 32;
+    uint64_t ullLowLow = ullXLow * ullYLow;
+    uint64_t ullLowHigh = ullXLow * ullYHigh;
+    uint64_t ullHighLow = ullXHigh * ullYLow;
+    uint64_t ullMiddle = ( ullLowLow >> 32 ) + ( ullLowHigh & 0xFFFFFFFFULL ) +
+                         ( ullHighLow & 0xFFFFFFFFULL ) + ( 1ULL << 31 );
+
+    xResult.ullF = ( xX.ullF >> 32 ) * ullYHigh + ( ullLowHigh >> 32 ) + ( ullHighLow >> 32 ) + ( ullMiddle >> 32 );
+    xResult.lE = xX.lE + xY.lE + 64;
+
+    return xResult;
+}
+
+static AzureIoTJSONWriterDiyFp_t prvDiyFpNormalize( AzureIoTJSONWriterDiyFp_t xX )
+{
+    while( ( xX.ullF >> 63 ) == 0 )
+    {
+        xX.ullF <<= 1;
+        xX.lE--;
+    }
+
+    return xX;
+}
+
+/* NaN and infinities have the largest exponent, and no JSON number */
+static bool prvIsFinite( double xValue )
+{
+    uint64_t ullBits;
+
+    memcpy( &ullBits, &xValue, sizeof( ullBits ) );
+
+    return ( ( ullBits >> 52 ) & 0x7FFU ) != 0x7FFU;
+}
+
+/* Digits of the shortest decimal in the rounding interval of a positive, finite xValue, and the
+ * exponent of its last digit. */
+static void prvGrisu2( double xValue,
+                       char * pcDigits,
+                       int32_t * plLength,
+                       int32_t * plDecimalExponent )
+{
+    AzureIoTJSONWriterDiyFp_t xV;
+    AzureIoTJSONWriterDiyFp_t xMinus;
+    AzureIoTJSONWriterDiyFp_t xPlus;
+    AzureIoTJSONWriterDiyFp_t xOne;
+    AzureIoTJSONWriterDiyFp_t xCachedPower;
+    const AzureIoTJSONWriterCachedPower_t * pxCachedPower;
+    uint64_t ullBits;
+    uint64_t ullFraction;
+    uint64_t ullDelta;
+    uint64_t ullDistance;
+    uint64_t ullRest;
+    uint64_t ullUnit;
+    uint32_t ulIntegral;
+    uint32_t ulPow10 = 1000000000U;
+    int32_t lExponent;
+    int32_t lK;
+    int32_t lDigits = 10;
+
+    memcpy( &ullBits, &xValue, sizeof( ullBits ) );
+    lExponent = ( int32_t ) ( ullBits >> 52 );
+    ullFraction = ullBits & ( ( 1ULL << 52 ) - 1 );
+
+    /* The value and the bounds of the values that round to it */
+    if( lExponent == 0 )
+    {
+        xV.ullF = ullFraction;
+        xV.lE = 1 - 1075;
+    }
+    else
+    {
+        xV.ullF = ullFraction | ( 1ULL << 52 );
+        xV.lE = lExponent - 1075;
+    }
+
+    xPlus.ullF = 2 * xV.ullF + 1;
+    xPlus.lE = xV.lE - 1;
+    xPlus = prvDiyFpNormalize( xPlus );
+
+    if( ( ullFraction == 0 ) && ( lExponent > 1 ) )
+    {
+        xMinus.ullF = 4 * xV.ullF - 1;
+        xMinus.lE = xV.lE - 2;
+    }
+    else
+    {
+        xMinus.ullF = 2 * xV.ullF - 1;
+        xMinus.lE = xV.lE - 1;
+    }
+
+    xMinus.ullF <<= xMinus.lE - xPlus.lE;
+    xMinus.lE = xPlus.lE;
+    xV = prvDiyFpNormalize( xV );
+
+    /* Scale by the cached power of ten bringing the exponent in [alpha, alpha + 28] */
+    lK = azureiotjsonwriterGRISU_ALPHA - xPlus.lE - 1;
+    lK = ( lK * 78913 ) / ( 1 << 18 ) + ( ( lK > 0 ) ? 1 : 0 );
+    pxCachedPower = &xCachedPowers[ ( -azureiotjsonwriterGRISU_CACHED_POWER_MIN + lK + azureiotjsonwriterGRISU_CACHED_POWER_STEP - 1 ) /
+                                    azureiotjsonwriterGRISU_CACHED_POWER_STEP ];
+    xCachedPower.ullF = pxCachedPower->ullF;
+    xCachedPower.lE = pxCachedPower->lE;
+
+    xV = prvDiyFpMul( xV, xCachedPower );
+    xMinus = prvDiyFpMul( xMinus, xCachedPower );
+    xPlus = prvDiyFpMul( xPlus, xCachedPower );
+    xMinus.ullF++;
+    xPlus.ullF--;
+    *plDecimalExponent = -pxCachedPower->lK;
+
+    /* Digits of the upper bound until the rest is within the interval */
+    ullDelta = prvDiyFpSub( xPlus, xMinus ).ullF;
+    ullDistance = prvDiyFpSub( xPlus, xV ).ullF;
+    xOne.lE = xPlus.lE;
+    xOne.ullF = 1ULL << -xOne.lE;
+    ulIntegral = ( uint32_t ) ( xPlus.ullF >> -xOne.lE );
+    ullFraction = xPlus.ullF & ( xOne.ullF - 1 );
+    *plLength = 0;
+
+    while( ulPow10 > ulIntegral && ulPow10 > 1 )
+    {
+        ulPow10 /= 10;
+        lDigits--;
+    }
+
+    for( ; ; )
+    {
+        if( lDigits > 0 )
+        {
+            pcDigits[ ( *plLength )++ ] = ( char ) ( '0' + ulIntegral / ulPow10 );
+            ulIntegral %= ulPow10;
+            lDigits--;
+            ullRest = ( ( uint64_t ) ulIntegral << -xOne.lE ) + ullFraction;
+            ullUnit = ( uint64_t ) ulPow10 << -xOne.lE;
+            ulPow10 /= 10;
+
+            if( ullRest <= ullDelta )
+            {
+                *plDecimalExponent += lDigits;
+                break;
+            }
+        }
+        else
+        {
+            ullFraction *= 10;
+            pcDigits[ ( *plLength )++ ] = ( char ) ( '0' + ( ullFraction >> -xOne.lE ) );
+            ullFraction &= xOne.ullF - 1;
+            ullDelta *= 10;
+            ullDistance *= 10;
+            ( *plDecimalExponent )--;
+            ullRest = ullFraction;
+            ullUnit = xOne.ullF;
+
+            if( ullRest <= ullDelta )
+            {
+                break;
+            }
+        }
+    }
+
+    /* Move the last digit closer to the value while the digits stay in the interval */
+    while( ( ullRest < ullDistance ) && ( ullDelta - ullRest >= ullUnit ) &&
+           ( ( ullRest + ullUnit < ullDistance ) || ( ullDistance - ullRest > ullRest + ullUnit - ullDistance ) ) )
+    {
+        pcDigits[ *plLength - 1 ]--;
+        ullRest += ullUnit;
+    }
+}
+
+/* The shortest JSON number reading back as xValue, in pcBuffer of azureiotjsonwriterNUMBER_MAX bytes. */
+static int32_t prvFormatShortestDouble( double xValue,
+                                        char * pcBuffer )
+{
+    char * pcDigits = pcBuffer;
+    int32_t lLength;
+    int32_t lDecimalExponent;
+    int32_t lPoint;
+    int32_t lExponent;
+
+    if( xValue < 0 )
+    {
+        *pcDigits++ = '-';
+        xValue = -xValue;
+    }
+
+    if( xValue == 0 )
+    {
+        pcBuffer[ 0 ] = '0';
+        return 1;
+    }
+
+    prvGrisu2( xValue, pcDigits, &lLength, &lDecimalExponent );
+
+    /* Position of the decimal point from the first digit */
+    lPoint = lLength + lDecimalExponent;
+
+    if( ( lLength <= lPoint ) && ( lPoint <= azureiotjsonwriterDECIMAL_POINT_MAX ) )
+    {
+        /* 1234e2 -> 123400 */
+        memset( pcDigits + lLength, '0', ( size_t ) ( lPoint - lLength ) );
+        pcDigits += lPoint;
+    }
+    else if( ( 0 < lPoint ) && ( lPoint <= azureiotjsonwriterDECIMAL_POINT_MAX ) )
+    {
+        /* 1234e-2 -> 12.34 */
+        memmove( pcDigits + lPoint + 1, pcDigits + lPoint, ( size_t ) ( lLength - lPoint ) );
+        pcDigits[ lPoint ] = '.';
+        pcDigits += lLength + 1;
+    }
+    else if( ( azureiotjsonwriterDECIMAL_POINT_MIN < lPoint ) && ( lPoint <= 0 ) )
+    {
+        /* 1234e-6 -> 0.001234 */
+        memmove( pcDigits + 2 - lPoint, pcDigits, ( size_t ) lLength );
+        pcDigits[ 0 ] = '0';
+        pcDigits[ 1 ] = '.';
+        memset( pcDigits + 2, '0', ( size_t ) -lPoint );
+        pcDigits += 2 - lPoint + lLength;
+    }
+    else
+    {
+        /* 1234e-30 -> 1.234e-27 */
+        if( lLength > 1 )
+        {
+            memmove( pcDigits + 2, pcDigits + 1, ( size_t ) ( lLength - 1 ) );
+            pcDigits[ 1 ] = '.';
+            pcDigits += lLength + 1;
+        }
+        else
+        {
+            pcDigits++;
+        }
+
+        *pcDigits++ = 'e';
+        lExponent = lPoint - 1;
+
+        if( lExponent < 0 )
+        {
+            *pcDigits++ = '-';
+            lExponent = -lExponent;
+        }
+
+        if( lExponent >= 100 )
+        {
+            *pcDigits++ = ( char ) ( '0' + lExponent / 100 );
+            lExponent %= 100;
+            *pcDigits++ = ( char ) ( '0' + lExponent / 10 );
+        }
+        else if( lExponent >= 10 )
+        {
+            *pcDigits++ = ( char ) ( '0' + lExponent / 10 );
+        }
+
+        *pcDigits++ = ( char ) ( '0' + lExponent % 10 );
+    }
+
+    return ( int32_t ) ( pcDigits - pcBuffer );
+}
+
+/* lValue / 10^usScale, without trailing zeros after the decimal point, in pcBuffer of
+ * azureiotjsonwriterNUMBER_MAX bytes. */
+static int32_t prvFormatFixedPoint( int32_t lValue,
+                                    uint16_t usScale,
+                                    char * pcBuffer )
+{
+    char cDigits[ 10 ];
+    uint32_t ulValue = ( lValue < 0 ) ? ( 0U - ( uint32_t ) lValue ) : ( uint32_t ) lValue;
+    int32_t lDigits = 0;
+    int32_t lLength = 0;
+    int32_t lIndex;
+
+    /* Least significant digit first, without the zeros after the decimal point */
+    do
+    {
+        cDigits[ lDigits++ ] = ( char ) ( '0' + ulValue % 10 );
+        ulValue /= 10;
+    } while( ulValue != 0 );
+
+    while( ( usScale > 0 ) && ( lDigits > 1 ) && ( cDigits[ 0 ] == '0' ) )
+    {
+        memmove( cDigits, cDigits + 1, ( size_t ) --lDigits );
+        usScale--;
+    }
+
+    if( ( lDigits == 1 ) && ( cDigits[ 0 ] == '0' ) )
+    {
+        pcBuffer[ 0 ] = '0';
+        return 1;
+    }
+
+    if( lValue < 0 )
+    {
+        pcBuffer[ lLength++ ] = '-';
+    }
+
+    if( lDigits <= ( int32_t ) usScale )
+    {
+        pcBuffer[ lLength++ ] = '0';
+        pcBuffer[ lLength++ ] = '.';
+
+        for( lIndex = lDigits; lIndex < ( int32_t ) usScale; lIndex++ )
+        {
+            pcBuffer[ lLength++ ] = '0';
+        }
+    }
+
+    for( lIndex = lDigits - 1; lIndex >= 0; lIndex-- )
+    {
+        pcBuffer[ lLength++ ] = cDigits[ lIndex ];
+
+        if( ( lIndex == ( int32_t ) usScale ) && ( lIndex > 0 ) )
+        {
+            pcBuffer[ lLength++ ] = '.';
+        }
+    }
+
+    return lLength;
+}
+
+/* The flush callback result first, for an append which failed because the callback failed */
+static AzureIoTResult_t prvTranslateCoreError( AzureIoTJSONWriter_t * pxWriter,
+                                               az_result xCoreResult )
+{
+    if( pxWriter->_internal.xFlushResult != eAzureIoTSuccess )
+    {
+        return pxWriter->_internal.xFlushResult;
+    }
+
+    return AzureIoT_TranslateCoreError( xCoreResult );
+}
+
+/* The allocator of the core writer in streaming mode: flushes the buffer, then hands it back whole */
+static az_result prvFlushChunk( az_span_allocator_context * pxAllocatorContext,
+                                az_span * pxNextDestination )
+{
+    AzureIoTJSONWriter_t * pxWriter = ( AzureIoTJSONWriter_t * ) pxAllocatorContext->user_context;
+
+    /* Once a chunk is lost, the JSON text can't be completed */
+    if( pxWriter->_internal.xFlushResult != eAzureIoTSuccess )
+    {
+        return AZ_ERROR_NOT_ENOUGH_SPACE;
+    }
+
+    /* AzureIoTJSONWriter_Flush() may have passed on the start of the chunk already */
+    if( ( uint32_t ) pxAllocatorContext->bytes_used > pxWriter->_internal.ulFlushedLength )
+    {
+        pxWriter->_internal.xFlushResult = pxWriter->_internal.xFlushCallback( pxWriter->_internal.pucBuffer + pxWriter->_internal.ulFlushedLength,
+                                                                               ( uint32_t ) pxAllocatorContext->bytes_used - pxWriter->_internal.ulFlushedLength,
+                                                                               pxWriter->_internal.pvFlushContext );
+
+        if( pxWriter->_internal.xFlushResult != eAzureIoTSuccess )
+        {
+            AZLogError( ( "JSON writer flush failed: error=0x%08x", ( uint16_t ) pxWriter->_internal.xFlushResult ) );
+            return AZ_ERROR_NOT_ENOUGH_SPACE;
+        }
+    }
+
+    pxWriter->_internal.ulFlushedLength = 0;
+    *pxNextDestination = az_span_create( pxWriter->_internal.pucBuffer, ( int32_t ) pxWriter->_internal.ulBufferSize );
+
+    return AZ_OK;
+}
+
+static AzureIoTResult_t prvDiscardChunk( const uint8_t * pucData,
+                                         uint32_t ulDataLength,
+                                         void * pvContext )
+{
+    ( void ) pucData;
+    ( void ) ulDataLength;
+    ( void ) pvContext;
+
+    return eAzureIoTSuccess;
+}
+
+/* A counting writer checks the JSON text is a single value, then counts it without copying it:
+ * a null stands in for it, so the core writer adds the same comma and moves to the same state */
+static az_result prvCountJSONText( AzureIoTJSONWriter_t * pxWriter,
+                                   az_span xJSONSpan )
+{
+    az_json_reader xReader;
+    az_result xCoreResult;
+
+    if( az_result_failed( xCoreResult = az_json_reader_init( &xReader, xJSONSpan, NULL ) ) ||
+        az_result_failed( xCoreResult = az_json_reader_next_token( &xReader ) ) ||
+        az_result_failed( xCoreResult = az_json_reader_skip_children( &xReader ) ) )
+    {
+        return xCoreResult;
+    }
+
+    if( ( xCoreResult = az_json_reader_next_token( &xReader ) ) != AZ_ERROR_JSON_READER_DONE )
+    {
+        return az_result_failed( xCoreResult ) ? xCoreResult : AZ_ERROR_UNEXPECTED_CHAR;
+    }
+
+    if( az_result_failed( xCoreResult = az_json_writer_append_null( &pxWriter->_internal.xCoreWriter ) ) )
+    {
+        return xCoreResult;
+    }
+
+    pxWriter->_internal.lUncopiedLength += az_span_size( xJSONSpan ) - ( int32_t ) ( sizeof( "null" ) - 1 );
+
+    return AZ_OK;
+}
+
 AzureIoTResult_t AzureIoTJSONWriter_Init( AzureIoTJSONWriter_t * pxWriter,
                                           uint8_t * pucBuffer,
                                           uint32_t ulBufferSize )
@@ -30,6 +561,14 @@ AzureIoTResult_t AzureIoTJSONWriter_Init( AzureIoTJSONWriter_t * pxWriter,
     else
     {
         xJSONSpan = az_span_create( ( uint8_t * ) pucBuffer, ( int32_t ) ulBufferSize );
+        pxWriter->_internal.pucBuffer = pucBuffer;
+        pxWriter->_internal.ulBufferSize = ulBufferSize;
+        pxWriter->_internal.xFlushCallback = NULL;
+        pxWriter->_internal.pvFlushContext = NULL;
+        pxWriter->_internal.xFlushResult = eAzureIoTSuccess;
+        pxWriter->_internal.ulFlushedLength = 0;
+        pxWriter->_internal.xCounting = false;
+        pxWriter->_internal.lUncopiedLength = 0;
 
         if( az_result_failed( xCoreResult = az_json_writer_init( &pxWriter->_internal.xCoreWriter, xJSONSpan, NULL ) ) )
         {
@@ -45,6 +584,103 @@ AzureIoTResult_t AzureIoTJSONWriter_Init( AzureIoTJSONWriter_t * pxWriter,
     return xResult;
 }
 
+AzureIoTResult_t AzureIoTJSONWriter_InitStreaming( AzureIoTJSONWriter_t * pxWriter,
+                                                   uint8_t * pucBuffer,
+                                                   uint32_t ulBufferSize,
+                                                   AzureIoTJSONWriterFlushCallback_t xFlushCallback,
+                                                   void * pvFlushContext )
+{
+    AzureIoTResult_t xResult;
+    az_result xCoreResult;
+    az_span xJSONSpan;
+
+    if( ( pxWriter == NULL ) || ( pucBuffer == NULL ) ||
+        ( ulBufferSize < azureiotjsonwriterSTREAMING_BUFFER_MIN_SIZE ) || ( xFlushCallback == NULL ) )
+    {
+        AZLogError( ( "AzureIoTJSONWriter_InitStreaming failed: invalid argument" ) );
+        xResult = eAzureIoTErrorInvalidArgument;
+    }
+    else
+    {
+        xJSONSpan = az_span_create( ( uint8_t * ) pucBuffer, ( int32_t ) ulBufferSize );
+        pxWriter->_internal.pucBuffer = pucBuffer;
+        pxWriter->_internal.ulBufferSize = ulBufferSize;
+        pxWriter->_internal.xFlushCallback = xFlushCallback;
+        pxWriter->_internal.pvFlushContext = pvFlushContext;
+        pxWriter->_internal.xFlushResult = eAzureIoTSuccess;
+        pxWriter->_internal.ulFlushedLength = 0;
+        pxWriter->_internal.xCounting = false;
+        pxWriter->_internal.lUncopiedLength = 0;
+
+        if( az_result_failed( xCoreResult = az_json_writer_chunked_init( &pxWriter->_internal.xCoreWriter, xJSONSpan,
+                                                                         prvFlushChunk, pxWriter, NULL ) ) )
+        {
+            AZLogError( ( "Could not initialize the JSON writer: core error=0x%08x", ( uint16_t ) xCoreResult ) );
+            xResult = AzureIoT_TranslateCoreError( xCoreResult );
+        }
+        else
+        {
+            xResult = eAzureIoTSuccess;
+        }
+    }
+
+    return xResult;
+}
+
+AzureIoTResult_t AzureIoTJSONWriter_InitCounting( AzureIoTJSONWriter_t * pxWriter,
+                                                  uint8_t * pucBuffer,
+                                                  uint32_t ulBufferSize )
+{
+    AzureIoTResult_t xResult;
+
+    if( ( pxWriter == NULL ) || ( pucBuffer == NULL ) ||
+        ( ulBufferSize < azureiotjsonwriterSTREAMING_BUFFER_MIN_SIZE ) )
+    {
+        AZLogError( ( "AzureIoTJSONWriter_InitCounting failed: invalid argument" ) );
+        xResult = eAzureIoTErrorInvalidArgument;
+    }
+    else if( ( xResult = AzureIoTJSONWriter_InitStreaming( pxWriter, pucBuffer, ulBufferSize,
+                                                           prvDiscardChunk, NULL ) ) == eAzureIoTSuccess )
+    {
+        pxWriter->_internal.xCounting = true;
+    }
+
+    return xResult;
+}
+
+AzureIoTResult_t AzureIoTJSONWriter_Flush( AzureIoTJSONWriter_t * pxWriter )
+{
+    AzureIoTResult_t xResult;
+    int32_t lBytesUsed;
+
+    if( ( pxWriter == NULL ) || ( pxWriter->_internal.xFlushCallback == NULL ) )
+    {
+        AZLogError( ( "AzureIoTJSONWriter_Flush failed: invalid argument" ) );
+        xResult = eAzureIoTErrorInvalidArgument;
+    }
+    else if( pxWriter->_internal.xFlushResult != eAzureIoTSuccess )
+    {
+        xResult = pxWriter->_internal.xFlushResult;
+    }
+    else
+    {
+        lBytesUsed = az_span_size( az_json_writer_get_bytes_used_in_destination( &pxWriter->_internal.xCoreWriter ) );
+
+        /* The core writer keeps writing after the text flushed, which is skipped by the next flush */
+        if( ( uint32_t ) lBytesUsed > pxWriter->_internal.ulFlushedLength )
+        {
+            pxWriter->_internal.xFlushResult = pxWriter->_internal.xFlushCallback( pxWriter->_internal.pucBuffer + pxWriter->_internal.ulFlushedLength,
+                                                                                   ( uint32_t ) lBytesUsed - pxWriter->_internal.ulFlushedLength,
+                                                                                   pxWriter->_internal.pvFlushContext );
+            pxWriter->_internal.ulFlushedLength = ( uint32_t ) lBytesUsed;
+        }
+
+        xResult = pxWriter->_internal.xFlushResult;
+    }
+
+    return xResult;
+}
+
 AzureIoTResult_t AzureIoTJSONWriter_AppendPropertyWithInt32Value( AzureIoTJSONWriter_t * pxWriter,
                                                                   const uint8_t * pucPropertyName,
                                                                   uint32_t ulPropertyNameLength,
@@ -67,7 +703,7 @@ AzureIoTResult_t AzureIoTJSONWriter_AppendPropertyWithInt32Value( AzureIoTJSONWr
             az_result_failed( xCoreResult = az_json_writer_append_int32( &pxWriter->_internal.xCoreWriter, lValue ) ) )
         {
             AZLogError( ( "Could not append property and int32: core error=0x%08x", ( uint16_t ) xCoreResult ) );
-            xResult = AzureIoT_TranslateCoreError( xCoreResult );
+            xResult = prvTranslateCoreError( pxWriter, xCoreResult );
         }
         else
         {
@@ -101,7 +737,84 @@ AzureIoTResult_t AzureIoTJSONWriter_AppendPropertyWithDoubleValue( AzureIoTJSONW
             az_result_failed( xCoreResult = az_json_writer_append_double( &pxWriter->_internal.xCoreWriter, xValue, ( int32_t ) usFractionalDigits ) ) )
         {
             AZLogError( ( "Could not append property and double: core error=0x%08x", ( uint16_t ) xCoreResult ) );
-            xResult = AzureIoT_TranslateCoreError( xCoreResult );
+            xResult = prvTranslateCoreError( pxWriter, xCoreResult );
+        }
+        else
+        {
+            xResult = eAzureIoTSuccess;
+        }
+    }
+
+    return xResult;
+}
+
+AzureIoTResult_t AzureIoTJSONWriter_AppendPropertyWithShortestDoubleValue( AzureIoTJSONWriter_t * pxWriter,
+                                                                           const uint8_t * pucPropertyName,
+                                                                           uint32_t ulPropertyNameLength,
+                                                                           double xValue )
+{
+    AzureIoTResult_t xResult;
+    az_result xCoreResult;
+    az_span xPropertyNameSpan;
+    char cNumber[ azureiotjsonwriterNUMBER_MAX ];
+    int32_t lNumberLength;
+
+    if( ( pxWriter == NULL ) || ( pucPropertyName == NULL ) || ( ulPropertyNameLength == 0 ) ||
+        !prvIsFinite( xValue ) )
+    {
+        AZLogError( ( "AzureIoTJSONWriter_AppendPropertyWithShortestDoubleValue failed: invalid argument" ) );
+        xResult = eAzureIoTErrorInvalidArgument;
+    }
+    else
+    {
+        xPropertyNameSpan = az_span_create( ( uint8_t * ) pucPropertyName, ( int32_t ) ulPropertyNameLength );
+        lNumberLength = prvFormatShortestDouble( xValue, cNumber );
+
+        if( az_result_failed( xCoreResult = az_json_writer_append_property_name( &pxWriter->_internal.xCoreWriter, xPropertyNameSpan ) ) ||
+            az_result_failed( xCoreResult = az_json_writer_append_json_text( &pxWriter->_internal.xCoreWriter,
+                                                                             az_span_create( ( uint8_t * ) cNumber, lNumberLength ) ) ) )
+        {
+            AZLogError( ( "Could not append property and shortest double: core error=0x%08x", ( uint16_t ) xCoreResult ) );
+            xResult = prvTranslateCoreError( pxWriter, xCoreResult );
+        }
+        else
+        {
+            xResult = eAzureIoTSuccess;
+        }
+    }
+
+    return xResult;
+}
+
+AzureIoTResult_t AzureIoTJSONWriter_AppendPropertyWithFixedPointValue( AzureIoTJSONWriter_t * pxWriter,
+                                                                       const uint8_t * pucPropertyName,
+                                                                       uint32_t ulPropertyNameLength,
+                                                                       int32_t lValue,
+                                                                       uint16_t usScale )
+{
+    AzureIoTResult_t xResult;
+    az_result xCoreResult;
+    az_span xPropertyNameSpan;
+    char cNumber[ azureiotjsonwriterNUMBER_MAX ];
+    int32_t lNumberLength;
+
+    if( ( pxWriter == NULL ) || ( pucPropertyName == NULL ) || ( ulPropertyNameLength == 0 ) ||
+        ( usScale > azureiotjsonwriterFIXED_POINT_SCALE_MAX ) )
+    {
+        AZLogError( ( "AzureIoTJSONWriter_AppendPropertyWithFixedPointValue failed: invalid argument" ) );
+        xResult = eAzureIoTErrorInvalidArgument;
+    }
+    else
+    {
+        xPropertyNameSpan = az_span_create( ( uint8_t * ) pucPropertyName, ( int32_t ) ulPropertyNameLength );
+        lNumberLength = prvFormatFixedPoint( lValue, usScale, cNumber );
+
+        if( az_result_failed( xCoreResult = az_json_writer_append_property_name( &pxWriter->_internal.xCoreWriter, xPropertyNameSpan ) ) ||
+            az_result_failed( xCoreResult = az_json_writer_append_json_text( &pxWriter->_internal.xCoreWriter,
+                                                                             az_span_create( ( uint8_t * ) cNumber, lNumberLength ) ) ) )
+        {
+            AZLogError( ( "Could not append property and fixed point: core error=0x%08x", ( uint16_t ) xCoreResult ) );
+            xResult = prvTranslateCoreError( pxWriter, xCoreResult );
         }
         else
         {
@@ -134,7 +847,7 @@ AzureIoTResult_t AzureIoTJSONWriter_AppendPropertyWithBoolValue( AzureIoTJSONWri
             az_result_failed( xCoreResult = az_json_writer_append_bool( &pxWriter->_internal.xCoreWriter, xValue ) ) )
         {
             AZLogError( ( "Could not append property and bool: core error=0x%08x", ( uint16_t ) xCoreResult ) );
-            xResult = AzureIoT_TranslateCoreError( xCoreResult );
+            xResult = prvTranslateCoreError( pxWriter, xCoreResult );
         }
         else
         {
@@ -171,7 +884,7 @@ AzureIoTResult_t AzureIoTJSONWriter_AppendPropertyWithStringValue( AzureIoTJSONW
             az_result_failed( xCoreResult = az_json_writer_append_string( &pxWriter->_internal.xCoreWriter, xValueSpan ) ) )
         {
             AZLogError( ( "Could not append property and string: core error=0x%08x", ( uint16_t ) xCoreResult ) );
-            xResult = AzureIoT_TranslateCoreError( xCoreResult );
+            xResult = prvTranslateCoreError( pxWriter, xCoreResult );
         }
         else
         {
@@ -190,6 +903,11 @@ int32_t AzureIoTJSONWriter_GetBytesUsed( AzureIoTJSONWriter_t * pxWriter )
         return -1;
     }
 
+    if( pxWriter->_internal.xFlushCallback != NULL )
+    {
+        return pxWriter->_internal.xCoreWriter.total_bytes_written + pxWriter->_internal.lUncopiedLength;
+    }
+
     return az_span_size( az_json_writer_get_bytes_used_in_destination( &pxWriter->_internal.xCoreWriter ) );
 }
 
@@ -213,7 +931,7 @@ AzureIoTResult_t AzureIoTJSONWriter_AppendString( AzureIoTJSONWriter_t * pxWrite
         if( az_result_failed( xCoreResult = az_json_writer_append_string( &pxWriter->_internal.xCoreWriter, xValueSpan ) ) )
         {
             AZLogError( ( "Could not append string: core error=0x%08x", ( uint16_t ) xCoreResult ) );
-            xResult = AzureIoT_TranslateCoreError( xCoreResult );
+            xResult = prvTranslateCoreError( pxWriter, xCoreResult );
         }
         else
         {
@@ -241,10 +959,19 @@ AzureIoTResult_t AzureIoTJSONWriter_AppendJSONText( AzureIoTJSONWriter_t * pxWri
     {
         xJSONSpan = az_span_create( ( uint8_t * ) pucJSON, ( int32_t ) ulJSONLen );
 
-        if( az_result_failed( xCoreResult = az_json_writer_append_json_text( &pxWriter->_internal.xCoreWriter, xJSONSpan ) ) )
+        if( pxWriter->_internal.xCounting )
+        {
+            xCoreResult = prvCountJSONText( pxWriter, xJSONSpan );
+        }
+        else
+        {
+            xCoreResult = az_json_writer_append_json_text( &pxWriter->_internal.xCoreWriter, xJSONSpan );
+        }
+
+        if( az_result_failed( xCoreResult ) )
         {
             AZLogError( ( "Could not append JSON text: core error=0x%08x", ( uint16_t ) xCoreResult ) );
-            xResult = AzureIoT_TranslateCoreError( xCoreResult );
+            xResult = prvTranslateCoreError( pxWriter, xCoreResult );
         }
         else
         {
@@ -275,7 +1002,7 @@ AzureIoTResult_t AzureIoTJSONWriter_AppendPropertyName( AzureIoTJSONWriter_t * p
         if( az_result_failed( xCoreResult = az_json_writer_append_property_name( &pxWriter->_internal.xCoreWriter, xPropertyNameSpan ) ) )
         {
             AZLogError( ( "Could not append property name: core error=0x%08x", ( uint16_t ) xCoreResult ) );
-            xResult = AzureIoT_TranslateCoreError( xCoreResult );
+            xResult = prvTranslateCoreError( pxWriter, xCoreResult );
         }
         else
         {
@@ -302,7 +1029,7 @@ AzureIoTResult_t AzureIoTJSONWriter_AppendBool( AzureIoTJSONWriter_t * pxWriter,
         if( az_result_failed( xCoreResult = az_json_writer_append_bool( &pxWriter->_internal.xCoreWriter, xValue ) ) )
         {
             AZLogError( ( "Could not append bool: core error=0x%08x", ( uint16_t ) xCoreResult ) );
-            xResult = AzureIoT_TranslateCoreError( xCoreResult );
+            xResult = prvTranslateCoreError( pxWriter, xCoreResult );
         }
         else
         {
@@ -329,7 +1056,7 @@ AzureIoTResult_t AzureIoTJSONWriter_AppendInt32( AzureIoTJSONWriter_t * pxWriter
         if( az_result_failed( xCoreResult = az_json_writer_append_int32( &pxWriter->_internal.xCoreWriter, lValue ) ) )
         {
             AZLogError( ( "Could not append int32: core error=0x%08x", ( uint16_t ) xCoreResult ) );
-            xResult = AzureIoT_TranslateCoreError( xCoreResult );
+            xResult = prvTranslateCoreError( pxWriter, xCoreResult );
         }
         else
         {
@@ -357,7 +1084,72 @@ AzureIoTResult_t AzureIoTJSONWriter_AppendDouble( AzureIoTJSONWriter_t * pxWrite
         if( az_result_failed( xCoreResult = az_json_writer_append_double( &pxWriter->_internal.xCoreWriter, xValue, usFractionalDigits ) ) )
         {
             AZLogError( ( "Could not append double: core error=0x%08x", ( uint16_t ) xCoreResult ) );
-            xResult = AzureIoT_TranslateCoreError( xCoreResult );
+            xResult = prvTranslateCoreError( pxWriter, xCoreResult );
+        }
+        else
+        {
+            xResult = eAzureIoTSuccess;
+        }
+    }
+
+    return xResult;
+}
+
+AzureIoTResult_t AzureIoTJSONWriter_AppendShortestDouble( AzureIoTJSONWriter_t * pxWriter,
+                                                          double xValue )
+{
+    AzureIoTResult_t xResult;
+    az_result xCoreResult;
+    char cNumber[ azureiotjsonwriterNUMBER_MAX ];
+    int32_t lNumberLength;
+
+    if( ( pxWriter == NULL ) || !prvIsFinite( xValue ) )
+    {
+        AZLogError( ( "AzureIoTJSONWriter_AppendShortestDouble failed: invalid argument" ) );
+        xResult = eAzureIoTErrorInvalidArgument;
+    }
+    else
+    {
+        lNumberLength = prvFormatShortestDouble( xValue, cNumber );
+
+        if( az_result_failed( xCoreResult = az_json_writer_append_json_text( &pxWriter->_internal.xCoreWriter,
+                                                                             az_span_create( ( uint8_t * ) cNumber, lNumberLength ) ) ) )
+        {
+            AZLogError( ( "Could not append shortest double: core error=0x%08x", ( uint16_t ) xCoreResult ) );
+            xResult = prvTranslateCoreError( pxWriter, xCoreResult );
+        }
+        else
+        {
+            xResult = eAzureIoTSuccess;
+        }
+    }
+
+    return xResult;
+}
+
+AzureIoTResult_t AzureIoTJSONWriter_AppendFixedPoint( AzureIoTJSONWriter_t * pxWriter,
+                                                      int32_t lValue,
+                                                      uint16_t usScale )
+{
+    AzureIoTResult_t xResult;
+    az_result xCoreResult;
+    char cNumber[ azureiotjsonwriterNUMBER_MAX ];
+    int32_t lNumberLength;
+
+    if( ( pxWriter == NULL ) || ( usScale > azureiotjsonwriterFIXED_POINT_SCALE_MAX ) )
+    {
+        AZLogError( ( "AzureIoTJSONWriter_AppendFixedPoint failed: invalid argument" ) );
+        xResult = eAzureIoTErrorInvalidArgument;
+    }
+    else
+    {
+        lNumberLength = prvFormatFixedPoint( lValue, usScale, cNumber );
+
+        if( az_result_failed( xCoreResult = az_json_writer_append_json_text( &pxWriter->_internal.xCoreWriter,
+                                                                             az_span_create( ( uint8_t * ) cNumber, lNumberLength ) ) ) )
+        {
+            AZLogError( ( "Could not append fixed point: core error=0x%08x", ( uint16_t ) xCoreResult ) );
+            xResult = prvTranslateCoreError( pxWriter, xCoreResult );
         }
         else
         {
@@ -383,7 +1175,7 @@ AzureIoTResult_t AzureIoTJSONWriter_AppendNull( AzureIoTJSONWriter_t * pxWriter
         if( az_result_failed( xCoreResult = az_json_writer_append_null( &pxWriter->_internal.xCoreWriter ) ) )
         {
             AZLogError( ( "Could not append NULL: core error=0x%08x", ( uint16_t ) xCoreResult ) );
-            xResult = AzureIoT_TranslateCoreError( xCoreResult );
+            xResult = prvTranslateCoreError( pxWriter, xCoreResult );
         }
         else
         {
@@ -409,7 +1201,7 @@ AzureIoTResult_t AzureIoTJSONWriter_AppendBeginObject( AzureIoTJSONWriter_t * px
         if( az_result_failed( xCoreResult = az_json_writer_append_begin_object( &pxWriter->_internal.xCoreWriter ) ) )
         {
             AZLogError( ( "Could not append begin object: core error=0x%08x", ( uint16_t ) xCoreResult ) );
-            xResult = AzureIoT_TranslateCoreError( xCoreResult );
+            xResult = prvTranslateCoreError( pxWriter, xCoreResult );
         }
         else
         {
@@ -435,7 +1227,7 @@ AzureIoTResult_t AzureIoTJSONWriter_AppendBeginArray( AzureIoTJSONWriter_t * pxW
         if( az_result_failed( xCoreResult = az_json_writer_append_begin_array( &pxWriter->_internal.xCoreWriter ) ) )
         {
             AZLogError( ( "Could not append begin array: core error=0x%08x", ( uint16_t ) xCoreResult ) );
-            xResult = AzureIoT_TranslateCoreError( xCoreResult );
+            xResult = prvTranslateCoreError( pxWriter, xCoreResult );
         }
         else
         {
@@ -461,7 +1253,7 @@ AzureIoTResult_t AzureIoTJSONWriter_AppendEndObject( AzureIoTJSONWriter_t * pxWr
         if( az_result_failed( xCoreResult = az_json_writer_append_end_object( &pxWriter->_internal.xCoreWriter ) ) )
         {
             AZLogError( ( "Could not append end object: core error=0x%08x", ( uint16_t ) xCoreResult ) );
-            xResult = AzureIoT_TranslateCoreError( xCoreResult );
+            xResult = prvTranslateCoreError( pxWriter, xCoreResult );
         }
         else
         {
@@ -487,7 +1279,7 @@ AzureIoTResult_t AzureIoTJSONWriter_AppendEndArray( AzureIoTJSONWriter_t * pxWri
         if( az_result_failed( xCoreResult = az_json_writer_append_end_array( &pxWriter->_internal.xCoreWriter ) ) )
         {
             AZLogError( ( "Could not append end array: core error=0x%08x", ( uint16_t ) xCoreResult ) );
-            xResult = AzureIoT_TranslateCoreError( xCoreResult );
+            xResult = prvTranslateCoreError( pxWriter, xCoreResult );
         }
         else
         {
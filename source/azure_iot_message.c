@@ -101,3 +101,21 @@ AzureIoTResult_t AzureIoTMessage_PropertiesFind( AzureIoTMessageProperties_t * p
     return eAzureIoTSuccess;
 }
 /*-----------------------------------------------------------*/
+
+AzureIoTResult_t AzureIoTMessage_PropertiesAppendContentType( AzureIoTMessageProperties_t * pxMessageProperties,
+                                                              const uint8_t * pucContentType,
+                                                              uint32_t ulContentTypeLength )
+{
+    if( ( pxMessageProperties == NULL ) ||
+        ( pucContentType == NULL ) || ( ulContentTypeLength == 0 ) )
+    {
+        AZLogError( ( "AzureIoTMessage_PropertiesAppendContentType failed: Invalid argument" ) );
+        return eAzureIoTErrorInvalidArgument;
+    }
+
+    return AzureIoTMessage_PropertiesAppend( pxMessageProperties,
+                                             ( const uint8_t * ) azureiotmessagePROPERTY_CONTENT_TYPE,
+                                             sizeof( azureiotmessagePROPERTY_CONTENT_TYPE ) - 1,
+                                             pucContentType, ulContentTypeLength );
+}
+/*-----------------------------------------------------------*/
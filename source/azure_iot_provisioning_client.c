@@ -54,6 +54,7 @@
 #define azureiotprovisioningWF_STATE_COMPLETE       ( 0x8 )
 
 #define azureiotPrvGetMaxInt( a, b )    ( ( a ) > ( b ) ? ( a ) : ( b ) )
+#define azureiotPrvGetMinInt( a, b )    ( ( a ) < ( b ) ? ( a ) : ( b ) )
 
 #define azureiotprovisioningREQUEST_PAYLOAD_LABEL            "payload"
 #define azureiotprovisioningREQUEST_REGISTRATION_ID_LABEL    "registrationId"
@@ -557,6 +558,59 @@ static AzureIoTResult_t prvProvClientRunWorkflow( AzureIoTProvisioningClient_t *
 }
 /*-----------------------------------------------------------*/
 
+/**
+ * Compute the time in milliseconds until the workflow needs to be serviced again.
+ *
+ * While waiting for the retry interval the deadline is capped to half the MQTT keep alive,
+ * so that the ping is still sent on time by the process loop.
+ *
+ */
+static uint32_t prvProvClientGetNextDeadline( AzureIoTProvisioningClient_t * pxAzureProvClient )
+{
+    uint64_t ullNow;
+    uint64_t ullRemainingMs;
+    uint32_t ulDeadline;
+
+    switch( pxAzureProvClient->_internal.ulWorkflowState )
+    {
+        case azureiotprovisioningWF_STATE_CONNECT:
+        case azureiotprovisioningWF_STATE_SUBSCRIBE:
+        case azureiotprovisioningWF_STATE_REQUEST:
+        case azureiotprovisioningWF_STATE_RESPONSE:
+            /* Next action can be taken right away. */
+            ulDeadline = 0;
+            break;
+
+        case azureiotprovisioningWF_STATE_WAITING:
+            ullNow = pxAzureProvClient->_internal.xGetTimeFunction();
+
+            if( ullNow > pxAzureProvClient->_internal.ullRetryAfter )
+            {
+                ulDeadline = 0;
+            }
+            else
+            {
+                /* Retry fires once current time is past ullRetryAfter, hence the extra second. */
+                ullRemainingMs = ( pxAzureProvClient->_internal.ullRetryAfter - ullNow + 1 ) * 1000U;
+                ulDeadline = ( uint32_t ) azureiotPrvGetMinInt( ullRemainingMs,
+                                                               ( azureiotprovisioningKEEP_ALIVE_TIMEOUT_SECONDS * 1000U ) / 2U );
+            }
+
+            break;
+
+        case azureiotprovisioningWF_STATE_COMPLETE:
+            ulDeadline = azureiotprovisioningWAIT_FOREVER;
+            break;
+
+        default:
+            /* Waiting on the receive path. */
+            ulDeadline = azureiotprovisioningPROCESS_LOOP_TIMEOUT_MS;
+            break;
+    }
+
+    return ulDeadline;
+}
+/*-----------------------------------------------------------*/
 
 /**
  *  Process MQTT Subscribe Ack from Provisioning Service
@@ -906,6 +960,75 @@ AzureIoTResult_t AzureIoTProvisioningClient_Register( AzureIoTProvisioningClient
 }
 /*-----------------------------------------------------------*/
 
+AzureIoTResult_t AzureIoTProvisioningClient_RegisterAsync( AzureIoTProvisioningClient_t * pxAzureProvClient,
+                                                           AzureIoTProvisioningClientRegisterCallback_t xCallback,
+                                                           void * pvCallbackContext )
+{
+    AzureIoTResult_t xResult;
+
+    if( pxAzureProvClient == NULL )
+    {
+        AZLogError( ( "AzureIoTProvisioningClient_RegisterAsync failed: invalid argument" ) );
+        xResult = eAzureIoTErrorInvalidArgument;
+    }
+    else if( pxAzureProvClient->_internal.ulWorkflowState != azureiotprovisioningWF_STATE_INIT )
+    {
+        AZLogError( ( "AzureIoTProvisioningClient_RegisterAsync failed: registration already started, state=%u",
+                      ( uint16_t ) pxAzureProvClient->_internal.ulWorkflowState ) );
+        xResult = eAzureIoTErrorFailed;
+    }
+    else
+    {
+        pxAzureProvClient->_internal.xRegisterCallback = xCallback;
+        pxAzureProvClient->_internal.pvRegisterCallbackContext = pvCallbackContext;
+        pxAzureProvClient->_internal.ulWorkflowState = azureiotprovisioningWF_STATE_CONNECT;
+        xResult = eAzureIoTSuccess;
+    }
+
+    return xResult;
+}
+/*-----------------------------------------------------------*/
+
+AzureIoTResult_t AzureIoTProvisioningClient_ProcessLoop( AzureIoTProvisioningClient_t * pxAzureProvClient,
+                                                         uint32_t * pulNextDeadlineMilliseconds )
+{
+    AzureIoTResult_t xResult;
+    AzureIoTProvisioningClientRegisterCallback_t xCallback;
+
+    if( pxAzureProvClient == NULL )
+    {
+        AZLogError( ( "AzureIoTProvisioningClient_ProcessLoop failed: invalid argument" ) );
+        xResult = eAzureIoTErrorInvalidArgument;
+    }
+    else if( pxAzureProvClient->_internal.ulWorkflowState == azureiotprovisioningWF_STATE_INIT )
+    {
+        AZLogError( ( "AzureIoTProvisioningClient_ProcessLoop failed: registration not started" ) );
+        xResult = eAzureIoTErrorFailed;
+    }
+    else
+    {
+        xResult = prvProvClientRunWorkflow( pxAzureProvClient, azureiotprovisioningNO_WAIT );
+
+        if( ( xResult != eAzureIoTErrorPending ) &&
+            ( pxAzureProvClient->_internal.xRegisterCallback != NULL ) )
+        {
+            /* Clear before invoking so the callback is only delivered once. */
+            xCallback = pxAzureProvClient->_internal.xRegisterCallback;
+            pxAzureProvClient->_internal.xRegisterCallback = NULL;
+            xCallback( pxAzureProvClient, xResult,
+                       pxAzureProvClient->_internal.pvRegisterCallbackContext );
+        }
+
+        if( pulNextDeadlineMilliseconds != NULL )
+        {
+            *pulNextDeadlineMilliseconds = prvProvClientGetNextDeadline( pxAzureProvClient );
+        }
+    }
+
+    return xResult;
+}
+/*-----------------------------------------------------------*/
+
 AzureIoTResult_t AzureIoTProvisioningClient_GetDeviceAndHub( AzureIoTProvisioningClient_t * pxAzureProvClient,
                                                              uint8_t * pucHubHostname,
                                                              uint32_t * pulHostnameLength,
@@ -283,6 +283,84 @@ typedef struct AzureIoTADUUpdateRequest
     AzureIoTADUUpdateManifest_t xUpdateManifest;
 } AzureIoTADUUpdateRequest_t;
 
+/**
+ * @brief A step in the instructions of an ADU update manifest, read from an
+ *        #AzureIoTADUUpdateRequestCompact_t.
+ *
+ * @note The names of the files of the step are read with AzureIoTADUUpdateRequestCompact_GetStepFile().
+ */
+typedef struct AzureIoTADUInstructionStepCompact
+{
+    uint8_t * pucHandler;
+    uint32_t ulHandlerLength;
+    uint8_t * pucInstalledCriteria;
+    uint32_t ulInstalledCriteriaLength;
+    uint32_t ulFilesCount;
+
+    struct
+    {
+        uint8_t * pucFiles;
+        uint32_t ulFilesLength;
+    } _internal; /**< Internal */
+} AzureIoTADUInstructionStepCompact_t;
+
+/**
+ * @brief Details of a file referenced in the update manifest, read from an
+ *        #AzureIoTADUUpdateRequestCompact_t.
+ *
+ * @note The hashes of the file are read with AzureIoTADUUpdateRequestCompact_GetFileHash().
+ */
+typedef struct AzureIoTADUUpdateManifestFileCompact
+{
+    uint8_t * pucId;
+    uint32_t ulIdLength;
+    uint8_t * pucFileName;
+    uint32_t ulFileNameLength;
+    int64_t llSizeInBytes;
+    uint32_t ulHashesCount;
+
+    struct
+    {
+        uint8_t * pucHashes;
+        uint32_t ulHashesLength;
+    } _internal; /**< Internal */
+} AzureIoTADUUpdateManifestFileCompact_t;
+
+/**
+ * @brief Compact form of #AzureIoTADUUpdateRequest_t.
+ *
+ * Only the workflow, the update id and the locations of the instruction steps, the files and the file
+ * urls in the property JSON are stored. Steps, files, hashes and urls are parsed on each access by the
+ * AzureIoTADUUpdateRequestCompact_Get*() functions, so there is no limit on their number and the
+ * property payload must stay valid while the request is used.
+ */
+typedef struct AzureIoTADUUpdateRequestCompact
+{
+    AzureIoTADUClientWorkflow_t xWorkflow;
+    uint8_t * pucUpdateManifest;
+    uint32_t ulUpdateManifestLength;
+    uint8_t * pucUpdateManifestSignature;
+    uint32_t ulUpdateManifestSignatureLength;
+    AzureIoTADUUpdateId_t xUpdateId;
+    uint8_t * pucManifestVersion;
+    uint32_t ulManifestVersionLength;
+    uint8_t * pucCreateDateTime;
+    uint32_t ulCreateDateTimeLength;
+    uint32_t ulStepsCount;
+    uint32_t ulFilesCount;
+    uint32_t ulFileUrlCount;
+
+    struct
+    {
+        uint8_t * pucSteps;
+        uint32_t ulStepsLength;
+        uint8_t * pucFiles;
+        uint32_t ulFilesLength;
+        uint8_t * pucFileUrls;
+        uint32_t ulFileUrlsLength;
+    } _internal; /**< Internal */
+} AzureIoTADUUpdateRequestCompact_t;
+
 /**
  * @brief User-defined options for the Azure IoT ADU client.
  */
@@ -362,6 +440,108 @@ AzureIoTResult_t AzureIoTADUClient_ParseRequest( AzureIoTADUClient_t * pxAzureIo
                                                  AzureIoTJSONReader_t * pxReader,
                                                  AzureIoTADUUpdateRequest_t * pxAduUpdateRequest );
 
+/**
+ * @brief Parse the ADU update request into the compact #AzureIoTADUUpdateRequestCompact_t.
+ *
+ * Like AzureIoTADUClient_ParseRequest(), the update manifest is unescaped in place in the
+ * property payload. Only its top level is parsed here; steps, files, hashes and urls are parsed
+ * when they are read.
+ *
+ * @param[in] pxAzureIoTADUClient The #AzureIoTADUClient_t * to use for this call.
+ * @param[in,out] pxReader The initialized JSON reader positioned at the beginning of the ADU subcomponent property.
+ * @param[out] pxAduUpdateRequest The #AzureIoTADUUpdateRequestCompact_t into which the properties will be parsed.
+ * @return AzureIoTResult_t An #AzureIoTResult_t with the result of the operation.
+ */
+AzureIoTResult_t AzureIoTADUClient_ParseRequestCompact( AzureIoTADUClient_t * pxAzureIoTADUClient,
+                                                        AzureIoTJSONReader_t * pxReader,
+                                                        AzureIoTADUUpdateRequestCompact_t * pxAduUpdateRequest );
+
+/**
+ * @brief Read an instruction step of a compact update request.
+ *
+ * @note The steps are walked from the first one, so the cost grows with \p ulStepIndex.
+ *
+ * @param[in] pxAduUpdateRequest The #AzureIoTADUUpdateRequestCompact_t to read from.
+ * @param[in] ulStepIndex The index of the step, lower than `ulStepsCount`.
+ * @param[out] pxStep The #AzureIoTADUInstructionStepCompact_t to fill.
+ * @return An #AzureIoTResult_t with the result of the operation.
+ * @retval eAzureIoTErrorItemNotFound if there is no step \p ulStepIndex.
+ */
+AzureIoTResult_t AzureIoTADUUpdateRequestCompact_GetStep( AzureIoTADUUpdateRequestCompact_t const* pxAduUpdateRequest,
+                                                          uint32_t ulStepIndex,
+                                                          AzureIoTADUInstructionStepCompact_t * pxStep );
+
+/**
+ * @brief Read the name of a file of an instruction step.
+ *
+ * @param[in] pxStep The #AzureIoTADUInstructionStepCompact_t read with AzureIoTADUUpdateRequestCompact_GetStep().
+ * @param[in] ulFileIndex The index of the file, lower than `ulFilesCount` of \p pxStep.
+ * @param[out] pxFile The #AzureIoTADUUpdateManifestInstructionStepFile_t to fill.
+ * @return An #AzureIoTResult_t with the result of the operation.
+ * @retval eAzureIoTErrorItemNotFound if there is no file \p ulFileIndex.
+ */
+AzureIoTResult_t AzureIoTADUUpdateRequestCompact_GetStepFile( AzureIoTADUInstructionStepCompact_t const* pxStep,
+                                                              uint32_t ulFileIndex,
+                                                              AzureIoTADUUpdateManifestInstructionStepFile_t * pxFile );
+
+/**
+ * @brief Read a file of the update manifest of a compact update request.
+ *
+ * @note The files are walked from the first one, so the cost grows with \p ulFileIndex.
+ *
+ * @param[in] pxAduUpdateRequest The #AzureIoTADUUpdateRequestCompact_t to read from.
+ * @param[in] ulFileIndex The index of the file, lower than `ulFilesCount`.
+ * @param[out] pxFile The #AzureIoTADUUpdateManifestFileCompact_t to fill.
+ * @return An #AzureIoTResult_t with the result of the operation.
+ * @retval eAzureIoTErrorItemNotFound if there is no file \p ulFileIndex.
+ */
+AzureIoTResult_t AzureIoTADUUpdateRequestCompact_GetFile( AzureIoTADUUpdateRequestCompact_t const* pxAduUpdateRequest,
+                                                          uint32_t ulFileIndex,
+                                                          AzureIoTADUUpdateManifestFileCompact_t * pxFile );
+
+/**
+ * @brief Find a file of the update manifest of a compact update request by its id.
+ *
+ * @param[in] pxAduUpdateRequest The #AzureIoTADUUpdateRequestCompact_t to read from.
+ * @param[in] pucFileId The id of the file, as listed by the files of a step.
+ * @param[in] ulFileIdLength The length of \p pucFileId.
+ * @param[out] pxFile The #AzureIoTADUUpdateManifestFileCompact_t to fill.
+ * @return An #AzureIoTResult_t with the result of the operation.
+ * @retval eAzureIoTErrorItemNotFound if there is no file with id \p pucFileId.
+ */
+AzureIoTResult_t AzureIoTADUUpdateRequestCompact_FindFile( AzureIoTADUUpdateRequestCompact_t const* pxAduUpdateRequest,
+                                                           const uint8_t * pucFileId,
+                                                           uint32_t ulFileIdLength,
+                                                           AzureIoTADUUpdateManifestFileCompact_t * pxFile );
+
+/**
+ * @brief Read a hash of a file of the update manifest.
+ *
+ * @param[in] pxFile The #AzureIoTADUUpdateManifestFileCompact_t read with AzureIoTADUUpdateRequestCompact_GetFile().
+ * @param[in] ulHashIndex The index of the hash, lower than `ulHashesCount` of \p pxFile.
+ * @param[out] pxHash The #AzureIoTADUUpdateManifestFileHash_t to fill.
+ * @return An #AzureIoTResult_t with the result of the operation.
+ * @retval eAzureIoTErrorItemNotFound if there is no hash \p ulHashIndex.
+ */
+AzureIoTResult_t AzureIoTADUUpdateRequestCompact_GetFileHash( AzureIoTADUUpdateManifestFileCompact_t const* pxFile,
+                                                              uint32_t ulHashIndex,
+                                                              AzureIoTADUUpdateManifestFileHash_t * pxHash );
+
+/**
+ * @brief Find the download url of a file of a compact update request.
+ *
+ * @param[in] pxAduUpdateRequest The #AzureIoTADUUpdateRequestCompact_t to read from.
+ * @param[in] pucFileId The id of the file.
+ * @param[in] ulFileIdLength The length of \p pucFileId.
+ * @param[out] pxFileUrl The #AzureIoTADUUpdateManifestFileUrl_t to fill.
+ * @return An #AzureIoTResult_t with the result of the operation.
+ * @retval eAzureIoTErrorItemNotFound if there is no url for \p pucFileId.
+ */
+AzureIoTResult_t AzureIoTADUUpdateRequestCompact_FindFileUrl( AzureIoTADUUpdateRequestCompact_t const* pxAduUpdateRequest,
+                                                              const uint8_t * pucFileId,
+                                                              uint32_t ulFileIdLength,
+                                                              AzureIoTADUUpdateManifestFileUrl_t * pxFileUrl );
+
 /**
  * @brief Updates the ADU Agent Client with ADU service device update properties.
  * @remark It must be called whenever writable properties are received containing
@@ -418,4 +598,32 @@ AzureIoTResult_t AzureIoTADUClient_SendAgentState( AzureIoTADUClient_t const* px
                                                    uint32_t * pulRequestId );
 
 
+/**
+ * @brief Sends the current state of the Azure IoT ADU agent for a compact update request.
+ *
+ * Same as AzureIoTADUClient_SendAgentState(), taking the workflow from an #AzureIoTADUUpdateRequestCompact_t.
+ *
+ * @param[in] pxAzureIoTADUClient The #AzureIoTADUClient_t * to use for this call.
+ * @param[in] pxAzureIoTHubClient The #AzureIoTHubClient_t * to use for this call.
+ * @param[in] pxDeviceProperties The device information which will be used to generate the payload.
+ * @param[in] pxAduUpdateRequest The current #AzureIoTADUUpdateRequestCompact_t. This can be `NULL` if there isn't
+ * currently an update request.
+ * @param[in] xAgentState The current #AzureIoTADUAgentState_t.
+ * @param[in] pxUpdateResults The current #AzureIoTADUClientInstallResult_t. This can be `NULL` if there aren't any
+ * results from an update.
+ * @param[out] pucBuffer The buffer into which the generated payload will be placed.
+ * @param[in] ulBufferSize The length of \p pucBuffer.
+ * @param[in] pulRequestId An optional request id to be used for the publish. This can be `NULL`.
+ * @return An #AzureIoTResult_t with the result of the operation.
+ */
+AzureIoTResult_t AzureIoTADUClient_SendAgentStateCompact( AzureIoTADUClient_t const* pxAzureIoTADUClient,
+                                                          AzureIoTHubClient_t * pxAzureIoTHubClient,
+                                                          AzureIoTADUClientDeviceProperties_t const* pxDeviceProperties,
+                                                          AzureIoTADUUpdateRequestCompact_t const* pxAduUpdateRequest,
+                                                          AzureIoTADUAgentState_t xAgentState,
+                                                          AzureIoTADUClientInstallResult_t const* pxUpdateResults,
+                                                          uint8_t * pucBuffer,
+                                                          uint32_t ulBufferSize,
+                                                          uint32_t * pulRequestId );
+
 #endif /* AZURE_IOT_ADU_CLIENT_H */
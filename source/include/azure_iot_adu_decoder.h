@@ -0,0 +1,61 @@
+/* Copyright (c) Microsoft Corporation.
+ * Licensed under the MIT License. */
+
+/**
+ * @file azure_iot_adu_decoder.h
+ *
+ * @brief Interface of the streaming decoders run by the ADU download engine.
+ *
+ * A decoder sits between the range requests and the flash writes of AzureIoTADUDownload_t, for
+ * example to download a compressed image. #azure_iot_adu_heatshrink.h is a reference implementation.
+ */
+#ifndef AZURE_IOT_ADU_DECODER_H
+#define AZURE_IOT_ADU_DECODER_H
+
+#include <stdint.h>
+
+#include "azure_iot_result.h"
+
+/**
+ * @brief Reset the decoder to the start of a new stream.
+ *
+ * @param[in] pvDecoderContext The decoder context of #AzureIoTADUDecoderInterface_t.
+ * @return An #AzureIoTResult_t with the result of the operation.
+ */
+typedef AzureIoTResult_t ( * AzureIoTADUDecoderReset_t )( void * pvDecoderContext );
+
+/**
+ * @brief Decode the next bytes of the stream.
+ *
+ * The decoder consumes input until \p pucOutput is full or the input runs out, and keeps any state it
+ * needs to continue with the next call. It is called again with the rest of the input, if any, as long as
+ * it fills \p pucOutput completely.
+ *
+ * @param[in] pvDecoderContext The decoder context of #AzureIoTADUDecoderInterface_t.
+ * @param[in] pucInput The next bytes of the encoded stream.
+ * @param[in] ulInputLength The length of \p pucInput.
+ * @param[out] pulInputConsumed The number of bytes of \p pucInput consumed.
+ * @param[out] pucOutput The buffer to decode into.
+ * @param[in] ulOutputLength The length of \p pucOutput.
+ * @param[out] pulOutputProduced The number of bytes decoded into \p pucOutput.
+ * @return An #AzureIoTResult_t with the result of the operation.
+ */
+typedef AzureIoTResult_t ( * AzureIoTADUDecoderDecode_t )( void * pvDecoderContext,
+                                                           const uint8_t * pucInput,
+                                                           uint32_t ulInputLength,
+                                                           uint32_t * pulInputConsumed,
+                                                           uint8_t * pucOutput,
+                                                           uint32_t ulOutputLength,
+                                                           uint32_t * pulOutputProduced );
+
+/**
+ * @brief The decoder interface.
+ */
+typedef struct AzureIoTADUDecoderInterface
+{
+    void * pvDecoderContext;           /**< The context passed to the decoder functions. */
+    AzureIoTADUDecoderReset_t xReset;  /**< The reset function. */
+    AzureIoTADUDecoderDecode_t xDecode; /**< The decode function. */
+} AzureIoTADUDecoderInterface_t;
+
+#endif /* AZURE_IOT_ADU_DECODER_H */
@@ -0,0 +1,513 @@
+/* Copyright (c) Microsoft Corporation.
+ * Licensed under the MIT License. */
+
+/**
+ * @file azure_iot_adu_download.h
+ *
+ * @brief Download engine for Azure Device Update images.
+ *
+ * Downloads a file referenced by an ADU update request with back to back HTTP range requests
+ * on a kept alive connection, and writes it to flash through the flash platform interface.
+ *
+ * @note You MUST NOT use any symbols (macros, functions, structures, enums, etc.)
+ * prefixed with an underscore ('_') directly in your application code. These symbols
+ * are part of Azure SDK's internal implementation; we do not document these symbols
+ * and they are subject to change in future versions of the SDK which would break your code.
+ */
+#ifndef AZURE_IOT_ADU_DOWNLOAD_H
+#define AZURE_IOT_ADU_DOWNLOAD_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "azure_iot.h"
+#include "azure_iot_result.h"
+#include "azure_iot_hub_client.h"
+#include "azure_iot_http.h"
+#include "azure_iot_flash_platform.h"
+#include "azure_iot_crypto.h"
+#include "azure_iot_adu_patch.h"
+#include "azure_iot_adu_decoder.h"
+#include "azure_iot_adu_flash_writer.h"
+
+/**
+ * @brief Number of chunk buffers used by the download engine.
+ */
+#define azureiotaduDOWNLOAD_BUFFER_COUNT    ( 2U )
+
+/**
+ * @brief Maximum number of chunk sizes an adaptive download chooses from.
+ *
+ * The sizes are the minimum chunk size passed to AzureIoTADUDownload_SetAdaptiveChunkSize()
+ * multiplied by successive powers of two, up to the chunk size passed to AzureIoTADUDownload_Init().
+ */
+#define azureiotaduDOWNLOAD_ADAPTIVE_LEVEL_COUNT    ( 8U )
+
+/**
+ * @brief Size of the buffer to pass to AzureIoTADUDownload_Init() to download \p ulChunkSize bytes per request.
+ */
+#define azureiotaduDOWNLOAD_BUFFER_SIZE( ulChunkSize )         \
+    ( azureiotconfigADU_DOWNLOAD_REQUEST_HEADER_MAX +          \
+      azureiotaduDOWNLOAD_BUFFER_COUNT *                       \
+      ( ( ulChunkSize ) + azureiotconfigADU_DOWNLOAD_RESPONSE_HEADER_MAX ) )
+
+/**
+ * @brief Stream covered by the hash of AzureIoTADUDownload_GetSHA256() when a decoder is set.
+ */
+typedef enum AzureIoTADUDownloadHash
+{
+    eAzureIoTADUDownloadHashDownloaded = 0, /**< The file as downloaded, before decoding. */
+    eAzureIoTADUDownloadHashDecoded         /**< The output of the decoder. */
+} AzureIoTADUDownloadHash_t;
+
+/**
+ * @brief Throughput statistics of a download.
+ */
+typedef struct AzureIoTADUDownloadStats
+{
+    uint32_t ulBytesDownloaded;     /**< Number of bytes received from the server. */
+    uint32_t ulBytesWritten;        /**< Number of bytes written to flash. */
+    uint32_t ulRequestCount;        /**< Number of range requests issued. */
+    uint32_t ulFetchMilliseconds;   /**< Time spent waiting on range requests. */
+    uint32_t ulWriteMilliseconds;   /**< Time spent writing to flash. */
+    uint32_t ulElapsedMilliseconds; /**< Time since AzureIoTADUDownload_Start(). */
+    uint32_t ulBytesPerSecond;      /**< Overall goodput, from start to the last byte written. */
+    uint32_t ulResumeOffset;        /**< Offset the download resumed from, `0` if it started over. */
+    uint32_t ulRequestErrorCount;   /**< Number of range requests that failed. */
+    uint32_t ulChunkSize;           /**< Size of the next range request. */
+    uint32_t ulBytesDecoded;        /**< Number of bytes output by the decoder, if one is set. */
+} AzureIoTADUDownloadStats_t;
+
+/**
+ * @brief Progress of a download, saved with AzureIoTPlatform_SaveCheckpoint().
+ */
+typedef struct AzureIoTADUDownloadCheckpoint
+{
+    uint32_t ulVersion;                                                    /**< Layout version of the checkpoint. */
+    uint32_t ulFileSize;                                                   /**< Size of the file being downloaded. */
+    uint32_t ulOffset;                                                     /**< Number of bytes written to flash. */
+    uint32_t ulFileIdLength;                                               /**< Length of ucFileId. */
+    uint32_t ulFileHashLength;                                             /**< Length of ucFileHash. */
+    uint8_t ucFileId[ azureiotconfigADU_DOWNLOAD_CHECKPOINT_FILE_ID_MAX ]; /**< File ID from the update manifest. */
+    uint8_t ucFileHash[ azureiotconfigADU_DOWNLOAD_CHECKPOINT_HASH_MAX ];  /**< File hash from the update manifest. */
+    uint32_t ulSHA256Layout;                                               /**< #azureiotcryptoSHA256_CONTEXT_LAYOUT of the saved contexts. */
+    AzureIoTCryptoSHA256Context_t xSHA256Context;                          /**< SHA256 of the first ulOffset bytes, not finished. */
+    AzureIoTADUPatchState_t xPatchState;                                   /**< Progress of the patch, if the file is a patch. */
+} AzureIoTADUDownloadCheckpoint_t;
+
+/**
+ * @brief The ADU download engine.
+ */
+typedef struct AzureIoTADUDownload
+{
+    struct
+    {
+        AzureIoTHTTPHandle_t xHTTPHandle;
+        AzureIoTTransportInterface_t * pxHTTPTransport;
+        AzureIoTTransportConnect_t xConnect;
+        void * pvConnectContext;
+        AzureADUImage_t * pxImage;
+
+        const char * pucURL;
+        uint32_t ulURLLength;
+        const char * pucPath;
+        uint32_t ulPathLength;
+
+        char * pucHeaderBuffer;
+        uint32_t ulHeaderBufferLength;
+        char * pucBuffers[ azureiotaduDOWNLOAD_BUFFER_COUNT ];
+        uint32_t ulBufferLength;
+        uint32_t ulChunkSize;
+        uint32_t ulMaxChunkSize;
+
+        /* Streamed requests write the body as it is received, in Fetch. */
+        bool xStreaming;
+        uint32_t ulStreamRangeLength;
+        uint32_t ulStreamLength;
+        AzureIoTResult_t xStreamResult;
+
+        /* Range already requested ahead by a pipelined streamed request, none when ulPipelinedLength is 0. */
+        bool xPipelining;
+        uint32_t ulPipelinedOffset;
+        uint32_t ulPipelinedLength;
+
+        /* Adaptive chunk size, disabled when ulMinChunkSize is 0. */
+        uint32_t ulMinChunkSize;
+        uint32_t ulChunkLevel;
+        uint32_t ulChunkLevelCount;
+        uint32_t ulLevelBytesPerSecond[ azureiotaduDOWNLOAD_ADAPTIVE_LEVEL_COUNT ];
+        uint32_t ulWindowRequests;
+        uint32_t ulWindowBytes;
+        uint32_t ulWindowMilliseconds;
+        uint32_t ulStableWindows;
+
+        /* Chunks fetched and not yet written. Fetch only updates ulFetchCount
+         * and Commit only updates ulCommitCount, so they can run on different tasks. */
+        char * pucChunkData[ azureiotaduDOWNLOAD_BUFFER_COUNT ];
+        uint32_t ulChunkLength[ azureiotaduDOWNLOAD_BUFFER_COUNT ];
+        uint32_t ulChunkOffset[ azureiotaduDOWNLOAD_BUFFER_COUNT ];
+        volatile uint32_t ulFetchCount;
+        volatile uint32_t ulCommitCount;
+
+        uint32_t ulFileSize;
+        uint32_t ulRequestOffset;
+        uint32_t ulWriteOffset;
+
+        AzureIoTADUPatch_t * pxPatch;
+
+        const AzureIoTADUDecoderInterface_t * pxDecoder;
+        uint8_t * pucDecodeBuffer;
+        uint32_t ulDecodeBufferLength;
+        AzureIoTADUDownloadHash_t xHash;
+        uint32_t ulOutputOffset;
+
+        AzureIoTADUFlashWriter_t * pxWriter;
+
+        /* Time slicing, disabled when ulSliceMilliseconds is 0. ulSliceBytesPerSecond is
+         * measured on the last range request, 0 until one completed. */
+        uint32_t ulSliceMilliseconds;
+        uint32_t ulSliceBytesPerSecond;
+        uint32_t ulStepsPerHubProcess;
+        uint32_t ulHubProcessMilliseconds;
+
+        /* Consecutive failed range requests of ProcessLoop, and when to request the range again. */
+        uint32_t ulRetryCount;
+        uint32_t ulRetryTimeMs;
+
+        uint32_t ulCheckpointInterval;
+        AzureIoTADUDownloadCheckpoint_t xCheckpoint; /* Also holds the running SHA256 of the written bytes. */
+        uint8_t ucSHA256[ azureiotcryptoSHA256_SIZE ];
+        bool xSHA256Ready;
+
+        uint32_t ulStartTimeMs;
+        uint32_t ulEndTimeMs;
+        AzureIoTADUDownloadStats_t xStats;
+    } _internal; /**< @brief Internal to the SDK */
+} AzureIoTADUDownload_t;
+
+/**
+ * @brief Initialize the ADU download engine.
+ *
+ * The buffer is split into a request header area and #azureiotaduDOWNLOAD_BUFFER_COUNT chunk buffers.
+ * Use #azureiotaduDOWNLOAD_BUFFER_SIZE to size it.
+ *
+ * @param[out] pxDownload The #AzureIoTADUDownload_t * to use for this call.
+ * @param[in] xHTTPHandle The #AzureIoTHTTPHandle_t to download with.
+ * @param[in] pxImage The #AzureADUImage_t to write the downloaded file to.
+ * @param[in] pucBuffer The buffer used for requests and responses.
+ * @param[in] ulBufferLength The length of \p pucBuffer.
+ * @param[in] ulChunkSize The number of bytes to request per range request.
+ * @return An #AzureIoTResult_t with the result of the operation.
+ */
+AzureIoTResult_t AzureIoTADUDownload_Init( AzureIoTADUDownload_t * pxDownload,
+                                           AzureIoTHTTPHandle_t xHTTPHandle,
+                                           AzureADUImage_t * pxImage,
+                                           uint8_t * pucBuffer,
+                                           uint32_t ulBufferLength,
+                                           uint32_t ulChunkSize );
+
+/**
+ * @brief Enable checkpointing of the downloads.
+ *
+ * The progress of the download is saved with AzureIoTPlatform_SaveCheckpoint() every \p ulInterval bytes
+ * written. AzureIoTADUDownload_Start() then resumes a download of the same file, identified by its ID
+ * and hash, with a range request from the last saved offset. The image must only be erased when
+ * #AzureIoTADUDownloadStats_t.ulResumeOffset is `0`.
+ *
+ * @param[in] pxDownload The #AzureIoTADUDownload_t * to use for this call.
+ * @param[in] pucFileId The ID of the file in the update manifest.
+ * @param[in] ulFileIdLength The length of \p pucFileId.
+ * @param[in] pucFileHash The hash of the file in the update manifest.
+ * @param[in] ulFileHashLength The length of \p pucFileHash.
+ * @param[in] ulInterval The number of bytes written between checkpoints. If `0`, #azureiotconfigADU_DOWNLOAD_CHECKPOINT_INTERVAL is used.
+ * @return An #AzureIoTResult_t with the result of the operation.
+ */
+AzureIoTResult_t AzureIoTADUDownload_SetCheckpoint( AzureIoTADUDownload_t * pxDownload,
+                                                    const uint8_t * pucFileId,
+                                                    uint32_t ulFileIdLength,
+                                                    const uint8_t * pucFileHash,
+                                                    uint32_t ulFileHashLength,
+                                                    uint32_t ulInterval );
+
+/**
+ * @brief Let the download adapt the size of the range requests to the link.
+ *
+ * Each chunk size is used for #azureiotconfigADU_DOWNLOAD_ADAPTIVE_WINDOW requests, and its goodput
+ * (bytes received over the time of the requests, failed ones included) is measured. The download then
+ * moves to the next larger size until the goodput stops improving, or to the next smaller one when
+ * it is better. Larger chunks amortize the request overhead on fast links, smaller chunks lose less
+ * time on failures on lossy links. Downloads start with \p ulMinChunkSize.
+ *
+ * @param[in] pxDownload The #AzureIoTADUDownload_t * to use for this call.
+ * @param[in] ulMinChunkSize The smallest number of bytes to request per range request. The largest
+ * is the chunk size passed to AzureIoTADUDownload_Init(), which the buffer is sized for.
+ * @return An #AzureIoTResult_t with the result of the operation.
+ */
+AzureIoTResult_t AzureIoTADUDownload_SetAdaptiveChunkSize( AzureIoTADUDownload_t * pxDownload,
+                                                           uint32_t ulMinChunkSize );
+
+/**
+ * @brief Apply the downloaded file as a patch instead of writing it to flash.
+ *
+ * The chunks are passed to AzureIoTADUPatch_Write(), which writes the new image. The progress of
+ * the patch is part of the download checkpoint, so a patched download also resumes after a reset.
+ * AzureIoTADUDownload_GetSHA256() still covers the downloaded patch, verify the new image with
+ * AzureIoTADUPatch_VerifySHA256().
+ *
+ * @param[in] pxDownload The #AzureIoTADUDownload_t * to use for this call.
+ * @param[in] pxPatch The initialized #AzureIoTADUPatch_t to apply the file with, or `NULL` to write the file as is.
+ * @return An #AzureIoTResult_t with the result of the operation.
+ */
+AzureIoTResult_t AzureIoTADUDownload_SetPatch( AzureIoTADUDownload_t * pxDownload,
+                                               AzureIoTADUPatch_t * pxPatch );
+
+/**
+ * @brief Decode the downloaded file before it is written to flash or to the patch.
+ *
+ * Each received chunk is passed to the decoder, and its output is written as it is produced, in blocks
+ * of at most \p ulBufferLength bytes. The decoder state is not part of the download checkpoint, so
+ * checkpoints are neither saved nor loaded while a decoder is set.
+ *
+ * @param[in] pxDownload The #AzureIoTADUDownload_t * to use for this call.
+ * @param[in] pxDecoder The #AzureIoTADUDecoderInterface_t to decode with, or `NULL` to write the file as is.
+ * It must remain valid until the download is complete.
+ * @param[in] pucBuffer The buffer to decode into.
+ * @param[in] ulBufferLength The length of \p pucBuffer.
+ * @param[in] xHash The stream covered by AzureIoTADUDownload_GetSHA256(), the one the update manifest hash is for.
+ * @return An #AzureIoTResult_t with the result of the operation.
+ */
+AzureIoTResult_t AzureIoTADUDownload_SetDecoder( AzureIoTADUDownload_t * pxDownload,
+                                                 const AzureIoTADUDecoderInterface_t * pxDecoder,
+                                                 uint8_t * pucBuffer,
+                                                 uint32_t ulBufferLength,
+                                                 AzureIoTADUDownloadHash_t xHash );
+
+/**
+ * @brief Stream the body of the range requests straight to flash.
+ *
+ * The body is handed to the download as it is received with AzureIoTHTTP_RequestStream(), and written
+ * (or decoded, or applied as a patch) from the receive buffer, so the chunk size is no longer limited by
+ * the buffer passed to AzureIoTADUDownload_Init(): the whole buffer receives fragments of a chunk instead
+ * of holding it. Writing then happens in AzureIoTADUDownload_Fetch(), one chunk at a time, and
+ * AzureIoTADUDownload_Commit() only records the progress.
+ *
+ * Call it before AzureIoTADUDownload_SetAdaptiveChunkSize(), which adapts up to \p ulChunkSize.
+ *
+ * @param[in] pxDownload The #AzureIoTADUDownload_t * to use for this call.
+ * @param[in] ulChunkSize The number of bytes to request per range request, or `0` to stop streaming
+ * and go back to the largest chunk the buffer holds.
+ * @return An #AzureIoTResult_t with the result of the operation.
+ */
+AzureIoTResult_t AzureIoTADUDownload_SetStreaming( AzureIoTADUDownload_t * pxDownload,
+                                                   uint32_t ulChunkSize );
+
+/**
+ * @brief Request the next range while the current one is still being received.
+ *
+ * With streaming enabled by AzureIoTADUDownload_SetStreaming(), each range request pipelines the
+ * request for the next range with AzureIoTHTTP_SetNextRange(), so consecutive ranges arrive back to
+ * back instead of one round trip apart. This matters on high latency links, where round trips rather
+ * than bandwidth bound the download time. The server must support HTTP/1.1 pipelining; if it closes
+ * the connection instead, set a reconnect function with AzureIoTADUDownload_SetConnect().
+ *
+ * @param[in] pxDownload The #AzureIoTADUDownload_t * to use for this call.
+ * @param[in] xEnable `true` to pipeline streamed requests.
+ * @return An #AzureIoTResult_t with the result of the operation.
+ */
+AzureIoTResult_t AzureIoTADUDownload_SetPipelining( AzureIoTADUDownload_t * pxDownload,
+                                                    bool xEnable );
+
+/**
+ * @brief Write to flash through a flash writer, in aligned whole pages.
+ *
+ * Chunks and decoder or patch output rarely end on a page boundary, so without a writer the flash
+ * platform reprograms the page they share. With a writer, the written bytes are gathered into aligned
+ * whole pages, and the writer is flushed before each checkpoint is saved and when the download completes.
+ * Each flush for a checkpoint writes a partial page unless the chunk size and the checkpoint interval are
+ * multiples of the page size. The writer is also set on the patch of AzureIoTADUDownload_SetPatch(), if any,
+ * by AzureIoTADUDownload_Start().
+ *
+ * @param[in] pxDownload The #AzureIoTADUDownload_t * to use for this call.
+ * @param[in] pxWriter The initialized #AzureIoTADUFlashWriter_t to write through, or `NULL` to call
+ * AzureIoTPlatform_WriteBlock() directly.
+ * @return An #AzureIoTResult_t with the result of the operation.
+ */
+AzureIoTResult_t AzureIoTADUDownload_SetFlashWriter( AzureIoTADUDownload_t * pxDownload,
+                                                     AzureIoTADUFlashWriter_t * pxWriter );
+
+/**
+ * @brief Bound the time taken by each step of the download.
+ *
+ * A range request blocks the task until its response is received, for a time proportional to the chunk
+ * size. With a time slice, each range request is limited to the bytes the link delivered in \p ulSliceMilliseconds
+ * on the previous request, and never less than #azureiotconfigADU_DOWNLOAD_TIME_SLICE_MIN_CHUNK bytes. Each call
+ * to AzureIoTADUDownload_Process() then returns after about one slice, plus the time to write the chunk,
+ * and the task can run the hub client in between, see AzureIoTADUDownload_ProcessLoop().
+ *
+ * The slice caps the chunk size chosen by AzureIoTADUDownload_SetAdaptiveChunkSize() and AzureIoTADUDownload_SetStreaming().
+ * Slices shorter than the round trip of the link make every request #azureiotconfigADU_DOWNLOAD_TIME_SLICE_MIN_CHUNK
+ * bytes long.
+ *
+ * @param[in] pxDownload The #AzureIoTADUDownload_t * to use for this call.
+ * @param[in] ulSliceMilliseconds The time each range request should take, or `0` to use the whole chunk size.
+ * @return An #AzureIoTResult_t with the result of the operation.
+ */
+AzureIoTResult_t AzureIoTADUDownload_SetTimeSlice( AzureIoTADUDownload_t * pxDownload,
+                                                   uint32_t ulSliceMilliseconds );
+
+/**
+ * @brief Set how AzureIoTADUDownload_ProcessLoop() shares the task between the download and the hub client.
+ *
+ * The hub client is processed for \p ulHubProcessMilliseconds every \p ulStepsPerHubProcess download steps.
+ * With one step per hub process, commands and keep-alives wait at most one step, about one time slice;
+ * more steps give the download more of the task. The default is one step and `0` milliseconds, which
+ * only handles what the hub client already received.
+ *
+ * @param[in] pxDownload The #AzureIoTADUDownload_t * to use for this call.
+ * @param[in] ulStepsPerHubProcess The number of download steps between two calls to AzureIoTHubClient_ProcessLoop(). Must be at least `1`.
+ * @param[in] ulHubProcessMilliseconds The timeout passed to AzureIoTHubClient_ProcessLoop().
+ * @return An #AzureIoTResult_t with the result of the operation.
+ */
+AzureIoTResult_t AzureIoTADUDownload_SetPriority( AzureIoTADUDownload_t * pxDownload,
+                                                  uint32_t ulStepsPerHubProcess,
+                                                  uint32_t ulHubProcessMilliseconds );
+
+/**
+ * @brief Reconnect the HTTP transport when the server closes the connection.
+ *
+ * AzureIoTADUDownload_Start() passes \p xConnect to AzureIoTHTTP_InitConnection() with the transport it
+ * is given. The HTTP client then calls it when the server closes the connection between range requests,
+ * and sends the request again once.
+ *
+ * @param[in] pxDownload The #AzureIoTADUDownload_t * to use for this call.
+ * @param[in] xConnect The function reconnecting the transport passed to AzureIoTADUDownload_Start(), or `NULL`.
+ * @param[in] pvConnectContext The context passed to \p xConnect.
+ * @return An #AzureIoTResult_t with the result of the operation.
+ */
+AzureIoTResult_t AzureIoTADUDownload_SetConnect( AzureIoTADUDownload_t * pxDownload,
+                                                 AzureIoTTransportConnect_t xConnect,
+                                                 void * pvConnectContext );
+
+/**
+ * @brief Start downloading a file.
+ *
+ * @note \p pucURL and \p pucPath must remain valid until the download is complete.
+ *
+ * @param[in] pxDownload The #AzureIoTADUDownload_t * to use for this call.
+ * @param[in] pxHTTPTransport The #AzureIoTTransportInterface_t connected to \p pucURL.
+ * @param[in] pucURL The host of the file to download.
+ * @param[in] ulURLLength The length of \p pucURL.
+ * @param[in] pucPath The path of the file to download.
+ * @param[in] ulPathLength The length of \p pucPath.
+ * @param[in] ulFileSize The size of the file, as found in the update manifest. If `0`, the size is requested from the server.
+ * @return An #AzureIoTResult_t with the result of the operation.
+ */
+AzureIoTResult_t AzureIoTADUDownload_Start( AzureIoTADUDownload_t * pxDownload,
+                                            AzureIoTTransportInterface_t * pxHTTPTransport,
+                                            const char * pucURL,
+                                            uint32_t ulURLLength,
+                                            const char * pucPath,
+                                            uint32_t ulPathLength,
+                                            uint32_t ulFileSize );
+
+/**
+ * @brief Receive the next chunk of the file into a free chunk buffer.
+ *
+ * AzureIoTADUDownload_Fetch() and AzureIoTADUDownload_Commit() may be called from two different tasks,
+ * so that a chunk is written to flash while the next one is being received.
+ *
+ * @param[in] pxDownload The #AzureIoTADUDownload_t * to use for this call.
+ * @return An #AzureIoTResult_t with the result of the operation.
+ *      - eAzureIoTSuccess a chunk was received, or the whole file was already requested.
+ *      - eAzureIoTErrorOutOfMemory no chunk buffer is free, AzureIoTADUDownload_Commit() must be called first.
+ *      - eAzureIoTErrorFailed the range request failed. When streaming, the part received before the failure
+ *        is kept and the next request continues after it.
+ *      - eAzureIoTErrorInitFailed the request could not be set up, AzureIoTHTTP_InitNextRequest() failed. Nothing was sent.
+ *      - When streaming, any error returned by AzureIoTADUDownload_Commit() for a write.
+ */
+AzureIoTResult_t AzureIoTADUDownload_Fetch( AzureIoTADUDownload_t * pxDownload );
+
+/**
+ * @brief Write the oldest received chunk to flash.
+ *
+ * @param[in] pxDownload The #AzureIoTADUDownload_t * to use for this call.
+ * @return An #AzureIoTResult_t with the result of the operation.
+ *      - eAzureIoTSuccess the whole file is written.
+ *      - eAzureIoTErrorPending the file is not completely written yet.
+ *      - Any error returned by AzureIoTPlatform_WriteBlock(), by AzureIoTADUPatch_Write() for a patch,
+ *        or by the decoder.
+ */
+AzureIoTResult_t AzureIoTADUDownload_Commit( AzureIoTADUDownload_t * pxDownload );
+
+/**
+ * @brief Run one fetch and one commit step of the download from a single task.
+ *
+ * On a single task network and flash accesses are serialized. To overlap them, call
+ * AzureIoTADUDownload_Fetch() and AzureIoTADUDownload_Commit() from separate tasks instead.
+ *
+ * @param[in] pxDownload The #AzureIoTADUDownload_t * to use for this call.
+ * @return An #AzureIoTResult_t with the result of the operation.
+ *      - eAzureIoTSuccess the whole file is downloaded and written.
+ *      - eAzureIoTErrorPending the download is still in progress.
+ *      - Any other value is an error.
+ */
+AzureIoTResult_t AzureIoTADUDownload_Process( AzureIoTADUDownload_t * pxDownload );
+
+/**
+ * @brief Run the download and a hub client on the same task for up to \p ulTimeoutMilliseconds.
+ *
+ * Alternates AzureIoTHubClient_ProcessLoop() and AzureIoTADUDownload_Process() as set with
+ * AzureIoTADUDownload_SetPriority(), starting with the hub client, so the connection is kept alive
+ * and commands are handled during the download. Set a time slice with AzureIoTADUDownload_SetTimeSlice()
+ * to bound how long they wait. The loop returns after the step during which the timeout expires.
+ *
+ * A failed range request does not end the loop, the range is requested again after
+ * #azureiotconfigADU_DOWNLOAD_RETRY_DELAY_MS, doubled with each consecutive failure, and continues from
+ * where the failed request ended. The hub client is processed while waiting. After
+ * #azureiotconfigADU_DOWNLOAD_RETRY_MAX consecutive failures the loop returns the failure.
+ * #AzureIoTADUDownloadStats_t.ulRequestErrorCount counts them.
+ *
+ * @param[in] pxDownload The #AzureIoTADUDownload_t * to use for this call.
+ * @param[in] pxHubClient The connected #AzureIoTHubClient_t to process.
+ * @param[in] ulTimeoutMilliseconds The time to run the loop for.
+ * @return An #AzureIoTResult_t with the result of the operation.
+ *      - eAzureIoTSuccess the whole file is downloaded and written.
+ *      - eAzureIoTErrorPending the download is still in progress.
+ *      - eAzureIoTErrorHubClientFailed AzureIoTHubClient_ProcessLoop() failed, the hub client must reconnect.
+ *        The download can continue once it is connected again.
+ *      - eAzureIoTErrorFailed #azureiotconfigADU_DOWNLOAD_RETRY_MAX consecutive range requests failed.
+ *      - Any other value is an error of AzureIoTADUDownload_Process() which ends the download.
+ */
+AzureIoTResult_t AzureIoTADUDownload_ProcessLoop( AzureIoTADUDownload_t * pxDownload,
+                                                  AzureIoTHubClient_t * pxHubClient,
+                                                  uint32_t ulTimeoutMilliseconds );
+
+/**
+ * @brief Get the SHA256 hash of the downloaded file.
+ *
+ * The hash is calculated as the chunks are written to flash, so the image does not
+ * need to be read back to be verified. With a decoder, it covers the stream selected with
+ * AzureIoTADUDownload_SetDecoder().
+ *
+ * @param[in] pxDownload The #AzureIoTADUDownload_t * to use for this call.
+ * @param[out] pucSHA256 The buffer into which the hash will be placed.
+ * @param[in] ulSHA256Length The length of \p pucSHA256. Must be at least #azureiotcryptoSHA256_SIZE.
+ * @return An #AzureIoTResult_t with the result of the operation.
+ *      - eAzureIoTSuccess the hash was copied.
+ *      - eAzureIoTErrorPending the file is not completely written yet.
+ */
+AzureIoTResult_t AzureIoTADUDownload_GetSHA256( AzureIoTADUDownload_t * pxDownload,
+                                                uint8_t * pucSHA256,
+                                                uint32_t ulSHA256Length );
+
+/**
+ * @brief Get the throughput statistics of the current download.
+ *
+ * @param[in] pxDownload The #AzureIoTADUDownload_t * to use for this call.
+ * @param[out] pxStats The #AzureIoTADUDownloadStats_t to populate.
+ * @return An #AzureIoTResult_t with the result of the operation.
+ */
+AzureIoTResult_t AzureIoTADUDownload_GetStats( AzureIoTADUDownload_t * pxDownload,
+                                               AzureIoTADUDownloadStats_t * pxStats );
+
+#endif /* AZURE_IOT_ADU_DOWNLOAD_H */
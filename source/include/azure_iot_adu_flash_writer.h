@@ -0,0 +1,117 @@
+/* Copyright (c) Microsoft Corporation.
+ * Licensed under the MIT License. */
+
+/**
+ * @file azure_iot_adu_flash_writer.h
+ *
+ * @brief Page aligned write coalescing in front of AzureIoTPlatform_WriteBlock().
+ *
+ * Network reads and decoders produce blocks of any size at any offset. Flash programs whole pages, so
+ * a port given such blocks has to read, merge and program the same page again for each of them. The
+ * flash writer gathers the blocks in a buffer and only hands aligned whole pages to
+ * AzureIoTPlatform_WriteBlock(), never across an erase sector. Aligned blocks at least as large as
+ * the buffer are written from the caller's buffer without a copy.
+ *
+ * Two writes may still be partial pages: the first, when writing does not start on a page boundary,
+ * for example when resuming a download, up to the next page boundary, and the last, on
+ * AzureIoTADUFlashWriter_Flush().
+ *
+ * @note You MUST NOT use any symbols (macros, functions, structures, enums, etc.)
+ * prefixed with an underscore ('_') directly in your application code. These symbols
+ * are part of Azure SDK's internal implementation; we do not document these symbols
+ * and they are subject to change in future versions of the SDK which would break your code.
+ */
+#ifndef AZURE_IOT_ADU_FLASH_WRITER_H
+#define AZURE_IOT_ADU_FLASH_WRITER_H
+
+#include <stdint.h>
+
+#include "azure_iot.h"
+#include "azure_iot_result.h"
+#include "azure_iot_flash_platform.h"
+
+/**
+ * @brief The ADU flash writer.
+ */
+typedef struct AzureIoTADUFlashWriter
+{
+    struct
+    {
+        AzureADUImage_t * pxImage;
+        uint8_t * pucBuffer;
+        uint32_t ulBufferLength;
+        uint32_t ulPageSize;
+        uint32_t ulSectorSize;
+
+        uint32_t ulBufferOffset;
+        uint32_t ulBufferFill;
+        uint32_t ulWriteCount;
+    } _internal; /**< @brief Internal to the SDK */
+} AzureIoTADUFlashWriter_t;
+
+/**
+ * @brief Initialize the ADU flash writer.
+ *
+ * The page and sector sizes are read with AzureIoTPlatform_GetProgramPageSize() and
+ * AzureIoTPlatform_GetEraseSectorSize(). Only whole pages of \p pucBuffer are used, so a multiple of the
+ * page size wastes no RAM. A larger buffer makes fewer, larger writes.
+ *
+ * @param[out] pxWriter The #AzureIoTADUFlashWriter_t * to use for this call.
+ * @param[in] pxImage The #AzureADUImage_t to write to.
+ * @param[in] pucBuffer The buffer to gather pages in.
+ * @param[in] ulBufferLength The length of \p pucBuffer. Must be at least the program page size.
+ * @return An #AzureIoTResult_t with the result of the operation.
+ */
+AzureIoTResult_t AzureIoTADUFlashWriter_Init( AzureIoTADUFlashWriter_t * pxWriter,
+                                              AzureADUImage_t * pxImage,
+                                              uint8_t * pucBuffer,
+                                              uint32_t ulBufferLength );
+
+/**
+ * @brief Write a block to the image.
+ *
+ * Blocks are expected to follow each other. A block not starting where the previous one ended flushes
+ * the bytes gathered so far first.
+ *
+ * @param[in] pxWriter The #AzureIoTADUFlashWriter_t * to use for this call.
+ * @param[in] ulOffset The offset into the image of \p pucData.
+ * @param[in] pucData The data to write.
+ * @param[in] ulLength The length of \p pucData.
+ * @return An #AzureIoTResult_t with the result of the operation.
+ *      - Any error returned by AzureIoTPlatform_WriteBlock().
+ */
+AzureIoTResult_t AzureIoTADUFlashWriter_Write( AzureIoTADUFlashWriter_t * pxWriter,
+                                               uint32_t ulOffset,
+                                               const uint8_t * pucData,
+                                               uint32_t ulLength );
+
+/**
+ * @brief Write the bytes gathered so far to the image.
+ *
+ * Needed at the end of the image, and before saving anything that assumes the bytes are in flash.
+ *
+ * @param[in] pxWriter The #AzureIoTADUFlashWriter_t * to use for this call.
+ * @return An #AzureIoTResult_t with the result of the operation.
+ *      - Any error returned by AzureIoTPlatform_WriteBlock().
+ */
+AzureIoTResult_t AzureIoTADUFlashWriter_Flush( AzureIoTADUFlashWriter_t * pxWriter );
+
+/**
+ * @brief Drop the bytes gathered so far without writing them.
+ *
+ * Needed when the image is written again from a new offset, e.g. when a download is restarted.
+ *
+ * @param[in] pxWriter The #AzureIoTADUFlashWriter_t * to use for this call.
+ * @return An #AzureIoTResult_t with the result of the operation.
+ */
+AzureIoTResult_t AzureIoTADUFlashWriter_Reset( AzureIoTADUFlashWriter_t * pxWriter );
+
+/**
+ * @brief Get the number of calls made to AzureIoTPlatform_WriteBlock().
+ *
+ * @param[in] pxWriter The #AzureIoTADUFlashWriter_t * to use for this call.
+ * @return The number of writes since AzureIoTADUFlashWriter_Init().
+ */
+uint32_t AzureIoTADUFlashWriter_GetWriteCount( AzureIoTADUFlashWriter_t * pxWriter );
+
+#endif /* AZURE_IOT_ADU_FLASH_WRITER_H */
@@ -0,0 +1,113 @@
+/* Copyright (c) Microsoft Corporation.
+ * Licensed under the MIT License. */
+
+/**
+ * @file azure_iot_adu_heatshrink.h
+ *
+ * @brief Streaming heatshrink (LZSS) decoder for compressed ADU images.
+ *
+ * Decodes the output of the heatshrink encoder, for example `heatshrink -e -w 10 -l 4 image.bin image.hs`.
+ * The window and lookahead sizes used to encode must be passed to AzureIoTADUHeatshrink_Init(). The RAM
+ * used is the state below plus the window buffer of 2^window bits bytes.
+ *
+ * To decode a download, set the decoder with AzureIoTADUDownload_SetDecoder() and an
+ * #AzureIoTADUDecoderInterface_t of `{ &xHeatshrink, AzureIoTADUHeatshrink_Reset, AzureIoTADUHeatshrink_Decode }`.
+ *
+ * @note You MUST NOT use any symbols (macros, functions, structures, enums, etc.)
+ * prefixed with an underscore ('_') directly in your application code. These symbols
+ * are part of Azure SDK's internal implementation; we do not document these symbols
+ * and they are subject to change in future versions of the SDK which would break your code.
+ */
+#ifndef AZURE_IOT_ADU_HEATSHRINK_H
+#define AZURE_IOT_ADU_HEATSHRINK_H
+
+#include <stdint.h>
+
+#include "azure_iot.h"
+#include "azure_iot_result.h"
+#include "azure_iot_adu_decoder.h"
+
+/**
+ * @brief Smallest window size supported, in bits.
+ */
+#define azureiotaduHEATSHRINK_MIN_WINDOW_BITS    ( 4U )
+
+/**
+ * @brief Largest window size supported, in bits.
+ */
+#define azureiotaduHEATSHRINK_MAX_WINDOW_BITS    ( 15U )
+
+/**
+ * @brief Size of the window buffer to pass to AzureIoTADUHeatshrink_Init() for \p ucWindowBits.
+ */
+#define azureiotaduHEATSHRINK_WINDOW_SIZE( ucWindowBits )    ( 1U << ( ucWindowBits ) )
+
+/**
+ * @brief The heatshrink decoder.
+ */
+typedef struct AzureIoTADUHeatshrink
+{
+    struct
+    {
+        uint8_t * pucWindow;
+        uint8_t ucWindowBits;
+        uint8_t ucLookaheadBits;
+
+        uint8_t ucState;
+        uint8_t ucBitCount;
+        uint32_t ulBits;
+        uint16_t usHeadIndex;
+        uint16_t usBackrefIndex;
+        uint16_t usBackrefCount;
+    } _internal; /**< @brief Internal to the SDK */
+} AzureIoTADUHeatshrink_t;
+
+/**
+ * @brief Initialize the heatshrink decoder.
+ *
+ * @param[out] pxHeatshrink The #AzureIoTADUHeatshrink_t * to use for this call.
+ * @param[in] ucWindowBits The window size the stream was encoded with, `-w` of the heatshrink encoder.
+ * @param[in] ucLookaheadBits The lookahead size the stream was encoded with, `-l` of the heatshrink encoder.
+ * @param[in] pucWindow The window buffer.
+ * @param[in] ulWindowLength The length of \p pucWindow. Must be at least #azureiotaduHEATSHRINK_WINDOW_SIZE( \p ucWindowBits ).
+ * @return An #AzureIoTResult_t with the result of the operation.
+ */
+AzureIoTResult_t AzureIoTADUHeatshrink_Init( AzureIoTADUHeatshrink_t * pxHeatshrink,
+                                             uint8_t ucWindowBits,
+                                             uint8_t ucLookaheadBits,
+                                             uint8_t * pucWindow,
+                                             uint32_t ulWindowLength );
+
+/**
+ * @brief Reset the heatshrink decoder to the start of a new stream.
+ *
+ * An #AzureIoTADUDecoderReset_t.
+ *
+ * @param[in] pvHeatshrink The #AzureIoTADUHeatshrink_t * to use for this call.
+ * @return An #AzureIoTResult_t with the result of the operation.
+ */
+AzureIoTResult_t AzureIoTADUHeatshrink_Reset( void * pvHeatshrink );
+
+/**
+ * @brief Decode the next bytes of a heatshrink stream.
+ *
+ * An #AzureIoTADUDecoderDecode_t.
+ *
+ * @param[in] pvHeatshrink The #AzureIoTADUHeatshrink_t * to use for this call.
+ * @param[in] pucInput The next bytes of the compressed stream.
+ * @param[in] ulInputLength The length of \p pucInput.
+ * @param[out] pulInputConsumed The number of bytes of \p pucInput consumed.
+ * @param[out] pucOutput The buffer to decompress into.
+ * @param[in] ulOutputLength The length of \p pucOutput.
+ * @param[out] pulOutputProduced The number of bytes decompressed into \p pucOutput.
+ * @return An #AzureIoTResult_t with the result of the operation.
+ */
+AzureIoTResult_t AzureIoTADUHeatshrink_Decode( void * pvHeatshrink,
+                                               const uint8_t * pucInput,
+                                               uint32_t ulInputLength,
+                                               uint32_t * pulInputConsumed,
+                                               uint8_t * pucOutput,
+                                               uint32_t ulOutputLength,
+                                               uint32_t * pulOutputProduced );
+
+#endif /* AZURE_IOT_ADU_HEATSHRINK_H */
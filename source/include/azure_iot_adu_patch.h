@@ -0,0 +1,199 @@
+/* Copyright (c) Microsoft Corporation.
+ * Licensed under the MIT License. */
+
+/**
+ * @file azure_iot_adu_patch.h
+ *
+ * @brief Streaming binary patch applier for Azure Device Update delta images.
+ *
+ * Rebuilds the new image in the update bank from the image in the active bank and a bsdiff
+ * style patch, as the patch is received. The patch is never stored, and the RAM used is the
+ * state below plus one work buffer of a size chosen by the application.
+ *
+ * The patch starts with a #azureiotaduPATCH_HEADER_SIZE bytes header:
+ *  - the magic `AZDP`,
+ *  - the size of the old image, 32 bits little endian,
+ *  - the size of the new image, 32 bits little endian.
+ *
+ * It is followed by segments until the new image is complete. Each segment is a
+ * #azureiotaduPATCH_CONTROL_SIZE bytes control block:
+ *  - the diff length, 32 bits little endian,
+ *  - the extra length, 32 bits little endian,
+ *  - the old image adjustment, 32 bits little endian two's complement,
+ *
+ * then diff length bytes, each added to the next byte of the old image, then extra length
+ * bytes copied to the new image as is. The old image position then moves by the adjustment.
+ * The diff and the position after the adjustment must stay in the old image, as in the patches
+ * bsdiff makes, or the patch is rejected as malformed.
+ * This is the bsdiff format with its control, diff and extra streams interleaved, so it can be
+ * applied front to back. `tools/adu_patch/bsdiff_to_azdp.py` converts a patch made by bsdiff.
+ *
+ * @note You MUST NOT use any symbols (macros, functions, structures, enums, etc.)
+ * prefixed with an underscore ('_') directly in your application code. These symbols
+ * are part of Azure SDK's internal implementation; we do not document these symbols
+ * and they are subject to change in future versions of the SDK which would break your code.
+ */
+#ifndef AZURE_IOT_ADU_PATCH_H
+#define AZURE_IOT_ADU_PATCH_H
+
+#include <stdint.h>
+
+#include "azure_iot.h"
+#include "azure_iot_result.h"
+#include "azure_iot_flash_platform.h"
+#include "azure_iot_crypto.h"
+#include "azure_iot_adu_flash_writer.h"
+
+/**
+ * @brief Size of the patch header.
+ */
+#define azureiotaduPATCH_HEADER_SIZE     ( 12U )
+
+/**
+ * @brief Size of the control block of each patch segment.
+ */
+#define azureiotaduPATCH_CONTROL_SIZE    ( 12U )
+
+/**
+ * @brief Progress of a patch, saved in the download checkpoint when the patch is applied by
+ * the download engine.
+ */
+typedef struct AzureIoTADUPatchState
+{
+    uint32_t ulPhase;                                     /**< Part of the patch being received. */
+    uint32_t ulOldSize;                                   /**< Size of the old image. */
+    uint32_t ulNewSize;                                   /**< Size of the new image. */
+    uint32_t ulNewOffset;                                 /**< Number of bytes of the new image written. */
+    int32_t lOldOffset;                                   /**< Position in the old image. */
+    uint32_t ulDiffLength;                                /**< Diff bytes left in the segment. */
+    uint32_t ulExtraLength;                               /**< Extra bytes left in the segment. */
+    int32_t lOldAdjust;                                   /**< Old image adjustment of the segment. */
+    uint32_t ulPendingLength;                             /**< Length of ucPending. */
+    uint8_t ucPending[ azureiotaduPATCH_CONTROL_SIZE ];   /**< Header or control block received so far. */
+    AzureIoTCryptoSHA256Context_t xSHA256Context;         /**< SHA256 of the new image written so far, not finished. */
+} AzureIoTADUPatchState_t;
+
+/**
+ * @brief The ADU patch applier.
+ */
+typedef struct AzureIoTADUPatch
+{
+    struct
+    {
+        AzureADUImage_t * pxImage;
+        uint8_t * pucBuffer;
+        uint32_t ulBufferLength;
+        AzureIoTADUFlashWriter_t * pxWriter;
+
+        AzureIoTADUPatchState_t xState;
+    } _internal; /**< @brief Internal to the SDK */
+} AzureIoTADUPatch_t;
+
+/**
+ * @brief Initialize the ADU patch applier.
+ *
+ * The old image is read with AzureIoTPlatform_ReadActiveBlock() and the new image is written with
+ * AzureIoTPlatform_WriteBlock(), in blocks of at most \p ulBufferLength bytes.
+ *
+ * @param[out] pxPatch The #AzureIoTADUPatch_t * to use for this call.
+ * @param[in] pxImage The #AzureADUImage_t to write the new image to.
+ * @param[in] pucBuffer The work buffer.
+ * @param[in] ulBufferLength The length of \p pucBuffer.
+ * @return An #AzureIoTResult_t with the result of the operation.
+ */
+AzureIoTResult_t AzureIoTADUPatch_Init( AzureIoTADUPatch_t * pxPatch,
+                                        AzureADUImage_t * pxImage,
+                                        uint8_t * pucBuffer,
+                                        uint32_t ulBufferLength );
+
+/**
+ * @brief Write the new image through a flash writer, in aligned whole pages.
+ *
+ * The patch does not flush the writer: call AzureIoTADUFlashWriter_Flush() once the new image is complete.
+ * AzureIoTADUDownload_t sets the writer it is given with AzureIoTADUDownload_SetFlashWriter(), and flushes it.
+ *
+ * @param[in] pxPatch The #AzureIoTADUPatch_t * to use for this call.
+ * @param[in] pxWriter The #AzureIoTADUFlashWriter_t * to write through, or NULL to call AzureIoTPlatform_WriteBlock() directly.
+ * @return An #AzureIoTResult_t with the result of the operation.
+ */
+AzureIoTResult_t AzureIoTADUPatch_SetFlashWriter( AzureIoTADUPatch_t * pxPatch,
+                                                  AzureIoTADUFlashWriter_t * pxWriter );
+
+/**
+ * @brief Start applying a new patch.
+ *
+ * @param[in] pxPatch The #AzureIoTADUPatch_t * to use for this call.
+ * @return An #AzureIoTResult_t with the result of the operation.
+ */
+AzureIoTResult_t AzureIoTADUPatch_Start( AzureIoTADUPatch_t * pxPatch );
+
+/**
+ * @brief Get the progress of the patch, to resume it later with AzureIoTADUPatch_Resume().
+ *
+ * @param[in] pxPatch The #AzureIoTADUPatch_t * to use for this call.
+ * @param[out] pxState The progress of the patch.
+ * @return An #AzureIoTResult_t with the result of the operation.
+ */
+AzureIoTResult_t AzureIoTADUPatch_GetState( AzureIoTADUPatch_t * pxPatch,
+                                            AzureIoTADUPatchState_t * pxState );
+
+/**
+ * @brief Go on applying a patch from a progress got with AzureIoTADUPatch_GetState().
+ *
+ * The new image must hold the bytes written up to that progress.
+ *
+ * @param[in] pxPatch The #AzureIoTADUPatch_t * to use for this call.
+ * @param[in] pxState The progress of the patch.
+ * @return An #AzureIoTResult_t with the result of the operation.
+ */
+AzureIoTResult_t AzureIoTADUPatch_Resume( AzureIoTADUPatch_t * pxPatch,
+                                          const AzureIoTADUPatchState_t * pxState );
+
+/**
+ * @brief Apply the next bytes of the patch.
+ *
+ * The patch may be split at any position.
+ *
+ * @param[in] pxPatch The #AzureIoTADUPatch_t * to use for this call.
+ * @param[in] pucData The next bytes of the patch.
+ * @param[in] ulLength The length of \p pucData.
+ * @return An #AzureIoTResult_t with the result of the operation.
+ *      - eAzureIoTSuccess the new image is complete.
+ *      - eAzureIoTErrorPending more of the patch is needed.
+ *      - eAzureIoTErrorInvalidResponse the patch is malformed.
+ *      - Any error returned by the flash platform.
+ */
+AzureIoTResult_t AzureIoTADUPatch_Write( AzureIoTADUPatch_t * pxPatch,
+                                         const uint8_t * pucData,
+                                         uint32_t ulLength );
+
+/**
+ * @brief Get the SHA256 hash of the new image.
+ *
+ * @param[in] pxPatch The #AzureIoTADUPatch_t * to use for this call.
+ * @param[out] pucSHA256 The buffer into which the hash will be placed.
+ * @param[in] ulSHA256Length The length of \p pucSHA256. Must be at least #azureiotcryptoSHA256_SIZE.
+ * @return An #AzureIoTResult_t with the result of the operation.
+ *      - eAzureIoTSuccess the hash was copied.
+ *      - eAzureIoTErrorPending the new image is not complete yet.
+ */
+AzureIoTResult_t AzureIoTADUPatch_GetSHA256( AzureIoTADUPatch_t * pxPatch,
+                                             uint8_t * pucSHA256,
+                                             uint32_t ulSHA256Length );
+
+/**
+ * @brief Verify the new image against the hash of the update manifest.
+ *
+ * @param[in] pxPatch The #AzureIoTADUPatch_t * to use for this call.
+ * @param[in] pucHash The base64 encoded SHA256 hash, as found in #AzureIoTADUUpdateManifestFileHash_t.pucHash.
+ * @param[in] ulHashLength The length of \p pucHash.
+ * @return An #AzureIoTResult_t with the result of the operation.
+ *      - eAzureIoTSuccess the new image matches the hash.
+ *      - eAzureIoTErrorPending the new image is not complete yet.
+ *      - eAzureIoTErrorFailed the new image does not match the hash.
+ */
+AzureIoTResult_t AzureIoTADUPatch_VerifySHA256( AzureIoTADUPatch_t * pxPatch,
+                                                const uint8_t * pucHash,
+                                                uint32_t ulHashLength );
+
+#endif /* AZURE_IOT_ADU_PATCH_H */
@@ -0,0 +1,238 @@
+/* Copyright (c) Microsoft Corporation.
+ * Licensed under the MIT License. */
+
+/**
+ * @file azure_iot_cbor_reader.h
+ *
+ * @brief The CBOR (RFC 8949) reader, a binary alternative to the JSON reader.
+ *
+ * The functions are those of #AzureIoTJSONReader_t, over the tokens of the JSON data model: a map
+ * reads as an object whose keys, which must be text strings, are property names. Maps and arrays
+ * of definite or indefinite length, integers, half, single and double precision floats, text and
+ * byte strings, `true`, `false`, `null` and `undefined` (read as `null`) are read. Tags are skipped,
+ * chunked strings are not supported.
+ *
+ * Strings are never escaped in CBOR, so they are always read in place.
+ *
+ * @note You MUST NOT use any symbols (macros, functions, structures, enums, etc.)
+ * prefixed with an underscore ('_') directly in your application code. These symbols
+ * are part of Azure SDK's internal implementation; we do not document these symbols
+ * and they are subject to change in future versions of the SDK which would break your code.
+ *
+ */
+
+#ifndef AZURE_IOT_CBOR_READER_H
+#define AZURE_IOT_CBOR_READER_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "azure_iot.h"
+#include "azure_iot_result.h"
+
+/* Azure SDK for Embedded C includes */
+#include "azure/core/_az_cfg_prefix.h"
+
+/**
+ * @brief The kinds of CBOR tokens, named after their #AzureIoTJSONTokenType_t equivalent.
+ */
+typedef enum AzureIoTCBORTokenType
+{
+    eAzureIoTCBORTokenNONE = 0,
+    eAzureIoTCBORTokenBEGIN_OBJECT, /**< The beginning of a map. */
+    eAzureIoTCBORTokenEND_OBJECT,   /**< The end of a map. */
+    eAzureIoTCBORTokenBEGIN_ARRAY,
+    eAzureIoTCBORTokenEND_ARRAY,
+    eAzureIoTCBORTokenPROPERTY_NAME, /**< A key of a map. */
+    eAzureIoTCBORTokenSTRING,        /**< A text string. */
+    eAzureIoTCBORTokenBYTES,         /**< A byte string. */
+    eAzureIoTCBORTokenNUMBER,        /**< An integer or a float. */
+    eAzureIoTCBORTokenTRUE,
+    eAzureIoTCBORTokenFALSE,
+    eAzureIoTCBORTokenNULL
+} AzureIoTCBORTokenType_t;
+
+/**
+ * @brief The struct to use for Azure IoT CBOR reader functionality.
+ */
+typedef struct AzureIoTCBORReader
+{
+    struct
+    {
+        const uint8_t * pucBuffer;
+        uint32_t ulBufferSize;
+        uint32_t ulOffset;
+        AzureIoTCBORTokenType_t xTokenType;
+        const uint8_t * pucTokenString;
+        uint32_t ulTokenStringLength;
+        uint64_t ullTokenInteger;
+        double xTokenFloat;
+        bool xTokenIsNegative;
+        bool xTokenIsFloat;
+        uint8_t ucDepth;
+        uint32_t ulMapStack;
+        uint32_t ulNameStack;
+        uint32_t ulIndefiniteStack;
+        uint32_t ulItemsLeft[ azureiotconfigCBOR_READER_MAX_DEPTH ];
+    } _internal; /**< @brief Internal to the SDK */
+} AzureIoTCBORReader_t;
+
+/**
+ * @brief Initializes an #AzureIoTCBORReader_t to read the CBOR data item in the provided buffer.
+ *
+ * @param[out] pxReader A pointer to an #AzureIoTCBORReader_t instance to initialize.
+ * @param[in] pucBuffer A pointer to a buffer containing the CBOR to read.
+ * @param[in] ulBufferSize Length of buffer.
+ *
+ * @return An #AzureIoTResult_t value indicating the result of the operation.
+ * @retval eAzureIoTSuccess The #AzureIoTCBORReader_t is initialized successfully.
+ */
+AzureIoTResult_t AzureIoTCBORReader_Init( AzureIoTCBORReader_t * pxReader,
+                                          const uint8_t * pucBuffer,
+                                          uint32_t ulBufferSize );
+
+/**
+ * @brief Reads the next token in the CBOR and updates the reader state.
+ *
+ * @param[in] pxReader A pointer to an #AzureIoTCBORReader_t instance containing the CBOR to read.
+ *
+ * @return An #AzureIoTResult_t value indicating the result of the operation.
+ * @retval eAzureIoTSuccess The token was read successfully.
+ * @retval eAzureIoTErrorJSONReaderDone The data item has been read.
+ * @retval eAzureIoTErrorUnexpectedChar The CBOR is malformed, truncated or not supported.
+ * @retval eAzureIoTErrorJSONNestingOverflow More than #azureiotconfigCBOR_READER_MAX_DEPTH maps
+ * and arrays are nested.
+ */
+AzureIoTResult_t AzureIoTCBORReader_NextToken( AzureIoTCBORReader_t * pxReader );
+
+/**
+ * @brief Reads and skips over any nested CBOR elements.
+ *
+ * @note If the current token kind is a property name, the reader first moves to the property value.
+ * Then, if the token kind is start of a map or array, the reader moves to the matching end. For
+ * all other token kinds, the reader doesn't move and returns.
+ *
+ * @param[in] pxReader A pointer to an #AzureIoTCBORReader_t instance containing the CBOR to read.
+ *
+ * @return An #AzureIoTResult_t value indicating the result of the operation.
+ * @retval eAzureIoTSuccess The children of the current CBOR token are skipped successfully.
+ */
+AzureIoTResult_t AzureIoTCBORReader_SkipChildren( AzureIoTCBORReader_t * pxReader );
+
+/**
+ * @brief Gets the CBOR token's boolean.
+ *
+ * @param[in] pxReader A pointer to an #AzureIoTCBORReader_t instance.
+ * @param[out] pxValue A pointer to a variable to receive the value.
+ *
+ * @return An #AzureIoTResult_t value indicating the result of the operation.
+ * @retval eAzureIoTSuccess The boolean value is returned.
+ * @retval eAzureIoTErrorJSONInvalidState The token is not `true` or `false`.
+ */
+AzureIoTResult_t AzureIoTCBORReader_GetTokenBool( AzureIoTCBORReader_t * pxReader,
+                                                  bool * pxValue );
+
+/**
+ * @brief Gets the CBOR token's integer as an `int32_t`.
+ *
+ * @param[in] pxReader A pointer to an #AzureIoTCBORReader_t instance.
+ * @param[out] plValue A pointer to a variable to receive the value.
+ *
+ * @return An #AzureIoTResult_t value indicating the result of the operation.
+ * @retval eAzureIoTSuccess The number is returned.
+ * @retval eAzureIoTErrorJSONInvalidState The token is not a number.
+ * @retval eAzureIoTErrorUnexpectedChar The number is a float or does not fit in an `int32_t`.
+ */
+AzureIoTResult_t AzureIoTCBORReader_GetTokenInt32( AzureIoTCBORReader_t * pxReader,
+                                                   int32_t * plValue );
+
+/**
+ * @brief Gets the CBOR token's number, integer or float, as a `double`.
+ *
+ * @param[in] pxReader A pointer to an #AzureIoTCBORReader_t instance.
+ * @param[out] pxValue A pointer to a variable to receive the value.
+ *
+ * @return An #AzureIoTResult_t value indicating the result of the operation.
+ * @retval eAzureIoTSuccess The number is returned.
+ * @retval eAzureIoTErrorJSONInvalidState The token is not a number.
+ */
+AzureIoTResult_t AzureIoTCBORReader_GetTokenDouble( AzureIoTCBORReader_t * pxReader,
+                                                    double * pxValue );
+
+/**
+ * @brief Gets the CBOR token's text string, copied and NULL terminated.
+ *
+ * @param[in] pxReader A pointer to an #AzureIoTCBORReader_t instance on a string or a property name.
+ * @param[out] pucBuffer A pointer to a buffer where the string should be copied into.
+ * @param[in] ulBufferSize The maximum available space within the buffer.
+ * @param[out] pulBytesCopied The length of the string copied, without the NULL terminator.
+ *
+ * @return An #AzureIoTResult_t value indicating the result of the operation.
+ * @retval eAzureIoTSuccess The string is returned.
+ * @retval eAzureIoTErrorJSONInvalidState The token is not a string or a property name.
+ * @retval eAzureIoTErrorOutOfMemory The buffer has no room for the string and its NULL terminator.
+ */
+AzureIoTResult_t AzureIoTCBORReader_GetTokenString( AzureIoTCBORReader_t * pxReader,
+                                                    uint8_t * pucBuffer,
+                                                    uint32_t ulBufferSize,
+                                                    uint32_t * pulBytesCopied );
+
+/**
+ * @brief Gets the CBOR token's text string without copying it.
+ *
+ * @param[in] pxReader A pointer to an #AzureIoTCBORReader_t instance on a string or a property name.
+ * @param[out] ppucString The string, in the buffer the reader was initialized with. It is not NULL
+ * terminated.
+ * @param[out] pulStringLength The length of \p ppucString.
+ *
+ * @return An #AzureIoTResult_t value indicating the result of the operation.
+ * @retval eAzureIoTSuccess The string is returned.
+ * @retval eAzureIoTErrorJSONInvalidState The token is not a string or a property name.
+ */
+AzureIoTResult_t AzureIoTCBORReader_GetTokenStringView( AzureIoTCBORReader_t * pxReader,
+                                                        const uint8_t ** ppucString,
+                                                        uint32_t * pulStringLength );
+
+/**
+ * @brief Gets the CBOR token's byte string without copying it.
+ *
+ * @param[in] pxReader A pointer to an #AzureIoTCBORReader_t instance on a byte string.
+ * @param[out] ppucBytes The bytes, in the buffer the reader was initialized with.
+ * @param[out] pulBytesLength The length of \p ppucBytes.
+ *
+ * @return An #AzureIoTResult_t value indicating the result of the operation.
+ * @retval eAzureIoTSuccess The bytes are returned.
+ * @retval eAzureIoTErrorJSONInvalidState The token is not a byte string.
+ */
+AzureIoTResult_t AzureIoTCBORReader_GetTokenBytes( AzureIoTCBORReader_t * pxReader,
+                                                   const uint8_t ** ppucBytes,
+                                                   uint32_t * pulBytesLength );
+
+/**
+ * @brief Determines whether the CBOR token's text string equals the text passed.
+ *
+ * @param[in] pxReader A pointer to an #AzureIoTCBORReader_t instance.
+ * @param[in] pucExpectedText A pointer to the text to compare.
+ * @param[in] ulExpectedTextLength The length of \p pucExpectedText.
+ *
+ * @return `true` if the token is a string or a property name equal to the text, `false` otherwise.
+ */
+bool AzureIoTCBORReader_TokenIsTextEqual( AzureIoTCBORReader_t * pxReader,
+                                          const uint8_t * pucExpectedText,
+                                          uint32_t ulExpectedTextLength );
+
+/**
+ * @brief Gets the CBOR token's type.
+ *
+ * @param[in] pxReader A pointer to an #AzureIoTCBORReader_t instance.
+ * @param[out] pxTokenType The returned type of the token.
+ *
+ * @return An #AzureIoTResult_t value indicating the result of the operation.
+ * @retval eAzureIoTSuccess The token type is returned.
+ */
+AzureIoTResult_t AzureIoTCBORReader_TokenType( AzureIoTCBORReader_t * pxReader,
+                                               AzureIoTCBORTokenType_t * pxTokenType );
+
+#include "azure/core/_az_cfg_suffix.h"
+
+#endif /* AZURE_IOT_CBOR_READER_H */
@@ -0,0 +1,303 @@
+/* Copyright (c) Microsoft Corporation.
+ * Licensed under the MIT License. */
+
+/**
+ * @file azure_iot_cbor_writer.h
+ *
+ * @brief The CBOR (RFC 8949) writer, a binary alternative to the JSON writer for telemetry.
+ *
+ * The functions are those of #AzureIoTJSONWriter_t: a JSON object is written as a CBOR map with
+ * text string keys, a JSON array as a CBOR array. Maps and arrays are written with an indefinite
+ * length, so nothing needs to be counted ahead, integers and lengths with the fewest bytes, and
+ * doubles as the smallest of half, single or double precision floats holding the exact value.
+ *
+ * IoT Hub reads the body of a message as JSON only with the content type `application/json`. Send
+ * CBOR telemetry with the content type #azureiotcborCONTENT_TYPE, see
+ * AzureIoTMessage_PropertiesAppendContentType(). Routing queries can't look into a CBOR body, and
+ * twin properties stay JSON.
+ *
+ * @note You MUST NOT use any symbols (macros, functions, structures, enums, etc.)
+ * prefixed with an underscore ('_') directly in your application code. These symbols
+ * are part of Azure SDK's internal implementation; we do not document these symbols
+ * and they are subject to change in future versions of the SDK which would break your code.
+ *
+ */
+
+#ifndef AZURE_IOT_CBOR_WRITER_H
+#define AZURE_IOT_CBOR_WRITER_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "azure_iot_result.h"
+
+/* Azure SDK for Embedded C includes */
+#include "azure/core/_az_cfg_prefix.h"
+
+/**
+ * @brief The content type of a CBOR message, `application/cbor` percent-encoded for the message properties.
+ */
+#define azureiotcborCONTENT_TYPE    "application%2Fcbor"
+
+/**
+ * @brief The struct to use for Azure IoT CBOR writer functionality.
+ */
+typedef struct AzureIoTCBORWriter
+{
+    struct
+    {
+        uint8_t * pucBuffer;
+        uint32_t ulBufferSize;
+        uint32_t ulBytesUsed;
+        uint32_t ulMapStack;
+        uint8_t ucDepth;
+        bool xNeedsPropertyName;
+    } _internal; /**< @brief Internal to the SDK */
+} AzureIoTCBORWriter_t;
+
+/**
+ * @brief Initializes an #AzureIoTCBORWriter_t which writes CBOR into a buffer passed.
+ *
+ * @param[out] pxWriter A pointer to an #AzureIoTCBORWriter_t the instance to initialize.
+ * @param[in] pucBuffer A buffer pointer to which CBOR will be written.
+ * @param[in] ulBufferSize Length of buffer.
+ *
+ * @return An #AzureIoTResult_t value indicating the result of the operation.
+ * @retval eAzureIoTSuccess Successfully initialized CBOR writer.
+ */
+AzureIoTResult_t AzureIoTCBORWriter_Init( AzureIoTCBORWriter_t * pxWriter,
+                                          uint8_t * pucBuffer,
+                                          uint32_t ulBufferSize );
+
+/**
+ * @brief Appends the UTF-8 property name and value where value is int32.
+ *
+ * @param[in] pxWriter A pointer to an #AzureIoTCBORWriter_t.
+ * @param[in] pucPropertyName The UTF-8 encoded property name.
+ * @param[in] ulPropertyNameLength Length of pucPropertyName.
+ * @param[in] lValue The value to be written as a CBOR integer.
+ *
+ * @return An #AzureIoTResult_t value indicating the result of the operation.
+ * @retval eAzureIoTSuccess The property name and int32 value was appended successfully.
+ */
+AzureIoTResult_t AzureIoTCBORWriter_AppendPropertyWithInt32Value( AzureIoTCBORWriter_t * pxWriter,
+                                                                  const uint8_t * pucPropertyName,
+                                                                  uint32_t ulPropertyNameLength,
+                                                                  int32_t lValue );
+
+/**
+ * @brief Appends the UTF-8 property name and value where value is double.
+ *
+ * @param[in] pxWriter A pointer to an #AzureIoTCBORWriter_t.
+ * @param[in] pucPropertyName The UTF-8 encoded property name.
+ * @param[in] ulPropertyNameLength Length of pucPropertyName.
+ * @param[in] xValue The value to be written as a CBOR float, exactly.
+ *
+ * @return An #AzureIoTResult_t value indicating the result of the operation.
+ * @retval eAzureIoTSuccess The property name and double value was appended successfully.
+ */
+AzureIoTResult_t AzureIoTCBORWriter_AppendPropertyWithDoubleValue( AzureIoTCBORWriter_t * pxWriter,
+                                                                   const uint8_t * pucPropertyName,
+                                                                   uint32_t ulPropertyNameLength,
+                                                                   double xValue );
+
+/**
+ * @brief Appends the UTF-8 property name and value where value is boolean.
+ *
+ * @param[in] pxWriter A pointer to an #AzureIoTCBORWriter_t.
+ * @param[in] pucPropertyName The UTF-8 encoded property name.
+ * @param[in] ulPropertyNameLength Length of pucPropertyName.
+ * @param[in] xValue The value to be written as a CBOR `true` or `false`.
+ *
+ * @return An #AzureIoTResult_t value indicating the result of the operation.
+ * @retval eAzureIoTSuccess The property name and bool value was appended successfully.
+ */
+AzureIoTResult_t AzureIoTCBORWriter_AppendPropertyWithBoolValue( AzureIoTCBORWriter_t * pxWriter,
+                                                                 const uint8_t * pucPropertyName,
+                                                                 uint32_t ulPropertyNameLength,
+                                                                 bool xValue );
+
+/**
+ * @brief Appends the UTF-8 property name and value where value is a UTF-8 string.
+ *
+ * @param[in] pxWriter A pointer to an #AzureIoTCBORWriter_t.
+ * @param[in] pucPropertyName The UTF-8 encoded property name.
+ * @param[in] ulPropertyNameLength Length of pucPropertyName.
+ * @param[in] pucValue The UTF-8 encoded value to be written as a CBOR text string.
+ * @param[in] ulValueLen Length of value.
+ *
+ * @return An #AzureIoTResult_t value indicating the result of the operation.
+ * @retval eAzureIoTSuccess The property name and string value was appended successfully.
+ */
+AzureIoTResult_t AzureIoTCBORWriter_AppendPropertyWithStringValue( AzureIoTCBORWriter_t * pxWriter,
+                                                                   const uint8_t * pucPropertyName,
+                                                                   uint32_t ulPropertyNameLength,
+                                                                   const uint8_t * pucValue,
+                                                                   uint32_t ulValueLen );
+
+/**
+ * @brief Appends the UTF-8 property name and value where value is binary data.
+ *
+ * @param[in] pxWriter A pointer to an #AzureIoTCBORWriter_t.
+ * @param[in] pucPropertyName The UTF-8 encoded property name.
+ * @param[in] ulPropertyNameLength Length of pucPropertyName.
+ * @param[in] pucValue The value to be written as a CBOR byte string.
+ * @param[in] ulValueLen Length of value.
+ *
+ * @return An #AzureIoTResult_t value indicating the result of the operation.
+ * @retval eAzureIoTSuccess The property name and bytes value was appended successfully.
+ */
+AzureIoTResult_t AzureIoTCBORWriter_AppendPropertyWithBytesValue( AzureIoTCBORWriter_t * pxWriter,
+                                                                  const uint8_t * pucPropertyName,
+                                                                  uint32_t ulPropertyNameLength,
+                                                                  const uint8_t * pucValue,
+                                                                  uint32_t ulValueLen );
+
+/**
+ * @brief Returns the length of the CBOR written to the underlying buffer.
+ *
+ * @param[in] pxWriter A pointer to an #AzureIoTCBORWriter_t.
+ *
+ * @return An int32_t containing the length of CBOR built so far. Will return -1 if there was an error.
+ */
+int32_t AzureIoTCBORWriter_GetBytesUsed( AzureIoTCBORWriter_t * pxWriter );
+
+/**
+ * @brief Appends the UTF-8 text value as a CBOR text string.
+ *
+ * @param[in] pxWriter A pointer to an #AzureIoTCBORWriter_t.
+ * @param[in] pucValue The UTF-8 encoded value. It is written as is, nothing is escaped.
+ * @param[in] ulValueLen Length of value.
+ *
+ * @return An #AzureIoTResult_t value indicating the result of the operation.
+ * @retval eAzureIoTSuccess The string value was appended successfully.
+ */
+AzureIoTResult_t AzureIoTCBORWriter_AppendString( AzureIoTCBORWriter_t * pxWriter,
+                                                  const uint8_t * pucValue,
+                                                  uint32_t ulValueLen );
+
+/**
+ * @brief Appends binary data as a CBOR byte string, which JSON would need in base64.
+ *
+ * @param[in] pxWriter A pointer to an #AzureIoTCBORWriter_t.
+ * @param[in] pucValue The data. Can be `NULL` if \p ulValueLen is 0.
+ * @param[in] ulValueLen Length of data.
+ *
+ * @return An #AzureIoTResult_t value indicating the result of the operation.
+ * @retval eAzureIoTSuccess The bytes were appended successfully.
+ */
+AzureIoTResult_t AzureIoTCBORWriter_AppendBytes( AzureIoTCBORWriter_t * pxWriter,
+                                                 const uint8_t * pucValue,
+                                                 uint32_t ulValueLen );
+
+/**
+ * @brief Appends the UTF-8 property name, the key of a name/value pair of a CBOR map.
+ *
+ * @param[in] pxWriter A pointer to an #AzureIoTCBORWriter_t.
+ * @param[in] pusValue The UTF-8 encoded property name.
+ * @param[in] ulValueLen Length of name.
+ *
+ * @return An #AzureIoTResult_t value indicating the result of the operation.
+ * @retval eAzureIoTSuccess The property name was appended successfully.
+ * @retval eAzureIoTErrorJSONInvalidState The writer is not in a map, or the value of the previous
+ * property name is missing.
+ */
+AzureIoTResult_t AzureIoTCBORWriter_AppendPropertyName( AzureIoTCBORWriter_t * pxWriter,
+                                                        const uint8_t * pusValue,
+                                                        uint32_t ulValueLen );
+
+/**
+ * @brief Appends a boolean value (as a CBOR `true` or `false`).
+ *
+ * @param[in] pxWriter A pointer to an #AzureIoTCBORWriter_t.
+ * @param[in] xValue The value to be written.
+ *
+ * @return An #AzureIoTResult_t value indicating the result of the operation.
+ * @retval eAzureIoTSuccess The bool was appended successfully.
+ */
+AzureIoTResult_t AzureIoTCBORWriter_AppendBool( AzureIoTCBORWriter_t * pxWriter,
+                                                bool xValue );
+
+/**
+ * @brief Appends an `int32_t` as a CBOR integer.
+ *
+ * @param[in] pxWriter A pointer to an #AzureIoTCBORWriter_t.
+ * @param[in] lValue The value to be written.
+ *
+ * @return An #AzureIoTResult_t value indicating the result of the operation.
+ * @retval eAzureIoTSuccess The number was appended successfully.
+ */
+AzureIoTResult_t AzureIoTCBORWriter_AppendInt32( AzureIoTCBORWriter_t * pxWriter,
+                                                 int32_t lValue );
+
+/**
+ * @brief Appends a `double` as a CBOR float.
+ *
+ * The value is written exactly, in 3 bytes when a half precision float holds it (e.g. 21.5), in 5
+ * bytes when a single precision float does, and in 9 bytes otherwise (e.g. 21.37). NaN and the
+ * infinities are written too.
+ *
+ * @param[in] pxWriter A pointer to an #AzureIoTCBORWriter_t.
+ * @param[in] xValue The value to be written.
+ *
+ * @return An #AzureIoTResult_t value indicating the result of the operation.
+ * @retval eAzureIoTSuccess The number was appended successfully.
+ */
+AzureIoTResult_t AzureIoTCBORWriter_AppendDouble( AzureIoTCBORWriter_t * pxWriter,
+                                                  double xValue );
+
+/**
+ * @brief Appends the CBOR `null`.
+ *
+ * @param[in] pxWriter A pointer to an #AzureIoTCBORWriter_t.
+ *
+ * @return An #AzureIoTResult_t value indicating the result of the operation.
+ * @retval eAzureIoTSuccess `null` was appended successfully.
+ */
+AzureIoTResult_t AzureIoTCBORWriter_AppendNull( AzureIoTCBORWriter_t * pxWriter );
+
+/**
+ * @brief Appends the beginning of a CBOR map, the equivalent of a JSON object.
+ *
+ * @param[in] pxWriter A pointer to an #AzureIoTCBORWriter_t.
+ *
+ * @return An #AzureIoTResult_t value indicating the result of the operation.
+ * @retval eAzureIoTSuccess Map start was appended successfully.
+ * @retval eAzureIoTErrorJSONNestingOverflow More than 32 maps and arrays are open.
+ */
+AzureIoTResult_t AzureIoTCBORWriter_AppendBeginObject( AzureIoTCBORWriter_t * pxWriter );
+
+/**
+ * @brief Appends the beginning of a CBOR array.
+ *
+ * @param[in] pxWriter A pointer to an #AzureIoTCBORWriter_t.
+ *
+ * @return An #AzureIoTResult_t value indicating the result of the operation.
+ * @retval eAzureIoTSuccess Array start was appended successfully.
+ * @retval eAzureIoTErrorJSONNestingOverflow More than 32 maps and arrays are open.
+ */
+AzureIoTResult_t AzureIoTCBORWriter_AppendBeginArray( AzureIoTCBORWriter_t * pxWriter );
+
+/**
+ * @brief Appends the end of the current CBOR map.
+ *
+ * @param[in] pxWriter A pointer to an #AzureIoTCBORWriter_t.
+ *
+ * @return An #AzureIoTResult_t value indicating the result of the operation.
+ * @retval eAzureIoTSuccess Map end was appended successfully.
+ */
+AzureIoTResult_t AzureIoTCBORWriter_AppendEndObject( AzureIoTCBORWriter_t * pxWriter );
+
+/**
+ * @brief Appends the end of the current CBOR array.
+ *
+ * @param[in] pxWriter A pointer to an #AzureIoTCBORWriter_t.
+ *
+ * @return An #AzureIoTResult_t value indicating the result of the operation.
+ * @retval eAzureIoTSuccess Array end was appended successfully.
+ */
+AzureIoTResult_t AzureIoTCBORWriter_AppendEndArray( AzureIoTCBORWriter_t * pxWriter );
+
+#include "azure/core/_az_cfg_suffix.h"
+
+#endif /* AZURE_IOT_CBOR_WRITER_H */
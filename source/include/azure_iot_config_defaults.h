@@ -74,6 +74,150 @@
     #define azureiotconfigPROVISIONING_POLLING_INTERVAL_S    ( 3U )
 #endif
 
+/**
+ * @brief Space reserved for the HTTP request headers of an ADU download.
+ *
+ */
+#ifndef azureiotconfigADU_DOWNLOAD_REQUEST_HEADER_MAX
+    #define azureiotconfigADU_DOWNLOAD_REQUEST_HEADER_MAX    ( 512U )
+#endif
+
+/**
+ * @brief Space reserved for the HTTP response headers in each ADU download buffer.
+ *
+ * @details The body of a range response is placed right after its headers, so each of the
+ *          download buffers must hold the headers plus one chunk.
+ */
+#ifndef azureiotconfigADU_DOWNLOAD_RESPONSE_HEADER_MAX
+    #define azureiotconfigADU_DOWNLOAD_RESPONSE_HEADER_MAX    ( 512U )
+#endif
+
+/**
+ * @brief Number of range requests over which an adaptive ADU download measures the goodput
+ * of a chunk size.
+ *
+ */
+#ifndef azureiotconfigADU_DOWNLOAD_ADAPTIVE_WINDOW
+    #define azureiotconfigADU_DOWNLOAD_ADAPTIVE_WINDOW    ( 4U )
+#endif
+
+/**
+ * @brief Number of measurement windows an adaptive ADU download stays at the same chunk size
+ * before probing the next larger size again.
+ *
+ */
+#ifndef azureiotconfigADU_DOWNLOAD_ADAPTIVE_PROBE_WINDOWS
+    #define azureiotconfigADU_DOWNLOAD_ADAPTIVE_PROBE_WINDOWS    ( 8U )
+#endif
+
+/**
+ * @brief Smallest range request of an ADU download with a time slice.
+ *
+ * @details Also the size of the first request, which measures the link.
+ */
+#ifndef azureiotconfigADU_DOWNLOAD_TIME_SLICE_MIN_CHUNK
+    #define azureiotconfigADU_DOWNLOAD_TIME_SLICE_MIN_CHUNK    ( 512U )
+#endif
+
+/**
+ * @brief Number of consecutive failed range requests after which AzureIoTADUDownload_ProcessLoop()
+ * gives up and returns the failure.
+ *
+ */
+#ifndef azureiotconfigADU_DOWNLOAD_RETRY_MAX
+    #define azureiotconfigADU_DOWNLOAD_RETRY_MAX    ( 5U )
+#endif
+
+/**
+ * @brief Time AzureIoTADUDownload_ProcessLoop() waits before requesting a failed range again.
+ *
+ * @details The wait doubles with each consecutive failure, up to
+ * #azureiotconfigADU_DOWNLOAD_RETRY_DELAY_MAX_MS. The hub client is processed while waiting.
+ */
+#ifndef azureiotconfigADU_DOWNLOAD_RETRY_DELAY_MS
+    #define azureiotconfigADU_DOWNLOAD_RETRY_DELAY_MS    ( 1000U )
+#endif
+
+/**
+ * @brief Longest time AzureIoTADUDownload_ProcessLoop() waits before requesting a failed range again.
+ *
+ */
+#ifndef azureiotconfigADU_DOWNLOAD_RETRY_DELAY_MAX_MS
+    #define azureiotconfigADU_DOWNLOAD_RETRY_DELAY_MAX_MS    ( 60000U )
+#endif
+
+/**
+ * @brief Number of bytes written between two checkpoints of an ADU download.
+ *
+ */
+#ifndef azureiotconfigADU_DOWNLOAD_CHECKPOINT_INTERVAL
+    #define azureiotconfigADU_DOWNLOAD_CHECKPOINT_INTERVAL    ( 64U * 1024U )
+#endif
+
+/**
+ * @brief Maximum length of the file ID stored in an ADU download checkpoint.
+ *
+ */
+#ifndef azureiotconfigADU_DOWNLOAD_CHECKPOINT_FILE_ID_MAX
+    #define azureiotconfigADU_DOWNLOAD_CHECKPOINT_FILE_ID_MAX    ( 32U )
+#endif
+
+/**
+ * @brief Maximum length of the file hash stored in an ADU download checkpoint.
+ *
+ * @details The default fits a base64 encoded SHA256 hash.
+ */
+#ifndef azureiotconfigADU_DOWNLOAD_CHECKPOINT_HASH_MAX
+    #define azureiotconfigADU_DOWNLOAD_CHECKPOINT_HASH_MAX    ( 48U )
+#endif
+
+/**
+ * @brief Number of verified ADU signing keys remembered by the JWS port.
+ *
+ * @details A manifest signed by a remembered signing key skips the RSA verification of the
+ *          key against the root key. Set to 0 to verify the signing key of every manifest.
+ */
+#ifndef azureiotconfigJWS_SIGNING_KEY_CACHE_SIZE
+    #define azureiotconfigJWS_SIGNING_KEY_CACHE_SIZE    ( 2U )
+#endif
+
+/**
+ * @brief Maximum length of the root key id (`kid`) of a remembered ADU signing key.
+ *
+ * @details Signing keys under a root key with a longer id are not remembered.
+ */
+#ifndef azureiotconfigJWS_SIGNING_KEY_CACHE_KID_MAX
+    #define azureiotconfigJWS_SIGNING_KEY_CACHE_KID_MAX    ( 32U )
+#endif
+
+/**
+ * @brief Set to 1 when the crypto port provides an azure_iot_crypto_port.h with its own #AzureIoTCryptoSHA256Context_t.
+ *
+ * @details When 0, the incremental SHA256 functions of azure_iot_crypto.h use the context defined there.
+ *          The mbedTLS crypto port in ports/mbedTLS needs 1.
+ */
+#ifndef azureiotconfigCRYPTO_PORT_HEADER
+    #define azureiotconfigCRYPTO_PORT_HEADER    ( 0U )
+#endif
+
+/**
+ * @brief Maximum nesting of maps and arrays read by an #AzureIoTCBORReader_t.
+ *
+ * @details Each level takes 4 bytes in the reader, and there are at most 32.
+ */
+#ifndef azureiotconfigCBOR_READER_MAX_DEPTH
+    #define azureiotconfigCBOR_READER_MAX_DEPTH    ( 8U )
+#endif
+
+/**
+ * @brief Maximum number of components and properties recorded by an #AzureIoTHubClientPropertiesIndex_t.
+ *
+ * @details Each entry takes 16 bytes in the index, and there are at most 255.
+ */
+#ifndef azureiotconfigPROPERTIES_INDEX_MAX_ENTRIES
+    #define azureiotconfigPROPERTIES_INDEX_MAX_ENTRIES    ( 64U )
+#endif
+
 /**
  * @brief Macro that is called in the Azure IoT middleware library for logging "Error" level
  * messages.
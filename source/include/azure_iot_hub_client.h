@@ -17,6 +17,7 @@
 #define AZURE_IOT_HUB_CLIENT_H
 
 #include "azure_iot.h"
+#include "azure_iot_json_writer.h"
 #include "azure_iot_message.h"
 #include "azure_iot_result.h"
 
@@ -483,6 +484,45 @@ AzureIoTResult_t AzureIoTHubClient_SendPropertiesReported( AzureIoTHubClient_t *
                                                            uint32_t ulReportedPayloadLength,
                                                            uint32_t * pulRequestID );
 
+/**
+ * @brief Callback writing reported properties for AzureIoTHubClient_SendPropertiesReportedStreaming().
+ *
+ * @param[in] pxWriter The streaming #AzureIoTJSONWriter_t to write the whole JSON document with.
+ * @param[in] pvContext The context passed to AzureIoTHubClient_SendPropertiesReportedStreaming().
+ *
+ * @return #eAzureIoTSuccess if the document was written, the error returned by \p pxWriter otherwise.
+ */
+typedef AzureIoTResult_t ( * AzureIoTHubClientPropertiesWriteCallback_t )( AzureIoTJSONWriter_t * pxWriter,
+                                                                           void * pvContext );
+
+/**
+ * @brief Send reported device properties to Azure IoT Hub, written through a small buffer while they are sent.
+ *
+ * @note AzureIoTHubClient_SubscribeProperties() must be called before calling this function.
+ *
+ * The payload is never held in RAM whole. \p xWriteCallback is called twice: first to count the
+ * length of the payload, which MQTT sends ahead of it, then to write the payload, which is sent
+ * in chunks of at most \p ulBufferSize bytes. It must write the same JSON text both times.
+ *
+ * If the second pass fails or writes a different length, the MQTT packet has been partly sent
+ * and #eAzureIoTErrorHubClientFailed is returned: the connection must be closed and the hub client
+ * connected again. #eAzureIoTErrorPublishFailed means nothing was sent and the connection can be used.
+ *
+ * @param[in] pxAzureIoTHubClient The #AzureIoTHubClient_t * to use for this call.
+ * @param[in] xWriteCallback The callback writing the reported properties.
+ * @param[in] pvContext The context passed to \p xWriteCallback.
+ * @param[in] pucBuffer The buffer the JSON text is written to before it is sent.
+ * @param[in] ulBufferSize The length of \p pucBuffer, at least #azureiotjsonwriterSTREAMING_BUFFER_MIN_SIZE.
+ * @param[out] pulRequestID Pointer to request ID used to send the reported property.
+ * @return An #AzureIoTResult_t with the result of the operation.
+ */
+AzureIoTResult_t AzureIoTHubClient_SendPropertiesReportedStreaming( AzureIoTHubClient_t * pxAzureIoTHubClient,
+                                                                    AzureIoTHubClientPropertiesWriteCallback_t xWriteCallback,
+                                                                    void * pvContext,
+                                                                    uint8_t * pucBuffer,
+                                                                    uint32_t ulBufferSize,
+                                                                    uint32_t * pulRequestID );
+
 /**
  * @brief Request to get the device property document.
  *
@@ -47,6 +47,9 @@
  * to this API and AzureIoTHubClientProperties_BuilderEndComponent() using
  * \p pxJSONWriter to specify the JSON payload.
  *
+ * @note To learn the exact length of the payload before writing it, build it first with a
+ * writer from AzureIoTJSONWriter_InitCounting().
+ *
  * @param[in] pxAzureIoTHubClient The #AzureIoTHubClient_t to use for this call.
  * @param[in,out] pxJSONWriter The #AzureIoTJSONWriter_t to append the necessary characters for an IoT
  * Plug and Play component.
@@ -313,6 +316,111 @@ AzureIoTResult_t AzureIoTHubClientProperties_GetNextComponentProperty( AzureIoTH
                                                                        const uint8_t ** ppucComponentName,
                                                                        uint32_t * pulComponentNameLength );
 
+/**
+ * @brief The components and properties of a property document, see AzureIoTHubClientProperties_BuildIndex().
+ */
+typedef struct AzureIoTHubClientPropertiesIndexEntry
+{
+    uint32_t ulNameOffset;
+    uint32_t ulValueOffset;
+    uint32_t ulValueLength;
+    uint16_t usNameLength;
+    uint8_t ucComponent;
+    bool xIsComponent;
+} AzureIoTHubClientPropertiesIndexEntry_t;
+
+/**
+ * @brief The struct to use for Azure IoT Hub property document index functionality.
+ */
+typedef struct AzureIoTHubClientPropertiesIndex
+{
+    struct
+    {
+        const uint8_t * pucJSON;
+        uint32_t ulEntryCount;
+        AzureIoTHubClientPropertiesIndexEntry_t xEntries[ azureiotconfigPROPERTIES_INDEX_MAX_ENTRIES ];
+    } _internal; /**< @brief Internal to the SDK */
+} AzureIoTHubClientPropertiesIndex_t;
+
+/**
+ * @brief Records where the components and properties of a property document are, in one pass.
+ *
+ * Where each handler would scan the whole document with
+ * AzureIoTHubClientProperties_GetNextComponentProperty() to find its component, the document is
+ * read once, then AzureIoTHubClientProperties_IndexGetComponent() and
+ * AzureIoTHubClientProperties_IndexGetNextProperty() go straight to the part a handler reads.
+ * The `$version` and `__t` properties are not recorded.
+ *
+ * @note Component names must be registered as for AzureIoTHubClientProperties_GetNextComponentProperty().
+ *
+ * @param[in] pxAzureIoTHubClient The #AzureIoTHubClient_t to use for this call.
+ * @param[out] pxIndex The #AzureIoTHubClientPropertiesIndex_t to fill.
+ * @param[in] pucJSON The property document, which must stay unchanged while \p pxIndex is used.
+ * @param[in] ulJSONLength The length of \p pucJSON.
+ * @param[in] xResponseType The #AzureIoTHubMessageType_t representing the message
+ * type associated with the payload.
+ * @param[in] xPropertyType The #AzureIoTHubClientPropertyType_t to record.
+ *
+ * @pre \p xResponseType must be #eAzureIoTHubPropertiesRequestedMessage or #eAzureIoTHubPropertiesWritablePropertyMessage.
+ * If eAzureIoTHubClientReportedFromDevice is specified in \p xPropertyType,
+ * then \p xResponseType must be #eAzureIoTHubPropertiesRequestedMessage.
+ *
+ * @return An #AzureIoTResult_t value indicating the result of the operation.
+ * @retval eAzureIoTSuccess The document is indexed.
+ * @retval eAzureIoTErrorOutOfMemory The document has more than #azureiotconfigPROPERTIES_INDEX_MAX_ENTRIES
+ * components and properties.
+ */
+AzureIoTResult_t AzureIoTHubClientProperties_BuildIndex( AzureIoTHubClient_t * pxAzureIoTHubClient,
+                                                         AzureIoTHubClientPropertiesIndex_t * pxIndex,
+                                                         const uint8_t * pucJSON,
+                                                         uint32_t ulJSONLength,
+                                                         AzureIoTHubMessageType_t xResponseType,
+                                                         AzureIoTHubClientPropertyType_t xPropertyType );
+
+/**
+ * @brief Initializes a JSON reader on the object of a component recorded in an index.
+ *
+ * @param[in] pxIndex The #AzureIoTHubClientPropertiesIndex_t filled by AzureIoTHubClientProperties_BuildIndex().
+ * @param[in] pucComponentName The component name.
+ * @param[in] ulComponentNameLength The length of \p pucComponentName.
+ * @param[out] pxJSONReader The #AzureIoTJSONReader_t to initialize, before the `{` of the component.
+ *
+ * @return An #AzureIoTResult_t value indicating the result of the operation.
+ * @retval eAzureIoTSuccess The reader is initialized on the component.
+ * @retval eAzureIoTErrorItemNotFound The document has no such component.
+ */
+AzureIoTResult_t AzureIoTHubClientProperties_IndexGetComponent( AzureIoTHubClientPropertiesIndex_t * pxIndex,
+                                                                const uint8_t * pucComponentName,
+                                                                uint32_t ulComponentNameLength,
+                                                                AzureIoTJSONReader_t * pxJSONReader );
+
+/**
+ * @brief Iteratively read the properties of one component recorded in an index.
+ *
+ * Start with \p pulPosition set to 0. On success, \p ppucPropertyName is the property name as
+ * written in the document, and \p pxJSONReader is initialized on the property value alone: call
+ * AzureIoTJSONReader_NextToken() once to read it.
+ *
+ * @param[in] pxIndex The #AzureIoTHubClientPropertiesIndex_t filled by AzureIoTHubClientProperties_BuildIndex().
+ * @param[in] pucComponentName The component name, or `NULL` for the properties outside of any component.
+ * @param[in] ulComponentNameLength The length of \p pucComponentName.
+ * @param[in,out] pulPosition Where to go on from, updated for the next call.
+ * @param[out] ppucPropertyName The property name.
+ * @param[out] pulPropertyNameLength The length of \p ppucPropertyName.
+ * @param[out] pxJSONReader The #AzureIoTJSONReader_t to initialize on the property value.
+ *
+ * @return An #AzureIoTResult_t value indicating the result of the operation.
+ * @retval eAzureIoTSuccess The next property of the component is returned.
+ * @retval eAzureIoTErrorEndOfProperties If there are no more properties left for the component.
+ */
+AzureIoTResult_t AzureIoTHubClientProperties_IndexGetNextProperty( AzureIoTHubClientPropertiesIndex_t * pxIndex,
+                                                                   const uint8_t * pucComponentName,
+                                                                   uint32_t ulComponentNameLength,
+                                                                   uint32_t * pulPosition,
+                                                                   const uint8_t ** ppucPropertyName,
+                                                                   uint32_t * pulPropertyNameLength,
+                                                                   AzureIoTJSONReader_t * pxJSONReader );
+
 #include "azure/core/_az_cfg_suffix.h"
 
 #endif /*AZURE_IOT_HUB_CLIENT_PROPERTIES_H */
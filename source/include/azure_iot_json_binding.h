@@ -0,0 +1,151 @@
+/* Copyright (c) Microsoft Corporation.
+ * Licensed under the MIT License. */
+
+/**
+ * @file azure_iot_json_binding.h
+ *
+ * @brief Read JSON properties into the fields of a C struct, described by a table of bindings.
+ *
+ * Each binding gives the name of a property, the type and offset of the field it is read into, and
+ * an optional validation. Reading an object goes once over its properties: the value of each known
+ * property is converted, validated and stored, unknown properties and their children are skipped.
+ * Bitmasks, with the bit `1 << n` for the binding `n` of the table, report which fields were read
+ * and which properties had a value of the wrong type or failing the validation.
+ *
+ * @code
+ * typedef struct Thermostat
+ * {
+ *     double xTargetTemperature;
+ *     int32_t lReportInterval;
+ *     uint8_t ucMode[ 16 ];
+ * } Thermostat_t;
+ *
+ * static const AzureIoTJSONBinding_t xThermostatBindings[] =
+ * {
+ *     azureiotjsonBINDING( "targetTemperature", eAzureIoTJSONBindingDouble, Thermostat_t, xTargetTemperature, NULL ),
+ *     azureiotjsonBINDING( "reportInterval", eAzureIoTJSONBindingInt32, Thermostat_t, lReportInterval, prvIsPositive ),
+ *     azureiotjsonBINDING( "mode", eAzureIoTJSONBindingString, Thermostat_t, ucMode, NULL )
+ * };
+ *
+ * while( AzureIoTHubClientProperties_GetNextComponentProperty( &xClient, &xReader, xMessageType,
+ *                                                              eAzureIoTHubClientPropertyWritable,
+ *                                                              &pucComponentName, &ulComponentNameLength ) == eAzureIoTSuccess )
+ * {
+ *     xResult = AzureIoTJSONBinding_ReadProperty( &xReader, xThermostatBindings, 3, &xThermostat, &ulPresent, &ulInvalid );
+ * }
+ * @endcode
+ */
+#ifndef AZURE_IOT_JSON_BINDING_H
+#define AZURE_IOT_JSON_BINDING_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "azure_iot_result.h"
+#include "azure_iot_json_reader.h"
+
+/* Azure SDK for Embedded C includes */
+#include "azure/core/_az_cfg_prefix.h"
+
+/**
+ * @brief The most bindings in a table, one per bit of the bitmasks.
+ */
+#define azureiotjsonBINDING_MAX    ( 32U )
+
+/**
+ * @brief Make an #AzureIoTJSONBinding_t of the property \p pcName, a string literal, read into the
+ * field \p xMember of the struct \p xStruct.
+ */
+#define azureiotjsonBINDING( pcName, xType, xStruct, xMember, xValidate )                \
+    { ( const uint8_t * ) ( pcName ), sizeof( pcName ) - 1, ( xType ),                  \
+      ( uint32_t ) offsetof( xStruct, xMember ), ( uint32_t ) sizeof( ( ( xStruct * ) 0 )->xMember ), \
+      ( xValidate ) }
+
+/**
+ * @brief The type of the field a property is read into.
+ */
+typedef enum AzureIoTJSONBindingType
+{
+    eAzureIoTJSONBindingBool = 0, /**< A `bool`, from `true` or `false`. */
+    eAzureIoTJSONBindingInt32,    /**< An `int32_t`, from a number. */
+    eAzureIoTJSONBindingDouble,   /**< A `double`, from a number. */
+    eAzureIoTJSONBindingString    /**< A `uint8_t` array, from a string unescaped and NULL terminated. */
+} AzureIoTJSONBindingType_t;
+
+/**
+ * @brief Check a value before it is stored in its field.
+ *
+ * @param[in] pvValue The value, a pointer to a `bool`, an `int32_t`, a `double` or the NULL
+ * terminated string, depending on the type of the binding.
+ * @return `true` to store the value, `false` to report the property as invalid.
+ */
+typedef bool ( * AzureIoTJSONBindingValidate_t )( const void * pvValue );
+
+/**
+ * @brief A property and the field of a struct it is read into.
+ */
+typedef struct AzureIoTJSONBinding
+{
+    const uint8_t * pucName;                 /**< The property name, unescaped. */
+    uint32_t ulNameLength;                   /**< The length of #pucName. */
+    AzureIoTJSONBindingType_t xType;         /**< The type of the field. */
+    uint32_t ulOffset;                       /**< The offset of the field in the struct. */
+    uint32_t ulSize;                         /**< The size of the field, with the NULL terminator for strings. */
+    AzureIoTJSONBindingValidate_t xValidate; /**< The validation of the value, or `NULL`. */
+} AzureIoTJSONBinding_t;
+
+/**
+ * @brief Read the property the reader is on, if it has a binding.
+ *
+ * To call on each property returned by AzureIoTHubClientProperties_GetNextComponentProperty().
+ * The bits of the binding are set in \p pulPresent, or in \p pulInvalid, and cleared in the other.
+ * The field is only changed when the value is stored, except string fields, which are left empty
+ * when the value does not fit or fails the validation.
+ *
+ * @param[in] pxReader The #AzureIoTJSONReader_t on a property name. It is moved after the value of
+ * the property, known or not. It must be initialized with AzureIoTJSONReader_Init(): a resumable
+ * reader is rejected with eAzureIoTErrorInvalidArgument.
+ * @param[in] pxBindings The table of bindings.
+ * @param[in] ulBindingCount The number of bindings in \p pxBindings, up to #azureiotjsonBINDING_MAX.
+ * @param[out] pvStruct The struct the fields of the bindings are in.
+ * @param[in,out] pulPresent The bitmask of the fields stored.
+ * @param[in,out] pulInvalid The bitmask of the properties not stored because their value has the
+ * wrong type or fails the validation. Can be `NULL`.
+ * @return An #AzureIoTResult_t with the result of the operation.
+ * @retval eAzureIoTSuccess The property has a binding, stored or invalid.
+ * @retval eAzureIoTErrorItemNotFound The property has no binding and was skipped.
+ */
+AzureIoTResult_t AzureIoTJSONBinding_ReadProperty( AzureIoTJSONReader_t * pxReader,
+                                                   const AzureIoTJSONBinding_t * pxBindings,
+                                                   uint32_t ulBindingCount,
+                                                   void * pvStruct,
+                                                   uint32_t * pulPresent,
+                                                   uint32_t * pulInvalid );
+
+/**
+ * @brief Read all the properties of the object the reader is on, in one pass.
+ *
+ * Properties without a binding are skipped. \p pulPresent and \p pulInvalid are cleared first.
+ *
+ * @param[in] pxReader The #AzureIoTJSONReader_t on the beginning of an object. It is moved to the
+ * end of the object. It must be initialized with AzureIoTJSONReader_Init(): a resumable reader is
+ * rejected with eAzureIoTErrorInvalidArgument.
+ * @param[in] pxBindings The table of bindings.
+ * @param[in] ulBindingCount The number of bindings in \p pxBindings, up to #azureiotjsonBINDING_MAX.
+ * @param[out] pvStruct The struct the fields of the bindings are in.
+ * @param[out] pulPresent The bitmask of the fields stored.
+ * @param[out] pulInvalid The bitmask of the properties not stored because their value has the
+ * wrong type or fails the validation. Can be `NULL`.
+ * @return An #AzureIoTResult_t with the result of the operation.
+ */
+AzureIoTResult_t AzureIoTJSONBinding_ReadObject( AzureIoTJSONReader_t * pxReader,
+                                                 const AzureIoTJSONBinding_t * pxBindings,
+                                                 uint32_t ulBindingCount,
+                                                 void * pvStruct,
+                                                 uint32_t * pulPresent,
+                                                 uint32_t * pulInvalid );
+
+#include "azure/core/_az_cfg_suffix.h"
+
+#endif /* AZURE_IOT_JSON_BINDING_H */
@@ -51,6 +51,24 @@ typedef struct AzureIoTJSONReader
     struct
     {
         az_json_reader xCoreReader;
+
+        /* Resumable reading, see AzureIoTJSONReader_InitResumable() */
+        uint8_t * pucTokenBuffer;
+        uint32_t ulTokenBufferSize;
+        uint32_t ulTokenLength;
+        uint32_t ulTokenStart;
+        const uint8_t * pucFragment;
+        uint32_t ulFragmentSize;
+        uint32_t ulFragmentOffset;
+        uint64_t ullNesting;
+        uint8_t ucDepth;
+        uint8_t ucSkipDepth;
+        uint8_t ucExpect;
+        uint8_t ucScan;
+        bool xTokenCarried;
+        bool xTokenHasEscapes;
+        bool xIsLastFragment;
+        bool xSkipping;
     } _internal; /**< @brief Internal to the SDK */
 } AzureIoTJSONReader_t;
 
@@ -71,6 +89,47 @@ AzureIoTResult_t AzureIoTJSONReader_Init( AzureIoTJSONReader_t * pxReader,
                                           const uint8_t * pucBuffer,
                                           uint32_t ulBufferSize );
 
+/**
+ * @brief Initializes an #AzureIoTJSONReader_t to read JSON text which arrives in fragments.
+ *
+ * Pass each fragment with AzureIoTJSONReader_AppendFragment(), then read its tokens with
+ * AzureIoTJSONReader_NextToken() until it returns eAzureIoTErrorJSONReaderNeedMoreData. A token
+ * inside a fragment is read in place; a token split across fragments is copied into \p pucTokenBuffer,
+ * which must hold the longest such token. Either way, the token is valid until the next fragment is
+ * appended.
+ *
+ * @note The token functions of this file accept a resumable reader, but AzureIoTJSONReader_GetTokenStringInPlace()
+ * only on a token copied into \p pucTokenBuffer. Functions reading a whole
+ * document, like AzureIoTHubClientProperties_GetNextComponentProperty(), need AzureIoTJSONReader_Init().
+ *
+ * @param[out] pxReader A pointer to an #AzureIoTJSONReader_t instance to initialize.
+ * @param[in] pucTokenBuffer A buffer for the tokens split across fragments.
+ * @param[in] ulTokenBufferSize Length of \p pucTokenBuffer.
+ *
+ * @return An #AzureIoTResult_t value indicating the result of the operation.
+ * @retval eAzureIoTSuccess The #AzureIoTJSONReader_t is initialized successfully.
+ */
+AzureIoTResult_t AzureIoTJSONReader_InitResumable( AzureIoTJSONReader_t * pxReader,
+                                                   uint8_t * pucTokenBuffer,
+                                                   uint32_t ulTokenBufferSize );
+
+/**
+ * @brief Passes the next fragment of the JSON text to a resumable #AzureIoTJSONReader_t.
+ *
+ * @param[in] pxReader A pointer to an #AzureIoTJSONReader_t initialized with AzureIoTJSONReader_InitResumable().
+ * @param[in] pucFragment The fragment, which must stay unchanged until the next one is appended.
+ * @param[in] ulFragmentSize Length of \p pucFragment.
+ * @param[in] xIsLastFragment `true` when the JSON text ends with this fragment.
+ *
+ * @return An #AzureIoTResult_t value indicating the result of the operation.
+ * @retval eAzureIoTSuccess The fragment is ready to read.
+ * @retval eAzureIoTErrorJSONInvalidState The previous fragment is not read to its end, or it was the last one.
+ */
+AzureIoTResult_t AzureIoTJSONReader_AppendFragment( AzureIoTJSONReader_t * pxReader,
+                                                    const uint8_t * pucFragment,
+                                                    uint32_t ulFragmentSize,
+                                                    bool xIsLastFragment );
+
 /**
  * @brief Reads the next token in the JSON text and updates the reader state.
  *
@@ -79,6 +138,8 @@ AzureIoTResult_t AzureIoTJSONReader_Init( AzureIoTJSONReader_t * pxReader,
  *
  * @return An #AzureIoTResult_t value indicating the result of the operation.
  * @retval eAzureIoTSuccess The token was read successfully.
+ * @retval eAzureIoTErrorJSONReaderNeedMoreData A resumable reader reached the end of its fragment:
+ * append the next one and call again.
  */
 AzureIoTResult_t AzureIoTJSONReader_NextToken( AzureIoTJSONReader_t * pxReader );
 
@@ -94,6 +155,8 @@ AzureIoTResult_t AzureIoTJSONReader_NextToken( AzureIoTJSONReader_t * pxReader )
  * @remarks If the current token kind is a property name, the reader first moves to the property
  * value. Then, if the token kind is start of an object or array, the reader moves to the matching
  * end object or array. For all other token kinds, the reader doesn't move and returns eAzureIoTSuccess.
+ * When a resumable reader returns eAzureIoTErrorJSONReaderNeedMoreData, call again after appending
+ * the next fragment to finish skipping. Calling AzureIoTJSONReader_NextToken() instead abandons the skip.
  */
 AzureIoTResult_t AzureIoTJSONReader_SkipChildren( AzureIoTJSONReader_t * pxReader );
 
@@ -150,6 +213,43 @@ AzureIoTResult_t AzureIoTJSONReader_GetTokenString( AzureIoTJSONReader_t * pxRea
                                                     uint32_t ulBufferSize,
                                                     uint32_t * pusBytesCopied );
 
+/**
+ * @brief Gets the JSON token's string without copying it, when it has no escapes.
+ *
+ * @param[in] pxReader A pointer to an #AzureIoTJSONReader_t instance on a string or a property name.
+ * @param[out] ppucString The string, in the buffer the reader was initialized with.
+ * @param[out] pulStringLength The length of \p ppucString.
+ *
+ * @return An #AzureIoTResult_t value indicating the result of the operation.
+ * @retval eAzureIoTSuccess The string is returned.
+ * @retval eAzureIoTErrorFailed The string has escapes: use AzureIoTJSONReader_GetTokenString() or
+ * AzureIoTJSONReader_GetTokenStringInPlace().
+ * @retval eAzureIoTErrorJSONInvalidState The token is not a string or a property name.
+ */
+AzureIoTResult_t AzureIoTJSONReader_GetTokenStringView( AzureIoTJSONReader_t * pxReader,
+                                                        const uint8_t ** ppucString,
+                                                        uint32_t * pulStringLength );
+
+/**
+ * @brief Gets the JSON token's string without copying it, unescaping it in place if required.
+ *
+ * A string with escapes is unescaped over its escaped text, in the buffer the reader was initialized
+ * with, so that buffer MUST be writable. The reader keeps reading after the token, but the changed
+ * buffer MUST NOT be read again as JSON by another #AzureIoTJSONReader_t.
+ *
+ * @param[in] pxReader A pointer to an #AzureIoTJSONReader_t instance on a string or a property name.
+ * @param[out] ppucString The unescaped string, in the buffer the reader was initialized with.
+ * @param[out] pulStringLength The length of \p ppucString.
+ *
+ * @return An #AzureIoTResult_t value indicating the result of the operation.
+ * @retval eAzureIoTSuccess The string is returned.
+ * @retval eAzureIoTErrorJSONInvalidState The token is not a string or a property name, or a resumable
+ * reader reads it in place in a fragment, which is never written: use AzureIoTJSONReader_GetTokenString().
+ */
+AzureIoTResult_t AzureIoTJSONReader_GetTokenStringInPlace( AzureIoTJSONReader_t * pxReader,
+                                                           uint8_t ** ppucString,
+                                                           uint32_t * pulStringLength );
+
 /**
  * @brief Determines whether the unescaped JSON token value that the #AzureIoTJSONReader_t points to is
  * equal to the expected text within the provided buffer bytes by doing a case-sensitive comparison.
@@ -0,0 +1,259 @@
+/* Copyright (c) Microsoft Corporation.
+ * Licensed under the MIT License. */
+
+/**
+ * @file azure_iot_json_template.h
+ *
+ * @brief Pre-rendered JSON object for telemetry with the same properties on every message.
+ *
+ * The properties are added once, then AzureIoTJSONTemplate_Render() writes and validates the
+ * whole object with the #AzureIoTJSONWriter_t. Each value is a slot of the rendered text: setting
+ * a value of the same length as the previous one only formats it over the slot. After a value of
+ * another length, AzureIoTJSONTemplate_GetPayload() renders the object again with the
+ * #AzureIoTJSONWriter_t, once for all the values set since the last payload.
+ *
+ * @code
+ * xResult = AzureIoTJSONTemplate_Init( &xTemplate, xSlots, 2, ucBuffer, sizeof( ucBuffer ) );
+ * xResult = AzureIoTJSONTemplate_AddDoubleProperty( &xTemplate, "temperature", 11, 2, &ulTemperatureSlot );
+ * xResult = AzureIoTJSONTemplate_AddInt32Property( &xTemplate, "battery", 7, &ulBatterySlot );
+ * xResult = AzureIoTJSONTemplate_Render( &xTemplate );
+ *
+ * for( ; ; )
+ * {
+ *     xResult = AzureIoTJSONTemplate_SetDouble( &xTemplate, ulTemperatureSlot, xReadTemperature() );
+ *     xResult = AzureIoTJSONTemplate_SetInt32( &xTemplate, ulBatterySlot, lReadBattery() );
+ *     xResult = AzureIoTJSONTemplate_GetPayload( &xTemplate, &pucPayload, &ulPayloadLength );
+ *     xResult = AzureIoTHubClient_SendTelemetry( &xClient, pucPayload, ulPayloadLength, NULL, eAzureIoTHubMessageQoS1, NULL );
+ * }
+ * @endcode
+ *
+ * @note You MUST NOT use any symbols (macros, functions, structures, enums, etc.)
+ * prefixed with an underscore ('_') directly in your application code. These symbols
+ * are part of Azure SDK's internal implementation; we do not document these symbols
+ * and they are subject to change in future versions of the SDK which would break your code.
+ */
+#ifndef AZURE_IOT_JSON_TEMPLATE_H
+#define AZURE_IOT_JSON_TEMPLATE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "azure_iot_result.h"
+
+/* Azure SDK for Embedded C includes */
+#include "azure/core/_az_cfg_prefix.h"
+
+/**
+ * @brief A property of an #AzureIoTJSONTemplate_t, its value and the place of the value in the
+ * rendered text.
+ */
+typedef struct AzureIoTJSONTemplateSlot
+{
+    struct
+    {
+        const uint8_t * pucName;
+        uint32_t ulNameLength;
+        uint8_t ucType;
+        uint16_t usFractionalDigits;
+        union
+        {
+            int32_t lValue;
+            double xValue;
+            bool xBool;
+            struct
+            {
+                const uint8_t * pucValue;
+                uint32_t ulValueLength;
+            } xString;
+        } xValue;
+        uint32_t ulOffset;
+        uint32_t ulLength;
+    } _internal; /**< @brief Internal to the SDK */
+} AzureIoTJSONTemplateSlot_t;
+
+/**
+ * @brief A pre-rendered JSON object.
+ */
+typedef struct AzureIoTJSONTemplate
+{
+    struct
+    {
+        AzureIoTJSONTemplateSlot_t * pxSlots;
+        uint32_t ulSlotCount;
+        uint32_t ulSlotMax;
+        uint8_t * pucBuffer;
+        uint32_t ulBufferSize;
+        uint32_t ulLength;
+    } _internal; /**< @brief Internal to the SDK */
+} AzureIoTJSONTemplate_t;
+
+/**
+ * @brief Initialize an #AzureIoTJSONTemplate_t without properties.
+ *
+ * @note The object is rendered with the #AzureIoTJSONWriter_t, so \p pucBuffer needs its 64 bytes
+ * of slack on top of the rendered text.
+ *
+ * @param[out] pxTemplate The #AzureIoTJSONTemplate_t to initialize.
+ * @param[in] pxSlots The slots of the properties, one per property.
+ * @param[in] ulSlotMax The number of slots in \p pxSlots.
+ * @param[in] pucBuffer The buffer of the rendered text.
+ * @param[in] ulBufferSize The size of \p pucBuffer.
+ * @return An #AzureIoTResult_t with the result of the operation.
+ */
+AzureIoTResult_t AzureIoTJSONTemplate_Init( AzureIoTJSONTemplate_t * pxTemplate,
+                                            AzureIoTJSONTemplateSlot_t * pxSlots,
+                                            uint32_t ulSlotMax,
+                                            uint8_t * pucBuffer,
+                                            uint32_t ulBufferSize );
+
+/**
+ * @brief Add a property with an int32 value, 0 until set.
+ *
+ * @note The name is not copied, it must stay valid as long as \p pxTemplate is used.
+ *
+ * @param[in] pxTemplate The #AzureIoTJSONTemplate_t to add to.
+ * @param[in] pucPropertyName The UTF-8 property name, escaped when rendered.
+ * @param[in] ulPropertyNameLength The length of \p pucPropertyName.
+ * @param[out] pulSlot The slot of the property, to set its value.
+ * @return An #AzureIoTResult_t with the result of the operation.
+ * @retval eAzureIoTErrorOutOfMemory All slots are used.
+ */
+AzureIoTResult_t AzureIoTJSONTemplate_AddInt32Property( AzureIoTJSONTemplate_t * pxTemplate,
+                                                        const uint8_t * pucPropertyName,
+                                                        uint32_t ulPropertyNameLength,
+                                                        uint32_t * pulSlot );
+
+/**
+ * @brief Add a property with a double value, 0 until set.
+ *
+ * @note The name is not copied, it must stay valid as long as \p pxTemplate is used.
+ *
+ * @param[in] pxTemplate The #AzureIoTJSONTemplate_t to add to.
+ * @param[in] pucPropertyName The UTF-8 property name, escaped when rendered.
+ * @param[in] ulPropertyNameLength The length of \p pucPropertyName.
+ * @param[in] usFractionalDigits The number of digits after the decimal point of the value.
+ * @param[out] pulSlot The slot of the property, to set its value.
+ * @return An #AzureIoTResult_t with the result of the operation.
+ * @retval eAzureIoTErrorOutOfMemory All slots are used.
+ */
+AzureIoTResult_t AzureIoTJSONTemplate_AddDoubleProperty( AzureIoTJSONTemplate_t * pxTemplate,
+                                                         const uint8_t * pucPropertyName,
+                                                         uint32_t ulPropertyNameLength,
+                                                         uint16_t usFractionalDigits,
+                                                         uint32_t * pulSlot );
+
+/**
+ * @brief Add a property with a bool value, false until set.
+ *
+ * @note The name is not copied, it must stay valid as long as \p pxTemplate is used.
+ *
+ * @param[in] pxTemplate The #AzureIoTJSONTemplate_t to add to.
+ * @param[in] pucPropertyName The UTF-8 property name, escaped when rendered.
+ * @param[in] ulPropertyNameLength The length of \p pucPropertyName.
+ * @param[out] pulSlot The slot of the property, to set its value.
+ * @return An #AzureIoTResult_t with the result of the operation.
+ * @retval eAzureIoTErrorOutOfMemory All slots are used.
+ */
+AzureIoTResult_t AzureIoTJSONTemplate_AddBoolProperty( AzureIoTJSONTemplate_t * pxTemplate,
+                                                       const uint8_t * pucPropertyName,
+                                                       uint32_t ulPropertyNameLength,
+                                                       uint32_t * pulSlot );
+
+/**
+ * @brief Add a property with a string value, empty until set.
+ *
+ * @note The name is not copied, it must stay valid as long as \p pxTemplate is used.
+ *
+ * @param[in] pxTemplate The #AzureIoTJSONTemplate_t to add to.
+ * @param[in] pucPropertyName The UTF-8 property name, escaped when rendered.
+ * @param[in] ulPropertyNameLength The length of \p pucPropertyName.
+ * @param[out] pulSlot The slot of the property, to set its value.
+ * @return An #AzureIoTResult_t with the result of the operation.
+ * @retval eAzureIoTErrorOutOfMemory All slots are used.
+ */
+AzureIoTResult_t AzureIoTJSONTemplate_AddStringProperty( AzureIoTJSONTemplate_t * pxTemplate,
+                                                         const uint8_t * pucPropertyName,
+                                                         uint32_t ulPropertyNameLength,
+                                                         uint32_t * pulSlot );
+
+/**
+ * @brief Render the object with the current values.
+ *
+ * Call it once the properties are added, to validate them and write the text the values are set in.
+ * AzureIoTJSONTemplate_GetPayload() also renders the object when needed.
+ *
+ * @param[in] pxTemplate The #AzureIoTJSONTemplate_t to render.
+ * @return An #AzureIoTResult_t with the result of the operation.
+ * @retval eAzureIoTErrorOutOfMemory The object does not fit in the buffer.
+ */
+AzureIoTResult_t AzureIoTJSONTemplate_Render( AzureIoTJSONTemplate_t * pxTemplate );
+
+/**
+ * @brief Set the value of an int32 property.
+ *
+ * @param[in] pxTemplate The #AzureIoTJSONTemplate_t.
+ * @param[in] ulSlot The slot returned by AzureIoTJSONTemplate_AddInt32Property().
+ * @param[in] lValue The value.
+ * @return An #AzureIoTResult_t with the result of the operation.
+ */
+AzureIoTResult_t AzureIoTJSONTemplate_SetInt32( AzureIoTJSONTemplate_t * pxTemplate,
+                                                uint32_t ulSlot,
+                                                int32_t lValue );
+
+/**
+ * @brief Set the value of a double property.
+ *
+ * @param[in] pxTemplate The #AzureIoTJSONTemplate_t.
+ * @param[in] ulSlot The slot returned by AzureIoTJSONTemplate_AddDoubleProperty().
+ * @param[in] xValue The value, written with the fractional digits of the property.
+ * @return An #AzureIoTResult_t with the result of the operation.
+ */
+AzureIoTResult_t AzureIoTJSONTemplate_SetDouble( AzureIoTJSONTemplate_t * pxTemplate,
+                                                 uint32_t ulSlot,
+                                                 double xValue );
+
+/**
+ * @brief Set the value of a bool property.
+ *
+ * @param[in] pxTemplate The #AzureIoTJSONTemplate_t.
+ * @param[in] ulSlot The slot returned by AzureIoTJSONTemplate_AddBoolProperty().
+ * @param[in] xValue The value.
+ * @return An #AzureIoTResult_t with the result of the operation.
+ */
+AzureIoTResult_t AzureIoTJSONTemplate_SetBool( AzureIoTJSONTemplate_t * pxTemplate,
+                                               uint32_t ulSlot,
+                                               bool xValue );
+
+/**
+ * @brief Set the value of a string property.
+ *
+ * @note The value is not copied: rendering the object again, for a value of another length of any
+ * property, reads it. It must stay valid until the next value is set or the payload is taken.
+ *
+ * @param[in] pxTemplate The #AzureIoTJSONTemplate_t.
+ * @param[in] ulSlot The slot returned by AzureIoTJSONTemplate_AddStringProperty().
+ * @param[in] pucValue The UTF-8 value, escaped when written.
+ * @param[in] ulValueLength The length of \p pucValue.
+ * @return An #AzureIoTResult_t with the result of the operation.
+ */
+AzureIoTResult_t AzureIoTJSONTemplate_SetString( AzureIoTJSONTemplate_t * pxTemplate,
+                                                 uint32_t ulSlot,
+                                                 const uint8_t * pucValue,
+                                                 uint32_t ulValueLength );
+
+/**
+ * @brief Get the object with the values set, rendering it again if a value changed length.
+ *
+ * @param[in] pxTemplate The #AzureIoTJSONTemplate_t.
+ * @param[out] ppucPayload The JSON text, in the buffer of \p pxTemplate.
+ * @param[out] pulPayloadLength The length of the JSON text.
+ * @return An #AzureIoTResult_t with the result of the operation.
+ * @retval eAzureIoTErrorOutOfMemory The object does not fit in the buffer with the values set.
+ */
+AzureIoTResult_t AzureIoTJSONTemplate_GetPayload( AzureIoTJSONTemplate_t * pxTemplate,
+                                                  const uint8_t ** ppucPayload,
+                                                  uint32_t * pulPayloadLength );
+
+#include "azure/core/_az_cfg_suffix.h"
+
+#endif /* AZURE_IOT_JSON_TEMPLATE_H */
@@ -25,6 +25,24 @@
 #include "azure/core/az_json.h"
 #include "azure/core/_az_cfg_prefix.h"
 
+/**
+ * @brief The smallest buffer of a streaming #AzureIoTJSONWriter_t, see AzureIoTJSONWriter_InitStreaming().
+ */
+#define azureiotjsonwriterSTREAMING_BUFFER_MIN_SIZE    ( 64U )
+
+/**
+ * @brief Callback receiving the JSON text of a streaming #AzureIoTJSONWriter_t, chunk by chunk.
+ *
+ * @param[in] pucData The JSON text written since the previous chunk.
+ * @param[in] ulDataLength The length of \p pucData.
+ * @param[in] pvContext The context passed to AzureIoTJSONWriter_InitStreaming().
+ *
+ * @return #eAzureIoTSuccess to go on writing. Any other result fails the append, which returns it.
+ */
+typedef AzureIoTResult_t ( * AzureIoTJSONWriterFlushCallback_t )( const uint8_t * pucData,
+                                                                  uint32_t ulDataLength,
+                                                                  void * pvContext );
+
 /**
  * @brief The struct to use for Azure IoT JSON writer functionality.
  */
@@ -33,6 +51,14 @@ typedef struct AzureIoTJSONWriter
     struct
     {
         az_json_writer xCoreWriter;
+        uint8_t * pucBuffer;
+        uint32_t ulBufferSize;
+        AzureIoTJSONWriterFlushCallback_t xFlushCallback;
+        void * pvFlushContext;
+        AzureIoTResult_t xFlushResult;
+        uint32_t ulFlushedLength;
+        bool xCounting;
+        int32_t lUncopiedLength;
     } _internal; /**< @brief Internal to the SDK */
 } AzureIoTJSONWriter_t;
 
@@ -50,6 +76,60 @@ AzureIoTResult_t AzureIoTJSONWriter_Init( AzureIoTJSONWriter_t * pxWriter,
                                           uint8_t * pucBuffer,
                                           uint32_t ulBufferSize );
 
+/**
+ * @brief Initializes an #AzureIoTJSONWriter_t which writes JSON text of any length through a small buffer.
+ *
+ * When the next JSON token doesn't fit in the rest of the buffer, the writer passes the text written
+ * so far to \p xFlushCallback, then writes again from the start of the buffer. Call
+ * AzureIoTJSONWriter_Flush() once the JSON text is complete, to pass the last chunk.
+ *
+ * @note AzureIoTJSONWriter_AppendJSONText() needs its whole text to fit in the buffer.
+ *
+ * @param[out] pxWriter A pointer to an #AzureIoTJSONWriter_t the instance to initialize.
+ * @param[in] pucBuffer A buffer pointer to which JSON text will be written.
+ * @param[in] ulBufferSize Length of buffer, at least #azureiotjsonwriterSTREAMING_BUFFER_MIN_SIZE.
+ * @param[in] xFlushCallback The callback receiving the chunks of JSON text.
+ * @param[in] pvFlushContext The context passed to \p xFlushCallback.
+ *
+ * @return An #AzureIoTResult_t value indicating the result of the operation.
+ * @retval eAzureIoTSuccess Successfully initialized JSON writer.
+ */
+AzureIoTResult_t AzureIoTJSONWriter_InitStreaming( AzureIoTJSONWriter_t * pxWriter,
+                                                   uint8_t * pucBuffer,
+                                                   uint32_t ulBufferSize,
+                                                   AzureIoTJSONWriterFlushCallback_t xFlushCallback,
+                                                   void * pvFlushContext );
+
+/**
+ * @brief Initializes an #AzureIoTJSONWriter_t which only counts the length of the JSON text appended.
+ *
+ * Nothing is written: once the JSON text is complete, AzureIoTJSONWriter_GetBytesUsed() returns
+ * its exact length, to size the buffer of a writer from AzureIoTJSONWriter_Init() or to
+ * learn a payload length before sending it. The property builders of
+ * azure_iot_hub_client_properties.h accept a counting writer as well.
+ *
+ * @param[out] pxWriter A pointer to an #AzureIoTJSONWriter_t the instance to initialize.
+ * @param[in] pucBuffer A scratch buffer the writer overwrites; its content is meaningless afterwards.
+ * @param[in] ulBufferSize Length of buffer, at least #azureiotjsonwriterSTREAMING_BUFFER_MIN_SIZE.
+ *
+ * @return An #AzureIoTResult_t value indicating the result of the operation.
+ * @retval eAzureIoTSuccess Successfully initialized JSON writer.
+ */
+AzureIoTResult_t AzureIoTJSONWriter_InitCounting( AzureIoTJSONWriter_t * pxWriter,
+                                                  uint8_t * pucBuffer,
+                                                  uint32_t ulBufferSize );
+
+/**
+ * @brief Passes the JSON text not flushed yet by a streaming #AzureIoTJSONWriter_t to its flush callback.
+ *
+ * @param[in] pxWriter A pointer to an #AzureIoTJSONWriter_t initialized with AzureIoTJSONWriter_InitStreaming().
+ *
+ * @return An #AzureIoTResult_t value indicating the result of the operation.
+ * @retval eAzureIoTSuccess The JSON text was flushed, or there was nothing to flush.
+ * @retval eAzureIoTErrorInvalidArgument The writer is not streaming.
+ */
+AzureIoTResult_t AzureIoTJSONWriter_Flush( AzureIoTJSONWriter_t * pxWriter );
+
 /**
  * @brief Appends the UTF-8 property name and value where value is int32
  *
@@ -98,6 +178,63 @@ AzureIoTResult_t AzureIoTJSONWriter_AppendPropertyWithDoubleValue( AzureIoTJSONW
                                                                    double xValue,
                                                                    uint16_t usFractionalDigits );
 
+/**
+ * @brief Appends the UTF-8 property name and value where value is double, with the fewest digits
+ * that read back as the same double
+ *
+ * @note If you receive an #eAzureIoTErrorOutOfMemory result while appending data for which there is
+ * sufficient space, note that the JSON writer requires at least 64 bytes of slack within the
+ * output buffer, above the theoretical minimal space needed. The JSON writer pessimistically
+ * requires this extra space because it tries to write formatted text in chunks rather than one
+ * character at a time, whenever the input data is dynamic in size.
+ *
+ * @remark Unlike AzureIoTJSONWriter_AppendPropertyWithDoubleValue(), the value is formatted with
+ * integer operations only. Magnitudes of 1e15 or more, or less than 1e-4, use the exponent notation.
+ *
+ * @param[in] pxWriter A pointer to an #AzureIoTJSONWriter_t.
+ * @param[in] pucPropertyName The UTF-8 encoded property name of the JSON value to be written. The name is
+ * escaped before writing.
+ * @param[in] ulPropertyNameLength Length of pucPropertyName.
+ * @param[in] xValue The finite value to be written as a JSON number.
+ *
+ * @return An #AzureIoTResult_t value indicating the result of the operation.
+ * @retval eAzureIoTSuccess The property name and double value was appended successfully.
+ * @retval eAzureIoTErrorInvalidArgument \p xValue is `NAN` or an infinity.
+ */
+AzureIoTResult_t AzureIoTJSONWriter_AppendPropertyWithShortestDoubleValue( AzureIoTJSONWriter_t * pxWriter,
+                                                                           const uint8_t * pucPropertyName,
+                                                                           uint32_t ulPropertyNameLength,
+                                                                           double xValue );
+
+/**
+ * @brief Appends the UTF-8 property name and value where value is the fixed point number
+ * \p lValue / 10^\p usScale
+ *
+ * @note If you receive an #eAzureIoTErrorOutOfMemory result while appending data for which there is
+ * sufficient space, note that the JSON writer requires at least 64 bytes of slack within the
+ * output buffer, above the theoretical minimal space needed. The JSON writer pessimistically
+ * requires this extra space because it tries to write formatted text in chunks rather than one
+ * character at a time, whenever the input data is dynamic in size.
+ *
+ * @remark Non-significant trailing zeros (after the decimal point) are not written: 2150 with a
+ * scale of 2 is written as `21.5`.
+ *
+ * @param[in] pxWriter A pointer to an #AzureIoTJSONWriter_t.
+ * @param[in] pucPropertyName The UTF-8 encoded property name of the JSON value to be written. The name is
+ * escaped before writing.
+ * @param[in] ulPropertyNameLength Length of pucPropertyName.
+ * @param[in] lValue The value in units of 10^-\p usScale.
+ * @param[in] usScale The number of decimal digits of \p lValue after the decimal point, up to 15.
+ *
+ * @return An #AzureIoTResult_t value indicating the result of the operation.
+ * @retval eAzureIoTSuccess The property name and fixed point value was appended successfully.
+ */
+AzureIoTResult_t AzureIoTJSONWriter_AppendPropertyWithFixedPointValue( AzureIoTJSONWriter_t * pxWriter,
+                                                                       const uint8_t * pucPropertyName,
+                                                                       uint32_t ulPropertyNameLength,
+                                                                       int32_t lValue,
+                                                                       uint16_t usScale );
+
 /**
  * @brief Appends the UTF-8 property name and value where value is boolean
  *
@@ -150,6 +287,8 @@ AzureIoTResult_t AzureIoTJSONWriter_AppendPropertyWithStringValue( AzureIoTJSONW
 /**
  * @brief Returns the length containing the JSON text written to the underlying buffer.
  *
+ * @note For a streaming or counting writer, it is the length of all the JSON text written, flushed or not.
+ *
  * @param[in] pxWriter A pointer to an #AzureIoTJSONWriter_t.
  *
  * @return An int32_t containing the length of JSON text built so far. Will return -1 if there was an error.
@@ -296,6 +435,54 @@ AzureIoTResult_t AzureIoTJSONWriter_AppendDouble( AzureIoTJSONWriter_t * pxWrite
                                                   double xValue,
                                                   uint16_t usFractionalDigits );
 
+/**
+ * @brief Appends a `double` number value with the fewest digits that read back as the same double.
+ *
+ * @note If you receive an #eAzureIoTErrorOutOfMemory result while appending data for which there is
+ * sufficient space, note that the JSON writer requires at least 64 bytes of slack within the
+ * output buffer, above the theoretical minimal space needed. The JSON writer pessimistically
+ * requires this extra space because it tries to write formatted text in chunks rather than one
+ * character at a time, whenever the input data is dynamic in size.
+ *
+ * @remark Unlike AzureIoTJSONWriter_AppendDouble(), the value is formatted with integer operations
+ * only, which is faster on MCUs without a floating point unit, and 0.1 is written as `0.1` with no
+ * fractional digits to choose. Magnitudes of 1e15 or more, or less than 1e-4, use the exponent
+ * notation, e.g. `1e-7`.
+ *
+ * @param[in] pxWriter A pointer to an #AzureIoTJSONWriter_t.
+ * @param[in] xValue The finite value to be written as a JSON number.
+ *
+ * @return An #AzureIoTResult_t value indicating the result of the operation.
+ * @retval eAzureIoTSuccess The number was appended successfully.
+ * @retval eAzureIoTErrorInvalidArgument \p xValue is `NAN` or an infinity.
+ */
+AzureIoTResult_t AzureIoTJSONWriter_AppendShortestDouble( AzureIoTJSONWriter_t * pxWriter,
+                                                          double xValue );
+
+/**
+ * @brief Appends the fixed point number \p lValue / 10^\p usScale, e.g. a sensor reading in
+ * hundredths of a degree, without floating point operations.
+ *
+ * @note If you receive an #eAzureIoTErrorOutOfMemory result while appending data for which there is
+ * sufficient space, note that the JSON writer requires at least 64 bytes of slack within the
+ * output buffer, above the theoretical minimal space needed. The JSON writer pessimistically
+ * requires this extra space because it tries to write formatted text in chunks rather than one
+ * character at a time, whenever the input data is dynamic in size.
+ *
+ * @remark Non-significant trailing zeros (after the decimal point) are not written: 2150 with a
+ * scale of 2 is written as `21.5`.
+ *
+ * @param[in] pxWriter A pointer to an #AzureIoTJSONWriter_t.
+ * @param[in] lValue The value in units of 10^-\p usScale.
+ * @param[in] usScale The number of decimal digits of \p lValue after the decimal point, up to 15.
+ *
+ * @return An #AzureIoTResult_t value indicating the result of the operation.
+ * @retval eAzureIoTSuccess The number was appended successfully.
+ */
+AzureIoTResult_t AzureIoTJSONWriter_AppendFixedPoint( AzureIoTJSONWriter_t * pxWriter,
+                                                      int32_t lValue,
+                                                      uint16_t usScale );
+
 /**
  * @brief Appends the JSON literal `null`.
  *
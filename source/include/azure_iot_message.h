@@ -23,6 +23,11 @@
 #include "azure/iot/az_iot_hub_client_properties.h"
 #include "azure/core/_az_cfg_prefix.h"
 
+/**
+ * @brief The name of the system property with the content type of a message body.
+ */
+#define azureiotmessagePROPERTY_CONTENT_TYPE    "%24.ct"
+
 /**
  * @brief The bag of properties associated with a message.
  *
@@ -99,6 +104,22 @@ AzureIoTResult_t AzureIoTMessage_PropertiesFind( AzureIoTMessageProperties_t * p
                                                  const uint8_t ** ppucOutValue,
                                                  uint32_t * pulOutValueLength );
 
+/**
+ * @brief Append the content type of the message body, e.g. #azureiotcborCONTENT_TYPE for a body written
+ * with an #AzureIoTCBORWriter_t.
+ *
+ * IoT Hub reads a body without a content type as JSON. Find the content type of a received message
+ * with AzureIoTMessage_PropertiesFind() and #azureiotmessagePROPERTY_CONTENT_TYPE.
+ *
+ * @param[in] pxMessageProperties The #AzureIoTMessageProperties_t* to use for the operation.
+ * @param[in] pucContentType The content type, percent-encoded like other property values (`/` is `%2F`).
+ * @param[in] ulContentTypeLength The length of \p pucContentType.
+ * @return An #AzureIoTResult_t with the result of the operation.
+ */
+AzureIoTResult_t AzureIoTMessage_PropertiesAppendContentType( AzureIoTMessageProperties_t * pxMessageProperties,
+                                                              const uint8_t * pucContentType,
+                                                              uint32_t ulContentTypeLength );
+
 #include "azure/core/_az_cfg_suffix.h"
 
 #endif /* AZURE_IOT_MESSAGE_H */
@@ -45,10 +45,25 @@ typedef struct AzureIoTProvisioningClientOptions
     uint32_t ulUserAgentLength;   /**< The length of the user agent. */
 } AzureIoTProvisioningClientOptions_t;
 
+/* Forward declaration for Azure IoT Provisioning Client */
+typedef struct AzureIoTProvisioningClient AzureIoTProvisioningClient_t;
+
+/**
+ * @brief Registration callback to be invoked from AzureIoTProvisioningClient_ProcessLoop() once
+ * the registration started by AzureIoTProvisioningClient_RegisterAsync() has completed.
+ *
+ * @param[in] pxAzureProvClient The #AzureIoTProvisioningClient_t * which completed the registration.
+ * @param[in] xResult The #AzureIoTResult_t with the final result of the registration.
+ * @param[in] pvContext The context passed back to the caller.
+ */
+typedef void ( * AzureIoTProvisioningClientRegisterCallback_t ) ( AzureIoTProvisioningClient_t * pxAzureProvClient,
+                                                                  AzureIoTResult_t xResult,
+                                                                  void * pvContext );
+
 /**
  * @brief The Azure IoT Device Provisioning client
  */
-typedef struct AzureIoTProvisioningClient
+struct AzureIoTProvisioningClient
 {
     struct
     {
@@ -87,8 +102,11 @@ typedef struct AzureIoTProvisioningClient
         size_t xLastResponsePayloadLength;
         uint16_t usLastResponseTopicLength;
         az_iot_provisioning_client_register_response xRegisterResponse;
+
+        AzureIoTProvisioningClientRegisterCallback_t xRegisterCallback;
+        void * pvRegisterCallbackContext;
     } _internal; /**< @brief Internal to the SDK */
-} AzureIoTProvisioningClient_t;
+};
 
 /**
  * @brief Initialize the Azure IoT Provisioning Options with default values.
@@ -172,6 +190,47 @@ AzureIoTResult_t AzureIoTProvisioningClient_SetSymmetricKey( AzureIoTProvisionin
 AzureIoTResult_t AzureIoTProvisioningClient_Register( AzureIoTProvisioningClient_t * pxAzureProvClient,
                                                       uint32_t ulTimeoutMilliseconds );
 
+/**
+ * @brief Begin the provisioning process without blocking the calling task.
+ *
+ * This function only arms the registration workflow; no network traffic happens until
+ * AzureIoTProvisioningClient_ProcessLoop() is called. Once the registration has completed,
+ * successfully or not, \p xCallback is invoked once from AzureIoTProvisioningClient_ProcessLoop().
+ *
+ * @param[in] pxAzureProvClient The #AzureIoTProvisioningClient_t * to use for this call.
+ * @param[in] xCallback The #AzureIoTProvisioningClientRegisterCallback_t to invoke on completion. Can be `NULL`.
+ * @param[in] pvCallbackContext Context passed back to \p xCallback.
+ * @return An #AzureIoTResult_t with the result of the operation.
+ *      - eAzureIoTErrorFailed a registration is already in progress or completed on this client.
+ *      - eAzureIoTSuccess the registration workflow was started.
+ */
+AzureIoTResult_t AzureIoTProvisioningClient_RegisterAsync( AzureIoTProvisioningClient_t * pxAzureProvClient,
+                                                           AzureIoTProvisioningClientRegisterCallback_t xCallback,
+                                                           void * pvCallbackContext );
+
+/**
+ * @brief Advance the registration workflow started by AzureIoTProvisioningClient_RegisterAsync().
+ *
+ * Each call runs at most one step of the workflow and processes the MQTT receive path without waiting,
+ * so it never blocks for longer than the underlying transport calls. The time in milliseconds after which
+ * the workflow needs to be serviced again is returned in \p pulNextDeadlineMilliseconds. It is `0` if
+ * a step is ready to run, the remaining time of the service mandated retry interval while waiting to
+ * poll the registration status, and #azureiotprovisioningWAIT_FOREVER once the workflow has completed.
+ * Calling earlier than the deadline is harmless, which allows the application to wake on network activity.
+ *
+ * @param[in] pxAzureProvClient The #AzureIoTProvisioningClient_t * to use for this call.
+ * @param[out] pulNextDeadlineMilliseconds The pointer to the `uint32_t` which will be populated with the
+ * time until the next call is due. Can be `NULL`.
+ * @return An #AzureIoTResult_t with the result of the operation.
+ *      - eAzureIoTErrorPending registration is still in progess.
+ *      - eAzureIoTErrorOutOfMemory registration failed because the device is out of memory.
+ *      - eAzureIoTErrorServerError registration failed because of a server error.
+ *      - eAzureIoTErrorFailed registration failed because of an internal error.
+ *      - eAzureIoTSuccess registration is completed.
+ */
+AzureIoTResult_t AzureIoTProvisioningClient_ProcessLoop( AzureIoTProvisioningClient_t * pxAzureProvClient,
+                                                         uint32_t * pulNextDeadlineMilliseconds );
+
 /**
  * @brief After a registration has been completed, get the IoT Hub hostname and device ID.
  *
@@ -47,9 +47,13 @@ typedef enum AzureIoTResult
     eAzureIoTErrorUnexpectedChar,        /**< Input can't be successfully parsed. */
 
     /* === JSON: Error results === */
-    eAzureIoTErrorJSONInvalidState,    /**< The kind of the token being read is not compatible with the expected type of the value. */
-    eAzureIoTErrorJSONNestingOverflow, /**< The JSON depth is too large. */
-    eAzureIoTErrorJSONReaderDone       /**< No more JSON text left to process. */
+    eAzureIoTErrorJSONInvalidState,      /**< The kind of the token being read is not compatible with the expected type of the value. */
+    eAzureIoTErrorJSONNestingOverflow,   /**< The JSON depth is too large. */
+    eAzureIoTErrorJSONReaderDone,        /**< No more JSON text left to process. */
+    eAzureIoTErrorJSONReaderNeedMoreData, /**< The JSON text read so far ends before the next token does. */
+
+    /* === Core: Error results, added after the JSON ones to keep their values === */
+    eAzureIoTErrorHubClientFailed         /**< The connection of the hub client cannot be used anymore, it must reconnect. */
 } AzureIoTResult_t;
 
 #endif /* AZURE_IOT_RESULT_H */
@@ -9,11 +9,55 @@
  * Used for verifying the ADU image payload.
  *
  */
+#ifndef AZURE_IOT_CRYPTO_H
+#define AZURE_IOT_CRYPTO_H
 
 #include <stdint.h>
 
+/* AZURE_IOT_NO_CUSTOM_CONFIG allows building without a custom config, as in azure_iot.h. */
+#ifndef AZURE_IOT_NO_CUSTOM_CONFIG
+    #include "azure_iot_config.h"
+#endif
+
+#include "azure_iot_config_defaults.h"
+
 #include "azure_iot_result.h"
 
+#if azureiotconfigCRYPTO_PORT_HEADER
+    #include "azure_iot_crypto_port.h"
+#else
+
+    /**
+     * @brief Context of an incremental SHA256 calculation, for crypto ports without an azure_iot_crypto_port.h.
+     *
+     * Holds the standard SHA256 state, so any SHA256 implementation can keep its progress in it.
+     */
+    typedef struct AzureIoTCryptoSHA256Context
+    {
+        uint32_t ulState[ 8 ]; /**< Hash state words. */
+        uint64_t ullLength;    /**< Number of bytes added so far. */
+        uint8_t ucBlock[ 64 ]; /**< Bytes added since the last full block, `ullLength % 64` of them. */
+    } AzureIoTCryptoSHA256Context_t;
+
+    #define azureiotcryptoSHA256_CONTEXT_LAYOUT    ( 1U )
+#endif /* azureiotconfigCRYPTO_PORT_HEADER */
+
+/**
+ * @brief Identifies the layout of #AzureIoTCryptoSHA256Context_t.
+ *
+ * A context saved in flash, as in ADU download checkpoints, is only restored by a build with the
+ * same non-zero layout. A port sets it in azure_iot_crypto_port.h to a value that changes with its
+ * context, or leaves it 0 if the context cannot be restored after a reset.
+ */
+#ifndef azureiotcryptoSHA256_CONTEXT_LAYOUT
+    #define azureiotcryptoSHA256_CONTEXT_LAYOUT    ( 0U )
+#endif
+
+/**
+ * @brief Size of a SHA256 hash in bytes.
+ */
+#define azureiotcryptoSHA256_SIZE    ( 32U )
+
 /**
  * @brief Calculate a SHA256 hash.
  *
@@ -28,6 +72,41 @@ AzureIoTResult_t AzureIoTCrypto_SHA256Calculate( const char * pucInputPtr,
                                                  const char * pucOutputPtr,
                                                  uint64_t ulOutputSize );
 
+/**
+ * @brief Start an incremental SHA256 calculation.
+ *
+ * The #AzureIoTCryptoSHA256Context_t defined by the port must not hold pointers, so that
+ * it can be saved and restored as plain bytes, see #azureiotcryptoSHA256_CONTEXT_LAYOUT.
+ *
+ * @param[out] pxContext The #AzureIoTCryptoSHA256Context_t to initialize.
+ * @return AzureIoTResult_t
+ */
+AzureIoTResult_t AzureIoTCrypto_SHA256Init( AzureIoTCryptoSHA256Context_t * pxContext );
+
+/**
+ * @brief Add data to an incremental SHA256 calculation.
+ *
+ * @param[in] pxContext The #AzureIoTCryptoSHA256Context_t started with AzureIoTCrypto_SHA256Init().
+ * @param[in] pucInput The input to add to the calculation.
+ * @param[in] ulInputSize The size of \p pucInput.
+ * @return AzureIoTResult_t
+ */
+AzureIoTResult_t AzureIoTCrypto_SHA256Update( AzureIoTCryptoSHA256Context_t * pxContext,
+                                              const uint8_t * pucInput,
+                                              uint32_t ulInputSize );
+
+/**
+ * @brief Finish an incremental SHA256 calculation.
+ *
+ * @param[in] pxContext The #AzureIoTCryptoSHA256Context_t started with AzureIoTCrypto_SHA256Init().
+ * @param[out] pucOutput The buffer into which the hash will be placed.
+ * @param[in] ulOutputSize The length of \p pucOutput. Must be at least #azureiotcryptoSHA256_SIZE.
+ * @return AzureIoTResult_t
+ */
+AzureIoTResult_t AzureIoTCrypto_SHA256Final( AzureIoTCryptoSHA256Context_t * pxContext,
+                                             uint8_t * pucOutput,
+                                             uint32_t ulOutputSize );
+
 /**
  * @brief Verify an RS256 signed payload.
  *
@@ -53,3 +132,5 @@ AzureIoTResult_t AzureIoTCrypto_RS256Verify( const char * pucInputPtr,
                                              uint64_t ullESize,
                                              const char * pucBufferPtr,
                                              uint32_t ulBufferSize );
+
+#endif /* AZURE_IOT_CRYPTO_H */
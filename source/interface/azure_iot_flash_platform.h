@@ -30,6 +30,26 @@ AzureIoTResult_t AzureIoTPlatform_Init( AzureADUImage_t * const pxAduImage );
  */
 int64_t AzureIoTPlatform_GetSingleFlashBootBankSize();
 
+/**
+ * @brief Get the program page size of the flash holding the image.
+ *
+ * The smallest unit the flash programs in one operation. Writes of whole pages starting on a page
+ * boundary need no read-modify-write.
+ *
+ * @param pxAduImage The #AzureADUImage_t to use for this operation.
+ * @return uint32_t The page size in bytes, or 1 if any byte can be written on its own.
+ */
+uint32_t AzureIoTPlatform_GetProgramPageSize( AzureADUImage_t * const pxAduImage );
+
+/**
+ * @brief Get the erase sector size of the flash holding the image.
+ *
+ * @param pxAduImage The #AzureADUImage_t to use for this operation.
+ * @return uint32_t The sector size in bytes, a multiple of the program page size, or 1 if the flash
+ * does not need to be erased before it is written.
+ */
+uint32_t AzureIoTPlatform_GetEraseSectorSize( AzureADUImage_t * const pxAduImage );
+
 /**
  * @brief Write a block of data to the image.
  *
@@ -44,6 +64,22 @@ AzureIoTResult_t AzureIoTPlatform_WriteBlock( AzureADUImage_t * const pxAduImage
                                               uint8_t * const pData,
                                               uint32_t ulBlockSize );
 
+/**
+ * @brief Read a block of data from the image currently running, in the active bank.
+ *
+ * Used to apply delta updates, which rebuild the new image from the running one.
+ *
+ * @param pxAduImage The #AzureADUImage_t to use for this operation.
+ * @param ulOffset The offset into the running image from which to start reading.
+ * @param pData The pointer to the buffer to read into.
+ * @param ulBlockSize The length of \p pData.
+ * @return AzureIoTResult_t
+ */
+AzureIoTResult_t AzureIoTPlatform_ReadActiveBlock( AzureADUImage_t * const pxAduImage,
+                                                   uint32_t ulOffset,
+                                                   uint8_t * const pData,
+                                                   uint32_t ulBlockSize );
+
 /**
  * @brief Verify the bytes written to the image match a SHA256 hash.
  *
@@ -56,6 +92,34 @@ AzureIoTResult_t AzureIoTPlatform_VerifyImage( AzureADUImage_t * const pxAduImag
                                                uint8_t * pucSHA256Hash,
                                                uint32_t ulSHA256HashLength );
 
+/**
+ * @brief Persist the download checkpoint of the image.
+ *
+ * The checkpoint must survive a reset of the device, and is written again as the download progresses.
+ *
+ * @param pxAduImage The #AzureADUImage_t to use for this operation.
+ * @param pucCheckpoint The pointer to the checkpoint to save.
+ * @param ulCheckpointLength The length of \p pucCheckpoint.
+ * @return AzureIoTResult_t
+ */
+AzureIoTResult_t AzureIoTPlatform_SaveCheckpoint( AzureADUImage_t * const pxAduImage,
+                                                  const uint8_t * pucCheckpoint,
+                                                  uint32_t ulCheckpointLength );
+
+/**
+ * @brief Read back the download checkpoint last saved with AzureIoTPlatform_SaveCheckpoint().
+ *
+ * @param pxAduImage The #AzureADUImage_t to use for this operation.
+ * @param pucCheckpoint The pointer to the buffer to read the checkpoint into.
+ * @param ulCheckpointLength The length of \p pucCheckpoint.
+ * @return AzureIoTResult_t
+ *      - eAzureIoTSuccess the checkpoint was read.
+ *      - eAzureIoTErrorItemNotFound no checkpoint was saved.
+ */
+AzureIoTResult_t AzureIoTPlatform_LoadCheckpoint( AzureADUImage_t * const pxAduImage,
+                                                  uint8_t * pucCheckpoint,
+                                                  uint32_t ulCheckpointLength );
+
 /**
  * @brief Enable the update image.
  *
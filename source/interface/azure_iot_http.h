@@ -54,11 +54,35 @@ typedef enum AzureIoTHTTPResult
     eAzureIoTHTTPError
 } AzureIoTHTTPResult_t;
 
+/**
+ * @brief Let the Azure HTTP client reopen its connection when the server closes it.
+ *
+ * Call it after AzureIoTHTTP_Init() or AzureIoTHTTP_RequestSizeInit(), which leave the connection
+ * without reconnects. The connection is kept open between requests. When the server closes it,
+ * announced with `Connection: close` or found when a request fails before any response is received,
+ * \p xConnect is called to open a new one and the request is sent again once. Without it, requests
+ * keep going out on the same connection and such failures are returned.
+ *
+ * @param[in] xHTTPHandle The HTTP handle to use for this operation.
+ * @param[in] pxHTTPTransport The Azure IoT Transport interface passed to AzureIoTHTTP_Init().
+ * @param[in] xConnect The function reconnecting \p pxHTTPTransport, or `NULL`.
+ * @param[in] pvConnectContext The context passed to \p xConnect.
+ * @return AzureIoTHTTPResult_t
+ */
+AzureIoTHTTPResult_t AzureIoTHTTP_InitConnection( AzureIoTHTTPHandle_t xHTTPHandle,
+                                                  AzureIoTTransportInterface_t * pxHTTPTransport,
+                                                  AzureIoTTransportConnect_t xConnect,
+                                                  void * pvConnectContext );
+
 /**
  * @brief Initialize the Azure HTTP client.
  *
+ * Call it once for each new connection of \p pxHTTPTransport: the handle starts without reconnects
+ * and without any request pipelined. Use AzureIoTHTTP_InitNextRequest() for the following requests
+ * on the same connection.
+ *
  * @param[in] xHTTPHandle The HTTP handle to use for this operation.
- * @param[in] pxHTTPTransport The Azure IoT Transport interface to use for this operation.
+ * @param[in] pxHTTPTransport The connected Azure IoT Transport interface to use for the requests.
  * @param[in] pucURL The URL to use for this request.
  * @param[in] ulURLLength The length \p pucURL.
  * @param[in] pucPath The path to use for this request.
@@ -76,6 +100,18 @@ AzureIoTHTTPResult_t AzureIoTHTTP_Init( AzureIoTHTTPHandle_t xHTTPHandle,
                                         char * pucHeaderBuffer,
                                         uint32_t ulHeaderBufferLength );
 
+/**
+ * @brief Initialize the next GET request on the connection of the Azure HTTP client.
+ *
+ * The URL, path and header buffer are the ones passed to AzureIoTHTTP_Init() or
+ * AzureIoTHTTP_RequestSizeInit(). The connection, its reconnect function and any request pipelined
+ * with AzureIoTHTTP_SetNextRange() are kept.
+ *
+ * @param[in] xHTTPHandle The HTTP handle to use for this operation.
+ * @return AzureIoTHTTPResult_t
+ */
+AzureIoTHTTPResult_t AzureIoTHTTP_InitNextRequest( AzureIoTHTTPHandle_t xHTTPHandle );
+
 /**
  * @brief Send an HTTP GET request.
  *
@@ -96,11 +132,74 @@ AzureIoTHTTPResult_t AzureIoTHTTP_Request( AzureIoTHTTPHandle_t xHTTPHandle,
                                            char ** ppucOutData,
                                            uint32_t * pulOutDataLength );
 
+/**
+ * @brief Pipeline the next range request behind the next streamed one.
+ *
+ * The request for \p lRangeStart to \p lRangeEnd is sent on the same connection as soon as the
+ * headers of the next AzureIoTHTTP_RequestStream() response are received, while its body is still
+ * being received (HTTP/1.1 pipelining). The following AzureIoTHTTP_RequestStream() for that range then
+ * reads the response without waiting for a round trip. A request for any other range reconnects first.
+ *
+ * @param[in] xHTTPHandle The HTTP handle to use for this operation.
+ * @param[in] lRangeStart The start point of the next request.
+ * @param[in] lRangeEnd The end point of the next request.
+ * @return AzureIoTHTTPResult_t
+ */
+AzureIoTHTTPResult_t AzureIoTHTTP_SetNextRange( AzureIoTHTTPHandle_t xHTTPHandle,
+                                                int32_t lRangeStart,
+                                                int32_t lRangeEnd );
+
+/**
+ * @brief Callback receiving the body of a streamed response.
+ *
+ * Called with each fragment of the body, in order, as it is received. The fragment is only valid
+ * for the duration of the call.
+ *
+ * @param[in] pvCallbackContext The context passed to AzureIoTHTTP_RequestStream().
+ * @param[in] pucData The next bytes of the body.
+ * @param[in] ulDataLength The length of \p pucData.
+ * @return #eAzureIoTHTTPSuccess to continue, any other value aborts the request and is returned by
+ * AzureIoTHTTP_RequestStream().
+ */
+typedef AzureIoTHTTPResult_t ( * AzureIoTHTTPBodyCallback_t )( void * pvCallbackContext,
+                                                               const uint8_t * pucData,
+                                                               uint32_t ulDataLength );
+
+/**
+ * @brief Send an HTTP GET request and stream the response body to a callback.
+ *
+ * Unlike AzureIoTHTTP_Request(), the body does not have to fit in \p pucDataBuffer, which only needs
+ * to hold the response headers. The rest of the buffer is used to receive the body, which is passed to
+ * \p xBodyCallback as it arrives, so larger ranges can be requested with the same RAM.
+ * A partial response must have a `Content-Range` starting at \p lRangeStart, as long as its body and
+ * not past \p lRangeEnd, or #eAzureIoTHTTPInvalidResponse is returned before any of the body is passed on.
+ *
+ * @param[in] xHTTPHandle The HTTP handle to use for this operation.
+ * @param[in] lRangeStart The start point for the request payload.
+ * @param[in] lRangeEnd The end point for the request payload.
+ * @param[in] pucDataBuffer The buffer used to receive the response.
+ * @param[in] ulDataBufferLength The length of \p pucDataBuffer.
+ * @param[in] xBodyCallback The callback receiving the body.
+ * @param[in] pvCallbackContext The context passed to \p xBodyCallback.
+ * @param[out] pulOutDataLength The length of the body passed to \p xBodyCallback, also set on failure.
+ * @return AzureIoTHTTPResult_t
+ */
+AzureIoTHTTPResult_t AzureIoTHTTP_RequestStream( AzureIoTHTTPHandle_t xHTTPHandle,
+                                                 int32_t lRangeStart,
+                                                 int32_t lRangeEnd,
+                                                 char * pucDataBuffer,
+                                                 uint32_t ulDataBufferLength,
+                                                 AzureIoTHTTPBodyCallback_t xBodyCallback,
+                                                 void * pvCallbackContext,
+                                                 uint32_t * pulOutDataLength );
+
 /**
  * @brief Initialize a size request.
  *
+ * Like AzureIoTHTTP_Init(), call it once for each new connection of \p pxHTTPTransport.
+ *
  * @param[in] xHTTPHandle The HTTP handle to use for this operation.
- * @param[in] pxHTTPTransport The Azure IoT Transport interface to use for this operation.
+ * @param[in] pxHTTPTransport The connected Azure IoT Transport interface to use for the requests.
  * @param[in] pucURL The URL to use for this request.
  * @param[in] ulURLLength The length \p pucURL.
  * @param[in] pucPath The path to use for this request.
@@ -43,13 +43,12 @@ typedef struct AzureIoTJWS_RootKey
 /**
  * @brief The minimum amount of space needed to authenticate a JWS signature.
  *
- * @note azureiotjwsJWS_PAYLOAD_SIZE, one azureiotjwsSIGNATURE_SIZE, and one azureiotjwsSHA256_SIZE are excluded since
- * they will reuse buffer space.
+ * @note The JWK header, payload and signature as well as the signing key modulus and exponent are decoded in
+ * place within the decoded JWS header, and the manifest SHA calculation reuses the JWS signature space.
  */
-#define azureiotjwsSCRATCH_BUFFER_SIZE                                                            \
-    ( azureiotjwsJWS_HEADER_SIZE + azureiotjwsJWK_HEADER_SIZE + azureiotjwsJWK_PAYLOAD_SIZE       \
-      + azureiotjwsSIGNATURE_SIZE + azureiotjwsSIGNING_KEY_N_SIZE + azureiotjwsSIGNING_KEY_E_SIZE \
-      + azureiotjwsSHA_CALCULATION_SCRATCH_SIZE )
+#define azureiotjwsSCRATCH_BUFFER_SIZE                                                  \
+    ( azureiotjwsJWS_HEADER_SIZE + azureiotjwsSHA256_SIZE + azureiotjwsJWS_PAYLOAD_SIZE \
+      + azureiotjwsSIGNATURE_SIZE )
 
 /**
  * @brief Authenticate the manifest from ADU.
@@ -58,7 +57,7 @@ typedef struct AzureIoTJWS_RootKey
  * (`pucUpdateManifest` from #AzureIoTADUUpdateRequest_t).
  * @param[in] ulManifestLength The length of \p pucManifest.
  * (`ulUpdateManifestLength` from #AzureIoTADUUpdateRequest_t).
- * @param[in] pucJWS The JWS signature used to authenticate \p pucManifest.
+ * @param[in] pucJWS The JWS signature used to authenticate \p pucManifest. It is not modified.
  * (`pucUpdateManifestSignature` from #AzureIoTADUUpdateRequest_t).
  * @param[in] ulJWSLength The length of \p pucJWS.
  * (`ulUpdateManifestSignatureLength` from #AzureIoTADUUpdateRequest_t).
@@ -70,6 +69,11 @@ typedef struct AzureIoTJWS_RootKey
  * @return AzureIoTResult_t The return value of this function.
  * @retval eAzureIoTSuccess if successful.
  * @retval Otherwise if failed.
+ *
+ * @note Up to `azureiotconfigJWS_SIGNING_KEY_CACHE_SIZE` signing keys verified against a root key are
+ * remembered, by root key id and hash of the signed key. The signing key of a manifest re-delivered after
+ * a reconnect is then not verified again, only the manifest signature is. Authenticate manifests from
+ * one task at a time.
  */
 AzureIoTResult_t AzureIoTJWS_ManifestAuthenticate(
       const uint8_t*               pucManifest,
@@ -81,4 +85,13 @@ AzureIoTResult_t AzureIoTJWS_ManifestAuthenticate(
       uint8_t*                     pucScratchBuffer,
       uint32_t                     ulScratchBufferLength);
 
+/**
+ * @brief Forget the signing keys remembered by AzureIoTJWS_ManifestAuthenticate().
+ *
+ * Signing keys are remembered together with the root key which verified them, so a changed root key
+ * already forces a new verification. Call this to force one anyway, for example after a signing key
+ * was revoked.
+ */
+void AzureIoTJWS_ClearSigningKeyCache( void );
+
 #endif /* AZURE_IOT_JWS_H */
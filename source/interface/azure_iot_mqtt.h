@@ -316,6 +316,34 @@ AzureIoTMQTTResult_t AzureIoTMQTT_Publish( AzureIoTMQTTHandle_t xContext,
                                            const AzureIoTMQTTPublishInfo_t * pxPublishInfo,
                                            uint16_t usPacketId );
 
+/**
+ * @brief Starts a QoS 0 publish whose payload is sent next, in pieces, by AzureIoTMQTT_PublishPayload().
+ *
+ * Sends the PUBLISH packet up to its payload. The payload pieces sent next must add up to
+ * exactly \p pxPublishInfo->xPayloadLength bytes, with no other MQTT call in between: if they
+ * can't, the MQTT connection must be closed.
+ *
+ * @param[in] xContext Initialized AzureIoTMQTT context.
+ * @param[in] pxPublishInfo MQTT PUBLISH packet parameters, with QoS 0. The payload pointer is not used.
+ *
+ * @return An #AzureIoTMQTTResult_t with the result of the operation.
+ */
+AzureIoTMQTTResult_t AzureIoTMQTT_PublishHeader( AzureIoTMQTTHandle_t xContext,
+                                                 const AzureIoTMQTTPublishInfo_t * pxPublishInfo );
+
+/**
+ * @brief Sends a piece of the payload of a publish started by AzureIoTMQTT_PublishHeader().
+ *
+ * @param[in] xContext Initialized AzureIoTMQTT context.
+ * @param[in] pucPayload The piece of payload.
+ * @param[in] xPayloadLength The length of \p pucPayload.
+ *
+ * @return An #AzureIoTMQTTResult_t with the result of the operation.
+ */
+AzureIoTMQTTResult_t AzureIoTMQTT_PublishPayload( AzureIoTMQTTHandle_t xContext,
+                                                  const uint8_t * pucPayload,
+                                                  size_t xPayloadLength );
+
 /**
  * @brief Sends a MQTT PINGREQ to broker.
  *
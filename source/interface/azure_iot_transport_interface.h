@@ -152,6 +152,21 @@ typedef int32_t ( * AzureIoTTransportSend_t )( void * pxNetworkContext,
                                                const void * pvBuffer,
                                                size_t xBytesToSend );
 
+/**
+ * @brief User defined function for (re)connecting the transport, used by clients that reconnect on their own.
+ *
+ * Closes the current connection of \p pxTransport, if any, and opens a new one to the same server,
+ * updating \p pxTransport in place.
+ *
+ * @param[in] pvConnectContext Context given along with the function.
+ * @param[in,out] pxTransport The transport interface to reconnect.
+ *
+ * @return `0` if connected or a negative error code.
+ */
+struct AzureIoTTransportInterface;
+typedef int32_t ( * AzureIoTTransportConnect_t )( void * pvConnectContext,
+                                                  struct AzureIoTTransportInterface * pxTransport );
+
 /**
  * @brief The transport layer interface.
  */
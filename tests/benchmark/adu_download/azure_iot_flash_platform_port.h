@@ -0,0 +1,26 @@
+/* Copyright (c) Microsoft Corporation.
+ * Licensed under the MIT License. */
+
+/**
+ * @file azure_iot_flash_platform_port.h
+ * @brief Flash platform port of the ADU download benchmark.
+ *
+ */
+
+#ifndef AZURE_IOT_FLASH_PLATFORM_PORT_H
+#define AZURE_IOT_FLASH_PLATFORM_PORT_H
+
+#include <stdint.h>
+
+/**
+ * @brief Image written to a RAM bank.
+ */
+typedef struct AzureADUImage
+{
+    uint8_t * pucBank;
+    uint32_t ulBankSize;
+    uint32_t ulImageSize;
+    uint32_t ulWriteDelayMicroseconds; /* Delay per KiB written, to emulate the flash program time. */
+} AzureADUImage_t;
+
+#endif /* AZURE_IOT_FLASH_PLATFORM_PORT_H */
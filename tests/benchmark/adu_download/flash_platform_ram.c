@@ -0,0 +1,169 @@
+/* Copyright (c) Microsoft Corporation.
+ * Licensed under the MIT License. */
+
+/**
+ * @file flash_platform_ram.c
+ * @brief Flash platform port writing to a RAM bank.
+ *
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "azure_iot_flash_platform.h"
+
+#define benchmarkBANK_SIZE          ( 16U * 1024U * 1024U )
+#define benchmarkCHECKPOINT_SIZE    ( 512U )
+/*-----------------------------------------------------------*/
+
+static uint8_t ucSavedCheckpoint[ benchmarkCHECKPOINT_SIZE ];
+static uint32_t ulSavedCheckpointLength = 0;
+/*-----------------------------------------------------------*/
+
+AzureIoTResult_t AzureIoTPlatform_Init( AzureADUImage_t * const pxAduImage )
+{
+    if( pxAduImage->pucBank == NULL )
+    {
+        pxAduImage->pucBank = malloc( benchmarkBANK_SIZE );
+
+        if( pxAduImage->pucBank == NULL )
+        {
+            return eAzureIoTErrorOutOfMemory;
+        }
+
+        pxAduImage->ulBankSize = benchmarkBANK_SIZE;
+    }
+
+    memset( pxAduImage->pucBank, 0xFF, pxAduImage->ulBankSize );
+    pxAduImage->ulImageSize = 0;
+
+    return eAzureIoTSuccess;
+}
+/*-----------------------------------------------------------*/
+
+int64_t AzureIoTPlatform_GetSingleFlashBootBankSize()
+{
+    return benchmarkBANK_SIZE;
+}
+/*-----------------------------------------------------------*/
+
+uint32_t AzureIoTPlatform_GetProgramPageSize( AzureADUImage_t * const pxAduImage )
+{
+    ( void ) pxAduImage;
+
+    return 1;
+}
+/*-----------------------------------------------------------*/
+
+uint32_t AzureIoTPlatform_GetEraseSectorSize( AzureADUImage_t * const pxAduImage )
+{
+    ( void ) pxAduImage;
+
+    return 1;
+}
+/*-----------------------------------------------------------*/
+
+AzureIoTResult_t AzureIoTPlatform_WriteBlock( AzureADUImage_t * const pxAduImage,
+                                              uint32_t ulOffset,
+                                              uint8_t * const pData,
+                                              uint32_t ulBlockSize )
+{
+    if( ( ulOffset + ulBlockSize ) > pxAduImage->ulBankSize )
+    {
+        return eAzureIoTErrorOutOfMemory;
+    }
+
+    memcpy( pxAduImage->pucBank + ulOffset, pData, ulBlockSize );
+
+    if( pxAduImage->ulImageSize < ( ulOffset + ulBlockSize ) )
+    {
+        pxAduImage->ulImageSize = ulOffset + ulBlockSize;
+    }
+
+    if( pxAduImage->ulWriteDelayMicroseconds > 0 )
+    {
+        usleep( ( pxAduImage->ulWriteDelayMicroseconds * ulBlockSize ) / 1024U );
+    }
+
+    return eAzureIoTSuccess;
+}
+/*-----------------------------------------------------------*/
+
+AzureIoTResult_t AzureIoTPlatform_ReadActiveBlock( AzureADUImage_t * const pxAduImage,
+                                                   uint32_t ulOffset,
+                                                   uint8_t * const pData,
+                                                   uint32_t ulBlockSize )
+{
+    ( void ) pxAduImage;
+    ( void ) ulOffset;
+
+    /* There is no running image in the benchmark, it reads as erased flash. */
+    memset( pData, 0xFF, ulBlockSize );
+
+    return eAzureIoTSuccess;
+}
+/*-----------------------------------------------------------*/
+
+AzureIoTResult_t AzureIoTPlatform_VerifyImage( AzureADUImage_t * const pxAduImage,
+                                               uint8_t * pucSHA256Hash,
+                                               uint32_t ulSHA256HashLength )
+{
+    ( void ) pxAduImage;
+    ( void ) pucSHA256Hash;
+    ( void ) ulSHA256HashLength;
+
+    return eAzureIoTSuccess;
+}
+/*-----------------------------------------------------------*/
+
+AzureIoTResult_t AzureIoTPlatform_SaveCheckpoint( AzureADUImage_t * const pxAduImage,
+                                                  const uint8_t * pucCheckpoint,
+                                                  uint32_t ulCheckpointLength )
+{
+    ( void ) pxAduImage;
+
+    if( ulCheckpointLength > sizeof( ucSavedCheckpoint ) )
+    {
+        return eAzureIoTErrorOutOfMemory;
+    }
+
+    memcpy( ucSavedCheckpoint, pucCheckpoint, ulCheckpointLength );
+    ulSavedCheckpointLength = ulCheckpointLength;
+
+    return eAzureIoTSuccess;
+}
+/*-----------------------------------------------------------*/
+
+AzureIoTResult_t AzureIoTPlatform_LoadCheckpoint( AzureADUImage_t * const pxAduImage,
+                                                  uint8_t * pucCheckpoint,
+                                                  uint32_t ulCheckpointLength )
+{
+    ( void ) pxAduImage;
+
+    if( ( ulSavedCheckpointLength == 0 ) || ( ulSavedCheckpointLength != ulCheckpointLength ) )
+    {
+        return eAzureIoTErrorItemNotFound;
+    }
+
+    memcpy( pucCheckpoint, ucSavedCheckpoint, ulCheckpointLength );
+
+    return eAzureIoTSuccess;
+}
+/*-----------------------------------------------------------*/
+
+AzureIoTResult_t AzureIoTPlatform_EnableImage( AzureADUImage_t * const pxAduImage )
+{
+    ( void ) pxAduImage;
+
+    return eAzureIoTSuccess;
+}
+/*-----------------------------------------------------------*/
+
+AzureIoTResult_t AzureIoTPlatform_ResetDevice( AzureADUImage_t * const pxAduImage )
+{
+    ( void ) pxAduImage;
+
+    return eAzureIoTSuccess;
+}
+/*-----------------------------------------------------------*/
@@ -0,0 +1,271 @@
+/* Copyright (c) Microsoft Corporation.
+ * Licensed under the MIT License. */
+
+/**
+ * @file main.c
+ * @brief Throughput benchmark of the ADU download engine.
+ *
+ * Downloads a file from a local HTTP server once per chunk size and prints the goodput.
+ *
+ * Usage: azure_iot_adu_download_benchmark [host] [port] [path] [flash delay us per KiB]
+ */
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <netdb.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+
+/* FreeRTOS includes. */
+#include <FreeRTOS.h>
+#include "task.h"
+
+#include "azure_iot_adu_download.h"
+/*-----------------------------------------------------------*/
+
+#define benchmarkDEFAULT_HOST    "127.0.0.1"
+#define benchmarkDEFAULT_PORT    "8080"
+#define benchmarkDEFAULT_PATH    "/image.bin"
+#define benchmarkMAX_CHUNK_SIZE  ( 32U * 1024U )
+#define benchmarkTASK_STACK_SIZE ( 16U * 1024U )
+
+#ifndef benchmarkPOSIX_FLASH
+    #define benchmarkPOSIX_FLASH    0
+#endif
+
+/* Directory of the bank files, when writing to the POSIX flash port */
+#ifndef benchmarkPOSIX_FLASH_DIRECTORY
+    #define benchmarkPOSIX_FLASH_DIRECTORY    "adu_flash"
+#endif
+/*-----------------------------------------------------------*/
+
+struct NetworkContext
+{
+    int lSocket;
+};
+/*-----------------------------------------------------------*/
+
+static const uint32_t ulChunkSizes[] = { 512U, 1024U, 2048U, 4096U, 8192U, 16384U, 32768U };
+
+static uint8_t ucDownloadBuffer[ azureiotaduDOWNLOAD_BUFFER_SIZE( benchmarkMAX_CHUNK_SIZE ) ];
+
+static int lArgc;
+static char ** ppcArgv;
+/*-----------------------------------------------------------*/
+
+static int32_t prvSocketRecv( void * pxNetworkContext,
+                              void * pvBuffer,
+                              size_t xBytesToRecv )
+{
+    ssize_t lReceived;
+
+    do
+    {
+        lReceived = recv( ( ( struct NetworkContext * ) pxNetworkContext )->lSocket, pvBuffer, xBytesToRecv, 0 );
+    } while( ( lReceived < 0 ) && ( errno == EINTR ) );
+
+    /* A closed connection is reported as an error, 0 means no data yet. */
+    return ( lReceived == 0 ) ? -1 : ( int32_t ) lReceived;
+}
+/*-----------------------------------------------------------*/
+
+static int32_t prvSocketSend( void * pxNetworkContext,
+                              const void * pvBuffer,
+                              size_t xBytesToSend )
+{
+    ssize_t lSent;
+
+    do
+    {
+        lSent = send( ( ( struct NetworkContext * ) pxNetworkContext )->lSocket, pvBuffer, xBytesToSend, MSG_NOSIGNAL );
+    } while( ( lSent < 0 ) && ( errno == EINTR ) );
+
+    return ( int32_t ) lSent;
+}
+/*-----------------------------------------------------------*/
+
+static int prvSocketConnect( const char * pcHost,
+                             const char * pcPort )
+{
+    struct addrinfo xHints;
+    struct addrinfo * pxAddress = NULL;
+    int lSocket = -1;
+    int lNoDelay = 1;
+
+    memset( &xHints, 0, sizeof( xHints ) );
+    xHints.ai_family = AF_INET;
+    xHints.ai_socktype = SOCK_STREAM;
+
+    if( getaddrinfo( pcHost, pcPort, &xHints, &pxAddress ) != 0 )
+    {
+        return -1;
+    }
+
+    if( ( lSocket = socket( pxAddress->ai_family, pxAddress->ai_socktype, pxAddress->ai_protocol ) ) >= 0 )
+    {
+        if( connect( lSocket, pxAddress->ai_addr, pxAddress->ai_addrlen ) != 0 )
+        {
+            close( lSocket );
+            lSocket = -1;
+        }
+        else
+        {
+            setsockopt( lSocket, IPPROTO_TCP, TCP_NODELAY, &lNoDelay, sizeof( lNoDelay ) );
+        }
+    }
+
+    freeaddrinfo( pxAddress );
+
+    return lSocket;
+}
+/*-----------------------------------------------------------*/
+
+static void prvBenchmarkTask( void * pvParameters )
+{
+    const char * pcHost = ( lArgc > 1 ) ? ppcArgv[ 1 ] : benchmarkDEFAULT_HOST;
+    const char * pcPort = ( lArgc > 2 ) ? ppcArgv[ 2 ] : benchmarkDEFAULT_PORT;
+    const char * pcPath = ( lArgc > 3 ) ? ppcArgv[ 3 ] : benchmarkDEFAULT_PATH;
+    AzureIoTTransportInterface_t xTransport;
+    struct NetworkContext xNetworkContext;
+    AzureIoTHTTP_t xHTTPClient;
+    AzureADUImage_t xImage;
+    AzureIoTADUDownload_t xDownload;
+    AzureIoTADUDownloadStats_t xStats;
+    AzureIoTResult_t xResult;
+    uint32_t ulIndex;
+    int lExitCode = 0;
+
+    ( void ) pvParameters;
+
+    memset( &xImage, 0, sizeof( xImage ) );
+    #if benchmarkPOSIX_FLASH
+        xImage.pcDirectory = benchmarkPOSIX_FLASH_DIRECTORY;
+        xImage.ulProgramMicroseconds = ( lArgc > 4 ) ? ( uint32_t ) strtoul( ppcArgv[ 4 ], NULL, 10 ) : 0;
+        xImage.ulEraseMicroseconds = ( lArgc > 5 ) ? ( uint32_t ) strtoul( ppcArgv[ 5 ], NULL, 10 ) : 0;
+    #else
+        xImage.ulWriteDelayMicroseconds = ( lArgc > 4 ) ? ( uint32_t ) strtoul( ppcArgv[ 4 ], NULL, 10 ) : 0;
+    #endif
+
+    printf( "%10s %12s %10s %10s %10s %10s\r\n", "chunk", "bytes", "requests", "fetch ms", "write ms", "MB/s" );
+
+    for( ulIndex = 0; ulIndex < sizeof( ulChunkSizes ) / sizeof( ulChunkSizes[ 0 ] ); ulIndex++ )
+    {
+        if( ( xNetworkContext.lSocket = prvSocketConnect( pcHost, pcPort ) ) < 0 )
+        {
+            printf( "Failed to connect to %s:%s\r\n", pcHost, pcPort );
+            lExitCode = 1;
+            break;
+        }
+
+        xTransport.pxNetworkContext = &xNetworkContext;
+        xTransport.xRecv = prvSocketRecv;
+        xTransport.xSend = prvSocketSend;
+
+        if( ( AzureIoTPlatform_Init( &xImage ) != eAzureIoTSuccess ) ||
+            ( AzureIoTADUDownload_Init( &xDownload, &xHTTPClient, &xImage,
+                                        ucDownloadBuffer, sizeof( ucDownloadBuffer ),
+                                        ulChunkSizes[ ulIndex ] ) != eAzureIoTSuccess ) ||
+            ( AzureIoTADUDownload_Start( &xDownload, &xTransport,
+                                         pcHost, strlen( pcHost ),
+                                         pcPath, strlen( pcPath ), 0 ) != eAzureIoTSuccess ) )
+        {
+            xResult = eAzureIoTErrorFailed;
+        }
+        else
+        {
+            while( ( xResult = AzureIoTADUDownload_Process( &xDownload ) ) == eAzureIoTErrorPending )
+            {
+            }
+        }
+
+        close( xNetworkContext.lSocket );
+
+        if( xResult != eAzureIoTSuccess )
+        {
+            printf( "Download failed with chunk size %u: error=0x%08x\r\n", ulChunkSizes[ ulIndex ], ( uint16_t ) xResult );
+            lExitCode = 1;
+            break;
+        }
+
+        ( void ) AzureIoTADUDownload_GetStats( &xDownload, &xStats );
+
+        printf( "%10u %12u %10u %10u %10u %10.2f\r\n",
+                ulChunkSizes[ ulIndex ],
+                xStats.ulBytesWritten,
+                xStats.ulRequestCount,
+                xStats.ulFetchMilliseconds,
+                xStats.ulWriteMilliseconds,
+                ( double ) xStats.ulBytesPerSecond / ( 1024.0 * 1024.0 ) );
+    }
+
+    #if benchmarkPOSIX_FLASH
+        printf( "%u sectors erased, %u pages programmed, %llu ms flash busy\r\n",
+                xImage.ulEraseCount, xImage.ulProgramCount,
+                ( unsigned long long ) ( xImage.ullBusyMicroseconds / 1000U ) );
+        ( void ) AzureIoTPlatform_ResetDevice( &xImage );
+    #else
+        free( xImage.pucBank );
+    #endif
+
+    exit( lExitCode );
+}
+/*-----------------------------------------------------------*/
+
+int main( int argc,
+          char ** argv )
+{
+    lArgc = argc;
+    ppcArgv = argv;
+
+    xTaskCreate( prvBenchmarkTask, "Benchmark", benchmarkTASK_STACK_SIZE, NULL, tskIDLE_PRIORITY + 1, NULL );
+
+    /* Start the RTOS scheduler. */
+    vTaskStartScheduler();
+
+    return 1;
+}
+/*-----------------------------------------------------------*/
+
+void vAssertCalled( const char * pcFile,
+                    uint32_t ulLine )
+{
+    printf( "vAssertCalled( %s, %u\n", pcFile, ulLine );
+    abort();
+}
+/*-----------------------------------------------------------*/
+
+/* configUSE_STATIC_ALLOCATION is set to 1, so the application must provide an
+ * implementation of vApplicationGetIdleTaskMemory() to provide the memory that is
+ * used by the Idle task. */
+void vApplicationGetIdleTaskMemory( StaticTask_t ** ppxIdleTaskTCBBuffer,
+                                    StackType_t ** ppxIdleTaskStackBuffer,
+                                    uint32_t * pulIdleTaskStackSize )
+{
+    static StaticTask_t xIdleTaskTCB;
+    static StackType_t uxIdleTaskStack[ configMINIMAL_STACK_SIZE ];
+
+    *ppxIdleTaskTCBBuffer = &xIdleTaskTCB;
+    *ppxIdleTaskStackBuffer = uxIdleTaskStack;
+    *pulIdleTaskStackSize = configMINIMAL_STACK_SIZE;
+}
+/*-----------------------------------------------------------*/
+
+/* configUSE_STATIC_ALLOCATION and configUSE_TIMERS are both set to 1, so the
+ * application must provide an implementation of vApplicationGetTimerTaskMemory()
+ * to provide the memory that is used by the Timer service task. */
+void vApplicationGetTimerTaskMemory( StaticTask_t ** ppxTimerTaskTCBBuffer,
+                                     StackType_t ** ppxTimerTaskStackBuffer,
+                                     uint32_t * pulTimerTaskStackSize )
+{
+    static StaticTask_t xTimerTaskTCB;
+    static StackType_t uxTimerTaskStack[ configTIMER_TASK_STACK_DEPTH ];
+
+    *ppxTimerTaskTCBBuffer = &xTimerTaskTCB;
+    *ppxTimerTaskStackBuffer = uxTimerTaskStack;
+    *pulTimerTaskStackSize = configTIMER_TASK_STACK_DEPTH;
+}
+/*-----------------------------------------------------------*/
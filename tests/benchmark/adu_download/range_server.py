@@ -0,0 +1,56 @@
+# Copyright (c) Microsoft Corporation.
+# Licensed under the MIT License.
+
+# Serves a random file over HTTP/1.1 with keep-alive and Range support.
+# python3 range_server.py [port] [file size in bytes]
+
+import http.server
+import os
+import re
+import sys
+
+port = int(sys.argv[1]) if len(sys.argv) > 1 else 8080
+size = int(sys.argv[2]) if len(sys.argv) > 2 else 1024 * 1024
+content = os.urandom(size)
+
+
+class RangeHandler(http.server.BaseHTTPRequestHandler):
+    protocol_version = "HTTP/1.1"
+
+    def do_HEAD(self):
+        self.send_response(200)
+        self.send_header("Content-Length", str(len(content)))
+        self.send_header("Accept-Ranges", "bytes")
+        self.end_headers()
+
+    def do_GET(self):
+        match = re.match(r"bytes=(\d+)-(\d*)", self.headers.get("Range", ""))
+
+        if match is None:
+            self.send_response(200)
+            start, end = 0, len(content) - 1
+        else:
+            start = int(match.group(1))
+            end = min(int(match.group(2) or len(content) - 1), len(content) - 1)
+
+            if start > end:
+                self.send_response(416)
+                self.send_header("Content-Range", "bytes */%d" % len(content))
+                self.send_header("Content-Length", "0")
+                self.end_headers()
+                return
+
+            self.send_response(206)
+            self.send_header("Content-Range", "bytes %d-%d/%d" % (start, end, len(content)))
+
+        self.send_header("Content-Length", str(end - start + 1))
+        self.end_headers()
+        self.wfile.write(content[start:end + 1])
+
+    def log_message(self, format, *args):
+        pass
+
+
+if __name__ == "__main__":
+    print("Serving %d bytes on port %d" % (size, port))
+    http.server.ThreadingHTTPServer(("127.0.0.1", port), RangeHandler).serve_forever()
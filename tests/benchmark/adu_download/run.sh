@@ -0,0 +1,28 @@
+#!/bin/bash
+
+# Copyright (c) Microsoft. All rights reserved.
+# Licensed under the MIT license. See LICENSE file in the project root for full license information.
+#
+# This script builds the ADU download benchmark and runs it against a local HTTP server
+
+# ./run.sh <FreeRTOS Src path> [file size in bytes] [flash delay us per KiB]
+# e.g. ./run.sh ~/FreeRTOS 4194304
+
+source "$(dirname "$0")/../common/benchmark.sh"
+
+file_size=${2:-4194304}
+flash_delay=${3:-0}
+port=8080
+
+pushd "$dir"
+
+benchmark_build Release
+
+python3 ./range_server.py $port $file_size &
+server_pid=$!
+trap "kill $server_pid" EXIT
+sleep 1
+
+./build/azure_iot_adu_download_benchmark 127.0.0.1 $port /image.bin $flash_delay
+
+popd
@@ -0,0 +1,318 @@
+/* Copyright (c) Microsoft Corporation.
+ * Licensed under the MIT License. */
+
+/**
+ * @file main.c
+ * @brief Payload size, and messages encoded and decoded per second, of telemetry in JSON and in CBOR.
+ *
+ * Encodes the same telemetry with the JSON writer and the CBOR writer, decodes both payloads back
+ * with the JSON reader and the CBOR reader, and checks the values read are the values written.
+ *
+ * Usage: azure_iot_cbor_benchmark [messages]
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "azure_iot_cbor_reader.h"
+#include "azure_iot_cbor_writer.h"
+#include "azure_iot_json_reader.h"
+
+#include "benchmark_common.h"
+/*-----------------------------------------------------------*/
+
+#define benchmarkDEFAULT_MESSAGES    ( 1000000U )
+#define benchmarkBUFFER_SIZE         ( 256U )
+/*-----------------------------------------------------------*/
+
+typedef AzureIoTResult_t ( * Encode_t )( const BenchmarkTelemetry_t * pxTelemetry,
+                                         uint8_t * pucBuffer,
+                                         uint32_t * pulLength );
+
+typedef AzureIoTResult_t ( * Decode_t )( const uint8_t * pucPayload,
+                                         uint32_t ulLength,
+                                         BenchmarkTelemetry_t * pxTelemetry );
+
+static const char * const pcStates[] = { "idle", "heating", "off" };
+/*-----------------------------------------------------------*/
+
+/*
+ * The temperature has the 1/16 degree resolution of most digital sensors, which a half or single
+ * precision float holds exactly. The humidity is a decimal, which only a double holds.
+ */
+static void prvGetTelemetry( uint32_t ulMessage,
+                             BenchmarkTelemetry_t * pxTelemetry )
+{
+    pxTelemetry->xTemperature = 18.0 + ( double ) ( ulMessage % 97U ) / 16.0;
+    pxTelemetry->xHumidity = 40.1 + ( double ) ( ulMessage % 9U ) / 10.0;
+    pxTelemetry->lPressure = 990 + ( int32_t ) ( ulMessage % 40U );
+    pxTelemetry->xDoorOpen = ( ulMessage % 5U ) == 0;
+    vBenchmarkTelemetrySetState( pxTelemetry, pcStates[ ulMessage % 3U ] );
+}
+/*-----------------------------------------------------------*/
+
+static AzureIoTResult_t prvEncodeJSON( const BenchmarkTelemetry_t * pxTelemetry,
+                                       uint8_t * pucBuffer,
+                                       uint32_t * pulLength )
+{
+    return xBenchmarkTelemetryWriteJSON( pxTelemetry, 4, pucBuffer, benchmarkBUFFER_SIZE, pulLength );
+}
+/*-----------------------------------------------------------*/
+
+static AzureIoTResult_t prvEncodeCBOR( const BenchmarkTelemetry_t * pxTelemetry,
+                                       uint8_t * pucBuffer,
+                                       uint32_t * pulLength )
+{
+    AzureIoTCBORWriter_t xWriter;
+    AzureIoTResult_t xResult;
+
+    if( ( ( xResult = AzureIoTCBORWriter_Init( &xWriter, pucBuffer, benchmarkBUFFER_SIZE ) ) != eAzureIoTSuccess ) ||
+        ( ( xResult = AzureIoTCBORWriter_AppendBeginObject( &xWriter ) ) != eAzureIoTSuccess ) ||
+        ( ( xResult = AzureIoTCBORWriter_AppendPropertyWithDoubleValue( &xWriter, ucBenchmarkTemperature, sizeof( ucBenchmarkTemperature ) - 1,
+                                                                         pxTelemetry->xTemperature ) ) != eAzureIoTSuccess ) ||
+        ( ( xResult = AzureIoTCBORWriter_AppendPropertyWithDoubleValue( &xWriter, ucBenchmarkHumidity, sizeof( ucBenchmarkHumidity ) - 1,
+                                                                         pxTelemetry->xHumidity ) ) != eAzureIoTSuccess ) ||
+        ( ( xResult = AzureIoTCBORWriter_AppendPropertyWithInt32Value( &xWriter, ucBenchmarkPressure, sizeof( ucBenchmarkPressure ) - 1,
+                                                                        pxTelemetry->lPressure ) ) != eAzureIoTSuccess ) ||
+        ( ( xResult = AzureIoTCBORWriter_AppendPropertyWithBoolValue( &xWriter, ucBenchmarkDoorOpen, sizeof( ucBenchmarkDoorOpen ) - 1,
+                                                                       pxTelemetry->xDoorOpen ) ) != eAzureIoTSuccess ) ||
+        ( ( xResult = AzureIoTCBORWriter_AppendPropertyWithStringValue( &xWriter, ucBenchmarkState, sizeof( ucBenchmarkState ) - 1,
+                                                                         pxTelemetry->ucState,
+                                                                         pxTelemetry->ulStateLength ) ) != eAzureIoTSuccess ) ||
+        ( ( xResult = AzureIoTCBORWriter_AppendEndObject( &xWriter ) ) != eAzureIoTSuccess ) )
+    {
+        return xResult;
+    }
+
+    *pulLength = ( uint32_t ) AzureIoTCBORWriter_GetBytesUsed( &xWriter );
+
+    return eAzureIoTSuccess;
+}
+/*-----------------------------------------------------------*/
+
+static AzureIoTResult_t prvDecodeJSON( const uint8_t * pucPayload,
+                                       uint32_t ulLength,
+                                       BenchmarkTelemetry_t * pxTelemetry )
+{
+    AzureIoTJSONReader_t xReader;
+    AzureIoTJSONTokenType_t xTokenType;
+    AzureIoTResult_t xResult;
+
+    if( ( ( xResult = AzureIoTJSONReader_Init( &xReader, pucPayload, ulLength ) ) != eAzureIoTSuccess ) ||
+        ( ( xResult = AzureIoTJSONReader_NextToken( &xReader ) ) != eAzureIoTSuccess ) )
+    {
+        return xResult;
+    }
+
+    while( ( ( xResult = AzureIoTJSONReader_NextToken( &xReader ) ) == eAzureIoTSuccess ) &&
+           ( ( xResult = AzureIoTJSONReader_TokenType( &xReader, &xTokenType ) ) == eAzureIoTSuccess ) &&
+           ( xTokenType == eAzureIoTJSONTokenPROPERTY_NAME ) )
+    {
+        if( AzureIoTJSONReader_TokenIsTextEqual( &xReader, ucBenchmarkTemperature, sizeof( ucBenchmarkTemperature ) - 1 ) )
+        {
+            xResult = AzureIoTJSONReader_NextToken( &xReader );
+            xResult = ( xResult == eAzureIoTSuccess ) ? AzureIoTJSONReader_GetTokenDouble( &xReader, &pxTelemetry->xTemperature ) : xResult;
+        }
+        else if( AzureIoTJSONReader_TokenIsTextEqual( &xReader, ucBenchmarkHumidity, sizeof( ucBenchmarkHumidity ) - 1 ) )
+        {
+            xResult = AzureIoTJSONReader_NextToken( &xReader );
+            xResult = ( xResult == eAzureIoTSuccess ) ? AzureIoTJSONReader_GetTokenDouble( &xReader, &pxTelemetry->xHumidity ) : xResult;
+        }
+        else if( AzureIoTJSONReader_TokenIsTextEqual( &xReader, ucBenchmarkPressure, sizeof( ucBenchmarkPressure ) - 1 ) )
+        {
+            xResult = AzureIoTJSONReader_NextToken( &xReader );
+            xResult = ( xResult == eAzureIoTSuccess ) ? AzureIoTJSONReader_GetTokenInt32( &xReader, &pxTelemetry->lPressure ) : xResult;
+        }
+        else if( AzureIoTJSONReader_TokenIsTextEqual( &xReader, ucBenchmarkDoorOpen, sizeof( ucBenchmarkDoorOpen ) - 1 ) )
+        {
+            xResult = AzureIoTJSONReader_NextToken( &xReader );
+            xResult = ( xResult == eAzureIoTSuccess ) ? AzureIoTJSONReader_GetTokenBool( &xReader, &pxTelemetry->xDoorOpen ) : xResult;
+        }
+        else if( AzureIoTJSONReader_TokenIsTextEqual( &xReader, ucBenchmarkState, sizeof( ucBenchmarkState ) - 1 ) )
+        {
+            xResult = AzureIoTJSONReader_NextToken( &xReader );
+            xResult = ( xResult == eAzureIoTSuccess ) ?
+                      AzureIoTJSONReader_GetTokenString( &xReader, pxTelemetry->ucState, benchmarkTELEMETRY_STATE_SIZE,
+                                                         &pxTelemetry->ulStateLength ) : xResult;
+        }
+        else
+        {
+            xResult = AzureIoTJSONReader_SkipChildren( &xReader );
+        }
+
+        if( xResult != eAzureIoTSuccess )
+        {
+            break;
+        }
+    }
+
+    return xResult;
+}
+/*-----------------------------------------------------------*/
+
+static AzureIoTResult_t prvDecodeCBOR( const uint8_t * pucPayload,
+                                       uint32_t ulLength,
+                                       BenchmarkTelemetry_t * pxTelemetry )
+{
+    AzureIoTCBORReader_t xReader;
+    AzureIoTCBORTokenType_t xTokenType;
+    AzureIoTResult_t xResult;
+
+    if( ( ( xResult = AzureIoTCBORReader_Init( &xReader, pucPayload, ulLength ) ) != eAzureIoTSuccess ) ||
+        ( ( xResult = AzureIoTCBORReader_NextToken( &xReader ) ) != eAzureIoTSuccess ) )
+    {
+        return xResult;
+    }
+
+    while( ( ( xResult = AzureIoTCBORReader_NextToken( &xReader ) ) == eAzureIoTSuccess ) &&
+           ( ( xResult = AzureIoTCBORReader_TokenType( &xReader, &xTokenType ) ) == eAzureIoTSuccess ) &&
+           ( xTokenType == eAzureIoTCBORTokenPROPERTY_NAME ) )
+    {
+        if( AzureIoTCBORReader_TokenIsTextEqual( &xReader, ucBenchmarkTemperature, sizeof( ucBenchmarkTemperature ) - 1 ) )
+        {
+            xResult = AzureIoTCBORReader_NextToken( &xReader );
+            xResult = ( xResult == eAzureIoTSuccess ) ? AzureIoTCBORReader_GetTokenDouble( &xReader, &pxTelemetry->xTemperature ) : xResult;
+        }
+        else if( AzureIoTCBORReader_TokenIsTextEqual( &xReader, ucBenchmarkHumidity, sizeof( ucBenchmarkHumidity ) - 1 ) )
+        {
+            xResult = AzureIoTCBORReader_NextToken( &xReader );
+            xResult = ( xResult == eAzureIoTSuccess ) ? AzureIoTCBORReader_GetTokenDouble( &xReader, &pxTelemetry->xHumidity ) : xResult;
+        }
+        else if( AzureIoTCBORReader_TokenIsTextEqual( &xReader, ucBenchmarkPressure, sizeof( ucBenchmarkPressure ) - 1 ) )
+        {
+            xResult = AzureIoTCBORReader_NextToken( &xReader );
+            xResult = ( xResult == eAzureIoTSuccess ) ? AzureIoTCBORReader_GetTokenInt32( &xReader, &pxTelemetry->lPressure ) : xResult;
+        }
+        else if( AzureIoTCBORReader_TokenIsTextEqual( &xReader, ucBenchmarkDoorOpen, sizeof( ucBenchmarkDoorOpen ) - 1 ) )
+        {
+            xResult = AzureIoTCBORReader_NextToken( &xReader );
+            xResult = ( xResult == eAzureIoTSuccess ) ? AzureIoTCBORReader_GetTokenBool( &xReader, &pxTelemetry->xDoorOpen ) : xResult;
+        }
+        else if( AzureIoTCBORReader_TokenIsTextEqual( &xReader, ucBenchmarkState, sizeof( ucBenchmarkState ) - 1 ) )
+        {
+            xResult = AzureIoTCBORReader_NextToken( &xReader );
+            xResult = ( xResult == eAzureIoTSuccess ) ?
+                      AzureIoTCBORReader_GetTokenString( &xReader, pxTelemetry->ucState, benchmarkTELEMETRY_STATE_SIZE,
+                                                         &pxTelemetry->ulStateLength ) : xResult;
+        }
+        else
+        {
+            xResult = AzureIoTCBORReader_SkipChildren( &xReader );
+        }
+
+        if( xResult != eAzureIoTSuccess )
+        {
+            break;
+        }
+    }
+
+    return xResult;
+}
+/*-----------------------------------------------------------*/
+
+/*
+ * JSON has the humidity to one decimal, which reads back as the nearest double: compare to 1e-9.
+ */
+static bool prvTelemetryEqual( const BenchmarkTelemetry_t * pxExpected,
+                               const BenchmarkTelemetry_t * pxActual )
+{
+    return ( pxActual->xTemperature == pxExpected->xTemperature ) &&
+           ( fabs( pxActual->xHumidity - pxExpected->xHumidity ) < 1e-9 ) &&
+           ( pxActual->lPressure == pxExpected->lPressure ) &&
+           ( pxActual->xDoorOpen == pxExpected->xDoorOpen ) &&
+           ( pxActual->ulStateLength == pxExpected->ulStateLength ) &&
+           ( memcmp( pxActual->ucState, pxExpected->ucState, pxExpected->ulStateLength ) == 0 );
+}
+/*-----------------------------------------------------------*/
+
+static int prvCheck( const char * pcName,
+                     Encode_t xEncode,
+                     Decode_t xDecode )
+{
+    uint8_t ucBuffer[ benchmarkBUFFER_SIZE ];
+    BenchmarkTelemetry_t xExpected;
+    BenchmarkTelemetry_t xActual;
+    uint32_t ulLength = 0;
+    uint64_t ullTotal = 0;
+    uint32_t ulMessage;
+
+    for( ulMessage = 0; ulMessage < 1000U; ulMessage++ )
+    {
+        prvGetTelemetry( ulMessage, &xExpected );
+        memset( &xActual, 0, sizeof( xActual ) );
+
+        if( ( xEncode( &xExpected, ucBuffer, &ulLength ) != eAzureIoTSuccess ) ||
+            ( xDecode( ucBuffer, ulLength, &xActual ) != eAzureIoTSuccess ) ||
+            !prvTelemetryEqual( &xExpected, &xActual ) )
+        {
+            printf( "%s message %u does not round trip\r\n", pcName, ( unsigned ) ulMessage );
+            return 1;
+        }
+
+        ullTotal += ulLength;
+    }
+
+    printf( "%-5s %6.1f bytes on average\r\n", pcName, ( double ) ullTotal / 1000.0 );
+
+    return 0;
+}
+/*-----------------------------------------------------------*/
+
+static void prvRun( const char * pcName,
+                    Encode_t xEncode,
+                    Decode_t xDecode,
+                    uint32_t ulMessages )
+{
+    uint8_t ucBuffer[ benchmarkBUFFER_SIZE ];
+    BenchmarkTelemetry_t xTelemetry;
+    uint32_t ulLength = 0;
+    uint64_t ullStart;
+    double xEncodeRate;
+    double xDecodeRate;
+    uint32_t ulMessage;
+
+    ullStart = ullBenchmarkGetNanoseconds();
+
+    for( ulMessage = 0; ulMessage < ulMessages; ulMessage++ )
+    {
+        prvGetTelemetry( ulMessage, &xTelemetry );
+        ( void ) xEncode( &xTelemetry, ucBuffer, &ulLength );
+        ulBenchmarkSink += ulLength;
+    }
+
+    xEncodeRate = ulMessages * 1e9 / ( double ) ( ullBenchmarkGetNanoseconds() - ullStart );
+
+    ullStart = ullBenchmarkGetNanoseconds();
+
+    for( ulMessage = 0; ulMessage < ulMessages; ulMessage++ )
+    {
+        ( void ) xDecode( ucBuffer, ulLength, &xTelemetry );
+        ulBenchmarkSink += ( uint32_t ) xTelemetry.lPressure;
+    }
+
+    xDecodeRate = ulMessages * 1e9 / ( double ) ( ullBenchmarkGetNanoseconds() - ullStart );
+
+    printf( "%-10s %14.0f %14.0f\r\n", pcName, xEncodeRate, xDecodeRate );
+}
+/*-----------------------------------------------------------*/
+
+int main( int argc,
+          char ** argv )
+{
+    uint32_t ulMessages = ulBenchmarkGetCount( argc, argv, benchmarkDEFAULT_MESSAGES );
+
+    if( ( ulMessages == 0 ) ||
+        prvCheck( "JSON", prvEncodeJSON, prvDecodeJSON ) ||
+        prvCheck( "CBOR", prvEncodeCBOR, prvDecodeCBOR ) )
+    {
+        return 1;
+    }
+
+    printf( "\r\n%-10s %14s %14s\r\n", "messages/s", "encode", "decode" );
+    prvRun( "JSON", prvEncodeJSON, prvDecodeJSON, ulMessages );
+    prvRun( "CBOR", prvEncodeCBOR, prvDecodeCBOR, ulMessages );
+
+    return 0;
+}
+/*-----------------------------------------------------------*/
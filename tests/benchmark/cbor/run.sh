@@ -0,0 +1,21 @@
+#!/bin/bash
+
+# Copyright (c) Microsoft. All rights reserved.
+# Licensed under the MIT license. See LICENSE file in the project root for full license information.
+#
+# This script builds the CBOR benchmark and runs it
+
+# ./run.sh <FreeRTOS Src path> [messages]
+# e.g. ./run.sh ~/FreeRTOS 1000000
+
+source "$(dirname "$0")/../common/benchmark.sh"
+
+messages=${2:-1000000}
+
+pushd "$dir"
+
+benchmark_build Release
+
+./build/azure_iot_cbor_benchmark $messages
+
+popd
@@ -0,0 +1,23 @@
+# Copyright (c) Microsoft Corporation.
+# Licensed under the MIT License.
+
+# Included by the CMakeLists.txt of each benchmark after its project(): builds the middleware
+# against the FreeRTOS POSIX port and the benchmark_common library.
+
+if("${FREERTOS_DIRECTORY}" STREQUAL "")
+  message(FATAL_ERROR "${PROJECT_NAME} needs a FreeRTOS directory.")
+endif()
+
+include_directories(${CMAKE_CURRENT_LIST_DIR}/../../config_files)# Include config
+
+add_compile_options(-DprojCOVERAGE_TEST=0)
+
+include_directories(${FREERTOS_DIRECTORY}/FreeRTOS/Source/include)
+include_directories(${FREERTOS_DIRECTORY}/FreeRTOS/Source/portable/ThirdParty/GCC/Posix)
+
+# Add source files and libs
+add_subdirectory(${CMAKE_CURRENT_LIST_DIR}/../../../source source)
+
+add_library(benchmark_common ${CMAKE_CURRENT_LIST_DIR}/benchmark_common.c)
+target_include_directories(benchmark_common PUBLIC ${CMAKE_CURRENT_LIST_DIR})
+target_link_libraries(benchmark_common PUBLIC az::iot_middleware::freertos)
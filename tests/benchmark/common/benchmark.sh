@@ -0,0 +1,29 @@
+#!/bin/bash
+
+# Copyright (c) Microsoft. All rights reserved.
+# Licensed under the MIT license. See LICENSE file in the project root for full license information.
+#
+# Sourced by the run.sh of each benchmark with its arguments: checks the FreeRTOS source path
+# and defines benchmark_build, which builds the benchmark in its build directory.
+
+# Trace each command by: export DEBUG_SHELL=1
+if [[ ! -z ${DEBUG_SHELL} ]]
+then
+  set -x # Activate the expand mode if DEBUG is anything but empty.
+fi
+
+set -o errexit # Exit if command failed.
+set -o nounset # Exit if variable not set.
+set -o pipefail # Exit if pipe failed.
+
+dir=$(cd "$(dirname "$0")" && pwd)
+freertos_src_path=${1:-""}
+
+[ -n "$freertos_src_path" ] || { echo "\$1=FreeRTOS source path not set"; exit 1; }
+
+# benchmark_build <build type>
+benchmark_build()
+{
+  cmake -Bbuild -DCMAKE_BUILD_TYPE=$1 -DFREERTOS_DIRECTORY=$freertos_src_path .
+  cmake --build build
+}
@@ -0,0 +1,117 @@
+/* Copyright (c) Microsoft Corporation.
+ * Licensed under the MIT License. */
+
+/**
+ * @file benchmark_common.c
+ * @brief Timing, result sink, argument parsing and the telemetry shared by the benchmarks.
+ */
+
+#include "benchmark_common.h"
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#if defined( __x86_64__ ) || defined( __i386__ )
+    #include <x86intrin.h>
+#endif
+
+#include "azure_iot_json_writer.h"
+/*-----------------------------------------------------------*/
+
+const uint8_t ucBenchmarkTemperature[ sizeof( "temperature" ) ] = "temperature";
+const uint8_t ucBenchmarkHumidity[ sizeof( "humidity" ) ] = "humidity";
+const uint8_t ucBenchmarkPressure[ sizeof( "pressure" ) ] = "pressure";
+const uint8_t ucBenchmarkDoorOpen[ sizeof( "doorOpen" ) ] = "doorOpen";
+const uint8_t ucBenchmarkState[ sizeof( "state" ) ] = "state";
+
+volatile uint32_t ulBenchmarkSink;
+/*-----------------------------------------------------------*/
+
+void vLoggingPrintf( const char * pcFormat,
+                     ... )
+{
+    va_list arg;
+
+    va_start( arg, pcFormat );
+    vprintf( pcFormat, arg );
+    va_end( arg );
+}
+/*-----------------------------------------------------------*/
+
+uint64_t ullBenchmarkGetNanoseconds( void )
+{
+    struct timespec xTime;
+
+    clock_gettime( CLOCK_MONOTONIC, &xTime );
+
+    return ( uint64_t ) xTime.tv_sec * 1000000000ULL + ( uint64_t ) xTime.tv_nsec;
+}
+/*-----------------------------------------------------------*/
+
+uint64_t ullBenchmarkGetTimestamp( void )
+{
+    #if defined( __x86_64__ ) || defined( __i386__ )
+        return __rdtsc();
+    #else
+        return ullBenchmarkGetNanoseconds();
+    #endif
+}
+/*-----------------------------------------------------------*/
+
+uint32_t ulBenchmarkGetCount( int argc,
+                              char ** argv,
+                              uint32_t ulDefault )
+{
+    return ( argc > 1 ) ? ( uint32_t ) strtoul( argv[ 1 ], NULL, 10 ) : ulDefault;
+}
+/*-----------------------------------------------------------*/
+
+void vBenchmarkTelemetrySetState( BenchmarkTelemetry_t * pxTelemetry,
+                                  const char * pcState )
+{
+    pxTelemetry->ulStateLength = ( uint32_t ) strlen( pcState );
+
+    if( pxTelemetry->ulStateLength > benchmarkTELEMETRY_STATE_SIZE )
+    {
+        pxTelemetry->ulStateLength = benchmarkTELEMETRY_STATE_SIZE;
+    }
+
+    memcpy( pxTelemetry->ucState, pcState, pxTelemetry->ulStateLength );
+}
+/*-----------------------------------------------------------*/
+
+AzureIoTResult_t xBenchmarkTelemetryWriteJSON( const BenchmarkTelemetry_t * pxTelemetry,
+                                               uint16_t usTemperatureDigits,
+                                               uint8_t * pucBuffer,
+                                               uint32_t ulBufferLength,
+                                               uint32_t * pulLength )
+{
+    AzureIoTJSONWriter_t xWriter;
+    AzureIoTResult_t xResult;
+
+    if( ( ( xResult = AzureIoTJSONWriter_Init( &xWriter, pucBuffer, ulBufferLength ) ) != eAzureIoTSuccess ) ||
+        ( ( xResult = AzureIoTJSONWriter_AppendBeginObject( &xWriter ) ) != eAzureIoTSuccess ) ||
+        ( ( xResult = AzureIoTJSONWriter_AppendPropertyWithDoubleValue( &xWriter, ucBenchmarkTemperature, sizeof( ucBenchmarkTemperature ) - 1,
+                                                                         pxTelemetry->xTemperature, usTemperatureDigits ) ) != eAzureIoTSuccess ) ||
+        ( ( xResult = AzureIoTJSONWriter_AppendPropertyWithDoubleValue( &xWriter, ucBenchmarkHumidity, sizeof( ucBenchmarkHumidity ) - 1,
+                                                                         pxTelemetry->xHumidity, 1 ) ) != eAzureIoTSuccess ) ||
+        ( ( xResult = AzureIoTJSONWriter_AppendPropertyWithInt32Value( &xWriter, ucBenchmarkPressure, sizeof( ucBenchmarkPressure ) - 1,
+                                                                        pxTelemetry->lPressure ) ) != eAzureIoTSuccess ) ||
+        ( ( xResult = AzureIoTJSONWriter_AppendPropertyWithBoolValue( &xWriter, ucBenchmarkDoorOpen, sizeof( ucBenchmarkDoorOpen ) - 1,
+                                                                       pxTelemetry->xDoorOpen ) ) != eAzureIoTSuccess ) ||
+        ( ( xResult = AzureIoTJSONWriter_AppendPropertyWithStringValue( &xWriter, ucBenchmarkState, sizeof( ucBenchmarkState ) - 1,
+                                                                         pxTelemetry->ucState,
+                                                                         pxTelemetry->ulStateLength ) ) != eAzureIoTSuccess ) ||
+        ( ( xResult = AzureIoTJSONWriter_AppendEndObject( &xWriter ) ) != eAzureIoTSuccess ) )
+    {
+        return xResult;
+    }
+
+    *pulLength = ( uint32_t ) AzureIoTJSONWriter_GetBytesUsed( &xWriter );
+
+    return eAzureIoTSuccess;
+}
+/*-----------------------------------------------------------*/
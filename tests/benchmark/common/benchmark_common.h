@@ -0,0 +1,94 @@
+/* Copyright (c) Microsoft Corporation.
+ * Licensed under the MIT License. */
+
+/**
+ * @file benchmark_common.h
+ * @brief Timing, result sink, argument parsing and the telemetry shared by the benchmarks.
+ */
+
+#ifndef BENCHMARK_COMMON_H
+#define BENCHMARK_COMMON_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "azure_iot_result.h"
+
+/**
+ * @brief Unit of ullBenchmarkGetTimestamp(): time stamp counter cycles on x86, nanoseconds elsewhere.
+ */
+#if defined( __x86_64__ ) || defined( __i386__ )
+    #define benchmarkTIMESTAMP_UNIT    "cycles"
+#else
+    #define benchmarkTIMESTAMP_UNIT    "ns"
+#endif
+
+#define benchmarkTELEMETRY_STATE_SIZE    ( 16U )
+
+/**
+ * @brief The telemetry object written and read by the payload benchmarks.
+ */
+typedef struct BenchmarkTelemetry
+{
+    double xTemperature;
+    double xHumidity;
+    int32_t lPressure;
+    bool xDoorOpen;
+    uint8_t ucState[ benchmarkTELEMETRY_STATE_SIZE ];
+    uint32_t ulStateLength;
+} BenchmarkTelemetry_t;
+
+/* Property names of #BenchmarkTelemetry_t, sized so that `sizeof() - 1` is their length. */
+extern const uint8_t ucBenchmarkTemperature[ sizeof( "temperature" ) ];
+extern const uint8_t ucBenchmarkHumidity[ sizeof( "humidity" ) ];
+extern const uint8_t ucBenchmarkPressure[ sizeof( "pressure" ) ];
+extern const uint8_t ucBenchmarkDoorOpen[ sizeof( "doorOpen" ) ];
+extern const uint8_t ucBenchmarkState[ sizeof( "state" ) ];
+
+/**
+ * @brief Add the results of the measured calls here, so the compiler cannot drop the calls.
+ */
+extern volatile uint32_t ulBenchmarkSink;
+
+/**
+ * @brief Monotonic time in nanoseconds.
+ */
+uint64_t ullBenchmarkGetNanoseconds( void );
+
+/**
+ * @brief Finer grained time for short calls, in #benchmarkTIMESTAMP_UNIT.
+ */
+uint64_t ullBenchmarkGetTimestamp( void );
+
+/**
+ * @brief Get the repetition count given as the first argument, or \p ulDefault without one.
+ *
+ * @return The count, 0 if the argument is not a number.
+ */
+uint32_t ulBenchmarkGetCount( int argc,
+                              char ** argv,
+                              uint32_t ulDefault );
+
+/**
+ * @brief Set the state of a #BenchmarkTelemetry_t, truncated to #benchmarkTELEMETRY_STATE_SIZE.
+ */
+void vBenchmarkTelemetrySetState( BenchmarkTelemetry_t * pxTelemetry,
+                                  const char * pcState );
+
+/**
+ * @brief Write a #BenchmarkTelemetry_t as a JSON object with AzureIoTJSONWriter_t.
+ *
+ * @param[in] pxTelemetry The telemetry to write.
+ * @param[in] usTemperatureDigits The fractional digits of the temperature. The humidity has one.
+ * @param[out] pucBuffer The buffer to write to.
+ * @param[in] ulBufferLength The length of \p pucBuffer.
+ * @param[out] pulLength The length of the JSON object.
+ * @return An #AzureIoTResult_t with the result of the operation.
+ */
+AzureIoTResult_t xBenchmarkTelemetryWriteJSON( const BenchmarkTelemetry_t * pxTelemetry,
+                                               uint16_t usTemperatureDigits,
+                                               uint8_t * pucBuffer,
+                                               uint32_t ulBufferLength,
+                                               uint32_t * pulLength );
+
+#endif /* BENCHMARK_COMMON_H */
@@ -0,0 +1,197 @@
+/* Copyright (c) Microsoft Corporation.
+ * Licensed under the MIT License. */
+
+/**
+ * @file main.c
+ * @brief Compares the code generated by tools/dtdl_codegen with the equivalent hand-written
+ * AzureIoTJSONWriter and AzureIoTJSONReader code.
+ *
+ * Checks that both produce the same payloads and properties, then prints the time stamp counter
+ * cycles (nanoseconds on other architectures than x86) per call.
+ *
+ * Usage: azure_iot_json_codegen_benchmark [iterations]
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "azure_iot_json_reader.h"
+
+#include "benchmark_common.h"
+#include "thermostat_hand_written.h"
+#include "thermostat_model.h"
+/*-----------------------------------------------------------*/
+
+#define benchmarkDEFAULT_ITERATIONS    ( 1000000U )
+#define benchmarkBUFFER_SIZE           ( 256U )
+/*-----------------------------------------------------------*/
+
+static const uint8_t ucWritableProperties[] =
+    "{\"targetTemperature\":22.5,\"reportInterval\":60,\"mode\":\"eco\",\"ecoEnabled\":true,\"$version\":3}";
+/*-----------------------------------------------------------*/
+
+typedef AzureIoTResult_t ( * ParseProperty_t )( AzureIoTJSONReader_t * pxReader,
+                                                ThermostatWritableProperties_t * pxProperties );
+
+/* Reads the properties of ucWritableProperties, as the loop over
+ * AzureIoTHubClientProperties_GetNextComponentProperty() of a device would. */
+static AzureIoTResult_t prvParseWritableProperties( ParseProperty_t xParse,
+                                                    ThermostatWritableProperties_t * pxProperties )
+{
+    AzureIoTJSONReader_t xReader;
+    AzureIoTJSONTokenType_t xTokenType;
+    AzureIoTResult_t xResult;
+
+    memset( pxProperties, 0, sizeof( *pxProperties ) );
+
+    if( ( ( xResult = AzureIoTJSONReader_Init( &xReader, ucWritableProperties, sizeof( ucWritableProperties ) - 1 ) ) != eAzureIoTSuccess ) ||
+        ( ( xResult = AzureIoTJSONReader_NextToken( &xReader ) ) != eAzureIoTSuccess ) ||
+        ( ( xResult = AzureIoTJSONReader_NextToken( &xReader ) ) != eAzureIoTSuccess ) )
+    {
+        return xResult;
+    }
+
+    while( ( ( xResult = AzureIoTJSONReader_TokenType( &xReader, &xTokenType ) ) == eAzureIoTSuccess ) &&
+           ( xTokenType == eAzureIoTJSONTokenPROPERTY_NAME ) )
+    {
+        xResult = xParse( &xReader, pxProperties );
+
+        if( ( xResult != eAzureIoTSuccess ) && ( xResult != eAzureIoTErrorItemNotFound ) )
+        {
+            return xResult;
+        }
+    }
+
+    return xResult;
+}
+/*-----------------------------------------------------------*/
+
+typedef AzureIoTResult_t ( * Serialize_t )( const void * pvValue,
+                                            uint8_t * pucBuffer,
+                                            uint32_t ulBufferLength,
+                                            uint32_t * pulBytesWritten );
+
+static double prvTimeSerialize( Serialize_t xSerialize,
+                                const void * pvValue,
+                                uint32_t ulIterations )
+{
+    uint8_t ucBuffer[ benchmarkBUFFER_SIZE ];
+    uint32_t ulBytesWritten = 0;
+    uint64_t ullStart = ullBenchmarkGetTimestamp();
+    uint32_t ulIndex;
+
+    for( ulIndex = 0; ulIndex < ulIterations; ulIndex++ )
+    {
+        ( void ) xSerialize( pvValue, ucBuffer, sizeof( ucBuffer ), &ulBytesWritten );
+        ulBenchmarkSink += ulBytesWritten;
+    }
+
+    return ( double ) ( ullBenchmarkGetTimestamp() - ullStart ) / ulIterations;
+}
+/*-----------------------------------------------------------*/
+
+static double prvTimeParse( ParseProperty_t xParse,
+                            uint32_t ulIterations )
+{
+    ThermostatWritableProperties_t xProperties;
+    uint64_t ullStart = ullBenchmarkGetTimestamp();
+    uint32_t ulIndex;
+
+    for( ulIndex = 0; ulIndex < ulIterations; ulIndex++ )
+    {
+        ( void ) prvParseWritableProperties( xParse, &xProperties );
+        ulBenchmarkSink += xProperties.ulPresent;
+    }
+
+    return ( double ) ( ullBenchmarkGetTimestamp() - ullStart ) / ulIterations;
+}
+/*-----------------------------------------------------------*/
+
+static int prvCheckSerialize( const char * pcName,
+                              Serialize_t xHandWritten,
+                              Serialize_t xGenerated,
+                              const void * pvValue )
+{
+    uint8_t ucExpected[ benchmarkBUFFER_SIZE ];
+    uint8_t ucActual[ benchmarkBUFFER_SIZE ];
+    uint32_t ulExpectedLength = 0;
+    uint32_t ulActualLength = 0;
+
+    if( ( xHandWritten( pvValue, ucExpected, sizeof( ucExpected ), &ulExpectedLength ) != eAzureIoTSuccess ) ||
+        ( xGenerated( pvValue, ucActual, sizeof( ucActual ), &ulActualLength ) != eAzureIoTSuccess ) ||
+        ( ulExpectedLength != ulActualLength ) ||
+        ( memcmp( ucExpected, ucActual, ulActualLength ) != 0 ) )
+    {
+        printf( "%s: generated %.*s, hand-written %.*s\r\n", pcName,
+                ( int ) ulActualLength, ucActual, ( int ) ulExpectedLength, ucExpected );
+        return 1;
+    }
+
+    printf( "%s (%u bytes): %.*s\r\n", pcName, ( unsigned ) ulActualLength, ( int ) ulActualLength, ucActual );
+
+    return 0;
+}
+/*-----------------------------------------------------------*/
+
+int main( int argc,
+          char ** argv )
+{
+    uint32_t ulIterations = ulBenchmarkGetCount( argc, argv, benchmarkDEFAULT_ITERATIONS );
+    ThermostatTelemetry_t xTelemetry = { 0 };
+    ThermostatReportedProperties_t xReported = { 0 };
+    ThermostatWritableProperties_t xExpected;
+    ThermostatWritableProperties_t xActual;
+    double xHandWritten;
+    double xGenerated;
+
+    xTelemetry.xTemperature = 21.37;
+    xTelemetry.xHumidity = 48.5;
+    xTelemetry.lBatteryLevel = 87;
+    xTelemetry.pucState = ( const uint8_t * ) "heating";
+    xTelemetry.ulStateLength = sizeof( "heating" ) - 1;
+
+    xReported.ulPresent = thermostatREPORTED_MAX_TEMP_SINCE_LAST_REBOOT | thermostatREPORTED_SERIAL_NUMBER |
+                          thermostatREPORTED_UPTIME_SECONDS | thermostatREPORTED_HEATING;
+    xReported.xMaxTempSinceLastReboot = 25.1;
+    xReported.pucSerialNumber = ( const uint8_t * ) "SN-0042-\"A\"";
+    xReported.ulSerialNumberLength = sizeof( "SN-0042-\"A\"" ) - 1;
+    xReported.llUptimeSeconds = 86400;
+    xReported.xHeating = true;
+
+    if( ( ulIterations == 0 ) ||
+        prvCheckSerialize( "Telemetry", ( Serialize_t ) HandWritten_SerializeTelemetry,
+                           ( Serialize_t ) Thermostat_SerializeTelemetry, &xTelemetry ) ||
+        prvCheckSerialize( "Reported properties", ( Serialize_t ) HandWritten_SerializeReportedProperties,
+                           ( Serialize_t ) Thermostat_SerializeReportedProperties, &xReported ) )
+    {
+        return 1;
+    }
+
+    if( ( prvParseWritableProperties( HandWritten_ParseWritableProperty, &xExpected ) != eAzureIoTSuccess ) ||
+        ( prvParseWritableProperties( Thermostat_ParseWritableProperty, &xActual ) != eAzureIoTSuccess ) ||
+        ( xActual.ulPresent != ( thermostatWRITABLE_TARGET_TEMPERATURE | thermostatWRITABLE_REPORT_INTERVAL |
+                                 thermostatWRITABLE_MODE | thermostatWRITABLE_ECO_ENABLED ) ) ||
+        ( memcmp( &xExpected, &xActual, sizeof( xActual ) ) != 0 ) )
+    {
+        printf( "Writable properties: generated and hand-written differ\r\n" );
+        return 1;
+    }
+
+    printf( "Writable properties: %.*s\r\n\r\n", ( int ) sizeof( ucWritableProperties ) - 1, ucWritableProperties );
+    printf( "%-22s %14s %14s %8s\r\n", benchmarkTIMESTAMP_UNIT " per call", "hand-written", "generated", "speedup" );
+
+    xHandWritten = prvTimeSerialize( ( Serialize_t ) HandWritten_SerializeTelemetry, &xTelemetry, ulIterations );
+    xGenerated = prvTimeSerialize( ( Serialize_t ) Thermostat_SerializeTelemetry, &xTelemetry, ulIterations );
+    printf( "%-22s %14.1f %14.1f %7.2fx\r\n", "Telemetry", xHandWritten, xGenerated, xHandWritten / xGenerated );
+
+    xHandWritten = prvTimeSerialize( ( Serialize_t ) HandWritten_SerializeReportedProperties, &xReported, ulIterations );
+    xGenerated = prvTimeSerialize( ( Serialize_t ) Thermostat_SerializeReportedProperties, &xReported, ulIterations );
+    printf( "%-22s %14.1f %14.1f %7.2fx\r\n", "Reported properties", xHandWritten, xGenerated, xHandWritten / xGenerated );
+
+    xHandWritten = prvTimeParse( HandWritten_ParseWritableProperty, ulIterations );
+    xGenerated = prvTimeParse( Thermostat_ParseWritableProperty, ulIterations );
+    printf( "%-22s %14.1f %14.1f %7.2fx\r\n", "Writable properties", xHandWritten, xGenerated, xHandWritten / xGenerated );
+
+    return 0;
+}
+/*-----------------------------------------------------------*/
@@ -0,0 +1,24 @@
+#!/bin/bash
+
+# Copyright (c) Microsoft. All rights reserved.
+# Licensed under the MIT license. See LICENSE file in the project root for full license information.
+#
+# This script builds the JSON codegen benchmark, prints the code size of the generated and the
+# hand-written thermostat code, and runs the benchmark
+
+# ./run.sh <FreeRTOS Src path> [iterations]
+# e.g. ./run.sh ~/FreeRTOS 1000000
+
+source "$(dirname "$0")/../common/benchmark.sh"
+
+iterations=${2:-1000000}
+
+pushd "$dir"
+
+benchmark_build MinSizeRel
+
+size build/libthermostat_hand_written.a build/libthermostat_generated.a
+
+./build/azure_iot_json_codegen_benchmark $iterations
+
+popd
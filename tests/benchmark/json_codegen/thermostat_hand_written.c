@@ -0,0 +1,133 @@
+/* Copyright (c) Microsoft Corporation.
+ * Licensed under the MIT License. */
+
+/**
+ * @file thermostat_hand_written.c
+ * @brief The thermostat model written with AzureIoTJSONWriter and AzureIoTJSONReader calls, as
+ * devices do without the generator.
+ */
+
+#include "thermostat_hand_written.h"
+
+#include "azure_iot_json_writer.h"
+/*-----------------------------------------------------------*/
+
+#define handwrittenFRACTIONAL_DIGITS    ( 2 )
+/*-----------------------------------------------------------*/
+
+AzureIoTResult_t HandWritten_SerializeTelemetry( const ThermostatTelemetry_t * pxTelemetry,
+                                                 uint8_t * pucBuffer,
+                                                 uint32_t ulBufferLength,
+                                                 uint32_t * pulBytesWritten )
+{
+    AzureIoTJSONWriter_t xWriter;
+    AzureIoTResult_t xResult;
+
+    if( ( ( xResult = AzureIoTJSONWriter_Init( &xWriter, pucBuffer, ulBufferLength ) ) != eAzureIoTSuccess ) ||
+        ( ( xResult = AzureIoTJSONWriter_AppendBeginObject( &xWriter ) ) != eAzureIoTSuccess ) ||
+        ( ( xResult = AzureIoTJSONWriter_AppendPropertyWithDoubleValue( &xWriter, ( const uint8_t * ) "temperature", sizeof( "temperature" ) - 1,
+                                                                         pxTelemetry->xTemperature, handwrittenFRACTIONAL_DIGITS ) ) != eAzureIoTSuccess ) ||
+        ( ( xResult = AzureIoTJSONWriter_AppendPropertyWithDoubleValue( &xWriter, ( const uint8_t * ) "humidity", sizeof( "humidity" ) - 1,
+                                                                         pxTelemetry->xHumidity, handwrittenFRACTIONAL_DIGITS ) ) != eAzureIoTSuccess ) ||
+        ( ( xResult = AzureIoTJSONWriter_AppendPropertyWithInt32Value( &xWriter, ( const uint8_t * ) "batteryLevel", sizeof( "batteryLevel" ) - 1,
+                                                                        pxTelemetry->lBatteryLevel ) ) != eAzureIoTSuccess ) ||
+        ( ( xResult = AzureIoTJSONWriter_AppendPropertyWithStringValue( &xWriter, ( const uint8_t * ) "state", sizeof( "state" ) - 1,
+                                                                         pxTelemetry->pucState, pxTelemetry->ulStateLength ) ) != eAzureIoTSuccess ) ||
+        ( ( xResult = AzureIoTJSONWriter_AppendEndObject( &xWriter ) ) != eAzureIoTSuccess ) )
+    {
+        return xResult;
+    }
+
+    *pulBytesWritten = ( uint32_t ) AzureIoTJSONWriter_GetBytesUsed( &xWriter );
+
+    return eAzureIoTSuccess;
+}
+/*-----------------------------------------------------------*/
+
+AzureIoTResult_t HandWritten_SerializeReportedProperties( const ThermostatReportedProperties_t * pxProperties,
+                                                          uint8_t * pucBuffer,
+                                                          uint32_t ulBufferLength,
+                                                          uint32_t * pulBytesWritten )
+{
+    AzureIoTJSONWriter_t xWriter;
+    AzureIoTResult_t xResult;
+
+    /* The writer has no 64 bit integer, the uptime of the benchmark fits in an int32_t. */
+    if( ( ( xResult = AzureIoTJSONWriter_Init( &xWriter, pucBuffer, ulBufferLength ) ) != eAzureIoTSuccess ) ||
+        ( ( xResult = AzureIoTJSONWriter_AppendBeginObject( &xWriter ) ) != eAzureIoTSuccess ) ||
+        ( ( xResult = AzureIoTJSONWriter_AppendPropertyWithDoubleValue( &xWriter, ( const uint8_t * ) "maxTempSinceLastReboot", sizeof( "maxTempSinceLastReboot" ) - 1,
+                                                                         pxProperties->xMaxTempSinceLastReboot, handwrittenFRACTIONAL_DIGITS ) ) != eAzureIoTSuccess ) ||
+        ( ( xResult = AzureIoTJSONWriter_AppendPropertyWithStringValue( &xWriter, ( const uint8_t * ) "serialNumber", sizeof( "serialNumber" ) - 1,
+                                                                         pxProperties->pucSerialNumber, pxProperties->ulSerialNumberLength ) ) != eAzureIoTSuccess ) ||
+        ( ( xResult = AzureIoTJSONWriter_AppendPropertyWithInt32Value( &xWriter, ( const uint8_t * ) "uptimeSeconds", sizeof( "uptimeSeconds" ) - 1,
+                                                                        ( int32_t ) pxProperties->llUptimeSeconds ) ) != eAzureIoTSuccess ) ||
+        ( ( xResult = AzureIoTJSONWriter_AppendPropertyWithBoolValue( &xWriter, ( const uint8_t * ) "heating", sizeof( "heating" ) - 1,
+                                                                       pxProperties->xHeating ) ) != eAzureIoTSuccess ) ||
+        ( ( xResult = AzureIoTJSONWriter_AppendEndObject( &xWriter ) ) != eAzureIoTSuccess ) )
+    {
+        return xResult;
+    }
+
+    *pulBytesWritten = ( uint32_t ) AzureIoTJSONWriter_GetBytesUsed( &xWriter );
+
+    return eAzureIoTSuccess;
+}
+/*-----------------------------------------------------------*/
+
+AzureIoTResult_t HandWritten_ParseWritableProperty( AzureIoTJSONReader_t * pxReader,
+                                                    ThermostatWritableProperties_t * pxProperties )
+{
+    AzureIoTResult_t xResult;
+
+    if( AzureIoTJSONReader_TokenIsTextEqual( pxReader, ( const uint8_t * ) "targetTemperature", sizeof( "targetTemperature" ) - 1 ) )
+    {
+        if( ( ( xResult = AzureIoTJSONReader_NextToken( pxReader ) ) == eAzureIoTSuccess ) &&
+            ( ( xResult = AzureIoTJSONReader_GetTokenDouble( pxReader, &pxProperties->xTargetTemperature ) ) == eAzureIoTSuccess ) )
+        {
+            pxProperties->ulPresent |= thermostatWRITABLE_TARGET_TEMPERATURE;
+        }
+    }
+    else if( AzureIoTJSONReader_TokenIsTextEqual( pxReader, ( const uint8_t * ) "reportInterval", sizeof( "reportInterval" ) - 1 ) )
+    {
+        if( ( ( xResult = AzureIoTJSONReader_NextToken( pxReader ) ) == eAzureIoTSuccess ) &&
+            ( ( xResult = AzureIoTJSONReader_GetTokenInt32( pxReader, &pxProperties->lReportInterval ) ) == eAzureIoTSuccess ) )
+        {
+            pxProperties->ulPresent |= thermostatWRITABLE_REPORT_INTERVAL;
+        }
+    }
+    else if( AzureIoTJSONReader_TokenIsTextEqual( pxReader, ( const uint8_t * ) "mode", sizeof( "mode" ) - 1 ) )
+    {
+        if( ( ( xResult = AzureIoTJSONReader_NextToken( pxReader ) ) == eAzureIoTSuccess ) &&
+            ( ( xResult = AzureIoTJSONReader_GetTokenString( pxReader, pxProperties->ucMode, sizeof( pxProperties->ucMode ),
+                                                              &pxProperties->ulModeLength ) ) == eAzureIoTSuccess ) )
+        {
+            pxProperties->ulPresent |= thermostatWRITABLE_MODE;
+        }
+    }
+    else if( AzureIoTJSONReader_TokenIsTextEqual( pxReader, ( const uint8_t * ) "ecoEnabled", sizeof( "ecoEnabled" ) - 1 ) )
+    {
+        if( ( ( xResult = AzureIoTJSONReader_NextToken( pxReader ) ) == eAzureIoTSuccess ) &&
+            ( ( xResult = AzureIoTJSONReader_GetTokenBool( pxReader, &pxProperties->xEcoEnabled ) ) == eAzureIoTSuccess ) )
+        {
+            pxProperties->ulPresent |= thermostatWRITABLE_ECO_ENABLED;
+        }
+    }
+    else if( ( ( xResult = AzureIoTJSONReader_NextToken( pxReader ) ) == eAzureIoTSuccess ) &&
+             ( ( xResult = AzureIoTJSONReader_SkipChildren( pxReader ) ) == eAzureIoTSuccess ) )
+    {
+        xResult = eAzureIoTErrorItemNotFound;
+    }
+
+    if( ( xResult == eAzureIoTSuccess ) || ( xResult == eAzureIoTErrorItemNotFound ) )
+    {
+        AzureIoTResult_t xNextResult = AzureIoTJSONReader_NextToken( pxReader );
+
+        if( xNextResult != eAzureIoTSuccess )
+        {
+            xResult = xNextResult;
+        }
+    }
+
+    return xResult;
+}
+/*-----------------------------------------------------------*/
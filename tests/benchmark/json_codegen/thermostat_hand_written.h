@@ -0,0 +1,29 @@
+/* Copyright (c) Microsoft Corporation.
+ * Licensed under the MIT License. */
+
+/**
+ * @file thermostat_hand_written.h
+ * @brief Hand-written equivalents of the functions generated for thermostat.json.
+ */
+
+#ifndef THERMOSTAT_HAND_WRITTEN_H
+#define THERMOSTAT_HAND_WRITTEN_H
+
+#include "azure_iot_json_reader.h"
+
+#include "thermostat_model.h"
+
+AzureIoTResult_t HandWritten_SerializeTelemetry( const ThermostatTelemetry_t * pxTelemetry,
+                                                 uint8_t * pucBuffer,
+                                                 uint32_t ulBufferLength,
+                                                 uint32_t * pulBytesWritten );
+
+AzureIoTResult_t HandWritten_SerializeReportedProperties( const ThermostatReportedProperties_t * pxProperties,
+                                                          uint8_t * pucBuffer,
+                                                          uint32_t ulBufferLength,
+                                                          uint32_t * pulBytesWritten );
+
+AzureIoTResult_t HandWritten_ParseWritableProperty( AzureIoTJSONReader_t * pxReader,
+                                                    ThermostatWritableProperties_t * pxProperties );
+
+#endif /* THERMOSTAT_HAND_WRITTEN_H */
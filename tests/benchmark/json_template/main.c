@@ -0,0 +1,201 @@
+/* Copyright (c) Microsoft Corporation.
+ * Licensed under the MIT License. */
+
+/**
+ * @file main.c
+ * @brief Messages formatted per second by the JSON template and by the JSON writer.
+ *
+ * Formats the same telemetry with both and checks the payloads are the same, for values whose
+ * formatted length never changes, and for values whose length changes on every message.
+ *
+ * Usage: azure_iot_json_template_benchmark [messages]
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "azure_iot_json_template.h"
+
+#include "benchmark_common.h"
+/*-----------------------------------------------------------*/
+
+#define benchmarkDEFAULT_MESSAGES    ( 1000000U )
+#define benchmarkBUFFER_SIZE         ( 256U )
+#define benchmarkSLOT_COUNT          ( 5U )
+/*-----------------------------------------------------------*/
+
+/* Lengths constant from one message to the next */
+static const char * const pcStableStates[] = { "idle", "busy", "done" };
+
+/* Lengths changing on every message */
+static const char * const pcChangingStates[] = { "idle", "heating", "off" };
+
+static AzureIoTJSONTemplate_t xTemplate;
+static AzureIoTJSONTemplateSlot_t xSlots[ benchmarkSLOT_COUNT ];
+static uint8_t ucTemplateBuffer[ benchmarkBUFFER_SIZE ];
+static uint32_t ulSlots[ benchmarkSLOT_COUNT ];
+/*-----------------------------------------------------------*/
+
+static void prvGetTelemetry( uint32_t ulMessage,
+                             bool xStable,
+                             BenchmarkTelemetry_t * pxTelemetry )
+{
+    if( xStable )
+    {
+        pxTelemetry->xTemperature = 20.25 + ( double ) ( ulMessage % 50U ) / 10.0;
+        pxTelemetry->xHumidity = 40.1 + ( double ) ( ulMessage % 9U ) / 10.0;
+        pxTelemetry->lPressure = 1000 + ( int32_t ) ( ulMessage % 9U );
+        pxTelemetry->xDoorOpen = false;
+        vBenchmarkTelemetrySetState( pxTelemetry, pcStableStates[ ulMessage % 3U ] );
+    }
+    else
+    {
+        pxTelemetry->xTemperature = ( ulMessage & 1U ) ? 9.5 : -10.25;
+        pxTelemetry->xHumidity = 40.5;
+        pxTelemetry->lPressure = ( ulMessage & 1U ) ? 999 : 1013;
+        pxTelemetry->xDoorOpen = ( ulMessage & 1U ) != 0;
+        vBenchmarkTelemetrySetState( pxTelemetry, pcChangingStates[ ulMessage % 3U ] );
+    }
+}
+/*-----------------------------------------------------------*/
+
+static AzureIoTResult_t prvFormatWithWriter( const BenchmarkTelemetry_t * pxTelemetry,
+                                             uint8_t * pucBuffer,
+                                             uint32_t * pulLength )
+{
+    return xBenchmarkTelemetryWriteJSON( pxTelemetry, 2, pucBuffer, benchmarkBUFFER_SIZE, pulLength );
+}
+/*-----------------------------------------------------------*/
+
+static AzureIoTResult_t prvInitTemplate( void )
+{
+    AzureIoTResult_t xResult;
+
+    if( ( ( xResult = AzureIoTJSONTemplate_Init( &xTemplate, xSlots, benchmarkSLOT_COUNT,
+                                                 ucTemplateBuffer, sizeof( ucTemplateBuffer ) ) ) != eAzureIoTSuccess ) ||
+        ( ( xResult = AzureIoTJSONTemplate_AddDoubleProperty( &xTemplate, ucBenchmarkTemperature, sizeof( ucBenchmarkTemperature ) - 1,
+                                                              2, &ulSlots[ 0 ] ) ) != eAzureIoTSuccess ) ||
+        ( ( xResult = AzureIoTJSONTemplate_AddDoubleProperty( &xTemplate, ucBenchmarkHumidity, sizeof( ucBenchmarkHumidity ) - 1,
+                                                              1, &ulSlots[ 1 ] ) ) != eAzureIoTSuccess ) ||
+        ( ( xResult = AzureIoTJSONTemplate_AddInt32Property( &xTemplate, ucBenchmarkPressure, sizeof( ucBenchmarkPressure ) - 1,
+                                                             &ulSlots[ 2 ] ) ) != eAzureIoTSuccess ) ||
+        ( ( xResult = AzureIoTJSONTemplate_AddBoolProperty( &xTemplate, ucBenchmarkDoorOpen, sizeof( ucBenchmarkDoorOpen ) - 1,
+                                                            &ulSlots[ 3 ] ) ) != eAzureIoTSuccess ) ||
+        ( ( xResult = AzureIoTJSONTemplate_AddStringProperty( &xTemplate, ucBenchmarkState, sizeof( ucBenchmarkState ) - 1,
+                                                              &ulSlots[ 4 ] ) ) != eAzureIoTSuccess ) )
+    {
+        return xResult;
+    }
+
+    return AzureIoTJSONTemplate_Render( &xTemplate );
+}
+/*-----------------------------------------------------------*/
+
+static AzureIoTResult_t prvFormatWithTemplate( const BenchmarkTelemetry_t * pxTelemetry,
+                                               const uint8_t ** ppucPayload,
+                                               uint32_t * pulLength )
+{
+    AzureIoTResult_t xResult;
+
+    if( ( ( xResult = AzureIoTJSONTemplate_SetDouble( &xTemplate, ulSlots[ 0 ], pxTelemetry->xTemperature ) ) != eAzureIoTSuccess ) ||
+        ( ( xResult = AzureIoTJSONTemplate_SetDouble( &xTemplate, ulSlots[ 1 ], pxTelemetry->xHumidity ) ) != eAzureIoTSuccess ) ||
+        ( ( xResult = AzureIoTJSONTemplate_SetInt32( &xTemplate, ulSlots[ 2 ], pxTelemetry->lPressure ) ) != eAzureIoTSuccess ) ||
+        ( ( xResult = AzureIoTJSONTemplate_SetBool( &xTemplate, ulSlots[ 3 ], pxTelemetry->xDoorOpen ) ) != eAzureIoTSuccess ) ||
+        ( ( xResult = AzureIoTJSONTemplate_SetString( &xTemplate, ulSlots[ 4 ], pxTelemetry->ucState,
+                                                      pxTelemetry->ulStateLength ) ) != eAzureIoTSuccess ) )
+    {
+        return xResult;
+    }
+
+    return AzureIoTJSONTemplate_GetPayload( &xTemplate, ppucPayload, pulLength );
+}
+/*-----------------------------------------------------------*/
+
+static int prvCheck( bool xStable )
+{
+    uint8_t ucExpected[ benchmarkBUFFER_SIZE ];
+    uint32_t ulExpectedLength;
+    const uint8_t * pucPayload;
+    uint32_t ulLength;
+    BenchmarkTelemetry_t xTelemetry;
+    uint32_t ulMessage;
+
+    for( ulMessage = 0; ulMessage < 100U; ulMessage++ )
+    {
+        prvGetTelemetry( ulMessage, xStable, &xTelemetry );
+
+        if( ( prvFormatWithWriter( &xTelemetry, ucExpected, &ulExpectedLength ) != eAzureIoTSuccess ) ||
+            ( prvFormatWithTemplate( &xTelemetry, &pucPayload, &ulLength ) != eAzureIoTSuccess ) ||
+            ( ulLength != ulExpectedLength ) ||
+            ( memcmp( pucPayload, ucExpected, ulLength ) != 0 ) )
+        {
+            printf( "Message %u differs: writer %.*s\r\n", ( unsigned ) ulMessage, ( int ) ulExpectedLength, ucExpected );
+            return 1;
+        }
+    }
+
+    printf( "%s lengths: %.*s\r\n", xStable ? "Stable" : "Changing", ( int ) ulLength, pucPayload );
+
+    return 0;
+}
+/*-----------------------------------------------------------*/
+
+static void prvRun( bool xStable,
+                    uint32_t ulMessages )
+{
+    uint8_t ucBuffer[ benchmarkBUFFER_SIZE ];
+    const uint8_t * pucPayload;
+    uint32_t ulLength = 0;
+    BenchmarkTelemetry_t xTelemetry;
+    uint64_t ullStart;
+    double xWriterRate;
+    double xTemplateRate;
+    uint32_t ulMessage;
+
+    ullStart = ullBenchmarkGetNanoseconds();
+
+    for( ulMessage = 0; ulMessage < ulMessages; ulMessage++ )
+    {
+        prvGetTelemetry( ulMessage, xStable, &xTelemetry );
+        ( void ) prvFormatWithWriter( &xTelemetry, ucBuffer, &ulLength );
+        ulBenchmarkSink += ulLength;
+    }
+
+    xWriterRate = ulMessages * 1e9 / ( double ) ( ullBenchmarkGetNanoseconds() - ullStart );
+
+    ullStart = ullBenchmarkGetNanoseconds();
+
+    for( ulMessage = 0; ulMessage < ulMessages; ulMessage++ )
+    {
+        prvGetTelemetry( ulMessage, xStable, &xTelemetry );
+        ( void ) prvFormatWithTemplate( &xTelemetry, &pucPayload, &ulLength );
+        ulBenchmarkSink += ulLength;
+    }
+
+    xTemplateRate = ulMessages * 1e9 / ( double ) ( ullBenchmarkGetNanoseconds() - ullStart );
+
+    printf( "%-18s %14.0f %14.0f %7.2fx\r\n", xStable ? "Stable lengths" : "Changing lengths",
+            xWriterRate, xTemplateRate, xTemplateRate / xWriterRate );
+}
+/*-----------------------------------------------------------*/
+
+int main( int argc,
+          char ** argv )
+{
+    uint32_t ulMessages = ulBenchmarkGetCount( argc, argv, benchmarkDEFAULT_MESSAGES );
+
+    if( ( ulMessages == 0 ) ||
+        ( prvInitTemplate() != eAzureIoTSuccess ) ||
+        prvCheck( true ) ||
+        prvCheck( false ) )
+    {
+        return 1;
+    }
+
+    printf( "\r\n%-18s %14s %14s %8s\r\n", "messages/s", "writer", "template", "speedup" );
+    prvRun( true, ulMessages );
+    prvRun( false, ulMessages );
+
+    return 0;
+}
+/*-----------------------------------------------------------*/
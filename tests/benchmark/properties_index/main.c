@@ -0,0 +1,367 @@
+/* Copyright (c) Microsoft Corporation.
+ * Licensed under the MIT License. */
+
+/**
+ * @file main.c
+ * @brief Documents per second handled by one handler per component, with and without a properties index.
+ *
+ * Builds a writable property document of about 6 KB with 12 components, then lets 12 handlers,
+ * one per component, read the `targetTemperature` of their component. Without the index each
+ * handler reads the document from the start with AzureIoTHubClientProperties_GetNextComponentProperty().
+ * With the index the document is read once by AzureIoTHubClientProperties_BuildIndex() and each
+ * handler reads its own properties with AzureIoTHubClientProperties_IndexGetNextProperty().
+ *
+ * Usage: azure_iot_properties_index_benchmark [documents]
+ */
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "azure_iot_hub_client.h"
+#include "azure_iot_hub_client_properties.h"
+#include "azure_iot_json_reader.h"
+
+#include "benchmark_common.h"
+/*-----------------------------------------------------------*/
+
+#define benchmarkDEFAULT_DOCUMENTS     ( 100000U )
+#define benchmarkCOMPONENTS            ( 12U )
+#define benchmarkPROPERTIES            ( 4U )
+#define benchmarkDOCUMENT_SIZE         ( 8192U )
+#define benchmarkCLIENT_BUFFER_SIZE    ( 512U )
+/*-----------------------------------------------------------*/
+
+typedef int ( * Handle_t )( const uint8_t * pucDocument,
+                            uint32_t ulLength,
+                            double * pxTargets,
+                            uint32_t * pulProperties );
+
+static const uint8_t ucHostname[] = "benchmark.azure-devices.net";
+static const uint8_t ucDeviceID[] = "benchmark";
+static const uint8_t ucTargetTemperature[] = "targetTemperature";
+
+static AzureIoTHubClientComponent_t xComponents[ benchmarkCOMPONENTS ] =
+{
+    azureiothubCREATE_COMPONENT( "thermostat01" ), azureiothubCREATE_COMPONENT( "thermostat02" ),
+    azureiothubCREATE_COMPONENT( "thermostat03" ), azureiothubCREATE_COMPONENT( "thermostat04" ),
+    azureiothubCREATE_COMPONENT( "thermostat05" ), azureiothubCREATE_COMPONENT( "thermostat06" ),
+    azureiothubCREATE_COMPONENT( "thermostat07" ), azureiothubCREATE_COMPONENT( "thermostat08" ),
+    azureiothubCREATE_COMPONENT( "thermostat09" ), azureiothubCREATE_COMPONENT( "thermostat10" ),
+    azureiothubCREATE_COMPONENT( "thermostat11" ), azureiothubCREATE_COMPONENT( "thermostat12" )
+};
+
+static AzureIoTHubClient_t xHubClient;
+static uint8_t ucClientBuffer[ benchmarkCLIENT_BUFFER_SIZE ];
+static uint8_t ucDocument[ benchmarkDOCUMENT_SIZE ];
+/*-----------------------------------------------------------*/
+
+static uint64_t prvGetTime( void )
+{
+    return 0;
+}
+/*-----------------------------------------------------------*/
+
+static int32_t prvTransportSend( void * pxNetworkContext,
+                                 const void * pvBuffer,
+                                 size_t xBytesToSend )
+{
+    ( void ) pxNetworkContext;
+    ( void ) pvBuffer;
+
+    return ( int32_t ) xBytesToSend;
+}
+/*-----------------------------------------------------------*/
+
+static int32_t prvTransportRecv( void * pxNetworkContext,
+                                 void * pvBuffer,
+                                 size_t xBytesToRecv )
+{
+    ( void ) pxNetworkContext;
+    ( void ) pvBuffer;
+    ( void ) xBytesToRecv;
+
+    return 0;
+}
+/*-----------------------------------------------------------*/
+
+static double prvExpectedTarget( uint32_t ulComponent )
+{
+    return 18.0 + ( double ) ulComponent / 2.0;
+}
+/*-----------------------------------------------------------*/
+
+static void prvAppend( uint32_t * pulLength,
+                       const char * pcFormat,
+                       ... )
+{
+    va_list arg;
+
+    if( *pulLength < sizeof( ucDocument ) )
+    {
+        va_start( arg, pcFormat );
+        *pulLength += ( uint32_t ) vsnprintf( ( char * ) ucDocument + *pulLength, sizeof( ucDocument ) - *pulLength,
+                                              pcFormat, arg );
+        va_end( arg );
+    }
+}
+/*-----------------------------------------------------------*/
+
+/*
+ * Each component has its target, a schedule array and a calibration object that handlers skip,
+ * and a description, which make up about 500 bytes per component.
+ */
+static uint32_t prvBuildDocument( void )
+{
+    uint32_t ulLength = 0;
+    uint32_t ulComponent;
+    uint32_t ulItem;
+
+    prvAppend( &ulLength, "{" );
+
+    for( ulComponent = 0; ulComponent < benchmarkCOMPONENTS; ulComponent++ )
+    {
+        prvAppend( &ulLength, "\"%.*s\":{\"__t\":\"c\",\"targetTemperature\":%.1f,\"schedule\":[",
+                   ( int ) az_span_size( xComponents[ ulComponent ] ),
+                   ( const char * ) az_span_ptr( xComponents[ ulComponent ] ),
+                   prvExpectedTarget( ulComponent ) );
+
+        for( ulItem = 0; ulItem < 24U; ulItem++ )
+        {
+            prvAppend( &ulLength, "%s%.1f", ( ulItem == 0 ) ? "" : ",", 16.0 + ( double ) ( ulItem % 8U ) / 2.0 );
+        }
+
+        prvAppend( &ulLength, "],\"calibration\":{" );
+
+        for( ulItem = 0; ulItem < 8U; ulItem++ )
+        {
+            prvAppend( &ulLength, "%s\"offset%u\":%.3f", ( ulItem == 0 ) ? "" : ",", ( unsigned ) ulItem,
+                       ( double ) ulItem / 8.0 );
+        }
+
+        prvAppend( &ulLength, "},\"description\":\"Thermostat %u, living area zone controller with a weekly schedule, "
+                              "hysteresis of half a degree and calibration offsets for each of its sensors\"},",
+                   ( unsigned ) ulComponent + 1U );
+    }
+
+    prvAppend( &ulLength, "\"$version\":42}" );
+
+    return ( ulLength < sizeof( ucDocument ) ) ? ulLength : 0;
+}
+/*-----------------------------------------------------------*/
+
+/*
+ * Each handler reads the document from the start and skips the components of the other handlers.
+ */
+static int prvHandleWithReader( const uint8_t * pucDocument,
+                                uint32_t ulLength,
+                                double * pxTargets,
+                                uint32_t * pulProperties )
+{
+    AzureIoTJSONReader_t xReader;
+    const uint8_t * pucComponentName;
+    uint32_t ulComponentNameLength;
+    uint32_t ulComponent;
+    AzureIoTResult_t xResult;
+
+    for( ulComponent = 0; ulComponent < benchmarkCOMPONENTS; ulComponent++ )
+    {
+        if( AzureIoTJSONReader_Init( &xReader, pucDocument, ulLength ) != eAzureIoTSuccess )
+        {
+            return 1;
+        }
+
+        while( ( xResult = AzureIoTHubClientProperties_GetNextComponentProperty( &xHubClient, &xReader,
+                                                                                 eAzureIoTHubPropertiesWritablePropertyMessage,
+                                                                                 eAzureIoTHubClientPropertyWritable,
+                                                                                 &pucComponentName,
+                                                                                 &ulComponentNameLength ) ) == eAzureIoTSuccess )
+        {
+            if( ( ulComponentNameLength == ( uint32_t ) az_span_size( xComponents[ ulComponent ] ) ) &&
+                ( memcmp( pucComponentName, az_span_ptr( xComponents[ ulComponent ] ), ulComponentNameLength ) == 0 ) )
+            {
+                pulProperties[ ulComponent ]++;
+
+                if( AzureIoTJSONReader_TokenIsTextEqual( &xReader, ucTargetTemperature, sizeof( ucTargetTemperature ) - 1 ) )
+                {
+                    if( ( AzureIoTJSONReader_NextToken( &xReader ) != eAzureIoTSuccess ) ||
+                        ( AzureIoTJSONReader_GetTokenDouble( &xReader, &pxTargets[ ulComponent ] ) != eAzureIoTSuccess ) ||
+                        ( AzureIoTJSONReader_NextToken( &xReader ) != eAzureIoTSuccess ) )
+                    {
+                        return 1;
+                    }
+
+                    continue;
+                }
+            }
+
+            if( ( AzureIoTJSONReader_NextToken( &xReader ) != eAzureIoTSuccess ) ||
+                ( AzureIoTJSONReader_SkipChildren( &xReader ) != eAzureIoTSuccess ) ||
+                ( AzureIoTJSONReader_NextToken( &xReader ) != eAzureIoTSuccess ) )
+            {
+                return 1;
+            }
+        }
+
+        if( xResult != eAzureIoTErrorEndOfProperties )
+        {
+            return 1;
+        }
+    }
+
+    return 0;
+}
+/*-----------------------------------------------------------*/
+
+/*
+ * The document is read once, then each handler goes straight to the properties of its component.
+ */
+static int prvHandleWithIndex( const uint8_t * pucDocument,
+                               uint32_t ulLength,
+                               double * pxTargets,
+                               uint32_t * pulProperties )
+{
+    static AzureIoTHubClientPropertiesIndex_t xIndex;
+    AzureIoTJSONReader_t xReader;
+    const uint8_t * pucPropertyName;
+    uint32_t ulPropertyNameLength;
+    uint32_t ulPosition;
+    uint32_t ulComponent;
+    AzureIoTResult_t xResult;
+
+    if( AzureIoTHubClientProperties_BuildIndex( &xHubClient, &xIndex, pucDocument, ulLength,
+                                                eAzureIoTHubPropertiesWritablePropertyMessage,
+                                                eAzureIoTHubClientPropertyWritable ) != eAzureIoTSuccess )
+    {
+        return 1;
+    }
+
+    for( ulComponent = 0; ulComponent < benchmarkCOMPONENTS; ulComponent++ )
+    {
+        ulPosition = 0;
+
+        while( ( xResult = AzureIoTHubClientProperties_IndexGetNextProperty( &xIndex,
+                                                                             az_span_ptr( xComponents[ ulComponent ] ),
+                                                                             ( uint32_t ) az_span_size( xComponents[ ulComponent ] ),
+                                                                             &ulPosition, &pucPropertyName,
+                                                                             &ulPropertyNameLength, &xReader ) ) == eAzureIoTSuccess )
+        {
+            pulProperties[ ulComponent ]++;
+
+            if( ( ulPropertyNameLength == sizeof( ucTargetTemperature ) - 1 ) &&
+                ( memcmp( pucPropertyName, ucTargetTemperature, ulPropertyNameLength ) == 0 ) &&
+                ( ( AzureIoTJSONReader_NextToken( &xReader ) != eAzureIoTSuccess ) ||
+                  ( AzureIoTJSONReader_GetTokenDouble( &xReader, &pxTargets[ ulComponent ] ) != eAzureIoTSuccess ) ) )
+            {
+                return 1;
+            }
+        }
+
+        if( xResult != eAzureIoTErrorEndOfProperties )
+        {
+            return 1;
+        }
+    }
+
+    return 0;
+}
+/*-----------------------------------------------------------*/
+
+static int prvCheck( const char * pcName,
+                     Handle_t xHandle,
+                     uint32_t ulLength )
+{
+    double xTargets[ benchmarkCOMPONENTS ] = { 0 };
+    uint32_t ulProperties[ benchmarkCOMPONENTS ] = { 0 };
+    uint32_t ulComponent;
+
+    if( xHandle( ucDocument, ulLength, xTargets, ulProperties ) != 0 )
+    {
+        printf( "%s cannot read the document\r\n", pcName );
+        return 1;
+    }
+
+    for( ulComponent = 0; ulComponent < benchmarkCOMPONENTS; ulComponent++ )
+    {
+        if( ( xTargets[ ulComponent ] != prvExpectedTarget( ulComponent ) ) ||
+            ( ulProperties[ ulComponent ] != benchmarkPROPERTIES ) )
+        {
+            printf( "%s reads component %u wrong\r\n", pcName, ( unsigned ) ulComponent + 1U );
+            return 1;
+        }
+    }
+
+    return 0;
+}
+/*-----------------------------------------------------------*/
+
+static double prvRun( const char * pcName,
+                      Handle_t xHandle,
+                      uint32_t ulLength,
+                      uint32_t ulDocuments )
+{
+    double xTargets[ benchmarkCOMPONENTS ] = { 0 };
+    uint32_t ulProperties[ benchmarkCOMPONENTS ] = { 0 };
+    uint64_t ullStart;
+    double xRate;
+    uint32_t ulDocument;
+
+    ullStart = ullBenchmarkGetNanoseconds();
+
+    for( ulDocument = 0; ulDocument < ulDocuments; ulDocument++ )
+    {
+        ( void ) xHandle( ucDocument, ulLength, xTargets, ulProperties );
+        ulBenchmarkSink += ( uint32_t ) xTargets[ ulDocument % benchmarkCOMPONENTS ];
+    }
+
+    xRate = ulDocuments * 1e9 / ( double ) ( ullBenchmarkGetNanoseconds() - ullStart );
+
+    printf( "%-10s %14.0f\r\n", pcName, xRate );
+
+    return xRate;
+}
+/*-----------------------------------------------------------*/
+
+int main( int argc,
+          char ** argv )
+{
+    uint32_t ulDocuments = ulBenchmarkGetCount( argc, argv, benchmarkDEFAULT_DOCUMENTS );
+    AzureIoTHubClientOptions_t xOptions;
+    AzureIoTTransportInterface_t xTransport;
+    uint32_t ulLength;
+    double xReaderRate;
+    double xIndexRate;
+
+    xTransport.pxNetworkContext = NULL;
+    xTransport.xSend = prvTransportSend;
+    xTransport.xRecv = prvTransportRecv;
+
+    if( ( ulDocuments == 0 ) ||
+        ( ( ulLength = prvBuildDocument() ) == 0 ) ||
+        ( AzureIoTHubClient_OptionsInit( &xOptions ) != eAzureIoTSuccess ) )
+    {
+        return 1;
+    }
+
+    xOptions.pxComponentList = xComponents;
+    xOptions.ulComponentListLength = benchmarkCOMPONENTS;
+
+    if( ( AzureIoTHubClient_Init( &xHubClient, ucHostname, sizeof( ucHostname ) - 1,
+                                  ucDeviceID, sizeof( ucDeviceID ) - 1, &xOptions,
+                                  ucClientBuffer, sizeof( ucClientBuffer ),
+                                  prvGetTime, &xTransport ) != eAzureIoTSuccess ) ||
+        prvCheck( "Reader", prvHandleWithReader, ulLength ) ||
+        prvCheck( "Index", prvHandleWithIndex, ulLength ) )
+    {
+        return 1;
+    }
+
+    printf( "%u components in a %u byte document\r\n", ( unsigned ) benchmarkCOMPONENTS, ( unsigned ) ulLength );
+    printf( "\r\n%-10s %14s\r\n", "", "documents/s" );
+    xReaderRate = prvRun( "Reader", prvHandleWithReader, ulLength, ulDocuments );
+    xIndexRate = prvRun( "Index", prvHandleWithIndex, ulLength, ulDocuments );
+    printf( "\r\nThe index handles %.1f times as many documents per second.\r\n", xIndexRate / xReaderRate );
+
+    return 0;
+}
+/*-----------------------------------------------------------*/
@@ -0,0 +1,21 @@
+#!/bin/bash
+
+# Copyright (c) Microsoft. All rights reserved.
+# Licensed under the MIT license. See LICENSE file in the project root for full license information.
+#
+# This script builds the properties index benchmark and runs it
+
+# ./run.sh <FreeRTOS Src path> [documents]
+# e.g. ./run.sh ~/FreeRTOS 100000
+
+source "$(dirname "$0")/../common/benchmark.sh"
+
+documents=${2:-100000}
+
+pushd "$dir"
+
+benchmark_build Release
+
+./build/azure_iot_properties_index_benchmark $documents
+
+popd
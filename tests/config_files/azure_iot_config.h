@@ -13,6 +13,9 @@ extern void vLoggingPrintf( const char * pcFormatString,
 #define AZLogInfo( message )     AZLog( ( "[INFO] [AZ IoT] [%s:%d]", __FILE__, __LINE__ ) ); AZLog( message ); AZLog( ( "\r\n" ) )
 #define AZLogDebug( message )    AZLog( ( "[DEBUG] [AZ IoT] [%s:%d]", __FILE__, __LINE__ ) ); AZLog( message ); AZLog( ( "\r\n" ) )
 
+/* The unit tests and the mbedTLS crypto port both have an azure_iot_crypto_port.h */
+#define azureiotconfigCRYPTO_PORT_HEADER    ( 1U )
+
 /**
  * This certificate is for test purposes only. See official
  * documentation about certificate management for your released
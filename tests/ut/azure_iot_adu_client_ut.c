@@ -67,6 +67,7 @@ static uint8_t ucADURequestPayloadWithRetry[] = "{\"service\":{\"workflow\":{\"a
 static uint8_t ucADURequestPayloadUnusedFields[] = "{\"service\":{\"workflow\":{\"action\":3,\"id\":\"51552a54-765e-419f-892a-c822549b6f38\"},\"updateManifest\":\"{\\\"manifestVersion\\\":\\\"5\\\",\\\"updateId\\\":{\\\"provider\\\":\\\"Contoso\\\",\\\"name\\\":\\\"Foobar\\\",\\\"version\\\":\\\"1.1\\\"},\\\"compatibility\\\":[{\\\"deviceManufacturer\\\":\\\"Contoso\\\",\\\"deviceModel\\\":\\\"Foobar\\\"}],\\\"instructions\\\":{\\\"steps\\\":[{\\\"handler\\\":\\\"microsoft/swupdate:1\\\",\\\"files\\\":[\\\"f2f4a804ca17afbae\\\"],\\\"handlerProperties\\\":{\\\"installedCriteria\\\":\\\"1.0\\\"}}]},\\\"files\\\":{\\\"f2f4a804ca17afbae\\\":{\\\"fileName\\\":\\\"iot-middleware-sample-adu-v1.1\\\",\\\"sizeInBytes\\\":844976,\\\"hashes\\\":{\\\"sha256\\\":\\\"xsoCnYAMkZZ7m9RL9Vyg9jKfFehCNxyuPFaJVM/WBi0=\\\"},\\\"mimeType\\\":\\\"application/octet-stream\\\",\\\"relatedFiles\\\":[{\\\"filename\\\":\\\"in1_in2_deltaupdate.dat\\\",\\\"sizeInBytes\\\":\\\"102910752\\\",\\\"hashes\\\":{\\\"sha256\\\":\\\"2MIl...\\\"},\\\"properties\\\":{\\\"microsoft.sourceFileAlgorithm\\\":\\\"sha256\\\",\\\"microsoft.sourceFileHash\\\":\\\"YmFY...\\\"}}],\\\"downloadHandler\\\":{\\\"id\\\":\\\"microsoft/delta:1\\\"}}},\\\"createdDateTime\\\":\\\"2022-07-07T03:02:48.8449038Z\\\"}\",\"updateManifestSignature\":\"eyJhbGciOiJSUzI1NiIsInNqd2siOiJleUpoYkdjaU9pSlNVekkxTmlJc0ltdHBaQ0k2SWtGRVZTNHlNREEzTURJdVVpSjkuZXlKcmRIa2lPaUpTVTBFaUxDSnVJam9pYkV4bWMwdHZPRmwwWW1Oak1sRXpUalV3VlhSTVNXWlhVVXhXVTBGRlltTm9LMFl2WTJVM1V6Rlpja3BvV0U5VGNucFRaa051VEhCVmFYRlFWSGMwZWxndmRHbEJja0ZGZFhrM1JFRmxWVzVGU0VWamVEZE9hM2QzZVRVdk9IcExaV3AyWTBWWWNFRktMMlV6UWt0SE5FVTBiMjVtU0ZGRmNFOXplSGRQUzBWbFJ6QkhkamwzVjB3emVsUmpUblprUzFoUFJGaEdNMVZRWlVveGIwZGlVRkZ0Y3pKNmJVTktlRUppZEZOSldVbDBiWFpwWTNneVpXdGtWbnBYUm5jdmRrdFVUblZMYXpob2NVczNTRkptYWs5VlMzVkxXSGxqSzNsSVVVa3dZVVpDY2pKNmEyc3plR2d4ZEVWUFN6azRWMHBtZUdKamFsQnpSRTgyWjNwWmVtdFlla05OZW1Fd1R6QkhhV0pDWjB4QlZGUTVUV1k0V1ZCd1dVY3lhblpQWVVSVmIwTlJiakpWWTFWU1RtUnNPR2hLWW5scWJscHZNa3B5SzFVNE5IbDFjVTlyTjBZMFdubFRiMEoyTkdKWVNrZ3lXbEpTV2tab0wzVlRiSE5XT1hkU2JWbG9XWEoyT1RGRVdtbHhhemhJVWpaRVUyeHVabTVsZFRJNFJsUm9SVzF0YjNOVlRUTnJNbGxNYzBKak5FSnZkWEIwTTNsaFNEaFpia3BVTnpSMU16TjFlakU1TDAxNlZIVnFTMmMzVkdGcE1USXJXR0owYmxwRU9XcFVSMkY1U25Sc2FFWmxWeXRJUXpVM1FYUkJSbHBvY1ZsM2VVZHJXQ3M0TTBGaFVGaGFOR0V4VHpoMU1qTk9WVWQxTWtGd04yOU5NVTR3ZVVKS0swbHNUM29pTENKbElqb2lRVkZCUWlJc0ltRnNaeUk2SWxKVE1qVTJJaXdpYTJsa0lqb2lRVVJWTGpJeE1EWXdPUzVTTGxNaWZRLlJLS2VBZE02dGFjdWZpSVU3eTV2S3dsNFpQLURMNnEteHlrTndEdkljZFpIaTBIa2RIZ1V2WnoyZzZCTmpLS21WTU92dXp6TjhEczhybXo1dnMwT1RJN2tYUG1YeDZFLUYyUXVoUXNxT3J5LS1aN2J3TW5LYTNkZk1sbkthWU9PdURtV252RWMyR0hWdVVTSzREbmw0TE9vTTQxOVlMNThWTDAtSEthU18xYmNOUDhXYjVZR08xZXh1RmpiVGtIZkNIU0duVThJeUFjczlGTjhUT3JETHZpVEtwcWtvM3RiSUwxZE1TN3NhLWJkZExUVWp6TnVLTmFpNnpIWTdSanZGbjhjUDN6R2xjQnN1aVQ0XzVVaDZ0M05rZW1UdV9tZjdtZUFLLTBTMTAzMFpSNnNTR281azgtTE1sX0ZaUmh4djNFZFNtR2RBUTNlMDVMRzNnVVAyNzhTQWVzWHhNQUlHWmcxUFE3aEpoZGZHdmVGanJNdkdTSVFEM09wRnEtZHREcEFXbUo2Zm5sZFA1UWxYek5tQkJTMlZRQUtXZU9BYjh0Yjl5aVhsemhtT1dLRjF4SzlseHpYUG9GNmllOFRUWlJ4T0hxTjNiSkVISkVoQmVLclh6YkViV2tFNm4zTEoxbkd5M1htUlVFcER0Umdpa0tBUzZybFhFT0VneXNjIn0.eyJzaGEyNTYiOiJiUlkrcis0MzdsYTV5d2hIeDdqVHhlVVRkeDdJdXQyQkNlcVpoQys5bmFNPSJ9.eYoBoq9EOiCebTJAMhRh9DARC69F3C4Qsia86no9YbMJzwKt-rH88Va4dL59uNTlPNBQid4u0RlXSUTuma_v-Sf4hyw70tCskwru5Fp41k9Ve3YSkulUKzctEhaNUJ9tUSA11Tz9HwJHOAEA1-S_dXWR_yuxabk9G_BiucsuKhoI0Bas4e1ydQE2jXZNdVVibrFSqxvuVZrxHKVhwm-G9RYHjZcoSgmQ58vWyaC2l8K8ZqnlQWmuLur0CZFQlanUVxDocJUtu1MnB2ER6emMRD_4Azup2K4apq9E1EfYBbXxOZ0N5jaSr-2xg8NVSow5NqNSaYYY43wy_NIUefRlbSYu5zOrSWtuIwRdsO-43Eo8b9vuJj1Qty9ee6xz1gdUNHnUdnM6dHEplZK0GZznsxRviFXt7yv8bVLd32Z7QDtFh3s17xlKulBZxWP-q96r92RoUTov2M3ynPZSDmc6Mz7-r8ioO5VHO5pAPCH-tF5zsqzipPJKmBMaf5gYk8wR\",\"fileUrls\":{\"f2f4a804ca17afbae\":\"http://contoso-adu-instance--contoso-adu.b.nlu.dl.adu.microsoft.com/westus2/contoso-adu-instance--contoso-adu/67c8d2ef5148403391bed74f51a28597/iot-middleware-sample-adu-v1.1\"}}}";
 static uint8_t ucADURequestPayloadNoDeployment[] = "{\"service\":{\"workflow\":{\"action\":255,\"id\":\"nodeployment\"}},\"__t\":\"c\"}";
 static uint8_t ucADURequestPayloadNoDeploymentNullManifest[] = "{\"service\":{\"workflow\":{\"action\":255,\"id\":\"nodeployment\"},\"updateManifest\":null,\"updateManifestSignature\":null,\"fileUrls\":null},\"__t\":\"c\"}";
+static uint8_t ucADURequestPayloadMultiStep[] = "{\"service\":{\"workflow\":{\"action\":3,\"id\":\"multi\"},\"updateManifest\":\"{\\\"manifestVersion\\\":\\\"5\\\",\\\"updateId\\\":{\\\"provider\\\":\\\"Contoso\\\",\\\"name\\\":\\\"Foobar\\\",\\\"version\\\":\\\"1.2\\\"},\\\"compatibility\\\":[{\\\"deviceManufacturer\\\":\\\"Contoso\\\",\\\"deviceModel\\\":\\\"Foobar\\\"}],\\\"instructions\\\":{\\\"steps\\\":[{\\\"handler\\\":\\\"microsoft/script:1\\\",\\\"files\\\":[\\\"f1\\\",\\\"f2\\\"],\\\"handlerProperties\\\":{\\\"scriptFileName\\\":\\\"install.sh\\\",\\\"installedCriteria\\\":\\\"1.2\\\"}},{\\\"handler\\\":\\\"microsoft/swupdate:1\\\",\\\"files\\\":[\\\"f3\\\"],\\\"handlerProperties\\\":{\\\"installedCriteria\\\":\\\"1.2\\\"}}]},\\\"files\\\":{\\\"f1\\\":{\\\"fileName\\\":\\\"install.sh\\\",\\\"sizeInBytes\\\":1024,\\\"hashes\\\":{\\\"sha256\\\":\\\"AAAA\\\"}},\\\"f2\\\":{\\\"fileName\\\":\\\"image-1.2.bin\\\",\\\"sizeInBytes\\\":8589934592,\\\"hashes\\\":{\\\"sha256\\\":\\\"BBBB\\\",\\\"sha512\\\":\\\"CCCC\\\"}},\\\"f3\\\":{\\\"fileName\\\":\\\"firmware-1.2.bin\\\",\\\"sizeInBytes\\\":2048,\\\"hashes\\\":{\\\"sha256\\\":\\\"DDDD\\\"}}},\\\"createdDateTime\\\":\\\"2022-07-07T03:02:48.8449038Z\\\"}\",\"updateManifestSignature\":\"sig\",\"fileUrls\":{\"f1\":\"http://a/f1\",\"f2\":\"http://a/f2\",\"f3\":\"http://a/f3\"}},\"__t\":\"c\"}";
 static uint8_t ucADURequestManifest[] = "{\"manifestVersion\":\"5\",\"updateId\":{\"provider\":\"Contoso\",\"name\":\"Foobar\",\"version\":\"1.1\"},\"compatibility\":[{\"deviceManufacturer\":\"Contoso\",\"deviceModel\":\"Foobar\"}],\"instructions\":{\"steps\":[{\"handler\":\"microsoft/swupdate:1\",\"files\":[\"f2f4a804ca17afbae\"],\"handlerProperties\":{\"installedCriteria\":\"1.0\"}}]},\"files\":{\"f2f4a804ca17afbae\":{\"fileName\":\"iot-middleware-sample-adu-v1.1\",\"sizeInBytes\":844976,\"hashes\":{\"sha256\":\"xsoCnYAMkZZ7m9RL9Vyg9jKfFehCNxyuPFaJVM/WBi0=\"}}},\"createdDateTime\":\"2022-07-07T03:02:48.8449038Z\"}";
 static uint8_t ucADURequestManifestUnusedFields[] = "{\"manifestVersion\":\"5\",\"updateId\":{\"provider\":\"Contoso\",\"name\":\"Foobar\",\"version\":\"1.1\"},\"compatibility\":[{\"deviceManufacturer\":\"Contoso\",\"deviceModel\":\"Foobar\"}],\"instructions\":{\"steps\":[{\"handler\":\"microsoft/swupdate:1\",\"files\":[\"f2f4a804ca17afbae\"],\"handlerProperties\":{\"installedCriteria\":\"1.0\"}}]},\"files\":{\"f2f4a804ca17afbae\":{\"fileName\":\"iot-middleware-sample-adu-v1.1\",\"sizeInBytes\":844976,\"hashes\":{\"sha256\":\"xsoCnYAMkZZ7m9RL9Vyg9jKfFehCNxyuPFaJVM/WBi0=\"},\"mimeType\":\"application/octet-stream\",\"relatedFiles\":[{\"filename\":\"in1_in2_deltaupdate.dat\",\"sizeInBytes\":\"102910752\",\"hashes\":{\"sha256\":\"2MIl...\"},\"properties\":{\"microsoft.sourceFileAlgorithm\":\"sha256\",\"microsoft.sourceFileHash\":\"YmFY...\"}}],\"downloadHandler\":{\"id\":\"microsoft/delta:1\"}}},\"createdDateTime\":\"2022-07-07T03:02:48.8449038Z\"}";
 static uint32_t ulWorkflowAction = 3;
@@ -467,6 +468,228 @@ static void testAzureIoTADUClient_ParseRequest_NoDeploymentNullManifest_Success(
     assert_int_equal( xRequest.ulFileUrlCount, 0 );
 }
 
+static void prvParseRequestCompact( uint8_t * pucRequestPayload,
+                                    uint32_t ulRequestPayloadLength,
+                                    AzureIoTADUUpdateRequestCompact_t * pxRequest )
+{
+    AzureIoTADUClient_t xTestIoTADUClient;
+    AzureIoTJSONReader_t xReader;
+
+    assert_int_equal( AzureIoTADUClient_Init( &xTestIoTADUClient, NULL ), eAzureIoTSuccess );
+
+    /* We have to copy the payload to a scratch buffer since it's unescaped in place */
+    memcpy( ucRequestPayloadCopy, pucRequestPayload, ulRequestPayloadLength );
+    assert_int_equal( AzureIoTJSONReader_Init( &xReader, ucRequestPayloadCopy, ulRequestPayloadLength ), eAzureIoTSuccess );
+
+    /* ParseRequestCompact requires that the reader be placed on the "service" prop name */
+    assert_int_equal( AzureIoTJSONReader_NextToken( &xReader ), eAzureIoTSuccess );
+    assert_int_equal( AzureIoTJSONReader_NextToken( &xReader ), eAzureIoTSuccess );
+
+    assert_int_equal( AzureIoTADUClient_ParseRequestCompact( &xTestIoTADUClient,
+                                                             &xReader,
+                                                             pxRequest ), eAzureIoTSuccess );
+}
+
+static void testAzureIoTADUClient_ParseRequestCompact_InvalidArgFailure( void ** ppvState )
+{
+    AzureIoTADUClient_t xTestIoTADUClient;
+    AzureIoTJSONReader_t xReader;
+    AzureIoTADUUpdateRequestCompact_t xRequest;
+
+    assert_int_equal( AzureIoTADUClient_ParseRequestCompact( NULL,
+                                                             &xReader,
+                                                             &xRequest ), eAzureIoTErrorInvalidArgument );
+    assert_int_equal( AzureIoTADUClient_ParseRequestCompact( &xTestIoTADUClient,
+                                                             NULL,
+                                                             &xRequest ), eAzureIoTErrorInvalidArgument );
+    assert_int_equal( AzureIoTADUClient_ParseRequestCompact( &xTestIoTADUClient,
+                                                             &xReader,
+                                                             NULL ), eAzureIoTErrorInvalidArgument );
+    assert_int_equal( AzureIoTADUUpdateRequestCompact_GetStep( NULL, 0, NULL ), eAzureIoTErrorInvalidArgument );
+    assert_int_equal( AzureIoTADUUpdateRequestCompact_GetStepFile( NULL, 0, NULL ), eAzureIoTErrorInvalidArgument );
+    assert_int_equal( AzureIoTADUUpdateRequestCompact_GetFile( NULL, 0, NULL ), eAzureIoTErrorInvalidArgument );
+    assert_int_equal( AzureIoTADUUpdateRequestCompact_FindFile( NULL, ucFilesID, sizeof( ucFilesID ) - 1, NULL ), eAzureIoTErrorInvalidArgument );
+    assert_int_equal( AzureIoTADUUpdateRequestCompact_GetFileHash( NULL, 0, NULL ), eAzureIoTErrorInvalidArgument );
+    assert_int_equal( AzureIoTADUUpdateRequestCompact_FindFileUrl( NULL, ucFilesID, sizeof( ucFilesID ) - 1, NULL ), eAzureIoTErrorInvalidArgument );
+}
+
+static void prvParseRequestCompactSuccess( uint8_t * pucRequestPayload,
+                                           uint32_t ulRequestPayloadLength,
+                                           uint8_t * pucExpectedManifest,
+                                           uint32_t ulExpectedManifestLength )
+{
+    AzureIoTADUUpdateRequestCompact_t xRequest;
+    AzureIoTADUInstructionStepCompact_t xStep;
+    AzureIoTADUUpdateManifestInstructionStepFile_t xStepFile;
+    AzureIoTADUUpdateManifestFileCompact_t xFile;
+    AzureIoTADUUpdateManifestFileHash_t xHash;
+    AzureIoTADUUpdateManifestFileUrl_t xFileUrl;
+
+    prvParseRequestCompact( pucRequestPayload, ulRequestPayloadLength, &xRequest );
+
+    /* Workflow */
+    assert_int_equal( xRequest.xWorkflow.xAction, ulWorkflowAction );
+    assert_memory_equal( xRequest.xWorkflow.pucID, ucWorkflowID, sizeof( ucWorkflowID ) - 1 );
+    assert_int_equal( xRequest.xWorkflow.ulIDLength, sizeof( ucWorkflowID ) - 1 );
+    assert_null( xRequest.xWorkflow.pucRetryTimestamp );
+    assert_int_equal( xRequest.xWorkflow.ulRetryTimestampLength, 0 );
+
+    /* Update Manifest */
+    assert_memory_equal( xRequest.pucUpdateManifest, pucExpectedManifest, ulExpectedManifestLength );
+    assert_int_equal( xRequest.ulUpdateManifestLength, ulExpectedManifestLength );
+    assert_memory_equal( xRequest.pucManifestVersion, ucManifestVersion, sizeof( ucManifestVersion ) - 1 );
+    assert_int_equal( xRequest.ulManifestVersionLength, sizeof( ucManifestVersion ) - 1 );
+    assert_memory_equal( xRequest.xUpdateId.pucProvider, ucUpdateIDProvider, sizeof( ucUpdateIDProvider ) - 1 );
+    assert_int_equal( xRequest.xUpdateId.ulProviderLength, sizeof( ucUpdateIDProvider ) - 1 );
+    assert_memory_equal( xRequest.xUpdateId.pucName, ucUpdateIDName, sizeof( ucUpdateIDName ) - 1 );
+    assert_int_equal( xRequest.xUpdateId.ulNameLength, sizeof( ucUpdateIDName ) - 1 );
+    assert_memory_equal( xRequest.xUpdateId.pucVersion, ucUpdateIDVersion, sizeof( ucUpdateIDVersion ) - 1 );
+    assert_int_equal( xRequest.xUpdateId.ulVersionLength, sizeof( ucUpdateIDVersion ) - 1 );
+    assert_memory_equal( xRequest.pucCreateDateTime, ucCreateDateTime, sizeof( ucCreateDateTime ) - 1 );
+    assert_int_equal( xRequest.ulCreateDateTimeLength, sizeof( ucCreateDateTime ) - 1 );
+
+    /* Steps */
+    assert_int_equal( xRequest.ulStepsCount, 1 );
+    assert_int_equal( AzureIoTADUUpdateRequestCompact_GetStep( &xRequest, 0, &xStep ), eAzureIoTSuccess );
+    assert_memory_equal( xStep.pucHandler, ucInstructionsStepsHandler, sizeof( ucInstructionsStepsHandler ) - 1 );
+    assert_int_equal( xStep.ulHandlerLength, sizeof( ucInstructionsStepsHandler ) - 1 );
+    assert_memory_equal( xStep.pucInstalledCriteria, ucInstructionsStepsHandlerPropertiesInstallCriteria, sizeof( ucInstructionsStepsHandlerPropertiesInstallCriteria ) - 1 );
+    assert_int_equal( xStep.ulInstalledCriteriaLength, sizeof( ucInstructionsStepsHandlerPropertiesInstallCriteria ) - 1 );
+    assert_int_equal( xStep.ulFilesCount, 1 );
+    assert_int_equal( AzureIoTADUUpdateRequestCompact_GetStepFile( &xStep, 0, &xStepFile ), eAzureIoTSuccess );
+    assert_memory_equal( xStepFile.pucFileName, ucInstructionsStepsFile, sizeof( ucInstructionsStepsFile ) - 1 );
+    assert_int_equal( xStepFile.ulFileNameLength, sizeof( ucInstructionsStepsFile ) - 1 );
+    assert_int_equal( AzureIoTADUUpdateRequestCompact_GetStepFile( &xStep, 1, &xStepFile ), eAzureIoTErrorItemNotFound );
+    assert_int_equal( AzureIoTADUUpdateRequestCompact_GetStep( &xRequest, 1, &xStep ), eAzureIoTErrorItemNotFound );
+
+    /* Files */
+    assert_int_equal( xRequest.ulFilesCount, 1 );
+    assert_int_equal( AzureIoTADUUpdateRequestCompact_GetFile( &xRequest, 0, &xFile ), eAzureIoTSuccess );
+    assert_memory_equal( xFile.pucId, ucFilesID, sizeof( ucFilesID ) - 1 );
+    assert_int_equal( xFile.ulIdLength, sizeof( ucFilesID ) - 1 );
+    assert_memory_equal( xFile.pucFileName, ucFilesFilename, sizeof( ucFilesFilename ) - 1 );
+    assert_int_equal( xFile.ulFileNameLength, sizeof( ucFilesFilename ) - 1 );
+    assert_int_equal( xFile.llSizeInBytes, llFilesSizeInBytes );
+    assert_int_equal( xFile.ulHashesCount, 1 );
+    assert_int_equal( AzureIoTADUUpdateRequestCompact_GetFileHash( &xFile, 0, &xHash ), eAzureIoTSuccess );
+    assert_memory_equal( xHash.pucId, ucFilesHashID, sizeof( ucFilesHashID ) - 1 );
+    assert_int_equal( xHash.ulIdLength, sizeof( ucFilesHashID ) - 1 );
+    assert_memory_equal( xHash.pucHash, ucFilesHashesSHA, sizeof( ucFilesHashesSHA ) - 1 );
+    assert_int_equal( xHash.ulHashLength, sizeof( ucFilesHashesSHA ) - 1 );
+    assert_int_equal( AzureIoTADUUpdateRequestCompact_GetFileHash( &xFile, 1, &xHash ), eAzureIoTErrorItemNotFound );
+    assert_int_equal( AzureIoTADUUpdateRequestCompact_GetFile( &xRequest, 1, &xFile ), eAzureIoTErrorItemNotFound );
+    assert_int_equal( AzureIoTADUUpdateRequestCompact_FindFile( &xRequest, xStepFile.pucFileName, xStepFile.ulFileNameLength, &xFile ), eAzureIoTSuccess );
+    assert_int_equal( xFile.llSizeInBytes, llFilesSizeInBytes );
+
+    /* Signature */
+    assert_memory_equal( xRequest.pucUpdateManifestSignature, ucSignature, sizeof( ucSignature ) - 1 );
+    assert_int_equal( xRequest.ulUpdateManifestSignatureLength, sizeof( ucSignature ) - 1 );
+
+    /* File URLs */
+    assert_int_equal( xRequest.ulFileUrlCount, 1 );
+    assert_int_equal( AzureIoTADUUpdateRequestCompact_FindFileUrl( &xRequest, ucFilesID, sizeof( ucFilesID ) - 1, &xFileUrl ), eAzureIoTSuccess );
+    assert_memory_equal( xFileUrl.pucId, ucFilesID, sizeof( ucFilesID ) - 1 );
+    assert_int_equal( xFileUrl.ulIdLength, sizeof( ucFilesID ) - 1 );
+    assert_memory_equal( xFileUrl.pucUrl, ucFileUrl, sizeof( ucFileUrl ) - 1 );
+    assert_int_equal( xFileUrl.ulUrlLength, sizeof( ucFileUrl ) - 1 );
+    assert_int_equal( AzureIoTADUUpdateRequestCompact_FindFileUrl( &xRequest, ucUpdateIDName, sizeof( ucUpdateIDName ) - 1, &xFileUrl ), eAzureIoTErrorItemNotFound );
+}
+
+static void testAzureIoTADUClient_ParseRequestCompact_Success( void ** ppvState )
+{
+    prvParseRequestCompactSuccess( ucADURequestPayload, sizeof( ucADURequestPayload ) - 1,
+                                   ucADURequestManifest, sizeof( ucADURequestManifest ) - 1 );
+}
+
+static void testAzureIoTADUClient_ParseRequestCompact_UnusedFields_Success( void ** ppvState )
+{
+    prvParseRequestCompactSuccess( ucADURequestPayloadUnusedFields, sizeof( ucADURequestPayloadUnusedFields ) - 1,
+                                   ucADURequestManifestUnusedFields, sizeof( ucADURequestManifestUnusedFields ) - 1 );
+}
+
+static void testAzureIoTADUClient_ParseRequestCompact_MultiStep_Success( void ** ppvState )
+{
+    AzureIoTADUUpdateRequestCompact_t xRequest;
+    AzureIoTADUInstructionStepCompact_t xStep;
+    AzureIoTADUUpdateManifestInstructionStepFile_t xStepFile;
+    AzureIoTADUUpdateManifestFileCompact_t xFile;
+    AzureIoTADUUpdateManifestFileHash_t xHash;
+    AzureIoTADUUpdateManifestFileUrl_t xFileUrl;
+
+    prvParseRequestCompact( ucADURequestPayloadMultiStep, sizeof( ucADURequestPayloadMultiStep ) - 1, &xRequest );
+
+    assert_int_equal( xRequest.ulStepsCount, 2 );
+    assert_int_equal( xRequest.ulFilesCount, 3 );
+    assert_int_equal( xRequest.ulFileUrlCount, 3 );
+
+    assert_int_equal( AzureIoTADUUpdateRequestCompact_GetStep( &xRequest, 1, &xStep ), eAzureIoTSuccess );
+    assert_memory_equal( xStep.pucHandler, "microsoft/swupdate:1", sizeof( "microsoft/swupdate:1" ) - 1 );
+    assert_int_equal( xStep.ulFilesCount, 1 );
+
+    assert_int_equal( AzureIoTADUUpdateRequestCompact_GetStep( &xRequest, 0, &xStep ), eAzureIoTSuccess );
+    assert_memory_equal( xStep.pucHandler, "microsoft/script:1", sizeof( "microsoft/script:1" ) - 1 );
+    assert_memory_equal( xStep.pucInstalledCriteria, "1.2", sizeof( "1.2" ) - 1 );
+    assert_int_equal( xStep.ulFilesCount, 2 );
+
+    /* Second file of the first step, looked up by id */
+    assert_int_equal( AzureIoTADUUpdateRequestCompact_GetStepFile( &xStep, 1, &xStepFile ), eAzureIoTSuccess );
+    assert_int_equal( xStepFile.ulFileNameLength, 2 );
+    assert_memory_equal( xStepFile.pucFileName, "f2", 2 );
+    assert_int_equal( AzureIoTADUUpdateRequestCompact_FindFile( &xRequest, xStepFile.pucFileName, xStepFile.ulFileNameLength, &xFile ), eAzureIoTSuccess );
+    assert_memory_equal( xFile.pucFileName, "image-1.2.bin", sizeof( "image-1.2.bin" ) - 1 );
+    assert_true( xFile.llSizeInBytes == 8589934592LL );
+    assert_int_equal( xFile.ulHashesCount, 2 );
+    assert_int_equal( AzureIoTADUUpdateRequestCompact_GetFileHash( &xFile, 1, &xHash ), eAzureIoTSuccess );
+    assert_memory_equal( xHash.pucId, "sha512", sizeof( "sha512" ) - 1 );
+    assert_memory_equal( xHash.pucHash, "CCCC", sizeof( "CCCC" ) - 1 );
+    assert_int_equal( AzureIoTADUUpdateRequestCompact_FindFileUrl( &xRequest, xStepFile.pucFileName, xStepFile.ulFileNameLength, &xFileUrl ), eAzureIoTSuccess );
+    assert_memory_equal( xFileUrl.pucUrl, "http://a/f2", sizeof( "http://a/f2" ) - 1 );
+    assert_int_equal( xFileUrl.ulUrlLength, sizeof( "http://a/f2" ) - 1 );
+
+    assert_int_equal( AzureIoTADUUpdateRequestCompact_GetFile( &xRequest, 2, &xFile ), eAzureIoTSuccess );
+    assert_memory_equal( xFile.pucId, "f3", 2 );
+    assert_int_equal( xFile.llSizeInBytes, 2048 );
+    assert_int_equal( AzureIoTADUUpdateRequestCompact_FindFile( &xRequest, ( const uint8_t * ) "f4", 2, &xFile ), eAzureIoTErrorItemNotFound );
+}
+
+static void testAzureIoTADUClient_ParseRequestCompact_NoDeployment_Success( void ** ppvState )
+{
+    AzureIoTADUUpdateRequestCompact_t xRequest;
+    AzureIoTADUInstructionStepCompact_t xStep;
+    AzureIoTADUUpdateManifestFileUrl_t xFileUrl;
+
+    prvParseRequestCompact( ucADURequestPayloadNoDeployment, sizeof( ucADURequestPayloadNoDeployment ) - 1, &xRequest );
+
+    assert_int_equal( xRequest.xWorkflow.xAction, ulWorkflowActionNoDeployment );
+    assert_memory_equal( xRequest.xWorkflow.pucID, ucWorkflowIDNoDeployment, sizeof( ucWorkflowIDNoDeployment ) - 1 );
+    assert_int_equal( xRequest.xWorkflow.ulIDLength, sizeof( ucWorkflowIDNoDeployment ) - 1 );
+    assert_null( xRequest.pucUpdateManifest );
+    assert_int_equal( xRequest.ulUpdateManifestLength, 0 );
+    assert_null( xRequest.pucUpdateManifestSignature );
+    assert_int_equal( xRequest.ulUpdateManifestSignatureLength, 0 );
+    assert_int_equal( xRequest.ulStepsCount, 0 );
+    assert_int_equal( xRequest.ulFileUrlCount, 0 );
+    assert_int_equal( AzureIoTADUUpdateRequestCompact_GetStep( &xRequest, 0, &xStep ), eAzureIoTErrorItemNotFound );
+    assert_int_equal( AzureIoTADUUpdateRequestCompact_FindFileUrl( &xRequest, ucFilesID, sizeof( ucFilesID ) - 1, &xFileUrl ), eAzureIoTErrorItemNotFound );
+
+    prvParseRequestCompact( ucADURequestPayloadNoDeploymentNullManifest, sizeof( ucADURequestPayloadNoDeploymentNullManifest ) - 1, &xRequest );
+
+    assert_int_equal( xRequest.xWorkflow.xAction, ulWorkflowActionNoDeployment );
+    assert_null( xRequest.pucUpdateManifest );
+    assert_int_equal( xRequest.ulUpdateManifestLength, 0 );
+    assert_null( xRequest.pucUpdateManifestSignature );
+    assert_int_equal( xRequest.ulUpdateManifestSignatureLength, 0 );
+    assert_int_equal( xRequest.ulFileUrlCount, 0 );
+}
+
+static void testAzureIoTADUClient_ParseRequestCompact_Size( void ** ppvState )
+{
+    print_message( "AzureIoTADUUpdateRequest_t: %u bytes, AzureIoTADUUpdateRequestCompact_t: %u bytes\n",
+                   ( unsigned int ) sizeof( AzureIoTADUUpdateRequest_t ),
+                   ( unsigned int ) sizeof( AzureIoTADUUpdateRequestCompact_t ) );
+    assert_true( sizeof( AzureIoTADUUpdateRequestCompact_t ) * 4 < sizeof( AzureIoTADUUpdateRequest_t ) );
+}
+
 static void testAzureIoTADUClient_SendResponse_InvalidArgFailure( void ** ppvState )
 {
     AzureIoTADUClient_t xTestIoTADUClient;
@@ -816,6 +1039,12 @@ uint32_t ulGetAllTests()
         cmocka_unit_test( testAzureIoTADUClient_ParseRequest_UnusedFields_Success ),
         cmocka_unit_test( testAzureIoTADUClient_ParseRequest_NoDeployment_Success ),
         cmocka_unit_test( testAzureIoTADUClient_ParseRequest_NoDeploymentNullManifest_Success ),
+        cmocka_unit_test( testAzureIoTADUClient_ParseRequestCompact_InvalidArgFailure ),
+        cmocka_unit_test( testAzureIoTADUClient_ParseRequestCompact_Success ),
+        cmocka_unit_test( testAzureIoTADUClient_ParseRequestCompact_UnusedFields_Success ),
+        cmocka_unit_test( testAzureIoTADUClient_ParseRequestCompact_MultiStep_Success ),
+        cmocka_unit_test( testAzureIoTADUClient_ParseRequestCompact_NoDeployment_Success ),
+        cmocka_unit_test( testAzureIoTADUClient_ParseRequestCompact_Size ),
         cmocka_unit_test( testAzureIoTADUClient_SendResponse_InvalidArgFailure ),
         cmocka_unit_test( testAzureIoTADUClient_SendResponse_Success ),
         cmocka_unit_test( testAzureIoTADUClient_SendAgentState_InvalidArgFailure ),
@@ -0,0 +1,1650 @@
+/* Copyright (c) Microsoft Corporation.
+ * Licensed under the MIT License. */
+
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <setjmp.h>
+
+#include <cmocka.h>
+
+#include "azure_iot_mqtt.h"
+#include "azure_iot_adu_download.h"
+#include "azure_iot_adu_heatshrink.h"
+/*-----------------------------------------------------------*/
+
+#define testCHUNK_SIZE        ( 1024 )
+#define testFILE_SIZE         ( 10 * testCHUNK_SIZE + 100 )
+#define testFILE_CHUNK_COUNT  ( 11 )
+#define testSIM_FILE_SIZE     ( 60 * 1024 )
+#define testSIM_MIN_CHUNK     ( 512 )
+#define testSIM_MAX_CHUNK     ( 8 * 1024 )
+#define testPATCH_OLD_SIZE    ( 8000 )
+#define testPATCH_EXTRA_SIZE  ( 500 )
+#define testDECODED_SIZE      ( 40000 )
+#define testSTREAM_CHUNK_SIZE ( 4 * testCHUNK_SIZE )
+#define testKEEP_ALIVE_MS     ( 1000 )
+#define testSLICE_MS          ( 200 )
+#define testPATCH_SIZE        ( azureiotaduPATCH_HEADER_SIZE + azureiotaduPATCH_CONTROL_SIZE + testPATCH_OLD_SIZE + testPATCH_EXTRA_SIZE )
+/*-----------------------------------------------------------*/
+
+/* Data exported by cmocka port for HTTP and flash */
+extern const uint8_t * pucTestHTTPFile;
+extern uint32_t ulTestHTTPFileLength;
+extern uint32_t ulTestHTTPMaxBodyLength;
+extern int32_t lTestHTTPLastRangeStart;
+extern int32_t lTestHTTPLastRangeEnd;
+extern uint32_t ulTestHTTPStreamFailLength;
+extern uint32_t ulTestHTTPStreamFragmentCount;
+extern uint32_t ulTestHTTPPipelinedCount;
+extern AzureIoTTransportInterface_t * pxTestHTTPTransport;
+extern AzureIoTTransportConnect_t xTestHTTPConnect;
+extern void * pvTestHTTPConnectContext;
+extern uint8_t ucTestFlash[];
+extern uint8_t ucTestActiveFlash[];
+extern uint32_t ulTestFlashWriteCount;
+extern uint32_t ulTestFlashPageSize;
+extern uint32_t ulTestFlashSectorSize;
+extern uint32_t ulTestFlashUnalignedWriteCount;
+extern uint32_t ulTestFlashSectorCrossingCount;
+extern uint8_t ucTestCheckpoint[];
+extern uint32_t ulTestCheckpointLength;
+extern uint32_t ulTestCheckpointSaveCount;
+extern uint32_t ulTestHTTPBytesPerMs;
+extern uint32_t ulTestHTTPRoundTripMs;
+extern uint32_t ulTestHTTPTimeoutMs;
+extern uint32_t ulTestHTTPLossPerMillionBytes;
+extern uint32_t ulTestHTTPSimulatedMs;
+extern uint32_t ulTestHTTPRandomSeed;
+
+/* Data exported by cmocka port for MQTT */
+extern void ( * pxTestMQTTProcessLoopHook )( uint32_t ulMilliseconds );
+/*-----------------------------------------------------------*/
+
+static const char ucTestURL[] = "unittest.blob.core.windows.net";
+static const char ucTestPath[] = "/container/image.bin";
+static const uint8_t ucTestFileId[] = "00";
+static const uint8_t ucTestFileHash[] = "xHAwOiqEzzUhhqhv7Yrwu9rQ1BCHdcVEcRZBAnv5aPE=";
+static const uint8_t ucTestOtherFileHash[] = "LBU6uZzzMuyIyhUdCULKchIhfPk9pRmSrL8UKUWXDnk=";
+static uint8_t ucTestFile[ testFILE_SIZE ];
+static uint8_t ucDownloadBuffer[ azureiotaduDOWNLOAD_BUFFER_SIZE( testCHUNK_SIZE ) ];
+static uint8_t ucSimFile[ testSIM_FILE_SIZE ];
+static uint8_t ucSimBuffer[ azureiotaduDOWNLOAD_BUFFER_SIZE( testSIM_MAX_CHUNK ) ];
+static uint8_t ucTestPatchFile[ testPATCH_SIZE ];
+static uint8_t ucTestPatchImage[ testPATCH_OLD_SIZE + testPATCH_EXTRA_SIZE ];
+static uint8_t ucPatchBuffer[ 256 ];
+static uint8_t ucTestDecodedFile[ testDECODED_SIZE ];
+static uint8_t ucTestEncodedFile[ testDECODED_SIZE / 8 ];
+static uint32_t ulTestEncodedFileLength;
+static uint8_t ucDecodeBuffer[ 100 ];
+static uint8_t ucHeatshrinkWindow[ azureiotaduHEATSHRINK_WINDOW_SIZE( 8 ) ];
+static uint8_t ucFlashWriterBuffer[ 1024 ];
+static AzureIoTHTTP_t xTestHTTPClient;
+static AzureADUImage_t xTestImage;
+static AzureIoTTransportInterface_t xTransportInterface =
+{
+    .pxNetworkContext = NULL,
+    .xSend            = ( AzureIoTTransportSend_t ) 0xA5A5A5A5,
+    .xRecv            = ( AzureIoTTransportRecv_t ) 0xACACACAC
+};
+static TickType_t xTestTickCount = 0;
+static AzureIoTHubClient_t xTestHubClient;
+static uint32_t ulTestHubProcessCount;
+static uint32_t ulTestHubLastProcessMs;
+static uint32_t ulTestHubMaxGapMs;
+/*-----------------------------------------------------------*/
+
+TickType_t xTaskGetTickCount( void );
+uint32_t ulGetAllTests();
+/*-----------------------------------------------------------*/
+
+TickType_t xTaskGetTickCount( void )
+{
+    /* Every call moves time forward, so each step takes measurable time. */
+    return xTestTickCount++ + ulTestHTTPSimulatedMs;
+}
+/*-----------------------------------------------------------*/
+
+static void prvSetupTestFile( void )
+{
+    uint32_t ulIndex;
+
+    for( ulIndex = 0; ulIndex < sizeof( ucTestFile ); ulIndex++ )
+    {
+        ucTestFile[ ulIndex ] = ( uint8_t ) ( ulIndex * 31 + 7 );
+    }
+
+    pucTestHTTPFile = ucTestFile;
+    ulTestHTTPFileLength = sizeof( ucTestFile );
+    ulTestHTTPMaxBodyLength = 0;
+    ulTestFlashPageSize = 1;
+    ulTestFlashSectorSize = 1;
+
+    will_return( AzureIoTPlatform_Init, eAzureIoTSuccess );
+    assert_int_equal( AzureIoTPlatform_Init( &xTestImage ), eAzureIoTSuccess );
+}
+/*-----------------------------------------------------------*/
+
+static void prvAssertTestFileSHA256( AzureIoTADUDownload_t * pxDownload )
+{
+    AzureIoTCryptoSHA256Context_t xContext;
+    uint8_t ucExpected[ azureiotcryptoSHA256_SIZE ];
+    uint8_t ucActual[ azureiotcryptoSHA256_SIZE ];
+
+    /* Hash of the whole file in one go */
+    assert_int_equal( AzureIoTCrypto_SHA256Init( &xContext ), eAzureIoTSuccess );
+    assert_int_equal( AzureIoTCrypto_SHA256Update( &xContext, ucTestFile, sizeof( ucTestFile ) ), eAzureIoTSuccess );
+    assert_int_equal( AzureIoTCrypto_SHA256Final( &xContext, ucExpected, sizeof( ucExpected ) ), eAzureIoTSuccess );
+    assert_int_equal( AzureIoTADUDownload_GetSHA256( pxDownload, ucActual, sizeof( ucActual ) ), eAzureIoTSuccess );
+    assert_memory_equal( ucActual, ucExpected, sizeof( ucExpected ) );
+}
+/*-----------------------------------------------------------*/
+
+static void prvSetupTestDownload( AzureIoTADUDownload_t * pxDownload )
+{
+    prvSetupTestFile();
+
+    assert_int_equal( AzureIoTADUDownload_Init( pxDownload, &xTestHTTPClient, &xTestImage,
+                                                ucDownloadBuffer, sizeof( ucDownloadBuffer ),
+                                                testCHUNK_SIZE ),
+                      eAzureIoTSuccess );
+    assert_int_equal( AzureIoTADUDownload_Start( pxDownload, &xTransportInterface,
+                                                 ucTestURL, sizeof( ucTestURL ) - 1,
+                                                 ucTestPath, sizeof( ucTestPath ) - 1,
+                                                 sizeof( ucTestFile ) ),
+                      eAzureIoTSuccess );
+}
+/*-----------------------------------------------------------*/
+
+/* A patch keeping the old image with a few bytes changed, then appending new bytes */
+static void prvSetupTestPatchFile( void )
+{
+    uint8_t ucHeader[ azureiotaduPATCH_HEADER_SIZE + azureiotaduPATCH_CONTROL_SIZE ] =
+    {
+        'A', 'Z', 'D', 'P',
+        ( uint8_t ) testPATCH_OLD_SIZE, ( uint8_t ) ( testPATCH_OLD_SIZE >> 8 ), 0, 0,
+        ( uint8_t ) sizeof( ucTestPatchImage ), ( uint8_t ) ( sizeof( ucTestPatchImage ) >> 8 ), 0, 0,
+        ( uint8_t ) testPATCH_OLD_SIZE, ( uint8_t ) ( testPATCH_OLD_SIZE >> 8 ), 0, 0,
+        ( uint8_t ) testPATCH_EXTRA_SIZE, ( uint8_t ) ( testPATCH_EXTRA_SIZE >> 8 ), 0, 0,
+        0, 0, 0, 0
+    };
+    uint8_t * pucDiff = ucTestPatchFile + sizeof( ucHeader );
+    uint32_t ulIndex;
+
+    memcpy( ucTestPatchFile, ucHeader, sizeof( ucHeader ) );
+
+    for( ulIndex = 0; ulIndex < testPATCH_OLD_SIZE; ulIndex++ )
+    {
+        ucTestActiveFlash[ ulIndex ] = ( uint8_t ) ( ulIndex * 11 + 1 );
+        pucDiff[ ulIndex ] = ( ( ulIndex % 50 ) == 0 ) ? 1 : 0;
+        ucTestPatchImage[ ulIndex ] = ( uint8_t ) ( ucTestActiveFlash[ ulIndex ] + pucDiff[ ulIndex ] );
+    }
+
+    for( ulIndex = 0; ulIndex < testPATCH_EXTRA_SIZE; ulIndex++ )
+    {
+        pucDiff[ testPATCH_OLD_SIZE + ulIndex ] = ( uint8_t ) ( ulIndex * 3 );
+        ucTestPatchImage[ testPATCH_OLD_SIZE + ulIndex ] = ( uint8_t ) ( ulIndex * 3 );
+    }
+
+    pucTestHTTPFile = ucTestPatchFile;
+    ulTestHTTPFileLength = sizeof( ucTestPatchFile );
+    ulTestHTTPMaxBodyLength = 0;
+    memset( ucTestFlash, 0xFF, sizeof( ucTestPatchImage ) );
+    ulTestCheckpointLength = 0;
+}
+/*-----------------------------------------------------------*/
+
+static void prvStartTestPatchDownload( AzureIoTADUDownload_t * pxDownload,
+                                       AzureIoTADUPatch_t * pxPatch )
+{
+    assert_int_equal( AzureIoTADUDownload_Init( pxDownload, &xTestHTTPClient, &xTestImage,
+                                                ucDownloadBuffer, sizeof( ucDownloadBuffer ),
+                                                testCHUNK_SIZE ),
+                      eAzureIoTSuccess );
+    assert_int_equal( AzureIoTADUPatch_Init( pxPatch, &xTestImage, ucPatchBuffer, sizeof( ucPatchBuffer ) ),
+                      eAzureIoTSuccess );
+    assert_int_equal( AzureIoTADUDownload_SetPatch( pxDownload, pxPatch ), eAzureIoTSuccess );
+    assert_int_equal( AzureIoTADUDownload_SetCheckpoint( pxDownload,
+                                                         ucTestFileId, sizeof( ucTestFileId ) - 1,
+                                                         ucTestFileHash, sizeof( ucTestFileHash ) - 1,
+                                                         2 * testCHUNK_SIZE ),
+                      eAzureIoTSuccess );
+    assert_int_equal( AzureIoTADUDownload_Start( pxDownload, &xTransportInterface,
+                                                 ucTestURL, sizeof( ucTestURL ) - 1,
+                                                 ucTestPath, sizeof( ucTestPath ) - 1,
+                                                 sizeof( ucTestPatchFile ) ),
+                      eAzureIoTSuccess );
+}
+/*-----------------------------------------------------------*/
+
+/* A 16 bytes pattern, heatshrink encoded with -w 8 -l 4 as literals then back-references to the previous copy */
+static void prvSetupTestEncodedFile( void )
+{
+    uint32_t ulBitCount = 0;
+    uint32_t ulValue;
+    uint32_t ulBits;
+    uint32_t ulIndex;
+
+    memset( ucTestEncodedFile, 0, sizeof( ucTestEncodedFile ) );
+
+    for( ulIndex = 0; ulIndex < testDECODED_SIZE; ulIndex += ( ulIndex < 16 ) ? 1 : 16 )
+    {
+        if( ulIndex < 16 )
+        {
+            ucTestDecodedFile[ ulIndex ] = ( uint8_t ) ( ulIndex * 17 + 3 );
+            ulValue = 0x100 | ucTestDecodedFile[ ulIndex ];
+            ulBits = 9;
+        }
+        else
+        {
+            memcpy( ucTestDecodedFile + ulIndex, ucTestDecodedFile, 16 );
+            ulValue = ( 15 << 4 ) | 15;
+            ulBits = 13;
+        }
+
+        while( ulBits-- > 0 )
+        {
+            ucTestEncodedFile[ ulBitCount / 8 ] |= ( uint8_t ) ( ( ( ulValue >> ulBits ) & 1 ) << ( 7 - ( ulBitCount % 8 ) ) );
+            ulBitCount++;
+        }
+    }
+
+    ulTestEncodedFileLength = ( ulBitCount + 7 ) / 8;
+    pucTestHTTPFile = ucTestEncodedFile;
+    ulTestHTTPFileLength = ulTestEncodedFileLength;
+    ulTestHTTPMaxBodyLength = 0;
+    memset( ucTestFlash, 0xFF, testDECODED_SIZE );
+}
+/*-----------------------------------------------------------*/
+
+static void prvRunTestDecoderDownload( AzureIoTADUDownloadHash_t xHash,
+                                       uint8_t * pucSHA256 )
+{
+    AzureIoTADUDownload_t xDownload;
+    AzureIoTADUDownloadStats_t xStats;
+    AzureIoTADUHeatshrink_t xHeatshrink;
+    AzureIoTADUDecoderInterface_t xDecoder = { &xHeatshrink, AzureIoTADUHeatshrink_Reset, AzureIoTADUHeatshrink_Decode };
+    AzureIoTResult_t xResult;
+
+    prvSetupTestEncodedFile();
+
+    assert_int_equal( AzureIoTADUHeatshrink_Init( &xHeatshrink, 8, 4, ucHeatshrinkWindow, sizeof( ucHeatshrinkWindow ) ),
+                      eAzureIoTSuccess );
+    assert_int_equal( AzureIoTADUDownload_Init( &xDownload, &xTestHTTPClient, &xTestImage,
+                                                ucDownloadBuffer, sizeof( ucDownloadBuffer ),
+                                                testCHUNK_SIZE ),
+                      eAzureIoTSuccess );
+    assert_int_equal( AzureIoTADUDownload_SetDecoder( &xDownload, &xDecoder, ucDecodeBuffer, sizeof( ucDecodeBuffer ), xHash ),
+                      eAzureIoTSuccess );
+
+    /* Checkpoints are ignored with a decoder, AzureIoTPlatform_SaveCheckpoint() is not called */
+    assert_int_equal( AzureIoTADUDownload_SetCheckpoint( &xDownload,
+                                                         ucTestFileId, sizeof( ucTestFileId ) - 1,
+                                                         ucTestFileHash, sizeof( ucTestFileHash ) - 1, 0 ),
+                      eAzureIoTSuccess );
+    assert_int_equal( AzureIoTADUDownload_Start( &xDownload, &xTransportInterface,
+                                                 ucTestURL, sizeof( ucTestURL ) - 1,
+                                                 ucTestPath, sizeof( ucTestPath ) - 1,
+                                                 ulTestEncodedFileLength ),
+                      eAzureIoTSuccess );
+
+    do
+    {
+        xResult = AzureIoTADUDownload_Process( &xDownload );
+    } while( xResult == eAzureIoTErrorPending );
+
+    assert_int_equal( xResult, eAzureIoTSuccess );
+    assert_memory_equal( ucTestFlash, ucTestDecodedFile, testDECODED_SIZE );
+    assert_int_equal( AzureIoTADUDownload_GetStats( &xDownload, &xStats ), eAzureIoTSuccess );
+    assert_int_equal( xStats.ulBytesDownloaded, ulTestEncodedFileLength );
+    assert_int_equal( xStats.ulBytesDecoded, testDECODED_SIZE );
+    assert_int_equal( AzureIoTADUDownload_GetSHA256( &xDownload, pucSHA256, azureiotcryptoSHA256_SIZE ), eAzureIoTSuccess );
+}
+/*-----------------------------------------------------------*/
+
+static void prvCalculateSHA256( const uint8_t * pucData,
+                                uint32_t ulLength,
+                                uint8_t * pucSHA256 )
+{
+    AzureIoTCryptoSHA256Context_t xSHA256Context;
+
+    assert_int_equal( AzureIoTCrypto_SHA256Init( &xSHA256Context ), eAzureIoTSuccess );
+    assert_int_equal( AzureIoTCrypto_SHA256Update( &xSHA256Context, pucData, ulLength ), eAzureIoTSuccess );
+    assert_int_equal( AzureIoTCrypto_SHA256Final( &xSHA256Context, pucSHA256, azureiotcryptoSHA256_SIZE ), eAzureIoTSuccess );
+}
+/*-----------------------------------------------------------*/
+
+/* Download the simulation file over the link set up in the HTTP port, retrying failed requests */
+static uint32_t prvRunSimulatedDownload( uint32_t ulChunkSize,
+                                         uint32_t ulMinChunkSize,
+                                         AzureIoTADUDownloadStats_t * pxStats )
+{
+    AzureIoTADUDownload_t xDownload;
+    AzureIoTResult_t xResult;
+    uint32_t ulStartMs;
+    uint32_t ulIteration = 0;
+
+    ulTestHTTPRandomSeed = 1;
+    ulStartMs = ulTestHTTPSimulatedMs;
+
+    assert_int_equal( AzureIoTADUDownload_Init( &xDownload, &xTestHTTPClient, &xTestImage,
+                                                ucSimBuffer, sizeof( ucSimBuffer ), ulChunkSize ),
+                      eAzureIoTSuccess );
+
+    if( ulMinChunkSize != 0 )
+    {
+        assert_int_equal( AzureIoTADUDownload_SetAdaptiveChunkSize( &xDownload, ulMinChunkSize ), eAzureIoTSuccess );
+    }
+
+    assert_int_equal( AzureIoTADUDownload_Start( &xDownload, &xTransportInterface,
+                                                 ucTestURL, sizeof( ucTestURL ) - 1,
+                                                 ucTestPath, sizeof( ucTestPath ) - 1,
+                                                 sizeof( ucSimFile ) ),
+                      eAzureIoTSuccess );
+
+    do
+    {
+        xResult = AzureIoTADUDownload_Process( &xDownload );
+        assert_true( ++ulIteration < 10000 );
+    } while( ( xResult == eAzureIoTErrorPending ) || ( xResult == eAzureIoTErrorFailed ) );
+
+    assert_int_equal( xResult, eAzureIoTSuccess );
+    assert_memory_equal( ucTestFlash, ucSimFile, sizeof( ucSimFile ) );
+    assert_int_equal( AzureIoTADUDownload_GetStats( &xDownload, pxStats ), eAzureIoTSuccess );
+
+    return ulTestHTTPSimulatedMs - ulStartMs;
+}
+/*-----------------------------------------------------------*/
+
+/* Records how long the hub client waits between two ProcessLoop calls, the latency of its commands and keep-alives */
+static void prvTestHubProcessLoop( uint32_t ulMilliseconds )
+{
+    uint32_t ulNowMs = ( uint32_t ) ( xTestTickCount + ulTestHTTPSimulatedMs );
+
+    if( ( ulTestHubProcessCount > 0 ) && ( ( ulNowMs - ulTestHubLastProcessMs ) > ulTestHubMaxGapMs ) )
+    {
+        ulTestHubMaxGapMs = ulNowMs - ulTestHubLastProcessMs;
+    }
+
+    /* The hub client waits for packets for the whole timeout */
+    xTestTickCount += ulMilliseconds;
+    ulTestHubLastProcessMs = ulNowMs + ulMilliseconds;
+    ulTestHubProcessCount++;
+}
+/*-----------------------------------------------------------*/
+
+static uint32_t prvRunSlicedDownload( uint32_t ulSliceMs,
+                                      uint32_t ulStepsPerHubProcess,
+                                      uint32_t ulHubProcessMs,
+                                      AzureIoTADUDownloadStats_t * pxStats )
+{
+    AzureIoTADUDownload_t xDownload;
+    AzureIoTResult_t xResult;
+    uint32_t ulStartMs;
+    uint32_t ulIteration = 0;
+
+    ulTestHTTPRandomSeed = 1;
+    ulStartMs = ( uint32_t ) ( xTestTickCount + ulTestHTTPSimulatedMs );
+    ulTestHubProcessCount = 0;
+    ulTestHubMaxGapMs = 0;
+    pxTestMQTTProcessLoopHook = prvTestHubProcessLoop;
+    will_return_always( AzureIoTMQTT_ProcessLoop, eAzureIoTMQTTSuccess );
+
+    assert_int_equal( AzureIoTADUDownload_Init( &xDownload, &xTestHTTPClient, &xTestImage,
+                                                ucSimBuffer, sizeof( ucSimBuffer ), testSIM_MAX_CHUNK ),
+                      eAzureIoTSuccess );
+    assert_int_equal( AzureIoTADUDownload_SetTimeSlice( &xDownload, ulSliceMs ), eAzureIoTSuccess );
+    assert_int_equal( AzureIoTADUDownload_SetPriority( &xDownload, ulStepsPerHubProcess, ulHubProcessMs ), eAzureIoTSuccess );
+    assert_int_equal( AzureIoTADUDownload_Start( &xDownload, &xTransportInterface,
+                                                 ucTestURL, sizeof( ucTestURL ) - 1,
+                                                 ucTestPath, sizeof( ucTestPath ) - 1,
+                                                 sizeof( ucSimFile ) ),
+                      eAzureIoTSuccess );
+
+    /* The application loop, which would also run other work between the calls */
+    do
+    {
+        xResult = AzureIoTADUDownload_ProcessLoop( &xDownload, &xTestHubClient, 1000 );
+        assert_true( ++ulIteration < 1000 );
+    } while( xResult == eAzureIoTErrorPending );
+
+    pxTestMQTTProcessLoopHook = NULL;
+
+    assert_int_equal( xResult, eAzureIoTSuccess );
+    assert_memory_equal( ucTestFlash, ucSimFile, sizeof( ucSimFile ) );
+    assert_int_equal( AzureIoTADUDownload_GetStats( &xDownload, pxStats ), eAzureIoTSuccess );
+
+    return ( uint32_t ) ( xTestTickCount + ulTestHTTPSimulatedMs ) - ulStartMs;
+}
+/*-----------------------------------------------------------*/
+
+static void prvSetupSimulatedLink( uint32_t ulRoundTripMs,
+                                   uint32_t ulBytesPerMs,
+                                   uint32_t ulLossPerMillionBytes,
+                                   uint32_t ulTimeoutMs )
+{
+    uint32_t ulIndex;
+
+    for( ulIndex = 0; ulIndex < sizeof( ucSimFile ); ulIndex++ )
+    {
+        ucSimFile[ ulIndex ] = ( uint8_t ) ( ulIndex * 13 + 5 );
+    }
+
+    pucTestHTTPFile = ucSimFile;
+    ulTestHTTPFileLength = sizeof( ucSimFile );
+    ulTestHTTPMaxBodyLength = 0;
+    ulTestHTTPRoundTripMs = ulRoundTripMs;
+    ulTestHTTPBytesPerMs = ulBytesPerMs;
+    ulTestHTTPLossPerMillionBytes = ulLossPerMillionBytes;
+    ulTestHTTPTimeoutMs = ulTimeoutMs;
+
+    will_return_always( AzureIoTHTTP_InitNextRequest, eAzureIoTHTTPSuccess );
+    will_return_always( AzureIoTHTTP_Request, eAzureIoTHTTPSuccess );
+    will_return_always( AzureIoTPlatform_WriteBlock, eAzureIoTSuccess );
+}
+/*-----------------------------------------------------------*/
+
+static void prvTeardownSimulatedLink( void )
+{
+    ulTestHTTPBytesPerMs = 0;
+    ulTestHTTPSimulatedMs = 0;
+}
+/*-----------------------------------------------------------*/
+
+static void testAzureIoTADUDownload_Init_Failure( void ** ppvState )
+{
+    AzureIoTADUDownload_t xDownload;
+
+    ( void ) ppvState;
+
+    /* Fail init when null download is passed */
+    assert_int_equal( AzureIoTADUDownload_Init( NULL, &xTestHTTPClient, &xTestImage,
+                                                ucDownloadBuffer, sizeof( ucDownloadBuffer ),
+                                                testCHUNK_SIZE ),
+                      eAzureIoTErrorInvalidArgument );
+
+    /* Fail init when null HTTP handle is passed */
+    assert_int_equal( AzureIoTADUDownload_Init( &xDownload, NULL, &xTestImage,
+                                                ucDownloadBuffer, sizeof( ucDownloadBuffer ),
+                                                testCHUNK_SIZE ),
+                      eAzureIoTErrorInvalidArgument );
+
+    /* Fail init when null image is passed */
+    assert_int_equal( AzureIoTADUDownload_Init( &xDownload, &xTestHTTPClient, NULL,
+                                                ucDownloadBuffer, sizeof( ucDownloadBuffer ),
+                                                testCHUNK_SIZE ),
+                      eAzureIoTErrorInvalidArgument );
+
+    /* Fail init when null buffer is passed */
+    assert_int_equal( AzureIoTADUDownload_Init( &xDownload, &xTestHTTPClient, &xTestImage,
+                                                NULL, sizeof( ucDownloadBuffer ),
+                                                testCHUNK_SIZE ),
+                      eAzureIoTErrorInvalidArgument );
+
+    /* Fail init when chunk size is zero */
+    assert_int_equal( AzureIoTADUDownload_Init( &xDownload, &xTestHTTPClient, &xTestImage,
+                                                ucDownloadBuffer, sizeof( ucDownloadBuffer ),
+                                                0 ),
+                      eAzureIoTErrorInvalidArgument );
+
+    /* Fail init when buffer cannot hold two chunks */
+    assert_int_equal( AzureIoTADUDownload_Init( &xDownload, &xTestHTTPClient, &xTestImage,
+                                                ucDownloadBuffer, sizeof( ucDownloadBuffer ),
+                                                testCHUNK_SIZE * 2 ),
+                      eAzureIoTErrorOutOfMemory );
+}
+/*-----------------------------------------------------------*/
+
+static void testAzureIoTADUDownload_Start_Failure( void ** ppvState )
+{
+    AzureIoTADUDownload_t xDownload;
+
+    ( void ) ppvState;
+
+    assert_int_equal( AzureIoTADUDownload_Init( &xDownload, &xTestHTTPClient, &xTestImage,
+                                                ucDownloadBuffer, sizeof( ucDownloadBuffer ),
+                                                testCHUNK_SIZE ),
+                      eAzureIoTSuccess );
+
+    /* Fail start when null transport is passed */
+    assert_int_equal( AzureIoTADUDownload_Start( &xDownload, NULL,
+                                                 ucTestURL, sizeof( ucTestURL ) - 1,
+                                                 ucTestPath, sizeof( ucTestPath ) - 1,
+                                                 0 ),
+                      eAzureIoTErrorInvalidArgument );
+
+    /* Fail start when null path is passed */
+    assert_int_equal( AzureIoTADUDownload_Start( &xDownload, &xTransportInterface,
+                                                 ucTestURL, sizeof( ucTestURL ) - 1,
+                                                 NULL, 0,
+                                                 0 ),
+                      eAzureIoTErrorInvalidArgument );
+
+    /* Fail start when the size request fails */
+    will_return( AzureIoTHTTP_RequestSizeInit, eAzureIoTHTTPSuccess );
+    will_return( AzureIoTHTTP_RequestSize, -1 );
+    assert_int_equal( AzureIoTADUDownload_Start( &xDownload, &xTransportInterface,
+                                                 ucTestURL, sizeof( ucTestURL ) - 1,
+                                                 ucTestPath, sizeof( ucTestPath ) - 1,
+                                                 0 ),
+                      eAzureIoTErrorFailed );
+}
+/*-----------------------------------------------------------*/
+
+static void testAzureIoTADUDownload_Process_Success( void ** ppvState )
+{
+    AzureIoTADUDownload_t xDownload;
+    AzureIoTADUDownloadStats_t xStats;
+    AzureIoTResult_t xResult;
+    uint8_t ucSHA256[ azureiotcryptoSHA256_SIZE ];
+
+    ( void ) ppvState;
+
+    prvSetupTestFile();
+
+    /* File size is requested from the server */
+    assert_int_equal( AzureIoTADUDownload_Init( &xDownload, &xTestHTTPClient, &xTestImage,
+                                                ucDownloadBuffer, sizeof( ucDownloadBuffer ),
+                                                testCHUNK_SIZE ),
+                      eAzureIoTSuccess );
+    will_return( AzureIoTHTTP_RequestSizeInit, eAzureIoTHTTPSuccess );
+    will_return( AzureIoTHTTP_RequestSize, testFILE_SIZE );
+    assert_int_equal( AzureIoTADUDownload_Start( &xDownload, &xTransportInterface,
+                                                 ucTestURL, sizeof( ucTestURL ) - 1,
+                                                 ucTestPath, sizeof( ucTestPath ) - 1,
+                                                 0 ),
+                      eAzureIoTSuccess );
+
+    will_return_count( AzureIoTHTTP_InitNextRequest, eAzureIoTHTTPSuccess, testFILE_CHUNK_COUNT );
+    will_return_count( AzureIoTHTTP_Request, eAzureIoTHTTPSuccess, testFILE_CHUNK_COUNT );
+    will_return_count( AzureIoTPlatform_WriteBlock, eAzureIoTSuccess, testFILE_CHUNK_COUNT );
+
+    /* Hash is only available once the whole file is written */
+    assert_int_equal( AzureIoTADUDownload_GetSHA256( &xDownload, ucSHA256, sizeof( ucSHA256 ) ), eAzureIoTErrorPending );
+
+    do
+    {
+        xResult = AzureIoTADUDownload_Process( &xDownload );
+    } while( xResult == eAzureIoTErrorPending );
+
+    assert_int_equal( xResult, eAzureIoTSuccess );
+    assert_memory_equal( ucTestFlash, ucTestFile, sizeof( ucTestFile ) );
+    prvAssertTestFileSHA256( &xDownload );
+
+    /* Fail when the hash buffer is too small */
+    assert_int_equal( AzureIoTADUDownload_GetSHA256( &xDownload, ucSHA256, sizeof( ucSHA256 ) - 1 ), eAzureIoTErrorInvalidArgument );
+
+    /* Last range is the remainder of the file */
+    assert_int_equal( lTestHTTPLastRangeStart, testFILE_SIZE - 100 );
+    assert_int_equal( lTestHTTPLastRangeEnd, testFILE_SIZE - 1 );
+
+    assert_int_equal( AzureIoTADUDownload_GetStats( &xDownload, &xStats ), eAzureIoTSuccess );
+    assert_int_equal( xStats.ulRequestCount, testFILE_CHUNK_COUNT );
+    assert_int_equal( xStats.ulBytesDownloaded, testFILE_SIZE );
+    assert_int_equal( xStats.ulBytesWritten, testFILE_SIZE );
+    assert_true( xStats.ulElapsedMilliseconds > 0 );
+    assert_true( xStats.ulBytesPerSecond > 0 );
+
+    /* Once complete, processing is a no-op */
+    assert_int_equal( AzureIoTADUDownload_Process( &xDownload ), eAzureIoTSuccess );
+}
+/*-----------------------------------------------------------*/
+
+static void testAzureIoTADUDownload_FetchCommit_DoubleBuffer( void ** ppvState )
+{
+    AzureIoTADUDownload_t xDownload;
+    AzureIoTResult_t xResult;
+
+    ( void ) ppvState;
+
+    prvSetupTestDownload( &xDownload );
+
+    /* Nothing to write before the first chunk arrives */
+    assert_int_equal( AzureIoTADUDownload_Commit( &xDownload ), eAzureIoTErrorPending );
+
+    /* Both buffers can be filled before any write */
+    will_return_count( AzureIoTHTTP_InitNextRequest, eAzureIoTHTTPSuccess, 2 );
+    will_return_count( AzureIoTHTTP_Request, eAzureIoTHTTPSuccess, 2 );
+    assert_int_equal( AzureIoTADUDownload_Fetch( &xDownload ), eAzureIoTSuccess );
+    assert_int_equal( AzureIoTADUDownload_Fetch( &xDownload ), eAzureIoTSuccess );
+    assert_int_equal( AzureIoTADUDownload_Fetch( &xDownload ), eAzureIoTErrorOutOfMemory );
+
+    /* Writing the oldest chunk releases its buffer */
+    will_return( AzureIoTPlatform_WriteBlock, eAzureIoTSuccess );
+    assert_int_equal( AzureIoTADUDownload_Commit( &xDownload ), eAzureIoTErrorPending );
+    assert_memory_equal( ucTestFlash, ucTestFile, testCHUNK_SIZE );
+
+    will_return( AzureIoTHTTP_InitNextRequest, eAzureIoTHTTPSuccess );
+    will_return( AzureIoTHTTP_Request, eAzureIoTHTTPSuccess );
+    assert_int_equal( AzureIoTADUDownload_Fetch( &xDownload ), eAzureIoTSuccess );
+
+    /* Drain the rest alternating fetch and commit */
+    will_return_count( AzureIoTHTTP_InitNextRequest, eAzureIoTHTTPSuccess, testFILE_CHUNK_COUNT - 3 );
+    will_return_count( AzureIoTHTTP_Request, eAzureIoTHTTPSuccess, testFILE_CHUNK_COUNT - 3 );
+    will_return_count( AzureIoTPlatform_WriteBlock, eAzureIoTSuccess, testFILE_CHUNK_COUNT - 1 );
+
+    do
+    {
+        xResult = AzureIoTADUDownload_Commit( &xDownload );
+        assert_int_not_equal( AzureIoTADUDownload_Fetch( &xDownload ), eAzureIoTErrorFailed );
+    } while( xResult == eAzureIoTErrorPending );
+
+    assert_int_equal( xResult, eAzureIoTSuccess );
+    assert_int_equal( ulTestFlashWriteCount, testFILE_CHUNK_COUNT );
+    assert_memory_equal( ucTestFlash, ucTestFile, sizeof( ucTestFile ) );
+}
+/*-----------------------------------------------------------*/
+
+static void testAzureIoTADUDownload_Process_ShortResponse( void ** ppvState )
+{
+    AzureIoTADUDownload_t xDownload;
+    AzureIoTADUDownloadStats_t xStats;
+    AzureIoTResult_t xResult;
+
+    ( void ) ppvState;
+
+    prvSetupTestDownload( &xDownload );
+
+    /* Server returns less than requested, the next request continues from there */
+    ulTestHTTPMaxBodyLength = testCHUNK_SIZE / 2;
+    will_return_count( AzureIoTHTTP_InitNextRequest, eAzureIoTHTTPSuccess, 21 );
+    will_return_count( AzureIoTHTTP_Request, eAzureIoTHTTPSuccess, 21 );
+    will_return_count( AzureIoTPlatform_WriteBlock, eAzureIoTSuccess, 21 );
+
+    do
+    {
+        xResult = AzureIoTADUDownload_Process( &xDownload );
+    } while( xResult == eAzureIoTErrorPending );
+
+    assert_int_equal( xResult, eAzureIoTSuccess );
+    assert_memory_equal( ucTestFlash, ucTestFile, sizeof( ucTestFile ) );
+    assert_int_equal( AzureIoTADUDownload_GetStats( &xDownload, &xStats ), eAzureIoTSuccess );
+    assert_int_equal( xStats.ulRequestCount, 21 );
+    prvAssertTestFileSHA256( &xDownload );
+}
+/*-----------------------------------------------------------*/
+
+static void testAzureIoTADUDownload_Process_Failure( void ** ppvState )
+{
+    AzureIoTADUDownload_t xDownload;
+
+    ( void ) ppvState;
+
+    prvSetupTestDownload( &xDownload );
+
+    /* Request failure */
+    will_return( AzureIoTHTTP_InitNextRequest, eAzureIoTHTTPSuccess );
+    will_return( AzureIoTHTTP_Request, eAzureIoTHTTPNetworkError );
+    assert_int_equal( AzureIoTADUDownload_Process( &xDownload ), eAzureIoTErrorFailed );
+
+    /* Write failure */
+    will_return( AzureIoTHTTP_InitNextRequest, eAzureIoTHTTPSuccess );
+    will_return( AzureIoTHTTP_Request, eAzureIoTHTTPSuccess );
+    will_return( AzureIoTPlatform_WriteBlock, eAzureIoTErrorFailed );
+    assert_int_equal( AzureIoTADUDownload_Process( &xDownload ), eAzureIoTErrorFailed );
+
+    /* Chunk that failed to be written is retried */
+    will_return( AzureIoTPlatform_WriteBlock, eAzureIoTSuccess );
+    assert_int_equal( AzureIoTADUDownload_Commit( &xDownload ), eAzureIoTErrorPending );
+    assert_memory_equal( ucTestFlash, ucTestFile, testCHUNK_SIZE );
+}
+/*-----------------------------------------------------------*/
+
+static void testAzureIoTADUDownload_SetCheckpoint_Failure( void ** ppvState )
+{
+    AzureIoTADUDownload_t xDownload;
+    uint8_t ucLongFileId[ azureiotconfigADU_DOWNLOAD_CHECKPOINT_FILE_ID_MAX + 1 ] = { 0 };
+
+    ( void ) ppvState;
+
+    /* Fail when null download is passed */
+    assert_int_equal( AzureIoTADUDownload_SetCheckpoint( NULL,
+                                                         ucTestFileId, sizeof( ucTestFileId ) - 1,
+                                                         ucTestFileHash, sizeof( ucTestFileHash ) - 1,
+                                                         0 ),
+                      eAzureIoTErrorInvalidArgument );
+
+    /* Fail when null file ID is passed */
+    assert_int_equal( AzureIoTADUDownload_SetCheckpoint( &xDownload,
+                                                         NULL, 0,
+                                                         ucTestFileHash, sizeof( ucTestFileHash ) - 1,
+                                                         0 ),
+                      eAzureIoTErrorInvalidArgument );
+
+    /* Fail when null hash is passed */
+    assert_int_equal( AzureIoTADUDownload_SetCheckpoint( &xDownload,
+                                                         ucTestFileId, sizeof( ucTestFileId ) - 1,
+                                                         NULL, 0,
+                                                         0 ),
+                      eAzureIoTErrorInvalidArgument );
+
+    /* Fail when file ID does not fit in the checkpoint */
+    assert_int_equal( AzureIoTADUDownload_SetCheckpoint( &xDownload,
+                                                         ucLongFileId, sizeof( ucLongFileId ),
+                                                         ucTestFileHash, sizeof( ucTestFileHash ) - 1,
+                                                         0 ),
+                      eAzureIoTErrorOutOfMemory );
+}
+/*-----------------------------------------------------------*/
+
+static void testAzureIoTADUDownload_Process_ResumeFromCheckpoint( void ** ppvState )
+{
+    AzureIoTADUDownload_t xDownload;
+    AzureIoTADUDownloadStats_t xStats;
+    AzureIoTResult_t xResult;
+    uint32_t ulIndex;
+
+    ( void ) ppvState;
+
+    prvSetupTestFile();
+    ulTestCheckpointLength = 0;
+    ulTestCheckpointSaveCount = 0;
+
+    assert_int_equal( AzureIoTADUDownload_Init( &xDownload, &xTestHTTPClient, &xTestImage,
+                                                ucDownloadBuffer, sizeof( ucDownloadBuffer ),
+                                                testCHUNK_SIZE ),
+                      eAzureIoTSuccess );
+    assert_int_equal( AzureIoTADUDownload_SetCheckpoint( &xDownload,
+                                                         ucTestFileId, sizeof( ucTestFileId ) - 1,
+                                                         ucTestFileHash, sizeof( ucTestFileHash ) - 1,
+                                                         2 * testCHUNK_SIZE ),
+                      eAzureIoTSuccess );
+
+    /* No checkpoint yet, one is saved at offset 0 */
+    will_return( AzureIoTPlatform_SaveCheckpoint, eAzureIoTSuccess );
+    assert_int_equal( AzureIoTADUDownload_Start( &xDownload, &xTransportInterface,
+                                                 ucTestURL, sizeof( ucTestURL ) - 1,
+                                                 ucTestPath, sizeof( ucTestPath ) - 1,
+                                                 sizeof( ucTestFile ) ),
+                      eAzureIoTSuccess );
+
+    /* Connection drops after 5 chunks, the checkpoint is at 4 chunks */
+    will_return_count( AzureIoTHTTP_InitNextRequest, eAzureIoTHTTPSuccess, 5 );
+    will_return_count( AzureIoTHTTP_Request, eAzureIoTHTTPSuccess, 5 );
+    will_return_count( AzureIoTPlatform_WriteBlock, eAzureIoTSuccess, 5 );
+    will_return_count( AzureIoTPlatform_SaveCheckpoint, eAzureIoTSuccess, 2 );
+
+    for( ulIndex = 0; ulIndex < 5; ulIndex++ )
+    {
+        assert_int_equal( AzureIoTADUDownload_Process( &xDownload ), eAzureIoTErrorPending );
+    }
+
+    assert_int_equal( ulTestCheckpointSaveCount, 3 );
+
+    /* Restart of the workflow for the same file */
+    assert_int_equal( AzureIoTADUDownload_Init( &xDownload, &xTestHTTPClient, &xTestImage,
+                                                ucDownloadBuffer, sizeof( ucDownloadBuffer ),
+                                                testCHUNK_SIZE ),
+                      eAzureIoTSuccess );
+    assert_int_equal( AzureIoTADUDownload_SetCheckpoint( &xDownload,
+                                                         ucTestFileId, sizeof( ucTestFileId ) - 1,
+                                                         ucTestFileHash, sizeof( ucTestFileHash ) - 1,
+                                                         2 * testCHUNK_SIZE ),
+                      eAzureIoTSuccess );
+    assert_int_equal( AzureIoTADUDownload_Start( &xDownload, &xTransportInterface,
+                                                 ucTestURL, sizeof( ucTestURL ) - 1,
+                                                 ucTestPath, sizeof( ucTestPath ) - 1,
+                                                 sizeof( ucTestFile ) ),
+                      eAzureIoTSuccess );
+
+    /* First request continues from the checkpoint */
+    will_return( AzureIoTHTTP_InitNextRequest, eAzureIoTHTTPSuccess );
+    will_return( AzureIoTHTTP_Request, eAzureIoTHTTPSuccess );
+    assert_int_equal( AzureIoTADUDownload_Fetch( &xDownload ), eAzureIoTSuccess );
+    assert_int_equal( lTestHTTPLastRangeStart, 4 * testCHUNK_SIZE );
+
+    will_return_count( AzureIoTHTTP_InitNextRequest, eAzureIoTHTTPSuccess, testFILE_CHUNK_COUNT - 5 );
+    will_return_count( AzureIoTHTTP_Request, eAzureIoTHTTPSuccess, testFILE_CHUNK_COUNT - 5 );
+    will_return_count( AzureIoTPlatform_WriteBlock, eAzureIoTSuccess, testFILE_CHUNK_COUNT - 4 );
+    will_return_count( AzureIoTPlatform_SaveCheckpoint, eAzureIoTSuccess, 4 );
+
+    do
+    {
+        xResult = AzureIoTADUDownload_Process( &xDownload );
+    } while( xResult == eAzureIoTErrorPending );
+
+    assert_int_equal( xResult, eAzureIoTSuccess );
+    assert_memory_equal( ucTestFlash, ucTestFile, sizeof( ucTestFile ) );
+
+    assert_int_equal( AzureIoTADUDownload_GetStats( &xDownload, &xStats ), eAzureIoTSuccess );
+    assert_int_equal( xStats.ulResumeOffset, 4 * testCHUNK_SIZE );
+    assert_int_equal( xStats.ulRequestCount, testFILE_CHUNK_COUNT - 4 );
+    assert_int_equal( xStats.ulBytesWritten, testFILE_SIZE - 4 * testCHUNK_SIZE );
+
+    /* Hash state restored from the checkpoint covers the bytes written before the restart */
+    prvAssertTestFileSHA256( &xDownload );
+}
+/*-----------------------------------------------------------*/
+
+static void testAzureIoTADUDownload_Start_CheckpointOtherFile( void ** ppvState )
+{
+    AzureIoTADUDownload_t xDownload;
+    AzureIoTADUDownloadStats_t xStats;
+
+    ( void ) ppvState;
+
+    prvSetupTestFile();
+    ulTestCheckpointLength = 0;
+
+    /* Save a checkpoint in the middle of the file */
+    assert_int_equal( AzureIoTADUDownload_Init( &xDownload, &xTestHTTPClient, &xTestImage,
+                                                ucDownloadBuffer, sizeof( ucDownloadBuffer ),
+                                                testCHUNK_SIZE ),
+                      eAzureIoTSuccess );
+    assert_int_equal( AzureIoTADUDownload_SetCheckpoint( &xDownload,
+                                                         ucTestFileId, sizeof( ucTestFileId ) - 1,
+                                                         ucTestFileHash, sizeof( ucTestFileHash ) - 1,
+                                                         testCHUNK_SIZE ),
+                      eAzureIoTSuccess );
+    will_return_count( AzureIoTPlatform_SaveCheckpoint, eAzureIoTSuccess, 2 );
+    assert_int_equal( AzureIoTADUDownload_Start( &xDownload, &xTransportInterface,
+                                                 ucTestURL, sizeof( ucTestURL ) - 1,
+                                                 ucTestPath, sizeof( ucTestPath ) - 1,
+                                                 sizeof( ucTestFile ) ),
+                      eAzureIoTSuccess );
+    will_return( AzureIoTHTTP_InitNextRequest, eAzureIoTHTTPSuccess );
+    will_return( AzureIoTHTTP_Request, eAzureIoTHTTPSuccess );
+    will_return( AzureIoTPlatform_WriteBlock, eAzureIoTSuccess );
+    assert_int_equal( AzureIoTADUDownload_Process( &xDownload ), eAzureIoTErrorPending );
+
+    /* A new update with another hash starts over and replaces the checkpoint */
+    assert_int_equal( AzureIoTADUDownload_Init( &xDownload, &xTestHTTPClient, &xTestImage,
+                                                ucDownloadBuffer, sizeof( ucDownloadBuffer ),
+                                                testCHUNK_SIZE ),
+                      eAzureIoTSuccess );
+    assert_int_equal( AzureIoTADUDownload_SetCheckpoint( &xDownload,
+                                                         ucTestFileId, sizeof( ucTestFileId ) - 1,
+                                                         ucTestOtherFileHash, sizeof( ucTestOtherFileHash ) - 1,
+                                                         testCHUNK_SIZE ),
+                      eAzureIoTSuccess );
+    will_return( AzureIoTPlatform_SaveCheckpoint, eAzureIoTSuccess );
+    assert_int_equal( AzureIoTADUDownload_Start( &xDownload, &xTransportInterface,
+                                                 ucTestURL, sizeof( ucTestURL ) - 1,
+                                                 ucTestPath, sizeof( ucTestPath ) - 1,
+                                                 sizeof( ucTestFile ) ),
+                      eAzureIoTSuccess );
+    assert_int_equal( AzureIoTADUDownload_GetStats( &xDownload, &xStats ), eAzureIoTSuccess );
+    assert_int_equal( xStats.ulResumeOffset, 0 );
+
+    /* A failure to save a checkpoint does not fail the download */
+    will_return( AzureIoTHTTP_InitNextRequest, eAzureIoTHTTPSuccess );
+    will_return( AzureIoTHTTP_Request, eAzureIoTHTTPSuccess );
+    will_return( AzureIoTPlatform_WriteBlock, eAzureIoTSuccess );
+    will_return( AzureIoTPlatform_SaveCheckpoint, eAzureIoTErrorFailed );
+    assert_int_equal( AzureIoTADUDownload_Process( &xDownload ), eAzureIoTErrorPending );
+    assert_int_equal( lTestHTTPLastRangeStart, 0 );
+}
+/*-----------------------------------------------------------*/
+
+static void testAzureIoTADUDownload_Start_CheckpointOtherSHA256Layout( void ** ppvState )
+{
+    AzureIoTADUDownload_t xDownload;
+    AzureIoTADUDownloadStats_t xStats;
+    uint32_t ulLayout = azureiotcryptoSHA256_CONTEXT_LAYOUT + 1;
+
+    ( void ) ppvState;
+
+    prvSetupTestFile();
+    ulTestCheckpointLength = 0;
+
+    /* Save a checkpoint in the middle of the file */
+    assert_int_equal( AzureIoTADUDownload_Init( &xDownload, &xTestHTTPClient, &xTestImage,
+                                                ucDownloadBuffer, sizeof( ucDownloadBuffer ),
+                                                testCHUNK_SIZE ),
+                      eAzureIoTSuccess );
+    assert_int_equal( AzureIoTADUDownload_SetCheckpoint( &xDownload,
+                                                         ucTestFileId, sizeof( ucTestFileId ) - 1,
+                                                         ucTestFileHash, sizeof( ucTestFileHash ) - 1,
+                                                         testCHUNK_SIZE ),
+                      eAzureIoTSuccess );
+    will_return_count( AzureIoTPlatform_SaveCheckpoint, eAzureIoTSuccess, 2 );
+    assert_int_equal( AzureIoTADUDownload_Start( &xDownload, &xTransportInterface,
+                                                 ucTestURL, sizeof( ucTestURL ) - 1,
+                                                 ucTestPath, sizeof( ucTestPath ) - 1,
+                                                 sizeof( ucTestFile ) ),
+                      eAzureIoTSuccess );
+    will_return( AzureIoTHTTP_InitNextRequest, eAzureIoTHTTPSuccess );
+    will_return( AzureIoTHTTP_Request, eAzureIoTHTTPSuccess );
+    will_return( AzureIoTPlatform_WriteBlock, eAzureIoTSuccess );
+    assert_int_equal( AzureIoTADUDownload_Process( &xDownload ), eAzureIoTErrorPending );
+
+    /* As if saved by a build with another SHA256 context, such as another mbedTLS version */
+    memcpy( &ucTestCheckpoint[ offsetof( AzureIoTADUDownloadCheckpoint_t, ulSHA256Layout ) ], &ulLayout, sizeof( ulLayout ) );
+
+    /* The same file starts over rather than resume with a hash state it cannot read */
+    assert_int_equal( AzureIoTADUDownload_Init( &xDownload, &xTestHTTPClient, &xTestImage,
+                                                ucDownloadBuffer, sizeof( ucDownloadBuffer ),
+                                                testCHUNK_SIZE ),
+                      eAzureIoTSuccess );
+    assert_int_equal( AzureIoTADUDownload_SetCheckpoint( &xDownload,
+                                                         ucTestFileId, sizeof( ucTestFileId ) - 1,
+                                                         ucTestFileHash, sizeof( ucTestFileHash ) - 1,
+                                                         testCHUNK_SIZE ),
+                      eAzureIoTSuccess );
+    will_return( AzureIoTPlatform_SaveCheckpoint, eAzureIoTSuccess );
+    assert_int_equal( AzureIoTADUDownload_Start( &xDownload, &xTransportInterface,
+                                                 ucTestURL, sizeof( ucTestURL ) - 1,
+                                                 ucTestPath, sizeof( ucTestPath ) - 1,
+                                                 sizeof( ucTestFile ) ),
+                      eAzureIoTSuccess );
+    assert_int_equal( AzureIoTADUDownload_GetStats( &xDownload, &xStats ), eAzureIoTSuccess );
+    assert_int_equal( xStats.ulResumeOffset, 0 );
+
+    /* The replaced checkpoint has the layout of this build */
+    memcpy( &ulLayout, &ucTestCheckpoint[ offsetof( AzureIoTADUDownloadCheckpoint_t, ulSHA256Layout ) ], sizeof( ulLayout ) );
+    assert_int_equal( ulLayout, azureiotcryptoSHA256_CONTEXT_LAYOUT );
+}
+/*-----------------------------------------------------------*/
+
+static void testAzureIoTADUDownload_SetAdaptiveChunkSize_Failure( void ** ppvState )
+{
+    AzureIoTADUDownload_t xDownload;
+
+    ( void ) ppvState;
+
+    assert_int_equal( AzureIoTADUDownload_Init( &xDownload, &xTestHTTPClient, &xTestImage,
+                                                ucDownloadBuffer, sizeof( ucDownloadBuffer ),
+                                                testCHUNK_SIZE ),
+                      eAzureIoTSuccess );
+
+    /* Fail when null download is passed */
+    assert_int_equal( AzureIoTADUDownload_SetAdaptiveChunkSize( NULL, testCHUNK_SIZE / 2 ), eAzureIoTErrorInvalidArgument );
+
+    /* Fail when minimum chunk size is zero */
+    assert_int_equal( AzureIoTADUDownload_SetAdaptiveChunkSize( &xDownload, 0 ), eAzureIoTErrorInvalidArgument );
+
+    /* Fail when minimum chunk size is larger than the buffers */
+    assert_int_equal( AzureIoTADUDownload_SetAdaptiveChunkSize( &xDownload, testCHUNK_SIZE * 2 ), eAzureIoTErrorInvalidArgument );
+}
+/*-----------------------------------------------------------*/
+
+static void testAzureIoTADUDownload_Process_AdaptiveFastLink( void ** ppvState )
+{
+    AzureIoTADUDownloadStats_t xFixedStats;
+    AzureIoTADUDownloadStats_t xAdaptiveStats;
+    uint32_t ulFixedMs;
+    uint32_t ulAdaptiveMs;
+
+    ( void ) ppvState;
+
+    /* Wi-Fi like link: 20 ms round trip, 1 MB/s, no loss */
+    prvSetupSimulatedLink( 20, 1000, 0, 5000 );
+
+    ulFixedMs = prvRunSimulatedDownload( testSIM_MIN_CHUNK, 0, &xFixedStats );
+    ulAdaptiveMs = prvRunSimulatedDownload( testSIM_MAX_CHUNK, testSIM_MIN_CHUNK, &xAdaptiveStats );
+
+
+    /* Request overhead dominates, chunks grow to the largest size the buffers allow */
+    assert_int_equal( xAdaptiveStats.ulChunkSize, testSIM_MAX_CHUNK );
+    assert_true( ulAdaptiveMs < ulFixedMs / 2 );
+
+    prvTeardownSimulatedLink();
+}
+/*-----------------------------------------------------------*/
+
+static void testAzureIoTADUDownload_Process_AdaptiveLossyLink( void ** ppvState )
+{
+    AzureIoTADUDownloadStats_t xFixedStats;
+    AzureIoTADUDownloadStats_t xAdaptiveStats;
+    uint32_t ulFixedMs;
+    uint32_t ulAdaptiveMs;
+
+    ( void ) ppvState;
+
+    /* Flaky cellular like link: 200 ms round trip, 10 kB/s, a request fails after 5 s
+     * with a probability of 1 in 10000 per byte */
+    prvSetupSimulatedLink( 200, 10, 100, 5000 );
+
+    ulFixedMs = prvRunSimulatedDownload( testSIM_MAX_CHUNK, 0, &xFixedStats );
+    ulAdaptiveMs = prvRunSimulatedDownload( testSIM_MAX_CHUNK, testSIM_MIN_CHUNK, &xAdaptiveStats );
+
+
+    /* Failures cost more than the request overhead, chunks stay small */
+    assert_true( xAdaptiveStats.ulChunkSize < testSIM_MAX_CHUNK );
+    assert_true( xAdaptiveStats.ulRequestErrorCount < xFixedStats.ulRequestErrorCount );
+    assert_true( ulAdaptiveMs < ulFixedMs );
+
+    prvTeardownSimulatedLink();
+}
+/*-----------------------------------------------------------*/
+
+static void testAzureIoTADUDownload_Process_PatchResumeFromCheckpoint( void ** ppvState )
+{
+    AzureIoTADUDownload_t xDownload;
+    AzureIoTADUDownloadStats_t xStats;
+    AzureIoTADUPatch_t xPatch;
+    AzureIoTCryptoSHA256Context_t xSHA256Context;
+    AzureIoTResult_t xResult;
+    uint8_t ucExpected[ azureiotcryptoSHA256_SIZE ];
+    uint8_t ucSHA256[ azureiotcryptoSHA256_SIZE ];
+    uint32_t ulIndex;
+
+    ( void ) ppvState;
+
+    prvSetupTestPatchFile();
+
+    will_return_always( AzureIoTHTTP_InitNextRequest, eAzureIoTHTTPSuccess );
+    will_return_always( AzureIoTHTTP_Request, eAzureIoTHTTPSuccess );
+    will_return_always( AzureIoTPlatform_ReadActiveBlock, eAzureIoTSuccess );
+    will_return_always( AzureIoTPlatform_WriteBlock, eAzureIoTSuccess );
+    will_return_always( AzureIoTPlatform_SaveCheckpoint, eAzureIoTSuccess );
+
+    prvStartTestPatchDownload( &xDownload, &xPatch );
+
+    /* Connection drops after 5 chunks, the checkpoint is at 4 chunks */
+    for( ulIndex = 0; ulIndex < 5; ulIndex++ )
+    {
+        assert_int_equal( AzureIoTADUDownload_Process( &xDownload ), eAzureIoTErrorPending );
+    }
+
+    /* Restart of the workflow, the patch continues from the checkpoint */
+    prvStartTestPatchDownload( &xDownload, &xPatch );
+    assert_int_equal( AzureIoTADUDownload_GetStats( &xDownload, &xStats ), eAzureIoTSuccess );
+    assert_int_equal( xStats.ulResumeOffset, 4 * testCHUNK_SIZE );
+
+    do
+    {
+        xResult = AzureIoTADUDownload_Process( &xDownload );
+    } while( xResult == eAzureIoTErrorPending );
+
+    assert_int_equal( xResult, eAzureIoTSuccess );
+    assert_memory_equal( ucTestFlash, ucTestPatchImage, sizeof( ucTestPatchImage ) );
+
+    assert_int_equal( AzureIoTCrypto_SHA256Init( &xSHA256Context ), eAzureIoTSuccess );
+    assert_int_equal( AzureIoTCrypto_SHA256Update( &xSHA256Context, ucTestPatchImage, sizeof( ucTestPatchImage ) ), eAzureIoTSuccess );
+    assert_int_equal( AzureIoTCrypto_SHA256Final( &xSHA256Context, ucExpected, sizeof( ucExpected ) ), eAzureIoTSuccess );
+    assert_int_equal( AzureIoTADUPatch_GetSHA256( &xPatch, ucSHA256, sizeof( ucSHA256 ) ), eAzureIoTSuccess );
+    assert_memory_equal( ucSHA256, ucExpected, sizeof( ucExpected ) );
+}
+/*-----------------------------------------------------------*/
+
+static void testAzureIoTADUDownload_SetDecoder_Failure( void ** ppvState )
+{
+    AzureIoTADUDownload_t xDownload;
+    AzureIoTADUHeatshrink_t xHeatshrink;
+    AzureIoTADUDecoderInterface_t xDecoder = { &xHeatshrink, AzureIoTADUHeatshrink_Reset, NULL };
+
+    ( void ) ppvState;
+
+    prvSetupTestDownload( &xDownload );
+
+    /* Fail when null download is passed */
+    assert_int_equal( AzureIoTADUDownload_SetDecoder( NULL, NULL, NULL, 0, eAzureIoTADUDownloadHashDownloaded ),
+                      eAzureIoTErrorInvalidArgument );
+
+    /* Fail when the decoder has no decode function */
+    assert_int_equal( AzureIoTADUDownload_SetDecoder( &xDownload, &xDecoder, ucDecodeBuffer, sizeof( ucDecodeBuffer ),
+                                                      eAzureIoTADUDownloadHashDownloaded ),
+                      eAzureIoTErrorInvalidArgument );
+
+    /* Fail when no buffer is passed */
+    xDecoder.xDecode = AzureIoTADUHeatshrink_Decode;
+    assert_int_equal( AzureIoTADUDownload_SetDecoder( &xDownload, &xDecoder, NULL, sizeof( ucDecodeBuffer ),
+                                                      eAzureIoTADUDownloadHashDownloaded ),
+                      eAzureIoTErrorInvalidArgument );
+
+    /* Removing the decoder needs no buffer */
+    assert_int_equal( AzureIoTADUDownload_SetDecoder( &xDownload, NULL, NULL, 0, eAzureIoTADUDownloadHashDownloaded ),
+                      eAzureIoTSuccess );
+}
+/*-----------------------------------------------------------*/
+
+static void testAzureIoTADUDownload_Process_Decoder( void ** ppvState )
+{
+    uint8_t ucSHA256[ azureiotcryptoSHA256_SIZE ];
+    uint8_t ucExpected[ azureiotcryptoSHA256_SIZE ];
+
+    ( void ) ppvState;
+
+    will_return_always( AzureIoTHTTP_InitNextRequest, eAzureIoTHTTPSuccess );
+    will_return_always( AzureIoTHTTP_Request, eAzureIoTHTTPSuccess );
+    will_return_always( AzureIoTPlatform_WriteBlock, eAzureIoTSuccess );
+
+    /* Hash of the decompressed image */
+    prvRunTestDecoderDownload( eAzureIoTADUDownloadHashDecoded, ucSHA256 );
+    prvCalculateSHA256( ucTestDecodedFile, testDECODED_SIZE, ucExpected );
+    assert_memory_equal( ucSHA256, ucExpected, sizeof( ucExpected ) );
+
+    /* Hash of the compressed file */
+    prvRunTestDecoderDownload( eAzureIoTADUDownloadHashDownloaded, ucSHA256 );
+    prvCalculateSHA256( ucTestEncodedFile, ulTestEncodedFileLength, ucExpected );
+    assert_memory_equal( ucSHA256, ucExpected, sizeof( ucExpected ) );
+}
+/*-----------------------------------------------------------*/
+
+static void testAzureIoTADUDownload_SetStreaming_Failure( void ** ppvState )
+{
+    ( void ) ppvState;
+
+    /* Fail when null download is passed */
+    assert_int_equal( AzureIoTADUDownload_SetStreaming( NULL, testSTREAM_CHUNK_SIZE ),
+                      eAzureIoTErrorInvalidArgument );
+}
+/*-----------------------------------------------------------*/
+
+static void testAzureIoTADUDownload_Process_Streaming( void ** ppvState )
+{
+    AzureIoTADUDownload_t xDownload;
+    AzureIoTADUDownloadStats_t xStats;
+    AzureIoTResult_t xResult;
+
+    ( void ) ppvState;
+
+    will_return_always( AzureIoTHTTP_InitNextRequest, eAzureIoTHTTPSuccess );
+    will_return_always( AzureIoTHTTP_RequestStream, eAzureIoTHTTPSuccess );
+    will_return_always( AzureIoTPlatform_WriteBlock, eAzureIoTSuccess );
+
+    prvSetupTestDownload( &xDownload );
+    memset( ucTestFlash, 0xFF, sizeof( ucTestFile ) );
+    ulTestHTTPStreamFragmentCount = 0;
+
+    /* Chunks larger than the buffer holds */
+    assert_int_equal( AzureIoTADUDownload_SetStreaming( &xDownload, testSTREAM_CHUNK_SIZE ), eAzureIoTSuccess );
+
+    do
+    {
+        xResult = AzureIoTADUDownload_Process( &xDownload );
+    } while( xResult == eAzureIoTErrorPending );
+
+    assert_int_equal( xResult, eAzureIoTSuccess );
+    assert_memory_equal( ucTestFlash, ucTestFile, sizeof( ucTestFile ) );
+    prvAssertTestFileSHA256( &xDownload );
+
+    assert_int_equal( AzureIoTADUDownload_GetStats( &xDownload, &xStats ), eAzureIoTSuccess );
+    assert_int_equal( xStats.ulRequestCount, ( sizeof( ucTestFile ) + testSTREAM_CHUNK_SIZE - 1 ) / testSTREAM_CHUNK_SIZE );
+    assert_int_equal( xStats.ulBytesDownloaded, sizeof( ucTestFile ) );
+    assert_int_equal( xStats.ulBytesWritten, sizeof( ucTestFile ) );
+
+    /* Each range arrived in more than one fragment */
+    assert_true( ulTestHTTPStreamFragmentCount > xStats.ulRequestCount );
+}
+/*-----------------------------------------------------------*/
+
+static void testAzureIoTADUDownload_Process_StreamingFailure( void ** ppvState )
+{
+    AzureIoTADUDownload_t xDownload;
+    AzureIoTADUDownloadStats_t xStats;
+    AzureIoTResult_t xResult;
+
+    ( void ) ppvState;
+
+    will_return_always( AzureIoTHTTP_InitNextRequest, eAzureIoTHTTPSuccess );
+    will_return_always( AzureIoTPlatform_WriteBlock, eAzureIoTSuccess );
+
+    prvSetupTestDownload( &xDownload );
+    memset( ucTestFlash, 0xFF, sizeof( ucTestFile ) );
+    assert_int_equal( AzureIoTADUDownload_SetStreaming( &xDownload, testSTREAM_CHUNK_SIZE ), eAzureIoTSuccess );
+
+    /* The connection drops after part of the first range */
+    ulTestHTTPStreamFailLength = 1500;
+    will_return( AzureIoTHTTP_RequestStream, eAzureIoTHTTPNetworkError );
+    assert_int_equal( AzureIoTADUDownload_Process( &xDownload ), eAzureIoTErrorFailed );
+    ulTestHTTPStreamFailLength = 0;
+
+    assert_int_equal( AzureIoTADUDownload_GetStats( &xDownload, &xStats ), eAzureIoTSuccess );
+    assert_int_equal( xStats.ulBytesDownloaded, 1500 );
+    assert_int_equal( xStats.ulRequestErrorCount, 1 );
+
+    /* The part received is kept, the next range starts after it */
+    will_return_always( AzureIoTHTTP_RequestStream, eAzureIoTHTTPSuccess );
+
+    do
+    {
+        xResult = AzureIoTADUDownload_Process( &xDownload );
+    } while( xResult == eAzureIoTErrorPending );
+
+    assert_int_equal( xResult, eAzureIoTSuccess );
+    assert_memory_equal( ucTestFlash, ucTestFile, sizeof( ucTestFile ) );
+    prvAssertTestFileSHA256( &xDownload );
+
+    assert_int_equal( AzureIoTADUDownload_GetStats( &xDownload, &xStats ), eAzureIoTSuccess );
+    assert_int_equal( xStats.ulBytesDownloaded, sizeof( ucTestFile ) );
+}
+/*-----------------------------------------------------------*/
+
+static void prvRunTestStreamingSimulation( bool xPipelining,
+                                           AzureIoTADUDownloadStats_t * pxStats )
+{
+    AzureIoTADUDownload_t xDownload;
+    AzureIoTResult_t xResult;
+    uint32_t ulIndex;
+
+    for( ulIndex = 0; ulIndex < sizeof( ucSimFile ); ulIndex++ )
+    {
+        ucSimFile[ ulIndex ] = ( uint8_t ) ( ulIndex * 13 + 5 );
+    }
+
+    pucTestHTTPFile = ucSimFile;
+    ulTestHTTPFileLength = sizeof( ucSimFile );
+    ulTestHTTPBytesPerMs = 100;
+    ulTestHTTPRoundTripMs = 300;
+    ulTestHTTPTimeoutMs = 0;
+    ulTestHTTPLossPerMillionBytes = 0;
+    ulTestHTTPSimulatedMs = 0;
+    ulTestHTTPPipelinedCount = 0;
+
+    assert_int_equal( AzureIoTADUDownload_Init( &xDownload, &xTestHTTPClient, &xTestImage,
+                                                ucDownloadBuffer, sizeof( ucDownloadBuffer ),
+                                                testCHUNK_SIZE ),
+                      eAzureIoTSuccess );
+    assert_int_equal( AzureIoTADUDownload_SetStreaming( &xDownload, testSIM_MAX_CHUNK ), eAzureIoTSuccess );
+    assert_int_equal( AzureIoTADUDownload_SetPipelining( &xDownload, xPipelining ), eAzureIoTSuccess );
+    assert_int_equal( AzureIoTADUDownload_Start( &xDownload, &xTransportInterface,
+                                                 ucTestURL, sizeof( ucTestURL ) - 1,
+                                                 ucTestPath, sizeof( ucTestPath ) - 1,
+                                                 sizeof( ucSimFile ) ),
+                      eAzureIoTSuccess );
+
+    do
+    {
+        xResult = AzureIoTADUDownload_Process( &xDownload );
+    } while( xResult == eAzureIoTErrorPending );
+
+    assert_int_equal( xResult, eAzureIoTSuccess );
+    assert_memory_equal( ucTestFlash, ucSimFile, sizeof( ucSimFile ) );
+    assert_int_equal( AzureIoTADUDownload_GetStats( &xDownload, pxStats ), eAzureIoTSuccess );
+
+    ulTestHTTPBytesPerMs = 0;
+}
+/*-----------------------------------------------------------*/
+
+static void testAzureIoTADUDownload_SetPipelining_Failure( void ** ppvState )
+{
+    ( void ) ppvState;
+
+    /* Fail when null download is passed */
+    assert_int_equal( AzureIoTADUDownload_SetPipelining( NULL, true ), eAzureIoTErrorInvalidArgument );
+}
+/*-----------------------------------------------------------*/
+
+static int32_t prvTestConnect( void * pvConnectContext,
+                               AzureIoTTransportInterface_t * pxTransport )
+{
+    ( void ) pvConnectContext;
+    ( void ) pxTransport;
+
+    return 0;
+}
+/*-----------------------------------------------------------*/
+
+static void testAzureIoTADUDownload_SetConnect_Success( void ** ppvState )
+{
+    AzureIoTADUDownload_t xDownload;
+    uint32_t ulContext;
+
+    ( void ) ppvState;
+
+    prvSetupTestFile();
+
+    /* The connection of each download starts without a reconnect function */
+    assert_int_equal( AzureIoTADUDownload_Init( &xDownload, &xTestHTTPClient, &xTestImage,
+                                                ucDownloadBuffer, sizeof( ucDownloadBuffer ),
+                                                testCHUNK_SIZE ),
+                      eAzureIoTSuccess );
+    xTestHTTPConnect = prvTestConnect;
+    assert_int_equal( AzureIoTADUDownload_Start( &xDownload, &xTransportInterface,
+                                                 ucTestURL, sizeof( ucTestURL ) - 1,
+                                                 ucTestPath, sizeof( ucTestPath ) - 1,
+                                                 sizeof( ucTestFile ) ),
+                      eAzureIoTSuccess );
+    assert_ptr_equal( pxTestHTTPTransport, &xTransportInterface );
+    assert_null( xTestHTTPConnect );
+
+    /* The reconnect function set after init reaches the HTTP client with the transport */
+    assert_int_equal( AzureIoTADUDownload_Init( &xDownload, &xTestHTTPClient, &xTestImage,
+                                                ucDownloadBuffer, sizeof( ucDownloadBuffer ),
+                                                testCHUNK_SIZE ),
+                      eAzureIoTSuccess );
+    assert_int_equal( AzureIoTADUDownload_SetConnect( &xDownload, prvTestConnect, &ulContext ), eAzureIoTSuccess );
+    pxTestHTTPTransport = NULL;
+    assert_int_equal( AzureIoTADUDownload_Start( &xDownload, &xTransportInterface,
+                                                 ucTestURL, sizeof( ucTestURL ) - 1,
+                                                 ucTestPath, sizeof( ucTestPath ) - 1,
+                                                 sizeof( ucTestFile ) ),
+                      eAzureIoTSuccess );
+    assert_ptr_equal( pxTestHTTPTransport, &xTransportInterface );
+    assert_ptr_equal( xTestHTTPConnect, prvTestConnect );
+    assert_ptr_equal( pvTestHTTPConnectContext, &ulContext );
+
+    /* Fail when null download is passed */
+    assert_int_equal( AzureIoTADUDownload_SetConnect( NULL, prvTestConnect, NULL ), eAzureIoTErrorInvalidArgument );
+}
+/*-----------------------------------------------------------*/
+
+static void testAzureIoTADUDownload_Process_StreamingPipelined( void ** ppvState )
+{
+    AzureIoTADUDownloadStats_t xStats;
+    uint32_t ulSequentialMs;
+
+    ( void ) ppvState;
+
+    will_return_always( AzureIoTHTTP_InitNextRequest, eAzureIoTHTTPSuccess );
+    will_return_always( AzureIoTHTTP_RequestStream, eAzureIoTHTTPSuccess );
+    will_return_always( AzureIoTPlatform_WriteBlock, eAzureIoTSuccess );
+
+    prvRunTestStreamingSimulation( false, &xStats );
+    ulSequentialMs = ulTestHTTPSimulatedMs;
+    assert_int_equal( ulTestHTTPPipelinedCount, 0 );
+
+    /* All requests but the first are sent ahead, and save a round trip each */
+    prvRunTestStreamingSimulation( true, &xStats );
+    assert_int_equal( ulTestHTTPPipelinedCount, xStats.ulRequestCount - 1 );
+    assert_int_equal( ulSequentialMs - ulTestHTTPSimulatedMs, ( xStats.ulRequestCount - 1 ) * 300 );
+}
+/*-----------------------------------------------------------*/
+
+static void testAzureIoTADUDownload_SetFlashWriter_Failure( void ** ppvState )
+{
+    AzureIoTADUFlashWriter_t xWriter;
+
+    ( void ) ppvState;
+
+    /* Fail when null download is passed */
+    assert_int_equal( AzureIoTADUDownload_SetFlashWriter( NULL, &xWriter ), eAzureIoTErrorInvalidArgument );
+}
+/*-----------------------------------------------------------*/
+
+static void testAzureIoTADUDownload_Process_FlashWriter( void ** ppvState )
+{
+    AzureIoTADUDownload_t xDownload;
+    AzureIoTADUFlashWriter_t xWriter;
+    AzureIoTResult_t xResult;
+
+    ( void ) ppvState;
+
+    will_return_always( AzureIoTHTTP_InitNextRequest, eAzureIoTHTTPSuccess );
+    will_return_always( AzureIoTHTTP_RequestStream, eAzureIoTHTTPSuccess );
+    will_return_always( AzureIoTPlatform_WriteBlock, eAzureIoTSuccess );
+
+    prvSetupTestDownload( &xDownload );
+    memset( ucTestFlash, 0xFF, sizeof( ucTestFile ) );
+    ulTestHTTPStreamFragmentCount = 0;
+    ulTestFlashPageSize = 256;
+    ulTestFlashSectorSize = 4096;
+
+    /* Streamed fragments end anywhere in a page */
+    assert_int_equal( AzureIoTADUFlashWriter_Init( &xWriter, &xTestImage, ucFlashWriterBuffer, sizeof( ucFlashWriterBuffer ) ),
+                      eAzureIoTSuccess );
+    assert_int_equal( AzureIoTADUDownload_SetFlashWriter( &xDownload, &xWriter ), eAzureIoTSuccess );
+    assert_int_equal( AzureIoTADUDownload_SetStreaming( &xDownload, testSTREAM_CHUNK_SIZE ), eAzureIoTSuccess );
+
+    do
+    {
+        xResult = AzureIoTADUDownload_Process( &xDownload );
+    } while( xResult == eAzureIoTErrorPending );
+
+    assert_int_equal( xResult, eAzureIoTSuccess );
+    assert_memory_equal( ucTestFlash, ucTestFile, sizeof( ucTestFile ) );
+    prvAssertTestFileSHA256( &xDownload );
+
+    /* Fragments end mid page, but only the tail of the file is written as a partial page */
+    assert_true( ulTestHTTPStreamFragmentCount > 1 );
+    assert_int_equal( ulTestFlashUnalignedWriteCount, 1 );
+    assert_int_equal( ulTestFlashSectorCrossingCount, 0 );
+
+    ulTestFlashPageSize = 1;
+    ulTestFlashSectorSize = 1;
+}
+/*-----------------------------------------------------------*/
+
+static void testAzureIoTADUDownload_SetTimeSlice_Failure( void ** ppvState )
+{
+    ( void ) ppvState;
+
+    /* Fail when null download is passed */
+    assert_int_equal( AzureIoTADUDownload_SetTimeSlice( NULL, testSLICE_MS ), eAzureIoTErrorInvalidArgument );
+}
+/*-----------------------------------------------------------*/
+
+static void testAzureIoTADUDownload_SetPriority_Failure( void ** ppvState )
+{
+    AzureIoTADUDownload_t xDownload;
+
+    ( void ) ppvState;
+
+    assert_int_equal( AzureIoTADUDownload_Init( &xDownload, &xTestHTTPClient, &xTestImage,
+                                                ucDownloadBuffer, sizeof( ucDownloadBuffer ),
+                                                testCHUNK_SIZE ),
+                      eAzureIoTSuccess );
+
+    /* Fail when null download is passed */
+    assert_int_equal( AzureIoTADUDownload_SetPriority( NULL, 1, 0 ), eAzureIoTErrorInvalidArgument );
+
+    /* Fail when the hub client would never be processed */
+    assert_int_equal( AzureIoTADUDownload_SetPriority( &xDownload, 0, 0 ), eAzureIoTErrorInvalidArgument );
+}
+/*-----------------------------------------------------------*/
+
+static void testAzureIoTADUDownload_ProcessLoop_Failure( void ** ppvState )
+{
+    AzureIoTADUDownload_t xDownload;
+
+    ( void ) ppvState;
+
+    prvSetupTestDownload( &xDownload );
+
+    /* Fail when null download is passed */
+    assert_int_equal( AzureIoTADUDownload_ProcessLoop( NULL, &xTestHubClient, 1000 ), eAzureIoTErrorInvalidArgument );
+
+    /* Fail when null hub client is passed */
+    assert_int_equal( AzureIoTADUDownload_ProcessLoop( &xDownload, NULL, 1000 ), eAzureIoTErrorInvalidArgument );
+
+    /* Fail when the hub client fails, before any download step */
+    will_return( AzureIoTMQTT_ProcessLoop, eAzureIoTMQTTRecvFailed );
+    assert_int_equal( AzureIoTADUDownload_ProcessLoop( &xDownload, &xTestHubClient, 1000 ), eAzureIoTErrorHubClientFailed );
+
+    /* Fail when the request cannot be set up, which is not a failed request */
+    will_return( AzureIoTMQTT_ProcessLoop, eAzureIoTMQTTSuccess );
+    will_return( AzureIoTHTTP_InitNextRequest, eAzureIoTHTTPInvalidParameter );
+    assert_int_equal( AzureIoTADUDownload_ProcessLoop( &xDownload, &xTestHubClient, 1000 ), eAzureIoTErrorInitFailed );
+}
+/*-----------------------------------------------------------*/
+
+static void testAzureIoTADUDownload_ProcessLoop_Timeout( void ** ppvState )
+{
+    AzureIoTADUDownload_t xDownload;
+
+    ( void ) ppvState;
+
+    prvSetupTestDownload( &xDownload );
+
+    /* A loop of 0 ms runs a single step */
+    will_return( AzureIoTMQTT_ProcessLoop, eAzureIoTMQTTSuccess );
+    will_return( AzureIoTHTTP_InitNextRequest, eAzureIoTHTTPSuccess );
+    will_return( AzureIoTHTTP_Request, eAzureIoTHTTPSuccess );
+    will_return( AzureIoTPlatform_WriteBlock, eAzureIoTSuccess );
+    assert_int_equal( AzureIoTADUDownload_ProcessLoop( &xDownload, &xTestHubClient, 0 ), eAzureIoTErrorPending );
+    assert_memory_equal( ucTestFlash, ucTestFile, testCHUNK_SIZE );
+
+    /* A failed range request is requested again after the retry delay, spent in the hub client */
+    will_return( AzureIoTMQTT_ProcessLoop, eAzureIoTMQTTSuccess );
+    will_return( AzureIoTHTTP_InitNextRequest, eAzureIoTHTTPSuccess );
+    will_return( AzureIoTHTTP_Request, eAzureIoTHTTPNetworkError );
+    assert_int_equal( AzureIoTADUDownload_ProcessLoop( &xDownload, &xTestHubClient, 0 ), eAzureIoTErrorPending );
+
+    will_return( AzureIoTMQTT_ProcessLoop, eAzureIoTMQTTSuccess );
+    assert_int_equal( AzureIoTADUDownload_ProcessLoop( &xDownload, &xTestHubClient, 0 ), eAzureIoTErrorPending );
+
+    xTestTickCount += azureiotconfigADU_DOWNLOAD_RETRY_DELAY_MS;
+    will_return( AzureIoTMQTT_ProcessLoop, eAzureIoTMQTTSuccess );
+    will_return( AzureIoTHTTP_InitNextRequest, eAzureIoTHTTPSuccess );
+    will_return( AzureIoTHTTP_Request, eAzureIoTHTTPSuccess );
+    will_return( AzureIoTPlatform_WriteBlock, eAzureIoTSuccess );
+    assert_int_equal( AzureIoTADUDownload_ProcessLoop( &xDownload, &xTestHubClient, 0 ), eAzureIoTErrorPending );
+    assert_int_equal( lTestHTTPLastRangeStart, testCHUNK_SIZE );
+    assert_memory_equal( ucTestFlash, ucTestFile, 2 * testCHUNK_SIZE );
+
+    /* A failed write ends the loop */
+    will_return( AzureIoTMQTT_ProcessLoop, eAzureIoTMQTTSuccess );
+    will_return( AzureIoTHTTP_InitNextRequest, eAzureIoTHTTPSuccess );
+    will_return( AzureIoTHTTP_Request, eAzureIoTHTTPSuccess );
+    will_return( AzureIoTPlatform_WriteBlock, eAzureIoTErrorFailed );
+    assert_int_equal( AzureIoTADUDownload_ProcessLoop( &xDownload, &xTestHubClient, 1000 ), eAzureIoTErrorFailed );
+}
+/*-----------------------------------------------------------*/
+
+static void testAzureIoTADUDownload_ProcessLoop_RetryLimit( void ** ppvState )
+{
+    AzureIoTADUDownload_t xDownload;
+    AzureIoTADUDownloadStats_t xStats;
+    uint32_t ulStartMs;
+    uint32_t ulElapsedMs;
+
+    ( void ) ppvState;
+
+    prvSetupTestDownload( &xDownload );
+    ulTestHubProcessCount = 0;
+    pxTestMQTTProcessLoopHook = prvTestHubProcessLoop;
+    will_return_always( AzureIoTMQTT_ProcessLoop, eAzureIoTMQTTSuccess );
+
+    /* Each failure waits twice as long as the previous one, until the loop gives up */
+    will_return_count( AzureIoTHTTP_InitNextRequest, eAzureIoTHTTPSuccess, azureiotconfigADU_DOWNLOAD_RETRY_MAX );
+    will_return_count( AzureIoTHTTP_Request, eAzureIoTHTTPNetworkError, azureiotconfigADU_DOWNLOAD_RETRY_MAX );
+    ulStartMs = ( uint32_t ) xTestTickCount;
+    assert_int_equal( AzureIoTADUDownload_ProcessLoop( &xDownload, &xTestHubClient, UINT32_MAX ), eAzureIoTErrorFailed );
+    ulElapsedMs = ( uint32_t ) xTestTickCount - ulStartMs;
+
+    assert_int_equal( AzureIoTADUDownload_GetStats( &xDownload, &xStats ), eAzureIoTSuccess );
+    assert_int_equal( xStats.ulRequestErrorCount, azureiotconfigADU_DOWNLOAD_RETRY_MAX );
+    assert_true( ulElapsedMs >= azureiotconfigADU_DOWNLOAD_RETRY_DELAY_MS * ( ( 1U << ( azureiotconfigADU_DOWNLOAD_RETRY_MAX - 1 ) ) - 1 ) );
+    assert_true( ulTestHubProcessCount >= 2 * azureiotconfigADU_DOWNLOAD_RETRY_MAX - 1 );
+
+    /* A successful request resets the count */
+    will_return_count( AzureIoTHTTP_InitNextRequest, eAzureIoTHTTPSuccess, 2 * azureiotconfigADU_DOWNLOAD_RETRY_MAX );
+    will_return_count( AzureIoTHTTP_Request, eAzureIoTHTTPNetworkError, azureiotconfigADU_DOWNLOAD_RETRY_MAX - 1 );
+    will_return( AzureIoTHTTP_Request, eAzureIoTHTTPSuccess );
+    will_return( AzureIoTPlatform_WriteBlock, eAzureIoTSuccess );
+    will_return_count( AzureIoTHTTP_Request, eAzureIoTHTTPNetworkError, azureiotconfigADU_DOWNLOAD_RETRY_MAX );
+    assert_int_equal( AzureIoTADUDownload_ProcessLoop( &xDownload, &xTestHubClient, UINT32_MAX ), eAzureIoTErrorFailed );
+    assert_memory_equal( ucTestFlash, ucTestFile, testCHUNK_SIZE );
+
+    assert_int_equal( AzureIoTADUDownload_GetStats( &xDownload, &xStats ), eAzureIoTSuccess );
+    assert_int_equal( xStats.ulRequestErrorCount, 3 * azureiotconfigADU_DOWNLOAD_RETRY_MAX - 1 );
+
+    pxTestMQTTProcessLoopHook = NULL;
+}
+/*-----------------------------------------------------------*/
+
+static void testAzureIoTADUDownload_ProcessLoop_CommandLatency( void ** ppvState )
+{
+    AzureIoTADUDownloadStats_t xBlockingStats;
+    AzureIoTADUDownloadStats_t xSlicedStats;
+    uint32_t ulBlockingMs;
+    uint32_t ulSlicedMs;
+
+    ( void ) ppvState;
+
+    /* Cellular like link: 100 ms round trip, 20 kB/s */
+    prvSetupSimulatedLink( 100, 20, 0, 5000 );
+
+    /* The hub client is only processed once the blocking download is over */
+    ulBlockingMs = prvRunSimulatedDownload( testSIM_MAX_CHUNK, 0, &xBlockingStats );
+
+    ulSlicedMs = prvRunSlicedDownload( testSLICE_MS, 1, 0, &xSlicedStats );
+
+    /* A command waits at most about a slice instead of the whole download,
+     * and keep-alives are sent in time */
+    assert_true( ulBlockingMs > testKEEP_ALIVE_MS );
+    assert_true( ulTestHubMaxGapMs < 2 * testSLICE_MS );
+    assert_true( ulTestHubMaxGapMs < testKEEP_ALIVE_MS / 2 );
+
+    /* The requests shrink to fit the slice, at the cost of more round trips */
+    assert_true( xSlicedStats.ulRequestCount > xBlockingStats.ulRequestCount );
+    assert_true( ulSlicedMs < 2 * ulBlockingMs );
+
+    prvTeardownSimulatedLink();
+}
+/*-----------------------------------------------------------*/
+
+static void testAzureIoTADUDownload_ProcessLoop_Priority( void ** ppvState )
+{
+    AzureIoTADUDownloadStats_t xStats;
+    uint32_t ulHubPriorityCount;
+    uint32_t ulHubPriorityMaxGapMs;
+    uint32_t ulHubPriorityMs;
+    uint32_t ulDownloadPriorityMs;
+
+    ( void ) ppvState;
+
+    prvSetupSimulatedLink( 100, 20, 0, 5000 );
+
+    /* The hub client waits 20 ms for packets after every step */
+    ulHubPriorityMs = prvRunSlicedDownload( testSLICE_MS, 1, 20, &xStats );
+    ulHubPriorityCount = ulTestHubProcessCount;
+    ulHubPriorityMaxGapMs = ulTestHubMaxGapMs;
+
+    /* The hub client waits 20 ms for packets every 4 steps */
+    ulDownloadPriorityMs = prvRunSlicedDownload( testSLICE_MS, 4, 20, &xStats );
+
+    /* The download gets more of the task, and commands wait longer */
+    assert_true( ulTestHubProcessCount < ulHubPriorityCount / 2 );
+    assert_true( ulDownloadPriorityMs < ulHubPriorityMs );
+    assert_true( ulTestHubMaxGapMs > ulHubPriorityMaxGapMs );
+    assert_true( ulTestHubMaxGapMs < 4 * 2 * testSLICE_MS );
+
+    prvTeardownSimulatedLink();
+}
+/*-----------------------------------------------------------*/
+
+static void testAzureIoTADUDownload_ProcessLoop_LossyLink( void ** ppvState )
+{
+    AzureIoTADUDownloadStats_t xStats;
+
+    ( void ) ppvState;
+
+    /* Failed requests are retried within the loop, which keeps processing the hub client */
+    prvSetupSimulatedLink( 100, 20, 100, 1000 );
+
+    ( void ) prvRunSlicedDownload( testSLICE_MS, 1, 0, &xStats );
+
+    assert_true( xStats.ulRequestErrorCount > 0 );
+    assert_true( ulTestHubMaxGapMs <= 1000 + 2 * testSLICE_MS );
+
+    prvTeardownSimulatedLink();
+}
+/*-----------------------------------------------------------*/
+
+uint32_t ulGetAllTests()
+{
+    const struct CMUnitTest tests[] =
+    {
+        cmocka_unit_test( testAzureIoTADUDownload_Init_Failure ),
+        cmocka_unit_test( testAzureIoTADUDownload_Start_Failure ),
+        cmocka_unit_test( testAzureIoTADUDownload_Process_Success ),
+        cmocka_unit_test( testAzureIoTADUDownload_FetchCommit_DoubleBuffer ),
+        cmocka_unit_test( testAzureIoTADUDownload_Process_ShortResponse ),
+        cmocka_unit_test( testAzureIoTADUDownload_Process_Failure ),
+        cmocka_unit_test( testAzureIoTADUDownload_SetCheckpoint_Failure ),
+        cmocka_unit_test( testAzureIoTADUDownload_Process_ResumeFromCheckpoint ),
+        cmocka_unit_test( testAzureIoTADUDownload_Start_CheckpointOtherFile ),
+        cmocka_unit_test( testAzureIoTADUDownload_Start_CheckpointOtherSHA256Layout ),
+        cmocka_unit_test( testAzureIoTADUDownload_SetAdaptiveChunkSize_Failure ),
+        cmocka_unit_test( testAzureIoTADUDownload_Process_AdaptiveFastLink ),
+        cmocka_unit_test( testAzureIoTADUDownload_Process_AdaptiveLossyLink ),
+        cmocka_unit_test( testAzureIoTADUDownload_Process_PatchResumeFromCheckpoint ),
+        cmocka_unit_test( testAzureIoTADUDownload_SetDecoder_Failure ),
+        cmocka_unit_test( testAzureIoTADUDownload_Process_Decoder ),
+        cmocka_unit_test( testAzureIoTADUDownload_SetStreaming_Failure ),
+        cmocka_unit_test( testAzureIoTADUDownload_Process_Streaming ),
+        cmocka_unit_test( testAzureIoTADUDownload_Process_StreamingFailure ),
+        cmocka_unit_test( testAzureIoTADUDownload_SetPipelining_Failure ),
+        cmocka_unit_test( testAzureIoTADUDownload_SetConnect_Success ),
+        cmocka_unit_test( testAzureIoTADUDownload_Process_StreamingPipelined ),
+        cmocka_unit_test( testAzureIoTADUDownload_SetFlashWriter_Failure ),
+        cmocka_unit_test( testAzureIoTADUDownload_Process_FlashWriter ),
+        cmocka_unit_test( testAzureIoTADUDownload_SetTimeSlice_Failure ),
+        cmocka_unit_test( testAzureIoTADUDownload_SetPriority_Failure ),
+        cmocka_unit_test( testAzureIoTADUDownload_ProcessLoop_Failure ),
+        cmocka_unit_test( testAzureIoTADUDownload_ProcessLoop_Timeout ),
+        cmocka_unit_test( testAzureIoTADUDownload_ProcessLoop_RetryLimit ),
+        cmocka_unit_test( testAzureIoTADUDownload_ProcessLoop_CommandLatency ),
+        cmocka_unit_test( testAzureIoTADUDownload_ProcessLoop_Priority ),
+        cmocka_unit_test( testAzureIoTADUDownload_ProcessLoop_LossyLink )
+    };
+
+    return ( uint32_t ) cmocka_run_group_tests_name( "azure_iot_adu_download_ut", tests, NULL, NULL );
+}
+/*-----------------------------------------------------------*/
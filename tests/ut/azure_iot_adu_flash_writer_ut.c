@@ -0,0 +1,305 @@
+/* Copyright (c) Microsoft Corporation.
+ * Licensed under the MIT License. */
+
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <setjmp.h>
+
+#include <cmocka.h>
+
+#include "azure_iot_adu_flash_writer.h"
+/*-----------------------------------------------------------*/
+
+#define testPAGE_SIZE      ( 256 )
+#define testSECTOR_SIZE    ( 4096 )
+#define testDATA_SIZE      ( 10000 )
+/*-----------------------------------------------------------*/
+
+extern uint8_t ucTestFlash[];
+extern uint32_t ulTestFlashWriteCount;
+extern uint32_t ulTestFlashPageSize;
+extern uint32_t ulTestFlashSectorSize;
+extern uint32_t ulTestFlashUnalignedWriteCount;
+extern uint32_t ulTestFlashSectorCrossingCount;
+
+static AzureADUImage_t xTestImage;
+static uint8_t ucTestBuffer[ testPAGE_SIZE * 4 ];
+static uint8_t ucTestData[ testDATA_SIZE ];
+/*-----------------------------------------------------------*/
+
+uint32_t ulGetAllTests();
+/*-----------------------------------------------------------*/
+
+static void prvSetupFlash( uint32_t ulPageSize,
+                           uint32_t ulSectorSize )
+{
+    uint32_t ulIndex;
+
+    ulTestFlashPageSize = ulPageSize;
+    ulTestFlashSectorSize = ulSectorSize;
+    ulTestFlashWriteCount = 0;
+    ulTestFlashUnalignedWriteCount = 0;
+    ulTestFlashSectorCrossingCount = 0;
+    memset( ucTestFlash, 0xFF, testDATA_SIZE * 2 );
+
+    for( ulIndex = 0; ulIndex < testDATA_SIZE; ulIndex++ )
+    {
+        ucTestData[ ulIndex ] = ( uint8_t ) ( ulIndex * 7 + ( ulIndex >> 8 ) );
+    }
+}
+/*-----------------------------------------------------------*/
+
+/* Write ucTestData at ulOffset, in pieces of the sizes in pulPieces, in turn, and return the number of pieces */
+static uint32_t prvWritePieces( AzureIoTADUFlashWriter_t * pxWriter,
+                            uint32_t ulOffset,
+                            const uint32_t * pulPieces,
+                            uint32_t ulPieceCount )
+{
+    uint32_t ulDone = 0;
+    uint32_t ulLength;
+    uint32_t ulIndex = 0;
+
+    while( ulDone < testDATA_SIZE )
+    {
+        ulLength = pulPieces[ ulIndex++ % ulPieceCount ];
+
+        if( ulLength > ( testDATA_SIZE - ulDone ) )
+        {
+            ulLength = testDATA_SIZE - ulDone;
+        }
+
+        assert_int_equal( AzureIoTADUFlashWriter_Write( pxWriter, ulOffset + ulDone, ucTestData + ulDone, ulLength ),
+                          eAzureIoTSuccess );
+        ulDone += ulLength;
+    }
+
+    assert_int_equal( AzureIoTADUFlashWriter_Flush( pxWriter ), eAzureIoTSuccess );
+
+    return ulIndex;
+}
+/*-----------------------------------------------------------*/
+
+static void testAzureIoTADUFlashWriter_Init_Failure( void ** ppvState )
+{
+    AzureIoTADUFlashWriter_t xWriter;
+
+    ( void ) ppvState;
+
+    prvSetupFlash( testPAGE_SIZE, testSECTOR_SIZE );
+
+    /* Fail when null writer is passed */
+    assert_int_equal( AzureIoTADUFlashWriter_Init( NULL, &xTestImage, ucTestBuffer, sizeof( ucTestBuffer ) ),
+                      eAzureIoTErrorInvalidArgument );
+
+    /* Fail when null image is passed */
+    assert_int_equal( AzureIoTADUFlashWriter_Init( &xWriter, NULL, ucTestBuffer, sizeof( ucTestBuffer ) ),
+                      eAzureIoTErrorInvalidArgument );
+
+    /* Fail when null buffer is passed */
+    assert_int_equal( AzureIoTADUFlashWriter_Init( &xWriter, &xTestImage, NULL, sizeof( ucTestBuffer ) ),
+                      eAzureIoTErrorInvalidArgument );
+
+    /* Fail when the buffer does not hold a page */
+    assert_int_equal( AzureIoTADUFlashWriter_Init( &xWriter, &xTestImage, ucTestBuffer, testPAGE_SIZE - 1 ),
+                      eAzureIoTErrorInvalidArgument );
+}
+/*-----------------------------------------------------------*/
+
+static void testAzureIoTADUFlashWriter_Write_Failure( void ** ppvState )
+{
+    AzureIoTADUFlashWriter_t xWriter;
+
+    ( void ) ppvState;
+
+    prvSetupFlash( testPAGE_SIZE, testSECTOR_SIZE );
+
+    assert_int_equal( AzureIoTADUFlashWriter_Init( &xWriter, &xTestImage, ucTestBuffer, sizeof( ucTestBuffer ) ),
+                      eAzureIoTSuccess );
+
+    /* Fail when null writer is passed */
+    assert_int_equal( AzureIoTADUFlashWriter_Write( NULL, 0, ucTestData, 1 ), eAzureIoTErrorInvalidArgument );
+    assert_int_equal( AzureIoTADUFlashWriter_Flush( NULL ), eAzureIoTErrorInvalidArgument );
+
+    /* Fail when null data is passed */
+    assert_int_equal( AzureIoTADUFlashWriter_Write( &xWriter, 0, NULL, 1 ), eAzureIoTErrorInvalidArgument );
+
+    /* Fail when the flash write fails, and keep the bytes to retry */
+    assert_int_equal( AzureIoTADUFlashWriter_Write( &xWriter, 0, ucTestData, 10 ), eAzureIoTSuccess );
+    will_return( AzureIoTPlatform_WriteBlock, eAzureIoTErrorFailed );
+    assert_int_equal( AzureIoTADUFlashWriter_Flush( &xWriter ), eAzureIoTErrorFailed );
+
+    will_return( AzureIoTPlatform_WriteBlock, eAzureIoTSuccess );
+    assert_int_equal( AzureIoTADUFlashWriter_Flush( &xWriter ), eAzureIoTSuccess );
+    assert_memory_equal( ucTestFlash, ucTestData, 10 );
+    assert_int_equal( AzureIoTADUFlashWriter_GetWriteCount( &xWriter ), 1 );
+}
+/*-----------------------------------------------------------*/
+
+static void testAzureIoTADUFlashWriter_Write_Coalesced( void ** ppvState )
+{
+    AzureIoTADUFlashWriter_t xWriter;
+    const uint32_t ulPieces[] = { 1, 77, 300, 5, 1000, 13 };
+    uint32_t ulPieceCount;
+
+    ( void ) ppvState;
+
+    prvSetupFlash( testPAGE_SIZE, testSECTOR_SIZE );
+    will_return_always( AzureIoTPlatform_WriteBlock, eAzureIoTSuccess );
+
+    assert_int_equal( AzureIoTADUFlashWriter_Init( &xWriter, &xTestImage, ucTestBuffer, sizeof( ucTestBuffer ) ),
+                      eAzureIoTSuccess );
+    ulPieceCount = prvWritePieces( &xWriter, 0, ulPieces, sizeof( ulPieces ) / sizeof( ulPieces[ 0 ] ) );
+
+    assert_memory_equal( ucTestFlash, ucTestData, testDATA_SIZE );
+
+    /* Only the tail is a partial page, and no write crosses a sector */
+    assert_int_equal( ulTestFlashUnalignedWriteCount, 1 );
+    assert_int_equal( ulTestFlashSectorCrossingCount, 0 );
+
+    /* Far fewer writes than pieces */
+    assert_int_equal( AzureIoTADUFlashWriter_GetWriteCount( &xWriter ), ulTestFlashWriteCount );
+    assert_true( ( ulTestFlashWriteCount * 2 ) < ulPieceCount );
+}
+/*-----------------------------------------------------------*/
+
+static void testAzureIoTADUFlashWriter_Write_UnalignedStart( void ** ppvState )
+{
+    AzureIoTADUFlashWriter_t xWriter;
+    const uint32_t ulPieces[] = { 333 };
+
+    ( void ) ppvState;
+
+    prvSetupFlash( testPAGE_SIZE, testSECTOR_SIZE );
+    will_return_always( AzureIoTPlatform_WriteBlock, eAzureIoTSuccess );
+
+    assert_int_equal( AzureIoTADUFlashWriter_Init( &xWriter, &xTestImage, ucTestBuffer, sizeof( ucTestBuffer ) ),
+                      eAzureIoTSuccess );
+    ( void ) prvWritePieces( &xWriter, 1000, ulPieces, 1 );
+
+    assert_memory_equal( ucTestFlash + 1000, ucTestData, testDATA_SIZE );
+
+    /* Nothing before the start is overwritten */
+    assert_int_equal( ucTestFlash[ 999 ], 0xFF );
+
+    /* Only the head, up to the next page, and the tail are partial pages */
+    assert_int_equal( ulTestFlashUnalignedWriteCount, 2 );
+    assert_int_equal( ulTestFlashSectorCrossingCount, 0 );
+}
+/*-----------------------------------------------------------*/
+
+static void testAzureIoTADUFlashWriter_Write_Direct( void ** ppvState )
+{
+    AzureIoTADUFlashWriter_t xWriter;
+    const uint32_t ulPieces[] = { testSECTOR_SIZE / 2 };
+
+    ( void ) ppvState;
+
+    prvSetupFlash( testPAGE_SIZE, testSECTOR_SIZE );
+    will_return_always( AzureIoTPlatform_WriteBlock, eAzureIoTSuccess );
+
+    /* Aligned blocks larger than the buffer are written as they come */
+    assert_int_equal( AzureIoTADUFlashWriter_Init( &xWriter, &xTestImage, ucTestBuffer, testPAGE_SIZE ),
+                      eAzureIoTSuccess );
+    ( void ) prvWritePieces( &xWriter, 0, ulPieces, 1 );
+
+    assert_memory_equal( ucTestFlash, ucTestData, testDATA_SIZE );
+    /* The last piece is 7 whole pages, written directly, and a tail */
+    assert_int_equal( ulTestFlashWriteCount, ( testDATA_SIZE / ( testSECTOR_SIZE / 2 ) ) + 2 );
+    assert_int_equal( ulTestFlashUnalignedWriteCount, 1 );
+    assert_int_equal( ulTestFlashSectorCrossingCount, 0 );
+}
+/*-----------------------------------------------------------*/
+
+static void testAzureIoTADUFlashWriter_Write_NonContiguous( void ** ppvState )
+{
+    AzureIoTADUFlashWriter_t xWriter;
+
+    ( void ) ppvState;
+
+    prvSetupFlash( testPAGE_SIZE, testSECTOR_SIZE );
+    will_return_always( AzureIoTPlatform_WriteBlock, eAzureIoTSuccess );
+
+    assert_int_equal( AzureIoTADUFlashWriter_Init( &xWriter, &xTestImage, ucTestBuffer, sizeof( ucTestBuffer ) ),
+                      eAzureIoTSuccess );
+
+    /* A block elsewhere flushes the bytes gathered so far first */
+    assert_int_equal( AzureIoTADUFlashWriter_Write( &xWriter, 0, ucTestData, 100 ), eAzureIoTSuccess );
+    assert_int_equal( ulTestFlashWriteCount, 0 );
+    assert_int_equal( AzureIoTADUFlashWriter_Write( &xWriter, 5000, ucTestData + 5000, 100 ), eAzureIoTSuccess );
+    assert_int_equal( ulTestFlashWriteCount, 1 );
+    assert_int_equal( AzureIoTADUFlashWriter_Flush( &xWriter ), eAzureIoTSuccess );
+    assert_int_equal( ulTestFlashWriteCount, 2 );
+
+    assert_memory_equal( ucTestFlash, ucTestData, 100 );
+    assert_memory_equal( ucTestFlash + 5000, ucTestData + 5000, 100 );
+    assert_int_equal( ucTestFlash[ 100 ], 0xFF );
+}
+/*-----------------------------------------------------------*/
+
+static void testAzureIoTADUFlashWriter_Reset( void ** ppvState )
+{
+    AzureIoTADUFlashWriter_t xWriter;
+
+    ( void ) ppvState;
+
+    prvSetupFlash( testPAGE_SIZE, testSECTOR_SIZE );
+    will_return_always( AzureIoTPlatform_WriteBlock, eAzureIoTSuccess );
+
+    /* Fail when null writer is passed */
+    assert_int_equal( AzureIoTADUFlashWriter_Reset( NULL ), eAzureIoTErrorInvalidArgument );
+
+    assert_int_equal( AzureIoTADUFlashWriter_Init( &xWriter, &xTestImage, ucTestBuffer, sizeof( ucTestBuffer ) ),
+                      eAzureIoTSuccess );
+
+    /* The bytes gathered before the reset are never written */
+    assert_int_equal( AzureIoTADUFlashWriter_Write( &xWriter, 0, ucTestData, 100 ), eAzureIoTSuccess );
+    assert_int_equal( AzureIoTADUFlashWriter_Reset( &xWriter ), eAzureIoTSuccess );
+    assert_int_equal( AzureIoTADUFlashWriter_Write( &xWriter, 200, ucTestData + 200, 100 ), eAzureIoTSuccess );
+    assert_int_equal( AzureIoTADUFlashWriter_Flush( &xWriter ), eAzureIoTSuccess );
+    assert_int_equal( ulTestFlashWriteCount, 1 );
+
+    assert_int_equal( ucTestFlash[ 0 ], 0xFF );
+    assert_memory_equal( ucTestFlash + 200, ucTestData + 200, 100 );
+}
+/*-----------------------------------------------------------*/
+
+static void testAzureIoTADUFlashWriter_Write_BytePages( void ** ppvState )
+{
+    AzureIoTADUFlashWriter_t xWriter;
+    const uint32_t ulPieces[] = { 10, 3000 };
+
+    ( void ) ppvState;
+
+    /* Flash without page or sector constraints, the buffer is used as is */
+    prvSetupFlash( 1, 1 );
+    will_return_always( AzureIoTPlatform_WriteBlock, eAzureIoTSuccess );
+
+    assert_int_equal( AzureIoTADUFlashWriter_Init( &xWriter, &xTestImage, ucTestBuffer, 1000 ), eAzureIoTSuccess );
+    ( void ) prvWritePieces( &xWriter, 0, ulPieces, 2 );
+
+    assert_memory_equal( ucTestFlash, ucTestData, testDATA_SIZE );
+    assert_int_equal( ulTestFlashUnalignedWriteCount, 0 );
+}
+/*-----------------------------------------------------------*/
+
+uint32_t ulGetAllTests()
+{
+    const struct CMUnitTest tests[] =
+    {
+        cmocka_unit_test( testAzureIoTADUFlashWriter_Init_Failure ),
+        cmocka_unit_test( testAzureIoTADUFlashWriter_Write_Failure ),
+        cmocka_unit_test( testAzureIoTADUFlashWriter_Write_Coalesced ),
+        cmocka_unit_test( testAzureIoTADUFlashWriter_Write_UnalignedStart ),
+        cmocka_unit_test( testAzureIoTADUFlashWriter_Write_Direct ),
+        cmocka_unit_test( testAzureIoTADUFlashWriter_Write_NonContiguous ),
+        cmocka_unit_test( testAzureIoTADUFlashWriter_Reset ),
+        cmocka_unit_test( testAzureIoTADUFlashWriter_Write_BytePages )
+    };
+
+    return ( uint32_t ) cmocka_run_group_tests_name( "azure_iot_adu_flash_writer_ut", tests, NULL, NULL );
+}
+/*-----------------------------------------------------------*/
@@ -0,0 +1,274 @@
+/* Copyright (c) Microsoft Corporation.
+ * Licensed under the MIT License. */
+
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <setjmp.h>
+
+#include <cmocka.h>
+
+#include "azure_iot_adu_heatshrink.h"
+/*-----------------------------------------------------------*/
+
+#define testWINDOW_BITS       ( 8 )
+#define testLOOKAHEAD_BITS    ( 4 )
+#define testDATA_SIZE         ( 4000 )
+/*-----------------------------------------------------------*/
+
+/* "abcabcabc" as encoded by heatshrink -w 8 -l 4: three literals and a back-reference of 6 bytes at distance 3 */
+static const uint8_t ucTestEncodedABC[] = { 0xB0, 0xD8, 0xAC, 0x60, 0x25 };
+
+static uint8_t ucTestWindow[ azureiotaduHEATSHRINK_WINDOW_SIZE( testWINDOW_BITS ) ];
+static uint8_t ucTestData[ testDATA_SIZE ];
+static uint8_t ucTestEncoded[ testDATA_SIZE * 2 ];
+static uint32_t ulTestEncodedLength;
+static uint8_t ucTestDecoded[ testDATA_SIZE * 2 ];
+/*-----------------------------------------------------------*/
+
+uint32_t ulGetAllTests();
+/*-----------------------------------------------------------*/
+
+static void prvPushBits( uint32_t * pulBitCount,
+                         uint32_t ulValue,
+                         uint32_t ulCount )
+{
+    while( ulCount-- > 0 )
+    {
+        if( ( *pulBitCount % 8 ) == 0 )
+        {
+            ucTestEncoded[ *pulBitCount / 8 ] = 0;
+        }
+
+        if( ( ulValue >> ulCount ) & 1 )
+        {
+            ucTestEncoded[ *pulBitCount / 8 ] |= ( uint8_t ) ( 0x80 >> ( *pulBitCount % 8 ) );
+        }
+
+        ( *pulBitCount )++;
+    }
+}
+/*-----------------------------------------------------------*/
+
+/* Greedy heatshrink encoder, matching the longest back-reference in the window */
+static void prvEncodeTestData( void )
+{
+    uint32_t ulBitCount = 0;
+    uint32_t ulIndex = 0;
+    uint32_t ulDistance;
+    uint32_t ulLength;
+    uint32_t ulBestDistance;
+    uint32_t ulBestLength;
+
+    while( ulIndex < testDATA_SIZE )
+    {
+        ulBestLength = 0;
+        ulBestDistance = 0;
+
+        for( ulDistance = 1; ( ulDistance <= ulIndex ) && ( ulDistance <= ( 1U << testWINDOW_BITS ) ); ulDistance++ )
+        {
+            for( ulLength = 0;
+                 ( ulLength < ( 1U << testLOOKAHEAD_BITS ) ) && ( ( ulIndex + ulLength ) < testDATA_SIZE ) &&
+                 ( ucTestData[ ulIndex + ulLength ] == ucTestData[ ulIndex + ulLength - ulDistance ] );
+                 ulLength++ )
+            {
+            }
+
+            if( ulLength > ulBestLength )
+            {
+                ulBestLength = ulLength;
+                ulBestDistance = ulDistance;
+            }
+        }
+
+        if( ulBestLength > 1 )
+        {
+            prvPushBits( &ulBitCount, 0, 1 );
+            prvPushBits( &ulBitCount, ulBestDistance - 1, testWINDOW_BITS );
+            prvPushBits( &ulBitCount, ulBestLength - 1, testLOOKAHEAD_BITS );
+            ulIndex += ulBestLength;
+        }
+        else
+        {
+            prvPushBits( &ulBitCount, 1, 1 );
+            prvPushBits( &ulBitCount, ucTestData[ ulIndex ], 8 );
+            ulIndex++;
+        }
+    }
+
+    ulTestEncodedLength = ( ulBitCount + 7 ) / 8;
+}
+/*-----------------------------------------------------------*/
+
+static void prvSetupTestData( void )
+{
+    uint32_t ulIndex;
+
+    /* Repeated runs with some noise, compressible like firmware */
+    for( ulIndex = 0; ulIndex < testDATA_SIZE; ulIndex++ )
+    {
+        ucTestData[ ulIndex ] = ( uint8_t ) ( ( ( ulIndex % 64 ) < 40 ) ? ( ulIndex % 7 ) : ( ulIndex * 37 + ( ulIndex >> 5 ) ) );
+    }
+
+    prvEncodeTestData();
+}
+/*-----------------------------------------------------------*/
+
+/* Decode the whole stream, in input pieces of ulInputPiece bytes and output pieces of ulOutputPiece bytes */
+static uint32_t prvDecode( AzureIoTADUHeatshrink_t * pxHeatshrink,
+                           const uint8_t * pucInput,
+                           uint32_t ulInputLength,
+                           uint32_t ulInputPiece,
+                           uint32_t ulOutputPiece )
+{
+    uint32_t ulInputOffset = 0;
+    uint32_t ulOutputOffset = 0;
+    uint32_t ulLength;
+    uint32_t ulConsumed;
+    uint32_t ulProduced;
+
+    do
+    {
+        ulLength = ( ulInputLength - ulInputOffset ) < ulInputPiece ? ( ulInputLength - ulInputOffset ) : ulInputPiece;
+        assert_true( ( ulOutputOffset + ulOutputPiece ) <= sizeof( ucTestDecoded ) );
+        assert_int_equal( AzureIoTADUHeatshrink_Decode( pxHeatshrink, pucInput + ulInputOffset, ulLength, &ulConsumed,
+                                                        ucTestDecoded + ulOutputOffset, ulOutputPiece, &ulProduced ),
+                          eAzureIoTSuccess );
+        assert_true( ulConsumed <= ulLength );
+        assert_true( ulProduced <= ulOutputPiece );
+
+        /* Input is left over only when the output is full */
+        assert_true( ( ulConsumed == ulLength ) || ( ulProduced == ulOutputPiece ) );
+
+        ulInputOffset += ulConsumed;
+        ulOutputOffset += ulProduced;
+    } while( ( ulInputOffset < ulInputLength ) || ( ulProduced == ulOutputPiece ) );
+
+    return ulOutputOffset;
+}
+/*-----------------------------------------------------------*/
+
+static void testAzureIoTADUHeatshrink_Init_Failure( void ** ppvState )
+{
+    AzureIoTADUHeatshrink_t xHeatshrink;
+
+    ( void ) ppvState;
+
+    /* Fail when null decoder is passed */
+    assert_int_equal( AzureIoTADUHeatshrink_Init( NULL, testWINDOW_BITS, testLOOKAHEAD_BITS,
+                                                  ucTestWindow, sizeof( ucTestWindow ) ),
+                      eAzureIoTErrorInvalidArgument );
+
+    /* Fail when null window is passed */
+    assert_int_equal( AzureIoTADUHeatshrink_Init( &xHeatshrink, testWINDOW_BITS, testLOOKAHEAD_BITS,
+                                                  NULL, sizeof( ucTestWindow ) ),
+                      eAzureIoTErrorInvalidArgument );
+
+    /* Fail when the window is too small */
+    assert_int_equal( AzureIoTADUHeatshrink_Init( &xHeatshrink, testWINDOW_BITS + 1, testLOOKAHEAD_BITS,
+                                                  ucTestWindow, sizeof( ucTestWindow ) ),
+                      eAzureIoTErrorInvalidArgument );
+
+    /* Fail when the window bits are out of range */
+    assert_int_equal( AzureIoTADUHeatshrink_Init( &xHeatshrink, 3, 3, ucTestWindow, sizeof( ucTestWindow ) ),
+                      eAzureIoTErrorInvalidArgument );
+
+    /* Fail when the lookahead is not smaller than the window */
+    assert_int_equal( AzureIoTADUHeatshrink_Init( &xHeatshrink, testWINDOW_BITS, testWINDOW_BITS,
+                                                  ucTestWindow, sizeof( ucTestWindow ) ),
+                      eAzureIoTErrorInvalidArgument );
+}
+/*-----------------------------------------------------------*/
+
+static void testAzureIoTADUHeatshrink_Decode_Failure( void ** ppvState )
+{
+    AzureIoTADUHeatshrink_t xHeatshrink;
+    uint32_t ulConsumed;
+    uint32_t ulProduced;
+
+    ( void ) ppvState;
+
+    assert_int_equal( AzureIoTADUHeatshrink_Init( &xHeatshrink, testWINDOW_BITS, testLOOKAHEAD_BITS,
+                                                  ucTestWindow, sizeof( ucTestWindow ) ),
+                      eAzureIoTSuccess );
+
+    /* Fail when null decoder is passed */
+    assert_int_equal( AzureIoTADUHeatshrink_Decode( NULL, ucTestEncodedABC, sizeof( ucTestEncodedABC ), &ulConsumed,
+                                                    ucTestDecoded, sizeof( ucTestDecoded ), &ulProduced ),
+                      eAzureIoTErrorInvalidArgument );
+
+    /* Fail when null output is passed */
+    assert_int_equal( AzureIoTADUHeatshrink_Decode( &xHeatshrink, ucTestEncodedABC, sizeof( ucTestEncodedABC ), &ulConsumed,
+                                                    NULL, sizeof( ucTestDecoded ), &ulProduced ),
+                      eAzureIoTErrorInvalidArgument );
+
+    /* Fail when empty output is passed */
+    assert_int_equal( AzureIoTADUHeatshrink_Decode( &xHeatshrink, ucTestEncodedABC, sizeof( ucTestEncodedABC ), &ulConsumed,
+                                                    ucTestDecoded, 0, &ulProduced ),
+                      eAzureIoTErrorInvalidArgument );
+}
+/*-----------------------------------------------------------*/
+
+static void testAzureIoTADUHeatshrink_Decode_Reference( void ** ppvState )
+{
+    AzureIoTADUHeatshrink_t xHeatshrink;
+
+    ( void ) ppvState;
+
+    assert_int_equal( AzureIoTADUHeatshrink_Init( &xHeatshrink, testWINDOW_BITS, testLOOKAHEAD_BITS,
+                                                  ucTestWindow, sizeof( ucTestWindow ) ),
+                      eAzureIoTSuccess );
+
+    assert_int_equal( prvDecode( &xHeatshrink, ucTestEncodedABC, sizeof( ucTestEncodedABC ), 1, 2 ), 9 );
+    assert_memory_equal( ucTestDecoded, "abcabcabc", 9 );
+}
+/*-----------------------------------------------------------*/
+
+static void testAzureIoTADUHeatshrink_Decode_Success( void ** ppvState )
+{
+    AzureIoTADUHeatshrink_t xHeatshrink;
+    uint32_t ulInputPieces[] = { 1, 3, 100, sizeof( ucTestEncoded ) };
+    uint32_t ulOutputPieces[] = { 1, 5, 64, testDATA_SIZE + 1 };
+    uint32_t ulIndex;
+
+    ( void ) ppvState;
+
+    prvSetupTestData();
+
+    /* Compresses, or the test data would not exercise back-references */
+    assert_true( ulTestEncodedLength < ( testDATA_SIZE / 2 ) );
+
+    assert_int_equal( AzureIoTADUHeatshrink_Init( &xHeatshrink, testWINDOW_BITS, testLOOKAHEAD_BITS,
+                                                  ucTestWindow, sizeof( ucTestWindow ) ),
+                      eAzureIoTSuccess );
+
+    /* The output does not depend on how the input and output are split */
+    for( ulIndex = 0; ulIndex < sizeof( ulInputPieces ) / sizeof( ulInputPieces[ 0 ] ); ulIndex++ )
+    {
+        assert_int_equal( AzureIoTADUHeatshrink_Reset( &xHeatshrink ), eAzureIoTSuccess );
+        memset( ucTestDecoded, 0, sizeof( ucTestDecoded ) );
+
+        assert_int_equal( prvDecode( &xHeatshrink, ucTestEncoded, ulTestEncodedLength,
+                                     ulInputPieces[ ulIndex ], ulOutputPieces[ ulIndex ] ),
+                          testDATA_SIZE );
+        assert_memory_equal( ucTestDecoded, ucTestData, testDATA_SIZE );
+    }
+}
+/*-----------------------------------------------------------*/
+
+uint32_t ulGetAllTests()
+{
+    const struct CMUnitTest tests[] =
+    {
+        cmocka_unit_test( testAzureIoTADUHeatshrink_Init_Failure ),
+        cmocka_unit_test( testAzureIoTADUHeatshrink_Decode_Failure ),
+        cmocka_unit_test( testAzureIoTADUHeatshrink_Decode_Reference ),
+        cmocka_unit_test( testAzureIoTADUHeatshrink_Decode_Success )
+    };
+
+    return ( uint32_t ) cmocka_run_group_tests_name( "azure_iot_adu_heatshrink_ut", tests, NULL, NULL );
+}
+/*-----------------------------------------------------------*/
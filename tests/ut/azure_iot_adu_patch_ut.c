@@ -0,0 +1,364 @@
+/* Copyright (c) Microsoft Corporation.
+ * Licensed under the MIT License. */
+
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <setjmp.h>
+
+#include <cmocka.h>
+
+#include "azure_iot_adu_patch.h"
+
+#include "azure/core/az_base64.h"
+#include "azure/core/az_span.h"
+/*-----------------------------------------------------------*/
+
+#define testOLD_SIZE        ( 4096 )
+#define testNEW_SIZE        ( 4300 )
+#define testBUFFER_SIZE     ( 64 )
+#define testSEGMENT_COUNT   ( 4 )
+/*-----------------------------------------------------------*/
+
+/* Data exported by cmocka port for flash */
+extern uint8_t ucTestFlash[];
+extern uint8_t ucTestActiveFlash[];
+extern uint32_t ulTestFlashWriteCount;
+/*-----------------------------------------------------------*/
+
+typedef struct TestSegment
+{
+    uint32_t ulDiffLength;
+    uint32_t ulExtraLength;
+    int32_t lOldAdjust;
+} TestSegment_t;
+
+/* Keeps most of the old image, replaces a few bytes, inserts, skips, and reads up to both ends of the old image. */
+static const TestSegment_t xTestSegments[ testSEGMENT_COUNT ] =
+{
+    { 1000, 150, -900  },
+    { 1200, 0,   1500  },
+    { 1296, 200, -4096 },
+    { 404,  50,  0     }
+};
+
+static AzureADUImage_t xTestImage;
+static uint8_t ucPatchBuffer[ testBUFFER_SIZE ];
+static uint8_t ucTestPatch[ 8 * 1024 ];
+static uint32_t ulTestPatchLength;
+static uint8_t ucTestNewImage[ testNEW_SIZE ];
+/*-----------------------------------------------------------*/
+
+uint32_t ulGetAllTests();
+/*-----------------------------------------------------------*/
+
+static void prvAppendUint32( uint32_t ulValue )
+{
+    ucTestPatch[ ulTestPatchLength++ ] = ( uint8_t ) ulValue;
+    ucTestPatch[ ulTestPatchLength++ ] = ( uint8_t ) ( ulValue >> 8 );
+    ucTestPatch[ ulTestPatchLength++ ] = ( uint8_t ) ( ulValue >> 16 );
+    ucTestPatch[ ulTestPatchLength++ ] = ( uint8_t ) ( ulValue >> 24 );
+}
+/*-----------------------------------------------------------*/
+
+/* Build the patch of xTestSegments, and the new image as bspatch would rebuild it. */
+static void prvSetupTestPatch( void )
+{
+    uint32_t ulIndex;
+    uint32_t ulSegment;
+    uint32_t ulNewOffset = 0;
+    int32_t lOldOffset = 0;
+    uint8_t ucOld;
+
+    for( ulIndex = 0; ulIndex < testOLD_SIZE; ulIndex++ )
+    {
+        ucTestActiveFlash[ ulIndex ] = ( uint8_t ) ( ulIndex * 7 + 3 );
+    }
+
+    ulTestPatchLength = 0;
+    ucTestPatch[ ulTestPatchLength++ ] = 'A';
+    ucTestPatch[ ulTestPatchLength++ ] = 'Z';
+    ucTestPatch[ ulTestPatchLength++ ] = 'D';
+    ucTestPatch[ ulTestPatchLength++ ] = 'P';
+    prvAppendUint32( testOLD_SIZE );
+    prvAppendUint32( testNEW_SIZE );
+
+    for( ulSegment = 0; ulSegment < testSEGMENT_COUNT; ulSegment++ )
+    {
+        prvAppendUint32( xTestSegments[ ulSegment ].ulDiffLength );
+        prvAppendUint32( xTestSegments[ ulSegment ].ulExtraLength );
+        prvAppendUint32( ( uint32_t ) xTestSegments[ ulSegment ].lOldAdjust );
+
+        for( ulIndex = 0; ulIndex < xTestSegments[ ulSegment ].ulDiffLength; ulIndex++ )
+        {
+            /* Mostly unchanged bytes, as in a real diff */
+            ucTestPatch[ ulTestPatchLength ] = ( ( ulIndex % 97 ) == 0 ) ? ( uint8_t ) ( ulIndex + ulSegment ) : 0;
+            ucOld = ucTestActiveFlash[ lOldOffset ];
+            ucTestNewImage[ ulNewOffset++ ] = ( uint8_t ) ( ucOld + ucTestPatch[ ulTestPatchLength++ ] );
+            lOldOffset++;
+        }
+
+        for( ulIndex = 0; ulIndex < xTestSegments[ ulSegment ].ulExtraLength; ulIndex++ )
+        {
+            ucTestPatch[ ulTestPatchLength ] = ( uint8_t ) ( ulIndex * 13 + ulSegment );
+            ucTestNewImage[ ulNewOffset++ ] = ucTestPatch[ ulTestPatchLength++ ];
+        }
+
+        lOldOffset += xTestSegments[ ulSegment ].lOldAdjust;
+    }
+
+    assert_int_equal( ulNewOffset, testNEW_SIZE );
+
+    memset( ucTestFlash, 0xFF, testNEW_SIZE );
+    ulTestFlashWriteCount = 0;
+}
+/*-----------------------------------------------------------*/
+
+static void prvInitTestPatch( AzureIoTADUPatch_t * pxPatch )
+{
+    prvSetupTestPatch();
+    assert_int_equal( AzureIoTADUPatch_Init( pxPatch, &xTestImage, ucPatchBuffer, sizeof( ucPatchBuffer ) ),
+                      eAzureIoTSuccess );
+}
+/*-----------------------------------------------------------*/
+
+static AzureIoTResult_t prvWriteTestPatch( AzureIoTADUPatch_t * pxPatch,
+                                           uint32_t ulPieceLength )
+{
+    AzureIoTResult_t xResult = eAzureIoTErrorPending;
+    uint32_t ulOffset = 0;
+    uint32_t ulLength;
+
+    while( ( ulOffset < ulTestPatchLength ) && ( xResult == eAzureIoTErrorPending ) )
+    {
+        ulLength = ( ulTestPatchLength - ulOffset ) < ulPieceLength ? ( ulTestPatchLength - ulOffset ) : ulPieceLength;
+        xResult = AzureIoTADUPatch_Write( pxPatch, ucTestPatch + ulOffset, ulLength );
+        ulOffset += ulLength;
+    }
+
+    /* The patch is complete only with its last byte */
+    assert_int_equal( ulOffset, ulTestPatchLength );
+
+    return xResult;
+}
+/*-----------------------------------------------------------*/
+
+static void testAzureIoTADUPatch_Init_Failure( void ** ppvState )
+{
+    AzureIoTADUPatch_t xPatch;
+
+    ( void ) ppvState;
+
+    /* Fail when null patch is passed */
+    assert_int_equal( AzureIoTADUPatch_Init( NULL, &xTestImage, ucPatchBuffer, sizeof( ucPatchBuffer ) ),
+                      eAzureIoTErrorInvalidArgument );
+
+    /* Fail when null image is passed */
+    assert_int_equal( AzureIoTADUPatch_Init( &xPatch, NULL, ucPatchBuffer, sizeof( ucPatchBuffer ) ),
+                      eAzureIoTErrorInvalidArgument );
+
+    /* Fail when null buffer is passed */
+    assert_int_equal( AzureIoTADUPatch_Init( &xPatch, &xTestImage, NULL, sizeof( ucPatchBuffer ) ),
+                      eAzureIoTErrorInvalidArgument );
+
+    /* Fail when empty buffer is passed */
+    assert_int_equal( AzureIoTADUPatch_Init( &xPatch, &xTestImage, ucPatchBuffer, 0 ),
+                      eAzureIoTErrorInvalidArgument );
+}
+/*-----------------------------------------------------------*/
+
+static void testAzureIoTADUPatch_Write_Success( void ** ppvState )
+{
+    AzureIoTADUPatch_t xPatch;
+    uint32_t ulPieceLengths[] = { 1, 7, 12, 100, sizeof( ucTestPatch ) };
+    uint32_t ulIndex;
+
+    ( void ) ppvState;
+
+    will_return_always( AzureIoTPlatform_ReadActiveBlock, eAzureIoTSuccess );
+    will_return_always( AzureIoTPlatform_WriteBlock, eAzureIoTSuccess );
+
+    /* The result does not depend on how the patch is split */
+    for( ulIndex = 0; ulIndex < sizeof( ulPieceLengths ) / sizeof( ulPieceLengths[ 0 ] ); ulIndex++ )
+    {
+        prvInitTestPatch( &xPatch );
+
+        assert_int_equal( prvWriteTestPatch( &xPatch, ulPieceLengths[ ulIndex ] ), eAzureIoTSuccess );
+        assert_memory_equal( ucTestFlash, ucTestNewImage, testNEW_SIZE );
+
+        /* Flash is written in blocks no larger than the work buffer */
+        assert_true( ulTestFlashWriteCount >= ( testNEW_SIZE / testBUFFER_SIZE ) );
+    }
+}
+/*-----------------------------------------------------------*/
+
+static void testAzureIoTADUPatch_Write_Failure( void ** ppvState )
+{
+    AzureIoTADUPatch_t xPatch;
+
+    ( void ) ppvState;
+
+    prvInitTestPatch( &xPatch );
+
+    /* Fail when null patch is passed */
+    assert_int_equal( AzureIoTADUPatch_Write( NULL, ucTestPatch, ulTestPatchLength ), eAzureIoTErrorInvalidArgument );
+
+    /* Fail when null data is passed */
+    assert_int_equal( AzureIoTADUPatch_Write( &xPatch, NULL, ulTestPatchLength ), eAzureIoTErrorInvalidArgument );
+
+    /* Fail when the magic does not match */
+    ucTestPatch[ 0 ] = 'X';
+    assert_int_equal( AzureIoTADUPatch_Write( &xPatch, ucTestPatch, azureiotaduPATCH_HEADER_SIZE ), eAzureIoTErrorInvalidResponse );
+
+    /* Fail when a segment goes past the end of the new image */
+    prvInitTestPatch( &xPatch );
+    ucTestPatch[ azureiotaduPATCH_HEADER_SIZE + 7 ] = 0xFF;
+    assert_int_equal( AzureIoTADUPatch_Write( &xPatch, ucTestPatch, azureiotaduPATCH_HEADER_SIZE + azureiotaduPATCH_CONTROL_SIZE ),
+                      eAzureIoTErrorInvalidResponse );
+
+    /* Fail when the diff reads past the end of the old image */
+    prvInitTestPatch( &xPatch );
+    ucTestPatch[ azureiotaduPATCH_HEADER_SIZE ] = 0x10;
+    ucTestPatch[ azureiotaduPATCH_HEADER_SIZE + 1 ] = 0x10;
+    assert_int_equal( AzureIoTADUPatch_Write( &xPatch, ucTestPatch, azureiotaduPATCH_HEADER_SIZE + azureiotaduPATCH_CONTROL_SIZE ),
+                      eAzureIoTErrorInvalidResponse );
+
+    /* Fail when the adjustment moves before the start of the old image */
+    prvInitTestPatch( &xPatch );
+    ucTestPatch[ azureiotaduPATCH_HEADER_SIZE + 9 ] = 0xF0;
+    assert_int_equal( AzureIoTADUPatch_Write( &xPatch, ucTestPatch, azureiotaduPATCH_HEADER_SIZE + azureiotaduPATCH_CONTROL_SIZE ),
+                      eAzureIoTErrorInvalidResponse );
+
+    /* Fail when the adjustment moves past the end of the old image, instead of wrapping around */
+    prvInitTestPatch( &xPatch );
+    ucTestPatch[ azureiotaduPATCH_HEADER_SIZE + 8 ] = 0xFF;
+    ucTestPatch[ azureiotaduPATCH_HEADER_SIZE + 9 ] = 0xFF;
+    ucTestPatch[ azureiotaduPATCH_HEADER_SIZE + 10 ] = 0xFF;
+    ucTestPatch[ azureiotaduPATCH_HEADER_SIZE + 11 ] = 0x7F;
+    assert_int_equal( AzureIoTADUPatch_Write( &xPatch, ucTestPatch, azureiotaduPATCH_HEADER_SIZE + azureiotaduPATCH_CONTROL_SIZE ),
+                      eAzureIoTErrorInvalidResponse );
+
+    /* Fail when the old image cannot be read */
+    prvInitTestPatch( &xPatch );
+    will_return( AzureIoTPlatform_ReadActiveBlock, eAzureIoTErrorFailed );
+    assert_int_equal( AzureIoTADUPatch_Write( &xPatch, ucTestPatch, ulTestPatchLength ), eAzureIoTErrorFailed );
+
+    /* Fail when the new image cannot be written */
+    prvInitTestPatch( &xPatch );
+    will_return( AzureIoTPlatform_ReadActiveBlock, eAzureIoTSuccess );
+    will_return( AzureIoTPlatform_WriteBlock, eAzureIoTErrorFailed );
+    assert_int_equal( AzureIoTADUPatch_Write( &xPatch, ucTestPatch, ulTestPatchLength ), eAzureIoTErrorFailed );
+}
+/*-----------------------------------------------------------*/
+
+static void testAzureIoTADUPatch_Resume_Success( void ** ppvState )
+{
+    AzureIoTADUPatch_t xPatch;
+    AzureIoTADUPatch_t xResumed;
+    AzureIoTADUPatchState_t xState;
+    uint32_t ulSplit;
+
+    ( void ) ppvState;
+
+    will_return_always( AzureIoTPlatform_ReadActiveBlock, eAzureIoTSuccess );
+    will_return_always( AzureIoTPlatform_WriteBlock, eAzureIoTSuccess );
+
+    /* Fail when null patch or state is passed */
+    assert_int_equal( AzureIoTADUPatch_GetState( NULL, &xState ), eAzureIoTErrorInvalidArgument );
+    assert_int_equal( AzureIoTADUPatch_GetState( &xPatch, NULL ), eAzureIoTErrorInvalidArgument );
+    assert_int_equal( AzureIoTADUPatch_Resume( NULL, &xState ), eAzureIoTErrorInvalidArgument );
+    assert_int_equal( AzureIoTADUPatch_Resume( &xPatch, NULL ), eAzureIoTErrorInvalidArgument );
+
+    /* A patch stopped in the middle of a control block goes on in another applier */
+    prvInitTestPatch( &xPatch );
+    ulSplit = azureiotaduPATCH_HEADER_SIZE + azureiotaduPATCH_CONTROL_SIZE + xTestSegments[ 0 ].ulDiffLength +
+              xTestSegments[ 0 ].ulExtraLength + 5;
+    assert_int_equal( AzureIoTADUPatch_Write( &xPatch, ucTestPatch, ulSplit ), eAzureIoTErrorPending );
+    assert_int_equal( AzureIoTADUPatch_GetState( &xPatch, &xState ), eAzureIoTSuccess );
+
+    assert_int_equal( AzureIoTADUPatch_Init( &xResumed, &xTestImage, ucPatchBuffer, sizeof( ucPatchBuffer ) ),
+                      eAzureIoTSuccess );
+    assert_int_equal( AzureIoTADUPatch_Resume( &xResumed, &xState ), eAzureIoTSuccess );
+    assert_int_equal( AzureIoTADUPatch_Write( &xResumed, ucTestPatch + ulSplit, ulTestPatchLength - ulSplit ),
+                      eAzureIoTSuccess );
+    assert_memory_equal( ucTestFlash, ucTestNewImage, testNEW_SIZE );
+}
+/*-----------------------------------------------------------*/
+
+static void testAzureIoTADUPatch_Write_PastEnd( void ** ppvState )
+{
+    AzureIoTADUPatch_t xPatch;
+
+    ( void ) ppvState;
+
+    will_return_always( AzureIoTPlatform_ReadActiveBlock, eAzureIoTSuccess );
+    will_return_always( AzureIoTPlatform_WriteBlock, eAzureIoTSuccess );
+
+    prvInitTestPatch( &xPatch );
+
+    /* Fail on bytes after the end of the patch */
+    ulTestPatchLength++;
+    assert_int_equal( AzureIoTADUPatch_Write( &xPatch, ucTestPatch, ulTestPatchLength ), eAzureIoTErrorInvalidResponse );
+}
+/*-----------------------------------------------------------*/
+
+static void testAzureIoTADUPatch_VerifySHA256( void ** ppvState )
+{
+    AzureIoTADUPatch_t xPatch;
+    AzureIoTCryptoSHA256Context_t xSHA256Context;
+    uint8_t ucSHA256[ azureiotcryptoSHA256_SIZE ];
+    uint8_t ucExpected[ azureiotcryptoSHA256_SIZE ];
+    uint8_t ucHash[ 48 ];
+    int32_t lHashLength;
+
+    ( void ) ppvState;
+
+    will_return_always( AzureIoTPlatform_ReadActiveBlock, eAzureIoTSuccess );
+    will_return_always( AzureIoTPlatform_WriteBlock, eAzureIoTSuccess );
+
+    prvInitTestPatch( &xPatch );
+
+    assert_int_equal( AzureIoTCrypto_SHA256Init( &xSHA256Context ), eAzureIoTSuccess );
+    assert_int_equal( AzureIoTCrypto_SHA256Update( &xSHA256Context, ucTestNewImage, testNEW_SIZE ), eAzureIoTSuccess );
+    assert_int_equal( AzureIoTCrypto_SHA256Final( &xSHA256Context, ucExpected, sizeof( ucExpected ) ), eAzureIoTSuccess );
+    assert_false( az_result_failed( az_base64_encode( az_span_create( ucHash, sizeof( ucHash ) ),
+                                                      az_span_create( ucExpected, sizeof( ucExpected ) ),
+                                                      &lHashLength ) ) );
+
+    /* Pending until the new image is complete */
+    assert_int_equal( AzureIoTADUPatch_GetSHA256( &xPatch, ucSHA256, sizeof( ucSHA256 ) ), eAzureIoTErrorPending );
+    assert_int_equal( AzureIoTADUPatch_VerifySHA256( &xPatch, ucHash, ( uint32_t ) lHashLength ), eAzureIoTErrorPending );
+
+    assert_int_equal( prvWriteTestPatch( &xPatch, 100 ), eAzureIoTSuccess );
+
+    assert_int_equal( AzureIoTADUPatch_GetSHA256( &xPatch, ucSHA256, sizeof( ucSHA256 ) ), eAzureIoTSuccess );
+    assert_memory_equal( ucSHA256, ucExpected, sizeof( ucExpected ) );
+    assert_int_equal( AzureIoTADUPatch_VerifySHA256( &xPatch, ucHash, ( uint32_t ) lHashLength ), eAzureIoTSuccess );
+
+    /* Fail when the hash does not match */
+    ucHash[ 0 ] = ( ucHash[ 0 ] == 'A' ) ? 'B' : 'A';
+    assert_int_equal( AzureIoTADUPatch_VerifySHA256( &xPatch, ucHash, ( uint32_t ) lHashLength ), eAzureIoTErrorFailed );
+
+    /* Fail when null hash is passed */
+    assert_int_equal( AzureIoTADUPatch_VerifySHA256( &xPatch, NULL, ( uint32_t ) lHashLength ), eAzureIoTErrorInvalidArgument );
+}
+/*-----------------------------------------------------------*/
+
+uint32_t ulGetAllTests()
+{
+    const struct CMUnitTest tests[] =
+    {
+        cmocka_unit_test( testAzureIoTADUPatch_Init_Failure ),
+        cmocka_unit_test( testAzureIoTADUPatch_Write_Success ),
+        cmocka_unit_test( testAzureIoTADUPatch_Write_Failure ),
+        cmocka_unit_test( testAzureIoTADUPatch_Resume_Success ),
+        cmocka_unit_test( testAzureIoTADUPatch_Write_PastEnd ),
+        cmocka_unit_test( testAzureIoTADUPatch_VerifySHA256 )
+    };
+
+    return ( uint32_t ) cmocka_run_group_tests_name( "azure_iot_adu_patch_ut", tests, NULL, NULL );
+}
+/*-----------------------------------------------------------*/
@@ -0,0 +1,373 @@
+/* Copyright (c) Microsoft Corporation.
+ * Licensed under the MIT License. */
+
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <setjmp.h>
+
+#include <cmocka.h>
+
+#include "azure_iot_cbor_reader.h"
+#include "azure_iot_cbor_writer.h"
+/*-----------------------------------------------------------*/
+
+#define testBUFFER_SIZE    ( 128 )
+
+static uint8_t ucTemperature[] = "temp";
+static uint8_t ucCount[] = "count";
+static uint8_t ucState[] = "state";
+static uint8_t ucRaw[] = "raw";
+static uint8_t ucIdle[] = "idle";
+static uint8_t ucRawValue[] = { 0x01, 0x02, 0xFF };
+
+/*
+ * { "a": 1, "b": [ 1.5, -1000 ], "c": { "d": false }, "e": null }, with definite lengths
+ */
+static const uint8_t ucTestDefinite[] =
+{
+    0xA4,
+    0x61, 'a',  0x01,
+    0x61, 'b',  0x82, 0xF9, 0x3E, 0x00, 0x39, 0x03, 0xE7,
+    0x61, 'c',  0xA1, 0x61, 'd',  0xF4,
+    0x61, 'e',  0xF6
+};
+
+static uint8_t ucTestBuffer[ testBUFFER_SIZE ];
+/*-----------------------------------------------------------*/
+
+static void prvNextTokenIs( AzureIoTCBORReader_t * pxReader,
+                            AzureIoTCBORTokenType_t xExpected )
+{
+    AzureIoTCBORTokenType_t xTokenType;
+
+    assert_int_equal( AzureIoTCBORReader_NextToken( pxReader ), eAzureIoTSuccess );
+    assert_int_equal( AzureIoTCBORReader_TokenType( pxReader, &xTokenType ), eAzureIoTSuccess );
+    assert_int_equal( xTokenType, xExpected );
+}
+/*-----------------------------------------------------------*/
+
+static void prvReadFails( const uint8_t * pucCBOR,
+                          uint32_t ulLength,
+                          uint32_t ulGoodTokens,
+                          AzureIoTResult_t xExpected )
+{
+    AzureIoTCBORReader_t xReader;
+    uint32_t ulIndex;
+
+    assert_int_equal( AzureIoTCBORReader_Init( &xReader, pucCBOR, ulLength ), eAzureIoTSuccess );
+
+    for( ulIndex = 0; ulIndex < ulGoodTokens; ulIndex++ )
+    {
+        assert_int_equal( AzureIoTCBORReader_NextToken( &xReader ), eAzureIoTSuccess );
+    }
+
+    assert_int_equal( AzureIoTCBORReader_NextToken( &xReader ), xExpected );
+}
+/*-----------------------------------------------------------*/
+
+static void testAzureIoTCBORReader_Init_Failure( void ** ppvState )
+{
+    AzureIoTCBORReader_t xReader;
+
+    assert_int_equal( AzureIoTCBORReader_Init( NULL, ucTestDefinite, sizeof( ucTestDefinite ) ),
+                      eAzureIoTErrorInvalidArgument );
+    assert_int_equal( AzureIoTCBORReader_Init( &xReader, NULL, sizeof( ucTestDefinite ) ),
+                      eAzureIoTErrorInvalidArgument );
+    assert_int_equal( AzureIoTCBORReader_Init( &xReader, ucTestDefinite, 0 ),
+                      eAzureIoTErrorInvalidArgument );
+    assert_int_equal( AzureIoTCBORReader_NextToken( NULL ), eAzureIoTErrorInvalidArgument );
+    assert_int_equal( AzureIoTCBORReader_SkipChildren( NULL ), eAzureIoTErrorInvalidArgument );
+}
+/*-----------------------------------------------------------*/
+
+static void testAzureIoTCBORReader_Definite_Success( void ** ppvState )
+{
+    AzureIoTCBORReader_t xReader;
+    bool xValue = true;
+    int32_t lValue;
+    double xDouble;
+
+    assert_int_equal( AzureIoTCBORReader_Init( &xReader, ucTestDefinite, sizeof( ucTestDefinite ) ), eAzureIoTSuccess );
+
+    prvNextTokenIs( &xReader, eAzureIoTCBORTokenBEGIN_OBJECT );
+    prvNextTokenIs( &xReader, eAzureIoTCBORTokenPROPERTY_NAME );
+    assert_true( AzureIoTCBORReader_TokenIsTextEqual( &xReader, ( const uint8_t * ) "a", 1 ) );
+    prvNextTokenIs( &xReader, eAzureIoTCBORTokenNUMBER );
+    assert_int_equal( AzureIoTCBORReader_GetTokenInt32( &xReader, &lValue ), eAzureIoTSuccess );
+    assert_int_equal( lValue, 1 );
+
+    prvNextTokenIs( &xReader, eAzureIoTCBORTokenPROPERTY_NAME );
+    assert_true( AzureIoTCBORReader_TokenIsTextEqual( &xReader, ( const uint8_t * ) "b", 1 ) );
+    prvNextTokenIs( &xReader, eAzureIoTCBORTokenBEGIN_ARRAY );
+    prvNextTokenIs( &xReader, eAzureIoTCBORTokenNUMBER );
+    assert_int_equal( AzureIoTCBORReader_GetTokenDouble( &xReader, &xDouble ), eAzureIoTSuccess );
+    assert_true( xDouble == 1.5 );
+    assert_int_equal( AzureIoTCBORReader_GetTokenInt32( &xReader, &lValue ), eAzureIoTErrorUnexpectedChar );
+    prvNextTokenIs( &xReader, eAzureIoTCBORTokenNUMBER );
+    assert_int_equal( AzureIoTCBORReader_GetTokenInt32( &xReader, &lValue ), eAzureIoTSuccess );
+    assert_int_equal( lValue, -1000 );
+    assert_int_equal( AzureIoTCBORReader_GetTokenDouble( &xReader, &xDouble ), eAzureIoTSuccess );
+    assert_true( xDouble == -1000.0 );
+    prvNextTokenIs( &xReader, eAzureIoTCBORTokenEND_ARRAY );
+
+    prvNextTokenIs( &xReader, eAzureIoTCBORTokenPROPERTY_NAME );
+    prvNextTokenIs( &xReader, eAzureIoTCBORTokenBEGIN_OBJECT );
+    prvNextTokenIs( &xReader, eAzureIoTCBORTokenPROPERTY_NAME );
+    assert_true( AzureIoTCBORReader_TokenIsTextEqual( &xReader, ( const uint8_t * ) "d", 1 ) );
+    prvNextTokenIs( &xReader, eAzureIoTCBORTokenFALSE );
+    assert_int_equal( AzureIoTCBORReader_GetTokenBool( &xReader, &xValue ), eAzureIoTSuccess );
+    assert_false( xValue );
+    prvNextTokenIs( &xReader, eAzureIoTCBORTokenEND_OBJECT );
+
+    prvNextTokenIs( &xReader, eAzureIoTCBORTokenPROPERTY_NAME );
+    prvNextTokenIs( &xReader, eAzureIoTCBORTokenNULL );
+    prvNextTokenIs( &xReader, eAzureIoTCBORTokenEND_OBJECT );
+
+    assert_int_equal( AzureIoTCBORReader_NextToken( &xReader ), eAzureIoTErrorJSONReaderDone );
+}
+/*-----------------------------------------------------------*/
+
+static void testAzureIoTCBORReader_WriterPayload_Success( void ** ppvState )
+{
+    AzureIoTCBORWriter_t xWriter;
+    AzureIoTCBORReader_t xReader;
+    uint8_t ucString[ 8 ];
+    uint32_t ulLength;
+    const uint8_t * pucValue;
+    double xDouble;
+    int32_t lValue;
+
+    assert_int_equal( AzureIoTCBORWriter_Init( &xWriter, ucTestBuffer, sizeof( ucTestBuffer ) ), eAzureIoTSuccess );
+    assert_int_equal( AzureIoTCBORWriter_AppendBeginObject( &xWriter ), eAzureIoTSuccess );
+    assert_int_equal( AzureIoTCBORWriter_AppendPropertyWithDoubleValue( &xWriter, ucTemperature, sizeof( ucTemperature ) - 1, 21.37 ),
+                      eAzureIoTSuccess );
+    assert_int_equal( AzureIoTCBORWriter_AppendPropertyWithInt32Value( &xWriter, ucCount, sizeof( ucCount ) - 1, INT32_MIN ),
+                      eAzureIoTSuccess );
+    assert_int_equal( AzureIoTCBORWriter_AppendPropertyWithStringValue( &xWriter, ucState, sizeof( ucState ) - 1,
+                                                                        ucIdle, sizeof( ucIdle ) - 1 ),
+                      eAzureIoTSuccess );
+    assert_int_equal( AzureIoTCBORWriter_AppendPropertyWithBytesValue( &xWriter, ucRaw, sizeof( ucRaw ) - 1,
+                                                                       ucRawValue, sizeof( ucRawValue ) ),
+                      eAzureIoTSuccess );
+    assert_int_equal( AzureIoTCBORWriter_AppendEndObject( &xWriter ), eAzureIoTSuccess );
+
+    assert_int_equal( AzureIoTCBORReader_Init( &xReader, ucTestBuffer, ( uint32_t ) AzureIoTCBORWriter_GetBytesUsed( &xWriter ) ),
+                      eAzureIoTSuccess );
+    prvNextTokenIs( &xReader, eAzureIoTCBORTokenBEGIN_OBJECT );
+
+    prvNextTokenIs( &xReader, eAzureIoTCBORTokenPROPERTY_NAME );
+    assert_true( AzureIoTCBORReader_TokenIsTextEqual( &xReader, ucTemperature, sizeof( ucTemperature ) - 1 ) );
+    prvNextTokenIs( &xReader, eAzureIoTCBORTokenNUMBER );
+    assert_int_equal( AzureIoTCBORReader_GetTokenDouble( &xReader, &xDouble ), eAzureIoTSuccess );
+    assert_true( xDouble == 21.37 );
+
+    prvNextTokenIs( &xReader, eAzureIoTCBORTokenPROPERTY_NAME );
+    prvNextTokenIs( &xReader, eAzureIoTCBORTokenNUMBER );
+    assert_int_equal( AzureIoTCBORReader_GetTokenInt32( &xReader, &lValue ), eAzureIoTSuccess );
+    assert_int_equal( lValue, INT32_MIN );
+
+    prvNextTokenIs( &xReader, eAzureIoTCBORTokenPROPERTY_NAME );
+    prvNextTokenIs( &xReader, eAzureIoTCBORTokenSTRING );
+    assert_int_equal( AzureIoTCBORReader_GetTokenString( &xReader, ucString, sizeof( ucString ), &ulLength ), eAzureIoTSuccess );
+    assert_int_equal( ulLength, sizeof( ucIdle ) - 1 );
+    assert_string_equal( ( char * ) ucString, ( char * ) ucIdle );
+    assert_int_equal( AzureIoTCBORReader_GetTokenString( &xReader, ucString, sizeof( ucIdle ) - 1, &ulLength ),
+                      eAzureIoTErrorOutOfMemory );
+    assert_int_equal( AzureIoTCBORReader_GetTokenStringView( &xReader, &pucValue, &ulLength ), eAzureIoTSuccess );
+    assert_int_equal( ulLength, sizeof( ucIdle ) - 1 );
+    assert_memory_equal( pucValue, ucIdle, ulLength );
+    assert_int_equal( AzureIoTCBORReader_GetTokenBytes( &xReader, &pucValue, &ulLength ), eAzureIoTErrorJSONInvalidState );
+
+    prvNextTokenIs( &xReader, eAzureIoTCBORTokenPROPERTY_NAME );
+    prvNextTokenIs( &xReader, eAzureIoTCBORTokenBYTES );
+    assert_int_equal( AzureIoTCBORReader_GetTokenBytes( &xReader, &pucValue, &ulLength ), eAzureIoTSuccess );
+    assert_int_equal( ulLength, sizeof( ucRawValue ) );
+    assert_memory_equal( pucValue, ucRawValue, ulLength );
+    assert_int_equal( AzureIoTCBORReader_GetTokenStringView( &xReader, &pucValue, &ulLength ), eAzureIoTErrorJSONInvalidState );
+
+    prvNextTokenIs( &xReader, eAzureIoTCBORTokenEND_OBJECT );
+    assert_int_equal( AzureIoTCBORReader_NextToken( &xReader ), eAzureIoTErrorJSONReaderDone );
+}
+/*-----------------------------------------------------------*/
+
+static void testAzureIoTCBORReader_Floats_Success( void ** ppvState )
+{
+    AzureIoTCBORReader_t xReader;
+    double xDouble;
+
+    /* [_ 5.960464477539063e-8 (half), -Infinity (half), NaN (half), 100000.0 (single), 1(1363896240) ] */
+    static const uint8_t ucFloats[] =
+    {
+        0x9F,
+        0xF9, 0x00, 0x01,
+        0xF9, 0xFC, 0x00,
+        0xF9, 0x7E, 0x00,
+        0xFA, 0x47, 0xC3, 0x50, 0x00,
+        0xC1, 0x1A, 0x51, 0x4B, 0x67, 0xB0,
+        0xFF
+    };
+
+    assert_int_equal( AzureIoTCBORReader_Init( &xReader, ucFloats, sizeof( ucFloats ) ), eAzureIoTSuccess );
+    prvNextTokenIs( &xReader, eAzureIoTCBORTokenBEGIN_ARRAY );
+
+    prvNextTokenIs( &xReader, eAzureIoTCBORTokenNUMBER );
+    assert_int_equal( AzureIoTCBORReader_GetTokenDouble( &xReader, &xDouble ), eAzureIoTSuccess );
+    assert_true( xDouble == 5.960464477539063e-8 );
+
+    prvNextTokenIs( &xReader, eAzureIoTCBORTokenNUMBER );
+    assert_int_equal( AzureIoTCBORReader_GetTokenDouble( &xReader, &xDouble ), eAzureIoTSuccess );
+    assert_true( isinf( xDouble ) && ( xDouble < 0 ) );
+
+    prvNextTokenIs( &xReader, eAzureIoTCBORTokenNUMBER );
+    assert_int_equal( AzureIoTCBORReader_GetTokenDouble( &xReader, &xDouble ), eAzureIoTSuccess );
+    assert_true( isnan( xDouble ) );
+
+    prvNextTokenIs( &xReader, eAzureIoTCBORTokenNUMBER );
+    assert_int_equal( AzureIoTCBORReader_GetTokenDouble( &xReader, &xDouble ), eAzureIoTSuccess );
+    assert_true( xDouble == 100000.0 );
+
+    /* The tag is skipped */
+    prvNextTokenIs( &xReader, eAzureIoTCBORTokenNUMBER );
+    assert_int_equal( AzureIoTCBORReader_GetTokenDouble( &xReader, &xDouble ), eAzureIoTSuccess );
+    assert_true( xDouble == 1363896240.0 );
+
+    prvNextTokenIs( &xReader, eAzureIoTCBORTokenEND_ARRAY );
+}
+/*-----------------------------------------------------------*/
+
+static void testAzureIoTCBORReader_SkipChildren_Success( void ** ppvState )
+{
+    AzureIoTCBORReader_t xReader;
+    int32_t lValue;
+
+    assert_int_equal( AzureIoTCBORReader_Init( &xReader, ucTestDefinite, sizeof( ucTestDefinite ) ), eAzureIoTSuccess );
+    prvNextTokenIs( &xReader, eAzureIoTCBORTokenBEGIN_OBJECT );
+    prvNextTokenIs( &xReader, eAzureIoTCBORTokenPROPERTY_NAME );
+
+    /* A property name moves to its value, not a container */
+    assert_int_equal( AzureIoTCBORReader_SkipChildren( &xReader ), eAzureIoTSuccess );
+    assert_int_equal( AzureIoTCBORReader_GetTokenInt32( &xReader, &lValue ), eAzureIoTSuccess );
+    assert_int_equal( lValue, 1 );
+
+    /* "b" and its array */
+    prvNextTokenIs( &xReader, eAzureIoTCBORTokenPROPERTY_NAME );
+    assert_int_equal( AzureIoTCBORReader_SkipChildren( &xReader ), eAzureIoTSuccess );
+    prvNextTokenIs( &xReader, eAzureIoTCBORTokenPROPERTY_NAME );
+    assert_true( AzureIoTCBORReader_TokenIsTextEqual( &xReader, ( const uint8_t * ) "c", 1 ) );
+
+    /* The map of "c" */
+    prvNextTokenIs( &xReader, eAzureIoTCBORTokenBEGIN_OBJECT );
+    assert_int_equal( AzureIoTCBORReader_SkipChildren( &xReader ), eAzureIoTSuccess );
+    prvNextTokenIs( &xReader, eAzureIoTCBORTokenPROPERTY_NAME );
+    assert_true( AzureIoTCBORReader_TokenIsTextEqual( &xReader, ( const uint8_t * ) "e", 1 ) );
+
+    /* The whole payload */
+    assert_int_equal( AzureIoTCBORReader_Init( &xReader, ucTestDefinite, sizeof( ucTestDefinite ) ), eAzureIoTSuccess );
+    prvNextTokenIs( &xReader, eAzureIoTCBORTokenBEGIN_OBJECT );
+    assert_int_equal( AzureIoTCBORReader_SkipChildren( &xReader ), eAzureIoTSuccess );
+    assert_int_equal( AzureIoTCBORReader_NextToken( &xReader ), eAzureIoTErrorJSONReaderDone );
+}
+/*-----------------------------------------------------------*/
+
+static void testAzureIoTCBORReader_GetToken_Failure( void ** ppvState )
+{
+    AzureIoTCBORReader_t xReader;
+    AzureIoTCBORTokenType_t xTokenType;
+    uint8_t ucString[ 8 ];
+    uint32_t ulLength;
+    const uint8_t * pucValue;
+    bool xValue;
+    int32_t lValue;
+    double xDouble;
+
+    /* [ 2147483648, -2147483649 ] */
+    static const uint8_t ucLarge[] =
+    {
+        0x82, 0x1A, 0x80, 0x00, 0x00, 0x00, 0x3A, 0x80, 0x00, 0x00, 0x00
+    };
+
+    assert_int_equal( AzureIoTCBORReader_GetTokenBool( NULL, &xValue ), eAzureIoTErrorInvalidArgument );
+    assert_int_equal( AzureIoTCBORReader_GetTokenBool( &xReader, NULL ), eAzureIoTErrorInvalidArgument );
+    assert_int_equal( AzureIoTCBORReader_GetTokenInt32( NULL, &lValue ), eAzureIoTErrorInvalidArgument );
+    assert_int_equal( AzureIoTCBORReader_GetTokenDouble( NULL, &xDouble ), eAzureIoTErrorInvalidArgument );
+    assert_int_equal( AzureIoTCBORReader_GetTokenString( NULL, ucString, sizeof( ucString ), &ulLength ),
+                      eAzureIoTErrorInvalidArgument );
+    assert_int_equal( AzureIoTCBORReader_GetTokenString( &xReader, ucString, 0, &ulLength ),
+                      eAzureIoTErrorInvalidArgument );
+    assert_int_equal( AzureIoTCBORReader_GetTokenStringView( NULL, &pucValue, &ulLength ), eAzureIoTErrorInvalidArgument );
+    assert_int_equal( AzureIoTCBORReader_GetTokenBytes( NULL, &pucValue, &ulLength ), eAzureIoTErrorInvalidArgument );
+    assert_int_equal( AzureIoTCBORReader_TokenType( NULL, &xTokenType ), eAzureIoTErrorInvalidArgument );
+    assert_false( AzureIoTCBORReader_TokenIsTextEqual( NULL, ucIdle, sizeof( ucIdle ) - 1 ) );
+
+    assert_int_equal( AzureIoTCBORReader_Init( &xReader, ucLarge, sizeof( ucLarge ) ), eAzureIoTSuccess );
+    prvNextTokenIs( &xReader, eAzureIoTCBORTokenBEGIN_ARRAY );
+
+    /* Wrong token kinds */
+    assert_int_equal( AzureIoTCBORReader_GetTokenBool( &xReader, &xValue ), eAzureIoTErrorJSONInvalidState );
+    assert_int_equal( AzureIoTCBORReader_GetTokenInt32( &xReader, &lValue ), eAzureIoTErrorJSONInvalidState );
+    assert_int_equal( AzureIoTCBORReader_GetTokenDouble( &xReader, &xDouble ), eAzureIoTErrorJSONInvalidState );
+    assert_int_equal( AzureIoTCBORReader_GetTokenString( &xReader, ucString, sizeof( ucString ), &ulLength ),
+                      eAzureIoTErrorJSONInvalidState );
+    assert_false( AzureIoTCBORReader_TokenIsTextEqual( &xReader, NULL, 0 ) );
+
+    /* Out of the int32_t range */
+    prvNextTokenIs( &xReader, eAzureIoTCBORTokenNUMBER );
+    assert_int_equal( AzureIoTCBORReader_GetTokenInt32( &xReader, &lValue ), eAzureIoTErrorUnexpectedChar );
+    assert_int_equal( AzureIoTCBORReader_GetTokenDouble( &xReader, &xDouble ), eAzureIoTSuccess );
+    assert_true( xDouble == 2147483648.0 );
+    prvNextTokenIs( &xReader, eAzureIoTCBORTokenNUMBER );
+    assert_int_equal( AzureIoTCBORReader_GetTokenInt32( &xReader, &lValue ), eAzureIoTErrorUnexpectedChar );
+    assert_int_equal( AzureIoTCBORReader_GetTokenDouble( &xReader, &xDouble ), eAzureIoTSuccess );
+    assert_true( xDouble == -2147483649.0 );
+}
+/*-----------------------------------------------------------*/
+
+static void testAzureIoTCBORReader_Malformed_Failure( void ** ppvState )
+{
+    uint8_t ucDeep[ azureiotconfigCBOR_READER_MAX_DEPTH + 1 ];
+
+    /* Truncated head, string, and array */
+    prvReadFails( ( const uint8_t * ) "\x19\x01", 2, 0, eAzureIoTErrorUnexpectedChar );
+    prvReadFails( ( const uint8_t * ) "\x64" "ab", 3, 0, eAzureIoTErrorUnexpectedChar );
+    prvReadFails( ( const uint8_t * ) "\x83\x01", 2, 0, eAzureIoTErrorUnexpectedChar );
+    prvReadFails( ( const uint8_t * ) "\x9F\x01", 2, 2, eAzureIoTErrorUnexpectedChar );
+
+    /* A map key which is not a text string */
+    prvReadFails( ( const uint8_t * ) "\xA1\x01\x02", 3, 1, eAzureIoTErrorUnexpectedChar );
+
+    /* Breaks out of place: top level, definite array, between a name and its value */
+    prvReadFails( ( const uint8_t * ) "\xFF", 1, 0, eAzureIoTErrorUnexpectedChar );
+    prvReadFails( ( const uint8_t * ) "\x81\xFF", 2, 1, eAzureIoTErrorUnexpectedChar );
+    prvReadFails( ( const uint8_t * ) "\xBF\x61" "a\xFF", 4, 2, eAzureIoTErrorUnexpectedChar );
+
+    /* Reserved additional information, chunked strings, other simple values */
+    prvReadFails( ( const uint8_t * ) "\x1C", 1, 0, eAzureIoTErrorUnexpectedChar );
+    prvReadFails( ( const uint8_t * ) "\x7F\x61" "a\xFF", 4, 0, eAzureIoTErrorUnexpectedChar );
+    prvReadFails( ( const uint8_t * ) "\xF0", 1, 0, eAzureIoTErrorUnexpectedChar );
+
+    /* Too deep */
+    memset( ucDeep, 0x81, sizeof( ucDeep ) );
+    prvReadFails( ucDeep, sizeof( ucDeep ), azureiotconfigCBOR_READER_MAX_DEPTH, eAzureIoTErrorJSONNestingOverflow );
+}
+/*-----------------------------------------------------------*/
+
+uint32_t ulGetAllTests()
+{
+    const struct CMUnitTest tests[] =
+    {
+        cmocka_unit_test( testAzureIoTCBORReader_Init_Failure ),
+        cmocka_unit_test( testAzureIoTCBORReader_Definite_Success ),
+        cmocka_unit_test( testAzureIoTCBORReader_WriterPayload_Success ),
+        cmocka_unit_test( testAzureIoTCBORReader_Floats_Success ),
+        cmocka_unit_test( testAzureIoTCBORReader_SkipChildren_Success ),
+        cmocka_unit_test( testAzureIoTCBORReader_GetToken_Failure ),
+        cmocka_unit_test( testAzureIoTCBORReader_Malformed_Failure )
+    };
+
+    return ( uint32_t ) cmocka_run_group_tests_name( "azure_iot_cbor_reader_ut", tests, NULL, NULL );
+}
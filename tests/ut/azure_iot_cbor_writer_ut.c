@@ -0,0 +1,276 @@
+/* Copyright (c) Microsoft Corporation.
+ * Licensed under the MIT License. */
+
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <setjmp.h>
+
+#include <cmocka.h>
+
+#include "azure_iot_cbor_writer.h"
+/*-----------------------------------------------------------*/
+
+#define testBUFFER_SIZE    ( 128 )
+
+typedef struct TestDouble
+{
+    double xValue;
+    uint8_t ucEncoded[ 9 ];
+    uint32_t ulLength;
+} TestDouble_t;
+
+typedef struct TestInt32
+{
+    int32_t lValue;
+    uint8_t ucEncoded[ 5 ];
+    uint32_t ulLength;
+} TestInt32_t;
+
+static uint8_t ucTemperature[] = "temp";
+static uint8_t ucCount[] = "count";
+static uint8_t ucOk[] = "ok";
+static uint8_t ucState[] = "state";
+static uint8_t ucRaw[] = "raw";
+static uint8_t ucList[] = "list";
+static uint8_t ucIdle[] = "idle";
+static uint8_t ucRawValue[] = { 0x01, 0x02, 0xFF };
+
+/*
+ * {_ "temp": 21.5, "count": 3, "ok": true, "state": "idle", "raw": h'0102FF', "list": [_ -1, null] }
+ */
+static const uint8_t ucExpectedTelemetry[] =
+{
+    0xBF,
+    0x64, 't',  'e',  'm',  'p',  0xF9, 0x4D, 0x60,
+    0x65, 'c',  'o',  'u',  'n',  't',  0x03,
+    0x62, 'o',  'k',  0xF5,
+    0x65, 's',  't',  'a',  't',  'e',  0x64, 'i',  'd',  'l',  'e',
+    0x63, 'r',  'a',  'w',  0x43, 0x01, 0x02, 0xFF,
+    0x64, 'l',  'i',  's',  't',  0x9F, 0x20, 0xF6, 0xFF,
+    0xFF
+};
+
+static const TestDouble_t xTestDoubles[] =
+{
+    { 0.0,                     { 0xF9, 0x00, 0x00 },                                     3 },
+    { -0.0,                    { 0xF9, 0x80, 0x00 },                                     3 },
+    { 1.0,                     { 0xF9, 0x3C, 0x00 },                                     3 },
+    { 1.5,                     { 0xF9, 0x3E, 0x00 },                                     3 },
+    { 21.5,                    { 0xF9, 0x4D, 0x60 },                                     3 },
+    { 65504.0,                 { 0xF9, 0x7B, 0xFF },                                     3 },
+    { -4.0,                    { 0xF9, 0xC4, 0x00 },                                     3 },
+    { 5.960464477539063e-8,    { 0xF9, 0x00, 0x01 },                                     3 },
+    { 0.00006103515625,        { 0xF9, 0x04, 0x00 },                                     3 },
+    { 100000.0,                { 0xFA, 0x47, 0xC3, 0x50, 0x00 },                         5 },
+    { 3.4028234663852886e+38,  { 0xFA, 0x7F, 0x7F, 0xFF, 0xFF },                         5 },
+    { 1.1,                     { 0xFB, 0x3F, 0xF1, 0x99, 0x99, 0x99, 0x99, 0x99, 0x9A }, 9 },
+    { 21.37,                   { 0xFB, 0x40, 0x35, 0x5E, 0xB8, 0x51, 0xEB, 0x85, 0x1F }, 9 },
+    { 1.0e+300,                { 0xFB, 0x7E, 0x37, 0xE4, 0x3C, 0x88, 0x00, 0x75, 0x9C }, 9 },
+    { INFINITY,                { 0xF9, 0x7C, 0x00 },                                     3 },
+    { -INFINITY,               { 0xF9, 0xFC, 0x00 },                                     3 },
+    { NAN,                     { 0xF9, 0x7E, 0x00 },                                     3 }
+};
+
+static const TestInt32_t xTestInt32s[] =
+{
+    { 0,          { 0x00 },                         1 },
+    { 23,         { 0x17 },                         1 },
+    { 24,         { 0x18, 0x18 },                   2 },
+    { 255,        { 0x18, 0xFF },                   2 },
+    { 256,        { 0x19, 0x01, 0x00 },             3 },
+    { 65536,      { 0x1A, 0x00, 0x01, 0x00, 0x00 }, 5 },
+    { INT32_MAX,  { 0x1A, 0x7F, 0xFF, 0xFF, 0xFF }, 5 },
+    { -1,         { 0x20 },                         1 },
+    { -24,        { 0x37 },                         1 },
+    { -25,        { 0x38, 0x18 },                   2 },
+    { -1000,      { 0x39, 0x03, 0xE7 },             3 },
+    { INT32_MIN,  { 0x3A, 0x7F, 0xFF, 0xFF, 0xFF }, 5 }
+};
+
+static uint8_t ucTestBuffer[ testBUFFER_SIZE ];
+/*-----------------------------------------------------------*/
+
+static void testAzureIoTCBORWriter_Init_Failure( void ** ppvState )
+{
+    AzureIoTCBORWriter_t xWriter;
+
+    assert_int_equal( AzureIoTCBORWriter_Init( NULL, ucTestBuffer, sizeof( ucTestBuffer ) ),
+                      eAzureIoTErrorInvalidArgument );
+    assert_int_equal( AzureIoTCBORWriter_Init( &xWriter, NULL, sizeof( ucTestBuffer ) ),
+                      eAzureIoTErrorInvalidArgument );
+    assert_int_equal( AzureIoTCBORWriter_GetBytesUsed( NULL ), -1 );
+}
+/*-----------------------------------------------------------*/
+
+static void testAzureIoTCBORWriter_Telemetry_Success( void ** ppvState )
+{
+    AzureIoTCBORWriter_t xWriter;
+
+    assert_int_equal( AzureIoTCBORWriter_Init( &xWriter, ucTestBuffer, sizeof( ucTestBuffer ) ), eAzureIoTSuccess );
+    assert_int_equal( AzureIoTCBORWriter_AppendBeginObject( &xWriter ), eAzureIoTSuccess );
+    assert_int_equal( AzureIoTCBORWriter_AppendPropertyWithDoubleValue( &xWriter, ucTemperature, sizeof( ucTemperature ) - 1, 21.5 ),
+                      eAzureIoTSuccess );
+    assert_int_equal( AzureIoTCBORWriter_AppendPropertyWithInt32Value( &xWriter, ucCount, sizeof( ucCount ) - 1, 3 ),
+                      eAzureIoTSuccess );
+    assert_int_equal( AzureIoTCBORWriter_AppendPropertyWithBoolValue( &xWriter, ucOk, sizeof( ucOk ) - 1, true ),
+                      eAzureIoTSuccess );
+    assert_int_equal( AzureIoTCBORWriter_AppendPropertyWithStringValue( &xWriter, ucState, sizeof( ucState ) - 1,
+                                                                        ucIdle, sizeof( ucIdle ) - 1 ),
+                      eAzureIoTSuccess );
+    assert_int_equal( AzureIoTCBORWriter_AppendPropertyWithBytesValue( &xWriter, ucRaw, sizeof( ucRaw ) - 1,
+                                                                       ucRawValue, sizeof( ucRawValue ) ),
+                      eAzureIoTSuccess );
+    assert_int_equal( AzureIoTCBORWriter_AppendPropertyName( &xWriter, ucList, sizeof( ucList ) - 1 ), eAzureIoTSuccess );
+    assert_int_equal( AzureIoTCBORWriter_AppendBeginArray( &xWriter ), eAzureIoTSuccess );
+    assert_int_equal( AzureIoTCBORWriter_AppendInt32( &xWriter, -1 ), eAzureIoTSuccess );
+    assert_int_equal( AzureIoTCBORWriter_AppendNull( &xWriter ), eAzureIoTSuccess );
+    assert_int_equal( AzureIoTCBORWriter_AppendEndArray( &xWriter ), eAzureIoTSuccess );
+    assert_int_equal( AzureIoTCBORWriter_AppendEndObject( &xWriter ), eAzureIoTSuccess );
+
+    assert_int_equal( AzureIoTCBORWriter_GetBytesUsed( &xWriter ), sizeof( ucExpectedTelemetry ) );
+    assert_memory_equal( ucTestBuffer, ucExpectedTelemetry, sizeof( ucExpectedTelemetry ) );
+}
+/*-----------------------------------------------------------*/
+
+static void testAzureIoTCBORWriter_AppendDouble_Success( void ** ppvState )
+{
+    AzureIoTCBORWriter_t xWriter;
+    uint32_t ulIndex;
+
+    for( ulIndex = 0; ulIndex < sizeof( xTestDoubles ) / sizeof( xTestDoubles[ 0 ] ); ulIndex++ )
+    {
+        assert_int_equal( AzureIoTCBORWriter_Init( &xWriter, ucTestBuffer, sizeof( ucTestBuffer ) ), eAzureIoTSuccess );
+        assert_int_equal( AzureIoTCBORWriter_AppendDouble( &xWriter, xTestDoubles[ ulIndex ].xValue ), eAzureIoTSuccess );
+        assert_int_equal( AzureIoTCBORWriter_GetBytesUsed( &xWriter ), xTestDoubles[ ulIndex ].ulLength );
+        assert_memory_equal( ucTestBuffer, xTestDoubles[ ulIndex ].ucEncoded, xTestDoubles[ ulIndex ].ulLength );
+    }
+}
+/*-----------------------------------------------------------*/
+
+static void testAzureIoTCBORWriter_AppendInt32_Success( void ** ppvState )
+{
+    AzureIoTCBORWriter_t xWriter;
+    uint32_t ulIndex;
+
+    for( ulIndex = 0; ulIndex < sizeof( xTestInt32s ) / sizeof( xTestInt32s[ 0 ] ); ulIndex++ )
+    {
+        assert_int_equal( AzureIoTCBORWriter_Init( &xWriter, ucTestBuffer, sizeof( ucTestBuffer ) ), eAzureIoTSuccess );
+        assert_int_equal( AzureIoTCBORWriter_AppendInt32( &xWriter, xTestInt32s[ ulIndex ].lValue ), eAzureIoTSuccess );
+        assert_int_equal( AzureIoTCBORWriter_GetBytesUsed( &xWriter ), xTestInt32s[ ulIndex ].ulLength );
+        assert_memory_equal( ucTestBuffer, xTestInt32s[ ulIndex ].ucEncoded, xTestInt32s[ ulIndex ].ulLength );
+    }
+}
+/*-----------------------------------------------------------*/
+
+static void testAzureIoTCBORWriter_AppendString_Success( void ** ppvState )
+{
+    AzureIoTCBORWriter_t xWriter;
+    uint8_t ucLongString[ 100 ];
+
+    memset( ucLongString, 'a', sizeof( ucLongString ) );
+
+    /* Empty strings */
+    assert_int_equal( AzureIoTCBORWriter_Init( &xWriter, ucTestBuffer, sizeof( ucTestBuffer ) ), eAzureIoTSuccess );
+    assert_int_equal( AzureIoTCBORWriter_AppendBeginArray( &xWriter ), eAzureIoTSuccess );
+    assert_int_equal( AzureIoTCBORWriter_AppendString( &xWriter, NULL, 0 ), eAzureIoTSuccess );
+    assert_int_equal( AzureIoTCBORWriter_AppendBytes( &xWriter, NULL, 0 ), eAzureIoTSuccess );
+    assert_int_equal( AzureIoTCBORWriter_GetBytesUsed( &xWriter ), 3 );
+    assert_memory_equal( ucTestBuffer, "\x9F\x60\x40", 3 );
+
+    /* The length of longer strings in the following bytes */
+    assert_int_equal( AzureIoTCBORWriter_Init( &xWriter, ucTestBuffer, sizeof( ucTestBuffer ) ), eAzureIoTSuccess );
+    assert_int_equal( AzureIoTCBORWriter_AppendString( &xWriter, ucLongString, 100 ), eAzureIoTSuccess );
+    assert_int_equal( AzureIoTCBORWriter_GetBytesUsed( &xWriter ), 102 );
+    assert_memory_equal( ucTestBuffer, "\x78\x64" "aaaa", 6 );
+}
+/*-----------------------------------------------------------*/
+
+static void testAzureIoTCBORWriter_InvalidState_Failure( void ** ppvState )
+{
+    AzureIoTCBORWriter_t xWriter;
+    uint32_t ulIndex;
+
+    /* A property name outside of a map */
+    assert_int_equal( AzureIoTCBORWriter_Init( &xWriter, ucTestBuffer, sizeof( ucTestBuffer ) ), eAzureIoTSuccess );
+    assert_int_equal( AzureIoTCBORWriter_AppendPropertyName( &xWriter, ucOk, sizeof( ucOk ) - 1 ),
+                      eAzureIoTErrorJSONInvalidState );
+    assert_int_equal( AzureIoTCBORWriter_AppendBeginArray( &xWriter ), eAzureIoTSuccess );
+    assert_int_equal( AzureIoTCBORWriter_AppendPropertyWithInt32Value( &xWriter, ucCount, sizeof( ucCount ) - 1, 3 ),
+                      eAzureIoTErrorJSONInvalidState );
+    assert_int_equal( AzureIoTCBORWriter_AppendEndObject( &xWriter ), eAzureIoTErrorJSONInvalidState );
+    assert_int_equal( AzureIoTCBORWriter_AppendEndArray( &xWriter ), eAzureIoTSuccess );
+    assert_int_equal( AzureIoTCBORWriter_AppendEndArray( &xWriter ), eAzureIoTErrorJSONInvalidState );
+
+    /* A value without a property name, and a property name without a value */
+    assert_int_equal( AzureIoTCBORWriter_Init( &xWriter, ucTestBuffer, sizeof( ucTestBuffer ) ), eAzureIoTSuccess );
+    assert_int_equal( AzureIoTCBORWriter_AppendBeginObject( &xWriter ), eAzureIoTSuccess );
+    assert_int_equal( AzureIoTCBORWriter_AppendInt32( &xWriter, 1 ), eAzureIoTErrorJSONInvalidState );
+    assert_int_equal( AzureIoTCBORWriter_AppendBeginArray( &xWriter ), eAzureIoTErrorJSONInvalidState );
+    assert_int_equal( AzureIoTCBORWriter_AppendPropertyName( &xWriter, ucOk, sizeof( ucOk ) - 1 ), eAzureIoTSuccess );
+    assert_int_equal( AzureIoTCBORWriter_AppendPropertyName( &xWriter, ucOk, sizeof( ucOk ) - 1 ),
+                      eAzureIoTErrorJSONInvalidState );
+    assert_int_equal( AzureIoTCBORWriter_AppendPropertyWithBoolValue( &xWriter, ucOk, sizeof( ucOk ) - 1, true ),
+                      eAzureIoTErrorJSONInvalidState );
+    assert_int_equal( AzureIoTCBORWriter_AppendEndObject( &xWriter ), eAzureIoTErrorJSONInvalidState );
+    assert_int_equal( AzureIoTCBORWriter_AppendBool( &xWriter, false ), eAzureIoTSuccess );
+    assert_int_equal( AzureIoTCBORWriter_AppendEndArray( &xWriter ), eAzureIoTErrorJSONInvalidState );
+    assert_int_equal( AzureIoTCBORWriter_AppendEndObject( &xWriter ), eAzureIoTSuccess );
+    assert_int_equal( AzureIoTCBORWriter_GetBytesUsed( &xWriter ), 6 );
+    assert_memory_equal( ucTestBuffer, "\xBF\x62ok\xF4\xFF", 6 );
+
+    /* Too deep */
+    assert_int_equal( AzureIoTCBORWriter_Init( &xWriter, ucTestBuffer, sizeof( ucTestBuffer ) ), eAzureIoTSuccess );
+
+    for( ulIndex = 0; ulIndex < 32; ulIndex++ )
+    {
+        assert_int_equal( AzureIoTCBORWriter_AppendBeginArray( &xWriter ), eAzureIoTSuccess );
+    }
+
+    assert_int_equal( AzureIoTCBORWriter_AppendBeginArray( &xWriter ), eAzureIoTErrorJSONNestingOverflow );
+}
+/*-----------------------------------------------------------*/
+
+static void testAzureIoTCBORWriter_OutOfMemory_Failure( void ** ppvState )
+{
+    AzureIoTCBORWriter_t xWriter;
+
+    /* {_ "ok": true } takes 6 bytes */
+    assert_int_equal( AzureIoTCBORWriter_Init( &xWriter, ucTestBuffer, 5 ), eAzureIoTSuccess );
+    assert_int_equal( AzureIoTCBORWriter_AppendBeginObject( &xWriter ), eAzureIoTSuccess );
+
+    /* The name is not left alone when the value does not fit */
+    assert_int_equal( AzureIoTCBORWriter_AppendPropertyWithDoubleValue( &xWriter, ucOk, sizeof( ucOk ) - 1, 1.0 ),
+                      eAzureIoTErrorOutOfMemory );
+    assert_int_equal( AzureIoTCBORWriter_GetBytesUsed( &xWriter ), 1 );
+    assert_int_equal( AzureIoTCBORWriter_AppendPropertyWithBoolValue( &xWriter, ucOk, sizeof( ucOk ) - 1, true ),
+                      eAzureIoTSuccess );
+    assert_int_equal( AzureIoTCBORWriter_AppendEndObject( &xWriter ), eAzureIoTErrorOutOfMemory );
+    assert_int_equal( AzureIoTCBORWriter_GetBytesUsed( &xWriter ), 5 );
+
+    /* Strings are not written in part */
+    assert_int_equal( AzureIoTCBORWriter_Init( &xWriter, ucTestBuffer, 4 ), eAzureIoTSuccess );
+    assert_int_equal( AzureIoTCBORWriter_AppendString( &xWriter, ucIdle, sizeof( ucIdle ) - 1 ), eAzureIoTErrorOutOfMemory );
+    assert_int_equal( AzureIoTCBORWriter_GetBytesUsed( &xWriter ), 0 );
+}
+/*-----------------------------------------------------------*/
+
+uint32_t ulGetAllTests()
+{
+    const struct CMUnitTest tests[] =
+    {
+        cmocka_unit_test( testAzureIoTCBORWriter_Init_Failure ),
+        cmocka_unit_test( testAzureIoTCBORWriter_Telemetry_Success ),
+        cmocka_unit_test( testAzureIoTCBORWriter_AppendDouble_Success ),
+        cmocka_unit_test( testAzureIoTCBORWriter_AppendInt32_Success ),
+        cmocka_unit_test( testAzureIoTCBORWriter_AppendString_Success ),
+        cmocka_unit_test( testAzureIoTCBORWriter_InvalidState_Failure ),
+        cmocka_unit_test( testAzureIoTCBORWriter_OutOfMemory_Failure )
+    };
+
+    return ( uint32_t ) cmocka_run_group_tests_name( "azure_iot_cbor_writer_ut", tests, NULL, NULL );
+}
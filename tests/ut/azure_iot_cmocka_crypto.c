@@ -0,0 +1,81 @@
+/* Copyright (c) Microsoft Corporation.
+ * Licensed under the MIT License. */
+
+/**
+ * @file azure_iot_cmocka_crypto.c
+ * @brief Unit test dummy crypto port.
+ *
+ * The "SHA256" is an order dependent checksum, so that incremental and
+ * one shot calculations over the same bytes give the same result.
+ *
+ */
+
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <setjmp.h>
+
+#include <cmocka.h>
+
+#include "azure_iot_crypto.h"
+/*-----------------------------------------------------------*/
+
+AzureIoTResult_t AzureIoTCrypto_SHA256Calculate( const char * pucInputPtr,
+                                                 uint64_t ulInputSize,
+                                                 const char * pucOutputPtr,
+                                                 uint64_t ulOutputSize )
+{
+    AzureIoTCryptoSHA256Context_t xContext;
+
+    ( void ) AzureIoTCrypto_SHA256Init( &xContext );
+    ( void ) AzureIoTCrypto_SHA256Update( &xContext, ( const uint8_t * ) pucInputPtr, ( uint32_t ) ulInputSize );
+
+    return AzureIoTCrypto_SHA256Final( &xContext, ( uint8_t * ) pucOutputPtr, ( uint32_t ) ulOutputSize );
+}
+/*-----------------------------------------------------------*/
+
+AzureIoTResult_t AzureIoTCrypto_SHA256Init( AzureIoTCryptoSHA256Context_t * pxContext )
+{
+    pxContext->ulState = 2166136261U;
+    pxContext->ulLength = 0;
+
+    return eAzureIoTSuccess;
+}
+/*-----------------------------------------------------------*/
+
+AzureIoTResult_t AzureIoTCrypto_SHA256Update( AzureIoTCryptoSHA256Context_t * pxContext,
+                                              const uint8_t * pucInput,
+                                              uint32_t ulInputSize )
+{
+    uint32_t ulIndex;
+
+    for( ulIndex = 0; ulIndex < ulInputSize; ulIndex++ )
+    {
+        pxContext->ulState = ( pxContext->ulState ^ pucInput[ ulIndex ] ) * 16777619U;
+    }
+
+    pxContext->ulLength += ulInputSize;
+
+    return eAzureIoTSuccess;
+}
+/*-----------------------------------------------------------*/
+
+AzureIoTResult_t AzureIoTCrypto_SHA256Final( AzureIoTCryptoSHA256Context_t * pxContext,
+                                             uint8_t * pucOutput,
+                                             uint32_t ulOutputSize )
+{
+    uint32_t ulIndex;
+
+    assert_true( ulOutputSize >= azureiotcryptoSHA256_SIZE );
+
+    for( ulIndex = 0; ulIndex < azureiotcryptoSHA256_SIZE; ulIndex++ )
+    {
+        pucOutput[ ulIndex ] = ( uint8_t ) ( ( pxContext->ulState >> ( 8 * ( ulIndex % 4 ) ) ) + pxContext->ulLength + ulIndex );
+    }
+
+    return eAzureIoTSuccess;
+}
+/*-----------------------------------------------------------*/
@@ -0,0 +1,196 @@
+/* Copyright (c) Microsoft Corporation.
+ * Licensed under the MIT License. */
+
+/**
+ * @file azure_iot_cmocka_flash_platform.c
+ * @brief Unit test dummy flash platform port.
+ *
+ * Blocks are written to the RAM array #ucTestFlash, checkpoints to #ucTestCheckpoint.
+ * The running image is read from #ucTestActiveFlash. Writes that are not whole program pages, or
+ * that cross an erase sector, are counted.
+ *
+ */
+
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <setjmp.h>
+
+#include <cmocka.h>
+
+#include "azure_iot_flash_platform.h"
+/*-----------------------------------------------------------*/
+
+#define testFLASH_SIZE    ( 64 * 1024 )
+/*-----------------------------------------------------------*/
+
+uint8_t ucTestFlash[ testFLASH_SIZE ];
+uint8_t ucTestActiveFlash[ testFLASH_SIZE ];
+uint32_t ulTestFlashWriteCount = 0;
+uint32_t ulTestFlashPageSize = 1;
+uint32_t ulTestFlashSectorSize = 1;
+uint32_t ulTestFlashUnalignedWriteCount = 0;
+uint32_t ulTestFlashSectorCrossingCount = 0;
+uint8_t ucTestCheckpoint[ 256 ];
+uint32_t ulTestCheckpointLength = 0;
+uint32_t ulTestCheckpointSaveCount = 0;
+/*-----------------------------------------------------------*/
+
+AzureIoTResult_t AzureIoTPlatform_Init( AzureADUImage_t * const pxAduImage )
+{
+    ( void ) pxAduImage;
+
+    memset( ucTestFlash, 0xFF, sizeof( ucTestFlash ) );
+    ulTestFlashWriteCount = 0;
+    ulTestFlashUnalignedWriteCount = 0;
+    ulTestFlashSectorCrossingCount = 0;
+
+    return ( AzureIoTResult_t ) mock();
+}
+/*-----------------------------------------------------------*/
+
+int64_t AzureIoTPlatform_GetSingleFlashBootBankSize()
+{
+    return ( int64_t ) sizeof( ucTestFlash );
+}
+/*-----------------------------------------------------------*/
+
+uint32_t AzureIoTPlatform_GetProgramPageSize( AzureADUImage_t * const pxAduImage )
+{
+    ( void ) pxAduImage;
+
+    return ulTestFlashPageSize;
+}
+/*-----------------------------------------------------------*/
+
+uint32_t AzureIoTPlatform_GetEraseSectorSize( AzureADUImage_t * const pxAduImage )
+{
+    ( void ) pxAduImage;
+
+    return ulTestFlashSectorSize;
+}
+/*-----------------------------------------------------------*/
+
+AzureIoTResult_t AzureIoTPlatform_WriteBlock( AzureADUImage_t * const pxAduImage,
+                                              uint32_t ulOffset,
+                                              uint8_t * const pData,
+                                              uint32_t ulBlockSize )
+{
+    AzureIoTResult_t xReturn = ( AzureIoTResult_t ) mock();
+
+    ( void ) pxAduImage;
+
+    if( xReturn != eAzureIoTSuccess )
+    {
+        return xReturn;
+    }
+
+    assert_true( ( ulOffset + ulBlockSize ) <= sizeof( ucTestFlash ) );
+    memcpy( ucTestFlash + ulOffset, pData, ulBlockSize );
+    ulTestFlashWriteCount++;
+
+    if( ( ( ulOffset % ulTestFlashPageSize ) != 0 ) || ( ( ulBlockSize % ulTestFlashPageSize ) != 0 ) )
+    {
+        ulTestFlashUnalignedWriteCount++;
+    }
+
+    if( ( ulBlockSize > 0 ) && ( ( ulOffset / ulTestFlashSectorSize ) != ( ( ulOffset + ulBlockSize - 1 ) / ulTestFlashSectorSize ) ) )
+    {
+        ulTestFlashSectorCrossingCount++;
+    }
+
+    return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+AzureIoTResult_t AzureIoTPlatform_ReadActiveBlock( AzureADUImage_t * const pxAduImage,
+                                                   uint32_t ulOffset,
+                                                   uint8_t * const pData,
+                                                   uint32_t ulBlockSize )
+{
+    AzureIoTResult_t xReturn = ( AzureIoTResult_t ) mock();
+
+    ( void ) pxAduImage;
+
+    if( xReturn != eAzureIoTSuccess )
+    {
+        return xReturn;
+    }
+
+    assert_true( ( ulOffset + ulBlockSize ) <= sizeof( ucTestActiveFlash ) );
+    memcpy( pData, ucTestActiveFlash + ulOffset, ulBlockSize );
+
+    return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+AzureIoTResult_t AzureIoTPlatform_VerifyImage( AzureADUImage_t * const pxAduImage,
+                                               uint8_t * pucSHA256Hash,
+                                               uint32_t ulSHA256HashLength )
+{
+    ( void ) pxAduImage;
+    ( void ) pucSHA256Hash;
+    ( void ) ulSHA256HashLength;
+
+    return ( AzureIoTResult_t ) mock();
+}
+/*-----------------------------------------------------------*/
+
+AzureIoTResult_t AzureIoTPlatform_SaveCheckpoint( AzureADUImage_t * const pxAduImage,
+                                                  const uint8_t * pucCheckpoint,
+                                                  uint32_t ulCheckpointLength )
+{
+    AzureIoTResult_t xReturn = ( AzureIoTResult_t ) mock();
+
+    ( void ) pxAduImage;
+
+    if( xReturn != eAzureIoTSuccess )
+    {
+        return xReturn;
+    }
+
+    assert_true( ulCheckpointLength <= sizeof( ucTestCheckpoint ) );
+    memcpy( ucTestCheckpoint, pucCheckpoint, ulCheckpointLength );
+    ulTestCheckpointLength = ulCheckpointLength;
+    ulTestCheckpointSaveCount++;
+
+    return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+AzureIoTResult_t AzureIoTPlatform_LoadCheckpoint( AzureADUImage_t * const pxAduImage,
+                                                  uint8_t * pucCheckpoint,
+                                                  uint32_t ulCheckpointLength )
+{
+    ( void ) pxAduImage;
+
+    if( ulTestCheckpointLength == 0 )
+    {
+        return eAzureIoTErrorItemNotFound;
+    }
+
+    assert_int_equal( ulCheckpointLength, ulTestCheckpointLength );
+    memcpy( pucCheckpoint, ucTestCheckpoint, ulCheckpointLength );
+
+    return eAzureIoTSuccess;
+}
+/*-----------------------------------------------------------*/
+
+AzureIoTResult_t AzureIoTPlatform_EnableImage( AzureADUImage_t * const pxAduImage )
+{
+    ( void ) pxAduImage;
+
+    return ( AzureIoTResult_t ) mock();
+}
+/*-----------------------------------------------------------*/
+
+AzureIoTResult_t AzureIoTPlatform_ResetDevice( AzureADUImage_t * const pxAduImage )
+{
+    ( void ) pxAduImage;
+
+    return ( AzureIoTResult_t ) mock();
+}
+/*-----------------------------------------------------------*/
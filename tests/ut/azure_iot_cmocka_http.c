@@ -0,0 +1,301 @@
+/* Copyright (c) Microsoft Corporation.
+ * Licensed under the MIT License. */
+
+/**
+ * @file azure_iot_cmocka_http.c
+ * @brief Unit test dummy HTTP port.
+ *
+ * Range requests are served from #pucTestHTTPFile. Streamed requests pass the body to the callback
+ * through the data buffer, one buffer at a time; a failing streamed request first passes
+ * #ulTestHTTPStreamFailLength bytes. A streamed request for the range set with AzureIoTHTTP_SetNextRange()
+ * is pipelined, and does not pay the round trip of the simulated link. AzureIoTHTTP_InitConnection()
+ * keeps its arguments in #pxTestHTTPTransport, #xTestHTTPConnect and #pvTestHTTPConnectContext.
+ *
+ * When #ulTestHTTPBytesPerMs is set, requests are run over a simulated link: each one
+ * adds its round trip and transfer time to #ulTestHTTPSimulatedMs, and fails after
+ * #ulTestHTTPTimeoutMs with a probability proportional to its length.
+ *
+ */
+
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <setjmp.h>
+
+#include <cmocka.h>
+
+#include "azure_iot_http.h"
+/*-----------------------------------------------------------*/
+
+/* Simulated size of the response headers placed before the body */
+#define testHTTP_RESPONSE_HEADER_LENGTH    ( 64 )
+/*-----------------------------------------------------------*/
+
+const uint8_t * pucTestHTTPFile = NULL;
+uint32_t ulTestHTTPFileLength = 0;
+uint32_t ulTestHTTPMaxBodyLength = 0;
+int32_t lTestHTTPLastRangeStart = -1;
+int32_t lTestHTTPLastRangeEnd = -1;
+uint32_t ulTestHTTPStreamFailLength = 0;
+uint32_t ulTestHTTPStreamFragmentCount = 0;
+uint32_t ulTestHTTPPipelinedCount = 0;
+int32_t lTestHTTPNextRangeStart = -1;
+int32_t lTestHTTPNextRangeEnd = -1;
+AzureIoTTransportInterface_t * pxTestHTTPTransport = NULL;
+AzureIoTTransportConnect_t xTestHTTPConnect = NULL;
+void * pvTestHTTPConnectContext = NULL;
+static int32_t lTestHTTPPipelinedRangeStart = -1;
+static int32_t lTestHTTPPipelinedRangeEnd = -1;
+
+uint32_t ulTestHTTPBytesPerMs = 0;
+uint32_t ulTestHTTPRoundTripMs = 0;
+uint32_t ulTestHTTPTimeoutMs = 0;
+uint32_t ulTestHTTPLossPerMillionBytes = 0;
+uint32_t ulTestHTTPSimulatedMs = 0;
+uint32_t ulTestHTTPRandomSeed = 1;
+/*-----------------------------------------------------------*/
+
+static bool prvSimulateLink( uint32_t ulLength,
+                             bool xPipelined )
+{
+    ulTestHTTPRandomSeed = ulTestHTTPRandomSeed * 1103515245U + 12345U;
+
+    if( ( ( ulTestHTTPRandomSeed >> 8 ) % 1000000U ) < ( ulLength * ulTestHTTPLossPerMillionBytes ) )
+    {
+        ulTestHTTPSimulatedMs += ulTestHTTPTimeoutMs;
+        return false;
+    }
+
+    ulTestHTTPSimulatedMs += ( xPipelined ? 0 : ulTestHTTPRoundTripMs ) + ulLength / ulTestHTTPBytesPerMs;
+
+    return true;
+}
+/*-----------------------------------------------------------*/
+
+AzureIoTHTTPResult_t AzureIoTHTTP_InitConnection( AzureIoTHTTPHandle_t xHTTPHandle,
+                                                  AzureIoTTransportInterface_t * pxHTTPTransport,
+                                                  AzureIoTTransportConnect_t xConnect,
+                                                  void * pvConnectContext )
+{
+    if( ( xHTTPHandle == NULL ) || ( pxHTTPTransport == NULL ) )
+    {
+        return eAzureIoTHTTPInvalidParameter;
+    }
+
+    pxTestHTTPTransport = pxHTTPTransport;
+    xTestHTTPConnect = xConnect;
+    pvTestHTTPConnectContext = pvConnectContext;
+
+    return eAzureIoTHTTPSuccess;
+}
+/*-----------------------------------------------------------*/
+
+AzureIoTHTTPResult_t AzureIoTHTTP_Init( AzureIoTHTTPHandle_t xHTTPHandle,
+                                        AzureIoTTransportInterface_t * pxHTTPTransport,
+                                        const char * pucURL,
+                                        uint32_t ulURLLength,
+                                        const char * pucPath,
+                                        uint32_t ulPathLength,
+                                        char * pucHeaderBuffer,
+                                        uint32_t ulHeaderBufferLength )
+{
+    ( void ) xHTTPHandle;
+    ( void ) pxHTTPTransport;
+    ( void ) pucURL;
+    ( void ) ulURLLength;
+    ( void ) pucPath;
+    ( void ) ulPathLength;
+    ( void ) pucHeaderBuffer;
+    ( void ) ulHeaderBufferLength;
+
+    return eAzureIoTHTTPSuccess;
+}
+/*-----------------------------------------------------------*/
+
+AzureIoTHTTPResult_t AzureIoTHTTP_InitNextRequest( AzureIoTHTTPHandle_t xHTTPHandle )
+{
+    ( void ) xHTTPHandle;
+
+    return ( AzureIoTHTTPResult_t ) mock();
+}
+/*-----------------------------------------------------------*/
+
+AzureIoTHTTPResult_t AzureIoTHTTP_Request( AzureIoTHTTPHandle_t xHTTPHandle,
+                                           int32_t lRangeStart,
+                                           int32_t lRangeEnd,
+                                           char * pucDataBuffer,
+                                           uint32_t ulDataBufferLength,
+                                           char ** ppucOutData,
+                                           uint32_t * pulOutDataLength )
+{
+    AzureIoTHTTPResult_t xReturn = ( AzureIoTHTTPResult_t ) mock();
+    uint32_t ulLength;
+
+    ( void ) xHTTPHandle;
+
+    lTestHTTPLastRangeStart = lRangeStart;
+    lTestHTTPLastRangeEnd = lRangeEnd;
+
+    if( xReturn != eAzureIoTHTTPSuccess )
+    {
+        return xReturn;
+    }
+
+    assert_non_null( pucTestHTTPFile );
+    assert_true( lRangeStart <= lRangeEnd );
+    assert_true( ( uint32_t ) lRangeEnd < ulTestHTTPFileLength );
+
+    ulLength = ( uint32_t ) ( lRangeEnd - lRangeStart + 1 );
+
+    if( ( ulTestHTTPMaxBodyLength != 0 ) && ( ulLength > ulTestHTTPMaxBodyLength ) )
+    {
+        ulLength = ulTestHTTPMaxBodyLength;
+    }
+
+    if( ( ulTestHTTPBytesPerMs != 0 ) && !prvSimulateLink( ulLength, false ) )
+    {
+        return eAzureIoTHTTPNetworkError;
+    }
+
+    assert_true( ( ulLength + testHTTP_RESPONSE_HEADER_LENGTH ) <= ulDataBufferLength );
+
+    memset( pucDataBuffer, 0, testHTTP_RESPONSE_HEADER_LENGTH );
+    memcpy( pucDataBuffer + testHTTP_RESPONSE_HEADER_LENGTH, pucTestHTTPFile + lRangeStart, ulLength );
+
+    *ppucOutData = pucDataBuffer + testHTTP_RESPONSE_HEADER_LENGTH;
+    *pulOutDataLength = ulLength;
+
+    return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+AzureIoTHTTPResult_t AzureIoTHTTP_SetNextRange( AzureIoTHTTPHandle_t xHTTPHandle,
+                                                int32_t lRangeStart,
+                                                int32_t lRangeEnd )
+{
+    ( void ) xHTTPHandle;
+
+    lTestHTTPNextRangeStart = lRangeStart;
+    lTestHTTPNextRangeEnd = lRangeEnd;
+
+    return eAzureIoTHTTPSuccess;
+}
+/*-----------------------------------------------------------*/
+
+AzureIoTHTTPResult_t AzureIoTHTTP_RequestStream( AzureIoTHTTPHandle_t xHTTPHandle,
+                                                 int32_t lRangeStart,
+                                                 int32_t lRangeEnd,
+                                                 char * pucDataBuffer,
+                                                 uint32_t ulDataBufferLength,
+                                                 AzureIoTHTTPBodyCallback_t xBodyCallback,
+                                                 void * pvCallbackContext,
+                                                 uint32_t * pulOutDataLength )
+{
+    AzureIoTHTTPResult_t xReturn = ( AzureIoTHTTPResult_t ) mock();
+    AzureIoTHTTPResult_t xResult;
+    uint32_t ulLength;
+    uint32_t ulOffset = 0;
+    uint32_t ulFragment;
+    bool xPipelined = ( lRangeStart == lTestHTTPPipelinedRangeStart ) && ( lRangeEnd == lTestHTTPPipelinedRangeEnd );
+
+    ( void ) xHTTPHandle;
+
+    lTestHTTPLastRangeStart = lRangeStart;
+    lTestHTTPLastRangeEnd = lRangeEnd;
+
+    /* The next range is requested while this one is received. */
+    lTestHTTPPipelinedRangeStart = lTestHTTPNextRangeStart;
+    lTestHTTPPipelinedRangeEnd = lTestHTTPNextRangeEnd;
+    lTestHTTPNextRangeStart = -1;
+    lTestHTTPNextRangeEnd = -1;
+    *pulOutDataLength = 0;
+
+    if( xPipelined )
+    {
+        ulTestHTTPPipelinedCount++;
+    }
+
+    assert_non_null( pucTestHTTPFile );
+    assert_non_null( xBodyCallback );
+    assert_true( lRangeStart <= lRangeEnd );
+    assert_true( ( uint32_t ) lRangeEnd < ulTestHTTPFileLength );
+    assert_true( ulDataBufferLength > testHTTP_RESPONSE_HEADER_LENGTH );
+
+    ulLength = ( uint32_t ) ( lRangeEnd - lRangeStart + 1 );
+
+    if( xReturn != eAzureIoTHTTPSuccess )
+    {
+        ulLength = ( ulTestHTTPStreamFailLength < ulLength ) ? ulTestHTTPStreamFailLength : ulLength;
+    }
+    else if( ( ulTestHTTPBytesPerMs != 0 ) && !prvSimulateLink( ulLength, xPipelined ) )
+    {
+        return eAzureIoTHTTPNetworkError;
+    }
+
+    while( ulOffset < ulLength )
+    {
+        /* The first fragment shares the buffer with the response headers. */
+        ulFragment = ulDataBufferLength - ( ( ulOffset == 0 ) ? testHTTP_RESPONSE_HEADER_LENGTH : 0 );
+        ulFragment = ( ( ulLength - ulOffset ) < ulFragment ) ? ( ulLength - ulOffset ) : ulFragment;
+
+        memcpy( pucDataBuffer, pucTestHTTPFile + lRangeStart + ulOffset, ulFragment );
+        ulTestHTTPStreamFragmentCount++;
+
+        if( ( xResult = xBodyCallback( pvCallbackContext, ( const uint8_t * ) pucDataBuffer, ulFragment ) ) != eAzureIoTHTTPSuccess )
+        {
+            return xResult;
+        }
+
+        ulOffset += ulFragment;
+        *pulOutDataLength = ulOffset;
+    }
+
+    return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+AzureIoTHTTPResult_t AzureIoTHTTP_RequestSizeInit( AzureIoTHTTPHandle_t xHTTPHandle,
+                                                   AzureIoTTransportInterface_t * pxHTTPTransport,
+                                                   const char * pucURL,
+                                                   uint32_t ulURLLength,
+                                                   const char * pucPath,
+                                                   uint32_t ulPathLength,
+                                                   char * pucHeaderBuffer,
+                                                   uint32_t ulHeaderBufferLength )
+{
+    ( void ) xHTTPHandle;
+    ( void ) pxHTTPTransport;
+    ( void ) pucURL;
+    ( void ) ulURLLength;
+    ( void ) pucPath;
+    ( void ) ulPathLength;
+    ( void ) pucHeaderBuffer;
+    ( void ) ulHeaderBufferLength;
+
+    return ( AzureIoTHTTPResult_t ) mock();
+}
+/*-----------------------------------------------------------*/
+
+int32_t AzureIoTHTTP_RequestSize( AzureIoTHTTPHandle_t xHTTPHandle,
+                                  char * pucDataBuffer,
+                                  uint32_t ulDataBufferLength )
+{
+    ( void ) xHTTPHandle;
+    ( void ) pucDataBuffer;
+    ( void ) ulDataBufferLength;
+
+    return ( int32_t ) mock();
+}
+/*-----------------------------------------------------------*/
+
+AzureIoTHTTPResult_t AzureIoTHTTP_Deinit( AzureIoTHTTPHandle_t xHTTPHandle )
+{
+    ( void ) xHTTPHandle;
+
+    return ( AzureIoTHTTPResult_t ) mock();
+}
+/*-----------------------------------------------------------*/
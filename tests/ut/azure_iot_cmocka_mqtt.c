@@ -25,8 +25,11 @@ AzureIoTMQTTPacketInfo_t xPacketInfo;
 AzureIoTMQTTDeserializedInfo_t xDeserializedInfo;
 uint16_t usTestPacketId = 1;
 const uint8_t * pucPublishPayload = NULL;
+size_t xPublishStreamLength = 0;
+size_t xPublishStreamBytesSent = 0;
 uint16_t usSentQOS = 0xFF;
 uint32_t ulDelayReceivePacket = 0;
+void ( * pxTestMQTTProcessLoopHook )( uint32_t ulMilliseconds ) = NULL;
 /*-----------------------------------------------------------*/
 
 AzureIoTMQTTResult_t AzureIoTMQTT_Init( AzureIoTMQTTHandle_t xContext,
@@ -107,6 +110,52 @@ AzureIoTMQTTResult_t AzureIoTMQTT_Publish( AzureIoTMQTTHandle_t xContext,
 }
 /*-----------------------------------------------------------*/
 
+AzureIoTMQTTResult_t AzureIoTMQTT_PublishHeader( AzureIoTMQTTHandle_t xContext,
+                                                 const AzureIoTMQTTPublishInfo_t * pxPublishInfo )
+{
+    ( void ) xContext;
+
+    AzureIoTMQTTResult_t xReturn = ( AzureIoTMQTTResult_t ) mock();
+
+    if( xReturn )
+    {
+        return xReturn;
+    }
+
+    assert_int_equal( pxPublishInfo->xQOS, eAzureIoTMQTTQoS0 );
+    xPublishStreamLength = pxPublishInfo->xPayloadLength;
+    xPublishStreamBytesSent = 0;
+
+    return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+AzureIoTMQTTResult_t AzureIoTMQTT_PublishPayload( AzureIoTMQTTHandle_t xContext,
+                                                  const uint8_t * pucPayload,
+                                                  size_t xPayloadLength )
+{
+    ( void ) xContext;
+
+    AzureIoTMQTTResult_t xReturn = ( AzureIoTMQTTResult_t ) mock();
+
+    if( xReturn )
+    {
+        return xReturn;
+    }
+
+    assert_true( xPublishStreamBytesSent + xPayloadLength <= xPublishStreamLength );
+
+    if( pucPublishPayload )
+    {
+        assert_memory_equal( pucPayload, pucPublishPayload + xPublishStreamBytesSent, xPayloadLength );
+    }
+
+    xPublishStreamBytesSent += xPayloadLength;
+
+    return xReturn;
+}
+/*-----------------------------------------------------------*/
+
 AzureIoTMQTTResult_t AzureIoTMQTT_Unsubscribe( AzureIoTMQTTHandle_t xContext,
                                                const AzureIoTMQTTSubscribeInfo_t * pxSubscriptionList,
                                                size_t xSubscriptionCount,
@@ -137,6 +186,11 @@ AzureIoTMQTTResult_t AzureIoTMQTT_ProcessLoop( AzureIoTMQTTHandle_t xContext,
 
     AzureIoTMQTTResult_t xReturn = ( AzureIoTMQTTResult_t ) mock();
 
+    if( pxTestMQTTProcessLoopHook != NULL )
+    {
+        pxTestMQTTProcessLoopHook( ulMilliseconds );
+    }
+
     if( xReturn )
     {
         return xReturn;
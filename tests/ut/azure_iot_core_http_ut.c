@@ -0,0 +1,641 @@
+/* Copyright (c) Microsoft Corporation.
+ * Licensed under the MIT License. */
+
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <setjmp.h>
+
+#include <cmocka.h>
+
+#include "azure_iot_http.h"
+
+#include "FreeRTOS.h"
+#include "task.h"
+/*-----------------------------------------------------------*/
+
+#define testFILE_SIZE      ( 1000 )
+#define testBUFFER_SIZE    ( 256 )
+/*-----------------------------------------------------------*/
+
+static const char ucTestHost[] = "contoso.blob.core.windows.net";
+static const char ucTestPath[] = "/firmware.bin";
+
+static uint8_t ucTestFile[ testFILE_SIZE ];
+static char ucTestHeaderBuffer[ 512 ];
+static char ucTestBuffer[ testBUFFER_SIZE ];
+static uint8_t ucTestBody[ testFILE_SIZE ];
+static uint32_t ulTestBodyLength;
+
+/* The fake server answers each request received on the fake transport, until it closes the connection:
+ * after ulTestCloseAfterResponses responses, announced with Connection: close, or without a word on
+ * the next ulTestDropRequests requests. */
+static char ucTestRequest[ 512 ];
+static uint32_t ulTestRequestLength;
+static char ucTestResponse[ 4 * testFILE_SIZE ];
+static uint32_t ulTestResponseLength;
+static uint32_t ulTestResponseOffset;
+static const char * pcTestResponse;
+static uint32_t ulTestRecvStep;
+static uint32_t ulTestRequestCount;
+static bool xTestRecvStalls;
+static bool xTestClosed;
+static uint32_t ulTestCloseAfterResponses;
+static uint32_t ulTestDropRequests;
+static uint32_t ulTestConnectCount;
+static int32_t lTestConnectResult;
+static TickType_t xTestTickCount;
+static uint32_t ulTestDelayCount;
+
+static AzureIoTHTTP_t xTestHTTP;
+static AzureIoTTransportInterface_t xTestTransport;
+/*-----------------------------------------------------------*/
+
+TickType_t xTaskGetTickCount( void );
+void vTaskDelay( const TickType_t xTicksToDelay );
+uint32_t ulGetAllTests();
+/*-----------------------------------------------------------*/
+
+TickType_t xTaskGetTickCount( void )
+{
+    return xTestTickCount++;
+}
+/*-----------------------------------------------------------*/
+
+void vTaskDelay( const TickType_t xTicksToDelay )
+{
+    assert_true( xTicksToDelay > 0 );
+    xTestTickCount += xTicksToDelay;
+    ulTestDelayCount++;
+}
+/*-----------------------------------------------------------*/
+
+/* Queue the response to the request in ucTestRequest: pcTestResponse as is, or the range asked for. */
+static void prvTestServe( void )
+{
+    const char * pcRange = strstr( ucTestRequest, "Range: bytes=" );
+    int lFirst = 0;
+    int lLast = testFILE_SIZE - 1;
+
+    ulTestRequestCount++;
+
+    if( ulTestDropRequests > 0 )
+    {
+        ulTestDropRequests--;
+        xTestClosed = true;
+        return;
+    }
+
+    if( pcTestResponse != NULL )
+    {
+        ulTestResponseLength += ( uint32_t ) sprintf( ucTestResponse + ulTestResponseLength, "%s", pcTestResponse );
+        return;
+    }
+
+    if( pcRange == NULL )
+    {
+        ulTestResponseLength += ( uint32_t ) sprintf( ucTestResponse + ulTestResponseLength,
+                                                      "HTTP/1.1 200 OK\r\nContent-Length: %d\r\n\r\n", testFILE_SIZE );
+    }
+    else
+    {
+        ( void ) sscanf( pcRange, "Range: bytes=%d-%d", &lFirst, &lLast );
+        lLast = ( lLast < testFILE_SIZE ) ? lLast : ( testFILE_SIZE - 1 );
+        ulTestResponseLength += ( uint32_t ) sprintf( ucTestResponse + ulTestResponseLength,
+                                                      "HTTP/1.1 206 Partial Content\r\ncontent-range: bytes %d-%d/%d\r\n"
+                                                      "content-length: %d\r\n%s\r\n",
+                                                      lFirst, lLast, testFILE_SIZE, lLast - lFirst + 1,
+                                                      ( ulTestCloseAfterResponses == 1 ) ? "Connection: close\r\n" : "" );
+    }
+
+    if( ( ulTestCloseAfterResponses > 0 ) && ( --ulTestCloseAfterResponses == 0 ) )
+    {
+        xTestClosed = true;
+    }
+
+    memcpy( ucTestResponse + ulTestResponseLength, ucTestFile + lFirst, ( size_t ) ( lLast - lFirst + 1 ) );
+    ulTestResponseLength += ( uint32_t ) ( lLast - lFirst + 1 );
+}
+/*-----------------------------------------------------------*/
+
+static int32_t prvTestSend( void * pxNetworkContext,
+                            const void * pvBuffer,
+                            size_t xBytesToSend )
+{
+    ( void ) pxNetworkContext;
+
+    if( xTestClosed )
+    {
+        return -1;
+    }
+
+    memcpy( ucTestRequest + ulTestRequestLength, pvBuffer, xBytesToSend );
+    ulTestRequestLength += ( uint32_t ) xBytesToSend;
+    ucTestRequest[ ulTestRequestLength ] = '\0';
+
+    if( strstr( ucTestRequest, "\r\n\r\n" ) != NULL )
+    {
+        prvTestServe();
+        ulTestRequestLength = 0;
+    }
+
+    return ( int32_t ) xBytesToSend;
+}
+/*-----------------------------------------------------------*/
+
+/* Returns at most ulTestRecvStep bytes at a time, then nothing once the response is all read, or -1 if closed. */
+static int32_t prvTestRecv( void * pxNetworkContext,
+                            void * pvBuffer,
+                            size_t xBytesToRecv )
+{
+    uint32_t ulLength = ulTestResponseLength - ulTestResponseOffset;
+
+    ( void ) pxNetworkContext;
+
+    if( xTestRecvStalls )
+    {
+        return 0;
+    }
+
+    if( ( ulLength == 0 ) && xTestClosed )
+    {
+        return -1;
+    }
+
+    ulLength = ( ulLength < ulTestRecvStep ) ? ulLength : ulTestRecvStep;
+    ulLength = ( ulLength < xBytesToRecv ) ? ulLength : ( uint32_t ) xBytesToRecv;
+    memcpy( pvBuffer, ucTestResponse + ulTestResponseOffset, ulLength );
+    ulTestResponseOffset += ulLength;
+
+    return ( int32_t ) ulLength;
+}
+/*-----------------------------------------------------------*/
+
+/* Opens a new connection to the fake server. */
+static int32_t prvTestConnect( void * pvConnectContext,
+                               AzureIoTTransportInterface_t * pxTransport )
+{
+    assert_ptr_equal( pvConnectContext, &ulTestConnectCount );
+    assert_ptr_equal( pxTransport, &xTestTransport );
+
+    ulTestConnectCount++;
+
+    if( lTestConnectResult == 0 )
+    {
+        xTestClosed = false;
+        ulTestRequestLength = 0;
+        ulTestResponseLength = 0;
+        ulTestResponseOffset = 0;
+    }
+
+    return lTestConnectResult;
+}
+/*-----------------------------------------------------------*/
+
+static AzureIoTHTTPResult_t prvTestBodyCallback( void * pvCallbackContext,
+                                                 const uint8_t * pucData,
+                                                 uint32_t ulDataLength )
+{
+    ( void ) pvCallbackContext;
+
+    assert_true( ( ulTestBodyLength + ulDataLength ) <= sizeof( ucTestBody ) );
+    memcpy( ucTestBody + ulTestBodyLength, pucData, ulDataLength );
+    ulTestBodyLength += ulDataLength;
+
+    return eAzureIoTHTTPSuccess;
+}
+/*-----------------------------------------------------------*/
+
+static void prvSetupTestHTTP( uint32_t ulRecvStep,
+                              AzureIoTTransportConnect_t xConnect )
+{
+    uint32_t ulIndex;
+
+    for( ulIndex = 0; ulIndex < testFILE_SIZE; ulIndex++ )
+    {
+        ucTestFile[ ulIndex ] = ( uint8_t ) ( ulIndex * 31 + 7 );
+    }
+
+    ulTestRequestLength = 0;
+    ulTestResponseLength = 0;
+    ulTestResponseOffset = 0;
+    pcTestResponse = NULL;
+    ulTestRecvStep = ulRecvStep;
+    ulTestRequestCount = 0;
+    xTestRecvStalls = false;
+    xTestClosed = false;
+    ulTestCloseAfterResponses = 0;
+    ulTestDropRequests = 0;
+    ulTestConnectCount = 0;
+    lTestConnectResult = 0;
+    ulTestBodyLength = 0;
+
+    /* Nothing is expected of the handle before it is initialized */
+    memset( &xTestHTTP, 0xA5, sizeof( xTestHTTP ) );
+    xTestTransport.pxNetworkContext = NULL;
+    xTestTransport.xSend = prvTestSend;
+    xTestTransport.xRecv = prvTestRecv;
+
+    assert_int_equal( AzureIoTHTTP_Init( &xTestHTTP, &xTestTransport,
+                                         ucTestHost, sizeof( ucTestHost ) - 1,
+                                         ucTestPath, sizeof( ucTestPath ) - 1,
+                                         ucTestHeaderBuffer, sizeof( ucTestHeaderBuffer ) ),
+                      eAzureIoTHTTPSuccess );
+
+    /* Without it, the handle doesn't reconnect */
+    if( xConnect != NULL )
+    {
+        assert_int_equal( AzureIoTHTTP_InitConnection( &xTestHTTP, &xTestTransport, xConnect, &ulTestConnectCount ),
+                          eAzureIoTHTTPSuccess );
+    }
+}
+/*-----------------------------------------------------------*/
+
+/* Stream a request for lRangeStart to lRangeEnd, expecting xExpected. */
+static void prvRequestStream( int32_t lRangeStart,
+                              int32_t lRangeEnd,
+                              AzureIoTHTTPResult_t xExpected )
+{
+    uint32_t ulLength;
+
+    /* Headers are rebuilt for each request, on the same connection */
+    assert_int_equal( AzureIoTHTTP_InitNextRequest( &xTestHTTP ), eAzureIoTHTTPSuccess );
+
+    if( pcTestResponse != NULL )
+    {
+        /* Nothing left from the last canned response */
+        ulTestResponseLength = 0;
+        ulTestResponseOffset = 0;
+    }
+
+    ulTestBodyLength = 0;
+    assert_int_equal( AzureIoTHTTP_RequestStream( &xTestHTTP, lRangeStart, lRangeEnd,
+                                                  ucTestBuffer, sizeof( ucTestBuffer ),
+                                                  prvTestBodyCallback, NULL, &ulLength ),
+                      xExpected );
+    assert_int_equal( ulLength, ulTestBodyLength );
+}
+/*-----------------------------------------------------------*/
+
+static void testAzureIoTHTTP_RequestStream_InvalidArgFailure( void ** ppvState )
+{
+    uint32_t ulLength;
+
+    ( void ) ppvState;
+
+    prvSetupTestHTTP( 64, NULL );
+
+    assert_int_equal( AzureIoTHTTP_RequestStream( NULL, 0, 99, ucTestBuffer, sizeof( ucTestBuffer ),
+                                                  prvTestBodyCallback, NULL, &ulLength ),
+                      eAzureIoTHTTPInvalidParameter );
+    assert_int_equal( AzureIoTHTTP_RequestStream( &xTestHTTP, 0, 99, NULL, sizeof( ucTestBuffer ),
+                                                  prvTestBodyCallback, NULL, &ulLength ),
+                      eAzureIoTHTTPInvalidParameter );
+    assert_int_equal( AzureIoTHTTP_RequestStream( &xTestHTTP, 0, 99, ucTestBuffer, 0,
+                                                  prvTestBodyCallback, NULL, &ulLength ),
+                      eAzureIoTHTTPInvalidParameter );
+    assert_int_equal( AzureIoTHTTP_RequestStream( &xTestHTTP, 0, 99, ucTestBuffer, sizeof( ucTestBuffer ),
+                                                  NULL, NULL, &ulLength ),
+                      eAzureIoTHTTPInvalidParameter );
+    assert_int_equal( AzureIoTHTTP_RequestStream( &xTestHTTP, 0, 99, ucTestBuffer, sizeof( ucTestBuffer ),
+                                                  prvTestBodyCallback, NULL, NULL ),
+                      eAzureIoTHTTPInvalidParameter );
+}
+/*-----------------------------------------------------------*/
+
+static void testAzureIoTHTTP_RequestStream_Success( void ** ppvState )
+{
+    uint32_t ulRecvStep;
+
+    ( void ) ppvState;
+
+    /* The headers and the body split at any position, over a range larger than the buffer */
+    for( ulRecvStep = 1; ulRecvStep <= testBUFFER_SIZE; ulRecvStep += 17 )
+    {
+        prvSetupTestHTTP( ulRecvStep, NULL );
+        prvRequestStream( 100, 699, eAzureIoTHTTPSuccess );
+        assert_int_equal( ulTestBodyLength, 600 );
+        assert_memory_equal( ucTestBody, ucTestFile + 100, 600 );
+    }
+
+    /* The end of the file, shorter than asked for */
+    prvSetupTestHTTP( 64, NULL );
+    prvRequestStream( 900, 1099, eAzureIoTHTTPSuccess );
+    assert_int_equal( ulTestBodyLength, 100 );
+    assert_memory_equal( ucTestBody, ucTestFile + 900, 100 );
+
+    /* The whole file, with a 200 */
+    prvSetupTestHTTP( 64, NULL );
+    prvRequestStream( 0, azureiothttpHttpRangeRequestEndOfFile, eAzureIoTHTTPSuccess );
+    assert_int_equal( ulTestBodyLength, testFILE_SIZE );
+    assert_memory_equal( ucTestBody, ucTestFile, testFILE_SIZE );
+
+    /* The rest of the file */
+    prvSetupTestHTTP( 64, NULL );
+    prvRequestStream( 400, azureiothttpHttpRangeRequestEndOfFile, eAzureIoTHTTPSuccess );
+    assert_int_equal( ulTestBodyLength, 600 );
+    assert_memory_equal( ucTestBody, ucTestFile + 400, 600 );
+}
+/*-----------------------------------------------------------*/
+
+static void testAzureIoTHTTP_RequestStream_StatusFailure( void ** ppvState )
+{
+    ( void ) ppvState;
+
+    prvSetupTestHTTP( 64, NULL );
+
+    /* Fail when the status line is malformed */
+    pcTestResponse = "HTTP/1.1 2O6 Partial Content\r\nContent-Range: bytes 0-2/3\r\nContent-Length: 3\r\n\r\nabc";
+    prvRequestStream( 0, 99, eAzureIoTHTTPSecurityAlertInvalidStatusCode );
+
+    pcTestResponse = "HTTP/2 206\r\nContent-Range: bytes 0-2/3\r\nContent-Length: 3\r\n\r\nabc";
+    prvRequestStream( 0, 99, eAzureIoTHTTPSecurityAlertInvalidStatusCode );
+
+    /* Fail on an error status */
+    pcTestResponse = "HTTP/1.1 404 Not Found\r\nContent-Length: 0\r\n\r\n";
+    prvRequestStream( 0, 99, eAzureIoTHTTPError );
+
+    /* Fail on the whole file when a range was asked for */
+    pcTestResponse = "HTTP/1.1 200 OK\r\nContent-Length: 3\r\n\r\nabc";
+    prvRequestStream( 0, 99, eAzureIoTHTTPError );
+}
+/*-----------------------------------------------------------*/
+
+static void testAzureIoTHTTP_RequestStream_ContentLengthFailure( void ** ppvState )
+{
+    ( void ) ppvState;
+
+    prvSetupTestHTTP( 64, NULL );
+
+    /* Fail without a length */
+    pcTestResponse = "HTTP/1.1 206 Partial Content\r\nContent-Range: bytes 0-2/3\r\n\r\nabc";
+    prvRequestStream( 0, 99, eAzureIoTHTTPSecurityAlertInvalidContentLength );
+
+    /* Fail when the length is not a number */
+    pcTestResponse = "HTTP/1.1 206 Partial Content\r\nContent-Range: bytes 0-2/3\r\nContent-Length: 3x\r\n\r\nabc";
+    prvRequestStream( 0, 99, eAzureIoTHTTPSecurityAlertInvalidContentLength );
+
+    pcTestResponse = "HTTP/1.1 206 Partial Content\r\nContent-Range: bytes 0-2/3\r\nContent-Length: \r\n\r\nabc";
+    prvRequestStream( 0, 99, eAzureIoTHTTPSecurityAlertInvalidContentLength );
+
+    /* Fail when the length does not fit */
+    pcTestResponse = "HTTP/1.1 206 Partial Content\r\nContent-Range: bytes 0-2/3\r\nContent-Length: 4294967299\r\n\r\nabc";
+    prvRequestStream( 0, 99, eAzureIoTHTTPSecurityAlertInvalidContentLength );
+
+    /* Fail when more than the length comes with the headers */
+    pcTestResponse = "HTTP/1.1 206 Partial Content\r\nContent-Range: bytes 0-1/3\r\nContent-Length: 2\r\n\r\nabc";
+    prvRequestStream( 0, 99, eAzureIoTHTTPSecurityAlertExtraneousResponseData );
+}
+/*-----------------------------------------------------------*/
+
+static void testAzureIoTHTTP_RequestStream_ContentRangeFailure( void ** ppvState )
+{
+    ( void ) ppvState;
+
+    prvSetupTestHTTP( 64, NULL );
+
+    /* Fail without a range */
+    pcTestResponse = "HTTP/1.1 206 Partial Content\r\nContent-Length: 3\r\n\r\nabc";
+    prvRequestStream( 100, 199, eAzureIoTHTTPInvalidResponse );
+
+    /* Fail when the range is malformed */
+    pcTestResponse = "HTTP/1.1 206 Partial Content\r\nContent-Range: 100-102/1000\r\nContent-Length: 3\r\n\r\nabc";
+    prvRequestStream( 100, 199, eAzureIoTHTTPInvalidResponse );
+
+    pcTestResponse = "HTTP/1.1 206 Partial Content\r\nContent-Range: bytes 100-102\r\nContent-Length: 3\r\n\r\nabc";
+    prvRequestStream( 100, 199, eAzureIoTHTTPInvalidResponse );
+
+    pcTestResponse = "HTTP/1.1 206 Partial Content\r\nContent-Range: bytes 102-100/1000\r\nContent-Length: 3\r\n\r\nabc";
+    prvRequestStream( 100, 199, eAzureIoTHTTPInvalidResponse );
+
+    /* Fail when the range starts somewhere else */
+    pcTestResponse = "HTTP/1.1 206 Partial Content\r\nContent-Range: bytes 0-2/1000\r\nContent-Length: 3\r\n\r\nabc";
+    prvRequestStream( 100, 199, eAzureIoTHTTPInvalidResponse );
+
+    /* Fail when the range does not have the length of the body */
+    pcTestResponse = "HTTP/1.1 206 Partial Content\r\nContent-Range: bytes 100-103/1000\r\nContent-Length: 3\r\n\r\nabc";
+    prvRequestStream( 100, 199, eAzureIoTHTTPInvalidResponse );
+
+    /* Fail when the range goes past the one asked for */
+    pcTestResponse = "HTTP/1.1 206 Partial Content\r\nContent-Range: bytes 100-102/1000\r\nContent-Length: 3\r\n\r\nabc";
+    prvRequestStream( 100, 101, eAzureIoTHTTPInvalidResponse );
+
+    /* The same range is accepted */
+    prvRequestStream( 100, 102, eAzureIoTHTTPSuccess );
+    assert_memory_equal( ucTestBody, "abc", 3 );
+}
+/*-----------------------------------------------------------*/
+
+static void testAzureIoTHTTP_RequestStream_TruncatedFailure( void ** ppvState )
+{
+    ( void ) ppvState;
+
+    /* Fail when the connection stops sending in the body, after what was received is passed on */
+    prvSetupTestHTTP( 64, NULL );
+    pcTestResponse = "HTTP/1.1 206 Partial Content\r\nContent-Range: bytes 0-9/1000\r\nContent-Length: 10\r\n\r\nabcdef";
+    prvRequestStream( 0, 9, eAzureIoTHTTPPartialResponse );
+    assert_int_equal( ulTestBodyLength, 6 );
+    assert_memory_equal( ucTestBody, "abcdef", 6 );
+
+    /* Fail when the connection stops sending in the headers */
+    prvSetupTestHTTP( 64, NULL );
+    pcTestResponse = "HTTP/1.1 206 Partial Content\r\nContent-Ran";
+    prvRequestStream( 0, 9, eAzureIoTHTTPPartialResponse );
+    assert_int_equal( ulTestBodyLength, 0 );
+
+    /* Fail when nothing comes back, once the retry time is up */
+    prvSetupTestHTTP( 64, NULL );
+    xTestRecvStalls = true;
+    xTestTickCount = 0;
+    ulTestDelayCount = 0;
+    prvRequestStream( 0, 9, eAzureIoTHTTPNoResponse );
+    assert_true( ( xTestTickCount * ( 1000 / configTICK_RATE_HZ ) ) >= azureiothttpSTREAM_RETRY_TIMEOUT_MS );
+
+    /* The reads which return nothing are spaced out, not spun on */
+    assert_true( ulTestDelayCount > 0 );
+    assert_true( ulTestDelayCount <= ( azureiothttpSTREAM_RETRY_TIMEOUT_MS / azureiothttpSTREAM_RETRY_DELAY_MS ) );
+}
+/*-----------------------------------------------------------*/
+
+static void testAzureIoTHTTP_RequestStream_HeadersTooLargeFailure( void ** ppvState )
+{
+    static char ucResponse[ 2 * testBUFFER_SIZE ];
+
+    ( void ) ppvState;
+
+    prvSetupTestHTTP( 64, NULL );
+
+    /* Fail when the headers do not fit in the buffer */
+    ( void ) sprintf( ucResponse, "HTTP/1.1 206 Partial Content\r\nX-Padding: %0*d\r\n"
+                                  "Content-Range: bytes 0-2/3\r\nContent-Length: 3\r\n\r\nabc", testBUFFER_SIZE, 0 );
+    pcTestResponse = ucResponse;
+    prvRequestStream( 0, 99, eAzureIoTHTTPSecurityAlertResponseHeadersSizeLimitExceeded );
+
+    /* Headers that just fit are accepted */
+    ( void ) sprintf( ucResponse, "HTTP/1.1 206 Partial Content\r\nX-Padding: %0*d\r\n"
+                                  "Content-Range: bytes 0-2/3\r\nContent-Length: 3\r\n\r\nabc",
+                      testBUFFER_SIZE - 95, 0 );
+    assert_int_equal( strlen( ucResponse ), testBUFFER_SIZE );
+    prvSetupTestHTTP( 64, NULL );
+    pcTestResponse = ucResponse;
+    prvRequestStream( 0, 99, eAzureIoTHTTPSuccess );
+    assert_int_equal( ulTestBodyLength, 3 );
+}
+/*-----------------------------------------------------------*/
+
+static void testAzureIoTHTTP_InitConnection_Failure( void ** ppvState )
+{
+    ( void ) ppvState;
+
+    /* Fail when null handle is passed */
+    assert_int_equal( AzureIoTHTTP_InitConnection( NULL, &xTestTransport, prvTestConnect, NULL ),
+                      eAzureIoTHTTPInvalidParameter );
+
+    /* Fail when null transport is passed */
+    assert_int_equal( AzureIoTHTTP_InitConnection( &xTestHTTP, NULL, prvTestConnect, NULL ),
+                      eAzureIoTHTTPInvalidParameter );
+}
+/*-----------------------------------------------------------*/
+
+static void testAzureIoTHTTP_RequestStream_NoReconnect( void ** ppvState )
+{
+    ( void ) ppvState;
+
+    /* A handle from AzureIoTHTTP_Init() alone keeps its connection, and returns the failure */
+    prvSetupTestHTTP( 64, NULL );
+    ulTestCloseAfterResponses = 1;
+    prvRequestStream( 0, 99, eAzureIoTHTTPSuccess );
+    prvRequestStream( 100, 199, eAzureIoTHTTPNetworkError );
+    assert_int_equal( ulTestConnectCount, 0 );
+
+    /* AzureIoTHTTP_Init() drops the connect function of the previous connection */
+    prvSetupTestHTTP( 64, prvTestConnect );
+    assert_int_equal( AzureIoTHTTP_Init( &xTestHTTP, &xTestTransport,
+                                         ucTestHost, sizeof( ucTestHost ) - 1,
+                                         ucTestPath, sizeof( ucTestPath ) - 1,
+                                         ucTestHeaderBuffer, sizeof( ucTestHeaderBuffer ) ),
+                      eAzureIoTHTTPSuccess );
+    ulTestCloseAfterResponses = 1;
+    prvRequestStream( 0, 99, eAzureIoTHTTPSuccess );
+    prvRequestStream( 100, 199, eAzureIoTHTTPNetworkError );
+    assert_int_equal( ulTestConnectCount, 0 );
+}
+/*-----------------------------------------------------------*/
+
+static void testAzureIoTHTTP_RequestStream_ReconnectOnClose( void ** ppvState )
+{
+    ( void ) ppvState;
+
+    /* The connect function is kept by AzureIoTHTTP_InitNextRequest() */
+    prvSetupTestHTTP( 64, prvTestConnect );
+
+    /* The server announces it closes the connection after the second response */
+    ulTestCloseAfterResponses = 2;
+    prvRequestStream( 0, 99, eAzureIoTHTTPSuccess );
+    prvRequestStream( 100, 199, eAzureIoTHTTPSuccess );
+    assert_int_equal( ulTestConnectCount, 0 );
+
+    /* The next request goes out on a new connection, without a failed attempt first */
+    prvRequestStream( 200, 299, eAzureIoTHTTPSuccess );
+    assert_int_equal( ulTestConnectCount, 1 );
+    assert_int_equal( ulTestRequestCount, 3 );
+    assert_int_equal( ulTestBodyLength, 100 );
+    assert_memory_equal( ucTestBody, ucTestFile + 200, 100 );
+}
+/*-----------------------------------------------------------*/
+
+static void testAzureIoTHTTP_RequestStream_RetryOnce( void ** ppvState )
+{
+    ( void ) ppvState;
+
+    /* A request lost with a connection the server closed is sent again on a new one */
+    prvSetupTestHTTP( 64, prvTestConnect );
+    prvRequestStream( 0, 99, eAzureIoTHTTPSuccess );
+    ulTestDropRequests = 1;
+    prvRequestStream( 100, 199, eAzureIoTHTTPSuccess );
+    assert_int_equal( ulTestConnectCount, 1 );
+    assert_int_equal( ulTestRequestCount, 3 );
+    assert_memory_equal( ucTestBody, ucTestFile + 100, 100 );
+
+    /* Only once: the failure of the second attempt is returned */
+    prvSetupTestHTTP( 64, prvTestConnect );
+    ulTestDropRequests = 2;
+    prvRequestStream( 0, 99, eAzureIoTHTTPNetworkError );
+    assert_int_equal( ulTestConnectCount, 1 );
+    assert_int_equal( ulTestRequestCount, 2 );
+
+    /* The next request reconnects first */
+    prvRequestStream( 0, 99, eAzureIoTHTTPSuccess );
+    assert_int_equal( ulTestConnectCount, 2 );
+    assert_memory_equal( ucTestBody, ucTestFile, 100 );
+
+    /* Not when the reconnect fails */
+    prvSetupTestHTTP( 64, prvTestConnect );
+    ulTestDropRequests = 1;
+    lTestConnectResult = -1;
+    prvRequestStream( 0, 99, eAzureIoTHTTPNetworkError );
+    assert_int_equal( ulTestConnectCount, 1 );
+    assert_int_equal( ulTestRequestCount, 1 );
+
+    /* Nor without a connect function */
+    prvSetupTestHTTP( 64, NULL );
+    ulTestDropRequests = 1;
+    prvRequestStream( 0, 99, eAzureIoTHTTPNetworkError );
+    assert_int_equal( ulTestConnectCount, 0 );
+    assert_int_equal( ulTestRequestCount, 1 );
+}
+/*-----------------------------------------------------------*/
+
+static void testAzureIoTHTTP_Request_RetryOnce( void ** ppvState )
+{
+    char * pucData;
+    uint32_t ulLength;
+
+    ( void ) ppvState;
+
+    prvSetupTestHTTP( 64, prvTestConnect );
+
+    /* The server closed the connection while idle */
+    xTestClosed = true;
+    assert_int_equal( AzureIoTHTTP_Request( &xTestHTTP, 100, 199, ucTestBuffer, sizeof( ucTestBuffer ),
+                                            &pucData, &ulLength ),
+                      eAzureIoTHTTPSuccess );
+    assert_int_equal( ulTestConnectCount, 1 );
+    assert_int_equal( ulLength, 100 );
+    assert_memory_equal( pucData, ucTestFile + 100, 100 );
+
+    /* Only once */
+    prvSetupTestHTTP( 64, prvTestConnect );
+    ulTestDropRequests = 2;
+    assert_int_equal( AzureIoTHTTP_Request( &xTestHTTP, 100, 199, ucTestBuffer, sizeof( ucTestBuffer ),
+                                            &pucData, &ulLength ),
+                      eAzureIoTHTTPNetworkError );
+    assert_int_equal( ulTestConnectCount, 1 );
+    assert_int_equal( ulTestRequestCount, 2 );
+}
+/*-----------------------------------------------------------*/
+
+uint32_t ulGetAllTests()
+{
+    const struct CMUnitTest tests[] =
+    {
+        cmocka_unit_test( testAzureIoTHTTP_RequestStream_InvalidArgFailure ),
+        cmocka_unit_test( testAzureIoTHTTP_RequestStream_Success ),
+        cmocka_unit_test( testAzureIoTHTTP_RequestStream_StatusFailure ),
+        cmocka_unit_test( testAzureIoTHTTP_RequestStream_ContentLengthFailure ),
+        cmocka_unit_test( testAzureIoTHTTP_RequestStream_ContentRangeFailure ),
+        cmocka_unit_test( testAzureIoTHTTP_RequestStream_TruncatedFailure ),
+        cmocka_unit_test( testAzureIoTHTTP_RequestStream_HeadersTooLargeFailure ),
+        cmocka_unit_test( testAzureIoTHTTP_InitConnection_Failure ),
+        cmocka_unit_test( testAzureIoTHTTP_RequestStream_NoReconnect ),
+        cmocka_unit_test( testAzureIoTHTTP_RequestStream_ReconnectOnClose ),
+        cmocka_unit_test( testAzureIoTHTTP_RequestStream_RetryOnce ),
+        cmocka_unit_test( testAzureIoTHTTP_Request_RetryOnce ),
+    };
+
+    return ( uint32_t ) cmocka_run_group_tests_name( "azure_iot_core_http_ut ", tests, NULL, NULL );
+}
@@ -0,0 +1,24 @@
+/* Copyright (c) Microsoft Corporation.
+ * Licensed under the MIT License. */
+
+/**
+ * @file azure_iot_crypto_port.h
+ * @brief Unit test crypto port.
+ *
+ */
+
+#ifndef AZURE_IOT_CRYPTO_PORT_H
+#define AZURE_IOT_CRYPTO_PORT_H
+
+#include <stdint.h>
+
+/* Running checksum standing in for a SHA256 context */
+typedef struct AzureIoTCryptoSHA256Context
+{
+    uint32_t ulState;
+    uint32_t ulLength;
+} AzureIoTCryptoSHA256Context_t;
+
+#define azureiotcryptoSHA256_CONTEXT_LAYOUT    ( 0x10000U )
+
+#endif /* AZURE_IOT_CRYPTO_PORT_H */
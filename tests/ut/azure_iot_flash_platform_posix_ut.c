@@ -0,0 +1,328 @@
+/* Copyright (c) Microsoft Corporation.
+ * Licensed under the MIT License. */
+
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <setjmp.h>
+#include <unistd.h>
+
+#include <cmocka.h>
+
+#include "azure_iot_flash_platform.h"
+#include "azure_iot_crypto.h"
+
+#include "azure/core/az_base64.h"
+#include "azure/core/az_span.h"
+/*-----------------------------------------------------------*/
+
+#define testIMAGE_SIZE    ( 3 * azureiotflashposixSECTOR_SIZE + 100 )
+/*-----------------------------------------------------------*/
+
+static char cTestDirectory[] = "/tmp/azure_iot_flash_posix_ut_XXXXXX";
+static uint8_t ucTestImage[ testIMAGE_SIZE ];
+static uint8_t ucTestRead[ testIMAGE_SIZE ];
+static uint32_t ulTestResetCallbackCount;
+/*-----------------------------------------------------------*/
+
+uint32_t ulGetAllTests();
+/*-----------------------------------------------------------*/
+
+static void prvResetCallback( AzureADUImage_t * pxImage )
+{
+    ( void ) pxImage;
+
+    ulTestResetCallbackCount++;
+}
+/*-----------------------------------------------------------*/
+
+static void prvRemoveFile( const char * pcName )
+{
+    char cPath[ sizeof( cTestDirectory ) + 32 ];
+
+    ( void ) snprintf( cPath, sizeof( cPath ), "%s/%s", cTestDirectory, pcName );
+    ( void ) unlink( cPath );
+}
+/*-----------------------------------------------------------*/
+
+static int prvSetup( void ** ppvState )
+{
+    uint32_t ulIndex;
+
+    ( void ) ppvState;
+
+    strcpy( cTestDirectory, "/tmp/azure_iot_flash_posix_ut_XXXXXX" );
+    assert_non_null( mkdtemp( cTestDirectory ) );
+
+    for( ulIndex = 0; ulIndex < sizeof( ucTestImage ); ulIndex++ )
+    {
+        ucTestImage[ ulIndex ] = ( uint8_t ) ( ulIndex * 13 + 5 );
+    }
+
+    ulTestResetCallbackCount = 0;
+
+    return 0;
+}
+/*-----------------------------------------------------------*/
+
+static int prvTeardown( void ** ppvState )
+{
+    ( void ) ppvState;
+
+    prvRemoveFile( "bank0.bin" );
+    prvRemoveFile( "bank1.bin" );
+    prvRemoveFile( "boot.bin" );
+    prvRemoveFile( "checkpoint.bin" );
+    ( void ) rmdir( cTestDirectory );
+
+    return 0;
+}
+/*-----------------------------------------------------------*/
+
+static void prvInitImage( AzureADUImage_t * pxImage )
+{
+    memset( pxImage, 0, sizeof( *pxImage ) );
+    pxImage->pcDirectory = cTestDirectory;
+    pxImage->xResetCallback = prvResetCallback;
+
+    assert_int_equal( AzureIoTPlatform_Init( pxImage ), eAzureIoTSuccess );
+}
+/*-----------------------------------------------------------*/
+
+/* Reset the device and boot it again, as after a power cycle */
+static void prvRebootImage( AzureADUImage_t * pxImage )
+{
+    assert_int_equal( AzureIoTPlatform_ResetDevice( pxImage ), eAzureIoTSuccess );
+    assert_null( pxImage->pucBanks[ 0 ] );
+    assert_int_equal( AzureIoTPlatform_Init( pxImage ), eAzureIoTSuccess );
+}
+/*-----------------------------------------------------------*/
+
+/* Write the test image in blocks of ulBlockSize bytes */
+static void prvWriteImage( AzureADUImage_t * pxImage,
+                           uint32_t ulBlockSize )
+{
+    uint32_t ulOffset;
+    uint32_t ulLength;
+
+    for( ulOffset = 0; ulOffset < sizeof( ucTestImage ); ulOffset += ulLength )
+    {
+        ulLength = ( sizeof( ucTestImage ) - ulOffset ) < ulBlockSize ? ( sizeof( ucTestImage ) - ulOffset ) : ulBlockSize;
+        assert_int_equal( AzureIoTPlatform_WriteBlock( pxImage, ulOffset, ucTestImage + ulOffset, ulLength ), eAzureIoTSuccess );
+    }
+}
+/*-----------------------------------------------------------*/
+
+static void prvGetTestImageHash( uint8_t * pucHash,
+                                 uint32_t ulHashLength )
+{
+    AzureIoTCryptoSHA256Context_t xContext;
+    uint8_t ucSHA256[ azureiotcryptoSHA256_SIZE ];
+    int32_t lHashLength;
+
+    assert_int_equal( AzureIoTCrypto_SHA256Init( &xContext ), eAzureIoTSuccess );
+    assert_int_equal( AzureIoTCrypto_SHA256Update( &xContext, ucTestImage, sizeof( ucTestImage ) ), eAzureIoTSuccess );
+    assert_int_equal( AzureIoTCrypto_SHA256Final( &xContext, ucSHA256, sizeof( ucSHA256 ) ), eAzureIoTSuccess );
+    assert_true( az_result_succeeded( az_base64_encode( az_span_create( pucHash, ( int32_t ) ulHashLength ),
+                                                        az_span_create( ucSHA256, sizeof( ucSHA256 ) ),
+                                                        &lHashLength ) ) );
+    assert_int_equal( lHashLength, 44 );
+}
+/*-----------------------------------------------------------*/
+
+static void testAzureIoTPlatform_Init_Failure( void ** ppvState )
+{
+    AzureADUImage_t xImage;
+
+    ( void ) ppvState;
+
+    /* Fail when null image is passed */
+    assert_int_equal( AzureIoTPlatform_Init( NULL ), eAzureIoTErrorInvalidArgument );
+
+    /* Fail when no directory is set */
+    memset( &xImage, 0, sizeof( xImage ) );
+    assert_int_equal( AzureIoTPlatform_Init( &xImage ), eAzureIoTErrorInvalidArgument );
+
+    /* Fail to write before init */
+    assert_int_equal( AzureIoTPlatform_WriteBlock( &xImage, 0, ucTestImage, 1 ), eAzureIoTErrorInvalidArgument );
+}
+/*-----------------------------------------------------------*/
+
+static void testAzureIoTPlatform_WriteBlock_Success( void ** ppvState )
+{
+    AzureADUImage_t xImage;
+
+    ( void ) ppvState;
+
+    prvInitImage( &xImage );
+    xImage.ulEraseMicroseconds = 3;
+    xImage.ulProgramMicroseconds = 1;
+
+    assert_int_equal( AzureIoTPlatform_GetSingleFlashBootBankSize(), azureiotflashposixBANK_SIZE );
+    assert_int_equal( AzureIoTPlatform_GetProgramPageSize( &xImage ), azureiotflashposixPAGE_SIZE );
+    assert_int_equal( AzureIoTPlatform_GetEraseSectorSize( &xImage ), azureiotflashposixSECTOR_SIZE );
+
+    /* New banks are blank, nothing to erase */
+    prvWriteImage( &xImage, azureiotflashposixPAGE_SIZE );
+    assert_memory_equal( xImage.pucBanks[ 1 ], ucTestImage, sizeof( ucTestImage ) );
+    assert_int_equal( xImage.ulImageSize, sizeof( ucTestImage ) );
+    assert_int_equal( xImage.ulEraseCount, 0 );
+    assert_int_equal( xImage.ulProgramCount, ( sizeof( ucTestImage ) + azureiotflashposixPAGE_SIZE - 1 ) / azureiotflashposixPAGE_SIZE );
+
+    /* The bank survives the reset, and the next update erases each sector once */
+    prvRebootImage( &xImage );
+    assert_memory_equal( xImage.pucBanks[ 1 ], ucTestImage, sizeof( ucTestImage ) );
+
+    prvWriteImage( &xImage, 1000 );
+    assert_memory_equal( xImage.pucBanks[ 1 ], ucTestImage, sizeof( ucTestImage ) );
+    assert_int_equal( xImage.ulEraseCount, 4 );
+    assert_int_equal( xImage.ullBusyMicroseconds, xImage.ulEraseCount * 3 + xImage.ulProgramCount );
+
+    assert_int_equal( AzureIoTPlatform_WriteBlock( &xImage, azureiotflashposixBANK_SIZE - 1, ucTestImage, 2 ),
+                      eAzureIoTErrorOutOfMemory );
+
+    assert_int_equal( AzureIoTPlatform_ResetDevice( &xImage ), eAzureIoTSuccess );
+}
+/*-----------------------------------------------------------*/
+
+static void testAzureIoTPlatform_WriteBlock_Reprogram( void ** ppvState )
+{
+    AzureADUImage_t xImage;
+    uint8_t ucZero[ 16 ] = { 0 };
+    uint8_t ucOnes[ 16 ];
+
+    ( void ) ppvState;
+
+    memset( ucOnes, 0xFF, sizeof( ucOnes ) );
+    prvInitImage( &xImage );
+
+    /* Clearing more bits of programmed bytes works, as on NOR flash */
+    assert_int_equal( AzureIoTPlatform_WriteBlock( &xImage, 0, ucOnes, sizeof( ucOnes ) ), eAzureIoTSuccess );
+    assert_int_equal( AzureIoTPlatform_WriteBlock( &xImage, 0, ucTestImage, sizeof( ucOnes ) ), eAzureIoTSuccess );
+    assert_int_equal( AzureIoTPlatform_WriteBlock( &xImage, 0, ucZero, sizeof( ucZero ) ), eAzureIoTSuccess );
+
+    /* Setting them back needs an erase, and the sector is only erased once per boot */
+    assert_int_equal( AzureIoTPlatform_WriteBlock( &xImage, 0, ucOnes, 1 ), eAzureIoTErrorFailed );
+    assert_int_equal( AzureIoTPlatform_WriteBlock( &xImage, 8, ucTestImage, 1 ), eAzureIoTErrorFailed );
+    assert_int_equal( xImage.pucBanks[ 1 ][ 0 ], 0 );
+    assert_int_equal( xImage.ulEraseCount, 0 );
+
+    /* A write in the middle of a sector does not erase it */
+    prvRebootImage( &xImage );
+    assert_int_equal( AzureIoTPlatform_WriteBlock( &xImage, 8, ucTestImage, 1 ), eAzureIoTErrorFailed );
+
+    /* A write from its start does */
+    assert_int_equal( AzureIoTPlatform_WriteBlock( &xImage, 0, ucTestImage, 1 ), eAzureIoTSuccess );
+    assert_int_equal( xImage.ulEraseCount, 1 );
+    assert_int_equal( xImage.pucBanks[ 1 ][ 0 ], ucTestImage[ 0 ] );
+    assert_int_equal( xImage.pucBanks[ 1 ][ 8 ], 0xFF );
+
+    assert_int_equal( AzureIoTPlatform_ResetDevice( &xImage ), eAzureIoTSuccess );
+}
+/*-----------------------------------------------------------*/
+
+static void testAzureIoTPlatform_VerifyImage( void ** ppvState )
+{
+    AzureADUImage_t xImage;
+    uint8_t ucHash[ 48 ];
+
+    ( void ) ppvState;
+
+    prvInitImage( &xImage );
+    prvWriteImage( &xImage, 777 );
+    prvGetTestImageHash( ucHash, sizeof( ucHash ) );
+
+    assert_int_equal( AzureIoTPlatform_VerifyImage( &xImage, ucHash, 44 ), eAzureIoTSuccess );
+
+    /* Fail when the hash is not base64 of a SHA256 */
+    assert_int_equal( AzureIoTPlatform_VerifyImage( &xImage, ucHash, 40 ), eAzureIoTErrorInvalidArgument );
+
+    /* Fail when a byte differs */
+    ucTestImage[ 0 ] = 0;
+    prvGetTestImageHash( ucHash, sizeof( ucHash ) );
+    assert_int_equal( AzureIoTPlatform_VerifyImage( &xImage, ucHash, 44 ), eAzureIoTErrorFailed );
+
+    assert_int_equal( AzureIoTPlatform_ResetDevice( &xImage ), eAzureIoTSuccess );
+}
+/*-----------------------------------------------------------*/
+
+static void testAzureIoTPlatform_Checkpoint( void ** ppvState )
+{
+    AzureADUImage_t xImage;
+    uint8_t ucCheckpoint[ 100 ];
+
+    ( void ) ppvState;
+
+    prvInitImage( &xImage );
+
+    assert_int_equal( AzureIoTPlatform_LoadCheckpoint( &xImage, ucCheckpoint, sizeof( ucCheckpoint ) ),
+                      eAzureIoTErrorItemNotFound );
+    assert_int_equal( AzureIoTPlatform_SaveCheckpoint( &xImage, ucTestImage, sizeof( ucCheckpoint ) ), eAzureIoTSuccess );
+
+    /* The checkpoint survives a reset, but only loads with its own length */
+    prvRebootImage( &xImage );
+
+    assert_int_equal( AzureIoTPlatform_LoadCheckpoint( &xImage, ucCheckpoint, sizeof( ucCheckpoint ) - 1 ),
+                      eAzureIoTErrorItemNotFound );
+    assert_int_equal( AzureIoTPlatform_LoadCheckpoint( &xImage, ucCheckpoint, sizeof( ucCheckpoint ) ), eAzureIoTSuccess );
+    assert_memory_equal( ucCheckpoint, ucTestImage, sizeof( ucCheckpoint ) );
+
+    /* Fail when the checkpoint is too large */
+    assert_int_equal( AzureIoTPlatform_SaveCheckpoint( &xImage, ucTestImage, azureiotflashposixCHECKPOINT_SIZE + 1 ),
+                      eAzureIoTErrorInvalidArgument );
+
+    assert_int_equal( AzureIoTPlatform_ResetDevice( &xImage ), eAzureIoTSuccess );
+}
+/*-----------------------------------------------------------*/
+
+static void testAzureIoTPlatform_EnableImage_Reset( void ** ppvState )
+{
+    AzureADUImage_t xImage;
+
+    ( void ) ppvState;
+
+    prvInitImage( &xImage );
+    assert_int_equal( xImage.ulActiveBank, 0 );
+    prvWriteImage( &xImage, 4096 );
+
+    /* Without enabling the image, the device boots the same bank */
+    prvRebootImage( &xImage );
+    assert_int_equal( ulTestResetCallbackCount, 1 );
+    assert_int_equal( xImage.ulActiveBank, 0 );
+
+    /* Once enabled, it boots the update bank */
+    assert_int_equal( AzureIoTPlatform_EnableImage( &xImage ), eAzureIoTSuccess );
+    prvRebootImage( &xImage );
+    assert_int_equal( ulTestResetCallbackCount, 2 );
+    assert_int_equal( xImage.ulResetCount, 2 );
+    assert_int_equal( xImage.ulActiveBank, 1 );
+
+    assert_int_equal( AzureIoTPlatform_ReadActiveBlock( &xImage, 0, ucTestRead, sizeof( ucTestRead ) ), eAzureIoTSuccess );
+    assert_memory_equal( ucTestRead, ucTestImage, sizeof( ucTestImage ) );
+
+    /* The next update goes to the other bank, and reads the running image */
+    prvWriteImage( &xImage, 4096 );
+    assert_memory_equal( xImage.pucBanks[ 0 ], ucTestImage, sizeof( ucTestImage ) );
+
+    assert_int_equal( AzureIoTPlatform_ResetDevice( &xImage ), eAzureIoTSuccess );
+}
+/*-----------------------------------------------------------*/
+
+uint32_t ulGetAllTests()
+{
+    const struct CMUnitTest tests[] =
+    {
+        cmocka_unit_test_setup_teardown( testAzureIoTPlatform_Init_Failure, prvSetup, prvTeardown ),
+        cmocka_unit_test_setup_teardown( testAzureIoTPlatform_WriteBlock_Success, prvSetup, prvTeardown ),
+        cmocka_unit_test_setup_teardown( testAzureIoTPlatform_WriteBlock_Reprogram, prvSetup, prvTeardown ),
+        cmocka_unit_test_setup_teardown( testAzureIoTPlatform_VerifyImage, prvSetup, prvTeardown ),
+        cmocka_unit_test_setup_teardown( testAzureIoTPlatform_Checkpoint, prvSetup, prvTeardown ),
+        cmocka_unit_test_setup_teardown( testAzureIoTPlatform_EnableImage_Reset, prvSetup, prvTeardown )
+    };
+
+    return ( uint32_t ) cmocka_run_group_tests_name( "azure_iot_flash_platform_posix_ut", tests, NULL, NULL );
+}
+/*-----------------------------------------------------------*/
@@ -294,6 +294,35 @@ static void testAzureIoTHubClientProperties_BuilderResponse_Success( void ** ppv
     assert_string_equal( ucTestJSONResponse, ucJSONWriterBuffer );
 }
 
+static void testAzureIoTHubClientProperties_BuilderCounting_Success( void ** ppvState )
+{
+    AzureIoTHubClient_t xTestIoTHubClient;
+    AzureIoTJSONWriter_t xJSONWriter;
+    const char * pucPropertyName = "property";
+    const char * pucAckDescription = "success";
+    uint8_t ucScratch[ azureiotjsonwriterSTREAMING_BUFFER_MIN_SIZE ];
+
+    assert_int_equal( AzureIoTJSONWriter_InitCounting( &xJSONWriter, ucScratch, sizeof( ucScratch ) ), eAzureIoTSuccess );
+
+    assert_int_equal( AzureIoTJSONWriter_AppendBeginObject( &xJSONWriter ), eAzureIoTSuccess );
+    assert_int_equal( AzureIoTHubClientProperties_BuilderBeginResponseStatus( &xTestIoTHubClient,
+                                                                              &xJSONWriter,
+                                                                              pucPropertyName,
+                                                                              strlen( pucPropertyName ),
+                                                                              200,
+                                                                              1,
+                                                                              pucAckDescription,
+                                                                              strlen( pucAckDescription ) ), eAzureIoTSuccess );
+    assert_int_equal( AzureIoTJSONWriter_AppendString( &xJSONWriter,
+                                                       "val",
+                                                       strlen( "val" ) ), eAzureIoTSuccess );
+    assert_int_equal( AzureIoTHubClientProperties_BuilderEndResponseStatus( &xTestIoTHubClient,
+                                                                            &xJSONWriter ), eAzureIoTSuccess );
+    assert_int_equal( AzureIoTJSONWriter_AppendEndObject( &xJSONWriter ), eAzureIoTSuccess );
+
+    assert_int_equal( AzureIoTJSONWriter_GetBytesUsed( &xJSONWriter ), sizeof( ucTestJSONResponse ) - 1 );
+}
+
 static void testAzureIoTHubClientProperties_GetPropertiesVersion_Failure( void ** ppvState )
 {
     AzureIoTHubClient_t xTestIoTHubClient;
@@ -720,6 +749,139 @@ static void testAzureIoTHubClientProperties_GetNextComponentPropertyWriteableUpd
                                                                             &ulComponentNameLength ), eAzureIoTErrorEndOfProperties );
 }
 
+static void prvInitClientWithComponents( AzureIoTHubClient_t * pxTestIoTHubClient )
+{
+    AzureIoTHubClientOptions_t xOptions;
+    static AzureIoTHubClientComponent_t pxComponentNameList[] =
+    {
+        azureiothubCREATE_COMPONENT( "one_component" ), azureiothubCREATE_COMPONENT( "two_component" )
+    };
+
+    will_return( AzureIoTMQTT_Init, eAzureIoTMQTTSuccess );
+
+    AzureIoTHubClient_OptionsInit( &xOptions );
+    xOptions.pxComponentList = pxComponentNameList;
+    xOptions.ulComponentListLength = 2;
+
+    assert_int_equal( AzureIoTHubClient_Init( pxTestIoTHubClient,
+                                              ucHostname,
+                                              strlen( ucHostname ),
+                                              ucDeviceId,
+                                              strlen( ucDeviceId ),
+                                              &xOptions,
+                                              ucBuffer, sizeof( ucBuffer ),
+                                              prvGetUnixTime,
+                                              &xTransportInterface ), eAzureIoTSuccess );
+}
+
+static void testAzureIoTHubClientProperties_BuildIndex_Failure( void ** ppvState )
+{
+    AzureIoTHubClient_t xTestIoTHubClient;
+    AzureIoTHubClientPropertiesIndex_t xIndex;
+
+    assert_int_equal( AzureIoTHubClientProperties_BuildIndex( NULL, &xIndex, ucTestJSONVersion, strlen( ucTestJSONVersion ),
+                                                              eAzureIoTHubPropertiesWritablePropertyMessage,
+                                                              eAzureIoTHubClientPropertyWritable ), eAzureIoTErrorInvalidArgument );
+    assert_int_equal( AzureIoTHubClientProperties_BuildIndex( &xTestIoTHubClient, NULL, ucTestJSONVersion, strlen( ucTestJSONVersion ),
+                                                              eAzureIoTHubPropertiesWritablePropertyMessage,
+                                                              eAzureIoTHubClientPropertyWritable ), eAzureIoTErrorInvalidArgument );
+    assert_int_equal( AzureIoTHubClientProperties_BuildIndex( &xTestIoTHubClient, &xIndex, NULL, strlen( ucTestJSONVersion ),
+                                                              eAzureIoTHubPropertiesWritablePropertyMessage,
+                                                              eAzureIoTHubClientPropertyWritable ), eAzureIoTErrorInvalidArgument );
+    assert_int_equal( AzureIoTHubClientProperties_BuildIndex( &xTestIoTHubClient, &xIndex, ucTestJSONVersion, 0,
+                                                              eAzureIoTHubPropertiesWritablePropertyMessage,
+                                                              eAzureIoTHubClientPropertyWritable ), eAzureIoTErrorInvalidArgument );
+    assert_int_equal( AzureIoTHubClientProperties_BuildIndex( &xTestIoTHubClient, &xIndex, ucTestJSONVersion, strlen( ucTestJSONVersion ),
+                                                              eAzureIoTHubCommandMessage,
+                                                              eAzureIoTHubClientPropertyWritable ), eAzureIoTErrorInvalidArgument );
+
+    /* A writable property update has no reported properties */
+    assert_int_equal( AzureIoTHubClientProperties_BuildIndex( &xTestIoTHubClient, &xIndex, ucTestJSONVersion, strlen( ucTestJSONVersion ),
+                                                              eAzureIoTHubPropertiesWritablePropertyMessage,
+                                                              eAzureIoTHubClientReportedFromDevice ), eAzureIoTErrorInvalidArgument );
+
+    /* Not JSON */
+    prvInitClientWithComponents( &xTestIoTHubClient );
+    assert_int_equal( AzureIoTHubClientProperties_BuildIndex( &xTestIoTHubClient, &xIndex, "{\"a\":}", strlen( "{\"a\":}" ),
+                                                              eAzureIoTHubPropertiesWritablePropertyMessage,
+                                                              eAzureIoTHubClientPropertyWritable ), eAzureIoTErrorUnexpectedChar );
+}
+
+static void testAzureIoTHubClientProperties_BuildIndex_Success( void ** ppvState )
+{
+    AzureIoTHubClient_t xTestIoTHubClient;
+    AzureIoTHubClientPropertiesIndex_t xIndex;
+    AzureIoTJSONReader_t xJSONReader;
+    AzureIoTJSONTokenType_t xTokenType;
+    const uint8_t * pucPropertyName;
+    uint32_t ulPropertyNameLength;
+    uint32_t ulPosition = 0;
+    int32_t lValue;
+
+    prvInitClientWithComponents( &xTestIoTHubClient );
+
+    assert_int_equal( AzureIoTHubClientProperties_BuildIndex( &xTestIoTHubClient, &xIndex, ucTestJSONVersion, strlen( ucTestJSONVersion ),
+                                                              eAzureIoTHubPropertiesWritablePropertyMessage,
+                                                              eAzureIoTHubClientPropertyWritable ), eAzureIoTSuccess );
+
+    /* Straight to the object of a component */
+    assert_int_equal( AzureIoTHubClientProperties_IndexGetComponent( &xIndex, "two_component", strlen( "two_component" ), &xJSONReader ),
+                      eAzureIoTSuccess );
+    assert_int_equal( AzureIoTJSONReader_NextToken( &xJSONReader ), eAzureIoTSuccess );
+    assert_int_equal( AzureIoTJSONReader_TokenType( &xJSONReader, &xTokenType ), eAzureIoTSuccess );
+    assert_int_equal( xTokenType, eAzureIoTJSONTokenBEGIN_OBJECT );
+    assert_int_equal( AzureIoTJSONReader_NextToken( &xJSONReader ), eAzureIoTSuccess );
+    assert_true( AzureIoTJSONReader_TokenIsTextEqual( &xJSONReader, "prop_one", strlen( "prop_one" ) ) );
+    assert_int_equal( AzureIoTHubClientProperties_IndexGetComponent( &xIndex, "not_component", strlen( "not_component" ), &xJSONReader ),
+                      eAzureIoTErrorItemNotFound );
+
+    /* The properties of a component, in order */
+    assert_int_equal( AzureIoTHubClientProperties_IndexGetNextProperty( &xIndex, "one_component", strlen( "one_component" ), &ulPosition,
+                                                                        &pucPropertyName, &ulPropertyNameLength, &xJSONReader ), eAzureIoTSuccess );
+    assert_int_equal( ulPropertyNameLength, strlen( "thing_one" ) );
+    assert_memory_equal( pucPropertyName, "thing_one", ulPropertyNameLength );
+    assert_int_equal( AzureIoTJSONReader_NextToken( &xJSONReader ), eAzureIoTSuccess );
+    assert_int_equal( AzureIoTJSONReader_GetTokenInt32( &xJSONReader, &lValue ), eAzureIoTSuccess );
+    assert_int_equal( lValue, 1 );
+
+    assert_int_equal( AzureIoTHubClientProperties_IndexGetNextProperty( &xIndex, "one_component", strlen( "one_component" ), &ulPosition,
+                                                                        &pucPropertyName, &ulPropertyNameLength, &xJSONReader ), eAzureIoTSuccess );
+    assert_memory_equal( pucPropertyName, "thing_two", ulPropertyNameLength );
+    assert_int_equal( AzureIoTJSONReader_NextToken( &xJSONReader ), eAzureIoTSuccess );
+    assert_true( AzureIoTJSONReader_TokenIsTextEqual( &xJSONReader, "string", strlen( "string" ) ) );
+
+    assert_int_equal( AzureIoTHubClientProperties_IndexGetNextProperty( &xIndex, "one_component", strlen( "one_component" ), &ulPosition,
+                                                                        &pucPropertyName, &ulPropertyNameLength, &xJSONReader ), eAzureIoTSuccess );
+    assert_memory_equal( pucPropertyName, "thing_three", ulPropertyNameLength );
+    assert_int_equal( AzureIoTHubClientProperties_IndexGetNextProperty( &xIndex, "one_component", strlen( "one_component" ), &ulPosition,
+                                                                        &pucPropertyName, &ulPropertyNameLength, &xJSONReader ), eAzureIoTSuccess );
+    assert_memory_equal( pucPropertyName, "thing_four", ulPropertyNameLength );
+    assert_int_equal( AzureIoTHubClientProperties_IndexGetNextProperty( &xIndex, "one_component", strlen( "one_component" ), &ulPosition,
+                                                                        &pucPropertyName, &ulPropertyNameLength, &xJSONReader ), eAzureIoTErrorEndOfProperties );
+
+    /* The properties outside of components, without $version */
+    ulPosition = 0;
+    assert_int_equal( AzureIoTHubClientProperties_IndexGetNextProperty( &xIndex, NULL, 0, &ulPosition,
+                                                                        &pucPropertyName, &ulPropertyNameLength, &xJSONReader ), eAzureIoTSuccess );
+    assert_memory_equal( pucPropertyName, "not_component", ulPropertyNameLength );
+    assert_int_equal( AzureIoTJSONReader_NextToken( &xJSONReader ), eAzureIoTSuccess );
+    assert_int_equal( AzureIoTJSONReader_GetTokenInt32( &xJSONReader, &lValue ), eAzureIoTSuccess );
+    assert_int_equal( lValue, 42 );
+    assert_int_equal( AzureIoTHubClientProperties_IndexGetNextProperty( &xIndex, NULL, 0, &ulPosition,
+                                                                        &pucPropertyName, &ulPropertyNameLength, &xJSONReader ), eAzureIoTErrorEndOfProperties );
+
+    /* The reported properties of a get response */
+    ulPosition = 0;
+    assert_int_equal( AzureIoTHubClientProperties_BuildIndex( &xTestIoTHubClient, &xIndex, ucTestJSONGetPayload, strlen( ucTestJSONGetPayload ),
+                                                              eAzureIoTHubPropertiesRequestedMessage,
+                                                              eAzureIoTHubClientReportedFromDevice ), eAzureIoTSuccess );
+    assert_int_equal( AzureIoTHubClientProperties_IndexGetNextProperty( &xIndex, NULL, 0, &ulPosition,
+                                                                        &pucPropertyName, &ulPropertyNameLength, &xJSONReader ), eAzureIoTSuccess );
+    assert_memory_equal( pucPropertyName, "PropertyIterationForCurrentConnection", ulPropertyNameLength );
+    assert_int_equal( AzureIoTHubClientProperties_IndexGetNextProperty( &xIndex, "one_component", strlen( "one_component" ), &ulPosition,
+                                                                        &pucPropertyName, &ulPropertyNameLength, &xJSONReader ), eAzureIoTErrorEndOfProperties );
+}
+
 uint32_t ulGetAllTests()
 {
     const struct CMUnitTest tests[] =
@@ -731,6 +893,7 @@ uint32_t ulGetAllTests()
         cmocka_unit_test( testAzureIoTHubClientProperties_BuilderBeginResponseStatus_Failure ),
         cmocka_unit_test( testAzureIoTHubClientProperties_BuilderEndResponseStatus_Failure ),
         cmocka_unit_test( testAzureIoTHubClientProperties_BuilderResponse_Success ),
+        cmocka_unit_test( testAzureIoTHubClientProperties_BuilderCounting_Success ),
         cmocka_unit_test( testAzureIoTHubClientProperties_GetPropertiesVersion_Failure ),
         cmocka_unit_test( testAzureIoTHubClientProperties_GetPropertiesVersion_Success ),
         cmocka_unit_test( testAzureIoTHubClientProperties_GetPropertiesVersionGetDocument_Success ),
@@ -739,6 +902,8 @@ uint32_t ulGetAllTests()
         cmocka_unit_test( testAzureIoTHubClientProperties_GetNextComponentProperty_Success ),
         cmocka_unit_test( testAzureIoTHubClientProperties_GetNextComponentPropertyGetDocument_Success ),
         cmocka_unit_test( testAzureIoTHubClientProperties_GetNextComponentPropertyWriteableUpdate_Success ),
+        cmocka_unit_test( testAzureIoTHubClientProperties_BuildIndex_Failure ),
+        cmocka_unit_test( testAzureIoTHubClientProperties_BuildIndex_Success ),
     };
 
     return ( uint32_t ) cmocka_run_group_tests_name( "azure_iot_hub_client_properties_ut ", tests, NULL, NULL );
@@ -45,6 +45,8 @@ extern uint16_t usTestPacketId;
 extern const uint8_t * pucPublishPayload;
 extern uint16_t usSentQOS;
 extern uint32_t ulDelayReceivePacket;
+extern size_t xPublishStreamBytesSent;
+extern size_t xPublishStreamLength;
 
 static const uint8_t ucHostname[] = "unittest.azure-devices.net";
 static const uint8_t ucDeviceId[] = "testiothub";
@@ -1356,6 +1358,144 @@ static void testAzureIoTHubClient_SendPropertiesReported_Success( void ** ppvSta
 }
 /*-----------------------------------------------------------*/
 
+static AzureIoTResult_t prvTestWriteReportedProperties( AzureIoTJSONWriter_t * pxWriter,
+                                                        void * pvContext )
+{
+    uint32_t * pulExtraProperties = ( uint32_t * ) pvContext;
+    AzureIoTResult_t xResult;
+    int32_t lIndex;
+
+    if( ( xResult = AzureIoTJSONWriter_AppendBeginObject( pxWriter ) ) != eAzureIoTSuccess )
+    {
+        return xResult;
+    }
+
+    for( lIndex = 0; lIndex < 8 + ( int32_t ) *pulExtraProperties; lIndex++ )
+    {
+        if( ( xResult = AzureIoTJSONWriter_AppendPropertyWithInt32Value( pxWriter, ( const uint8_t * ) "telemetrySendFrequency",
+                                                                          sizeof( "telemetrySendFrequency" ) - 1, lIndex ) ) != eAzureIoTSuccess )
+        {
+            return xResult;
+        }
+    }
+
+    /* A document which grows between the two passes */
+    *pulExtraProperties *= 2;
+
+    return AzureIoTJSONWriter_AppendEndObject( pxWriter );
+}
+/*-----------------------------------------------------------*/
+
+static void prvTestSubscribeProperties( AzureIoTHubClient_t * pxTestIoTHubClient )
+{
+    will_return( AzureIoTMQTT_Subscribe, eAzureIoTMQTTSuccess );
+    will_return( AzureIoTMQTT_ProcessLoop, eAzureIoTMQTTSuccess );
+    xPacketInfo.ucType = azureiotmqttPACKET_TYPE_SUBACK;
+    xDeserializedInfo.usPacketIdentifier = usTestPacketId;
+    ulDelayReceivePacket = 0;
+    assert_int_equal( AzureIoTHubClient_SubscribeProperties( pxTestIoTHubClient,
+                                                             prvTestProperties,
+                                                             NULL, ( uint32_t ) -1 ),
+                      eAzureIoTSuccess );
+}
+/*-----------------------------------------------------------*/
+
+static void testAzureIoTHubClient_SendPropertiesReportedStreaming_InvalidArgFailure( void ** ppvState )
+{
+    AzureIoTHubClient_t xTestIoTHubClient;
+    uint8_t ucChunk[ azureiotjsonwriterSTREAMING_BUFFER_MIN_SIZE ];
+    uint32_t ulExtraProperties = 0;
+    uint32_t requestId = 0;
+
+    ( void ) ppvState;
+
+    prvSetupTestIoTHubClient( &xTestIoTHubClient );
+
+    assert_int_equal( AzureIoTHubClient_SendPropertiesReportedStreaming( NULL, prvTestWriteReportedProperties, &ulExtraProperties,
+                                                                         ucChunk, sizeof( ucChunk ), &requestId ),
+                      eAzureIoTErrorInvalidArgument );
+    assert_int_equal( AzureIoTHubClient_SendPropertiesReportedStreaming( &xTestIoTHubClient, NULL, &ulExtraProperties,
+                                                                         ucChunk, sizeof( ucChunk ), &requestId ),
+                      eAzureIoTErrorInvalidArgument );
+    assert_int_equal( AzureIoTHubClient_SendPropertiesReportedStreaming( &xTestIoTHubClient, prvTestWriteReportedProperties, &ulExtraProperties,
+                                                                         ucChunk, sizeof( ucChunk ) - 1, &requestId ),
+                      eAzureIoTErrorInvalidArgument );
+
+    assert_int_equal( AzureIoTHubClient_SendPropertiesReportedStreaming( &xTestIoTHubClient, prvTestWriteReportedProperties, &ulExtraProperties,
+                                                                         ucChunk, sizeof( ucChunk ), &requestId ),
+                      eAzureIoTErrorTopicNotSubscribed );
+}
+/*-----------------------------------------------------------*/
+
+static void testAzureIoTHubClient_SendPropertiesReportedStreaming_SendFailure( void ** ppvState )
+{
+    AzureIoTHubClient_t xTestIoTHubClient;
+    uint8_t ucChunk[ azureiotjsonwriterSTREAMING_BUFFER_MIN_SIZE ];
+    uint32_t ulExtraProperties = 0;
+    uint32_t requestId = 0;
+
+    ( void ) ppvState;
+
+    prvSetupTestIoTHubClient( &xTestIoTHubClient );
+    prvTestSubscribeProperties( &xTestIoTHubClient );
+    pucPublishPayload = NULL;
+
+    /* Nothing was sent, the connection can still be used */
+    will_return( AzureIoTMQTT_PublishHeader, eAzureIoTMQTTSendFailed );
+    assert_int_equal( AzureIoTHubClient_SendPropertiesReportedStreaming( &xTestIoTHubClient, prvTestWriteReportedProperties, &ulExtraProperties,
+                                                                         ucChunk, sizeof( ucChunk ), &requestId ),
+                      eAzureIoTErrorPublishFailed );
+
+    /* The packet was partly sent, the connection must be closed */
+    will_return( AzureIoTMQTT_PublishHeader, eAzureIoTMQTTSuccess );
+    will_return( AzureIoTMQTT_PublishPayload, eAzureIoTMQTTSuccess );
+    will_return( AzureIoTMQTT_PublishPayload, eAzureIoTMQTTSendFailed );
+    assert_int_equal( AzureIoTHubClient_SendPropertiesReportedStreaming( &xTestIoTHubClient, prvTestWriteReportedProperties, &ulExtraProperties,
+                                                                         ucChunk, sizeof( ucChunk ), &requestId ),
+                      eAzureIoTErrorHubClientFailed );
+    assert_true( xPublishStreamBytesSent > 0 );
+    assert_true( xPublishStreamBytesSent < xPublishStreamLength );
+
+    /* The second pass writes more than was counted */
+    ulExtraProperties = 1;
+    will_return( AzureIoTMQTT_PublishHeader, eAzureIoTMQTTSuccess );
+    will_return_always( AzureIoTMQTT_PublishPayload, eAzureIoTMQTTSuccess );
+    assert_int_equal( AzureIoTHubClient_SendPropertiesReportedStreaming( &xTestIoTHubClient, prvTestWriteReportedProperties, &ulExtraProperties,
+                                                                         ucChunk, sizeof( ucChunk ), &requestId ),
+                      eAzureIoTErrorHubClientFailed );
+}
+/*-----------------------------------------------------------*/
+
+static void testAzureIoTHubClient_SendPropertiesReportedStreaming_Success( void ** ppvState )
+{
+    AzureIoTHubClient_t xTestIoTHubClient;
+    AzureIoTJSONWriter_t xWriter;
+    uint8_t ucChunk[ azureiotjsonwriterSTREAMING_BUFFER_MIN_SIZE ];
+    uint8_t ucExpected[ 512 ];
+    uint32_t ulExtraProperties = 0;
+    uint32_t requestId = 0;
+
+    ( void ) ppvState;
+
+    assert_int_equal( AzureIoTJSONWriter_Init( &xWriter, ucExpected, sizeof( ucExpected ) ), eAzureIoTSuccess );
+    assert_int_equal( prvTestWriteReportedProperties( &xWriter, &ulExtraProperties ), eAzureIoTSuccess );
+    assert_true( AzureIoTJSONWriter_GetBytesUsed( &xWriter ) > ( int32_t ) sizeof( ucChunk ) * 3 );
+
+    prvSetupTestIoTHubClient( &xTestIoTHubClient );
+    prvTestSubscribeProperties( &xTestIoTHubClient );
+
+    will_return( AzureIoTMQTT_PublishHeader, eAzureIoTMQTTSuccess );
+    will_return_always( AzureIoTMQTT_PublishPayload, eAzureIoTMQTTSuccess );
+    pucPublishPayload = ucExpected;
+    assert_int_equal( AzureIoTHubClient_SendPropertiesReportedStreaming( &xTestIoTHubClient, prvTestWriteReportedProperties, &ulExtraProperties,
+                                                                         ucChunk, sizeof( ucChunk ), &requestId ),
+                      eAzureIoTSuccess );
+    assert_int_equal( xPublishStreamBytesSent, AzureIoTJSONWriter_GetBytesUsed( &xWriter ) );
+    assert_int_not_equal( requestId, 0 );
+    pucPublishPayload = NULL;
+}
+/*-----------------------------------------------------------*/
+
 static void testAzureIoTHubClient_RequestPropertiesAsync_InvalidArgFailure( void ** ppvState )
 {
     ( void ) ppvState;
@@ -1642,6 +1782,9 @@ uint32_t ulGetAllTests()
         cmocka_unit_test( testAzureIoTHubClient_SendPropertiesReported_NotSubscribeFailure ),
         cmocka_unit_test( testAzureIoTHubClient_SendPropertiesReported_SendFailure ),
         cmocka_unit_test( testAzureIoTHubClient_SendPropertiesReported_Success ),
+        cmocka_unit_test( testAzureIoTHubClient_SendPropertiesReportedStreaming_InvalidArgFailure ),
+        cmocka_unit_test( testAzureIoTHubClient_SendPropertiesReportedStreaming_SendFailure ),
+        cmocka_unit_test( testAzureIoTHubClient_SendPropertiesReportedStreaming_Success ),
         cmocka_unit_test( testAzureIoTHubClient_RequestPropertiesAsync_InvalidArgFailure ),
         cmocka_unit_test( testAzureIoTHubClient_RequestPropertiesAsync_NotSubscribeFailure ),
         cmocka_unit_test( testAzureIoTHubClient_RequestPropertiesAsync_SendFailure ),
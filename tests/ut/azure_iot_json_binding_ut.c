@@ -0,0 +1,248 @@
+/* Copyright (c) Microsoft Corporation.
+ * Licensed under the MIT License. */
+
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <setjmp.h>
+
+#include <cmocka.h>
+
+#include "azure_iot_json_binding.h"
+/*-----------------------------------------------------------*/
+
+#define testTARGET_TEMPERATURE    ( 1U << 0 )
+#define testREPORT_INTERVAL       ( 1U << 1 )
+#define testMODE                  ( 1U << 2 )
+#define testECO_ENABLED           ( 1U << 3 )
+
+typedef struct TestProperties
+{
+    double xTargetTemperature;
+    int32_t lReportInterval;
+    uint8_t ucMode[ 8 ];
+    bool xEcoEnabled;
+} TestProperties_t;
+
+static bool prvIsPositive( const void * pvValue );
+
+static const AzureIoTJSONBinding_t xTestBindings[] =
+{
+    azureiotjsonBINDING( "targetTemperature", eAzureIoTJSONBindingDouble, TestProperties_t, xTargetTemperature, NULL ),
+    azureiotjsonBINDING( "reportInterval", eAzureIoTJSONBindingInt32, TestProperties_t, lReportInterval, prvIsPositive ),
+    azureiotjsonBINDING( "mode", eAzureIoTJSONBindingString, TestProperties_t, ucMode, NULL ),
+    azureiotjsonBINDING( "ecoEnabled", eAzureIoTJSONBindingBool, TestProperties_t, xEcoEnabled, NULL )
+};
+
+#define testBINDING_COUNT    ( sizeof( xTestBindings ) / sizeof( xTestBindings[ 0 ] ) )
+
+static const uint8_t ucTestProperties[] =
+    "{\"targetTemperature\":22.5,\"unknown\":{\"a\":[1,2]},\"reportInterval\":60,"
+    "\"mode\":\"e\\u0063o\",\"ecoEnabled\":true,\"$version\":3}";
+
+static const uint8_t ucTestInvalidProperties[] =
+    "{\"targetTemperature\":\"warm\",\"reportInterval\":-1,\"mode\":\"much too long\",\"ecoEnabled\":[true]}";
+
+static const uint8_t ucTestNotObject[] = "[1,2]";
+/*-----------------------------------------------------------*/
+
+static bool prvIsPositive( const void * pvValue )
+{
+    return *( const int32_t * ) pvValue > 0;
+}
+
+static void prvInitReader( AzureIoTJSONReader_t * pxReader,
+                           const uint8_t * pucJSON,
+                           uint32_t ulJSONLength )
+{
+    assert_int_equal( AzureIoTJSONReader_Init( pxReader, pucJSON, ulJSONLength ), eAzureIoTSuccess );
+    assert_int_equal( AzureIoTJSONReader_NextToken( pxReader ), eAzureIoTSuccess );
+}
+/*-----------------------------------------------------------*/
+
+static void testAzureIoTJSONBinding_ReadObject_InvalidArgument_Failure( void ** ppvState )
+{
+    AzureIoTJSONReader_t xReader;
+    TestProperties_t xProperties;
+    uint32_t ulPresent;
+    uint8_t ucTokenBuffer[ 16 ];
+    AzureIoTJSONBinding_t xWrongSize[] =
+    {
+        azureiotjsonBINDING( "reportInterval", eAzureIoTJSONBindingDouble, TestProperties_t, lReportInterval, NULL )
+    };
+
+    ( void ) ppvState;
+
+    prvInitReader( &xReader, ucTestProperties, sizeof( ucTestProperties ) - 1 );
+
+    assert_int_equal( AzureIoTJSONBinding_ReadObject( NULL, xTestBindings, testBINDING_COUNT, &xProperties, &ulPresent, NULL ),
+                      eAzureIoTErrorInvalidArgument );
+    assert_int_equal( AzureIoTJSONBinding_ReadObject( &xReader, NULL, testBINDING_COUNT, &xProperties, &ulPresent, NULL ),
+                      eAzureIoTErrorInvalidArgument );
+    assert_int_equal( AzureIoTJSONBinding_ReadObject( &xReader, xTestBindings, 0, &xProperties, &ulPresent, NULL ),
+                      eAzureIoTErrorInvalidArgument );
+    assert_int_equal( AzureIoTJSONBinding_ReadObject( &xReader, xTestBindings, azureiotjsonBINDING_MAX + 1, &xProperties, &ulPresent, NULL ),
+                      eAzureIoTErrorInvalidArgument );
+    assert_int_equal( AzureIoTJSONBinding_ReadObject( &xReader, xTestBindings, testBINDING_COUNT, NULL, &ulPresent, NULL ),
+                      eAzureIoTErrorInvalidArgument );
+    assert_int_equal( AzureIoTJSONBinding_ReadObject( &xReader, xTestBindings, testBINDING_COUNT, &xProperties, NULL, NULL ),
+                      eAzureIoTErrorInvalidArgument );
+
+    /* The field does not have the size of the type */
+    assert_int_equal( AzureIoTJSONBinding_ReadObject( &xReader, xWrongSize, 1, &xProperties, &ulPresent, NULL ),
+                      eAzureIoTErrorInvalidArgument );
+
+    /* A resumable reader */
+    assert_int_equal( AzureIoTJSONReader_InitResumable( &xReader, ucTokenBuffer, sizeof( ucTokenBuffer ) ), eAzureIoTSuccess );
+    assert_int_equal( AzureIoTJSONBinding_ReadObject( &xReader, xTestBindings, testBINDING_COUNT, &xProperties, &ulPresent, NULL ),
+                      eAzureIoTErrorInvalidArgument );
+}
+
+static void testAzureIoTJSONBinding_ReadObject_NotObject_Failure( void ** ppvState )
+{
+    AzureIoTJSONReader_t xReader;
+    TestProperties_t xProperties;
+    uint32_t ulPresent;
+
+    ( void ) ppvState;
+
+    prvInitReader( &xReader, ucTestNotObject, sizeof( ucTestNotObject ) - 1 );
+
+    assert_int_equal( AzureIoTJSONBinding_ReadObject( &xReader, xTestBindings, testBINDING_COUNT, &xProperties, &ulPresent, NULL ),
+                      eAzureIoTErrorJSONInvalidState );
+}
+
+static void testAzureIoTJSONBinding_ReadObject_Success( void ** ppvState )
+{
+    AzureIoTJSONReader_t xReader;
+    AzureIoTJSONTokenType_t xTokenType;
+    TestProperties_t xProperties;
+    uint32_t ulPresent;
+    uint32_t ulInvalid;
+
+    ( void ) ppvState;
+
+    memset( &xProperties, 0, sizeof( xProperties ) );
+    prvInitReader( &xReader, ucTestProperties, sizeof( ucTestProperties ) - 1 );
+
+    assert_int_equal( AzureIoTJSONBinding_ReadObject( &xReader, xTestBindings, testBINDING_COUNT, &xProperties, &ulPresent, &ulInvalid ),
+                      eAzureIoTSuccess );
+    assert_int_equal( ulPresent, testTARGET_TEMPERATURE | testREPORT_INTERVAL | testMODE | testECO_ENABLED );
+    assert_int_equal( ulInvalid, 0 );
+    assert_true( xProperties.xTargetTemperature == 22.5 );
+    assert_int_equal( xProperties.lReportInterval, 60 );
+    assert_string_equal( ( const char * ) xProperties.ucMode, "eco" );
+    assert_true( xProperties.xEcoEnabled );
+
+    /* Left on the end of the object */
+    assert_int_equal( AzureIoTJSONReader_TokenType( &xReader, &xTokenType ), eAzureIoTSuccess );
+    assert_int_equal( xTokenType, eAzureIoTJSONTokenEND_OBJECT );
+}
+
+static void testAzureIoTJSONBinding_ReadObject_InvalidValues_Success( void ** ppvState )
+{
+    AzureIoTJSONReader_t xReader;
+    AzureIoTJSONTokenType_t xTokenType;
+    TestProperties_t xProperties;
+    uint32_t ulPresent;
+    uint32_t ulInvalid;
+
+    ( void ) ppvState;
+
+    memset( &xProperties, 0, sizeof( xProperties ) );
+    xProperties.xTargetTemperature = 20.0;
+    xProperties.lReportInterval = 30;
+    prvInitReader( &xReader, ucTestInvalidProperties, sizeof( ucTestInvalidProperties ) - 1 );
+
+    /* Wrong types, a failed validation and a string too long are reported, not stored */
+    assert_int_equal( AzureIoTJSONBinding_ReadObject( &xReader, xTestBindings, testBINDING_COUNT, &xProperties, &ulPresent, &ulInvalid ),
+                      eAzureIoTSuccess );
+    assert_int_equal( ulPresent, 0 );
+    assert_int_equal( ulInvalid, testTARGET_TEMPERATURE | testREPORT_INTERVAL | testMODE | testECO_ENABLED );
+    assert_true( xProperties.xTargetTemperature == 20.0 );
+    assert_int_equal( xProperties.lReportInterval, 30 );
+    assert_string_equal( ( const char * ) xProperties.ucMode, "" );
+    assert_false( xProperties.xEcoEnabled );
+
+    assert_int_equal( AzureIoTJSONReader_TokenType( &xReader, &xTokenType ), eAzureIoTSuccess );
+    assert_int_equal( xTokenType, eAzureIoTJSONTokenEND_OBJECT );
+}
+
+static void testAzureIoTJSONBinding_ReadProperty_Failure( void ** ppvState )
+{
+    AzureIoTJSONReader_t xReader;
+    TestProperties_t xProperties;
+    uint32_t ulPresent = 0;
+    uint8_t ucTokenBuffer[ 16 ];
+
+    ( void ) ppvState;
+
+    prvInitReader( &xReader, ucTestProperties, sizeof( ucTestProperties ) - 1 );
+
+    assert_int_equal( AzureIoTJSONBinding_ReadProperty( NULL, xTestBindings, testBINDING_COUNT, &xProperties, &ulPresent, NULL ),
+                      eAzureIoTErrorInvalidArgument );
+    assert_int_equal( AzureIoTJSONBinding_ReadProperty( &xReader, xTestBindings, testBINDING_COUNT, &xProperties, NULL, NULL ),
+                      eAzureIoTErrorInvalidArgument );
+
+    /* On the beginning of the object, not on a property name */
+    assert_int_equal( AzureIoTJSONBinding_ReadProperty( &xReader, xTestBindings, testBINDING_COUNT, &xProperties, &ulPresent, NULL ),
+                      eAzureIoTErrorJSONInvalidState );
+
+    /* A resumable reader */
+    assert_int_equal( AzureIoTJSONReader_InitResumable( &xReader, ucTokenBuffer, sizeof( ucTokenBuffer ) ), eAzureIoTSuccess );
+    assert_int_equal( AzureIoTJSONBinding_ReadProperty( &xReader, xTestBindings, testBINDING_COUNT, &xProperties, &ulPresent, NULL ),
+                      eAzureIoTErrorInvalidArgument );
+}
+
+static void testAzureIoTJSONBinding_ReadProperty_Success( void ** ppvState )
+{
+    AzureIoTJSONReader_t xReader;
+    TestProperties_t xProperties;
+    uint32_t ulPresent = 0;
+    uint32_t ulInvalid = testREPORT_INTERVAL;
+
+    ( void ) ppvState;
+
+    memset( &xProperties, 0, sizeof( xProperties ) );
+    prvInitReader( &xReader, ucTestProperties, sizeof( ucTestProperties ) - 1 );
+    assert_int_equal( AzureIoTJSONReader_NextToken( &xReader ), eAzureIoTSuccess );
+
+    /* As in the loop over AzureIoTHubClientProperties_GetNextComponentProperty() */
+    assert_int_equal( AzureIoTJSONBinding_ReadProperty( &xReader, xTestBindings, testBINDING_COUNT, &xProperties, &ulPresent, &ulInvalid ),
+                      eAzureIoTSuccess );
+    assert_int_equal( ulPresent, testTARGET_TEMPERATURE );
+    assert_true( xProperties.xTargetTemperature == 22.5 );
+
+    /* Unknown, with its children */
+    assert_int_equal( AzureIoTJSONBinding_ReadProperty( &xReader, xTestBindings, testBINDING_COUNT, &xProperties, &ulPresent, &ulInvalid ),
+                      eAzureIoTErrorItemNotFound );
+    assert_int_equal( ulPresent, testTARGET_TEMPERATURE );
+
+    /* A valid value clears the invalid bit */
+    assert_int_equal( AzureIoTJSONBinding_ReadProperty( &xReader, xTestBindings, testBINDING_COUNT, &xProperties, &ulPresent, &ulInvalid ),
+                      eAzureIoTSuccess );
+    assert_int_equal( ulPresent, testTARGET_TEMPERATURE | testREPORT_INTERVAL );
+    assert_int_equal( ulInvalid, 0 );
+    assert_int_equal( xProperties.lReportInterval, 60 );
+
+    assert_true( AzureIoTJSONReader_TokenIsTextEqual( &xReader, ( const uint8_t * ) "mode", sizeof( "mode" ) - 1 ) );
+}
+/*-----------------------------------------------------------*/
+
+uint32_t ulGetAllTests()
+{
+    const struct CMUnitTest tests[] =
+    {
+        cmocka_unit_test( testAzureIoTJSONBinding_ReadObject_InvalidArgument_Failure ),
+        cmocka_unit_test( testAzureIoTJSONBinding_ReadObject_NotObject_Failure ),
+        cmocka_unit_test( testAzureIoTJSONBinding_ReadObject_Success ),
+        cmocka_unit_test( testAzureIoTJSONBinding_ReadObject_InvalidValues_Success ),
+        cmocka_unit_test( testAzureIoTJSONBinding_ReadProperty_Failure ),
+        cmocka_unit_test( testAzureIoTJSONBinding_ReadProperty_Success )
+    };
+
+    return ( uint32_t ) cmocka_run_group_tests_name( "azure_iot_json_binding_ut", tests, NULL, NULL );
+}
@@ -103,6 +103,21 @@ static uint8_t ucTestJSONArray[] =
 static uint8_t ucTestEmptyJSONArray[] =
     "{}";
 
+/*
+ * {
+ *   "escaped": "a\"b\\c",
+ *   "number": -1.5e3,
+ *   "nothing": null,
+ *   "off": false,
+ *   "empty": [],
+ *   "nested": [{"deep":[0]}]
+ * }
+ */
+static uint8_t ucTestJSONLiterals[] =
+    "{ \"escaped\" : \"a\\\"b\\\\c\",\n"
+    "  \"number\": -1.5e3, \"nothing\": null, \"off\": false,"
+    "  \"empty\": [], \"nested\": [{\"deep\":[0]}] }";
+
 uint32_t ulGetAllTests();
 
 static void testAzureIoTJSONReader_Init_Failure( void ** ppvState )
@@ -553,6 +568,114 @@ static void testAzureIoTJSONReader_GetTokenString_Success( void ** ppvState )
     assert_string_equal( ucValueOne, ucValue );
 }
 
+static void testAzureIoTJSONReader_GetTokenStringView_Failure( void ** ppvState )
+{
+    AzureIoTJSONReader_t xReader;
+    const uint8_t * pucValue;
+    uint32_t ulValueLength;
+    uint8_t ucJSON[] = "{\"name\":\"a\\tb\",\"count\":1}";
+
+    assert_int_equal( AzureIoTJSONReader_GetTokenStringView( NULL, &pucValue, &ulValueLength ),
+                      eAzureIoTErrorInvalidArgument );
+    assert_int_equal( AzureIoTJSONReader_GetTokenStringView( &xReader, NULL, &ulValueLength ),
+                      eAzureIoTErrorInvalidArgument );
+    assert_int_equal( AzureIoTJSONReader_GetTokenStringView( &xReader, &pucValue, NULL ),
+                      eAzureIoTErrorInvalidArgument );
+
+    assert_int_equal( AzureIoTJSONReader_Init( &xReader, ucJSON, sizeof( ucJSON ) - 1 ), eAzureIoTSuccess );
+
+    /* Fail if the token is not a string */
+    assert_int_equal( AzureIoTJSONReader_NextToken( &xReader ), eAzureIoTSuccess );
+    assert_int_equal( AzureIoTJSONReader_GetTokenStringView( &xReader, &pucValue, &ulValueLength ),
+                      eAzureIoTErrorJSONInvalidState );
+
+    /* Fail if the string has escapes */
+    assert_int_equal( AzureIoTJSONReader_NextToken( &xReader ), eAzureIoTSuccess );
+    assert_int_equal( AzureIoTJSONReader_NextToken( &xReader ), eAzureIoTSuccess );
+    assert_int_equal( AzureIoTJSONReader_GetTokenStringView( &xReader, &pucValue, &ulValueLength ),
+                      eAzureIoTErrorFailed );
+}
+
+static void testAzureIoTJSONReader_GetTokenStringView_Success( void ** ppvState )
+{
+    AzureIoTJSONReader_t xReader;
+    const uint8_t * pucValue;
+    uint32_t ulValueLength;
+
+    assert_int_equal( AzureIoTJSONReader_Init( &xReader, ucTestJSONString, strlen( ucTestJSONString ) ),
+                      eAzureIoTSuccess );
+
+    /* Property name */
+    assert_int_equal( AzureIoTJSONReader_NextToken( &xReader ), eAzureIoTSuccess );
+    assert_int_equal( AzureIoTJSONReader_NextToken( &xReader ), eAzureIoTSuccess );
+    assert_int_equal( AzureIoTJSONReader_GetTokenStringView( &xReader, &pucValue, &ulValueLength ), eAzureIoTSuccess );
+    assert_int_equal( ulValueLength, strlen( "property_one" ) );
+    assert_memory_equal( pucValue, "property_one", ulValueLength );
+
+    /* Property string, pointing into the payload */
+    assert_int_equal( AzureIoTJSONReader_NextToken( &xReader ), eAzureIoTSuccess );
+    assert_int_equal( AzureIoTJSONReader_GetTokenStringView( &xReader, &pucValue, &ulValueLength ), eAzureIoTSuccess );
+    assert_int_equal( ulValueLength, strlen( ucValueOne ) );
+    assert_memory_equal( pucValue, ucValueOne, ulValueLength );
+    assert_true( ( pucValue > ( const uint8_t * ) ucTestJSONString ) &&
+                 ( pucValue < ( const uint8_t * ) ucTestJSONString + strlen( ucTestJSONString ) ) );
+}
+
+static void testAzureIoTJSONReader_GetTokenStringInPlace_Failure( void ** ppvState )
+{
+    AzureIoTJSONReader_t xReader;
+    uint8_t * pucValue;
+    uint32_t ulValueLength;
+    uint8_t ucJSON[] = "{\"count\":1}";
+
+    assert_int_equal( AzureIoTJSONReader_GetTokenStringInPlace( NULL, &pucValue, &ulValueLength ),
+                      eAzureIoTErrorInvalidArgument );
+    assert_int_equal( AzureIoTJSONReader_GetTokenStringInPlace( &xReader, NULL, &ulValueLength ),
+                      eAzureIoTErrorInvalidArgument );
+    assert_int_equal( AzureIoTJSONReader_GetTokenStringInPlace( &xReader, &pucValue, NULL ),
+                      eAzureIoTErrorInvalidArgument );
+
+    /* Fail if the token is not a string */
+    assert_int_equal( AzureIoTJSONReader_Init( &xReader, ucJSON, sizeof( ucJSON ) - 1 ), eAzureIoTSuccess );
+    assert_int_equal( AzureIoTJSONReader_NextToken( &xReader ), eAzureIoTSuccess );
+    assert_int_equal( AzureIoTJSONReader_NextToken( &xReader ), eAzureIoTSuccess );
+    assert_int_equal( AzureIoTJSONReader_NextToken( &xReader ), eAzureIoTSuccess );
+    assert_int_equal( AzureIoTJSONReader_GetTokenStringInPlace( &xReader, &pucValue, &ulValueLength ),
+                      eAzureIoTErrorJSONInvalidState );
+}
+
+static void testAzureIoTJSONReader_GetTokenStringInPlace_Success( void ** ppvState )
+{
+    AzureIoTJSONReader_t xReader;
+    AzureIoTJSONTokenType_t xTokenType;
+    uint8_t * pucValue;
+    uint32_t ulValueLength;
+    uint8_t ucJSON[] = "{\"manifest\":\"{\\\"a\\\":\\\"b\\\"}\",\"count\":1}";
+
+    assert_int_equal( AzureIoTJSONReader_Init( &xReader, ucJSON, sizeof( ucJSON ) - 1 ), eAzureIoTSuccess );
+    assert_int_equal( AzureIoTJSONReader_NextToken( &xReader ), eAzureIoTSuccess );
+    assert_int_equal( AzureIoTJSONReader_NextToken( &xReader ), eAzureIoTSuccess );
+    assert_int_equal( AzureIoTJSONReader_NextToken( &xReader ), eAzureIoTSuccess );
+
+    /* Unescaped over the escaped string */
+    assert_int_equal( AzureIoTJSONReader_GetTokenStringInPlace( &xReader, &pucValue, &ulValueLength ), eAzureIoTSuccess );
+    assert_ptr_equal( pucValue, &ucJSON[ 13 ] );
+    assert_int_equal( ulValueLength, 9 );
+    assert_memory_equal( pucValue, "{\"a\":\"b\"}", ulValueLength );
+
+    /* The token reads unescaped after that */
+    assert_true( AzureIoTJSONReader_TokenIsTextEqual( &xReader, ( const uint8_t * ) "{\"a\":\"b\"}", 9 ) );
+    assert_int_equal( AzureIoTJSONReader_GetTokenStringView( &xReader, ( const uint8_t ** ) &pucValue, &ulValueLength ),
+                      eAzureIoTSuccess );
+    assert_int_equal( ulValueLength, 9 );
+
+    /* The reader goes on after the string */
+    assert_int_equal( AzureIoTJSONReader_NextToken( &xReader ), eAzureIoTSuccess );
+    assert_int_equal( AzureIoTJSONReader_TokenType( &xReader, &xTokenType ), eAzureIoTSuccess );
+    assert_int_equal( xTokenType, eAzureIoTJSONTokenPROPERTY_NAME );
+    assert_true( AzureIoTJSONReader_TokenIsTextEqual( &xReader, ( const uint8_t * ) "count", 5 ) );
+}
+
 static void testAzureIoTJSONReader_TokenIsTextEqual_Failure( void ** ppvState )
 {
     AzureIoTJSONReader_t xReader;
@@ -717,6 +840,310 @@ static void testAzureIoTJSONReader_InvalidRead_Failure( void ** ppvState )
                       eAzureIoTErrorJSONReaderDone );
 }
 
+/* The next token of a resumable reader, appending fragments of ulFragmentSize bytes as they are needed */
+static AzureIoTResult_t prvResumableRead( AzureIoTJSONReader_t * pxReader,
+                                          const uint8_t * pucJSON,
+                                          uint32_t ulJSONLength,
+                                          uint32_t ulFragmentSize,
+                                          uint32_t * pulOffset,
+                                          bool xSkipChildren )
+{
+    AzureIoTResult_t xResult;
+    uint32_t ulLength;
+
+    while( ( xResult = ( xSkipChildren ? AzureIoTJSONReader_SkipChildren( pxReader ) :
+                         AzureIoTJSONReader_NextToken( pxReader ) ) ) == eAzureIoTErrorJSONReaderNeedMoreData )
+    {
+        ulLength = ulJSONLength - *pulOffset;
+        ulLength = ulLength < ulFragmentSize ? ulLength : ulFragmentSize;
+        assert_int_equal( AzureIoTJSONReader_AppendFragment( pxReader, pucJSON + *pulOffset, ulLength,
+                                                             ( *pulOffset + ulLength ) == ulJSONLength ), eAzureIoTSuccess );
+        *pulOffset += ulLength;
+    }
+
+    return xResult;
+}
+
+static void prvCheckSameToken( AzureIoTJSONReader_t * pxExpected,
+                               AzureIoTJSONReader_t * pxReader )
+{
+    AzureIoTJSONTokenType_t xExpectedType;
+    AzureIoTJSONTokenType_t xTokenType;
+    uint8_t ucExpectedValue[ 32 ];
+    uint8_t ucValue[ 32 ];
+    uint32_t ulExpectedLength;
+    uint32_t ulLength;
+    double xExpectedDouble;
+    double xDouble;
+
+    assert_int_equal( AzureIoTJSONReader_TokenType( pxExpected, &xExpectedType ), eAzureIoTSuccess );
+    assert_int_equal( AzureIoTJSONReader_TokenType( pxReader, &xTokenType ), eAzureIoTSuccess );
+    assert_int_equal( xTokenType, xExpectedType );
+
+    if( ( xTokenType == eAzureIoTJSONTokenPROPERTY_NAME ) || ( xTokenType == eAzureIoTJSONTokenSTRING ) )
+    {
+        assert_int_equal( AzureIoTJSONReader_GetTokenString( pxExpected, ucExpectedValue, sizeof( ucExpectedValue ), &ulExpectedLength ),
+                          eAzureIoTSuccess );
+        assert_int_equal( AzureIoTJSONReader_GetTokenString( pxReader, ucValue, sizeof( ucValue ), &ulLength ),
+                          eAzureIoTSuccess );
+        assert_int_equal( ulLength, ulExpectedLength );
+        assert_memory_equal( ucValue, ucExpectedValue, ulLength );
+    }
+    else if( xTokenType == eAzureIoTJSONTokenNUMBER )
+    {
+        assert_int_equal( AzureIoTJSONReader_GetTokenDouble( pxExpected, &xExpectedDouble ), eAzureIoTSuccess );
+        assert_int_equal( AzureIoTJSONReader_GetTokenDouble( pxReader, &xDouble ), eAzureIoTSuccess );
+        assert_true( xDouble == xExpectedDouble );
+    }
+}
+
+static void testAzureIoTJSONReader_InitResumable_Failure( void ** ppvState )
+{
+    AzureIoTJSONReader_t xReader;
+    uint8_t ucTokenBuffer[ 16 ];
+
+    assert_int_equal( AzureIoTJSONReader_InitResumable( NULL, ucTokenBuffer, sizeof( ucTokenBuffer ) ),
+                      eAzureIoTErrorInvalidArgument );
+    assert_int_equal( AzureIoTJSONReader_InitResumable( &xReader, NULL, sizeof( ucTokenBuffer ) ),
+                      eAzureIoTErrorInvalidArgument );
+    assert_int_equal( AzureIoTJSONReader_InitResumable( &xReader, ucTokenBuffer, 0 ),
+                      eAzureIoTErrorInvalidArgument );
+}
+
+static void testAzureIoTJSONReader_AppendFragment_Failure( void ** ppvState )
+{
+    AzureIoTJSONReader_t xReader;
+    uint8_t ucTokenBuffer[ 16 ];
+
+    assert_int_equal( AzureIoTJSONReader_AppendFragment( NULL, ucTestJSON, 4, false ),
+                      eAzureIoTErrorInvalidArgument );
+
+    /* Not a resumable reader */
+    assert_int_equal( AzureIoTJSONReader_Init( &xReader, ucTestJSON, strlen( ucTestJSON ) ),
+                      eAzureIoTSuccess );
+    assert_int_equal( AzureIoTJSONReader_AppendFragment( &xReader, ucTestJSON, 4, false ),
+                      eAzureIoTErrorInvalidArgument );
+
+    assert_int_equal( AzureIoTJSONReader_InitResumable( &xReader, ucTokenBuffer, sizeof( ucTokenBuffer ) ),
+                      eAzureIoTSuccess );
+    assert_int_equal( AzureIoTJSONReader_AppendFragment( &xReader, NULL, 4, false ),
+                      eAzureIoTErrorInvalidArgument );
+
+    /* The previous fragment is not read yet */
+    assert_int_equal( AzureIoTJSONReader_AppendFragment( &xReader, ucTestJSON, 4, false ),
+                      eAzureIoTSuccess );
+    assert_int_equal( AzureIoTJSONReader_AppendFragment( &xReader, ucTestJSON + 4, 4, false ),
+                      eAzureIoTErrorJSONInvalidState );
+
+    /* Nothing after the last fragment */
+    assert_int_equal( AzureIoTJSONReader_InitResumable( &xReader, ucTokenBuffer, sizeof( ucTokenBuffer ) ),
+                      eAzureIoTSuccess );
+    assert_int_equal( AzureIoTJSONReader_AppendFragment( &xReader, NULL, 0, true ),
+                      eAzureIoTSuccess );
+    assert_int_equal( AzureIoTJSONReader_AppendFragment( &xReader, ucTestJSON, 4, false ),
+                      eAzureIoTErrorJSONInvalidState );
+}
+
+static void testAzureIoTJSONReader_Resumable_Success( void ** ppvState )
+{
+    uint8_t * ppucDocuments[] = { ucTestJSON, ucTestJSONLiterals, ucTestJSONChildren };
+    AzureIoTJSONReader_t xExpected;
+    AzureIoTJSONReader_t xReader;
+    AzureIoTResult_t xExpectedResult;
+    uint8_t ucTokenBuffer[ 32 ];
+    uint32_t ulDocument;
+    uint32_t ulLength;
+    uint32_t ulFragmentSize;
+    uint32_t ulOffset;
+
+    for( ulDocument = 0; ulDocument < sizeof( ppucDocuments ) / sizeof( ppucDocuments[ 0 ] ); ulDocument++ )
+    {
+        ulLength = strlen( ppucDocuments[ ulDocument ] );
+
+        /* Every fragment size, from one byte to the whole document */
+        for( ulFragmentSize = 1; ulFragmentSize <= ulLength; ulFragmentSize++ )
+        {
+            assert_int_equal( AzureIoTJSONReader_Init( &xExpected, ppucDocuments[ ulDocument ], ulLength ), eAzureIoTSuccess );
+            assert_int_equal( AzureIoTJSONReader_InitResumable( &xReader, ucTokenBuffer, sizeof( ucTokenBuffer ) ), eAzureIoTSuccess );
+            ulOffset = 0;
+
+            do
+            {
+                xExpectedResult = AzureIoTJSONReader_NextToken( &xExpected );
+                assert_int_equal( prvResumableRead( &xReader, ppucDocuments[ ulDocument ], ulLength,
+                                                    ulFragmentSize, &ulOffset, false ), xExpectedResult );
+
+                if( xExpectedResult == eAzureIoTSuccess )
+                {
+                    prvCheckSameToken( &xExpected, &xReader );
+                }
+            } while( xExpectedResult == eAzureIoTSuccess );
+
+            assert_int_equal( xExpectedResult, eAzureIoTErrorJSONReaderDone );
+        }
+    }
+}
+
+static void testAzureIoTJSONReader_ResumableSkipChildren_Success( void ** ppvState )
+{
+    AzureIoTJSONReader_t xReader;
+    AzureIoTJSONTokenType_t xTokenType;
+    uint8_t ucTokenBuffer[ 16 ];
+    uint32_t ulLength = strlen( ucTestJSONChildren );
+    uint32_t ulOffset = 0;
+
+    /* One byte at a time: skipping stops at each fragment end and goes on when called again */
+    assert_int_equal( AzureIoTJSONReader_InitResumable( &xReader, ucTokenBuffer, sizeof( ucTokenBuffer ) ), eAzureIoTSuccess );
+    assert_int_equal( prvResumableRead( &xReader, ucTestJSONChildren, ulLength, 1, &ulOffset, false ), eAzureIoTSuccess );
+    assert_int_equal( prvResumableRead( &xReader, ucTestJSONChildren, ulLength, 1, &ulOffset, false ), eAzureIoTSuccess );
+
+    /* From the property name to the end of its value */
+    assert_int_equal( prvResumableRead( &xReader, ucTestJSONChildren, ulLength, 1, &ulOffset, true ), eAzureIoTSuccess );
+    assert_int_equal( AzureIoTJSONReader_TokenType( &xReader, &xTokenType ), eAzureIoTSuccess );
+    assert_int_equal( xTokenType, eAzureIoTJSONTokenEND_OBJECT );
+
+    assert_int_equal( prvResumableRead( &xReader, ucTestJSONChildren, ulLength, 1, &ulOffset, false ), eAzureIoTSuccess );
+    assert_true( AzureIoTJSONReader_TokenIsTextEqual( &xReader, ucPropertyTwo, strlen( ucPropertyTwo ) ) );
+
+    /* Nothing to skip on a string */
+    assert_int_equal( prvResumableRead( &xReader, ucTestJSONChildren, ulLength, 1, &ulOffset, false ), eAzureIoTSuccess );
+    assert_int_equal( prvResumableRead( &xReader, ucTestJSONChildren, ulLength, 1, &ulOffset, true ), eAzureIoTSuccess );
+    assert_int_equal( AzureIoTJSONReader_TokenType( &xReader, &xTokenType ), eAzureIoTSuccess );
+    assert_int_equal( xTokenType, eAzureIoTJSONTokenSTRING );
+}
+
+static void testAzureIoTJSONReader_ResumableSkipChildrenAbandoned_Success( void ** ppvState )
+{
+    AzureIoTJSONReader_t xReader;
+    AzureIoTJSONTokenType_t xTokenType;
+    uint8_t ucTokenBuffer[ 16 ];
+    uint32_t ulLength = strlen( ucTestJSONChildren );
+    uint32_t ulOffset = 0;
+
+    assert_int_equal( AzureIoTJSONReader_InitResumable( &xReader, ucTokenBuffer, sizeof( ucTokenBuffer ) ), eAzureIoTSuccess );
+    assert_int_equal( prvResumableRead( &xReader, ucTestJSONChildren, ulLength, 1, &ulOffset, false ), eAzureIoTSuccess );
+    assert_int_equal( prvResumableRead( &xReader, ucTestJSONChildren, ulLength, 1, &ulOffset, false ), eAzureIoTSuccess );
+
+    /* The skip stops at the end of the fragment, then the application reads on instead */
+    assert_int_equal( AzureIoTJSONReader_SkipChildren( &xReader ), eAzureIoTErrorJSONReaderNeedMoreData );
+    assert_int_equal( prvResumableRead( &xReader, ucTestJSONChildren, ulLength, 1, &ulOffset, false ), eAzureIoTSuccess );
+    assert_int_equal( AzureIoTJSONReader_TokenType( &xReader, &xTokenType ), eAzureIoTSuccess );
+    assert_int_equal( xTokenType, eAzureIoTJSONTokenBEGIN_OBJECT );
+
+    /* A later skip starts afresh, from the child property name to its value only */
+    assert_int_equal( prvResumableRead( &xReader, ucTestJSONChildren, ulLength, 1, &ulOffset, false ), eAzureIoTSuccess );
+    assert_int_equal( prvResumableRead( &xReader, ucTestJSONChildren, ulLength, 1, &ulOffset, true ), eAzureIoTSuccess );
+    assert_int_equal( AzureIoTJSONReader_TokenType( &xReader, &xTokenType ), eAzureIoTSuccess );
+    assert_int_equal( xTokenType, eAzureIoTJSONTokenSTRING );
+}
+
+static void testAzureIoTJSONReader_ResumableGetTokenStringInPlace( void ** ppvState )
+{
+    AzureIoTJSONReader_t xReader;
+    uint8_t ucTokenBuffer[ 16 ];
+    uint8_t * pucValue;
+    uint32_t ulValueLength;
+    uint32_t ulLength = strlen( ucTestJSONChildren );
+    uint32_t ulOffset = 0;
+
+    /* A token read in place in a fragment is never written */
+    assert_int_equal( AzureIoTJSONReader_InitResumable( &xReader, ucTokenBuffer, sizeof( ucTokenBuffer ) ), eAzureIoTSuccess );
+    assert_int_equal( prvResumableRead( &xReader, ucTestJSONChildren, ulLength, ulLength, &ulOffset, false ), eAzureIoTSuccess );
+    assert_int_equal( prvResumableRead( &xReader, ucTestJSONChildren, ulLength, ulLength, &ulOffset, false ), eAzureIoTSuccess );
+    assert_int_equal( AzureIoTJSONReader_GetTokenStringInPlace( &xReader, &pucValue, &ulValueLength ),
+                      eAzureIoTErrorJSONInvalidState );
+
+    /* A token split across fragments is in the token buffer */
+    ulOffset = 0;
+    assert_int_equal( AzureIoTJSONReader_InitResumable( &xReader, ucTokenBuffer, sizeof( ucTokenBuffer ) ), eAzureIoTSuccess );
+    assert_int_equal( prvResumableRead( &xReader, ucTestJSONChildren, ulLength, 1, &ulOffset, false ), eAzureIoTSuccess );
+    assert_int_equal( prvResumableRead( &xReader, ucTestJSONChildren, ulLength, 1, &ulOffset, false ), eAzureIoTSuccess );
+    assert_int_equal( AzureIoTJSONReader_GetTokenStringInPlace( &xReader, &pucValue, &ulValueLength ), eAzureIoTSuccess );
+    assert_ptr_equal( pucValue, ucTokenBuffer );
+    assert_int_equal( ulValueLength, strlen( "property_one" ) );
+    assert_memory_equal( pucValue, "property_one", ulValueLength );
+}
+
+static void testAzureIoTJSONReader_Resumable_Failure( void ** ppvState )
+{
+    const char * ppcMalformed[] = { "{\"property_one\":}", "{\"a\":1,}", "[1}", "{\"a\" 1}", "{\"a\":tru}",
+                                    "{\"a\":01}", "{\"a\":\"\\q\"}", "{\"a\":1" };
+    AzureIoTJSONReader_t xReader;
+    AzureIoTResult_t xResult;
+    uint8_t ucTokenBuffer[ 16 ];
+    uint32_t ulIndex;
+    uint32_t ulOffset;
+
+    for( ulIndex = 0; ulIndex < sizeof( ppcMalformed ) / sizeof( ppcMalformed[ 0 ] ); ulIndex++ )
+    {
+        assert_int_equal( AzureIoTJSONReader_InitResumable( &xReader, ucTokenBuffer, sizeof( ucTokenBuffer ) ), eAzureIoTSuccess );
+        ulOffset = 0;
+
+        do
+        {
+            xResult = prvResumableRead( &xReader, ( const uint8_t * ) ppcMalformed[ ulIndex ],
+                                        strlen( ppcMalformed[ ulIndex ] ), 2, &ulOffset, false );
+        } while( xResult == eAzureIoTSuccess );
+
+        assert_int_equal( xResult, eAzureIoTErrorUnexpectedChar );
+    }
+
+    /* A token split across fragments must fit in the token buffer */
+    assert_int_equal( AzureIoTJSONReader_InitResumable( &xReader, ucTokenBuffer, 4 ), eAzureIoTSuccess );
+    ulOffset = 0;
+    assert_int_equal( prvResumableRead( &xReader, ucTestJSON, strlen( ucTestJSON ), 4, &ulOffset, false ), eAzureIoTSuccess );
+    assert_int_equal( prvResumableRead( &xReader, ucTestJSON, strlen( ucTestJSON ), 4, &ulOffset, false ), eAzureIoTErrorOutOfMemory );
+}
+
+static void testAzureIoTJSONReader_ResumableUnicodeEscape( void ** ppvState )
+{
+    const char * pcValid = "{\"a\":\"x\\u00e9\\u20ACy\"}";
+    const char * ppcMalformed[] = { "{\"a\":\"\\uZZZZ\"}", "{\"a\":\"\\u12G4\"}", "{\"a\":\"\\u12\"}" };
+    AzureIoTJSONReader_t xReader;
+    AzureIoTJSONTokenType_t xTokenType;
+    AzureIoTResult_t xResult;
+    uint8_t ucTokenBuffer[ 32 ];
+    uint32_t ulIndex;
+    uint32_t ulFragmentSize;
+    uint32_t ulOffset;
+
+    /* Every fragment size, so the 4 hex digits are split at every place */
+    for( ulFragmentSize = 1; ulFragmentSize <= strlen( pcValid ); ulFragmentSize++ )
+    {
+        assert_int_equal( AzureIoTJSONReader_InitResumable( &xReader, ucTokenBuffer, sizeof( ucTokenBuffer ) ), eAzureIoTSuccess );
+        ulOffset = 0;
+        assert_int_equal( prvResumableRead( &xReader, ( const uint8_t * ) pcValid, strlen( pcValid ),
+                                            ulFragmentSize, &ulOffset, false ), eAzureIoTSuccess );
+        assert_int_equal( prvResumableRead( &xReader, ( const uint8_t * ) pcValid, strlen( pcValid ),
+                                            ulFragmentSize, &ulOffset, false ), eAzureIoTSuccess );
+        assert_int_equal( prvResumableRead( &xReader, ( const uint8_t * ) pcValid, strlen( pcValid ),
+                                            ulFragmentSize, &ulOffset, false ), eAzureIoTSuccess );
+        assert_int_equal( AzureIoTJSONReader_TokenType( &xReader, &xTokenType ), eAzureIoTSuccess );
+        assert_int_equal( xTokenType, eAzureIoTJSONTokenSTRING );
+        assert_int_equal( prvResumableRead( &xReader, ( const uint8_t * ) pcValid, strlen( pcValid ),
+                                            ulFragmentSize, &ulOffset, false ), eAzureIoTSuccess );
+        assert_int_equal( prvResumableRead( &xReader, ( const uint8_t * ) pcValid, strlen( pcValid ),
+                                            ulFragmentSize, &ulOffset, false ), eAzureIoTErrorJSONReaderDone );
+    }
+
+    for( ulIndex = 0; ulIndex < sizeof( ppcMalformed ) / sizeof( ppcMalformed[ 0 ] ); ulIndex++ )
+    {
+        for( ulFragmentSize = 1; ulFragmentSize <= strlen( ppcMalformed[ ulIndex ] ); ulFragmentSize++ )
+        {
+            assert_int_equal( AzureIoTJSONReader_InitResumable( &xReader, ucTokenBuffer, sizeof( ucTokenBuffer ) ), eAzureIoTSuccess );
+            ulOffset = 0;
+
+            do
+            {
+                xResult = prvResumableRead( &xReader, ( const uint8_t * ) ppcMalformed[ ulIndex ],
+                                            strlen( ppcMalformed[ ulIndex ] ), ulFragmentSize, &ulOffset, false );
+            } while( xResult == eAzureIoTSuccess );
+
+            assert_int_equal( xResult, eAzureIoTErrorUnexpectedChar );
+        }
+    }
+}
+
 uint32_t ulGetAllTests()
 {
     const struct CMUnitTest tests[] =
@@ -736,11 +1163,23 @@ uint32_t ulGetAllTests()
         cmocka_unit_test( testAzureIoTJSONReader_GetTokenDouble_Success ),
         cmocka_unit_test( testAzureIoTJSONReader_GetTokenString_Failure ),
         cmocka_unit_test( testAzureIoTJSONReader_GetTokenString_Success ),
+        cmocka_unit_test( testAzureIoTJSONReader_GetTokenStringView_Failure ),
+        cmocka_unit_test( testAzureIoTJSONReader_GetTokenStringView_Success ),
+        cmocka_unit_test( testAzureIoTJSONReader_GetTokenStringInPlace_Failure ),
+        cmocka_unit_test( testAzureIoTJSONReader_GetTokenStringInPlace_Success ),
         cmocka_unit_test( testAzureIoTJSONReader_TokenIsTextEqual_Failure ),
         cmocka_unit_test( testAzureIoTJSONReader_TokenIsTextEqual_Success ),
         cmocka_unit_test( testAzureIoTJSONReader_TokenType_Failure ),
         cmocka_unit_test( testAzureIoTJSONReader_TokenType_Success ),
-        cmocka_unit_test( testAzureIoTJSONReader_InvalidRead_Failure )
+        cmocka_unit_test( testAzureIoTJSONReader_InvalidRead_Failure ),
+        cmocka_unit_test( testAzureIoTJSONReader_InitResumable_Failure ),
+        cmocka_unit_test( testAzureIoTJSONReader_AppendFragment_Failure ),
+        cmocka_unit_test( testAzureIoTJSONReader_Resumable_Success ),
+        cmocka_unit_test( testAzureIoTJSONReader_ResumableSkipChildren_Success ),
+        cmocka_unit_test( testAzureIoTJSONReader_ResumableSkipChildrenAbandoned_Success ),
+        cmocka_unit_test( testAzureIoTJSONReader_ResumableGetTokenStringInPlace ),
+        cmocka_unit_test( testAzureIoTJSONReader_Resumable_Failure ),
+        cmocka_unit_test( testAzureIoTJSONReader_ResumableUnicodeEscape )
     };
 
     return ( uint32_t ) cmocka_run_group_tests_name( "azure_iot_json_reader_ut", tests, NULL, NULL );
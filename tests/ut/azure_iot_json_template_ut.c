@@ -0,0 +1,350 @@
+/* Copyright (c) Microsoft Corporation.
+ * Licensed under the MIT License. */
+
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <setjmp.h>
+
+#include <cmocka.h>
+
+#include "azure_iot_json_template.h"
+#include "azure_iot_json_writer.h"
+/*-----------------------------------------------------------*/
+
+#define testBUFFER_SIZE          ( 256 )
+#define testSMALL_BUFFER_SIZE    ( 100 )
+#define testSLOT_COUNT           ( 4 )
+
+typedef struct TestValues
+{
+    double xTemperature;
+    int32_t lBattery;
+    bool xHeating;
+    const char * pcState;
+} TestValues_t;
+
+static uint8_t ucTemperature[] = "temperature";
+static uint8_t ucBattery[] = "battery";
+static uint8_t ucHeating[] = "heating";
+static uint8_t ucState[] = "state";
+
+static AzureIoTJSONTemplate_t xTestTemplate;
+static AzureIoTJSONTemplateSlot_t xTestSlots[ testSLOT_COUNT ];
+static uint8_t ucTestBuffer[ testBUFFER_SIZE ];
+static uint32_t ulTemperatureSlot;
+static uint32_t ulBatterySlot;
+static uint32_t ulHeatingSlot;
+static uint32_t ulStateSlot;
+/*-----------------------------------------------------------*/
+
+static void prvInitTemplate( uint32_t ulBufferSize )
+{
+    assert_int_equal( AzureIoTJSONTemplate_Init( &xTestTemplate, xTestSlots, testSLOT_COUNT, ucTestBuffer, ulBufferSize ),
+                      eAzureIoTSuccess );
+    assert_int_equal( AzureIoTJSONTemplate_AddDoubleProperty( &xTestTemplate, ucTemperature, sizeof( ucTemperature ) - 1,
+                                                              2, &ulTemperatureSlot ), eAzureIoTSuccess );
+    assert_int_equal( AzureIoTJSONTemplate_AddInt32Property( &xTestTemplate, ucBattery, sizeof( ucBattery ) - 1,
+                                                             &ulBatterySlot ), eAzureIoTSuccess );
+    assert_int_equal( AzureIoTJSONTemplate_AddBoolProperty( &xTestTemplate, ucHeating, sizeof( ucHeating ) - 1,
+                                                            &ulHeatingSlot ), eAzureIoTSuccess );
+    assert_int_equal( AzureIoTJSONTemplate_AddStringProperty( &xTestTemplate, ucState, sizeof( ucState ) - 1,
+                                                              &ulStateSlot ), eAzureIoTSuccess );
+    assert_int_equal( AzureIoTJSONTemplate_Render( &xTestTemplate ), eAzureIoTSuccess );
+}
+
+static void prvSetValues( const TestValues_t * pxValues )
+{
+    assert_int_equal( AzureIoTJSONTemplate_SetDouble( &xTestTemplate, ulTemperatureSlot, pxValues->xTemperature ), eAzureIoTSuccess );
+    assert_int_equal( AzureIoTJSONTemplate_SetInt32( &xTestTemplate, ulBatterySlot, pxValues->lBattery ), eAzureIoTSuccess );
+    assert_int_equal( AzureIoTJSONTemplate_SetBool( &xTestTemplate, ulHeatingSlot, pxValues->xHeating ), eAzureIoTSuccess );
+    assert_int_equal( AzureIoTJSONTemplate_SetString( &xTestTemplate, ulStateSlot, ( const uint8_t * ) pxValues->pcState,
+                                                      strlen( pxValues->pcState ) ), eAzureIoTSuccess );
+}
+
+/* Check the payload against the same values written with the JSON writer. */
+static void prvCheckPayload( const TestValues_t * pxValues )
+{
+    AzureIoTJSONWriter_t xWriter;
+    uint8_t ucExpected[ testBUFFER_SIZE ];
+    const uint8_t * pucPayload;
+    uint32_t ulPayloadLength;
+
+    assert_int_equal( AzureIoTJSONWriter_Init( &xWriter, ucExpected, sizeof( ucExpected ) ), eAzureIoTSuccess );
+    assert_int_equal( AzureIoTJSONWriter_AppendBeginObject( &xWriter ), eAzureIoTSuccess );
+    assert_int_equal( AzureIoTJSONWriter_AppendPropertyWithDoubleValue( &xWriter, ucTemperature, sizeof( ucTemperature ) - 1,
+                                                                        pxValues->xTemperature, 2 ), eAzureIoTSuccess );
+    assert_int_equal( AzureIoTJSONWriter_AppendPropertyWithInt32Value( &xWriter, ucBattery, sizeof( ucBattery ) - 1,
+                                                                       pxValues->lBattery ), eAzureIoTSuccess );
+    assert_int_equal( AzureIoTJSONWriter_AppendPropertyWithBoolValue( &xWriter, ucHeating, sizeof( ucHeating ) - 1,
+                                                                      pxValues->xHeating ), eAzureIoTSuccess );
+    assert_int_equal( AzureIoTJSONWriter_AppendPropertyName( &xWriter, ucState, sizeof( ucState ) - 1 ), eAzureIoTSuccess );
+
+    if( strlen( pxValues->pcState ) == 0 )
+    {
+        assert_int_equal( AzureIoTJSONWriter_AppendJSONText( &xWriter, ( const uint8_t * ) "\"\"", 2 ), eAzureIoTSuccess );
+    }
+    else
+    {
+        assert_int_equal( AzureIoTJSONWriter_AppendString( &xWriter, ( const uint8_t * ) pxValues->pcState,
+                                                           strlen( pxValues->pcState ) ), eAzureIoTSuccess );
+    }
+
+    assert_int_equal( AzureIoTJSONWriter_AppendEndObject( &xWriter ), eAzureIoTSuccess );
+
+    assert_int_equal( AzureIoTJSONTemplate_GetPayload( &xTestTemplate, &pucPayload, &ulPayloadLength ), eAzureIoTSuccess );
+    assert_int_equal( ulPayloadLength, AzureIoTJSONWriter_GetBytesUsed( &xWriter ) );
+    assert_memory_equal( pucPayload, ucExpected, ulPayloadLength );
+}
+/*-----------------------------------------------------------*/
+
+static void testAzureIoTJSONTemplate_Init_Failure( void ** ppvState )
+{
+    ( void ) ppvState;
+
+    assert_int_equal( AzureIoTJSONTemplate_Init( NULL, xTestSlots, testSLOT_COUNT, ucTestBuffer, sizeof( ucTestBuffer ) ),
+                      eAzureIoTErrorInvalidArgument );
+    assert_int_equal( AzureIoTJSONTemplate_Init( &xTestTemplate, NULL, testSLOT_COUNT, ucTestBuffer, sizeof( ucTestBuffer ) ),
+                      eAzureIoTErrorInvalidArgument );
+    assert_int_equal( AzureIoTJSONTemplate_Init( &xTestTemplate, xTestSlots, testSLOT_COUNT, NULL, sizeof( ucTestBuffer ) ),
+                      eAzureIoTErrorInvalidArgument );
+    assert_int_equal( AzureIoTJSONTemplate_Init( &xTestTemplate, xTestSlots, testSLOT_COUNT, ucTestBuffer, 0 ),
+                      eAzureIoTErrorInvalidArgument );
+}
+
+static void testAzureIoTJSONTemplate_AddProperty_Failure( void ** ppvState )
+{
+    uint32_t ulSlot;
+
+    ( void ) ppvState;
+
+    assert_int_equal( AzureIoTJSONTemplate_Init( &xTestTemplate, xTestSlots, 1, ucTestBuffer, sizeof( ucTestBuffer ) ),
+                      eAzureIoTSuccess );
+
+    assert_int_equal( AzureIoTJSONTemplate_AddInt32Property( NULL, ucBattery, sizeof( ucBattery ) - 1, &ulSlot ),
+                      eAzureIoTErrorInvalidArgument );
+    assert_int_equal( AzureIoTJSONTemplate_AddInt32Property( &xTestTemplate, NULL, sizeof( ucBattery ) - 1, &ulSlot ),
+                      eAzureIoTErrorInvalidArgument );
+    assert_int_equal( AzureIoTJSONTemplate_AddInt32Property( &xTestTemplate, ucBattery, 0, &ulSlot ),
+                      eAzureIoTErrorInvalidArgument );
+    assert_int_equal( AzureIoTJSONTemplate_AddInt32Property( &xTestTemplate, ucBattery, sizeof( ucBattery ) - 1, NULL ),
+                      eAzureIoTErrorInvalidArgument );
+
+    /* One slot only */
+    assert_int_equal( AzureIoTJSONTemplate_AddInt32Property( &xTestTemplate, ucBattery, sizeof( ucBattery ) - 1, &ulSlot ),
+                      eAzureIoTSuccess );
+    assert_int_equal( ulSlot, 0 );
+    assert_int_equal( AzureIoTJSONTemplate_AddBoolProperty( &xTestTemplate, ucHeating, sizeof( ucHeating ) - 1, &ulSlot ),
+                      eAzureIoTErrorOutOfMemory );
+}
+
+static void testAzureIoTJSONTemplate_Render_Failure( void ** ppvState )
+{
+    const uint8_t * pucPayload;
+    uint32_t ulPayloadLength;
+
+    ( void ) ppvState;
+
+    assert_int_equal( AzureIoTJSONTemplate_Render( NULL ), eAzureIoTErrorInvalidArgument );
+
+    /* Too small for the object */
+    assert_int_equal( AzureIoTJSONTemplate_Init( &xTestTemplate, xTestSlots, testSLOT_COUNT, ucTestBuffer, 8 ),
+                      eAzureIoTSuccess );
+    assert_int_equal( AzureIoTJSONTemplate_AddInt32Property( &xTestTemplate, ucBattery, sizeof( ucBattery ) - 1, &ulBatterySlot ),
+                      eAzureIoTSuccess );
+    assert_int_equal( AzureIoTJSONTemplate_Render( &xTestTemplate ), eAzureIoTErrorOutOfMemory );
+    assert_int_equal( AzureIoTJSONTemplate_GetPayload( &xTestTemplate, &pucPayload, &ulPayloadLength ), eAzureIoTErrorOutOfMemory );
+}
+
+static void testAzureIoTJSONTemplate_Render_Success( void ** ppvState )
+{
+    TestValues_t xValues = { 0, 0, false, "" };
+
+    ( void ) ppvState;
+
+    prvInitTemplate( sizeof( ucTestBuffer ) );
+
+    prvCheckPayload( &xValues );
+}
+
+static void testAzureIoTJSONTemplate_Set_Failure( void ** ppvState )
+{
+    ( void ) ppvState;
+
+    prvInitTemplate( sizeof( ucTestBuffer ) );
+
+    assert_int_equal( AzureIoTJSONTemplate_SetInt32( NULL, ulBatterySlot, 1 ), eAzureIoTErrorInvalidArgument );
+    assert_int_equal( AzureIoTJSONTemplate_SetInt32( &xTestTemplate, testSLOT_COUNT, 1 ), eAzureIoTErrorInvalidArgument );
+    assert_int_equal( AzureIoTJSONTemplate_SetInt32( &xTestTemplate, ulTemperatureSlot, 1 ), eAzureIoTErrorInvalidArgument );
+    assert_int_equal( AzureIoTJSONTemplate_SetDouble( &xTestTemplate, ulBatterySlot, 1.0 ), eAzureIoTErrorInvalidArgument );
+    assert_int_equal( AzureIoTJSONTemplate_SetBool( &xTestTemplate, ulStateSlot, true ), eAzureIoTErrorInvalidArgument );
+    assert_int_equal( AzureIoTJSONTemplate_SetString( &xTestTemplate, ulHeatingSlot, ucState, 1 ), eAzureIoTErrorInvalidArgument );
+    assert_int_equal( AzureIoTJSONTemplate_SetString( &xTestTemplate, ulStateSlot, NULL, 1 ), eAzureIoTErrorInvalidArgument );
+}
+
+static void testAzureIoTJSONTemplate_Set_SameLength_Success( void ** ppvState )
+{
+    TestValues_t xFirst = { 21.25, 87, true, "idle" };
+    TestValues_t xSecond = { 22.75, 86, true, "busy" };
+    uint8_t ucRenamed[] = "temperature";
+
+    ( void ) ppvState;
+
+    assert_int_equal( AzureIoTJSONTemplate_Init( &xTestTemplate, xTestSlots, testSLOT_COUNT, ucTestBuffer, sizeof( ucTestBuffer ) ),
+                      eAzureIoTSuccess );
+    assert_int_equal( AzureIoTJSONTemplate_AddDoubleProperty( &xTestTemplate, ucRenamed, sizeof( ucRenamed ) - 1,
+                                                              2, &ulTemperatureSlot ), eAzureIoTSuccess );
+    assert_int_equal( AzureIoTJSONTemplate_AddInt32Property( &xTestTemplate, ucBattery, sizeof( ucBattery ) - 1,
+                                                             &ulBatterySlot ), eAzureIoTSuccess );
+    assert_int_equal( AzureIoTJSONTemplate_AddBoolProperty( &xTestTemplate, ucHeating, sizeof( ucHeating ) - 1,
+                                                            &ulHeatingSlot ), eAzureIoTSuccess );
+    assert_int_equal( AzureIoTJSONTemplate_AddStringProperty( &xTestTemplate, ucState, sizeof( ucState ) - 1,
+                                                              &ulStateSlot ), eAzureIoTSuccess );
+
+    prvSetValues( &xFirst );
+    prvCheckPayload( &xFirst );
+
+    /* Rendering again would write the changed name, values of the same length are written in place */
+    ucRenamed[ 0 ] = 'T';
+    prvSetValues( &xSecond );
+    ucRenamed[ 0 ] = 't';
+    prvCheckPayload( &xSecond );
+
+    /* false is longer than true */
+    xSecond.xHeating = false;
+    prvSetValues( &xSecond );
+    prvCheckPayload( &xSecond );
+}
+
+static void testAzureIoTJSONTemplate_Set_LengthChange_Success( void ** ppvState )
+{
+    TestValues_t xValues = { 5, 100, true, "heating" };
+
+    ( void ) ppvState;
+
+    prvInitTemplate( sizeof( ucTestBuffer ) );
+
+    prvSetValues( &xValues );
+    prvCheckPayload( &xValues );
+
+    xValues.xTemperature = -12.75;
+    xValues.lBattery = -2147483647 - 1;
+    xValues.pcState = "";
+    prvSetValues( &xValues );
+    prvCheckPayload( &xValues );
+}
+
+static void testAzureIoTJSONTemplate_Set_StringEscape_Success( void ** ppvState )
+{
+    TestValues_t xValues = { 0, 0, false, "ab" };
+
+    ( void ) ppvState;
+
+    prvInitTemplate( sizeof( ucTestBuffer ) );
+
+    prvSetValues( &xValues );
+    prvCheckPayload( &xValues );
+
+    /* Same length, but the quote is escaped */
+    xValues.pcState = "a\"";
+    prvSetValues( &xValues );
+    prvCheckPayload( &xValues );
+
+    /* Same rendered length as the escaped value */
+    xValues.pcState = "abc";
+    prvSetValues( &xValues );
+    prvCheckPayload( &xValues );
+}
+
+static void testAzureIoTJSONTemplate_GetPayload_OutOfMemory_Failure( void ** ppvState )
+{
+    TestValues_t xValues = { 1, 2, true, "ok" };
+    static const char cLong[] = "a value much longer than what is left in the buffer of the template";
+    const uint8_t * pucPayload;
+    uint32_t ulPayloadLength;
+
+    ( void ) ppvState;
+
+    prvInitTemplate( testSMALL_BUFFER_SIZE );
+
+    prvSetValues( &xValues );
+    prvCheckPayload( &xValues );
+
+    /* Only rendering the object finds out it does not fit */
+    assert_int_equal( AzureIoTJSONTemplate_SetString( &xTestTemplate, ulStateSlot, ( const uint8_t * ) cLong, sizeof( cLong ) - 1 ),
+                      eAzureIoTSuccess );
+    assert_int_equal( AzureIoTJSONTemplate_GetPayload( &xTestTemplate, &pucPayload, &ulPayloadLength ), eAzureIoTErrorOutOfMemory );
+
+    /* Fits again with a shorter value */
+    xValues.lBattery = 3;
+    prvSetValues( &xValues );
+    prvCheckPayload( &xValues );
+}
+
+static void testAzureIoTJSONTemplate_GetPayload_Failure( void ** ppvState )
+{
+    const uint8_t * pucPayload;
+    uint32_t ulPayloadLength;
+
+    ( void ) ppvState;
+
+    assert_int_equal( AzureIoTJSONTemplate_Init( &xTestTemplate, xTestSlots, testSLOT_COUNT, ucTestBuffer, sizeof( ucTestBuffer ) ),
+                      eAzureIoTSuccess );
+
+    assert_int_equal( AzureIoTJSONTemplate_GetPayload( NULL, &pucPayload, &ulPayloadLength ), eAzureIoTErrorInvalidArgument );
+    assert_int_equal( AzureIoTJSONTemplate_GetPayload( &xTestTemplate, NULL, &ulPayloadLength ), eAzureIoTErrorInvalidArgument );
+    assert_int_equal( AzureIoTJSONTemplate_GetPayload( &xTestTemplate, &pucPayload, NULL ), eAzureIoTErrorInvalidArgument );
+
+    /* Too small for the object */
+    assert_int_equal( AzureIoTJSONTemplate_Init( &xTestTemplate, xTestSlots, testSLOT_COUNT, ucTestBuffer, 8 ),
+                      eAzureIoTSuccess );
+    assert_int_equal( AzureIoTJSONTemplate_AddInt32Property( &xTestTemplate, ucBattery, sizeof( ucBattery ) - 1, &ulBatterySlot ),
+                      eAzureIoTSuccess );
+    assert_int_equal( AzureIoTJSONTemplate_GetPayload( &xTestTemplate, &pucPayload, &ulPayloadLength ), eAzureIoTErrorOutOfMemory );
+}
+
+static void testAzureIoTJSONTemplate_GetPayload_Success( void ** ppvState )
+{
+    const uint8_t * pucPayload;
+    uint32_t ulPayloadLength;
+
+    ( void ) ppvState;
+
+    /* Rendered on first use */
+    assert_int_equal( AzureIoTJSONTemplate_Init( &xTestTemplate, xTestSlots, testSLOT_COUNT, ucTestBuffer, sizeof( ucTestBuffer ) ),
+                      eAzureIoTSuccess );
+    assert_int_equal( AzureIoTJSONTemplate_GetPayload( &xTestTemplate, &pucPayload, &ulPayloadLength ), eAzureIoTSuccess );
+    assert_int_equal( ulPayloadLength, 2 );
+    assert_memory_equal( pucPayload, "{}", 2 );
+
+    /* Adding a property discards the rendered text */
+    assert_int_equal( AzureIoTJSONTemplate_AddInt32Property( &xTestTemplate, ucBattery, sizeof( ucBattery ) - 1, &ulBatterySlot ),
+                      eAzureIoTSuccess );
+    assert_int_equal( AzureIoTJSONTemplate_GetPayload( &xTestTemplate, &pucPayload, &ulPayloadLength ), eAzureIoTSuccess );
+    assert_int_equal( ulPayloadLength, sizeof( "{\"battery\":0}" ) - 1 );
+    assert_memory_equal( pucPayload, "{\"battery\":0}", ulPayloadLength );
+}
+/*-----------------------------------------------------------*/
+
+uint32_t ulGetAllTests()
+{
+    const struct CMUnitTest tests[] =
+    {
+        cmocka_unit_test( testAzureIoTJSONTemplate_Init_Failure ),
+        cmocka_unit_test( testAzureIoTJSONTemplate_AddProperty_Failure ),
+        cmocka_unit_test( testAzureIoTJSONTemplate_Render_Failure ),
+        cmocka_unit_test( testAzureIoTJSONTemplate_Render_Success ),
+        cmocka_unit_test( testAzureIoTJSONTemplate_Set_Failure ),
+        cmocka_unit_test( testAzureIoTJSONTemplate_Set_SameLength_Success ),
+        cmocka_unit_test( testAzureIoTJSONTemplate_Set_LengthChange_Success ),
+        cmocka_unit_test( testAzureIoTJSONTemplate_Set_StringEscape_Success ),
+        cmocka_unit_test( testAzureIoTJSONTemplate_GetPayload_OutOfMemory_Failure ),
+        cmocka_unit_test( testAzureIoTJSONTemplate_GetPayload_Failure ),
+        cmocka_unit_test( testAzureIoTJSONTemplate_GetPayload_Success )
+    };
+
+    return ( uint32_t ) cmocka_run_group_tests_name( "azure_iot_json_template_ut", tests, NULL, NULL );
+}
@@ -6,6 +6,7 @@
 #include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <math.h>
 #include <setjmp.h>
 
 #include <cmocka.h>
@@ -78,9 +79,236 @@ static uint8_t ucTestJSONCompound[] =
 static uint8_t ucTestJSONArray[] =
     "{\"property\":[\"value_one\",\"value_two\"]}";
 
+/*
+ * [0.1, -2.5, 0.0001, 1e-7, 1e21, 0, 123456.789, 5e-324]
+ */
+static uint8_t ucTestJSONShortestDoubleArray[] =
+    "[0.1,-2.5,0.0001,1e-7,1e21,0,123456.789,5e-324]";
+
+/*
+ * [0.005, -21.37, 21.5, 1, -214748.3648, 0]
+ */
+static uint8_t ucTestJSONFixedPointArray[] =
+    "[0.005,-21.37,21.5,1,-214748.3648,0]";
+
 static uint8_t ucJSONWriterBuffer[ 128 ];
 
 void prvInitJSONWriter( AzureIoTJSONWriter_t * pxWriter );
+typedef struct StreamedJSON
+{
+    uint8_t ucText[ 512 ];
+    uint32_t ulLength;
+    uint32_t ulChunks;
+    AzureIoTResult_t xResult;
+} StreamedJSON_t;
+
+static AzureIoTResult_t prvCollectChunk( const uint8_t * pucData,
+                                         uint32_t ulDataLength,
+                                         void * pvContext )
+{
+    StreamedJSON_t * pxStreamed = ( StreamedJSON_t * ) pvContext;
+
+    assert_true( ulDataLength <= azureiotjsonwriterSTREAMING_BUFFER_MIN_SIZE );
+    assert_true( pxStreamed->ulLength + ulDataLength <= sizeof( pxStreamed->ucText ) );
+    memcpy( pxStreamed->ucText + pxStreamed->ulLength, pucData, ulDataLength );
+    pxStreamed->ulLength += ulDataLength;
+    pxStreamed->ulChunks++;
+
+    return pxStreamed->xResult;
+}
+
+static AzureIoTResult_t prvWriteDocument( AzureIoTJSONWriter_t * pxWriter )
+{
+    AzureIoTResult_t xResult;
+    int32_t lIndex;
+
+    if( ( xResult = AzureIoTJSONWriter_AppendBeginObject( pxWriter ) ) != eAzureIoTSuccess )
+    {
+        return xResult;
+    }
+
+    for( lIndex = 0; lIndex < 10; lIndex++ )
+    {
+        if( ( ( xResult = AzureIoTJSONWriter_AppendPropertyName( pxWriter, ucPropertyName, sizeof( ucPropertyName ) - 1 ) ) != eAzureIoTSuccess ) ||
+            ( ( xResult = AzureIoTJSONWriter_AppendBeginObject( pxWriter ) ) != eAzureIoTSuccess ) ||
+            ( ( xResult = AzureIoTJSONWriter_AppendPropertyWithInt32Value( pxWriter, ucProperty, sizeof( ucProperty ) - 1, lIndex ) ) != eAzureIoTSuccess ) ||
+            ( ( xResult = AzureIoTJSONWriter_AppendPropertyWithStringValue( pxWriter, ucValue, sizeof( ucValue ) - 1,
+                                                                             ucValueOne, sizeof( ucValueOne ) - 1 ) ) != eAzureIoTSuccess ) ||
+            ( ( xResult = AzureIoTJSONWriter_AppendEndObject( pxWriter ) ) != eAzureIoTSuccess ) )
+        {
+            return xResult;
+        }
+    }
+
+    return AzureIoTJSONWriter_AppendEndObject( pxWriter );
+}
+
+static void testAzureIoTJSONWriter_InitStreaming_Failure( void ** ppvState )
+{
+    AzureIoTJSONWriter_t xWriter;
+    uint8_t ucBuffer[ azureiotjsonwriterSTREAMING_BUFFER_MIN_SIZE ];
+    StreamedJSON_t xStreamed = { 0 };
+
+    assert_int_equal( AzureIoTJSONWriter_InitStreaming( NULL, ucBuffer, sizeof( ucBuffer ), prvCollectChunk, &xStreamed ),
+                      eAzureIoTErrorInvalidArgument );
+    assert_int_equal( AzureIoTJSONWriter_InitStreaming( &xWriter, NULL, sizeof( ucBuffer ), prvCollectChunk, &xStreamed ),
+                      eAzureIoTErrorInvalidArgument );
+    assert_int_equal( AzureIoTJSONWriter_InitStreaming( &xWriter, ucBuffer, sizeof( ucBuffer ) - 1, prvCollectChunk, &xStreamed ),
+                      eAzureIoTErrorInvalidArgument );
+    assert_int_equal( AzureIoTJSONWriter_InitStreaming( &xWriter, ucBuffer, sizeof( ucBuffer ), NULL, &xStreamed ),
+                      eAzureIoTErrorInvalidArgument );
+
+    /* Not streaming */
+    assert_int_equal( AzureIoTJSONWriter_Flush( NULL ), eAzureIoTErrorInvalidArgument );
+    assert_int_equal( AzureIoTJSONWriter_Init( &xWriter, ucBuffer, sizeof( ucBuffer ) ), eAzureIoTSuccess );
+    assert_int_equal( AzureIoTJSONWriter_Flush( &xWriter ), eAzureIoTErrorInvalidArgument );
+}
+
+static void testAzureIoTJSONWriter_Streaming_Success( void ** ppvState )
+{
+    AzureIoTJSONWriter_t xWriter;
+    uint8_t ucBuffer[ azureiotjsonwriterSTREAMING_BUFFER_MIN_SIZE ];
+    uint8_t ucExpected[ 512 ];
+    StreamedJSON_t xStreamed = { 0 };
+    int32_t lExpectedLength;
+    int32_t lIndex;
+
+    assert_int_equal( AzureIoTJSONWriter_Init( &xWriter, ucExpected, sizeof( ucExpected ) ), eAzureIoTSuccess );
+    assert_int_equal( prvWriteDocument( &xWriter ), eAzureIoTSuccess );
+    lExpectedLength = AzureIoTJSONWriter_GetBytesUsed( &xWriter );
+
+    xStreamed.xResult = eAzureIoTSuccess;
+    assert_int_equal( AzureIoTJSONWriter_InitStreaming( &xWriter, ucBuffer, sizeof( ucBuffer ), prvCollectChunk, &xStreamed ),
+                      eAzureIoTSuccess );
+    assert_int_equal( prvWriteDocument( &xWriter ), eAzureIoTSuccess );
+    assert_int_equal( AzureIoTJSONWriter_GetBytesUsed( &xWriter ), lExpectedLength );
+    assert_true( xStreamed.ulLength < ( uint32_t ) lExpectedLength );
+
+    assert_int_equal( AzureIoTJSONWriter_Flush( &xWriter ), eAzureIoTSuccess );
+    assert_int_equal( AzureIoTJSONWriter_GetBytesUsed( &xWriter ), lExpectedLength );
+    assert_int_equal( xStreamed.ulLength, lExpectedLength );
+    assert_memory_equal( xStreamed.ucText, ucExpected, lExpectedLength );
+    assert_true( xStreamed.ulChunks > ( uint32_t ) lExpectedLength / sizeof( ucBuffer ) );
+
+    /* Nothing more to flush */
+    assert_int_equal( AzureIoTJSONWriter_Flush( &xWriter ), eAzureIoTSuccess );
+    assert_int_equal( xStreamed.ulLength, lExpectedLength );
+
+    /* Flushing in the middle passes each part of the text once */
+    memset( &xStreamed, 0, sizeof( xStreamed ) );
+    assert_int_equal( AzureIoTJSONWriter_InitStreaming( &xWriter, ucBuffer, sizeof( ucBuffer ), prvCollectChunk, &xStreamed ),
+                      eAzureIoTSuccess );
+    assert_int_equal( AzureIoTJSONWriter_AppendBeginArray( &xWriter ), eAzureIoTSuccess );
+
+    for( lIndex = 0; lIndex < 40; lIndex++ )
+    {
+        assert_int_equal( AzureIoTJSONWriter_AppendInt32( &xWriter, lIndex ), eAzureIoTSuccess );
+
+        if( ( lIndex % 7 ) == 0 )
+        {
+            assert_int_equal( AzureIoTJSONWriter_Flush( &xWriter ), eAzureIoTSuccess );
+        }
+    }
+
+    assert_int_equal( AzureIoTJSONWriter_AppendEndArray( &xWriter ), eAzureIoTSuccess );
+    assert_int_equal( AzureIoTJSONWriter_Flush( &xWriter ), eAzureIoTSuccess );
+
+    assert_int_equal( AzureIoTJSONWriter_Init( &xWriter, ucExpected, sizeof( ucExpected ) ), eAzureIoTSuccess );
+    assert_int_equal( AzureIoTJSONWriter_AppendBeginArray( &xWriter ), eAzureIoTSuccess );
+
+    for( lIndex = 0; lIndex < 40; lIndex++ )
+    {
+        assert_int_equal( AzureIoTJSONWriter_AppendInt32( &xWriter, lIndex ), eAzureIoTSuccess );
+    }
+
+    assert_int_equal( AzureIoTJSONWriter_AppendEndArray( &xWriter ), eAzureIoTSuccess );
+    lExpectedLength = AzureIoTJSONWriter_GetBytesUsed( &xWriter );
+    assert_int_equal( xStreamed.ulLength, lExpectedLength );
+    assert_memory_equal( xStreamed.ucText, ucExpected, lExpectedLength );
+}
+
+static void testAzureIoTJSONWriter_Streaming_Failure( void ** ppvState )
+{
+    AzureIoTJSONWriter_t xWriter;
+    uint8_t ucBuffer[ azureiotjsonwriterSTREAMING_BUFFER_MIN_SIZE ];
+    StreamedJSON_t xStreamed = { 0 };
+
+    xStreamed.xResult = eAzureIoTErrorPublishFailed;
+    assert_int_equal( AzureIoTJSONWriter_InitStreaming( &xWriter, ucBuffer, sizeof( ucBuffer ), prvCollectChunk, &xStreamed ),
+                      eAzureIoTSuccess );
+
+    /* The flush callback result is returned by the append which flushed, and by the next ones */
+    assert_int_equal( prvWriteDocument( &xWriter ), eAzureIoTErrorPublishFailed );
+    assert_int_equal( xStreamed.ulChunks, 1 );
+    assert_int_equal( AzureIoTJSONWriter_AppendNull( &xWriter ), eAzureIoTErrorPublishFailed );
+    assert_int_equal( AzureIoTJSONWriter_Flush( &xWriter ), eAzureIoTErrorPublishFailed );
+    assert_int_equal( xStreamed.ulChunks, 1 );
+}
+
+static void testAzureIoTJSONWriter_InitCounting_Failure( void ** ppvState )
+{
+    AzureIoTJSONWriter_t xWriter;
+    uint8_t ucScratch[ azureiotjsonwriterSTREAMING_BUFFER_MIN_SIZE ];
+
+    assert_int_equal( AzureIoTJSONWriter_InitCounting( NULL, ucScratch, sizeof( ucScratch ) ), eAzureIoTErrorInvalidArgument );
+    assert_int_equal( AzureIoTJSONWriter_InitCounting( &xWriter, NULL, sizeof( ucScratch ) ), eAzureIoTErrorInvalidArgument );
+    assert_int_equal( AzureIoTJSONWriter_InitCounting( &xWriter, ucScratch, sizeof( ucScratch ) - 1 ), eAzureIoTErrorInvalidArgument );
+}
+
+static void testAzureIoTJSONWriter_Counting_Success( void ** ppvState )
+{
+    AzureIoTJSONWriter_t xWriter;
+    uint8_t ucExpected[ 512 ];
+    uint8_t ucScratch[ azureiotjsonwriterSTREAMING_BUFFER_MIN_SIZE ];
+    int32_t lExpectedLength;
+
+    assert_int_equal( AzureIoTJSONWriter_Init( &xWriter, ucExpected, sizeof( ucExpected ) ), eAzureIoTSuccess );
+    assert_int_equal( prvWriteDocument( &xWriter ), eAzureIoTSuccess );
+    lExpectedLength = AzureIoTJSONWriter_GetBytesUsed( &xWriter );
+
+    assert_int_equal( AzureIoTJSONWriter_InitCounting( &xWriter, ucScratch, sizeof( ucScratch ) ), eAzureIoTSuccess );
+    assert_int_equal( AzureIoTJSONWriter_GetBytesUsed( &xWriter ), 0 );
+    assert_int_equal( prvWriteDocument( &xWriter ), eAzureIoTSuccess );
+    assert_true( lExpectedLength > azureiotjsonwriterSTREAMING_BUFFER_MIN_SIZE );
+    assert_int_equal( AzureIoTJSONWriter_GetBytesUsed( &xWriter ), lExpectedLength );
+
+    /* Flushing a counting writer drops nothing from the count */
+    assert_int_equal( AzureIoTJSONWriter_Flush( &xWriter ), eAzureIoTSuccess );
+    assert_int_equal( AzureIoTJSONWriter_GetBytesUsed( &xWriter ), lExpectedLength );
+}
+
+static void testAzureIoTJSONWriter_CountingJSONText_Success( void ** ppvState )
+{
+    AzureIoTJSONWriter_t xWriter;
+    uint8_t ucExpected[ 256 ];
+    uint8_t ucScratch[ azureiotjsonwriterSTREAMING_BUFFER_MIN_SIZE ];
+    const char * pcJSONText = "{\"targetTemperature\":{\"value\":23.5,\"ac\":200,\"av\":12,\"ad\":\"Temperature accepted\"}}";
+    int32_t lExpectedLength;
+
+    assert_true( strlen( pcJSONText ) > azureiotjsonwriterSTREAMING_BUFFER_MIN_SIZE );
+
+    assert_int_equal( AzureIoTJSONWriter_Init( &xWriter, ucExpected, sizeof( ucExpected ) ), eAzureIoTSuccess );
+    assert_int_equal( AzureIoTJSONWriter_AppendBeginArray( &xWriter ), eAzureIoTSuccess );
+    assert_int_equal( AzureIoTJSONWriter_AppendJSONText( &xWriter, pcJSONText, strlen( pcJSONText ) ), eAzureIoTSuccess );
+    assert_int_equal( AzureIoTJSONWriter_AppendJSONText( &xWriter, pcJSONText, strlen( pcJSONText ) ), eAzureIoTSuccess );
+    assert_int_equal( AzureIoTJSONWriter_AppendEndArray( &xWriter ), eAzureIoTSuccess );
+    lExpectedLength = AzureIoTJSONWriter_GetBytesUsed( &xWriter );
+
+    /* The text is counted whole, however long it is */
+    assert_int_equal( AzureIoTJSONWriter_InitCounting( &xWriter, ucScratch, sizeof( ucScratch ) ), eAzureIoTSuccess );
+    assert_int_equal( AzureIoTJSONWriter_AppendBeginArray( &xWriter ), eAzureIoTSuccess );
+    assert_int_equal( AzureIoTJSONWriter_AppendJSONText( &xWriter, pcJSONText, strlen( pcJSONText ) ), eAzureIoTSuccess );
+    assert_int_equal( AzureIoTJSONWriter_AppendJSONText( &xWriter, pcJSONText, strlen( pcJSONText ) ), eAzureIoTSuccess );
+    assert_int_equal( AzureIoTJSONWriter_AppendEndArray( &xWriter ), eAzureIoTSuccess );
+    assert_int_equal( AzureIoTJSONWriter_GetBytesUsed( &xWriter ), lExpectedLength );
+
+    /* Text which isn't a single JSON value is still rejected, and not counted */
+    assert_int_equal( AzureIoTJSONWriter_InitCounting( &xWriter, ucScratch, sizeof( ucScratch ) ), eAzureIoTSuccess );
+    assert_int_not_equal( AzureIoTJSONWriter_AppendJSONText( &xWriter, "{\"a\":1", strlen( "{\"a\":1" ) ), eAzureIoTSuccess );
+    assert_int_not_equal( AzureIoTJSONWriter_AppendJSONText( &xWriter, "1 2", strlen( "1 2" ) ), eAzureIoTSuccess );
+    assert_int_equal( AzureIoTJSONWriter_GetBytesUsed( &xWriter ), 0 );
+}
+
 uint32_t ulGetAllTests();
 
 void prvInitJSONWriter( AzureIoTJSONWriter_t * pxWriter )
@@ -208,6 +436,102 @@ static void testAzureIoTJSONWriter_AppendPropertyWithDouble_Success( void ** ppv
     assert_string_equal( ucJSONWriterBuffer, ucTestJSONDouble );
 }
 
+static void testAzureIoTJSONWriter_AppendPropertyWithShortestDouble_Failure( void ** ppvState )
+{
+    AzureIoTJSONWriter_t xWriter;
+
+    prvInitJSONWriter( &xWriter );
+
+    /* Fail append property with shortest double if JSON writer is NULL */
+    assert_int_equal( AzureIoTJSONWriter_AppendPropertyWithShortestDoubleValue( NULL,
+                                                                                ucPropertyName,
+                                                                                strlen( ucPropertyName ),
+                                                                                xDoubleValue ), eAzureIoTErrorInvalidArgument );
+
+    /* Fail append property with shortest double if property name is NULL */
+    assert_int_equal( AzureIoTJSONWriter_AppendPropertyWithShortestDoubleValue( &xWriter,
+                                                                                NULL,
+                                                                                strlen( ucPropertyName ),
+                                                                                xDoubleValue ), eAzureIoTErrorInvalidArgument );
+
+    /* Fail append property with shortest double if property name length is 0 */
+    assert_int_equal( AzureIoTJSONWriter_AppendPropertyWithShortestDoubleValue( &xWriter,
+                                                                                ucPropertyName,
+                                                                                0,
+                                                                                xDoubleValue ), eAzureIoTErrorInvalidArgument );
+
+    /* Fail append property with shortest double if value is not finite */
+    assert_int_equal( AzureIoTJSONWriter_AppendPropertyWithShortestDoubleValue( &xWriter,
+                                                                                ucPropertyName,
+                                                                                strlen( ucPropertyName ),
+                                                                                NAN ), eAzureIoTErrorInvalidArgument );
+}
+
+static void testAzureIoTJSONWriter_AppendPropertyWithShortestDouble_Success( void ** ppvState )
+{
+    AzureIoTJSONWriter_t xWriter;
+
+    prvInitJSONWriter( &xWriter );
+
+    assert_int_equal( AzureIoTJSONWriter_AppendBeginObject( &xWriter ), eAzureIoTSuccess );
+    assert_int_equal( AzureIoTJSONWriter_AppendPropertyWithShortestDoubleValue( &xWriter,
+                                                                                "property",
+                                                                                strlen( "property" ),
+                                                                                42.42 ), eAzureIoTSuccess );
+    assert_int_equal( AzureIoTJSONWriter_AppendEndObject( &xWriter ), eAzureIoTSuccess );
+    assert_int_equal( AzureIoTJSONWriter_GetBytesUsed( &xWriter ), strlen( ucTestJSONDouble ) );
+
+    assert_string_equal( ucJSONWriterBuffer, ucTestJSONDouble );
+}
+
+static void testAzureIoTJSONWriter_AppendPropertyWithFixedPoint_Failure( void ** ppvState )
+{
+    AzureIoTJSONWriter_t xWriter;
+
+    prvInitJSONWriter( &xWriter );
+
+    /* Fail append property with fixed point if JSON writer is NULL */
+    assert_int_equal( AzureIoTJSONWriter_AppendPropertyWithFixedPointValue( NULL,
+                                                                            ucPropertyName,
+                                                                            strlen( ucPropertyName ),
+                                                                            4242, 2 ), eAzureIoTErrorInvalidArgument );
+
+    /* Fail append property with fixed point if property name is NULL */
+    assert_int_equal( AzureIoTJSONWriter_AppendPropertyWithFixedPointValue( &xWriter,
+                                                                            NULL,
+                                                                            strlen( ucPropertyName ),
+                                                                            4242, 2 ), eAzureIoTErrorInvalidArgument );
+
+    /* Fail append property with fixed point if property name length is 0 */
+    assert_int_equal( AzureIoTJSONWriter_AppendPropertyWithFixedPointValue( &xWriter,
+                                                                            ucPropertyName,
+                                                                            0,
+                                                                            4242, 2 ), eAzureIoTErrorInvalidArgument );
+
+    /* Fail append property with fixed point if scale is more than 15 */
+    assert_int_equal( AzureIoTJSONWriter_AppendPropertyWithFixedPointValue( &xWriter,
+                                                                            ucPropertyName,
+                                                                            strlen( ucPropertyName ),
+                                                                            4242, 16 ), eAzureIoTErrorInvalidArgument );
+}
+
+static void testAzureIoTJSONWriter_AppendPropertyWithFixedPoint_Success( void ** ppvState )
+{
+    AzureIoTJSONWriter_t xWriter;
+
+    prvInitJSONWriter( &xWriter );
+
+    assert_int_equal( AzureIoTJSONWriter_AppendBeginObject( &xWriter ), eAzureIoTSuccess );
+    assert_int_equal( AzureIoTJSONWriter_AppendPropertyWithFixedPointValue( &xWriter,
+                                                                            "property",
+                                                                            strlen( "property" ),
+                                                                            4242, 2 ), eAzureIoTSuccess );
+    assert_int_equal( AzureIoTJSONWriter_AppendEndObject( &xWriter ), eAzureIoTSuccess );
+    assert_int_equal( AzureIoTJSONWriter_GetBytesUsed( &xWriter ), strlen( ucTestJSONDouble ) );
+
+    assert_string_equal( ucJSONWriterBuffer, ucTestJSONDouble );
+}
+
 static void testAzureIoTJSONWriter_AppendPropertyWithBool_Failure( void ** ppvState )
 {
     AzureIoTJSONWriter_t xWriter;
@@ -524,6 +848,83 @@ static void testAzureIoTJSONWriter_AppendDouble_Success( void ** ppvState )
     assert_string_equal( ucJSONWriterBuffer, ucTestJSONDouble );
 }
 
+static void testAzureIoTJSONWriter_AppendShortestDouble_Failure( void ** ppvState )
+{
+    AzureIoTJSONWriter_t xWriter;
+
+    prvInitJSONWriter( &xWriter );
+
+    /* Fail append shortest double if JSON writer is NULL */
+    assert_int_equal( AzureIoTJSONWriter_AppendShortestDouble( NULL,
+                                                               xDoubleValue ), eAzureIoTErrorInvalidArgument );
+
+    /* Fail append shortest double if value is not finite */
+    assert_int_equal( AzureIoTJSONWriter_AppendShortestDouble( &xWriter,
+                                                               NAN ), eAzureIoTErrorInvalidArgument );
+    assert_int_equal( AzureIoTJSONWriter_AppendShortestDouble( &xWriter,
+                                                               -INFINITY ), eAzureIoTErrorInvalidArgument );
+}
+
+static void testAzureIoTJSONWriter_AppendShortestDouble_Success( void ** ppvState )
+{
+    AzureIoTJSONWriter_t xWriter;
+    static const double xValues[] = { 0.1, -2.5, 0.0001, 1e-7, 1e21, -0.0, 123456.789, 5e-324 };
+    uint32_t ulIndex;
+
+    prvInitJSONWriter( &xWriter );
+
+    assert_int_equal( AzureIoTJSONWriter_AppendBeginArray( &xWriter ), eAzureIoTSuccess );
+
+    for( ulIndex = 0; ulIndex < sizeof( xValues ) / sizeof( xValues[ 0 ] ); ulIndex++ )
+    {
+        assert_int_equal( AzureIoTJSONWriter_AppendShortestDouble( &xWriter,
+                                                                   xValues[ ulIndex ] ), eAzureIoTSuccess );
+    }
+
+    assert_int_equal( AzureIoTJSONWriter_AppendEndArray( &xWriter ), eAzureIoTSuccess );
+    assert_int_equal( AzureIoTJSONWriter_GetBytesUsed( &xWriter ), strlen( ucTestJSONShortestDoubleArray ) );
+
+    assert_string_equal( ucJSONWriterBuffer, ucTestJSONShortestDoubleArray );
+}
+
+static void testAzureIoTJSONWriter_AppendFixedPoint_Failure( void ** ppvState )
+{
+    AzureIoTJSONWriter_t xWriter;
+
+    prvInitJSONWriter( &xWriter );
+
+    /* Fail append fixed point if JSON writer is NULL */
+    assert_int_equal( AzureIoTJSONWriter_AppendFixedPoint( NULL,
+                                                           4242, 2 ), eAzureIoTErrorInvalidArgument );
+
+    /* Fail append fixed point if scale is more than 15 */
+    assert_int_equal( AzureIoTJSONWriter_AppendFixedPoint( &xWriter,
+                                                           4242, 16 ), eAzureIoTErrorInvalidArgument );
+}
+
+static void testAzureIoTJSONWriter_AppendFixedPoint_Success( void ** ppvState )
+{
+    AzureIoTJSONWriter_t xWriter;
+    static const int32_t lValues[] = { 5, -2137, 2150, 100, INT32_MIN, 0 };
+    static const uint16_t usScales[] = { 3, 2, 2, 2, 4, 15 };
+    uint32_t ulIndex;
+
+    prvInitJSONWriter( &xWriter );
+
+    assert_int_equal( AzureIoTJSONWriter_AppendBeginArray( &xWriter ), eAzureIoTSuccess );
+
+    for( ulIndex = 0; ulIndex < sizeof( lValues ) / sizeof( lValues[ 0 ] ); ulIndex++ )
+    {
+        assert_int_equal( AzureIoTJSONWriter_AppendFixedPoint( &xWriter,
+                                                               lValues[ ulIndex ], usScales[ ulIndex ] ), eAzureIoTSuccess );
+    }
+
+    assert_int_equal( AzureIoTJSONWriter_AppendEndArray( &xWriter ), eAzureIoTSuccess );
+    assert_int_equal( AzureIoTJSONWriter_GetBytesUsed( &xWriter ), strlen( ucTestJSONFixedPointArray ) );
+
+    assert_string_equal( ucJSONWriterBuffer, ucTestJSONFixedPointArray );
+}
+
 static void testAzureIoTJSONWriter_AppendNull_Failure( void ** ppvState )
 {
     /* Fail append NULL if JSON writer is NULL */
@@ -656,6 +1057,10 @@ uint32_t ulGetAllTests()
         cmocka_unit_test( testAzureIoTJSONWriter_AppendPropertyWithInt32_Success ),
         cmocka_unit_test( testAzureIoTJSONWriter_AppendPropertyWithDouble_Failure ),
         cmocka_unit_test( testAzureIoTJSONWriter_AppendPropertyWithDouble_Success ),
+        cmocka_unit_test( testAzureIoTJSONWriter_AppendPropertyWithShortestDouble_Failure ),
+        cmocka_unit_test( testAzureIoTJSONWriter_AppendPropertyWithShortestDouble_Success ),
+        cmocka_unit_test( testAzureIoTJSONWriter_AppendPropertyWithFixedPoint_Failure ),
+        cmocka_unit_test( testAzureIoTJSONWriter_AppendPropertyWithFixedPoint_Success ),
         cmocka_unit_test( testAzureIoTJSONWriter_AppendPropertyWithBool_Failure ),
         cmocka_unit_test( testAzureIoTJSONWriter_AppendPropertyWithBool_Success ),
         cmocka_unit_test( testAzureIoTJSONWriter_AppendPropertyWithString_Failure ),
@@ -673,6 +1078,10 @@ uint32_t ulGetAllTests()
         cmocka_unit_test( testAzureIoTJSONWriter_AppendInt32_Success ),
         cmocka_unit_test( testAzureIoTJSONWriter_AppendDouble_Failure ),
         cmocka_unit_test( testAzureIoTJSONWriter_AppendDouble_Success ),
+        cmocka_unit_test( testAzureIoTJSONWriter_AppendShortestDouble_Failure ),
+        cmocka_unit_test( testAzureIoTJSONWriter_AppendShortestDouble_Success ),
+        cmocka_unit_test( testAzureIoTJSONWriter_AppendFixedPoint_Failure ),
+        cmocka_unit_test( testAzureIoTJSONWriter_AppendFixedPoint_Success ),
         cmocka_unit_test( testAzureIoTJSONWriter_AppendNull_Failure ),
         cmocka_unit_test( testAzureIoTJSONWriter_AppendNull_Success ),
         cmocka_unit_test( testAzureIoTJSONWriter_AppendBeginObject_Failure ),
@@ -680,7 +1089,13 @@ uint32_t ulGetAllTests()
         cmocka_unit_test( testAzureIoTJSONWriter_AppendBeginArray_Failure ),
         cmocka_unit_test( testAzureIoTJSONWriter_AppendEndArray_Failure ),
         cmocka_unit_test( testAzureIoTJSONWriter_AppendArray_Success ),
-        cmocka_unit_test( testAzureIoTJSONWriter_InvalidWrite_Failure )
+        cmocka_unit_test( testAzureIoTJSONWriter_InvalidWrite_Failure ),
+        cmocka_unit_test( testAzureIoTJSONWriter_InitStreaming_Failure ),
+        cmocka_unit_test( testAzureIoTJSONWriter_Streaming_Success ),
+        cmocka_unit_test( testAzureIoTJSONWriter_Streaming_Failure ),
+        cmocka_unit_test( testAzureIoTJSONWriter_InitCounting_Failure ),
+        cmocka_unit_test( testAzureIoTJSONWriter_Counting_Success ),
+        cmocka_unit_test( testAzureIoTJSONWriter_CountingJSONText_Success )
     };
 
     return ( uint32_t ) cmocka_run_group_tests_name( "azure_iot_json_writer_ut", tests, NULL, NULL );
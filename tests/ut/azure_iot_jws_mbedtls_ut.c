@@ -18,19 +18,66 @@
 
 #include "mbedtls/ctr_drbg.h"
 #include "mbedtls/entropy.h"
+#include "mbedtls/rsa.h"
 #include "mbedtls/threading.h"
+#include "mbedtls/version.h"
 
 #include "threading_alt.h"
 
+#include "azure_iot_crypto.h"
 #include "azure_iot_jws.h"
 /* #include "demo_config.h" */
 #include "FreeRTOSConfig.h"
 
 static mbedtls_entropy_context xEntropyContext;
 static mbedtls_ctr_drbg_context xCtrDrgbContext;
+static uint32_t ulRSAVerifyCount;
 
 uint32_t ulGetAllTests();
 
+/* Count the RSA verifications, the test links with --wrap=mbedtls_rsa_pkcs1_verify */
+#if MBEDTLS_VERSION_NUMBER >= 0x03000000
+    int __real_mbedtls_rsa_pkcs1_verify( mbedtls_rsa_context * ctx,
+                                         mbedtls_md_type_t md_alg,
+                                         unsigned int hashlen,
+                                         const unsigned char * hash,
+                                         const unsigned char * sig );
+
+    int __wrap_mbedtls_rsa_pkcs1_verify( mbedtls_rsa_context * ctx,
+                                         mbedtls_md_type_t md_alg,
+                                         unsigned int hashlen,
+                                         const unsigned char * hash,
+                                         const unsigned char * sig )
+    {
+        ulRSAVerifyCount++;
+
+        return __real_mbedtls_rsa_pkcs1_verify( ctx, md_alg, hashlen, hash, sig );
+    }
+#else
+    int __real_mbedtls_rsa_pkcs1_verify( mbedtls_rsa_context * ctx,
+                                         int ( * f_rng )( void *, unsigned char *, size_t ),
+                                         void * p_rng,
+                                         int mode,
+                                         mbedtls_md_type_t md_alg,
+                                         unsigned int hashlen,
+                                         const unsigned char * hash,
+                                         const unsigned char * sig );
+
+    int __wrap_mbedtls_rsa_pkcs1_verify( mbedtls_rsa_context * ctx,
+                                         int ( * f_rng )( void *, unsigned char *, size_t ),
+                                         void * p_rng,
+                                         int mode,
+                                         mbedtls_md_type_t md_alg,
+                                         unsigned int hashlen,
+                                         const unsigned char * hash,
+                                         const unsigned char * sig )
+    {
+        ulRSAVerifyCount++;
+
+        return __real_mbedtls_rsa_pkcs1_verify( ctx, f_rng, p_rng, mode, md_alg, hashlen, hash, sig );
+    }
+#endif /* MBEDTLS_VERSION_NUMBER >= 0x03000000 */
+
 /* ADU.200702.R */
 static uint8_t ucAzureIoTADURootKeyId200702[ 13 ] = "ADU.200702.R";
 static uint8_t ucAzureIoTADURootKeyN200702[ 385 ]
@@ -226,6 +273,8 @@ static int prvInitMbedTLS( mbedtls_entropy_context * pxEntropyContext,
 static int setup( void ** state )
 {
     memset( ucScratchBuffer, 0, sizeof( ucScratchBuffer ) );
+    AzureIoTJWS_ClearSigningKeyCache();
+    ulRSAVerifyCount = 0;
     return 0;
 }
 
@@ -253,6 +302,220 @@ static void testAzureIoTJWS_ManifestAuthenticate_WrongSha_Failure( void ** ppvSt
                                                         ucScratchBuffer, sizeof( ucScratchBuffer ) ), eAzureIoTErrorFailed );
 }
 
+static void testAzureIoTJWS_ManifestAuthenticate_CachedSigningKey_Success( void ** ppvState )
+{
+    assert_int_equal( AzureIoTJWS_ManifestAuthenticate( ucValidManifest, strlen( ucValidManifest ),
+                                                        ucValidManifestJWS, strlen( ucValidManifestJWS ),
+                                                        &xADURootKeys[ 0 ], sizeof( xADURootKeys ) / sizeof( xADURootKeys[ 0 ] ),
+                                                        ucScratchBuffer, sizeof( ucScratchBuffer ) ), eAzureIoTSuccess );
+    assert_int_equal( ulRSAVerifyCount, 2 );
+
+    /* The signing key is not verified again, the manifest signature is */
+    assert_int_equal( AzureIoTJWS_ManifestAuthenticate( ucValidManifest, strlen( ucValidManifest ),
+                                                        ucValidManifestJWS, strlen( ucValidManifestJWS ),
+                                                        &xADURootKeys[ 0 ], sizeof( xADURootKeys ) / sizeof( xADURootKeys[ 0 ] ),
+                                                        ucScratchBuffer, sizeof( ucScratchBuffer ) ), eAzureIoTSuccess );
+    assert_int_equal( ulRSAVerifyCount, 3 );
+
+    assert_int_equal( AzureIoTJWS_ManifestAuthenticate( ucInvalidManifest, strlen( ucInvalidManifest ),
+                                                        ucValidManifestJWS, strlen( ucValidManifestJWS ),
+                                                        &xADURootKeys[ 0 ], sizeof( xADURootKeys ) / sizeof( xADURootKeys[ 0 ] ),
+                                                        ucScratchBuffer, sizeof( ucScratchBuffer ) ), eAzureIoTErrorFailed );
+    assert_int_equal( AzureIoTJWS_ManifestAuthenticate( ucValidManifest, strlen( ucValidManifest ),
+                                                        ucWrongSHAManifestJWS, strlen( ucWrongSHAManifestJWS ),
+                                                        &xADURootKeys[ 0 ], sizeof( xADURootKeys ) / sizeof( xADURootKeys[ 0 ] ),
+                                                        ucScratchBuffer, sizeof( ucScratchBuffer ) ), eAzureIoTErrorFailed );
+
+    /* Once cleared, the signing key is verified again */
+    AzureIoTJWS_ClearSigningKeyCache();
+    ulRSAVerifyCount = 0;
+    assert_int_equal( AzureIoTJWS_ManifestAuthenticate( ucValidManifest, strlen( ucValidManifest ),
+                                                        ucValidManifestJWS, strlen( ucValidManifestJWS ),
+                                                        &xADURootKeys[ 0 ], sizeof( xADURootKeys ) / sizeof( xADURootKeys[ 0 ] ),
+                                                        ucScratchBuffer, sizeof( ucScratchBuffer ) ), eAzureIoTSuccess );
+    assert_int_equal( ulRSAVerifyCount, 2 );
+}
+
+static void testAzureIoTJWS_ManifestAuthenticate_CachedSigningKeyOtherRootKey_Failure( void ** ppvState )
+{
+    AzureIoTJWS_RootKey_t xOtherRootKeys[ sizeof( xADURootKeys ) / sizeof( xADURootKeys[ 0 ] ) ];
+
+    assert_int_equal( AzureIoTJWS_ManifestAuthenticate( ucValidManifest, strlen( ucValidManifest ),
+                                                        ucValidManifestJWS, strlen( ucValidManifestJWS ),
+                                                        &xADURootKeys[ 0 ], sizeof( xADURootKeys ) / sizeof( xADURootKeys[ 0 ] ),
+                                                        ucScratchBuffer, sizeof( ucScratchBuffer ) ), eAzureIoTSuccess );
+
+    /* Same key id, other modulus: the signing key remembered for the original root key must not be used */
+    memcpy( xOtherRootKeys, xADURootKeys, sizeof( xADURootKeys ) );
+    xOtherRootKeys[ 1 ].pucRootKeyN = ucAzureIoTADURootKeyN200703;
+    xOtherRootKeys[ 1 ].ulRootKeyNLength = sizeof( ucAzureIoTADURootKeyN200703 );
+
+    ulRSAVerifyCount = 0;
+    assert_int_equal( AzureIoTJWS_ManifestAuthenticate( ucValidManifest, strlen( ucValidManifest ),
+                                                        ucValidManifestJWS, strlen( ucValidManifestJWS ),
+                                                        &xOtherRootKeys[ 0 ], sizeof( xOtherRootKeys ) / sizeof( xOtherRootKeys[ 0 ] ),
+                                                        ucScratchBuffer, sizeof( ucScratchBuffer ) ), eAzureIoTErrorFailed );
+    assert_int_equal( ulRSAVerifyCount, 1 );
+}
+
+static uint32_t prvScratchBufferUsed( uint8_t ucFill )
+{
+    uint32_t ulUsed = sizeof( ucScratchBuffer );
+
+    while( ( ulUsed > 0 ) && ( ( uint8_t ) ucScratchBuffer[ ulUsed - 1 ] == ucFill ) )
+    {
+        ulUsed--;
+    }
+
+    return ulUsed;
+}
+
+static void testAzureIoTJWS_ManifestAuthenticate_ScratchUsage_Success( void ** ppvState )
+{
+    /* Two fill patterns, so a byte written with the value of one fill pattern is still counted */
+    const uint8_t ucFill[] = { 0xA5, 0x5A };
+    char ucJWS[ sizeof( ucValidManifestJWS ) ];
+    uint32_t ulPeakUsage = 0;
+    uint32_t ulUsed;
+    uint32_t ulIndex;
+
+    for( ulIndex = 0; ulIndex < sizeof( ucFill ); ulIndex++ )
+    {
+        memcpy( ucJWS, ucValidManifestJWS, sizeof( ucJWS ) );
+        memset( ucScratchBuffer, ucFill[ ulIndex ], sizeof( ucScratchBuffer ) );
+        AzureIoTJWS_ClearSigningKeyCache();
+
+        assert_int_equal( AzureIoTJWS_ManifestAuthenticate( ucValidManifest, strlen( ucValidManifest ),
+                                                            ucJWS, strlen( ucJWS ),
+                                                            &xADURootKeys[ 0 ], sizeof( xADURootKeys ) / sizeof( xADURootKeys[ 0 ] ),
+                                                            ucScratchBuffer, sizeof( ucScratchBuffer ) ), eAzureIoTSuccess );
+
+        /* The JWS is only read */
+        assert_memory_equal( ucJWS, ucValidManifestJWS, sizeof( ucJWS ) );
+
+        ulUsed = prvScratchBufferUsed( ucFill[ ulIndex ] );
+        ulPeakUsage = ( ulUsed > ulPeakUsage ) ? ulUsed : ulPeakUsage;
+    }
+
+    print_message( "JWS scratch buffer peak usage: %u of %u bytes\n",
+                   ( unsigned int ) ulPeakUsage, ( unsigned int ) azureiotjwsSCRATCH_BUFFER_SIZE );
+    assert_true( ulPeakUsage <= azureiotjwsSCRATCH_BUFFER_SIZE );
+}
+
+static void testAzureIoTJWS_ManifestAuthenticate_SmallScratchBuffer_Failure( void ** ppvState )
+{
+    assert_int_equal( AzureIoTJWS_ManifestAuthenticate( ucValidManifest, strlen( ucValidManifest ),
+                                                        ucValidManifestJWS, strlen( ucValidManifestJWS ),
+                                                        &xADURootKeys[ 0 ], sizeof( xADURootKeys ) / sizeof( xADURootKeys[ 0 ] ),
+                                                        ucScratchBuffer, sizeof( ucScratchBuffer ) - 1 ), eAzureIoTErrorOutOfMemory );
+}
+
+/* FIPS 180-2 known answers */
+static const char * const pcSHA256Inputs[] =
+{
+    "",
+    "abc",
+    "abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq",
+    "abcdefghbcdefghicdefghijdefghijkefghijklfghijklmghijklmnhijklmnoijklmnopjklmnopqklmnopqrlmnopqrsmnopqrstnopqrstu"
+};
+static const uint8_t ucSHA256Outputs[][ azureiotcryptoSHA256_SIZE ] =
+{
+    { 0xe3, 0xb0, 0xc4, 0x42, 0x98, 0xfc, 0x1c, 0x14, 0x9a, 0xfb, 0xf4, 0xc8, 0x99, 0x6f, 0xb9, 0x24,
+      0x27, 0xae, 0x41, 0xe4, 0x64, 0x9b, 0x93, 0x4c, 0xa4, 0x95, 0x99, 0x1b, 0x78, 0x52, 0xb8, 0x55 },
+    { 0xba, 0x78, 0x16, 0xbf, 0x8f, 0x01, 0xcf, 0xea, 0x41, 0x41, 0x40, 0xde, 0x5d, 0xae, 0x22, 0x23,
+      0xb0, 0x03, 0x61, 0xa3, 0x96, 0x17, 0x7a, 0x9c, 0xb4, 0x10, 0xff, 0x61, 0xf2, 0x00, 0x15, 0xad },
+    { 0x24, 0x8d, 0x6a, 0x61, 0xd2, 0x06, 0x38, 0xb8, 0xe5, 0xc0, 0x26, 0x93, 0x0c, 0x3e, 0x60, 0x39,
+      0xa3, 0x3c, 0xe4, 0x59, 0x64, 0xff, 0x21, 0x67, 0xf6, 0xec, 0xed, 0xd4, 0x19, 0xdb, 0x06, 0xc1 },
+    { 0xcf, 0x5b, 0x16, 0xa7, 0x78, 0xaf, 0x83, 0x80, 0x03, 0x6c, 0xe5, 0x9e, 0x7b, 0x04, 0x92, 0x37,
+      0x0b, 0x24, 0x9b, 0x11, 0xe8, 0xf0, 0x7a, 0x51, 0xaf, 0xac, 0x45, 0x03, 0x7a, 0xfe, 0xe9, 0xd1 }
+};
+static const uint8_t ucSHA256MillionA[ azureiotcryptoSHA256_SIZE ] =
+{
+    0xcd, 0xc7, 0x6e, 0x5c, 0x99, 0x14, 0xfb, 0x92, 0x81, 0xa1, 0xc7, 0xe2, 0x84, 0xd7, 0x3e, 0x67,
+    0xf1, 0x80, 0x9a, 0x48, 0xa4, 0x97, 0x20, 0x0e, 0x04, 0x6d, 0x39, 0xcc, 0xc7, 0x11, 0x2c, 0xd0
+};
+
+static void testAzureIoTCrypto_SHA256_Success( void ** ppvState )
+{
+    AzureIoTCryptoSHA256Context_t xContext;
+    uint8_t ucOutput[ azureiotcryptoSHA256_SIZE ];
+    uint32_t ulIndex;
+
+    for( ulIndex = 0; ulIndex < sizeof( pcSHA256Inputs ) / sizeof( pcSHA256Inputs[ 0 ] ); ulIndex++ )
+    {
+        assert_int_equal( AzureIoTCrypto_SHA256Init( &xContext ), eAzureIoTSuccess );
+        assert_int_equal( AzureIoTCrypto_SHA256Update( &xContext, ( const uint8_t * ) pcSHA256Inputs[ ulIndex ],
+                                                       ( uint32_t ) strlen( pcSHA256Inputs[ ulIndex ] ) ), eAzureIoTSuccess );
+        assert_int_equal( AzureIoTCrypto_SHA256Final( &xContext, ucOutput, sizeof( ucOutput ) ), eAzureIoTSuccess );
+        assert_memory_equal( ucOutput, ucSHA256Outputs[ ulIndex ], sizeof( ucOutput ) );
+    }
+}
+
+static void testAzureIoTCrypto_SHA256Incremental_Success( void ** ppvState )
+{
+    AzureIoTCryptoSHA256Context_t xContext;
+    uint8_t ucOutput[ azureiotcryptoSHA256_SIZE ];
+    uint8_t ucInput[ 1000 ];
+    uint32_t ulLength;
+    uint32_t ulPiece;
+    uint32_t ulOffset;
+    uint32_t ulIndex;
+
+    /* Every piece size, so the pieces end everywhere in and across the 64 byte blocks */
+    for( ulIndex = 0; ulIndex < sizeof( pcSHA256Inputs ) / sizeof( pcSHA256Inputs[ 0 ] ); ulIndex++ )
+    {
+        ulLength = ( uint32_t ) strlen( pcSHA256Inputs[ ulIndex ] );
+
+        for( ulPiece = 1; ulPiece <= ulLength; ulPiece++ )
+        {
+            assert_int_equal( AzureIoTCrypto_SHA256Init( &xContext ), eAzureIoTSuccess );
+
+            for( ulOffset = 0; ulOffset < ulLength; ulOffset += ulPiece )
+            {
+                assert_int_equal( AzureIoTCrypto_SHA256Update( &xContext, ( const uint8_t * ) pcSHA256Inputs[ ulIndex ] + ulOffset,
+                                                               ( ulLength - ulOffset < ulPiece ) ? ulLength - ulOffset : ulPiece ),
+                                  eAzureIoTSuccess );
+            }
+
+            assert_int_equal( AzureIoTCrypto_SHA256Final( &xContext, ucOutput, sizeof( ucOutput ) ), eAzureIoTSuccess );
+            assert_memory_equal( ucOutput, ucSHA256Outputs[ ulIndex ], sizeof( ucOutput ) );
+        }
+    }
+
+    /* One million 'a', in pieces of 1 to 1000 bytes, and empty updates in between */
+    memset( ucInput, 'a', sizeof( ucInput ) );
+    assert_int_equal( AzureIoTCrypto_SHA256Init( &xContext ), eAzureIoTSuccess );
+
+    for( ulOffset = 0, ulPiece = 1; ulOffset < 1000000; ulOffset += ulPiece, ulPiece = ( ulPiece % sizeof( ucInput ) ) + 1 )
+    {
+        ulPiece = ( 1000000 - ulOffset < ulPiece ) ? 1000000 - ulOffset : ulPiece;
+        assert_int_equal( AzureIoTCrypto_SHA256Update( &xContext, ucInput, ulPiece ), eAzureIoTSuccess );
+        assert_int_equal( AzureIoTCrypto_SHA256Update( &xContext, NULL, 0 ), eAzureIoTSuccess );
+    }
+
+    assert_int_equal( AzureIoTCrypto_SHA256Final( &xContext, ucOutput, sizeof( ucOutput ) ), eAzureIoTSuccess );
+    assert_memory_equal( ucOutput, ucSHA256MillionA, sizeof( ucOutput ) );
+}
+
+static void testAzureIoTCrypto_SHA256_Failure( void ** ppvState )
+{
+    AzureIoTCryptoSHA256Context_t xContext;
+    uint8_t ucOutput[ azureiotcryptoSHA256_SIZE ];
+
+    assert_int_equal( AzureIoTCrypto_SHA256Init( NULL ), eAzureIoTErrorInvalidArgument );
+
+    assert_int_equal( AzureIoTCrypto_SHA256Init( &xContext ), eAzureIoTSuccess );
+    assert_int_equal( AzureIoTCrypto_SHA256Update( NULL, ucOutput, 1 ), eAzureIoTErrorInvalidArgument );
+    assert_int_equal( AzureIoTCrypto_SHA256Update( &xContext, NULL, 1 ), eAzureIoTErrorInvalidArgument );
+    assert_int_equal( AzureIoTCrypto_SHA256Final( NULL, ucOutput, sizeof( ucOutput ) ), eAzureIoTErrorInvalidArgument );
+    assert_int_equal( AzureIoTCrypto_SHA256Final( &xContext, NULL, sizeof( ucOutput ) ), eAzureIoTErrorInvalidArgument );
+    assert_int_equal( AzureIoTCrypto_SHA256Final( &xContext, ucOutput, sizeof( ucOutput ) - 1 ), eAzureIoTErrorInvalidArgument );
+
+    /* The context is still usable after the rejected calls */
+    assert_int_equal( AzureIoTCrypto_SHA256Final( &xContext, ucOutput, sizeof( ucOutput ) ), eAzureIoTSuccess );
+    assert_memory_equal( ucOutput, ucSHA256Outputs[ 0 ], sizeof( ucOutput ) );
+}
+
 uint32_t ulGetAllTests()
 {
     if( prvInitMbedTLS( &xEntropyContext, &xCtrDrgbContext ) != 0 )
@@ -266,6 +529,13 @@ uint32_t ulGetAllTests()
         cmocka_unit_test_setup( testAzureIoTJWS_ManifestAuthenticate_Success,          setup ),
         cmocka_unit_test_setup( testAzureIoTJWS_ManifestAuthenticate_Failure,          setup ),
         cmocka_unit_test_setup( testAzureIoTJWS_ManifestAuthenticate_WrongSha_Failure, setup ),
+        cmocka_unit_test_setup( testAzureIoTJWS_ManifestAuthenticate_CachedSigningKey_Success, setup ),
+        cmocka_unit_test_setup( testAzureIoTJWS_ManifestAuthenticate_CachedSigningKeyOtherRootKey_Failure, setup ),
+        cmocka_unit_test_setup( testAzureIoTJWS_ManifestAuthenticate_ScratchUsage_Success, setup ),
+        cmocka_unit_test_setup( testAzureIoTJWS_ManifestAuthenticate_SmallScratchBuffer_Failure, setup ),
+        cmocka_unit_test( testAzureIoTCrypto_SHA256_Success ),
+        cmocka_unit_test( testAzureIoTCrypto_SHA256Incremental_Success ),
+        cmocka_unit_test( testAzureIoTCrypto_SHA256_Failure ),
     };
 
     return ( uint32_t ) cmocka_run_group_tests_name( "azure_iot_jws_ut", tests, NULL, NULL );
@@ -77,6 +77,8 @@ static const uint8_t ucCustomPayload[] = "{\"modelId\":\"UnitTest\"}";
 static uint8_t ucTopicBuffer[ 128 ];
 static uint32_t ulRequestId = 1;
 static uint64_t ullUnixTime = 0;
+static uint32_t ulRegisterCallbackCount = 0;
+static AzureIoTResult_t xRegisterCallbackResult = eAzureIoTErrorFailed;
 /*-----------------------------------------------------------*/
 
 TickType_t xTaskGetTickCount( void );
@@ -123,6 +125,18 @@ static uint32_t prvHmacFunction( const uint8_t * pucKey,
 }
 /*-----------------------------------------------------------*/
 
+static void prvRegisterCallback( AzureIoTProvisioningClient_t * pxAzureProvClient,
+                                 AzureIoTResult_t xResult,
+                                 void * pvContext )
+{
+    ( void ) pxAzureProvClient;
+
+    assert_ptr_equal( pvContext, &ulRegisterCallbackCount );
+    ulRegisterCallbackCount++;
+    xRegisterCallbackResult = xResult;
+}
+/*-----------------------------------------------------------*/
+
 static void prvGenerateResponse( AzureIoTMQTTPublishInfo_t * pxPublishInfo,
                                  uint32_t ulAssignedResponseAfter,
                                  const uint8_t * pucAssignedResponse,
@@ -798,6 +812,143 @@ static void testAzureIoTProvisioningClient_Register_Success( void ** ppvState )
 }
 /*-----------------------------------------------------------*/
 
+static void testAzureIoTProvisioningClient_ProcessLoop_Failure( void ** ppvState )
+{
+    AzureIoTProvisioningClient_t xTestProvisioningClient;
+    uint32_t ulNextDeadline;
+
+    ( void ) ppvState;
+
+    prvSetupTestProvisioningClient( &xTestProvisioningClient );
+
+    /* Fail when null client is passed */
+    assert_int_equal( AzureIoTProvisioningClient_RegisterAsync( NULL, prvRegisterCallback, NULL ),
+                      eAzureIoTErrorInvalidArgument );
+    assert_int_equal( AzureIoTProvisioningClient_ProcessLoop( NULL, &ulNextDeadline ),
+                      eAzureIoTErrorInvalidArgument );
+
+    /* Fail when registration is not started */
+    assert_int_equal( AzureIoTProvisioningClient_ProcessLoop( &xTestProvisioningClient, &ulNextDeadline ),
+                      eAzureIoTErrorFailed );
+
+    /* Fail when registration is started twice */
+    assert_int_equal( AzureIoTProvisioningClient_RegisterAsync( &xTestProvisioningClient, NULL, NULL ),
+                      eAzureIoTSuccess );
+    assert_int_equal( AzureIoTProvisioningClient_RegisterAsync( &xTestProvisioningClient, NULL, NULL ),
+                      eAzureIoTErrorFailed );
+
+    /* Connect failure is reported through the callback */
+    AzureIoTProvisioningClient_Deinit( &xTestProvisioningClient );
+    prvSetupTestProvisioningClient( &xTestProvisioningClient );
+    ulRegisterCallbackCount = 0;
+    assert_int_equal( AzureIoTProvisioningClient_RegisterAsync( &xTestProvisioningClient,
+                                                                prvRegisterCallback, &ulRegisterCallbackCount ),
+                      eAzureIoTSuccess );
+    will_return( prvHmacFunction, 0 );
+    will_return( AzureIoTMQTT_Connect, eAzureIoTMQTTServerRefused );
+    assert_int_equal( AzureIoTProvisioningClient_ProcessLoop( &xTestProvisioningClient, &ulNextDeadline ),
+                      eAzureIoTErrorServerError );
+    assert_int_equal( ulRegisterCallbackCount, 1 );
+    assert_int_equal( xRegisterCallbackResult, eAzureIoTErrorServerError );
+    assert_int_equal( ulNextDeadline, azureiotprovisioningWAIT_FOREVER );
+
+    AzureIoTProvisioningClient_Deinit( &xTestProvisioningClient );
+}
+/*-----------------------------------------------------------*/
+
+static void testAzureIoTProvisioningClient_ProcessLoop_Success( void ** ppvState )
+{
+    AzureIoTProvisioningClient_t xTestProvisioningClient;
+    AzureIoTMQTTPublishInfo_t xPublishInfo;
+    uint32_t ulNextDeadline;
+
+    ( void ) ppvState;
+
+    prvSetupTestProvisioningClient( &xTestProvisioningClient );
+    ulRegisterCallbackCount = 0;
+    assert_int_equal( AzureIoTProvisioningClient_RegisterAsync( &xTestProvisioningClient,
+                                                                prvRegisterCallback, &ulRegisterCallbackCount ),
+                      eAzureIoTSuccess );
+
+    /* Connect */
+    xPacketInfo.ucType = 0;
+    will_return( prvHmacFunction, 0 );
+    will_return( AzureIoTMQTT_Connect, eAzureIoTMQTTSuccess );
+    will_return( AzureIoTMQTT_ProcessLoop, eAzureIoTMQTTSuccess );
+    assert_int_equal( AzureIoTProvisioningClient_ProcessLoop( &xTestProvisioningClient, &ulNextDeadline ),
+                      eAzureIoTErrorPending );
+    assert_int_equal( ulNextDeadline, 0 );
+
+    /* Subscribe, next step is waiting on the receive path */
+    will_return( AzureIoTMQTT_Subscribe, eAzureIoTMQTTSuccess );
+    will_return( AzureIoTMQTT_ProcessLoop, eAzureIoTMQTTSuccess );
+    assert_int_equal( AzureIoTProvisioningClient_ProcessLoop( &xTestProvisioningClient, &ulNextDeadline ),
+                      eAzureIoTErrorPending );
+    assert_int_not_equal( ulNextDeadline, 0 );
+
+    /* AckSubscribe */
+    xPacketInfo.ucType = azureiotmqttPACKET_TYPE_SUBACK;
+    xDeserializedInfo.usPacketIdentifier = usTestPacketId;
+    will_return( AzureIoTMQTT_ProcessLoop, eAzureIoTMQTTSuccess );
+    assert_int_equal( AzureIoTProvisioningClient_ProcessLoop( &xTestProvisioningClient, &ulNextDeadline ),
+                      eAzureIoTErrorPending );
+    assert_int_equal( ulNextDeadline, 0 );
+
+    /* Publish Registration Request */
+    will_return( AzureIoTMQTT_Publish, eAzureIoTMQTTSuccess );
+    will_return( AzureIoTMQTT_ProcessLoop, eAzureIoTMQTTSuccess );
+    xPacketInfo.ucType = 0;
+    assert_int_equal( AzureIoTProvisioningClient_ProcessLoop( &xTestProvisioningClient, &ulNextDeadline ),
+                      eAzureIoTErrorPending );
+
+    /* Registration response */
+    prvGenerateGoodResponse( &xPublishInfo, 1 );
+    assert_int_equal( AzureIoTProvisioningClient_ProcessLoop( &xTestProvisioningClient, &ulNextDeadline ),
+                      eAzureIoTErrorPending );
+    assert_int_equal( ulNextDeadline, 0 );
+
+    /* Read response, deadline is the retry-after interval */
+    will_return( AzureIoTMQTT_ProcessLoop, eAzureIoTMQTTSuccess );
+    assert_int_equal( AzureIoTProvisioningClient_ProcessLoop( &xTestProvisioningClient, &ulNextDeadline ),
+                      eAzureIoTErrorPending );
+    assert_int_equal( ulNextDeadline, 2000 );
+
+    /* Wait for timeout */
+    will_return( AzureIoTMQTT_ProcessLoop, eAzureIoTMQTTSuccess );
+    ullUnixTime += 2;
+    assert_int_equal( AzureIoTProvisioningClient_ProcessLoop( &xTestProvisioningClient, &ulNextDeadline ),
+                      eAzureIoTErrorPending );
+    assert_int_equal( ulNextDeadline, 0 );
+
+    /* Publish Registration Query */
+    will_return( AzureIoTMQTT_Publish, eAzureIoTMQTTSuccess );
+    will_return( AzureIoTMQTT_ProcessLoop, eAzureIoTMQTTSuccess );
+    xPacketInfo.ucType = 0;
+    assert_int_equal( AzureIoTProvisioningClient_ProcessLoop( &xTestProvisioningClient, &ulNextDeadline ),
+                      eAzureIoTErrorPending );
+
+    /* Registration response */
+    prvGenerateGoodResponse( &xPublishInfo, 0 );
+    assert_int_equal( AzureIoTProvisioningClient_ProcessLoop( &xTestProvisioningClient, &ulNextDeadline ),
+                      eAzureIoTErrorPending );
+    assert_int_equal( ulRegisterCallbackCount, 0 );
+
+    /* Process response */
+    assert_int_equal( AzureIoTProvisioningClient_ProcessLoop( &xTestProvisioningClient, &ulNextDeadline ),
+                      eAzureIoTSuccess );
+    assert_int_equal( ulRegisterCallbackCount, 1 );
+    assert_int_equal( xRegisterCallbackResult, eAzureIoTSuccess );
+    assert_int_equal( ulNextDeadline, azureiotprovisioningWAIT_FOREVER );
+
+    /* Callback is only invoked once */
+    assert_int_equal( AzureIoTProvisioningClient_ProcessLoop( &xTestProvisioningClient, NULL ),
+                      eAzureIoTSuccess );
+    assert_int_equal( ulRegisterCallbackCount, 1 );
+
+    AzureIoTProvisioningClient_Deinit( &xTestProvisioningClient );
+}
+/*-----------------------------------------------------------*/
+
 static void testAzureIoTProvisioningClient_GetDeviceAndHub_Failure( void ** ppvState )
 {
     AzureIoTProvisioningClient_t xTestProvisioningClient;
@@ -952,6 +1103,8 @@ uint32_t ulGetAllTests()
         cmocka_unit_test( testAzureIoTProvisioningClient_Register_QueryDeviceDisabledResponseFailure ),
         cmocka_unit_test( testAzureIoTProvisioningClient_Register_QueryInvalidResponseFailure ),
         cmocka_unit_test( testAzureIoTProvisioningClient_Register_Success ),
+        cmocka_unit_test( testAzureIoTProvisioningClient_ProcessLoop_Failure ),
+        cmocka_unit_test( testAzureIoTProvisioningClient_ProcessLoop_Success ),
         cmocka_unit_test( testAzureIoTProvisioningClient_GetDeviceAndHub_Failure ),
         cmocka_unit_test( testAzureIoTProvisioningClient_GetDeviceAndHub_Success ),
         cmocka_unit_test( testAzureIoTProvisioningClient_WithCustomPayload_Failure ),
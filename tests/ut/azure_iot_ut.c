@@ -11,6 +11,7 @@
 #include <cmocka.h>
 
 #include "azure_iot.h"
+#include "azure_iot_cbor_writer.h"
 #include "azure_iot_message.h"
 #include "azure_iot_private.h"
 #include <azure/core/internal/az_log_internal.h>
@@ -202,6 +203,41 @@ static void testAzureIoTMessagePropertiesFind_Success( void ** ppvState )
 }
 /*-----------------------------------------------------------*/
 
+static void testAzureIoTMessagePropertiesAppendContentType_Success( void ** ppvState )
+{
+    AzureIoTMessageProperties_t xTestMessageProperties;
+    const uint8_t * pucOutValue;
+    uint32_t ulOutValueLength;
+
+    ( void ) ppvState;
+
+    assert_int_equal( AzureIoTMessage_PropertiesInit( &xTestMessageProperties,
+                                                      ucBuffer, 0, sizeof( ucBuffer ) ),
+                      eAzureIoTSuccess );
+
+    assert_int_equal( AzureIoTMessage_PropertiesAppendContentType( NULL,
+                                                                   ( const uint8_t * ) azureiotcborCONTENT_TYPE,
+                                                                   sizeof( azureiotcborCONTENT_TYPE ) - 1 ),
+                      eAzureIoTErrorInvalidArgument );
+    assert_int_equal( AzureIoTMessage_PropertiesAppendContentType( &xTestMessageProperties, NULL, 0 ),
+                      eAzureIoTErrorInvalidArgument );
+
+    assert_int_equal( AzureIoTMessage_PropertiesAppendContentType( &xTestMessageProperties,
+                                                                   ( const uint8_t * ) azureiotcborCONTENT_TYPE,
+                                                                   sizeof( azureiotcborCONTENT_TYPE ) - 1 ),
+                      eAzureIoTSuccess );
+
+    assert_int_equal( AzureIoTMessage_PropertiesFind( &xTestMessageProperties,
+                                                      ( const uint8_t * ) azureiotmessagePROPERTY_CONTENT_TYPE,
+                                                      sizeof( azureiotmessagePROPERTY_CONTENT_TYPE ) - 1,
+                                                      &pucOutValue, &ulOutValueLength ),
+                      eAzureIoTSuccess );
+    assert_int_equal( ulOutValueLength, sizeof( azureiotcborCONTENT_TYPE ) - 1 );
+    assert_memory_equal( pucOutValue, azureiotcborCONTENT_TYPE, ulOutValueLength );
+    assert_memory_equal( ucBuffer, "%24.ct=application%2Fcbor", ulOutValueLength + 7 );
+}
+/*-----------------------------------------------------------*/
+
 static void testAzureIoTInit_Success( void ** ppvState )
 {
     ( void ) ppvState;
@@ -288,6 +324,7 @@ uint32_t ulGetAllTests()
         cmocka_unit_test( testAzureIoTMessagePropertiesAppend_Success ),
         cmocka_unit_test( testAzureIoTMessagePropertiesFind_Failure ),
         cmocka_unit_test( testAzureIoTMessagePropertiesFind_Success ),
+        cmocka_unit_test( testAzureIoTMessagePropertiesAppendContentType_Success ),
         cmocka_unit_test( testAzureIoTInit_Success ),
         cmocka_unit_test( testAzureIoTInit_LogSuccess ),
         cmocka_unit_test( testAzureIoT_Base64HMACCalculateSuccess ),
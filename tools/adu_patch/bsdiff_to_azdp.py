@@ -0,0 +1,92 @@
+#!/usr/bin/env python3
+# Copyright (c) Microsoft Corporation.
+# Licensed under the MIT License.
+
+"""Convert a bsdiff (BSDIFF40) patch to the streaming patch format of azure_iot_adu_patch.h.
+
+bsdiff stores its control, diff and extra streams one after the other, each compressed with bzip2,
+so a device would need the whole patch before rebuilding the first byte. This script interleaves the
+streams segment by segment, so the patch can be applied while it is being downloaded.
+
+Usage:
+    bsdiff old.bin new.bin update.bsdiff
+    python3 bsdiff_to_azdp.py old.bin update.bsdiff update.azdp
+"""
+
+import bz2
+import os
+import struct
+import sys
+
+BSDIFF_MAGIC = b"BSDIFF40"
+AZDP_MAGIC = b"AZDP"
+
+
+def read_offset(data, offset):
+    """Read a bsdiff 64 bits sign and magnitude integer."""
+    value = int.from_bytes(data[offset:offset + 8], "little")
+    if value & (1 << 63):
+        value = -(value & ~(1 << 63))
+    return value
+
+
+def convert(old_size, patch):
+    if patch[:8] != BSDIFF_MAGIC:
+        raise ValueError("not a BSDIFF40 patch")
+
+    control_length = read_offset(patch, 8)
+    diff_length = read_offset(patch, 16)
+    new_size = read_offset(patch, 24)
+
+    if control_length < 0 or diff_length < 0 or new_size < 0 or new_size > 0x7FFFFFFF or old_size > 0x7FFFFFFF:
+        raise ValueError("corrupt patch or image too large")
+
+    control = bz2.decompress(patch[32:32 + control_length])
+    diff = bz2.decompress(patch[32 + control_length:32 + control_length + diff_length])
+    extra = bz2.decompress(patch[32 + control_length + diff_length:])
+
+    output = bytearray(AZDP_MAGIC + struct.pack("<II", old_size, new_size))
+    diff_offset = 0
+    extra_offset = 0
+    new_offset = 0
+
+    for entry in range(0, len(control), 24):
+        segment_diff = read_offset(control, entry)
+        segment_extra = read_offset(control, entry + 8)
+        adjust = read_offset(control, entry + 16)
+
+        if segment_diff < 0 or segment_extra < 0 or new_offset + segment_diff + segment_extra > new_size:
+            raise ValueError("corrupt patch")
+
+        output += struct.pack("<IIi", segment_diff, segment_extra, adjust)
+        output += diff[diff_offset:diff_offset + segment_diff]
+        output += extra[extra_offset:extra_offset + segment_extra]
+        diff_offset += segment_diff
+        extra_offset += segment_extra
+        new_offset += segment_diff + segment_extra
+
+    if new_offset != new_size:
+        raise ValueError("patch does not cover the new image")
+
+    return bytes(output)
+
+
+def main():
+    if len(sys.argv) != 4:
+        print(__doc__)
+        return 1
+
+    with open(sys.argv[2], "rb") as patch_file:
+        patch = patch_file.read()
+
+    output = convert(os.path.getsize(sys.argv[1]), patch)
+
+    with open(sys.argv[3], "wb") as output_file:
+        output_file.write(output)
+
+    print("{}: {} bytes, {} bytes as bsdiff".format(sys.argv[3], len(output), len(patch)))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
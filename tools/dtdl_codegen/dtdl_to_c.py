@@ -0,0 +1,698 @@
+#!/usr/bin/env python3
+# Copyright (c) Microsoft Corporation.
+# Licensed under the MIT License.
+
+"""Generate C serializers and parsers for the telemetry and properties of a DTDL v2 interface.
+
+Hand-written Plug and Play code builds each payload with one AzureIoTJSONWriter_AppendPropertyWith*Value
+call per property, escaping and validating the same property names on every message, and parses
+writable properties with one AzureIoTJSONReader_TokenIsTextEqual call per known name. For the model
+the device announces with pucModelID, this script generates instead:
+
+- <Prefix>Telemetry_t and <Prefix>_SerializeTelemetry(), which copies the JSON text between the
+  values as literal fragments computed here, and only formats the values.
+- <Prefix>ReportedProperties_t and <Prefix>_SerializeReportedProperties() for the read-only
+  properties, written when their bit is set in ulPresent.
+- <Prefix>WritableProperties_t and <Prefix>_ParseWritableProperty(), to call on each property
+  returned by AzureIoTHubClientProperties_GetNextComponentProperty(). It hashes the property name
+  once (FNV-1a, the hashes of the model names are computed here) and switches on the hash.
+
+Supported schemas: boolean, integer (int32_t), long (int64_t), double and float (double), and
+string, date, dateTime, time and duration (strings). Commands, and properties or telemetry of other
+schemas, are rejected unless --skip-unsupported is given.
+
+The generated code uses the internal token of the JSON reader, so regenerate it when updating the SDK.
+
+Usage:
+    python3 dtdl_to_c.py thermostat.json --prefix Thermostat --output thermostat_model
+"""
+
+import argparse
+import json
+import re
+import sys
+
+STRING_SCHEMAS = ("string", "date", "dateTime", "time", "duration")
+
+# C type and Hungarian prefix of the fields of the non-string schemas
+SCHEMAS = {
+    "boolean": ("bool", "x"),
+    "integer": ("int32_t", "l"),
+    "long": ("int64_t", "ll"),
+    "double": ("double", "x"),
+    "float": ("double", "x"),
+}
+
+
+class Field:
+    def __init__(self, name, schema, writable):
+        self.name = name
+        self.schema = schema
+        self.writable = writable
+        self.macro = re.sub(r"(?<=[a-z0-9])(?=[A-Z])", "_", name).upper()
+        self.suffix = name[0].upper() + name[1:]
+
+    @property
+    def is_string(self):
+        return self.schema in STRING_SCHEMAS
+
+
+def fnv1a(data):
+    value = 0x811C9DC5
+    for byte in data:
+        value = ((value ^ byte) * 0x01000193) & 0xFFFFFFFF
+    return value
+
+
+def c_string(text):
+    """C string literal of text."""
+    return '"' + text.replace("\\", "\\\\").replace('"', '\\"') + '"'
+
+
+def json_string(text):
+    return json.dumps(text, ensure_ascii=True)
+
+
+def load_fields(model, skip_unsupported):
+    telemetry = []
+    properties = []
+
+    for content in model.get("contents", []):
+        types = content.get("@type")
+        types = types if isinstance(types, list) else [types]
+        name = content.get("name", "")
+        schema = content.get("schema")
+
+        if "Telemetry" in types:
+            kind = telemetry
+        elif "Property" in types:
+            kind = properties
+        else:
+            # Commands are handled by the command callback, not by the property or telemetry code
+            continue
+
+        if not re.fullmatch(r"[A-Za-z][A-Za-z0-9_]{0,63}", name):
+            raise ValueError("invalid DTDL name: %r" % name)
+
+        if not isinstance(schema, str) or (schema not in SCHEMAS and schema not in STRING_SCHEMAS):
+            if skip_unsupported:
+                sys.stderr.write("skipping %s: unsupported schema %s\n" % (name, json.dumps(schema)))
+                continue
+            raise ValueError("%s: unsupported schema %s, use --skip-unsupported" % (name, json.dumps(schema)))
+
+        kind.append(Field(name, schema, bool(content.get("writable", False))))
+
+    return telemetry, properties
+
+
+class Generator:
+    def __init__(self, model_id, prefix, output, component, fractional_digits, string_max):
+        self.model_id = model_id
+        self.prefix = prefix
+        self.macro = prefix.lower()
+        self.output = output
+        self.component = component
+        self.fractional_digits = fractional_digits
+        self.string_max = string_max
+        self.helpers = set()
+
+    def field_decl(self, field, owned):
+        if field.is_string:
+            if owned:
+                return ["uint8_t uc%s[ %sSTRING_MAX ];" % (field.suffix, self.macro),
+                        "uint32_t ul%sLength;" % field.suffix]
+            return ["const uint8_t * puc%s;" % field.suffix,
+                    "uint32_t ul%sLength;" % field.suffix]
+
+        c_type, hungarian = SCHEMAS[field.schema]
+        return ["%s %s%s;" % (c_type, hungarian, field.suffix)]
+
+    def struct(self, name, fields, present, owned, doc):
+        lines = ["/**", " * @brief %s" % doc, " */", "typedef struct %s%s" % (self.prefix, name), "{"]
+        if present:
+            lines.append("    uint32_t ulPresent; /**< Bits of the properties set, #%s%s_* values. */"
+                         % (self.macro, name.upper().replace("PROPERTIES", "")))
+        for field in fields:
+            decls = self.field_decl(field, owned)
+            lines.append("    %s /**< %s */" % (decls[0], json_string(field.name)))
+            lines.extend("    " + decl for decl in decls[1:])
+        lines += ["} %s%s_t;" % (self.prefix, name), ""]
+        if present:
+            for index, field in enumerate(fields):
+                lines.append("#define %s%s_%s    ( 1UL << %d )"
+                             % (self.macro, name.upper().replace("PROPERTIES", ""), field.macro, index))
+            lines.append("")
+        return lines
+
+    def value(self, field, access):
+        if field.is_string:
+            self.helpers.add("string")
+            return ("prvAppendString( pucBuffer, ulBufferLength, &ulOffset, %s->puc%s, %s->ul%sLength )"
+                    % (access, field.suffix, access, field.suffix))
+        if field.schema == "boolean":
+            return ("prvAppendLiteral( pucBuffer, ulBufferLength, &ulOffset, %s->x%s ? \"true\" : \"false\", %s->x%s ? 4 : 5 )"
+                    % (access, field.suffix, access, field.suffix))
+        if field.schema in ("integer", "long"):
+            self.helpers.add("integer")
+            hungarian = SCHEMAS[field.schema][1]
+            return ("prvAppendInteger( pucBuffer, ulBufferLength, &ulOffset, %s->%s%s )"
+                    % (access, hungarian, field.suffix))
+        self.helpers.add("double")
+        return ("prvAppendDouble( pucBuffer, ulBufferLength, &ulOffset, %s->x%s )" % (access, field.suffix))
+
+    def append(self, call):
+        return ["    if( ( xResult = %s ) != eAzureIoTSuccess )" % call,
+                "    {",
+                "        return xResult;",
+                "    }",
+                ""]
+
+    def literal(self, text):
+        return "prvAppendLiteral( pucBuffer, ulBufferLength, &ulOffset, %s, %d )" % (c_string(text), len(text))
+
+    def serialize_prologue(self, name, struct_name, arg):
+        return ["AzureIoTResult_t %s_Serialize%s( const %s%s_t * %s," % (self.prefix, name, self.prefix, struct_name, arg),
+                " " * (len("AzureIoTResult_t %s_Serialize%s( " % (self.prefix, name))) + "uint8_t * pucBuffer,",
+                " " * (len("AzureIoTResult_t %s_Serialize%s( " % (self.prefix, name))) + "uint32_t ulBufferLength,",
+                " " * (len("AzureIoTResult_t %s_Serialize%s( " % (self.prefix, name))) + "uint32_t * pulBytesWritten )",
+                "{",
+                "    AzureIoTResult_t xResult;",
+                "    uint32_t ulOffset = 0;",
+                ""]
+
+    def serialize_check(self, function, arg):
+        return ["    if( ( %s == NULL ) || ( pucBuffer == NULL ) || ( pulBytesWritten == NULL ) )" % arg,
+                "    {",
+                "        AZLogError( ( \"%s failed: invalid argument\" ) );" % function,
+                "        return eAzureIoTErrorInvalidArgument;",
+                "    }",
+                ""]
+
+    def serialize_epilogue(self):
+        return ["    *pulBytesWritten = ulOffset;",
+                "",
+                "    return eAzureIoTSuccess;",
+                "}",
+                "/*-----------------------------------------------------------*/",
+                ""]
+
+    def telemetry_source(self, fields):
+        function = "%s_SerializeTelemetry" % self.prefix
+        lines = self.serialize_prologue("Telemetry", "Telemetry", "pxTelemetry")
+        lines += self.serialize_check(function, "pxTelemetry")
+
+        # Every field is written, the text between two values is a single fragment
+        fragment = "{"
+        for index, field in enumerate(fields):
+            fragment += ("," if index > 0 else "") + json_string(field.name) + ":"
+            lines += self.append(self.literal(fragment))
+            lines += self.append(self.value(field, "pxTelemetry"))
+            fragment = ""
+        lines += self.append(self.literal(fragment + "}"))
+        return lines + self.serialize_epilogue()
+
+    def reported_source(self, fields):
+        function = "%s_SerializeReportedProperties" % self.prefix
+        opening = "{"
+        closing = "}"
+        if self.component:
+            # The component marker comes first, every property then needs a comma
+            opening = "{" + json_string(self.component) + ":{\"__t\":\"c\""
+            closing = "}}"
+
+        lines = self.serialize_prologue("ReportedProperties", "ReportedProperties", "pxProperties")
+        lines.insert(-1, "    bool xFirst = %s;" % ("false" if self.component else "true"))
+        lines += self.serialize_check(function, "pxProperties")
+        lines += self.append(self.literal(opening))
+
+        for field in fields:
+            bit = "%sREPORTED_%s" % (self.macro, field.macro)
+            name = json_string(field.name) + ":"
+            lines += ["    if( ( pxProperties->ulPresent & %s ) != 0 )" % bit,
+                      "    {",
+                      "        if( ( xResult = ( xFirst ? %s :" % self.literal(name),
+                      "                          %s ) ) != eAzureIoTSuccess )" % self.literal("," + name),
+                      "        {",
+                      "            return xResult;",
+                      "        }",
+                      ""]
+            lines += ["    " + line if line else line for line in self.append(self.value(field, "pxProperties"))]
+            lines += ["        xFirst = false;", "    }", ""]
+
+        lines += self.append(self.literal(closing))
+        return lines + self.serialize_epilogue()
+
+    def parse_source(self, fields):
+        hashes = {}
+        for field in fields:
+            value = fnv1a(field.name.encode())
+            if value in hashes:
+                raise ValueError("hash collision between %s and %s" % (field.name, hashes[value].name))
+            hashes[value] = field
+
+        function = "%s_ParseWritableProperty" % self.prefix
+        indent = " " * len("AzureIoTResult_t %s( " % function)
+        lines = ["AzureIoTResult_t %s( AzureIoTJSONReader_t * pxReader," % function,
+                 indent + "%sWritableProperties_t * pxProperties )" % self.prefix,
+                 "{",
+                 "    AzureIoTResult_t xResult;",
+                 "    az_span xName;",
+                 "    uint32_t ulBit = 0;",
+                 ""]
+        if any(field.schema == "long" for field in fields):
+            lines[5:5] = ["    int64_t llValue;"]
+        lines += ["    if( ( pxReader == NULL ) || ( pxProperties == NULL ) )",
+                  "    {",
+                  "        AZLogError( ( \"%s failed: invalid argument\" ) );" % function,
+                  "        return eAzureIoTErrorInvalidArgument;",
+                  "    }",
+                  "",
+                  "    /* The name stays in the payload, only its hash is needed to dispatch. */",
+                  "    xName = pxReader->_internal.xCoreReader.token.slice;",
+                  ""]
+        lines += self.append("AzureIoTJSONReader_NextToken( pxReader )")
+        lines += ["    switch( prvHash( az_span_ptr( xName ), ( uint32_t ) az_span_size( xName ) ) )",
+                  "    {"]
+        for value, field in sorted(hashes.items()):
+            lines += ["        case 0x%08XUL: /* %s */" % (value, json_string(field.name)),
+                      "",
+                      "            if( ( az_span_size( xName ) == %d ) &&" % len(field.name),
+                      "                ( memcmp( az_span_ptr( xName ), %s, %d ) == 0 ) )"
+                      % (c_string(field.name), len(field.name)),
+                      "            {"]
+            lines += ["                " + line for line in self.parse_value(field)]
+            lines += ["                ulBit = %sWRITABLE_%s;" % (self.macro, field.macro),
+                      "            }",
+                      "",
+                      "            break;",
+                      ""]
+        lines += ["        default:",
+                  "            break;",
+                  "    }",
+                  "",
+                  "    if( ulBit == 0 )",
+                  "    {",
+                  "        /* Not in the model, skip its value. */",
+                  "        if( ( xResult = AzureIoTJSONReader_SkipChildren( pxReader ) ) == eAzureIoTSuccess )",
+                  "        {",
+                  "            xResult = eAzureIoTErrorItemNotFound;",
+                  "        }",
+                  "    }",
+                  "    else if( xResult == eAzureIoTSuccess )",
+                  "    {",
+                  "        pxProperties->ulPresent |= ulBit;",
+                  "    }",
+                  "",
+                  "    if( ( xResult == eAzureIoTSuccess ) || ( xResult == eAzureIoTErrorItemNotFound ) )",
+                  "    {",
+                  "        AzureIoTResult_t xNextResult;",
+                  "",
+                  "        /* Leave the reader after the value, for the next property. */",
+                  "        if( ( xNextResult = AzureIoTJSONReader_NextToken( pxReader ) ) != eAzureIoTSuccess )",
+                  "        {",
+                  "            xResult = xNextResult;",
+                  "        }",
+                  "    }",
+                  "",
+                  "    return xResult;",
+                  "}",
+                  "/*-----------------------------------------------------------*/",
+                  ""]
+        return lines
+
+    def parse_value(self, field):
+        target = "pxProperties->"
+        if field.is_string:
+            return ["xResult = AzureIoTJSONReader_GetTokenString( pxReader, %suc%s," % (target, field.suffix),
+                    "                                              sizeof( %suc%s ), &%sul%sLength );"
+                    % (target, field.suffix, target, field.suffix)]
+        if field.schema == "boolean":
+            return ["xResult = AzureIoTJSONReader_GetTokenBool( pxReader, &%sx%s );" % (target, field.suffix)]
+        if field.schema == "integer":
+            return ["xResult = AzureIoTJSONReader_GetTokenInt32( pxReader, &%sl%s );" % (target, field.suffix)]
+        if field.schema == "long":
+            return ["if( az_result_failed( az_json_token_get_int64( &pxReader->_internal.xCoreReader.token, &llValue ) ) )",
+                    "{",
+                    "    AZLogError( ( \"%s failed: %s is not a long\" ) );" % ("%s_ParseWritableProperty" % self.prefix, field.name),
+                    "    xResult = eAzureIoTErrorFailed;",
+                    "}",
+                    "else",
+                    "{",
+                    "    %sll%s = llValue;" % (target, field.suffix),
+                    "    xResult = eAzureIoTSuccess;",
+                    "}"]
+        return ["xResult = AzureIoTJSONReader_GetTokenDouble( pxReader, &%sx%s );" % (target, field.suffix)]
+
+    def helper_source(self, serialize, parse):
+        lines = []
+
+        if serialize:
+            lines += ["static AzureIoTResult_t prvAppendLiteral( uint8_t * pucBuffer,",
+                     "                                          uint32_t ulBufferLength,",
+                     "                                          uint32_t * pulOffset,",
+                     "                                          const char * pcLiteral,",
+                     "                                          uint32_t ulLength )",
+                     "{",
+                     "    if( ( ulBufferLength - *pulOffset ) < ulLength )",
+                     "    {",
+                     "        return eAzureIoTErrorOutOfMemory;",
+                     "    }",
+                     "",
+                     "    memcpy( pucBuffer + *pulOffset, pcLiteral, ulLength );",
+                     "    *pulOffset += ulLength;",
+                     "",
+                     "    return eAzureIoTSuccess;",
+                     "}",
+                     "/*-----------------------------------------------------------*/",
+                     ""]
+
+        if "integer" in self.helpers:
+            lines += ["static AzureIoTResult_t prvAppendInteger( uint8_t * pucBuffer,",
+                      "                                          uint32_t ulBufferLength,",
+                      "                                          uint32_t * pulOffset,",
+                      "                                          int64_t llValue )",
+                      "{",
+                      "    char cDigits[ 20 ];",
+                      "    uint32_t ulLength = 0;",
+                      "    uint64_t ullValue = ( llValue < 0 ) ? ( 0U - ( uint64_t ) llValue ) : ( uint64_t ) llValue;",
+                      "    uint32_t ulIndex;",
+                      "",
+                      "    do",
+                      "    {",
+                      "        cDigits[ ulLength++ ] = ( char ) ( '0' + ( ullValue % 10U ) );",
+                      "        ullValue /= 10U;",
+                      "    } while( ullValue != 0U );",
+                      "",
+                      "    if( ( ulBufferLength - *pulOffset ) < ( ulLength + ( ( llValue < 0 ) ? 1U : 0U ) ) )",
+                      "    {",
+                      "        return eAzureIoTErrorOutOfMemory;",
+                      "    }",
+                      "",
+                      "    if( llValue < 0 )",
+                      "    {",
+                      "        pucBuffer[ ( *pulOffset )++ ] = '-';",
+                      "    }",
+                      "",
+                      "    for( ulIndex = ulLength; ulIndex > 0; ulIndex-- )",
+                      "    {",
+                      "        pucBuffer[ ( *pulOffset )++ ] = ( uint8_t ) cDigits[ ulIndex - 1 ];",
+                      "    }",
+                      "",
+                      "    return eAzureIoTSuccess;",
+                      "}",
+                      "/*-----------------------------------------------------------*/",
+                      ""]
+
+        if "double" in self.helpers:
+            lines += ["static AzureIoTResult_t prvAppendDouble( uint8_t * pucBuffer,",
+                      "                                         uint32_t ulBufferLength,",
+                      "                                         uint32_t * pulOffset,",
+                      "                                         double xValue )",
+                      "{",
+                      "    az_span xRemainder;",
+                      "",
+                      "    /* JSON has no NaN nor infinity. */",
+                      "    if( !isfinite( xValue ) )",
+                      "    {",
+                      "        return eAzureIoTErrorInvalidArgument;",
+                      "    }",
+                      "",
+                      "    if( az_result_failed( az_span_dtoa( az_span_create( pucBuffer + *pulOffset, ( int32_t ) ( ulBufferLength - *pulOffset ) ),",
+                      "                                        xValue, %sFRACTIONAL_DIGITS, &xRemainder ) ) )" % self.macro,
+                      "    {",
+                      "        return eAzureIoTErrorOutOfMemory;",
+                      "    }",
+                      "",
+                      "    *pulOffset = ulBufferLength - ( uint32_t ) az_span_size( xRemainder );",
+                      "",
+                      "    return eAzureIoTSuccess;",
+                      "}",
+                      "/*-----------------------------------------------------------*/",
+                      ""]
+
+        if "string" in self.helpers:
+            lines += ["static AzureIoTResult_t prvAppendString( uint8_t * pucBuffer,",
+                      "                                         uint32_t ulBufferLength,",
+                      "                                         uint32_t * pulOffset,",
+                      "                                         const uint8_t * pucValue,",
+                      "                                         uint32_t ulValueLength )",
+                      "{",
+                      "    static const char cHex[] = \"0123456789abcdef\";",
+                      "    uint32_t ulOffset = *pulOffset;",
+                      "    uint32_t ulIndex;",
+                      "    uint8_t ucChar;",
+                      "",
+                      "    if( ( pucValue == NULL ) && ( ulValueLength > 0 ) )",
+                      "    {",
+                      "        return eAzureIoTErrorInvalidArgument;",
+                      "    }",
+                      "",
+                      "    /* Room for the quotes, each character then checks for its escaped length plus the closing quote. */",
+                      "    if( ( ulBufferLength - ulOffset ) < 2U )",
+                      "    {",
+                      "        return eAzureIoTErrorOutOfMemory;",
+                      "    }",
+                      "",
+                      "    pucBuffer[ ulOffset++ ] = '\"';",
+                      "",
+                      "    for( ulIndex = 0; ulIndex < ulValueLength; ulIndex++ )",
+                      "    {",
+                      "        ucChar = pucValue[ ulIndex ];",
+                      "",
+                      "        if( ( ucChar >= 0x20U ) && ( ucChar != '\"' ) && ( ucChar != '\\\\' ) )",
+                      "        {",
+                      "            if( ( ulBufferLength - ulOffset ) < 2U )",
+                      "            {",
+                      "                return eAzureIoTErrorOutOfMemory;",
+                      "            }",
+                      "",
+                      "            pucBuffer[ ulOffset++ ] = ucChar;",
+                      "        }",
+                      "        else if( ( ucChar == '\"' ) || ( ucChar == '\\\\' ) )",
+                      "        {",
+                      "            if( ( ulBufferLength - ulOffset ) < 3U )",
+                      "            {",
+                      "                return eAzureIoTErrorOutOfMemory;",
+                      "            }",
+                      "",
+                      "            pucBuffer[ ulOffset++ ] = '\\\\';",
+                      "            pucBuffer[ ulOffset++ ] = ucChar;",
+                      "        }",
+                      "        else",
+                      "        {",
+                      "            if( ( ulBufferLength - ulOffset ) < 7U )",
+                      "            {",
+                      "                return eAzureIoTErrorOutOfMemory;",
+                      "            }",
+                      "",
+                      "            memcpy( pucBuffer + ulOffset, \"\\\\u00\", 4 );",
+                      "            pucBuffer[ ulOffset + 4 ] = ( uint8_t ) cHex[ ucChar >> 4 ];",
+                      "            pucBuffer[ ulOffset + 5 ] = ( uint8_t ) cHex[ ucChar & 0xFU ];",
+                      "            ulOffset += 6;",
+                      "        }",
+                      "    }",
+                      "",
+                      "    pucBuffer[ ulOffset++ ] = '\"';",
+                      "    *pulOffset = ulOffset;",
+                      "",
+                      "    return eAzureIoTSuccess;",
+                      "}",
+                      "/*-----------------------------------------------------------*/",
+                      ""]
+
+        if parse:
+            lines += ["/* FNV-1a, the case labels are computed by the generator. */",
+                      "static uint32_t prvHash( const uint8_t * pucName,",
+                      "                         uint32_t ulNameLength )",
+                      "{",
+                      "    uint32_t ulHash = 0x811C9DC5UL;",
+                      "    uint32_t ulIndex;",
+                      "",
+                      "    for( ulIndex = 0; ulIndex < ulNameLength; ulIndex++ )",
+                      "    {",
+                      "        ulHash = ( ulHash ^ pucName[ ulIndex ] ) * 0x01000193UL;",
+                      "    }",
+                      "",
+                      "    return ulHash;",
+                      "}",
+                      "/*-----------------------------------------------------------*/",
+                      ""]
+        return lines
+
+    def header(self, telemetry, reported, writable):
+        guard = re.sub(r"[^A-Za-z0-9]", "_", self.output.split("/")[-1]).upper() + "_H"
+        name = self.output.split("/")[-1]
+        lines = ["/* Generated by tools/dtdl_codegen/dtdl_to_c.py from %s, do not edit. */" % self.model_id,
+                 "",
+                 "/**",
+                 " * @file %s.h" % name,
+                 " *",
+                 " * @brief Serializers and parsers for %s." % self.model_id,
+                 " */",
+                 "#ifndef %s" % guard,
+                 "#define %s" % guard,
+                 "",
+                 "#include <stdbool.h>",
+                 "#include <stdint.h>",
+                 "",
+                 "#include \"azure_iot_result.h\"",
+                 "#include \"azure_iot_json_reader.h\"",
+                 "",
+                 "/**",
+                 " * @brief Model ID to pass as `pucModelID` in the hub client options.",
+                 " */",
+                 "#define %sMODEL_ID    %s" % (self.macro, c_string(self.model_id)),
+                 ""]
+
+        if any(field.is_string for field in writable):
+            lines += ["/**",
+                      " * @brief Size of the buffers of the writable string properties.",
+                      " */",
+                      "#ifndef %sSTRING_MAX" % self.macro,
+                      "    #define %sSTRING_MAX    ( %dU )" % (self.macro, self.string_max),
+                      "#endif",
+                      ""]
+
+        if telemetry:
+            lines += self.struct("Telemetry", telemetry, False, False, "Telemetry of %s." % self.model_id)
+        if reported:
+            lines += self.struct("ReportedProperties", reported, True, False, "Read-only properties of %s." % self.model_id)
+        if writable:
+            lines += self.struct("WritableProperties", writable, True, True, "Writable properties of %s." % self.model_id)
+
+        if telemetry:
+            lines += ["/**",
+                      " * @brief Write the telemetry as a JSON object.",
+                      " *",
+                      " * @param[in] pxTelemetry The #%sTelemetry_t to write." % self.prefix,
+                      " * @param[out] pucBuffer The buffer to write to.",
+                      " * @param[in] ulBufferLength The length of \\p pucBuffer.",
+                      " * @param[out] pulBytesWritten The length of the JSON text.",
+                      " * @return An #AzureIoTResult_t with the result of the operation.",
+                      " */",
+                      "AzureIoTResult_t %s_SerializeTelemetry( const %sTelemetry_t * pxTelemetry," % (self.prefix, self.prefix),
+                      " " * len("AzureIoTResult_t %s_SerializeTelemetry( " % self.prefix) + "uint8_t * pucBuffer,",
+                      " " * len("AzureIoTResult_t %s_SerializeTelemetry( " % self.prefix) + "uint32_t ulBufferLength,",
+                      " " * len("AzureIoTResult_t %s_SerializeTelemetry( " % self.prefix) + "uint32_t * pulBytesWritten );",
+                      ""]
+        if reported:
+            lines += ["/**",
+                      " * @brief Write the properties whose bit is set in `ulPresent` as a reported properties document%s."
+                      % ((" of component " + json_string(self.component)) if self.component else ""),
+                      " *",
+                      " * @param[in] pxProperties The #%sReportedProperties_t to write." % self.prefix,
+                      " * @param[out] pucBuffer The buffer to write to.",
+                      " * @param[in] ulBufferLength The length of \\p pucBuffer.",
+                      " * @param[out] pulBytesWritten The length of the JSON text.",
+                      " * @return An #AzureIoTResult_t with the result of the operation.",
+                      " */",
+                      "AzureIoTResult_t %s_SerializeReportedProperties( const %sReportedProperties_t * pxProperties," % (self.prefix, self.prefix),
+                      " " * len("AzureIoTResult_t %s_SerializeReportedProperties( " % self.prefix) + "uint8_t * pucBuffer,",
+                      " " * len("AzureIoTResult_t %s_SerializeReportedProperties( " % self.prefix) + "uint32_t ulBufferLength,",
+                      " " * len("AzureIoTResult_t %s_SerializeReportedProperties( " % self.prefix) + "uint32_t * pulBytesWritten );",
+                      ""]
+        if writable:
+            lines += ["/**",
+                      " * @brief Read a writable property into \\p pxProperties and set its bit in `ulPresent`.",
+                      " *",
+                      " * Call it when AzureIoTHubClientProperties_GetNextComponentProperty() leaves the reader on a",
+                      " * property name. On return, the reader is after the property value.",
+                      " *",
+                      " * @param[in] pxReader The #AzureIoTJSONReader_t placed on the property name.",
+                      " * @param[in,out] pxProperties The #%sWritableProperties_t to update." % self.prefix,
+                      " * @return An #AzureIoTResult_t with the result of the operation.",
+                      " *      - eAzureIoTSuccess the property was read.",
+                      " *      - eAzureIoTErrorItemNotFound the property is not in the model, its value was skipped.",
+                      " *      - Any other value is an error reading the value, e.g. of the wrong type.",
+                      " */",
+                      "AzureIoTResult_t %s_ParseWritableProperty( AzureIoTJSONReader_t * pxReader," % self.prefix,
+                      " " * len("AzureIoTResult_t %s_ParseWritableProperty( " % self.prefix)
+                      + "%sWritableProperties_t * pxProperties );" % self.prefix,
+                      ""]
+
+        lines += ["#endif /* %s */" % guard]
+        return "\n".join(lines) + "\n"
+
+    def source(self, telemetry, reported, writable):
+        name = self.output.split("/")[-1]
+        body = []
+        if telemetry:
+            body += self.telemetry_source(telemetry)
+        if reported:
+            body += self.reported_source(reported)
+        if writable:
+            body += self.parse_source(writable)
+
+        lines = ["/* Generated by tools/dtdl_codegen/dtdl_to_c.py from %s, do not edit. */" % self.model_id,
+                 "",
+                 "#include \"%s.h\"" % name,
+                 "",
+                 "#include <math.h>",
+                 "#include <string.h>",
+                 "",
+                 "#include \"azure_iot.h\"",
+                 "",
+                 "#include \"azure/az_core.h\"",
+                 "/*-----------------------------------------------------------*/",
+                 ""]
+        if "double" in self.helpers:
+            lines += ["#define %sFRACTIONAL_DIGITS    ( %d )" % (self.macro, self.fractional_digits),
+                      "/*-----------------------------------------------------------*/",
+                      ""]
+        lines += self.helper_source(bool(telemetry or reported), bool(writable))
+        lines += body
+        return "\n".join(lines)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("model", help="DTDL v2 interface (JSON)")
+    parser.add_argument("--prefix", required=True, help="prefix of the generated types and functions, e.g. Thermostat")
+    parser.add_argument("--output", required=True, help="path of the generated files, without .h and .c")
+    parser.add_argument("--component", help="name of the component the reported properties belong to")
+    parser.add_argument("--fractional-digits", type=int, default=2, help="fractional digits of double values")
+    parser.add_argument("--string-max", type=int, default=32, help="buffer size of writable string properties")
+    parser.add_argument("--skip-unsupported", action="store_true", help="skip contents of unsupported schemas")
+    args = parser.parse_args()
+
+    if not re.fullmatch(r"[A-Z][A-Za-z0-9]*", args.prefix):
+        parser.error("the prefix must be a C identifier starting with an upper case letter")
+
+    with open(args.model) as model_file:
+        model = json.load(model_file)
+
+    if isinstance(model, list):
+        model = model[0]
+
+    if model.get("@type") != "Interface" or "@id" not in model:
+        parser.error("the model must be a DTDL interface with an @id")
+
+    try:
+        telemetry, properties = load_fields(model, args.skip_unsupported)
+    except ValueError as error:
+        parser.error(str(error))
+
+    reported = [field for field in properties if not field.writable]
+    writable = [field for field in properties if field.writable]
+
+    for fields in (reported, writable):
+        if len(fields) > 32:
+            parser.error("at most 32 reported and 32 writable properties are supported")
+
+    generator = Generator(model["@id"], args.prefix, args.output, args.component,
+                          args.fractional_digits, args.string_max)
+
+    try:
+        source = generator.source(telemetry, reported, writable)
+    except ValueError as error:
+        parser.error(str(error))
+
+    with open(args.output + ".h", "w") as header_file:
+        header_file.write(generator.header(telemetry, reported, writable))
+
+    with open(args.output + ".c", "w") as source_file:
+        source_file.write(source)
+
+
+if __name__ == "__main__":
+    main()